@@ -13,3 +13,12 @@
 #define MAX_NAME_COUNT	10000
 
 #define PCRE_STATIC     1
+
+/* JIT compilation with sljit, used by pcre_study(PCRE_STUDY_JIT_COMPILE).
+   Enabled on desktop x86/x64 only; console targets do not allow generating
+   executable code at run time. Patterns fall back to the interpreter
+   wherever it is disabled. */
+#if (defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)) && \
+    !defined(_XBOX) && !defined(_DURANGO) && !defined(SF_OS_ORBIS) && !defined(__ORBIS__)
+#define SUPPORT_JIT     1
+#endif
@@ -0,0 +1,624 @@
+/**************************************************************************
+
+Filename    :   AS3DispatchBenchmark.cpp
+Content     :   Times AS3 bytecode executed by the VM, to compare the
+                opcode dispatch styles of VM::ExecuteCode.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+// Runs small AS3 methods through the VM and reports the time of one loop
+// iteration of each of them. The methods are assembled into an ABC file at
+// startup, wrapped into an SWF held in memory and loaded with the regular
+// Loader; they are called through Value::Invoke, so they are traced and
+// executed by VM::ExecuteCode like any script code.
+//
+// VM::ExecuteCode dispatches opcodes either with a switch or through a
+// table of handler labels (SF_AS3_ENABLE_THREADED_DISPATCH, on by default
+// with GCC and Clang). The choice is made when the AS3 library is built, so
+// to compare the two, run this benchmark against a library built as is and
+// one built with SF_AS3_DISABLE_THREADED_DISPATCH; build the benchmark with
+// the same define, so that it reports the right mode. Both must report the
+// same results.
+//
+// Usage: AS3DispatchBenchmark [iterations]
+
+#include "GFx.h"
+#include "Kernel/SF_Timer.h"
+#include "Kernel/SF_File.h"
+#include "GFx/GFx_Tags.h"
+#include "GFx/AS3/AS3_Global.h"
+#include "GFx/AS3/AS3_VM.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace Scaleform;
+using namespace Scaleform::GFx;
+
+typedef ArrayPOD<UByte> ByteBuffer;
+typedef AS3::Abc::Code  Code;
+
+///////////////////////////////////////////////////////////////////////////
+// Encoding helpers, shared by the ABC and SWF writers.
+
+static void WriteU8(ByteBuffer& b, unsigned v)
+{
+    b.PushBack((UByte)v);
+}
+
+static void WriteU16(ByteBuffer& b, unsigned v)
+{
+    WriteU8(b, v & 0xFF);
+    WriteU8(b, (v >> 8) & 0xFF);
+}
+
+static void WriteU32(ByteBuffer& b, UInt32 v)
+{
+    WriteU16(b, v & 0xFFFF);
+    WriteU16(b, v >> 16);
+}
+
+static void WriteU30(ByteBuffer& b, UInt32 v)
+{
+    do
+    {
+        UByte c = (UByte)(v & 0x7F);
+        v >>= 7;
+        if (v)
+            c |= 0x80;
+        b.PushBack(c);
+    } while (v);
+}
+
+static void WriteString(ByteBuffer& b, const char* str)
+{
+    const UPInt length = SFstrlen(str);
+    WriteU30(b, (UInt32)length);
+    for (UPInt i = 0; i < length; ++i)
+        WriteU8(b, (UByte)str[i]);
+}
+
+static void Append(ByteBuffer& b, const ByteBuffer& data)
+{
+    for (UPInt i = 0; i < data.GetSize(); ++i)
+        b.PushBack(data[i]);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// ABC file.
+//
+// One class, equivalent to:
+//
+//  public class Bench {
+//      public var x:int;
+//      public function step(a:int):int { return (a & 7) + (a >> 1); }
+//      public function loop(n:int):int  { ... }
+//      ...
+//  }
+//
+// Each benchmark method runs a loop of n iterations and returns a value
+// computed from all of them.
+
+// Constant pool indices; index 0 is the implicit entry of each pool.
+enum StringIndex
+{
+    S_Empty = 1, S_Bench, S_Object, S_int, S_x, S_step,
+    S_loop, S_arith, S_calls, S_props, S_array,
+    S_Count
+};
+
+enum MultinameIndex
+{
+    MN_Bench = 1, MN_Object, MN_int, MN_x, MN_step,
+    MN_loop, MN_arith, MN_calls, MN_props, MN_array,
+    MN_Index,   // Run-time name in the public namespace, for array elements.
+    MN_Count
+};
+
+enum IntIndex
+{
+    INT_Mask = 1,
+    INT_Count
+};
+
+enum MethodIndex
+{
+    M_ScriptInit, M_ClassInit, M_InstanceInit, M_Step,
+    M_FirstBench
+};
+
+enum { Local_This, Local_N, Local_I, Local_Acc, Local_Array, Local_Count };
+
+static const char* const Strings[S_Count] =
+{
+    0, "", "Bench", "Object", "int", "x", "step",
+    "loop", "arith", "calls", "props", "array"
+};
+
+// Method body code, with branch patching.
+class CodeBuffer
+{
+public:
+    ByteBuffer Data;
+
+    void Op(Code::OpCode op)                 { WriteU8(Data, op); }
+    void OpU8(Code::OpCode op, unsigned v)   { WriteU8(Data, op); WriteU8(Data, v); }
+    void OpU30(Code::OpCode op, UInt32 v)    { WriteU8(Data, op); WriteU30(Data, v); }
+    void OpU30U30(Code::OpCode op, UInt32 v1, UInt32 v2)
+    {
+        OpU30(op, v1);
+        WriteU30(Data, v2);
+    }
+
+    // Emits a branch with its offset to be patched; returns the position
+    // following the branch, which the offset is relative to.
+    UPInt Branch(Code::OpCode op)
+    {
+        WriteU8(Data, op);
+        WriteU8(Data, 0);
+        WriteU8(Data, 0);
+        WriteU8(Data, 0);
+        return Data.GetSize();
+    }
+    void PatchBranch(UPInt from, UPInt to)
+    {
+        const SInt32 offset = (SInt32)to - (SInt32)from;
+        Data[from - 3] = (UByte)(offset & 0xFF);
+        Data[from - 2] = (UByte)((offset >> 8) & 0xFF);
+        Data[from - 1] = (UByte)((offset >> 16) & 0xFF);
+    }
+    UPInt GetPos() const { return Data.GetSize(); }
+};
+
+typedef void (*EmitBodyFunc)(CodeBuffer& c);
+
+// Loop bodies; local Local_I is the loop counter, Local_Acc the result.
+static void EmitLoopBody(CodeBuffer&)
+{
+}
+
+// acc = ((acc + i * 3) ^ (i >> 1)) & 0xFFFFFF;
+static void EmitArithBody(CodeBuffer& c)
+{
+    c.Op(Code::op_getlocal3);
+    c.Op(Code::op_getlocal2);
+    c.OpU8(Code::op_pushbyte, 3);
+    c.Op(Code::op_multiply_i);
+    c.Op(Code::op_add_i);
+    c.Op(Code::op_getlocal2);
+    c.OpU8(Code::op_pushbyte, 1);
+    c.Op(Code::op_rshift);
+    c.Op(Code::op_bitxor);
+    c.OpU30(Code::op_pushint, INT_Mask);
+    c.Op(Code::op_bitand);
+    c.Op(Code::op_setlocal3);
+}
+
+// acc = acc + step(i);
+static void EmitCallsBody(CodeBuffer& c)
+{
+    c.Op(Code::op_getlocal3);
+    c.Op(Code::op_getlocal0);
+    c.Op(Code::op_getlocal2);
+    c.OpU30U30(Code::op_callproperty, MN_step, 1);
+    c.Op(Code::op_add_i);
+    c.Op(Code::op_setlocal3);
+}
+
+// x = x + i; acc = acc ^ x;
+static void EmitPropsBody(CodeBuffer& c)
+{
+    c.Op(Code::op_getlocal0);
+    c.Op(Code::op_getlocal0);
+    c.OpU30(Code::op_getproperty, MN_x);
+    c.Op(Code::op_getlocal2);
+    c.Op(Code::op_add_i);
+    c.OpU30(Code::op_setproperty, MN_x);
+    c.Op(Code::op_getlocal3);
+    c.Op(Code::op_getlocal0);
+    c.OpU30(Code::op_getproperty, MN_x);
+    c.Op(Code::op_bitxor);
+    c.Op(Code::op_setlocal3);
+}
+
+// array[i & 63] = acc; acc = (acc + array[i & 63] + 1) & 0xFFFFFF;
+static void EmitArrayBody(CodeBuffer& c)
+{
+    c.OpU30(Code::op_getlocal, Local_Array);
+    c.Op(Code::op_getlocal2);
+    c.OpU8(Code::op_pushbyte, 63);
+    c.Op(Code::op_bitand);
+    c.Op(Code::op_getlocal3);
+    c.OpU30(Code::op_setproperty, MN_Index);
+    c.Op(Code::op_getlocal3);
+    c.OpU30(Code::op_getlocal, Local_Array);
+    c.Op(Code::op_getlocal2);
+    c.OpU8(Code::op_pushbyte, 63);
+    c.Op(Code::op_bitand);
+    c.OpU30(Code::op_getproperty, MN_Index);
+    c.Op(Code::op_convert_i);
+    c.Op(Code::op_add_i);
+    c.Op(Code::op_increment_i);
+    c.OpU30(Code::op_pushint, INT_Mask);
+    c.Op(Code::op_bitand);
+    c.Op(Code::op_setlocal3);
+}
+
+struct BenchDesc
+{
+    const char*     Name;
+    MultinameIndex  MethodName;
+    EmitBodyFunc    EmitBody;
+};
+
+static const BenchDesc Benches[] =
+{
+    { "loop",  MN_loop,  EmitLoopBody  },   // Loop overhead only.
+    { "arith", MN_arith, EmitArithBody },   // Integer arithmetic on locals.
+    { "calls", MN_calls, EmitCallsBody },   // Method call per iteration.
+    { "props", MN_props, EmitPropsBody },   // Typed slot reads and writes.
+    { "array", MN_array, EmitArrayBody }    // Array element reads and writes.
+};
+enum { BenchCount = sizeof(Benches) / sizeof(Benches[0]) };
+
+// x = 0; for (i = 0, acc = 0; i < n; ++i) { body } return acc;
+static void EmitBenchMethod(CodeBuffer& c, EmitBodyFunc emitBody)
+{
+    c.Op(Code::op_getlocal0);
+    c.Op(Code::op_pushscope);
+    c.Op(Code::op_getlocal0);
+    c.OpU8(Code::op_pushbyte, 0);
+    c.OpU30(Code::op_setproperty, MN_x);
+    c.OpU8(Code::op_pushbyte, 0);
+    c.Op(Code::op_setlocal2);
+    c.OpU8(Code::op_pushbyte, 0);
+    c.Op(Code::op_setlocal3);
+    c.OpU30(Code::op_newarray, 0);
+    c.OpU30(Code::op_setlocal, Local_Array);
+
+    const UPInt toCond = c.Branch(Code::op_jump);
+    const UPInt body   = c.GetPos();
+    c.Op(Code::op_label);
+    emitBody(c);
+    c.OpU30(Code::op_inclocal_i, Local_I);
+
+    c.PatchBranch(toCond, c.GetPos());
+    c.Op(Code::op_getlocal2);
+    c.Op(Code::op_getlocal1);
+    c.PatchBranch(c.Branch(Code::op_iflt), body);
+
+    c.Op(Code::op_getlocal3);
+    c.Op(Code::op_returnvalue);
+}
+
+static void WriteMethodInfo(ByteBuffer& b, unsigned paramCount)
+{
+    WriteU30(b, paramCount);
+    WriteU30(b, paramCount ? MN_int : 0);  // Return type.
+    for (unsigned i = 0; i < paramCount; ++i)
+        WriteU30(b, MN_int);
+    WriteU30(b, 0);                         // Name.
+    WriteU8(b, 0);                          // Flags.
+}
+
+static void WriteMethodBody(ByteBuffer& b, unsigned method, unsigned maxStack,
+                            unsigned localCount, const CodeBuffer& c)
+{
+    WriteU30(b, method);
+    WriteU30(b, maxStack);
+    WriteU30(b, localCount);
+    WriteU30(b, 0);                         // Init scope depth.
+    WriteU30(b, 2);                         // Max scope depth.
+    WriteU30(b, (UInt32)c.Data.GetSize());
+    Append(b, c.Data);
+    WriteU30(b, 0);                         // Exceptions.
+    WriteU30(b, 0);                         // Traits.
+}
+
+static void BuildAbc(ByteBuffer& b)
+{
+    unsigned i;
+
+    WriteU16(b, 16);                        // Minor version.
+    WriteU16(b, 46);                        // Major version.
+
+    // Constant pool.
+    WriteU30(b, INT_Count);
+    WriteU30(b, 0xFFFFFF);
+    WriteU30(b, 0);                         // UInts.
+    WriteU30(b, 0);                         // Doubles.
+    WriteU30(b, S_Count);
+    for (i = 1; i < S_Count; ++i)
+        WriteString(b, Strings[i]);
+    WriteU30(b, 2);                         // Namespaces.
+    WriteU8(b, 0x16);                       // Package namespace "".
+    WriteU30(b, S_Empty);
+    WriteU30(b, 2);                         // Namespace sets.
+    WriteU30(b, 1);
+    WriteU30(b, 1);
+    WriteU30(b, MN_Count);
+    static const StringIndex qnames[MN_Index - 1] =
+    {
+        S_Bench, S_Object, S_int, S_x, S_step,
+        S_loop, S_arith, S_calls, S_props, S_array
+    };
+    for (i = 0; i < MN_Index - 1; ++i)
+    {
+        WriteU8(b, 0x07);                   // QName.
+        WriteU30(b, 1);
+        WriteU30(b, qnames[i]);
+    }
+    WriteU8(b, 0x1B);                       // MultinameL.
+    WriteU30(b, 1);
+
+    // Methods.
+    WriteU30(b, M_FirstBench + BenchCount);
+    WriteMethodInfo(b, 0);
+    WriteMethodInfo(b, 0);
+    WriteMethodInfo(b, 0);
+    for (i = M_Step; i < M_FirstBench + BenchCount; ++i)
+        WriteMethodInfo(b, 1);
+
+    WriteU30(b, 0);                         // Metadata.
+
+    // Class Bench: instance and class info.
+    WriteU30(b, 1);
+    WriteU30(b, MN_Bench);
+    WriteU30(b, MN_Object);
+    WriteU8(b, 0x01);                       // Sealed.
+    WriteU30(b, 0);                         // Interfaces.
+    WriteU30(b, M_InstanceInit);
+    WriteU30(b, 2 + BenchCount);
+    WriteU30(b, MN_x);                      // var x:int
+    WriteU8(b, 0);
+    WriteU30(b, 0);
+    WriteU30(b, MN_int);
+    WriteU30(b, 0);
+    WriteU30(b, MN_step);                   // function step
+    WriteU8(b, 1);
+    WriteU30(b, 0);
+    WriteU30(b, M_Step);
+    for (i = 0; i < BenchCount; ++i)
+    {
+        WriteU30(b, Benches[i].MethodName);
+        WriteU8(b, 1);
+        WriteU30(b, 0);
+        WriteU30(b, M_FirstBench + i);
+    }
+    WriteU30(b, M_ClassInit);
+    WriteU30(b, 0);
+
+    // Script, defining the class.
+    WriteU30(b, 1);
+    WriteU30(b, M_ScriptInit);
+    WriteU30(b, 1);
+    WriteU30(b, MN_Bench);
+    WriteU8(b, 4);
+    WriteU30(b, 0);
+    WriteU30(b, 0);
+
+    // Method bodies.
+    WriteU30(b, M_FirstBench + BenchCount);
+    {
+        CodeBuffer c;
+        c.Op(Code::op_getlocal0);
+        c.Op(Code::op_pushscope);
+        c.OpU8(Code::op_getscopeobject, 0);
+        c.OpU30(Code::op_getlex, MN_Object);
+        c.Op(Code::op_pushscope);
+        c.OpU30(Code::op_getlex, MN_Object);
+        c.OpU30(Code::op_newclass, 0);
+        c.Op(Code::op_popscope);
+        c.OpU30(Code::op_initproperty, MN_Bench);
+        c.Op(Code::op_returnvoid);
+        WriteMethodBody(b, M_ScriptInit, 2, 1, c);
+    }
+    {
+        CodeBuffer c;
+        c.Op(Code::op_getlocal0);
+        c.Op(Code::op_pushscope);
+        c.Op(Code::op_returnvoid);
+        WriteMethodBody(b, M_ClassInit, 1, 1, c);
+    }
+    {
+        CodeBuffer c;
+        c.Op(Code::op_getlocal0);
+        c.Op(Code::op_pushscope);
+        c.Op(Code::op_getlocal0);
+        c.OpU30(Code::op_constructsuper, 0);
+        c.Op(Code::op_returnvoid);
+        WriteMethodBody(b, M_InstanceInit, 1, 1, c);
+    }
+    {
+        CodeBuffer c;
+        c.Op(Code::op_getlocal1);
+        c.OpU8(Code::op_pushbyte, 7);
+        c.Op(Code::op_bitand);
+        c.Op(Code::op_getlocal1);
+        c.OpU8(Code::op_pushbyte, 1);
+        c.Op(Code::op_rshift);
+        c.Op(Code::op_add_i);
+        c.Op(Code::op_returnvalue);
+        WriteMethodBody(b, M_Step, 3, 2, c);
+    }
+    for (i = 0; i < BenchCount; ++i)
+    {
+        CodeBuffer c;
+        EmitBenchMethod(c, Benches[i].EmitBody);
+        WriteMethodBody(b, M_FirstBench + i, 6, Local_Count, c);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// SWF file holding the ABC file.
+
+static void WriteTag(ByteBuffer& b, unsigned code, const ByteBuffer& data)
+{
+    const UPInt length = data.GetSize();
+    if (length < 0x3F)
+        WriteU16(b, (code << 6) | (unsigned)length);
+    else
+    {
+        WriteU16(b, (code << 6) | 0x3F);
+        WriteU32(b, (UInt32)length);
+    }
+    Append(b, data);
+}
+
+static void BuildSwf(ByteBuffer& b, const ByteBuffer& abc)
+{
+    WriteU8(b, 'F');
+    WriteU8(b, 'W');
+    WriteU8(b, 'S');
+    WriteU8(b, 10);                         // Version.
+    WriteU32(b, 0);                         // File length, set below.
+    WriteU8(b, 0);                          // Empty frame rectangle.
+    WriteU16(b, 24 << 8);                   // Frame rate, 8.8.
+    WriteU16(b, 1);                         // Frame count.
+
+    ByteBuffer data;
+    WriteU32(data, 0x08);                   // ActionScript 3.
+    WriteTag(b, Tag_FileAttributes, data);
+
+    data.Clear();
+    WriteU32(data, 0);                      // Flags.
+    WriteU8(data, 0);                       // Name.
+    Append(data, abc);
+    WriteTag(b, Tag_DoAbc, data);
+
+    data.Clear();
+    WriteTag(b, Tag_EndFrame, data);
+    WriteTag(b, Tag_End, data);
+
+    const UInt32 length = (UInt32)b.GetSize();
+    for (unsigned i = 0; i < 4; ++i)
+        b[4 + i] = (UByte)(length >> (i * 8));
+}
+
+///////////////////////////////////////////////////////////////////////////
+
+static const char* const SwfName = "AS3DispatchBenchmark.swf";
+
+// Serves the generated SWF from memory.
+class BenchFileOpener : public FileOpener
+{
+public:
+    BenchFileOpener(const ByteBuffer& swf) : Swf(swf) { }
+
+    virtual File* OpenFile(const char* purl, int flags, int mode)
+    {
+        if (SFstrcmp(purl, SwfName) == 0)
+            return SF_NEW MemoryFile(purl, Swf.GetDataPtr(), (int)Swf.GetSize());
+        return FileOpener::OpenFile(purl, flags, mode);
+    }
+
+private:
+    const ByteBuffer& Swf;
+};
+
+class BenchLog : public Log
+{
+public:
+    virtual void LogMessageVarg(LogMessageId messageId, const char* pfmt, va_list argList)
+    {
+        SF_UNUSED(messageId);
+        vprintf(pfmt, argList);
+    }
+};
+
+// Calls the method with n iterations; ticks receives the time in microseconds.
+static bool Run(GFx::Value& bench, const char* name, int n, SInt32* result, UInt64* ticks)
+{
+    GFx::Value arg((SInt32)n), ret;
+    UInt64 start = Timer::GetProfileTicks();
+    if (!bench.Invoke(name, &ret, &arg, 1) || !ret.IsNumeric())
+        return false;
+    *ticks  = Timer::GetProfileTicks() - start;
+    // AS3 int results come back as Int, not Number.
+    *result = ret.IsInt() ? ret.GetInt() : ret.IsUInt() ? (SInt32)ret.GetUInt() : (SInt32)ret.GetNumber();
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    GFx::System sys;
+
+    int iterations = (argc > 1) ? atoi(argv[1]) : 2000000;
+    if (iterations <= 0)
+    {
+        printf("Usage: AS3DispatchBenchmark [iterations]\n");
+        return 1;
+    }
+
+    ByteBuffer abc, swf;
+    BuildAbc(abc);
+    BuildSwf(swf, abc);
+
+    int status = 0;
+    {
+        Loader loader;
+        loader.SetLog(Ptr<Log>(*new BenchLog()));
+        loader.SetFileOpener(Ptr<FileOpener>(*new BenchFileOpener(swf)));
+        loader.SetAS3Support(Ptr<ASSupport>(*new AS3Support()));
+
+        Ptr<MovieDef> pmovieDef = *loader.CreateMovie(SwfName);
+        Ptr<Movie>    pmovie;
+        if (pmovieDef)
+            pmovie = *pmovieDef->CreateInstance(true);
+        if (!pmovie)
+        {
+            printf("Error: can't create the benchmark movie\n");
+            return 1;
+        }
+        pmovie->Advance(0);
+
+        GFx::Value bench;
+        pmovie->CreateObject(&bench, "Bench");
+        if (!bench.IsObject())
+        {
+            printf("Error: can't create the Bench object\n");
+            return 1;
+        }
+
+#ifdef SF_AS3_ENABLE_THREADED_DISPATCH
+        const char* dispatch = "threaded";
+#else
+        const char* dispatch = "switch";
+#endif
+        printf("AS3 VM, %s dispatch: %d iterations per method\n", dispatch, iterations);
+
+        for (unsigned i = 0; i < BenchCount; ++i)
+        {
+            // The first call traces the method.
+            SInt32 result = 0;
+            UInt64 ticks  = 0;
+            if (!Run(bench, Benches[i].Name, 100, &result, &ticks))
+            {
+                printf("Error: %s failed\n", Benches[i].Name);
+                status = 1;
+                continue;
+            }
+
+            UInt64 best = 0;
+            for (int pass = 0; pass < 5; ++pass)
+            {
+                Run(bench, Benches[i].Name, iterations, &result, &ticks);
+                if (pass == 0 || ticks < best)
+                    best = ticks;
+            }
+            printf("  %-6s %7.2f ns/iteration  (result %d)\n", Benches[i].Name,
+                   (double)best * 1000.0 / iterations, (int)result);
+        }
+
+        bench.SetUndefined();
+    }
+    return status;
+}
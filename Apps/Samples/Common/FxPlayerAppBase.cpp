@@ -1726,6 +1726,15 @@ void FxPlayerAppBase::InitArgDescriptions(Platform::Args* args)
         {"q",   "Quiet",               Args::Flag, "", "Quiet. Do not display errors or trace statements."},
         {"xmllog",   "XmlLog",         Args::Flag, "", "XML Log. Output errors and trace statement in XML format"},
         {"qae", "SuppressASErrors",    Args::Flag, "", "Quiet. Suppress ActionScript errors."},
+        {"pt",  "PreTraceTime",        Args::IntOption, "0",
+        "<usec>  Trace AS3 methods ahead of their first call, for up to\n"
+        "              the given number of microseconds per frame."},
+        {"gcs", "GCSliceTime",         Args::IntOption, "0",
+        "<usec>  Spread AS3 garbage collections over frames, collecting\n"
+        "              for up to the given number of microseconds per frame."},
+        {"tkm", "TimelineKeyframeMemory", Args::IntOption, "65536",
+        "<bytes> Memory limit of the keyframes kept by each movie clip\n"
+        "              timeline for backward gotos; 0 disables them."},
         {"ml",  "LodBias",             Args::FloatOption, "-0.5", 
         "<bias>  Specify the texture LOD bias (float, default -0.5)"},
         {"rs",  "RecordStatistics",    Args::StringOption, NULL,
@@ -1739,6 +1748,13 @@ void FxPlayerAppBase::InitArgDescriptions(Platform::Args* args)
         {"nck", "NoControlKeys",       Args::Flag, "", "Disable all player related control keys."},
         {"t",   "ExitTimeout",         Args::FloatOption, "0.0",
         "<msec>    Timeout and exit after the specified number of milliseconds."},
+        {"mc",  "MeshCacheFile",       Args::StringOption, NULL,
+        "<fname>  Load tessellated meshes from file, saving new ones at exit.\n"
+        "              Use with -t to pre-populate the file."},
+#ifdef GFX_AS3_SUPPORT
+        {"oc",  "OpCodeCacheFile",     Args::StringOption, NULL,
+        "<fname>  Load traced AS3 code from file, saving new code at exit."},
+#endif
         {"mtl", "ProgressiveLoading", Args::Flag, "", "Enable progressive loading."},
         {"res", "Resolution",          Args::StringOption, "", "Override GFxPlayer resolution with custom values\n"
         "              of width and height using -res W:H."},
@@ -1747,6 +1763,8 @@ void FxPlayerAppBase::InitArgDescriptions(Platform::Args* args)
         {"wait","AmpWait",             Args::Flag, "0", "Wait until an AMP connection has been established"},
         {"pl","AmpProfileLevel",       Args::IntOption, "-1", "AMP function profiling level: 0=Low (default), 1=Medium, 2=High."},
         {"mem","AmpMemDetail",         Args::Flag, "0", "AMP detailed memory reports."},
+        {"ampcap","AmpCaptureFile",    Args::StringOption, NULL,
+        "<fname>  Write AMP profile data to a capture file, for use with AmpAnalyzer."},
 #endif
         {"autotest","AutoPlayback",    Args::StringOption, NULL, "Use the given filename as instructions for an automated test playback." },
         {"autodir", "AutoOutput",      Args::StringOption, "AutoOutput", "Destination directory (prefix) for autotest output." },
@@ -1995,7 +2013,13 @@ bool FxPlayerAppBase::OnInit(Platform::ViewConfig& config)
 #endif
 
 #ifdef GFX_AS3_SUPPORT
-    Ptr<ASSupport> pAS3Support = *new AS3Support();
+    Ptr<AS3Support> pAS3Support = *new AS3Support();
+    if (args.HasValue("OpCodeCacheFile"))
+    {
+        Ptr<AS3::OpCodeCache> opCodeCache = *SF_NEW AS3::OpCodeCache;
+        opCodeCache->LoadFile(args.GetString("OpCodeCacheFile"));
+        pAS3Support->SetOpCodeCache(opCodeCache);
+    }
     mLoader.SetAS3Support(pAS3Support);
 #endif
 
@@ -2509,6 +2533,11 @@ bool FxPlayerAppBase::OnInit(Platform::ViewConfig& config)
     AmpServer::GetInstance().SetListeningPort(AmpPort);
     AmpDirty = true;
 
+    if (args.HasValue("AmpCaptureFile"))
+    {
+        AmpServer::GetInstance().StartCapture(args.GetString("AmpCaptureFile").ToCStr());
+    }
+
     AmpServer::GetInstance().OpenConnection();
 #endif
 
@@ -2554,17 +2583,35 @@ void FxPlayerAppBase::OnRenderThreadCreated()
     //tolParams.FillLowerScale = 0.5f; // Set thresholds for tessellation
     //tolParams.FillUpperScale = 2.0f;
     GetRenderThread()->SetToleranceParams(tolParams);
+
+    if (GetArgs().HasValue("MeshCacheFile"))
+    {
+        Ptr<MeshDiskCache> meshCache = *SF_NEW MeshDiskCache;
+        meshCache->LoadFile(GetArgs().GetString("MeshCacheFile"));
+        GetRenderThread()->SetMeshDiskCache(meshCache);
+    }
 }
 
 void FxPlayerAppBase::OnShutdown()
 {
 #ifdef SF_AMP_SERVER
+    AmpServer::GetInstance().StopCapture();
     AmpServer::GetInstance().CloseConnection();
 #endif
 
     pMovie = 0;
     pMovieDef = 0;
 
+#ifdef GFX_AS3_SUPPORT
+    Ptr<ASSupport> pAS3Support = mLoader.GetAS3Support();
+    if (pAS3Support)
+    {
+        AS3::OpCodeCache* opCodeCache = static_cast<AS3Support*>(pAS3Support.GetPtr())->GetOpCodeCache();
+        if (opCodeCache && opCodeCache->IsModified())
+            opCodeCache->SaveFile();
+    }
+#endif
+
     // If we started worker threads in the renderer we must end them here;
     // otherwise FinishAllThreads will lock up waiting indefinitely.
 #ifdef SF_ENABLE_THREADS
@@ -2959,6 +3006,8 @@ bool FxPlayerAppBase::LoadMovie( const String& filename)
     pactionControl->SetLogRootFilenames(args["LogRootFilenames"]->GetBool());
     pactionControl->SetLogChildFilenames(!args["NoLogChildFilnames"]->GetBool());
     pactionControl->SetLongFilenames(args["LogFilePath"]->GetBool());
+    pactionControl->SetPreTraceTime(args.GetInt("PreTraceTime"));
+    pactionControl->SetTimelineKeyframeMemory(args.GetInt("TimelineKeyframeMemory"));
 
 
     // For D3D, it is good to override image creator to keep image data,
@@ -2984,7 +3033,10 @@ bool FxPlayerAppBase::LoadMovie( const String& filename)
     // Tell the directory implementation of the  filename.
     ContentDir.SetCurrentFile(filenameStr);
 
-    pnewMovie = *pnewMovieDef->CreateInstance(MemoryParams(), false, pactionControl, pRenderThread);
+    MemoryParams memParams;
+    if (args.GetInt("GCSliceTime") > 0)
+        memParams.CollectionSliceTime = (unsigned)args.GetInt("GCSliceTime");
+    pnewMovie = *pnewMovieDef->CreateInstance(memParams, false, pactionControl, pRenderThread);
     if (!pnewMovie) 
     {
         fprintf(stderr, "Error: Failed to create movie instance\n");
@@ -0,0 +1,169 @@
+/**************************************************************************
+
+Filename    :   HeapBenchmark.cpp
+Content     :   Multithreaded allocation benchmark of the global heap.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+// Measures small block allocation throughput of the global heap with
+// several threads allocating at the same time, as the loader threads, the
+// AS3 VM and the render thread do. Each configuration is run with the
+// default root heap and with one created with Heap_ThreadCache; the thread
+// cache is only compiled in with SF_MEMORY_ENABLE_THREAD_CACHE.
+//
+// Every thread keeps a working set of live blocks, replacing a random one
+// on each step. The sizes mostly fall in the small size classes, with
+// a few larger blocks, and some blocks are handed over to be freed by
+// another thread, as happens with objects created by the loader.
+//
+// Usage: HeapBenchmark [operations per thread] [max threads]
+
+#include "Kernel/SF_Types.h"
+#include "Kernel/SF_System.h"
+#include "Kernel/SF_Threads.h"
+#include "Kernel/SF_Atomic.h"
+#include "Kernel/SF_Random.h"
+#include "Kernel/SF_Timer.h"
+#include "Kernel/SF_Memory.h"
+#include "Kernel/SF_HeapNew.h"
+#include "Kernel/SF_Alg.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Scaleform;
+
+enum
+{
+    WorkingSetSize  = 1024,
+    ExchangeSize    = 256
+};
+
+struct BenchmarkState
+{
+    unsigned        Operations;
+    AtomicPtr<void> Exchange[ExchangeSize];
+};
+
+struct WorkerData
+{
+    BenchmarkState* pState;
+    UInt32          Seed;
+};
+
+static UPInt RandomSize(Alg::Random::Generator& rnd)
+{
+    UInt32 r = rnd.NextRandom();
+    switch (r & 15)
+    {
+    case 0:  return 256 + (r >> 4) % 2048;
+    case 1:
+    case 2:  return 64 + (r >> 4) % 192;
+    default: return 8 + (r >> 4) % 56;
+    }
+}
+
+static int WorkerThreadFn(Thread*, void* h)
+{
+    WorkerData*     pdata  = (WorkerData*)h;
+    BenchmarkState* pstate = pdata->pState;
+    Alg::Random::Generator rnd;
+    rnd.SeedRandom(pdata->Seed);
+
+    void* blocks[WorkingSetSize];
+    memset(blocks, 0, sizeof(blocks));
+
+    for (unsigned i = 0; i < pstate->Operations; ++i)
+    {
+        UInt32 r     = rnd.NextRandom();
+        void*& block = blocks[r % WorkingSetSize];
+        if (block)
+        {
+            // Hand one block in eight over to another thread.
+            if (((r >> 16) & 7) == 0)
+                block = pstate->Exchange[(r >> 19) % ExchangeSize].Exchange_Sync(block);
+            if (block)
+                SF_FREE(block);
+        }
+        block = SF_ALLOC(RandomSize(rnd), Stat_Default_Mem);
+        *(UInt32*)block = r;
+    }
+
+    for (unsigned i = 0; i < WorkingSetSize; ++i)
+        if (blocks[i])
+            SF_FREE(blocks[i]);
+    return 0;
+}
+
+// Returns the number of operations per second for all threads.
+static double RunBenchmark(unsigned threadCount, unsigned operations, bool threadCache)
+{
+    MemoryHeap::RootHeapDesc desc;
+    if (threadCache)
+        desc.Flags |= MemoryHeap::Heap_ThreadCache;
+    System::Init(desc);
+
+    double opsPerSecond = 0;
+    {
+        BenchmarkState state;
+        state.Operations = operations;
+        for (unsigned i = 0; i < ExchangeSize; ++i)
+            state.Exchange[i] = 0;
+
+        WorkerData  data[64];
+        Ptr<Thread> threads[64];
+        UInt64      start = Timer::GetProfileTicks();
+        for (unsigned i = 0; i < threadCount; ++i)
+        {
+            data[i].pState = &state;
+            data[i].Seed   = 1234 + i;
+            threads[i] = *SF_NEW Thread(WorkerThreadFn, &data[i]);
+            threads[i]->Start();
+        }
+        for (unsigned i = 0; i < threadCount; ++i)
+            threads[i]->Wait();
+        UInt64 ticks = Timer::GetProfileTicks() - start;
+
+        for (unsigned i = 0; i < ExchangeSize; ++i)
+            if (state.Exchange[i])
+                SF_FREE(state.Exchange[i]);
+        opsPerSecond = (double)threadCount * operations * 1000000.0 / (double)Alg::Max<UInt64>(ticks, 1);
+    }
+
+    System::Destroy();
+    return opsPerSecond;
+}
+
+int main(int argc, char* argv[])
+{
+    int operations = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int maxThreads = (argc > 2) ? atoi(argv[2]) : 8;
+    if (operations <= 0 || maxThreads <= 0 || maxThreads > 64)
+    {
+        printf("Usage: HeapBenchmark [operations per thread] [max threads]\n");
+        return 1;
+    }
+
+    printf("Heap benchmark: %d operations per thread\n", operations);
+#ifndef SF_MEMORY_ENABLE_THREAD_CACHE
+    printf("  thread cache is not enabled (SF_MEMORY_ENABLE_THREAD_CACHE)\n");
+#endif
+    printf("  threads    locked heap    thread cache\n");
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        double locked = RunBenchmark((unsigned)threads, (unsigned)operations, false);
+        double cached = RunBenchmark((unsigned)threads, (unsigned)operations, true);
+        printf("  %7d  %8.2f Mop/s  %8.2f Mop/s (%.2fx)\n", threads,
+               locked / 1000000.0, cached / 1000000.0, cached / locked);
+    }
+    return 0;
+}
@@ -0,0 +1,525 @@
+/**************************************************************************
+
+Filename    :   AmpAnalyzer.cpp
+Content     :   Command-line analyzer of AMP capture files.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+// Reads a capture file written by AmpServer::StartCapture (GFxPlayer
+// -ampcap <fname>) and reports, over all of the captured frames:
+//  - frame time statistics and a histogram of frame times,
+//  - average CPU times per category, as in the AMP client graphs,
+//  - minimum, average and maximum of the memory counters, and the last
+//    detailed memory report if one was captured (GFxPlayer -mem),
+//  - the ActionScript and renderer functions taking the most time.
+// The report is printed as text, or as JSON with -json, so that it can be
+// compared between automated runs.
+//
+// Usage: AmpAnalyzer [-json] [-top <count>] [-bucket <msec>] <capture file>
+
+#include "Kernel/SF_Types.h"
+#include "Kernel/SF_System.h"
+#include "Kernel/SF_Array.h"
+#include "Kernel/SF_Hash.h"
+#include "Kernel/SF_Alg.h"
+#include "Kernel/SF_String.h"
+#include "Kernel/SF_MemItem.h"
+#include "Kernel/SF_HeapNew.h"
+#include "GFx/AMP/Amp_Capture.h"
+#include "GFx/AMP/Amp_ProfileFrame.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace Scaleform;
+using namespace Scaleform::GFx::AMP;
+
+struct FrameField
+{
+    const char*             Name;
+    UInt32 ProfileFrame::*  Field;
+};
+
+// CPU times are in microseconds
+static const FrameField CpuFields[] =
+{
+    { "advance",        &ProfileFrame::AdvanceTime },
+    { "action",         &ProfileFrame::ActionTime },
+    { "timeline",       &ProfileFrame::TimelineTime },
+    { "input",          &ProfileFrame::InputTime },
+    { "gcCollect",      &ProfileFrame::GcCollectTime },
+    { "display",        &ProfileFrame::DisplayTime },
+    { "present",        &ProfileFrame::PresentTime },
+    { "tessellation",   &ProfileFrame::TesselationTime },
+    { "gradientGen",    &ProfileFrame::GradientGenTime },
+    { "user",           &ProfileFrame::UserTime },
+    { NULL, NULL }
+};
+
+static const FrameField RenderFields[] =
+{
+    { "drawPrimitives", &ProfileFrame::DrawPrimitiveCount },
+    { "triangles",      &ProfileFrame::TriangleCount },
+    { "meshes",         &ProfileFrame::MeshCount },
+    { "masks",          &ProfileFrame::MaskCount },
+    { "filters",        &ProfileFrame::FilterCount },
+    { "meshThrashing",  &ProfileFrame::MeshThrashing },
+    { "rasterizedGlyphs", &ProfileFrame::RasterizedGlyphCount },
+    { "fontMisses",     &ProfileFrame::FontMisses },
+    { NULL, NULL }
+};
+
+// Memory counters are in bytes
+static const FrameField MemoryFields[] =
+{
+    { "total",          &ProfileFrame::TotalMemory },
+    { "image",          &ProfileFrame::ImageMemory },
+    { "movieData",      &ProfileFrame::MovieDataMemory },
+    { "movieView",      &ProfileFrame::MovieViewMemory },
+    { "meshCache",      &ProfileFrame::MeshCacheMemory },
+    { "fontCache",      &ProfileFrame::FontCacheMemory },
+    { "video",          &ProfileFrame::VideoMemory },
+    { "sound",          &ProfileFrame::SoundMemory },
+    { "other",          &ProfileFrame::OtherMemory },
+    { NULL, NULL }
+};
+
+struct FieldStats
+{
+    UInt64  Sum;
+    UInt32  Min;
+    UInt32  Max;
+
+    FieldStats() : Sum(0), Min(0xFFFFFFFF), Max(0) { }
+
+    void Add(UInt32 v)
+    {
+        Sum += v;
+        Min = Alg::Min(Min, v);
+        Max = Alg::Max(Max, v);
+    }
+};
+
+struct FunctionTotal
+{
+    String  Name;
+    UInt64  TotalTime;      // microseconds
+    UInt64  TimesCalled;
+};
+
+typedef Hash<UInt64, FunctionTotal> FunctionTotalHash;
+
+struct FunctionEntry
+{
+    UInt64                  FunctionId;
+    const FunctionTotal*    pTotal;
+
+    bool operator<(const FunctionEntry& other) const
+    {
+        return pTotal->TotalTime > other.pTotal->TotalTime;
+    }
+};
+
+class CaptureAnalysis
+{
+public:
+    CaptureAnalysis() : FrameCount(0), LogCount(0), FirstTimeStamp(0), LastTimeStamp(0) { }
+
+    void AddFrame(const ProfileFrame& frame);
+    void AddLog()   { ++LogCount; }
+
+    void PrintText(unsigned topCount, unsigned bucketMs) const;
+    void PrintJson(unsigned topCount, unsigned bucketMs) const;
+
+private:
+    void AddFunctions(FunctionTotalHash* totals, const MovieFunctionStats& stats);
+
+    void GetSortedFunctions(Array<FunctionEntry>* entries, const FunctionTotalHash& totals) const;
+    void GetHistogram(Array<UInt32>* buckets, unsigned bucketMs) const;
+    UInt32 GetPercentile(const Array<UInt32>& sorted, unsigned percent) const;
+
+    UInt32              FrameCount;
+    UInt32              LogCount;
+    UInt64              FirstTimeStamp;
+    UInt64              LastTimeStamp;
+    Array<UInt32>       FrameTimes;     // microseconds between frames
+    FieldStats          Cpu[sizeof(CpuFields) / sizeof(CpuFields[0])];
+    FieldStats          Render[sizeof(RenderFields) / sizeof(RenderFields[0])];
+    FieldStats          Memory[sizeof(MemoryFields) / sizeof(MemoryFields[0])];
+    FunctionTotalHash   ScriptFunctions;
+    FunctionTotalHash   RenderFunctions;
+    Ptr<MemItem>        LastMemoryReport;
+};
+
+void CaptureAnalysis::AddFunctions(FunctionTotalHash* totals, const MovieFunctionStats& stats)
+{
+    for (UPInt i = 0; i < stats.FunctionTimings.GetSize(); ++i)
+    {
+        const MovieFunctionStats::FuncStats& timing = stats.FunctionTimings[i];
+        FunctionTotal* total = totals->Get(timing.FunctionId);
+        if (!total)
+        {
+            FunctionTotal newTotal;
+            FunctionDescMap::ConstIterator descIt = stats.FunctionInfo.Find(timing.FunctionId);
+            if (descIt != stats.FunctionInfo.End())
+            {
+                newTotal.Name = descIt->Second->Name;
+            }
+            newTotal.TotalTime = 0;
+            newTotal.TimesCalled = 0;
+            totals->Add(timing.FunctionId, newTotal);
+            total = totals->Get(timing.FunctionId);
+        }
+        total->TotalTime += timing.TotalTime;
+        total->TimesCalled += timing.TimesCalled;
+    }
+}
+
+void CaptureAnalysis::AddFrame(const ProfileFrame& frame)
+{
+    if (FrameCount == 0)
+    {
+        FirstTimeStamp = frame.TimeStamp;
+    }
+    else if (frame.TimeStamp > LastTimeStamp)
+    {
+        FrameTimes.PushBack(static_cast<UInt32>(frame.TimeStamp - LastTimeStamp));
+    }
+    LastTimeStamp = frame.TimeStamp;
+    ++FrameCount;
+
+    unsigned i;
+    for (i = 0; CpuFields[i].Name; ++i)
+        Cpu[i].Add(frame.*CpuFields[i].Field);
+    for (i = 0; RenderFields[i].Name; ++i)
+        Render[i].Add(frame.*RenderFields[i].Field);
+    for (i = 0; MemoryFields[i].Name; ++i)
+        Memory[i].Add(frame.*MemoryFields[i].Field);
+
+    // Function stats come aggregated or as call trees, depending on
+    // the function aggregation state of the server
+    for (UPInt j = 0; j < frame.MovieStats.GetSize(); ++j)
+    {
+        const MovieProfile* movie = frame.MovieStats[j];
+        if (movie->FunctionStats && movie->FunctionStats->FunctionTimings.GetSize() > 0)
+        {
+            AddFunctions(&ScriptFunctions, *movie->FunctionStats);
+        }
+        else if (movie->FunctionTreeStats && !movie->FunctionTreeStats->IsEmpty())
+        {
+            Ptr<MovieFunctionStats> stats = *movie->FunctionTreeStats->Accumulate(true);
+            AddFunctions(&ScriptFunctions, *stats);
+        }
+    }
+    if (frame.DisplayStats && frame.DisplayStats->FunctionTimings.GetSize() > 0)
+    {
+        AddFunctions(&RenderFunctions, *frame.DisplayStats);
+    }
+    else if (frame.DisplayFunctionStats && !frame.DisplayFunctionStats->IsEmpty())
+    {
+        Ptr<MovieFunctionStats> stats = *frame.DisplayFunctionStats->Accumulate(false);
+        AddFunctions(&RenderFunctions, *stats);
+    }
+
+    if (frame.MemoryByStatId && frame.MemoryByStatId->Children.GetSize() > 0)
+    {
+        LastMemoryReport = frame.MemoryByStatId;
+    }
+}
+
+void CaptureAnalysis::GetSortedFunctions(Array<FunctionEntry>* entries, const FunctionTotalHash& totals) const
+{
+    for (FunctionTotalHash::ConstIterator it = totals.Begin(); it != totals.End(); ++it)
+    {
+        FunctionEntry entry;
+        entry.FunctionId = it->First;
+        entry.pTotal = &it->Second;
+        entries->PushBack(entry);
+    }
+    Alg::QuickSort(*entries);
+}
+
+void CaptureAnalysis::GetHistogram(Array<UInt32>* buckets, unsigned bucketMs) const
+{
+    // Fixed number of buckets, the last one collects all longer frames
+    enum { BucketCount = 32 };
+    buckets->Resize(BucketCount);
+    memset(&(*buckets)[0], 0, BucketCount * sizeof(UInt32));
+    for (UPInt i = 0; i < FrameTimes.GetSize(); ++i)
+    {
+        UPInt bucket = FrameTimes[i] / (bucketMs * 1000);
+        ++(*buckets)[Alg::Min(bucket, UPInt(BucketCount - 1))];
+    }
+}
+
+UInt32 CaptureAnalysis::GetPercentile(const Array<UInt32>& sorted, unsigned percent) const
+{
+    if (sorted.GetSize() == 0)
+        return 0;
+    UPInt index = (sorted.GetSize() - 1) * percent / 100;
+    return sorted[index];
+}
+
+void CaptureAnalysis::PrintText(unsigned topCount, unsigned bucketMs) const
+{
+    Array<UInt32> sorted(FrameTimes);
+    Alg::QuickSort(sorted);
+
+    double seconds = (LastTimeStamp - FirstTimeStamp) / 1000000.0;
+    printf("Frames: %u over %.2f s", FrameCount, seconds);
+    if (seconds > 0)
+        printf(" (%.1f fps)", (FrameCount - 1) / seconds);
+    printf(", %u log messages\n\n", LogCount);
+    if (FrameCount == 0)
+        return;
+
+    printf("Frame time (ms): p50 %.2f  p95 %.2f  p99 %.2f  max %.2f\n",
+           GetPercentile(sorted, 50) / 1000.0, GetPercentile(sorted, 95) / 1000.0,
+           GetPercentile(sorted, 99) / 1000.0, GetPercentile(sorted, 100) / 1000.0);
+
+    Array<UInt32> buckets;
+    GetHistogram(&buckets, bucketMs);
+    UInt32 maxBucket = 1;
+    UPInt i;
+    for (i = 0; i < buckets.GetSize(); ++i)
+        maxBucket = Alg::Max(maxBucket, buckets[i]);
+    for (i = 0; i < buckets.GetSize(); ++i)
+    {
+        if (buckets[i] == 0)
+            continue;
+        char bar[41];
+        unsigned barLength = static_cast<unsigned>(UInt64(buckets[i]) * 40 / maxBucket);
+        memset(bar, '#', barLength);
+        bar[barLength] = 0;
+        if (i + 1 < buckets.GetSize())
+            printf("  %4u-%-4u ms %8u %s\n", unsigned(i * bucketMs), unsigned((i + 1) * bucketMs), buckets[i], bar);
+        else
+            printf("  %4u+     ms %8u %s\n", unsigned(i * bucketMs), buckets[i], bar);
+    }
+
+    printf("\nCPU time per frame (ms):      avg       max\n");
+    for (i = 0; CpuFields[i].Name; ++i)
+        printf("  %-20s %9.3f %9.3f\n", CpuFields[i].Name,
+               double(Cpu[i].Sum) / FrameCount / 1000.0, Cpu[i].Max / 1000.0);
+
+    printf("\nRendering per frame:           avg       max\n");
+    for (i = 0; RenderFields[i].Name; ++i)
+        printf("  %-20s %9.1f %9u\n", RenderFields[i].Name,
+               double(Render[i].Sum) / FrameCount, Render[i].Max);
+
+    printf("\nMemory (KB):                   min       avg       max\n");
+    for (i = 0; MemoryFields[i].Name; ++i)
+        printf("  %-20s %9u %9.0f %9u\n", MemoryFields[i].Name, Memory[i].Min / 1024,
+               double(Memory[i].Sum) / FrameCount / 1024.0, Memory[i].Max / 1024);
+
+    const FunctionTotalHash* totals[2] = { &ScriptFunctions, &RenderFunctions };
+    const char* titles[2] = { "ActionScript functions", "Renderer functions" };
+    for (unsigned t = 0; t < 2; ++t)
+    {
+        Array<FunctionEntry> entries;
+        GetSortedFunctions(&entries, *totals[t]);
+        if (entries.GetSize() == 0)
+            continue;
+        printf("\n%s:         total ms   ms/frame      calls\n", titles[t]);
+        for (i = 0; i < entries.GetSize() && i < topCount; ++i)
+        {
+            const FunctionTotal& total = *entries[i].pTotal;
+            printf("  %-30s %10.2f %10.3f %10llu\n",
+                   total.Name.IsEmpty() ? "<unknown>" : total.Name.ToCStr(),
+                   total.TotalTime / 1000.0, double(total.TotalTime) / FrameCount / 1000.0,
+                   (unsigned long long)total.TimesCalled);
+        }
+    }
+
+    if (LastMemoryReport)
+    {
+        StringBuffer report;
+        LastMemoryReport->ToString(&report);
+        printf("\nLast memory report:\n%s\n", report.ToCStr());
+    }
+}
+
+static void PrintJsonString(const char* str)
+{
+    putchar('"');
+    for (; *str; ++str)
+    {
+        unsigned char c = static_cast<unsigned char>(*str);
+        if (c == '"' || c == '\\')
+            printf("\\%c", c);
+        else if (c < 0x20)
+            printf("\\u%04x", c);
+        else
+            putchar(c);
+    }
+    putchar('"');
+}
+
+static void PrintJsonMemItem(const MemItem* item, unsigned indent)
+{
+    printf("%*s{ \"name\": ", indent, "");
+    PrintJsonString(item->Name.ToCStr());
+    if (item->HasValue)
+        printf(", \"bytes\": %u", item->Value);
+    if (item->Children.GetSize() > 0)
+    {
+        printf(", \"children\": [\n");
+        for (UPInt i = 0; i < item->Children.GetSize(); ++i)
+        {
+            PrintJsonMemItem(item->Children[i], indent + 2);
+            printf(i + 1 < item->Children.GetSize() ? ",\n" : "\n");
+        }
+        printf("%*s]", indent, "");
+    }
+    printf(" }");
+}
+
+void CaptureAnalysis::PrintJson(unsigned topCount, unsigned bucketMs) const
+{
+    Array<UInt32> sorted(FrameTimes);
+    Alg::QuickSort(sorted);
+
+    printf("{\n");
+    printf("  \"frames\": %u,\n", FrameCount);
+    printf("  \"durationUs\": %llu,\n", (unsigned long long)(LastTimeStamp - FirstTimeStamp));
+    printf("  \"logMessages\": %u,\n", LogCount);
+    printf("  \"frameTimeUs\": { \"p50\": %u, \"p95\": %u, \"p99\": %u, \"max\": %u },\n",
+           GetPercentile(sorted, 50), GetPercentile(sorted, 95),
+           GetPercentile(sorted, 99), GetPercentile(sorted, 100));
+
+    Array<UInt32> buckets;
+    GetHistogram(&buckets, bucketMs);
+    printf("  \"frameTimeHistogram\": { \"bucketMs\": %u, \"counts\": [", bucketMs);
+    UPInt i;
+    for (i = 0; i < buckets.GetSize(); ++i)
+        printf(i ? ", %u" : "%u", buckets[i]);
+    printf("] },\n");
+
+    UInt32 frames = Alg::Max(FrameCount, 1u);
+    printf("  \"cpuUs\": {\n");
+    for (i = 0; CpuFields[i].Name; ++i)
+        printf("    \"%s\": { \"avg\": %.1f, \"max\": %u }%s\n", CpuFields[i].Name,
+               double(Cpu[i].Sum) / frames, Cpu[i].Max, CpuFields[i + 1].Name ? "," : "");
+    printf("  },\n");
+
+    printf("  \"rendering\": {\n");
+    for (i = 0; RenderFields[i].Name; ++i)
+        printf("    \"%s\": { \"avg\": %.1f, \"max\": %u }%s\n", RenderFields[i].Name,
+               double(Render[i].Sum) / frames, Render[i].Max, RenderFields[i + 1].Name ? "," : "");
+    printf("  },\n");
+
+    printf("  \"memoryBytes\": {\n");
+    for (i = 0; MemoryFields[i].Name; ++i)
+        printf("    \"%s\": { \"min\": %u, \"avg\": %.0f, \"max\": %u }%s\n", MemoryFields[i].Name,
+               FrameCount ? Memory[i].Min : 0, double(Memory[i].Sum) / frames, Memory[i].Max,
+               MemoryFields[i + 1].Name ? "," : "");
+    printf("  },\n");
+
+    const FunctionTotalHash* totals[2] = { &ScriptFunctions, &RenderFunctions };
+    const char* keys[2] = { "scriptFunctions", "renderFunctions" };
+    for (unsigned t = 0; t < 2; ++t)
+    {
+        Array<FunctionEntry> entries;
+        GetSortedFunctions(&entries, *totals[t]);
+        printf("  \"%s\": [\n", keys[t]);
+        UPInt count = Alg::Min(entries.GetSize(), UPInt(topCount));
+        for (i = 0; i < count; ++i)
+        {
+            const FunctionTotal& total = *entries[i].pTotal;
+            printf("    { \"name\": ");
+            PrintJsonString(total.Name.ToCStr());
+            printf(", \"totalUs\": %llu, \"calls\": %llu }%s\n",
+                   (unsigned long long)total.TotalTime, (unsigned long long)total.TimesCalled,
+                   (i + 1 < count) ? "," : "");
+        }
+        printf("  ]%s\n", (t == 0 || LastMemoryReport) ? "," : "");
+    }
+
+    if (LastMemoryReport)
+    {
+        printf("  \"memoryReport\":\n");
+        PrintJsonMemItem(LastMemoryReport, 4);
+        printf("\n");
+    }
+    printf("}\n");
+}
+
+static int Analyze(const char* path, bool json, unsigned topCount, unsigned bucketMs)
+{
+    Ptr<CaptureReader> reader = *SF_NEW CaptureReader();
+    if (!reader->Open(path))
+    {
+        fprintf(stderr, "AmpAnalyzer: '%s' is not an AMP capture file\n", path);
+        return 1;
+    }
+
+    CaptureAnalysis analysis;
+    Message* msg;
+    while ((msg = reader->ReadMessage()) != NULL)
+    {
+        if (msg->GetMessageName() == MessageProfileFrame::GetStaticTypeName())
+        {
+            const ProfileFrame* frame = static_cast<MessageProfileFrame*>(msg)->GetFrameInfo();
+            if (frame)
+                analysis.AddFrame(*frame);
+        }
+        else if (msg->GetMessageName() == MessageLog::GetStaticTypeName())
+        {
+            analysis.AddLog();
+        }
+        msg->Release();
+    }
+    if (reader->IsTruncated())
+    {
+        // A capture of a process that crashed or was killed; report what
+        // was written before that.
+        fprintf(stderr, "AmpAnalyzer: '%s' is truncated\n", path);
+    }
+
+    if (json)
+        analysis.PrintJson(topCount, bucketMs);
+    else
+        analysis.PrintText(topCount, bucketMs);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    bool        json = false;
+    unsigned    topCount = 20;
+    unsigned    bucketMs = 2;
+    const char* path = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-json"))
+            json = true;
+        else if (!strcmp(argv[i], "-top") && i + 1 < argc)
+            topCount = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-bucket") && i + 1 < argc)
+            bucketMs = (unsigned)atoi(argv[++i]);
+        else if (argv[i][0] != '-' && !path)
+            path = argv[i];
+        else
+            path = NULL, argc = 0;
+    }
+    if (!path || bucketMs == 0)
+    {
+        printf("Usage: AmpAnalyzer [-json] [-top <count>] [-bucket <msec>] <capture file>\n");
+        return 1;
+    }
+
+    System::Init();
+    int result = Analyze(path, json, topCount, bucketMs);
+    System::Destroy();
+    return result;
+}
@@ -126,6 +126,10 @@ otherwise accompanies this software in either electronic or hard copy form.
 // Disabling saves roughly 20k in release build.
 #define SF_ENABLE_ZLIB
 
+// Enable the built-in LZMA decoder and LzmaFile class.
+// When disabled, LZMA compressed (ZWS and ZFX) files will no longer load.
+#define SF_ENABLE_LZMA
+
 // If disabled, SWF PNG image loading is not functioning.
 // Note: beside the uncommenting the line below, it is necessary
 // to provide the path and the library name for the linker.
@@ -193,6 +197,12 @@ otherwise accompanies this software in either electronic or hard copy form.
 // See MemoryHeap::HeapTracer for details.
 //#define SF_MEMORY_TRACE_ALL
 
+// Enable per-thread caches of small blocks for a root heap created with the
+// MemoryHeap::Heap_ThreadCache flag. Reduces the heap lock contention when
+// several threads allocate from the global heap. Uses compiler thread local
+// storage; it has no effect with debug info, memset or trace enabled.
+//#define SF_MEMORY_ENABLE_THREAD_CACHE
+
 
 
 
@@ -552,6 +562,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 #ifdef SF_BUILD_LITE
     #undef SF_ENABLE_LIBJPEG
     #undef SF_ENABLE_ZLIB
+    #undef SF_ENABLE_LZMA
     #undef SF_ENABLE_LIBPNG
 
     #undef SF_ENABLE_STATS
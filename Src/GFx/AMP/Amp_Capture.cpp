@@ -0,0 +1,243 @@
+/**************************************************************************
+
+Filename    :   Amp_Capture.cpp
+Content     :   AMP message capture to file, for offline analysis
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Amp_Capture.h"
+#include "Amp_Stream.h"
+#include "Amp_MessageRegistry.h"
+#include "Kernel/SF_SysFile.h"
+#include "Kernel/SF_Alg.h"
+#include "Kernel/SF_HeapNew.h"
+
+namespace Scaleform {
+namespace GFx {
+namespace AMP {
+
+static const UByte CaptureFile_Magic[4] = { 'S', 'F', 'A', 'C' };
+
+CaptureWriter::CaptureWriter() : MessageCount(0)
+{
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    Close();
+}
+
+bool CaptureWriter::Open(const char* path)
+{
+    Close();
+    pFile = *SF_HEAP_AUTO_NEW(this) SysFile(path,
+        File::Open_Write | File::Open_Truncate | File::Open_Create | File::Open_Buffered);
+    if (!pFile->IsValid())
+    {
+        pFile = NULL;
+        return false;
+    }
+    pFile->Write(CaptureFile_Magic, 4);
+    pFile->WriteUInt32(CaptureFile_Version);
+    MessageCount = 0;
+    return true;
+}
+
+void CaptureWriter::Close()
+{
+    if (pFile)
+    {
+        pFile->Close();
+        pFile = NULL;
+    }
+}
+
+bool CaptureWriter::WriteMessage(const Message* msg)
+{
+    if (!pFile)
+    {
+        return false;
+    }
+
+    // Same format as ThreadMgr::CompressLoop sends over the socket
+    Ptr<AmpStream> stream = *SF_HEAP_AUTO_NEW(this) AmpStream();
+    Array<UByte> compressedData;
+    if (msg->Compress(compressedData))
+    {
+        Ptr<MessageCompressed> msgCompressed = *SF_HEAP_AUTO_NEW(this) MessageCompressed();
+        msgCompressed->SetVersion(msg->GetVersion());
+        msgCompressed->AddCompressedData(&compressedData[0], compressedData.GetSize());
+        msgCompressed->Write(*stream);
+    }
+    else
+    {
+        msg->Write(*stream);
+    }
+
+    int size = static_cast<int>(stream->GetBufferSize());
+    if (pFile->Write(stream->GetBuffer(), size) != size)
+    {
+        // Out of disk space, stop capturing
+        Close();
+        return false;
+    }
+    ++MessageCount;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+CaptureReader::CaptureReader() : Truncated(false)
+{
+    // Messages sent by the server
+    Registry = *SF_HEAP_AUTO_NEW(this) MessageTypeRegistry();
+    Registry->AddMessageType<MessageHeartbeat>(NULL);
+    Registry->AddMessageType<MessageCompressed>(NULL);
+    Registry->AddMessageType<MessageLog>(NULL);
+    Registry->AddMessageType<MessageCurrentState>(NULL);
+    Registry->AddMessageType<MessageProfileFrame>(NULL);
+    Registry->AddMessageType<MessageSwdFile>(NULL);
+    Registry->AddMessageType<MessageSourceFile>(NULL);
+    Registry->AddMessageType<MessageObjectsReport>(NULL);
+    Registry->AddMessageType<MessageAppControl>(NULL);
+    Registry->AddMessageType<MessageImageData>(NULL);
+    Registry->AddMessageType<MessageFontData>(NULL);
+}
+
+CaptureReader::~CaptureReader()
+{
+}
+
+bool CaptureReader::Open(const char* path)
+{
+    Close();
+    Truncated = false;
+    pFile = *SF_HEAP_AUTO_NEW(this) SysFile(path, File::Open_Read | File::Open_Buffered);
+    if (!pFile->IsValid())
+    {
+        pFile = NULL;
+        return false;
+    }
+
+    UByte magic[4];
+    if (pFile->Read(magic, 4) != 4 || memcmp(magic, CaptureFile_Magic, 4) != 0 ||
+        pFile->ReadUInt32() > CaptureFile_Version)
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void CaptureReader::Close()
+{
+    if (pFile)
+    {
+        pFile->Close();
+        pFile = NULL;
+    }
+}
+
+Message* CaptureReader::ReadMessage()
+{
+    while (pFile)
+    {
+        int available = pFile->BytesAvailable();
+        if (available < static_cast<int>(sizeof(UInt32)))
+        {
+            Truncated = (available > 0);
+            Close();
+            return NULL;
+        }
+
+        // The stored size includes the size field itself
+        UInt32 size = pFile->ReadUInt32();
+        UInt32 dataSize = size - sizeof(UInt32);
+        if (size <= sizeof(UInt32) || dataSize > static_cast<UInt32>(pFile->BytesAvailable()))
+        {
+            Truncated = true;
+            Close();
+            return NULL;
+        }
+
+        ArrayLH<UByte> buffer;
+        buffer.Resize(size);
+        UInt32 sizeLE = Alg::ByteUtil::SystemToLE(size);
+        memcpy(&buffer[0], &sizeLE, sizeof(UInt32));
+        if (pFile->Read(&buffer[sizeof(UInt32)], static_cast<int>(dataSize)) != static_cast<int>(dataSize))
+        {
+            Truncated = true;
+            Close();
+            return NULL;
+        }
+
+        Ptr<AmpStream> stream = *SF_HEAP_AUTO_NEW(this) AmpStream(buffer.GetDataPtr(), size);
+        Message* msg = createMessage(*stream);
+        if (msg == NULL)
+        {
+            continue;
+        }
+
+        Array<UByte> uncompressedData;
+        if (msg->Uncompress(uncompressedData))
+        {
+            msg->Release();
+            Ptr<AmpStream> ampStream = *SF_HEAP_AUTO_NEW(this) AmpStream(&uncompressedData[0], uncompressedData.GetSize());
+            msg = createMessage(*ampStream);
+            if (msg == NULL)
+            {
+                continue;
+            }
+        }
+        return msg;
+    }
+    return NULL;
+}
+
+// Same as ThreadMgr::CreateAndReadMessage
+Message* CaptureReader::createMessage(File& str) const
+{
+    UByte msgType = str.ReadUByte();
+    String msgTypeName;
+    if (msgType == 0)
+    {
+        Message::ReadString(str, &msgTypeName);
+    }
+    else // support of older message versions
+    {
+        msgTypeName = Message::MsgTypeToMsgName(msgType);
+    }
+
+    const BaseMessageTypeDescriptor* descriptor = Registry->GetMessageTypeDescriptor(msgTypeName);
+    if (descriptor == NULL)
+    {
+        return NULL; // The type is unknown
+    }
+
+    UInt32 msgVersion = str.ReadUInt32();
+    if (msgVersion > Message::GetLatestVersion())
+    {
+        return NULL; //The version is greater than the known ones
+    }
+
+    str.SeekToBegin();
+
+    Message* message = descriptor->CreateMessage();
+    if (message != NULL)
+    {
+        message->Read(str);
+    }
+    return message;
+}
+
+} // namespace AMP
+} // namespace GFx
+} // namespace Scaleform
@@ -0,0 +1,89 @@
+/**************************************************************************
+
+Filename    :   Amp_Capture.h
+Content     :   AMP message capture to file, for offline analysis
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INCLUDE_GFX_AMP_CAPTURE_H
+#define INCLUDE_GFX_AMP_CAPTURE_H
+
+#include "Amp_Interfaces.h"
+#include "Kernel/SF_File.h"
+
+namespace Scaleform {
+namespace GFx {
+namespace AMP {
+
+class MessageTypeRegistry;
+
+// A capture file holds the messages that the AMP server would send to the
+// client, so that titles can be profiled where the client can't connect,
+// and the results analyzed later by a tool.
+//
+// File layout, header values are little-endian:
+//   "SFAC", Version, then the messages in the same format as they are sent
+//   over the socket: each one is an AmpStream buffer starting with its size.
+// Messages are wrapped into MessageCompressed when zlib is available.
+
+enum { CaptureFile_Version = 1 };
+
+class CaptureWriter : public RefCountBase<CaptureWriter, StatAmp_Server>
+{
+public:
+    CaptureWriter();
+    ~CaptureWriter();
+
+    // Creates the file, replacing an existing one.
+    bool            Open(const char* path);
+    void            Close();
+    bool            IsOpen() const                  { return pFile != NULL; }
+
+    // Writes the message; the caller keeps ownership.
+    bool            WriteMessage(const Message* msg);
+
+    UInt32          GetMessageCount() const         { return MessageCount; }
+
+private:
+    Ptr<File>       pFile;
+    UInt32          MessageCount;
+};
+
+class CaptureReader : public RefCountBase<CaptureReader, StatAmp_Message>
+{
+public:
+    CaptureReader();
+    ~CaptureReader();
+
+    // Returns false if the file doesn't exist or is not a capture file.
+    bool            Open(const char* path);
+    void            Close();
+
+    // Returns the next message, already uncompressed, or NULL at the end
+    // of the file. Messages of unknown types are skipped.
+    Message*        ReadMessage();
+
+    // True if the file ended in the middle of a message.
+    bool            IsTruncated() const             { return Truncated; }
+
+private:
+    Message*        createMessage(File& str) const;
+
+    Ptr<File>                   pFile;
+    Ptr<MessageTypeRegistry>    Registry;
+    bool                        Truncated;
+};
+
+} // namespace AMP
+} // namespace GFx
+} // namespace Scaleform
+
+#endif
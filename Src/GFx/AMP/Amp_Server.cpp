@@ -30,6 +30,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "Amp_Stream.h"
 #include "Amp_MessageRegistry.h"
 #include "Amp_ObjectsLog.h"
+#include "Amp_Capture.h"
 #include "Kernel/SF_MsgFormat.h"
 #include "Kernel/SF_MemItem.h"
 #include "Render/ImageFiles/PNG_ImageFile.h"
@@ -405,6 +406,11 @@ bool Server::GetProfilingState() const
     {
         return true;
     }
+
+    if (IsCapturing())
+    {
+        return true;
+    }
     
     if (!IsEnabled())
     {
@@ -476,6 +482,43 @@ void Server::ToggleInternalStatRecording()
     }
 }
 
+// Starts writing all messages sent by the server to a file
+// Used for profiling without an AMP client, such as in automated runs
+bool Server::StartCapture(const char* filename)
+{
+    Ptr<CaptureWriter> capture = *SF_HEAP_AUTO_NEW(this) CaptureWriter();
+    if (!capture->Open(filename))
+    {
+        return false;
+    }
+    {
+        Lock::Locker lock(&CaptureLock);
+        Capture = capture;
+    }
+
+    // The state and caps are normally sent on connection
+    SendCurrentState();
+    SendAppControlCaps();
+    UpdateProfilingState();
+    return true;
+}
+
+// Stops the capture and closes the file
+void Server::StopCapture()
+{
+    {
+        Lock::Locker lock(&CaptureLock);
+        Capture = NULL;
+    }
+    UpdateProfilingState();
+}
+
+bool Server::IsCapturing() const
+{
+    Lock::Locker lock(&CaptureLock);
+    return Capture && Capture->IsOpen();
+}
+
 // The server can wait for a connection before proceeding
 // This is useful when you want to profile the startup
 void Server::SetConnectionWaitTime(unsigned waitTimeMilliseconds)
@@ -594,6 +637,13 @@ bool Server::HandleNextMessage()
 // Convenience method that wrapps the connection lock and NULL check
 void Server::SendMessage(Message* msg)
 {
+    {
+        Lock::Locker lock(&CaptureLock);
+        if (Capture)
+        {
+            Capture->WriteMessage(msg);
+        }
+    }
     SocketThreadMgr->SendAmpMessage(msg);
 }
 
@@ -1302,6 +1352,7 @@ Server::Server() :
 // Destructor
 Server::~Server()
 {
+    Capture = NULL;
     SocketThreadMgr = NULL;
     ReportHeap->Release();
 }
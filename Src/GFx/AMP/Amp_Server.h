@@ -38,6 +38,7 @@ class ViewStats;
 class SocketImplFactory;
 class AmpStream;
 class ObjectsLog;
+class CaptureWriter;
 
 // AMP server states
 enum ServerStateType
@@ -96,6 +97,9 @@ public:
     virtual void    SetMemReports(bool memReports, bool lock);
     virtual void    SetAppControlCaps(const MessageAppControl* caps);
     virtual void    ToggleInternalStatRecording();
+    virtual bool    StartCapture(const char* filename);
+    virtual void    StopCapture();
+    virtual bool    IsCapturing() const;
 
     // Configuration options
     virtual void    SetListeningPort(UInt32 port);
@@ -287,6 +291,10 @@ private:
     ServerRecordingState    RecordingState;
     mutable Lock            RecordingStateLock;
 
+    // Capture of sent messages to file
+    Ptr<CaptureWriter>      Capture;
+    mutable Lock            CaptureLock;
+
     // private constructor 
     // Create singleton with Server::Init
     Server();
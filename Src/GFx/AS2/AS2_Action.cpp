@@ -1444,9 +1444,26 @@ void GlobalContext::PreClean(bool preserveBuiltinProps)
     RegisteredClasses.Clear();
     BuiltinClassesRegistry.Clear();
     Prototypes.Clear();
+    ActionBuffers.Clear();
     DetachMovieRoot();
 }
 
+ActionBuffer* GlobalContext::GetActionBuffer(ActionBufferData* pbufferData)
+{
+    SF_ASSERT(pbufferData);
+    Ptr<ActionBuffer>* ppbuffer = ActionBuffers.Get(pbufferData);
+    if (ppbuffer)
+        return *ppbuffer;
+
+    if (ActionBuffers.GetSize() >= MaxCachedActionBuffers)
+        ActionBuffers.Clear();
+
+    ASStringContext   sc(this, 8);
+    Ptr<ActionBuffer> pbuffer = *SF_HEAP_NEW(pHeap) ActionBuffer(&sc, pbufferData);
+    ActionBuffers.Add(pbufferData, pbuffer);
+    return pbuffer;
+}
+
 FunctionObject* GlobalContext::ResolveFunctionName(const ASString& functionName) 
 {
     // not found; lets try to resolve
@@ -1750,10 +1767,236 @@ void    ActionBufferData::Read(StreamContext* psc, unsigned eventLength)
     SF_ASSERT(pBuffer[BufferLen-1] == 0);
 }
 
+const ActionBufferDecoded* ActionBufferData::GetDecoded() const
+{
+    ActionBufferDecoded* pdecoded = pDecoded;
+    if (!pdecoded && !IsNull())
+    {
+        // Decoded data shares the buffer heap, since it has the same lifetime.
+        pdecoded = SF_HEAP_AUTO_NEW(pBuffer) ActionBufferDecoded;
+        pdecoded->Decode(pBuffer, BufferLen);
+
+        // Another thread may have decoded the same buffer concurrently; 
+        // keep the first published result.
+        if (!pDecoded.CompareAndSet_Sync(0, pdecoded))
+        {
+            delete pdecoded;
+            pdecoded = pDecoded;
+        }
+    }
+    return pdecoded;
+}
+
+// ***** ActionBufferDecoded implementation
+
+unsigned ActionBufferDecoded::DecodePushOperand(const UByte* pdata, unsigned dataOffset, 
+                                                unsigned dataSize, PushOperand* pop)
+{
+    // Operand sizes, including the type byte; 0 for strings.
+    static const UByte sizes[10] = { 0, 5, 1, 1, 2, 2, 9, 5, 2, 3 };
+
+    SF_ASSERT(dataSize > 0);
+    pop->Type = pdata[0];
+    if (pop->Type < 10 && sizes[pop->Type] > dataSize)
+        return sizes[pop->Type];
+
+    switch (pop->Type)
+    {
+    case 0: // string
+        {
+            const UByte* pend = (const UByte*)memchr(&pdata[1], 0, dataSize - 1);
+            pop->Literal.Offset = dataOffset + 1;
+            pop->Literal.Index  = -1;
+            return pend ? (unsigned)(pend - pdata) + 1 : dataSize + 1;
+        }
+
+    case 1: // float (little-endian)
+        {
+            union {
+                float   F;
+                UInt32  I;
+            } u;
+            SF_COMPILER_ASSERT(sizeof(u) == sizeof(u.I));
+
+            memcpy(&u.I, &pdata[1], 4);
+            u.I = Alg::ByteUtil::LEToSystem(u.I);
+            pop->NumberValue = (Number)u.F;
+        }
+        return 5;
+
+    case 2: // null
+    case 3: // undefined
+        return 1;
+
+    case 4: // register
+    case 8: // constant pool index
+        pop->IntValue = pdata[1];
+        return 2;
+
+    case 5: // boolean
+        pop->IntValue = pdata[1] ? 1 : 0;
+        return 2;
+
+    case 6: // double
+        {
+            // wacky format: 45670123
+#ifdef SF_NO_DOUBLE
+            union
+            {
+                float   F;
+                UInt32  I;
+            } u;
+
+            // convert ieee754 64bit to 32bit for systems without proper double
+            int    sign = (pdata[1 + 3] & 0x80) >> 7;
+            int    expo = ((pdata[1 + 3] & 0x7f) << 4) + ((pdata[1 + 2] & 0xf0) >> 4);
+            int    mant = ((pdata[1 + 2] & 0x0f) << 19) + (pdata[1 + 1] << 11) +
+                          (pdata[1 + 0] << 3) + ((pdata[1 + 7] & 0xf8) >> 5);
+
+            if (expo == 2047)
+                expo = 255;
+            else if (expo - 1023 > 127)
+            {
+                expo = 255;
+                mant = 0;
+            }
+            else if (expo - 1023 < -126)
+            {
+                expo = 0;
+                mant = 0;
+            }
+            else
+                expo = expo - 1023 + 127;
+
+            u.I = (sign << 31) + (expo << 23) + mant;
+            pop->NumberValue = (Number)u.F;
+#else
+            union {
+                double  D;
+                UInt64  I;
+                struct {
+                    UInt32  Lo;
+                    UInt32  Hi;
+                } Sub;
+            } u;
+            SF_COMPILER_ASSERT(sizeof(UInt32) == 4);
+            SF_COMPILER_ASSERT(sizeof(u) == sizeof(u.I));
+
+            memcpy(&u.Sub.Hi, &pdata[1], 4);
+            memcpy(&u.Sub.Lo, &pdata[1 + 4], 4);
+            u.I = Alg::ByteUtil::LEToSystem(u.I);
+            pop->NumberValue = (Number)u.D;
+#endif
+        }
+        return 9;
+
+    case 7: // int32
+        pop->IntValue = pdata[1] | (pdata[2] << 8) | (pdata[3] << 16) | (pdata[4] << 24);
+        return 5;
+
+    case 9: // constant pool index (16 bit)
+        pop->IntValue = pdata[1] | (pdata[2] << 8);
+        return 3;
+
+    default:
+        // Unknown types are skipped, as in Flash.
+        return 1;
+    }
+}
+
+void ActionBufferDecoded::Decode(const UByte* pbuffer, unsigned length)
+{
+    // Linear sweep over the buffer. Code reachable only by jumping into 
+    // the middle of an action is not decoded; Execute interprets it directly.
+    unsigned pc = 0;
+    while (pc < length)
+    {
+        Action action;
+        action.Pc           = pc;
+        action.Target       = -1;
+        action.FirstOperand = 0;
+        action.OperandCount = 0;
+        action.ActionId     = pbuffer[pc];
+
+        unsigned nextPc = pc + 1;
+        if (action.ActionId & 0x80)
+        {
+            if (pc + 3 > length)
+                break;
+            nextPc = pc + 3 + (pbuffer[pc + 1] | (pbuffer[pc + 2] << 8));
+            if (nextPc > length)
+                break;
+
+            if (action.ActionId == 0x96)
+            {
+                // PushData. If the operands do not exactly fill the action, 
+                // leave them to be decoded during execution, which reproduces
+                // the way Flash reads such data.
+                UPInt    firstOperand = Operands.GetSize();
+                UPInt    firstLiteral = Literals.GetSize();
+                unsigned i = pc + 3;
+                while (i < nextPc)
+                {
+                    PushOperand op;
+                    i += DecodePushOperand(&pbuffer[i], i, nextPc - i, &op);
+                    if (op.Type == 0 && i <= nextPc)
+                    {
+                        op.Literal.Index = (SInt32)Literals.GetSize();
+                        Literals.PushBack(op.Literal.Offset);
+                    }
+                    Operands.PushBack(op);
+                }
+                UPInt count = Operands.GetSize() - firstOperand;
+                if (i == nextPc && count > 0 && count <= 0xFFFF)
+                {
+                    action.FirstOperand = (UInt32)firstOperand;
+                    action.OperandCount = (UInt16)count;
+                }
+                else
+                {
+                    Operands.Resize(firstOperand);
+                    Literals.Resize(firstLiteral);
+                }
+            }
+        }
+        Actions.PushBack(action);
+        pc = nextPc;
+    }
+
+    // Resolve branch destinations.
+    for (UPInt i = 0, n = Actions.GetSize(); i < n; ++i)
+    {
+        Action& action = Actions[i];
+        if (action.ActionId == 0x99 || action.ActionId == 0x9D)
+        {
+            unsigned actionPc = action.Pc;
+            SInt16   offset   = pbuffer[actionPc + 3] | (SInt16(pbuffer[actionPc + 4]) << 8);
+            int      destPc   = (int)actionPc + 5 + offset;
+            if (destPc >= 0)
+                action.Target = (SInt32)findAction((unsigned)destPc);
+        }
+    }
+}
+
+SPInt ActionBufferDecoded::findAction(unsigned pc) const
+{
+    UPInt lower = 0, upper = Actions.GetSize();
+    while (lower < upper)
+    {
+        UPInt middle = (lower + upper) >> 1;
+        if (Actions[middle].Pc < pc)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+    return (lower < Actions.GetSize() && Actions[lower].Pc == pc) ? (SPInt)lower : -1;
+}
+
 ActionBuffer::ActionBuffer(ASStringContext *psc, ActionBufferData *pbufferData)
 :   pBufferData(pbufferData),  
     Dictionary(psc->GetBuiltin(ASBuiltin_empty_)),
-    DeclDictProcessedAt(-1)
+    DeclDictProcessedAt(-1),
+    Literals(psc->GetBuiltin(ASBuiltin_empty_))
 { 
 }
 
@@ -1845,6 +2088,17 @@ void    ActionBuffer::ProcessDeclDict(ASStringContext *psc, unsigned startPc, un
     }
 }
 
+void    ActionBuffer::ResolveLiterals(ASStringContext *psc, const ActionBufferDecoded* pdecoded)
+{
+    SF_ASSERT(pdecoded);
+    const UByte* Buffer = GetBufferPtr();
+    UPInt        count  = pdecoded->Literals.GetSize();
+
+    Literals.Resize(count);
+    for (UPInt i = 0; i < count; i++)
+        Literals[i] = psc->CreateString((const char*) &Buffer[pdecoded->Literals[i]]);
+}
+
 bool    ActionBuffer::ResolveFrameNumber 
     (Environment* env, const Value& frameValue, InteractiveObject** pptarget, unsigned* pframeNumber)
 {
@@ -2763,6 +3017,14 @@ void    ActionBuffer::Execute(
     };
     char funcBuf[sizeof(FunctionRef)];
     char fnCallBuf[sizeof(FnCall)];
+    ActionBufferDecoded::PushOperand pushOperand;
+
+    // Decoded form of the buffer; its string literals are resolved once per ActionBuffer.
+    const ActionBufferDecoded*          pdecoded = pBufferData->GetDecoded();
+    const ActionBufferDecoded::Action*  paction  = NULL;
+    UPInt                               nextActionIndex = 0;
+    if (pdecoded && Literals.GetSize() != pdecoded->Literals.GetSize())
+        ResolveLiterals(env->GetSC(), pdecoded);
 
     GASInitBuffer(tmpStr1Buf);
     GASInitBuffer(tmpStr2Buf);
@@ -2816,6 +3078,15 @@ void    ActionBuffer::Execute(
                 execContext.WithStack.pWithStackArray->Resize(n - i);
         }
 
+        // Find the decoded action. Sequential execution and pre-resolved branch
+        // destinations match the hint; anything else falls back to a search.
+        if (pdecoded)
+        {
+            SPInt actionIndex = pdecoded->FindAction(execContext.PC, nextActionIndex);
+            paction         = (actionIndex >= 0) ? &pdecoded->Actions[actionIndex] : NULL;
+            nextActionIndex = (UPInt)(actionIndex + 1);
+        }
+
         // Get the opcode.
         int actionId = execContext.pBuffer[execContext.PC];
 
@@ -4774,26 +5045,43 @@ void    ActionBuffer::Execute(
 
             case 0x96:  // PushData
             {
-                int i = execContext.PC;
-
                 // MA: Length must be greater then 0 here, otherwise push would make no sense;
                 // so it shouldn't happen in practice. Hence, use do {} while for efficiency,
                 // as PushData is the *most* common op. This assertion can be checked for by the 
                 // bytecode verifier in the future (during action buffer Read, etc).
                 SF_ASSERT(actionLength > 0);
+
+                // Operands are normally pre-decoded. Actions reached by a jump into the
+                // middle of another action and malformed operands are decoded here, 
+                // one operand at a time.
+                const ActionBufferDecoded::PushOperand* pop    = &pushOperand;
+                const ActionBufferDecoded::PushOperand* popEnd = NULL;
+                unsigned                                dataPc = execContext.PC + 3;
+                if (paction && paction->OperandCount)
+                {
+                    pop    = &pdecoded->Operands[paction->FirstOperand];
+                    popEnd = pop + paction->OperandCount;
+                }
                
                 do
                 {
-                    SPInt   type = execContext.pBuffer[3 + i];
-                    i++;
+                    if (!popEnd)
+                    {
+                        unsigned available = (dataPc < GetLength()) ? GetLength() - dataPc : 0;
+                        unsigned size      = available ? 
+                            ActionBufferDecoded::DecodePushOperand(&execContext.pBuffer[dataPc], dataPc, available, &pushOperand) : 1;
+                        if (size > available)
+                            break;
+                        dataPc += size;
+                    }
+                    SPInt type = pop->Type;
 
                     // Push register is the most common value type.
                     // Push dictionary is the second common type.
                     if (type == 4)
                     {
                         // contents of register
-                        int reg = execContext.pBuffer[3 + i];
-                        i++;
+                        int reg = pop->IntValue;
                         if (execContext.IsFunction2)
                         {
                             env->Push(*(env->LocalRegisterPtr(reg)));
@@ -4843,10 +5131,9 @@ void    ActionBuffer::Execute(
                         }
 
                     }
-                    else if (type == 8)
+                    else if (type == 8 || type == 9)
                     {
-                        unsigned id = execContext.pBuffer[3 + i];
-                        i++;
+                        unsigned id = (unsigned)pop->IntValue;
                         if (id < Dictionary.GetSize())
                         {
                             // Push string directly with a copy constructor.
@@ -4875,34 +5162,35 @@ void    ActionBuffer::Execute(
                     else if (type == 0)
                     {
                         // string
-                        ASString& str = GASStringConstruct(env->CreateString((const char*) &execContext.pBuffer[3 + i]), tmpStr1Buf);
-                        i += (int)str.GetSize() + 1;
-                        env->Push(str);
+                        if (pop->Literal.Index >= 0)
+                        {
+                            env->Push(Literals[pop->Literal.Index]);
 
-                        #ifdef GFX_AS2_VERBOSE
-                        if (execContext.VerboseAction) 
-                            execContext.LogF.LogAction("-------------- pushed '%s'\n", str.ToCStr());
-                        #endif
-                        GASStringDeconstruct(str);
+                            #ifdef GFX_AS2_VERBOSE
+                            if (execContext.VerboseAction) 
+                                execContext.LogF.LogAction("-------------- pushed '%s'\n", Literals[pop->Literal.Index].ToCStr());
+                            #endif
+                        }
+                        else
+                        {
+                            ASString& str = GASStringConstruct(env->CreateString((const char*) &execContext.pBuffer[pop->Literal.Offset]), tmpStr1Buf);
+                            env->Push(str);
+
+                            #ifdef GFX_AS2_VERBOSE
+                            if (execContext.VerboseAction) 
+                                execContext.LogF.LogAction("-------------- pushed '%s'\n", str.ToCStr());
+                            #endif
+                            GASStringDeconstruct(str);
+                        }
                     }
-                    else if (type == 1)
+                    else if (type == 1 || type == 6)
                     {
-                        // float (little-endian)
-                        union {
-                            float   F;
-                            UInt32  I;
-                        } u;
-                        SF_COMPILER_ASSERT(sizeof(u) == sizeof(u.I));
-
-                        memcpy(&u.I, &execContext.pBuffer[3 + i], 4);
-                        u.I = Alg::ByteUtil::LEToSystem(u.I);
-                        i += 4;
-
-                        env->Push(u.F);
+                        // float, double
+                        env->Push(pop->NumberValue);
 
                         #ifdef GFX_AS2_VERBOSE
                         if (execContext.VerboseAction) 
-                            execContext.LogF.LogAction("-------------- pushed '%f'\n", u.F);
+                            execContext.LogF.LogAction("-------------- pushed %s %f\n", (type == 1) ? "float" : "double", (double)pop->NumberValue);
                         #endif
                     }
                     else if (type == 2)
@@ -4930,8 +5218,7 @@ void    ActionBuffer::Execute(
                     }
                     else if (type == 5)
                     {
-                        bool    boolVal = execContext.pBuffer[3 + i] ? true : false;
-                        i++;
+                        bool    boolVal = pop->IntValue != 0;
                         env->Push(boolVal);
 
                         #ifdef GFX_AS2_VERBOSE
@@ -4939,81 +5226,10 @@ void    ActionBuffer::Execute(
                             execContext.LogF.LogAction("-------------- pushed %s\n", boolVal ? "true" : "false");
                         #endif
                     }
-                    else if (type == 6)
-                    {
-                        // double
-                        // wacky format: 45670123
-#ifdef SF_NO_DOUBLE
-                        union
-                        {
-                            float   F;
-                            UInt32  I;
-                        } u;
-
-                        // convert ieee754 64bit to 32bit for systems without proper double
-                        int    sign = (execContext.pBuffer[3 + i + 3] & 0x80) >> 7;
-                        int    expo = ((execContext.pBuffer[3 + i + 3] & 0x7f) << 4) + ((execContext.pBuffer[3 + i + 2] & 0xf0) >> 4);
-                        int    mant = ((execContext.pBuffer[3 + i + 2] & 0x0f) << 19) + (execContext.pBuffer[3 + i + 1] << 11) +
-                                      (execContext.pBuffer[3 + i + 0] << 3) + ((execContext.pBuffer[3 + i + 7] & 0xf8) >> 5);
-
-                        if (expo == 2047)
-                            expo = 255;
-                        else if (expo - 1023 > 127)
-                        {
-                            expo = 255;
-                            mant = 0;
-                        }
-                        else if (expo - 1023 < -126)
-                        {
-                            expo = 0;
-                            mant = 0;
-                        }
-                        else
-                            expo = expo - 1023 + 127;
-
-                        u.I = (sign << 31) + (expo << 23) + mant;
-                        i += 8;
-
-                        env->Push((Number)u.F);
-                        
-                        #ifdef GFX_AS2_VERBOSE
-                        if (execContext.VerboseAction) 
-                            execContext.LogF.LogAction("-------------- pushed double %f\n", u.F);
-                        #endif
-#else
-                        union {
-                            double  D;
-                            UInt64  I;
-                            struct {
-                                UInt32  Lo;
-                                UInt32  Hi;
-                            } Sub;
-                        } u;
-                        SF_COMPILER_ASSERT(sizeof(UInt32) == 4);
-                        SF_COMPILER_ASSERT(sizeof(u) == sizeof(u.I));
-
-                        memcpy(&u.Sub.Hi, &execContext.pBuffer[3 + i], 4);
-                        memcpy(&u.Sub.Lo, &execContext.pBuffer[3 + i + 4], 4);
-                        u.I = Alg::ByteUtil::LEToSystem(u.I);
-                        i += 8;
-
-                        env->Push((Number)u.D);
-
-                        #ifdef GFX_AS2_VERBOSE
-                        if (execContext.VerboseAction) 
-                            execContext.LogF.LogAction("-------------- pushed double %f\n", u.D);
-                        #endif
-#endif
-                    }
                     else if (type == 7)
                     {
                         // int32
-                        SInt32  val = execContext.pBuffer[3 + i]
-                            | (execContext.pBuffer[3 + i + 1] << 8)
-                            | (execContext.pBuffer[3 + i + 2] << 16)
-                            | (execContext.pBuffer[3 + i + 3] << 24);
-                        i += 4;
-                    
+                        SInt32  val = pop->IntValue;
                         env->Push(val);
 
                         #ifdef GFX_AS2_VERBOSE
@@ -5021,36 +5237,8 @@ void    ActionBuffer::Execute(
                             execContext.LogF.LogAction("-------------- pushed int32 %d\n", (int)val);
                         #endif
                     }
-                    else if (type == 9)
-                    {
-                        unsigned id = execContext.pBuffer[3 + i] | (execContext.pBuffer[4 + i] << 8);
-                        i += 2;
-                        if (id < Dictionary.GetSize())
-                        {                            
-                            env->Push(Dictionary[id]);
-                            #ifdef GFX_AS2_VERBOSE
-                            if (execContext.VerboseAction) 
-                                execContext.LogF.LogAction("-------------- pushed '%s'\n", Dictionary[id].ToCStr());
-                            #endif
-                        }
-                        else
-                        {
-                            #ifdef GFX_AS2_VERBOSE_ERRORS
-                            if (execContext.VerboseActionErrors)
-                                execContext.LogF.LogScriptError("DictLookup(%d) is out of bounds", id);
-                            #endif
-                            Value& empty = GASValueConstruct0(valBuf1);
-                            env->Push(empty);
-                            GASValueDeconstruct(empty);
-
-                            #ifdef GFX_AS2_VERBOSE
-                            if (execContext.VerboseAction) 
-                                execContext.LogF.LogAction("-------------- pushed 0");
-                            #endif
-                        }
-                    }
 
-                } while (i - execContext.PC < actionLength);
+                } while (popEnd ? (++pop < popEnd) : (dataPc - (execContext.PC + 3) < (unsigned)actionLength));
                 
                 break;
             }
@@ -5058,6 +5246,8 @@ void    ActionBuffer::Execute(
             {
                 SInt16  offset = execContext.pBuffer[execContext.PC + 3] | (SInt16(execContext.pBuffer[execContext.PC + 4]) << 8);
                 execContext.NextPC += offset;
+                if (paction)
+                    nextActionIndex = (UPInt)paction->Target;
                                   
                 // Range checks.
                 if (((unsigned)execContext.NextPC) >= GetLength())
@@ -5154,6 +5344,8 @@ void    ActionBuffer::Execute(
                 if (test)
                 {
                     execContext.NextPC += offset;
+                    if (paction)
+                        nextActionIndex = (UPInt)paction->Target;
 
                     if (execContext.NextPC > execContext.StopPC)
                     {
@@ -767,6 +767,10 @@ private:
     HashUncachedLH<ASBuiltinType, Ptr<Object>, FixedSizeHash<ASBuiltinType> >   Prototypes;
     ASStringHash<FunctionRef>                           RegisteredClasses;  
     ASStringHash<ClassRegEntry>                         BuiltinClassesRegistry;
+    // ActionBuffers shared by all characters executing the same action data,
+    // so that their constant pools and literals are resolved once per movie.
+    // The ActionBuffer holds a reference to its key.
+    HashLH<const ActionBufferData*, Ptr<ActionBuffer> > ActionBuffers;
     MovieImpl*                                          pMovieRoot;
     MemoryHeap*                                         pHeap;
 public:
@@ -830,6 +834,12 @@ public:
     }
     FunctionObject* ResolveFunctionName(const ASString& functionName);
 
+    enum { MaxCachedActionBuffers = 2048 };
+
+    // Returns the movie view specific ActionBuffer for pbufferData, creating it
+    // on first use. The cache is dropped once it reaches MaxCachedActionBuffers.
+    ActionBuffer*       GetActionBuffer(ActionBufferData* pbufferData);
+
     MemoryHeap*         GetHeap() const         { return pHeap; }
 
     MovieImpl*          GetMovieImpl()          { return pMovieRoot; }
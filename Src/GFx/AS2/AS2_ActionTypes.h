@@ -220,6 +220,75 @@ public:
 typedef ArrayLH_POD<WithStackEntry, StatMV_ActionScript_Mem> WithStackArray;
 
 
+// ***** ActionBufferDecoded
+
+// One-time decoded form of an action buffer, built on first execution and
+// shared by everything executing the same ActionBufferData. It records the
+// boundaries of all actions reachable by a linear sweep, pre-resolves branch
+// destinations and pre-decodes PushData operands, so that Execute does not
+// need to re-parse them on every run. Decoding does not depend on the movie
+// view: string operands keep their constant pool index or literal index and
+// are resolved to ASStrings by ActionBuffer.
+class ActionBufferDecoded : public NewOverrideBase<StatMD_ASBinaryData_Mem>
+{
+public:
+    struct PushOperand
+    {
+        // SWF PushData value type: 0 - string literal, 1 - float, 2 - null,
+        // 3 - undefined, 4 - register, 5 - boolean, 6 - double, 7 - int32,
+        // 8, 9 - constant pool index.
+        UByte           Type;
+        union
+        {
+            Number      NumberValue;    // float, double
+            SInt32      IntValue;       // int32, boolean, register, constant pool index
+            struct
+            {
+                UInt32  Offset;         // offset of the string in the action buffer
+                SInt32  Index;          // index in Literals; -1 if decoded on the fly
+            }           Literal;
+        };
+    };
+
+    struct Action
+    {
+        UInt32          Pc;
+        // Index of the branch destination action for 0x99 and 0x9D,
+        // -1 if the destination is not on an action boundary.
+        SInt32          Target;
+        // First PushData operand in Operands.
+        UInt32          FirstOperand;
+        UInt16          OperandCount;
+        UByte           ActionId;
+    };
+
+    ArrayLH_POD<Action, StatMD_ASBinaryData_Mem>        Actions;
+    ArrayLH_POD<PushOperand, StatMD_ASBinaryData_Mem>   Operands;
+    // Buffer offsets of PushData string literals.
+    ArrayLH_POD<UInt32, StatMD_ASBinaryData_Mem>        Literals;
+
+    void            Decode(const UByte* pbuffer, unsigned length);
+
+    // Returns the index of the action starting at pc, or -1. The hint is the
+    // expected index, which is usually correct for sequential execution.
+    SPInt           FindAction(unsigned pc, UPInt hint) const
+    {
+        if (hint < Actions.GetSize() && Actions[hint].Pc == pc)
+            return (SPInt)hint;
+        return findAction(pc);
+    }
+
+    // Decodes one PushData operand at pdata, which is dataOffset bytes into
+    // the buffer and has dataSize bytes available. Returns the operand size
+    // in bytes; if it is greater than dataSize the operand was not decoded.
+    static unsigned DecodePushOperand(const UByte* pdata, unsigned dataOffset, 
+                                      unsigned dataSize, PushOperand* pop);
+
+private:
+    SPInt           findAction(unsigned pc) const;
+};
+
+
 // ***** ActionBuffer
 
 // ActionScript buffer for action opcodes. The associated dictionary is stored in a
@@ -237,7 +306,7 @@ class ActionBufferData : public RefCountBase<ActionBufferData, StatMD_ASBinaryDa
 protected:
     // Create using CreateNew static method
     ActionBufferData() 
-        : pBuffer(0), BufferLen(0), SwdHandle(0), SWFFileOffset(0)
+        : pBuffer(0), BufferLen(0), SwdHandle(0), SWFFileOffset(0), pDecoded()
     {   
         //AB: technically, pdataDef should be not null always to avoid crash in
         // situation when memory heap with opcodes is freed before AS-function object
@@ -245,7 +314,11 @@ protected:
         //SF_ASSERT(pdataDef);
     }
 public:
-    ~ActionBufferData() { if (pBuffer) SF_FREE(pBuffer); }
+    ~ActionBufferData() 
+    { 
+        if (pBuffer) SF_FREE(pBuffer); 
+        delete (ActionBufferDecoded*)pDecoded;
+    }
 
     // Use this method to create an instance
     static ActionBufferData* CreateNew();
@@ -253,6 +326,9 @@ public:
     bool                IsNull() const          { return BufferLen < 1 || pBuffer[0] == 0; }
     unsigned            GetLength() const       { return BufferLen; }
     const UByte*        GetBufferPtr() const    { return (IsNull()) ? NULL : pBuffer; }
+    // Returns the decoded form of the buffer, decoding it on first call.
+    // May be called from several threads.
+    const ActionBufferDecoded* GetDecoded() const;
 
     UInt32              GetSWFFileOffset() const            { return SWFFileOffset; }
     void                SetSWFFileOffset(UInt32 swfOffset)  { SWFFileOffset = swfOffset; }
@@ -280,6 +356,8 @@ protected:
     UInt32              SwdHandle;
     UInt32              SWFFileOffset;
 
+    mutable AtomicPtr<ActionBufferDecoded> pDecoded;
+
 #ifdef SF_BUILD_DEBUG
     StringLH           FileName;
 #endif
@@ -297,6 +375,8 @@ class ActionBuffer : public RefCountBaseNTS<ActionBuffer, StatMV_ActionScript_Me
     // Cached dictionary.
     ArrayCC<ASString, StatMV_ActionScript_Mem>   Dictionary;    
     int                         DeclDictProcessedAt;        
+    // PushData string literals, indexed as ActionBufferDecoded::Literals.
+    ArrayCC<ASString, StatMV_ActionScript_Mem>   Literals;
 
 public:
     ActionBuffer(ASStringContext *psc, ActionBufferData *pbufferData);
@@ -323,6 +403,8 @@ public:
                     ExecuteType execType);
 
     void    ProcessDeclDict(ASStringContext *psc, unsigned StartPc, unsigned StopPc, class ActionLogger &logger);
+    // Creates ASStrings for the decoded PushData string literals.
+    void    ResolveLiterals(ASStringContext *psc, const ActionBufferDecoded* pdecoded);
     
     bool         IsNull() const       { return pBufferData->IsNull(); }
     unsigned     GetLength() const    { return pBufferData->GetLength(); }
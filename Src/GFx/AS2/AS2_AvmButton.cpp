@@ -177,8 +177,7 @@ bool AvmButton::OnMouseEvent(const EventId& event)
                         {
                             if (!action->Actions[j]->IsNull())
                             {
-                                Ptr<ActionBuffer> pbuff = 
-                                    *SF_HEAP_NEW(psc->GetHeap()) ActionBuffer(psc, action->Actions[j]);
+                                Ptr<ActionBuffer> pbuff = psc->pContext->GetActionBuffer(action->Actions[j]);
                                 avmParentSpr->AddActionBuffer(pbuff);
                             }
                         }
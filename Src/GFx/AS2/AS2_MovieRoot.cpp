@@ -3208,7 +3208,7 @@ void    AvmSwfEvent::AttachTo(InteractiveObject* ch) const
         AvmCharacter*       pach  = GFx::AS2::ToAvmCharacter(ch);
         Environment*        penv  = pach->GetASEnvironment();
         MemoryHeap*         pheap = penv->GetHeap();
-        Ptr<ActionBuffer>   pbuff = *SF_HEAP_NEW(pheap) ActionBuffer(penv->GetSC(), pActionOpData);
+        Ptr<ActionBuffer>   pbuff = penv->GetGC()->GetActionBuffer(pActionOpData);
 
         // we need to set a different type for special events, such as Initialize,
         // Construct, Load and Unload. These events behave differently when character
@@ -528,7 +528,7 @@ Number   Value::ToNumber(Environment* penv) const
         // gets converted; otherwise it is set to NaN.
         //
         Number num;
-        if (!StringToNumber(&num, V.pStringNode->pData))
+        if (!StringToNumber(&num, V.pStringNode->GetFlatNode()->pData))
         {
             // Failed conversion to Number.
             num = NumberUtil::NaN(); //!AB
@@ -714,7 +714,7 @@ bool    Value::ToBool(const Environment* penv) const
             // be converted to a valid nonzero number".
             //
             Number num;
-            if (StringToNumber(&num, V.pStringNode->pData))
+            if (StringToNumber(&num, V.pStringNode->GetFlatNode()->pData))
             {
                 if (NumberUtil::IsNaN(num)) return false;
                 return (!!num);
@@ -884,6 +884,9 @@ void    Value::ConvertToString(Environment* pEnv)
 // Force type to string.
 void    Value::ConvertToStringVersioned(Environment* pEnv, unsigned version)
 {
+    // Keep strings as they are, so that concatenation nodes aren't flattened.
+    if (T.Type == STRING)
+        return;
     ASString str = ToStringVersioned(pEnv, version);    
     DropRefs();
     T.Type = STRING;  // force type.
@@ -971,7 +974,7 @@ void    Value::Add(Environment* penv, const Value& v)
 
         pv1.ConvertToStringVersioned(penv, version);
         pv1.StringConcat(penv, pv2.ToStringVersioned(penv, version));
-        SetString(pv1.ToString(penv));
+        *this = pv1;
     }
     else 
     {
@@ -991,7 +994,7 @@ void    Value::Add(Environment* penv, int v2)
 
         pv1.ConvertToStringVersioned(penv, version);
         pv1.StringConcat(penv, Value(v2).ToStringVersioned(penv, version));
-        SetString(pv1.ToString(penv));
+        *this = pv1;
     }
     else 
     {
@@ -1201,14 +1204,23 @@ Value    Value::Compare (Environment* penv, const Value& v, int action) const
 }
 
 
-// Sets *this to this string plus the given string.
+// Sets *this to this string plus the given string. The result is a
+// concatenation node unless short, see ASStringManager::CreateConcatNode.
 void    Value::StringConcat(Environment* penv, const ASString& str)
 {
-    ASString tempstr(ToString(penv) + str);
+    ASString      leftstr(str.GetManager()->GetEmptyStringNode());
+    ASStringNode* pleft = V.pStringNode;
+    if (T.Type != STRING)
+    {
+        leftstr = ToString(penv);
+        pleft   = leftstr.GetNode();
+    }
+    ASStringNode* pnode = str.GetManager()->CreateConcatNode(pleft, str.GetNode());
+    // pnode can be our own node.
+    pnode->AddRef();
     DropRefs();
     T.Type        = STRING;
-    V.pStringNode = tempstr.GetNode();
-    V.pStringNode->AddRef();
+    V.pStringNode = pnode;
 }
 
 // This hack is used to prevent memory leak in situations like this:
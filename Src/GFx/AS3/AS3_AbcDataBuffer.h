@@ -39,6 +39,10 @@ public:
 //#ifdef SF_BUILD_DEBUG
     StringLH    FileName;
 //#endif
+    // ABC code; points either to Data, or into the memory of pDataFile
+    // if the ABC block is referenced in place in a mapped file.
+    const UByte* pData;
+    Ptr<File>   pDataFile;
     UByte       Data[1];
 
     AbcDataBuffer(const String& name, unsigned flags, unsigned dataSize) 
@@ -46,14 +50,22 @@ public:
 #ifdef SF_AMP_SERVER
         , SwfHandle(0), SwfOffset(0)
 #endif
+        , pData(Data)
     {}
 
+    // Makes the buffer refer to data owned by pfile instead of Data.
+    void                SetMappedData(const UByte* pdata, File* pfile)
+    {
+        pData       = pdata;
+        pDataFile   = pfile;
+    }
+
     // Placement new/delete.
     SF_MEMORY_DEFINE_PLACEMENT_NEW
 
     bool                IsNull() const          { return DataSize == 0; }
     unsigned            GetLength() const       { return DataSize; }
-    const UByte*        GetBufferPtr() const    { return (IsNull()) ? NULL : Data; }
+    const UByte*        GetBufferPtr() const    { return (IsNull()) ? NULL : pData; }
 
     const char*         GetFileName() const    
     { 
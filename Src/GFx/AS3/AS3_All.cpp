@@ -37,6 +37,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "AS3_MovieRoot.cpp"
 #include "AS3_Object.cpp"
 #include "AS3_ObjCollector.cpp"
+#include "AS3_OpCodeCache.cpp"
 #include "AS3_Slot.cpp"
 #include "AS3_SocketBuffer.cpp"
 #include "AS3_SocketThreadMgr.cpp"
@@ -57,9 +57,17 @@ CheckResult Add(StringManager& sm, Value& result, const Value& l, const Value& r
         ASString left(sm.CreateEmptyString());
         ASString right(sm.CreateEmptyString());
 
-        if (l.Convert2String(left) && r.Convert2String(right))
+        // String operands are concatenated without being flattened, so that
+        // appending to a string in a loop doesn't copy it every time.
+        ASStringNode* lnode = l.IsString() ? l.AsRawStringNode() : NULL;
+        ASStringNode* rnode = r.IsString() ? r.AsRawStringNode() : NULL;
+
+        if ((lnode || l.Convert2String(left)) && (rnode || r.Convert2String(right)))
         {
-            result = left + right;
+            // "result" can be one of the operands.
+            Value concat(sm.GetStringManager()->CreateConcatNode(
+                lnode ? lnode : left.GetNode(), rnode ? rnode : right.GetNode()));
+            result.Swap(concat);
             return true;
         }
 
@@ -2230,6 +2238,25 @@ void VM::DropCallFrame()
 #endif
 }
 
+///////////////////////////////////////////////////////////////////////////
+// Opcode dispatch.
+// With threaded dispatch every handler ends by jumping directly to the
+// handler of the next opcode through dispatch_table, so each handler gets
+// its own indirect branch and branch history. The switch is only used to
+// enter the loop. When the debugger needs to check opcodes, handlers go
+// back to the top of the loop instead.
+#ifdef SF_AS3_ENABLE_THREADED_DISPATCH
+    #define SF_AS3_OPCODE(op) case Code::op: label_##op
+    #ifdef GFX_AS3_TRACE
+        #define SF_AS3_NEXT_OPCODE { if (ui.NeedToCheckOpCode()) break; curr_cp = cp; goto *dispatch_table[Read8(cp)]; }
+    #else
+        #define SF_AS3_NEXT_OPCODE { curr_cp = cp; goto *dispatch_table[Read8(cp)]; }
+    #endif
+#else
+    #define SF_AS3_OPCODE(op) case Code::op
+    #define SF_AS3_NEXT_OPCODE break
+#endif
+
 ///////////////////////////////////////////////////////////////////////////
 // By default execute only one top stack frame (including all function calls).
 int VM::ExecuteCode(unsigned max_stack_depth)
@@ -2242,6 +2269,299 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 #ifdef GFX_AS3_TRACE
     FlashUI& ui = GetUI();
 #endif
+#ifdef SF_AS3_ENABLE_THREADED_DISPATCH
+    // Handler labels indexed by opcode.
+    static const void* const dispatch_table[256] = {
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_nop,
+        &&label_op_throw,
+        &&label_op_getsuper,
+        &&label_op_setsuper,
+        &&label_op_dxns,
+        &&label_op_dxnslate,
+        &&label_op_kill,
+        &&label_op_label,
+        &&label_op_inclocal_ti,
+        &&label_op_declocal_ti,
+        &&label_op_ifnlt,
+        &&label_op_ifnle,
+        &&label_op_ifngt,
+        &&label_op_ifnge,
+        &&label_op_jump,
+        &&label_op_iftrue,
+        &&label_op_iffalse,
+        &&label_op_ifeq,
+        &&label_op_ifne,
+        &&label_op_iflt,
+        &&label_op_ifle,
+        &&label_op_ifgt,
+        &&label_op_ifge,
+        &&label_op_ifstricteq,
+        &&label_op_ifstrictne,
+        &&label_op_lookupswitch,
+        &&label_op_pushwith,
+        &&label_op_popscope,
+        &&label_op_nextname,
+        &&label_op_hasnext,
+        &&label_op_pushnull,
+        &&label_op_pushundefined,
+        &&label_op_not_tb,
+        &&label_op_nextvalue,
+        &&label_op_pushbyte,
+        &&label_op_pushshort,
+        &&label_op_pushtrue,
+        &&label_op_pushfalse,
+        &&label_op_pushnan,
+        &&label_op_pop,
+        &&label_op_dup,
+        &&label_op_swap,
+        &&label_op_pushstring,
+        &&label_op_pushint,
+        &&label_op_pushuint,
+        &&label_op_pushdouble,
+        &&label_op_pushscope,
+        &&label_op_pushnamespace,
+        &&label_op_hasnext2,
+        &&label_op_iftrue_tb,
+        &&label_op_iffalse_tb,
+        &&label_op_increment_tu,
+        &&label_op_decrement_tu,
+        &&label_op_inclocal_tu,
+        &&label_op_declocal_tu,
+        &&label_op_lf64,
+        &&label_op_si8,
+        &&label_op_si16,
+        &&label_op_si32,
+        &&label_op_sf32,
+        &&label_op_sf64,
+        &&label_op_negate_ti,
+        &&label_op_newfunction,
+        &&label_op_call,
+        &&label_op_construct,
+        &&label_op_callmethod,
+        &&label_op_callstatic,
+        &&label_op_callsuper,
+        &&label_op_callproperty,
+        &&label_op_returnvoid,
+        &&label_op_returnvalue,
+        &&label_op_constructsuper,
+        &&label_op_constructprop,
+        &&label_op_unknown,
+        &&label_op_callproplex,
+        &&label_op_unknown,
+        &&label_op_callsupervoid,
+        &&label_op_callpropvoid,
+        &&label_op_sxi1,
+        &&label_op_sxi8,
+        &&label_op_sxi16,
+        &&label_op_applytype,
+        &&label_op_negate_td,
+        &&label_op_newobject,
+        &&label_op_newarray,
+        &&label_op_newactivation,
+        &&label_op_newclass,
+        &&label_op_getdescendants,
+        &&label_op_newcatch,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_findpropstrict,
+        &&label_op_findproperty,
+        &&label_op_unknown,
+        &&label_op_getlex,
+        &&label_op_setproperty,
+        &&label_op_getlocal,
+        &&label_op_setlocal,
+        &&label_op_getglobalscope,
+        &&label_op_getscopeobject,
+        &&label_op_getproperty,
+        &&label_op_getouterscope,
+        &&label_op_initproperty,
+        &&label_op_dup_nrc,
+        &&label_op_deleteproperty,
+        &&label_op_pop_nrc,
+        &&label_op_getslot,
+        &&label_op_setslot,
+        &&label_op_getglobalslot,
+        &&label_op_setglobalslot,
+        &&label_op_convert_s,
+        &&label_op_esc_xelem,
+        &&label_op_esc_xattr,
+        &&label_op_convert_i,
+        &&label_op_convert_u,
+        &&label_op_convert_d,
+        &&label_op_convert_b,
+        &&label_op_convert_o,
+        &&label_op_checkfilter,
+        &&label_op_add_ti,
+        &&label_op_subtract_ti,
+        &&label_op_multiply_ti,
+        &&label_op_add_td,
+        &&label_op_subtract_td,
+        &&label_op_multiply_td,
+        &&label_op_divide_td,
+        &&label_op_coerce,
+        &&label_op_unknown,
+        &&label_op_coerce_a,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_coerce_s,
+        &&label_op_astype,
+        &&label_op_astypelate,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_ifnlt_ti,
+        &&label_op_ifnle_ti,
+        &&label_op_ifngt_ti,
+        &&label_op_ifnge_ti,
+        &&label_op_ifeq_ti,
+        &&label_op_ifge_ti,
+        &&label_op_negate,
+        &&label_op_increment,
+        &&label_op_inclocal,
+        &&label_op_decrement,
+        &&label_op_declocal,
+        &&label_op_typeof,
+        &&label_op_not,
+        &&label_op_bitnot,
+        &&label_op_increment_ti,
+        &&label_op_decrement_ti,
+        &&label_op_unknown,
+        &&label_op_add_d,
+        &&label_op_ifgt_ti,
+        &&label_op_ifle_ti,
+        &&label_op_iflt_ti,
+        &&label_op_ifne_ti,
+        &&label_op_add,
+        &&label_op_subtract,
+        &&label_op_multiply,
+        &&label_op_divide,
+        &&label_op_modulo,
+        &&label_op_lshift,
+        &&label_op_rshift,
+        &&label_op_urshift,
+        &&label_op_bitand,
+        &&label_op_bitor,
+        &&label_op_bitxor,
+        &&label_op_equals,
+        &&label_op_strictequals,
+        &&label_op_lessthan,
+        &&label_op_lessequals,
+        &&label_op_greaterthan,
+        &&label_op_greaterequals,
+        &&label_op_instanceof,
+        &&label_op_istype,
+        &&label_op_istypelate,
+        &&label_op_in,
+        &&label_op_getabsobject,
+        &&label_op_getabsslot,
+        &&label_op_setabsslot,
+        &&label_op_initabsslot,
+        &&label_op_callsupermethod,
+        &&label_op_callgetter,
+        &&label_op_callsupergetter,
+        &&label_op_ifgt_td,
+        &&label_op_ifle_td,
+        &&label_op_iflt_td,
+        &&label_op_ifne_td,
+        &&label_op_increment_i,
+        &&label_op_decrement_i,
+        &&label_op_inclocal_i,
+        &&label_op_declocal_i,
+        &&label_op_negate_i,
+        &&label_op_add_i,
+        &&label_op_subtract_i,
+        &&label_op_multiply_i,
+        &&label_op_ifnlt_td,
+        &&label_op_ifnle_td,
+        &&label_op_ifngt_td,
+        &&label_op_ifnge_td,
+        &&label_op_ifeq_td,
+        &&label_op_ifge_td,
+        &&label_op_callobject,
+        &&label_op_unknown,
+        &&label_op_getlocal0,
+        &&label_op_getlocal1,
+        &&label_op_getlocal2,
+        &&label_op_getlocal3,
+        &&label_op_setlocal0,
+        &&label_op_setlocal1,
+        &&label_op_setlocal2,
+        &&label_op_setlocal3,
+#ifdef ENABLE_STRICT_SETSLOT
+        &&label_op_setslot_str,
+#else
+        &&label_op_unknown,
+#endif
+#ifdef ENABLE_STRICT_SETSLOT
+        &&label_op_setslot_num,
+#else
+        &&label_op_unknown,
+#endif
+#ifdef ENABLE_STRICT_SETSLOT
+        &&label_op_setslot_uint,
+#else
+        &&label_op_unknown,
+#endif
+#ifdef ENABLE_STRICT_SETSLOT
+        &&label_op_setslot_sint,
+#else
+        &&label_op_unknown,
+#endif
+#ifdef ENABLE_STRICT_SETSLOT
+        &&label_op_setslot_bool,
+#else
+        &&label_op_unknown,
+#endif
+#ifdef ENABLE_STRICT_SETSLOT
+        &&label_op_setslot_value,
+#else
+        &&label_op_unknown,
+#endif
+#ifdef ENABLE_STRICT_SETSLOT
+        &&label_op_setslot_obj_as,
+#else
+        &&label_op_unknown,
+#endif
+#ifdef ENABLE_STRICT_SETSLOT
+        &&label_op_setslot_obj_cpp,
+#else
+        &&label_op_unknown,
+#endif
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_debug,
+        &&label_op_debugline,
+        &&label_op_debugfile,
+        &&label_op_0xF2,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown,
+        &&label_op_unknown
+    };
+#endif
 
     while (CallStack.GetSize() != 0)
     {
@@ -2317,10 +2637,10 @@ int VM::ExecuteCode(unsigned max_stack_depth)
             // Below this point call_frame may be invalidated ...
             switch (opcode)
             {
-            case Code::op_nop:
+            SF_AS3_OPCODE(op_nop):
                 exec_nop();
-                break;
-            case Code::op_throw:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_throw):
                 {
                     // Probably, we should use *curr_offset* here ...
                     int position = exec_throw(cp, call_frame);
@@ -2335,33 +2655,33 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                         cp = code + position;
                     }
                 }
-                break;
-            case Code::op_getsuper:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getsuper):
                 exec_getsuper(file, call_frame.GetOriginationTraits(), constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_setsuper:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setsuper):
                 exec_setsuper(file, call_frame.GetOriginationTraits(), constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_dxns:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_dxns):
                 exec_dxns(call_frame, ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_dxnslate:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_dxnslate):
                 exec_dxnslate();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_kill:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_kill):
                 exec_kill(ReadU30(cp));
-                break;
-            case Code::op_label:
-                break;
-            case Code::op_ifnlt:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_label):
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifnlt):
                 {
                     int offset = exec_ifnlt(ReadS24(cp));
 
@@ -2370,20 +2690,20 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_ifnlt_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifnlt_ti):
                 {
                     int offset = exec_ifnlt_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifnlt_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifnlt_td):
                 {
                     int offset = exec_ifnlt_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifnle:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifnle):
                 {
                     int offset = exec_ifnle(ReadS24(cp));
 
@@ -2392,20 +2712,20 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_ifnle_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifnle_ti):
                 {
                     int offset = exec_ifnle_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifnle_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifnle_td):
                 {
                     int offset = exec_ifnle_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifngt:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifngt):
                 {
                     int offset = exec_ifngt(ReadS24(cp));
 
@@ -2414,20 +2734,20 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_ifngt_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifngt_ti):
                 {
                     int offset = exec_ifngt_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifngt_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifngt_td):
                 {
                     int offset = exec_ifngt_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifnge:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifnge):
                 {
                     int offset = exec_ifnge(ReadS24(cp));
 
@@ -2436,52 +2756,52 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_ifnge_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifnge_ti):
                 {
                     int offset = exec_ifnge_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifnge_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifnge_td):
                 {
                     int offset = exec_ifnge_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_jump:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_jump):
                 {
                     int offset = exec_jump(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_iftrue:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_iftrue):
                 {
                     // No exceptions.
                     int offset = exec_iftrue(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_iftrue_tb:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_iftrue_tb):
                 {
                     int offset = exec_iftrue_tb(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_iffalse:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_iffalse):
                 {
                     // No exceptions.
                     int offset = exec_iffalse(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_iffalse_tb:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_iffalse_tb):
                 {
                     int offset = exec_iffalse_tb(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifeq:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifeq):
                 {
                     int offset = exec_ifeq(ReadS24(cp));
 
@@ -2490,20 +2810,20 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_ifeq_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifeq_ti):
                 {
                     int offset = exec_ifeq_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifeq_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifeq_td):
                 {
                     int offset = exec_ifeq_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifne:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifne):
                 {
                     int offset = exec_ifne(ReadS24(cp));
 
@@ -2512,20 +2832,20 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_ifne_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifne_ti):
                 {
                     int offset = exec_ifne_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifne_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifne_td):
                 {
                     int offset = exec_ifne_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_iflt:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_iflt):
                 {
                     int offset = exec_iflt(ReadS24(cp));
 
@@ -2534,20 +2854,20 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_iflt_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_iflt_ti):
                 {
                     int offset = exec_iflt_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_iflt_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_iflt_td):
                 {
                     int offset = exec_iflt_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifle:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifle):
                 {
                     int offset = exec_ifle(ReadS24(cp));
                     
@@ -2556,20 +2876,20 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_ifle_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifle_ti):
                 {
                     int offset = exec_ifle_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifle_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifle_td):
                 {
                     int offset = exec_ifle_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifgt:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifgt):
                 {
                     int offset = exec_ifgt(ReadS24(cp));
                     
@@ -2578,20 +2898,20 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_ifgt_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifgt_ti):
                 {
                     int offset = exec_ifgt_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifgt_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifgt_td):
                 {
                     int offset = exec_ifgt_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifge:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifge):
                 {
                     int offset = exec_ifge(ReadS24(cp));
 
@@ -2600,39 +2920,39 @@ int VM::ExecuteCode(unsigned max_stack_depth)
 
                     cp += offset;
                 }
-                break;
-            case Code::op_ifge_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifge_ti):
                 {
                     int offset = exec_ifge_ti(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifge_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifge_td):
                 {
                     int offset = exec_ifge_td(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_callobject:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callobject):
                 exec_callobject(ReadU30(cp));
 
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
 
-                break;
-            case Code::op_ifstricteq:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifstricteq):
                 {
                     int offset = exec_ifstricteq(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_ifstrictne:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_ifstrictne):
                 {
                     int offset = exec_ifstrictne(ReadS24(cp));
                     cp += offset;
                 }
-                break;
-            case Code::op_lookupswitch:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_lookupswitch):
                 {
                     const Abc::TOpCode::ValueType* base_location = curr_cp;
                     int default_offset = ReadS24(cp);
@@ -2649,85 +2969,85 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                         cp = base_location + case_offset;
                     }
                 }
-                break;
-            case Code::op_pushwith:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushwith):
                 exec_pushwith();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_popscope:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_popscope):
                 exec_popscope();
-                break;
-            case Code::op_nextname:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_nextname):
                 exec_nextname();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_hasnext:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_hasnext):
                 exec_hasnext();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_pushnull:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushnull):
                 exec_pushnull();
-                break;
-            case Code::op_pushundefined:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushundefined):
                 exec_pushundefined();
-                break;
-            case Code::op_not_tb:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_not_tb):
                 exec_not_tb();
-                break;
-            case Code::op_nextvalue:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_nextvalue):
                 exec_nextvalue();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_pushbyte:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushbyte):
                 exec_pushbyte(static_cast<UInt8>(Read8(cp)));
-                break;
-            case Code::op_pushshort:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushshort):
                 exec_pushshort(ReadU30(cp));
-                break;
-            case Code::op_pushtrue:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushtrue):
                 exec_pushtrue();
-                break;
-            case Code::op_pushfalse:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushfalse):
                 exec_pushfalse();
-                break;
-            case Code::op_pushnan:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushnan):
                 exec_pushnan();
-                break;
-            case Code::op_pop:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pop):
                 exec_pop();
-                break;
-            case Code::op_dup:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_dup):
                 exec_dup();
-                break;
-            case Code::op_swap:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_swap):
                 exec_swap();
-                break;
-            case Code::op_pushstring:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushstring):
                 exec_pushstring(constp.GetString(AbsoluteIndex(ReadU30(cp))));
-                break;
-            case Code::op_pushint:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushint):
                 exec_pushint(constp.GetInt(ReadU30(cp)));
-                break;
-            case Code::op_pushuint:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushuint):
                 exec_pushuint(constp.GetUInt(ReadU30(cp)));
-                break;
-            case Code::op_pushdouble:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushdouble):
                 exec_pushdouble(constp.GetDouble(ReadU30(cp)));
-                break;
-            case Code::op_pushscope:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushscope):
                 exec_pushscope();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_pushnamespace:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pushnamespace):
                 exec_pushnamespace(file.GetInternedNamespace(ReadU30(cp)));
                 // ??? Exceptions ?
-                break;
-            case Code::op_hasnext2:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_hasnext2):
                 {
                     UInt32 object_reg = ReadU30(cp);
                     UInt32 index_reg = ReadU30(cp);
@@ -2735,7 +3055,7 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 }
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
+                SF_AS3_NEXT_OPCODE;
 #if 0
             case Code::op_li8:
                 exec_li8();
@@ -2750,56 +3070,56 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 exec_lf32();
                 break;
 #endif
-            case Code::op_increment_tu:
+            SF_AS3_OPCODE(op_increment_tu):
                 exec_increment_tu();
-                break;
-            case Code::op_decrement_tu:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_decrement_tu):
                 exec_decrement_tu();
-                break;
-            case Code::op_inclocal_tu:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_inclocal_tu):
                 exec_inclocal_tu(ReadU30(cp));
-                break;
-            case Code::op_declocal_tu:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_declocal_tu):
                 exec_declocal_tu(ReadU30(cp));
-                break;
-            case Code::op_lf64:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_lf64):
                 exec_lf64();
-                break;
-            case Code::op_si8:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_si8):
                 exec_si8();
-                break;
-            case Code::op_si16:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_si16):
                 exec_si16();
-                break;
-            case Code::op_si32:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_si32):
                 exec_si32();
-                break;
-            case Code::op_sf32:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_sf32):
                 exec_sf32();
-                break;
-            case Code::op_sf64:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_sf64):
                 exec_sf64();
-                break;
-            case Code::op_newfunction:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_newfunction):
                 exec_newfunction(call_frame, ReadU30(cp));
                 // No exceptions in exec_newfunction.
                 // Tamarin throws exceptions in this opcode.
-                break;
-            case Code::op_call:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_call):
                 exec_call(ReadU30(cp));
 
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_construct:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_construct):
                 exec_construct(ReadU30(cp));
                 
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_callmethod:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callmethod):
                 {
                     UInt32 method_index = ReadU30(cp);
                     UInt32 arg_count = ReadU30(cp);
@@ -2809,8 +3129,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_callsupermethod:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callsupermethod):
                 {
                     UInt32 method_index = ReadU30(cp);
                     UInt32 arg_count = ReadU30(cp);
@@ -2820,8 +3140,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
 
-                break;
-            case Code::op_callgetter:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callgetter):
                 {
                     UInt32 method_index = ReadU30(cp);
                     UInt32 arg_count = ReadU30(cp);
@@ -2831,8 +3151,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
 
-                break;
-            case Code::op_callsupergetter:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callsupergetter):
                 {
                     UInt32 method_index = ReadU30(cp);
                     UInt32 arg_count = ReadU30(cp);
@@ -2842,8 +3162,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
 
-                break;
-            case Code::op_callstatic:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callstatic):
                 {
                     Abc::MiInd _1(ReadU30(cp));
                     UInt32 _2 = ReadU30(cp);
@@ -2853,8 +3173,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_callsuper:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callsuper):
                 {
                     UInt32 _1 = ReadU30(cp);
                     UInt32 _2 = ReadU30(cp);
@@ -2864,8 +3184,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_callproperty:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callproperty):
                 {
                     UInt32 _1 = ReadU30(cp);
                     UInt32 _2 = ReadU30(cp);
@@ -2875,12 +3195,12 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_returnvoid:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_returnvoid):
                 exec_returnvoid();
                 state = sReturn;
                 goto call_stack_label;
-            case Code::op_returnvalue:
+            SF_AS3_OPCODE(op_returnvalue):
                 exec_returnvalue();
                 
                 if (ProcessException(cp, call_frame, state))
@@ -2888,7 +3208,7 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 
                 state = sReturn;
                 goto call_stack_label;
-            case Code::op_constructsuper:
+            SF_AS3_OPCODE(op_constructsuper):
                 {
                     const Traits& ot = call_frame.GetOriginationTraits();
                     exec_constructsuper(ot, ReadU30(cp));
@@ -2897,8 +3217,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_constructprop:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_constructprop):
                 {
                     UInt32 mn_ind = ReadU30(cp);
                     UInt32 arg_count = ReadU30(cp);
@@ -2908,8 +3228,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_callproplex:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callproplex):
                 {
                     UInt32 mn_ind = ReadU30(cp);
                     UInt32 arg_count = ReadU30(cp);
@@ -2919,8 +3239,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_callsupervoid:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callsupervoid):
                 {
                     UInt32 mn_ind = ReadU30(cp);
                     UInt32 _2 = ReadU30(cp);
@@ -2930,8 +3250,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_callpropvoid:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_callpropvoid):
                 {
                     UInt32 mn_ind = ReadU30(cp);
                     UInt32 _2 = ReadU30(cp);
@@ -2941,57 +3261,57 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_sxi1:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_sxi1):
                 exec_sxi1();
-                break;
-            case Code::op_sxi8:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_sxi8):
                 exec_sxi8();
-                break;
-            case Code::op_sxi16:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_sxi16):
                 exec_sxi16();
-                break;
-            case Code::op_applytype:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_applytype):
                 exec_applytype(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_newobject:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_newobject):
                 exec_newobject(ReadU30(cp));
                 // Tamarin throws exceptions in this opcode.
-                break;
-            case Code::op_newarray:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_newarray):
                 exec_newarray(ReadU30(cp));
                 // No exceptions in exec_newarray().
                 // Tamarin throws exceptions in this opcode.
-                break;
-            case Code::op_newactivation:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_newactivation):
                 exec_newactivation(call_frame);
                 // No exceptions in exec_newactivation().
                 // Tamarin throws exceptions in this opcode.
-                break;
-            case Code::op_newclass:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_newclass):
                 exec_newclass(file, ReadU30(cp));
 
                 if (ProcessException(cp, call_frame, state) || NeedToStepInto(call_stack_size, state))
                     goto call_stack_label;
                 
-                break;
-            case Code::op_getdescendants:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getdescendants):
                 exec_getdescendants(file, constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_newcatch:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_newcatch):
                 exec_newcatch(file, call_frame.GetException().Get(ReadU30(cp)));
                 // Tamarin throws exceptions in this opcode.
-                break;
-            case Code::op_findpropstrict:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_findpropstrict):
                 exec_findpropstrict(file, constp.GetMultiname(ReadU30(cp)), call_frame.GetSavedScope());
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_findproperty:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_findproperty):
                 exec_findproperty(
                     file, 
                     constp.GetMultiname(ReadU30(cp)), 
@@ -3000,27 +3320,27 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                     );
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_getlex:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getlex):
                 exec_getlex(file, constp.GetMultiname(ReadU30(cp)), call_frame.GetSavedScope());
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_setproperty:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setproperty):
                 exec_setproperty(file, constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_getlocal:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getlocal):
                 exec_getlocal(ReadU30(cp));
-                break;
-            case Code::op_setlocal:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setlocal):
                 exec_setlocal(ReadU30(cp));
-                break;
-            case Code::op_getglobalscope:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getglobalscope):
                 exec_getglobalscope();
-                break;
-            case Code::op_getscopeobject:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getscopeobject):
                 {
                     // Get a scope object.
                     const int scope_index = ReadU30(cp);
@@ -3033,422 +3353,422 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
                 */
-                break;
-            case Code::op_getproperty:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getproperty):
                 exec_getproperty(file, constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_getouterscope:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getouterscope):
                 exec_getouterscope(call_frame, ReadU30(cp));
                 /* This check should be eliminated by the Verifier.
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
                 */
-                break;
-            case Code::op_initproperty:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_initproperty):
                 exec_initproperty(file, constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_pop_nrc:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_pop_nrc):
                 exec_pop_nrc();
-                break;
-            case Code::op_deleteproperty:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_deleteproperty):
                 exec_deleteproperty(file, constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_dup_nrc:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_dup_nrc):
                 exec_dup_nrc();
-                break;
-            case Code::op_getslot:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getslot):
                 exec_getslot(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_setslot:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setslot):
                 exec_setslot(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_getglobalslot:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getglobalslot):
                 exec_getglobalslot(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_setglobalslot:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setglobalslot):
                 exec_setglobalslot(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_convert_s:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_convert_s):
                 exec_convert_s();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_esc_xelem:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_esc_xelem):
                 exec_esc_xelem();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_esc_xattr:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_esc_xattr):
                 exec_esc_xattr();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_convert_i:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_convert_i):
                 exec_convert_i();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_convert_u:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_convert_u):
                 exec_convert_u();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_convert_d:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_convert_d):
                 exec_convert_d();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_convert_b:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_convert_b):
                 exec_convert_b();
                 // Doesn't throw exceptions.
-                break;
-            case Code::op_convert_o:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_convert_o):
                 exec_convert_o();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_checkfilter:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_checkfilter):
                 exec_checkfilter();
                 // ??? Exceptions?
-                break;
-            case Code::op_coerce:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_coerce):
                 exec_coerce(file, constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_coerce_a:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_coerce_a):
                 exec_coerce_a();
-                break;
-            case Code::op_coerce_s:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_coerce_s):
                 exec_coerce_s();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_astype:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_astype):
                 exec_astype(file, constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_astypelate:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_astypelate):
                 exec_astypelate();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_negate:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_negate):
                 exec_negate();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_increment:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_increment):
                 exec_increment();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_inclocal:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_inclocal):
                 exec_inclocal(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_decrement:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_decrement):
                 exec_decrement();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_declocal:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_declocal):
                 exec_declocal(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_typeof:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_typeof):
                 exec_typeof();
-                break;
-            case Code::op_not:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_not):
                 exec_not();
-                break;
-            case Code::op_bitnot:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_bitnot):
                 exec_bitnot();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_add_d:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_add_d):
                 exec_add_d();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_add:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_add):
                 exec_add();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_subtract:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_subtract):
                 exec_subtract();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_multiply:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_multiply):
                 exec_multiply();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_divide:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_divide):
                 exec_divide();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_divide_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_divide_td):
                 exec_divide_td();
                 // We shouldn't have exceptions here.
-                break;
-            case Code::op_modulo:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_modulo):
                 exec_modulo();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_lshift:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_lshift):
                 exec_lshift();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_rshift:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_rshift):
                 exec_rshift();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_urshift:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_urshift):
                 exec_urshift();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_bitand:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_bitand):
                 exec_bitand();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_bitor:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_bitor):
                 exec_bitor();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_bitxor:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_bitxor):
                 exec_bitxor();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_equals:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_equals):
                 exec_equals();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_strictequals:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_strictequals):
                 exec_strictequals();
-                break;
-            case Code::op_lessthan:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_lessthan):
                 exec_lessthan();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_lessequals:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_lessequals):
                 exec_lessequals();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_greaterthan:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_greaterthan):
                 exec_greaterthan();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_greaterequals:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_greaterequals):
                 exec_greaterequals();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_instanceof:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_instanceof):
                 exec_instanceof();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_istype:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_istype):
                 exec_istype(file, constp.GetMultiname(ReadU30(cp)));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_istypelate:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_istypelate):
                 exec_istypelate();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_in:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_in):
                 exec_in();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_getabsobject:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getabsobject):
                 exec_getabsobject(ReadUPInt(cp));
-                break;
-            case Code::op_getabsslot:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getabsslot):
                 exec_getabsslot(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_setabsslot:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setabsslot):
                 exec_setabsslot(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_initabsslot:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_initabsslot):
                 exec_initabsslot(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_increment_i:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_increment_i):
                 exec_increment_i();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_decrement_i:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_decrement_i):
                 exec_decrement_i();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_increment_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_increment_ti):
                 exec_increment_ti();
-                break;
-            case Code::op_decrement_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_decrement_ti):
                 exec_decrement_ti();
-                break;
-            case Code::op_inclocal_i:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_inclocal_i):
                 exec_inclocal_i(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_inclocal_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_inclocal_ti):
                 exec_inclocal_ti(ReadU30(cp));
-                break;
-            case Code::op_declocal_i:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_declocal_i):
                 exec_declocal_i(ReadU30(cp));
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_declocal_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_declocal_ti):
                 exec_declocal_ti(ReadU30(cp));
-                break;
-            case Code::op_negate_i:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_negate_i):
                 exec_negate_i();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_negate_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_negate_ti):
                 exec_negate_ti();
                 // We shouldn't have exceptions here.
-                break;
-            case Code::op_negate_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_negate_td):
                 exec_negate_td();
                 // We shouldn't have exceptions here.
-                break;
-            case Code::op_add_i:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_add_i):
                 exec_add_i();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_add_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_add_ti):
                 exec_add_ti();
                 // We shouldn't have exceptions here.
-                break;
-            case Code::op_add_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_add_td):
                 exec_add_td();
                 // We shouldn't have exceptions here.
-                break;
-            case Code::op_subtract_i:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_subtract_i):
                 exec_subtract_i();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_subtract_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_subtract_ti):
                 exec_subtract_ti();
                 // We shouldn't have exceptions here.
-                break;
-            case Code::op_subtract_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_subtract_td):
                 exec_subtract_td();
                 // We shouldn't have exceptions here.
-                break;
-            case Code::op_multiply_i:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_multiply_i):
                 exec_multiply_i();
                 if (ProcessException(cp, call_frame, state))
                     goto call_stack_label;
-                break;
-            case Code::op_multiply_ti:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_multiply_ti):
                 exec_multiply_ti();
                 // We shouldn't have exceptions here.
-                break;
-            case Code::op_multiply_td:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_multiply_td):
                 exec_multiply_td();
                 // We shouldn't have exceptions here.
-                break;
-            case Code::op_getlocal0:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getlocal0):
                 exec_getlocal0();
-                break;
-            case Code::op_getlocal1:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getlocal1):
                 exec_getlocal1();
-                break;
-            case Code::op_getlocal2:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getlocal2):
                 exec_getlocal2();
-                break;
-            case Code::op_getlocal3:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_getlocal3):
                 exec_getlocal3();
-                break;
-            case Code::op_setlocal0:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setlocal0):
                 exec_setlocal0();
-                break;
-            case Code::op_setlocal1:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setlocal1):
                 exec_setlocal1();
-                break;
-            case Code::op_setlocal2:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setlocal2):
                 exec_setlocal2();
-                break;
-            case Code::op_setlocal3:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setlocal3):
                 exec_setlocal3();
-                break;
+                SF_AS3_NEXT_OPCODE;
 #ifdef ENABLE_STRICT_SETSLOT
-            case Code::op_setslot_str:
+            SF_AS3_OPCODE(op_setslot_str):
                 exec_setslot_str(ReadU30(cp));
-                break;
-            case Code::op_setslot_num:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setslot_num):
                 exec_setslot_num(ReadU30(cp));
-                break;
-            case Code::op_setslot_uint:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setslot_uint):
                 exec_setslot_uint(ReadU30(cp));
-                break;
-            case Code::op_setslot_sint:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setslot_sint):
                 exec_setslot_sint(ReadU30(cp));
-                break;
-            case Code::op_setslot_bool:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setslot_bool):
                 exec_setslot_bool(ReadU30(cp));
-                break;
-            case Code::op_setslot_value:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setslot_value):
                 exec_setslot_value(ReadU30(cp));
-                break;
-            case Code::op_setslot_obj_as:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setslot_obj_as):
                 exec_setslot_obj_as(ReadU30(cp));
-                break;
-            case Code::op_setslot_obj_cpp:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_setslot_obj_cpp):
                 exec_setslot_obj_cpp(ReadU30(cp));
-                break;
+                SF_AS3_NEXT_OPCODE;
 #endif
-            case Code::op_debug:
+            SF_AS3_OPCODE(op_debug):
                 {
                     const UInt8 debug_type = static_cast<UInt8>(Read8(cp));
                     const int name_ind = ReadU30(cp);
@@ -3457,17 +3777,21 @@ int VM::ExecuteCode(unsigned max_stack_depth)
                     SF_UNUSED4(debug_type, name_ind, dreg, extra);
                 }
                 exec_debug();
-                break;
-            case Code::op_debugline:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_debugline):
                 exec_debugline(call_frame, ReadU30(cp));
-                break;
-            case Code::op_debugfile:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_debugfile):
                 exec_debugfile(call_frame, ReadU30(cp));
-                break;
-            case Code::op_0xF2:
+                SF_AS3_NEXT_OPCODE;
+            SF_AS3_OPCODE(op_0xF2):
                 ReadU30(cp);
                 // ???
+                SF_AS3_NEXT_OPCODE;
+#ifdef SF_AS3_ENABLE_THREADED_DISPATCH
+            label_op_unknown:
                 break;
+#endif
             }
 
             // Prefetch here will slow down the code on Windows.
@@ -3512,5 +3836,8 @@ int VM::ExecuteCode(unsigned max_stack_depth)
     return max_stack_depth;
 }
 
+#undef SF_AS3_OPCODE
+#undef SF_AS3_NEXT_OPCODE
+
 }}} // namespace Scaleform { namespace GFx { namespace AS3 {
 
@@ -34,6 +34,15 @@ namespace Scaleform { namespace GFx { namespace AS3
 // max num of roots before collection, off by default
 #define SF_GC_DEFAULT_MAX_FRAMES_BTW_COLL 0
 
+// time budget of an incremental collection slice, in microseconds; 
+// off by default
+#define SF_GC_DEFAULT_SLICE_TIME 0
+
+// Initial share of the slice given to MarkInCycle, in percents; it is 
+// adjusted after each slice.
+#define SF_GC_DEFAULT_MARK_TIME_PERCENT 50
+#define SF_GC_MIN_MARK_TIME_PERCENT     10
+
 ///////////////////////////////////////////////////////////////////////////
 //
 ASRefCountCollector::ASRefCountCollector()
@@ -53,12 +62,18 @@ ASRefCountCollector::ASRefCountCollector()
     RunsToCollectYoung   = 0;
     RunsToCollectOld     = 0;
 
+    MarkTimePercent      = SF_GC_DEFAULT_MARK_TIME_PERCENT;
+    IncrementalGen       = ~0u;
+    IncrementalUpgradeGen= false;
+    IncrementalStartRoots= 0;
+    IncrementalFreedRoots= 0;
+
     SetParams(~0u, ~0u);
 }
 
 void ASRefCountCollector::SetParams(unsigned frameBetweenCollections, unsigned maxRootCount,
                                     unsigned runsToUpgradeGen, unsigned runsToCollectYoung,
-                                    unsigned runsToCollectOld)
+                                    unsigned runsToCollectOld, unsigned sliceTime)
 {
     // max num of roots before collection
     if (frameBetweenCollections != ~0u)
@@ -86,6 +101,11 @@ void ASRefCountCollector::SetParams(unsigned frameBetweenCollections, unsigned m
         RunsToCollectOld   = runsToCollectOld;
     else
         RunsToCollectOld   = SF_GC_DEFAULT_RUNS_TO_COLLECT_OLD;
+
+    if (sliceTime != ~0u)
+        SliceTime          = sliceTime;
+    else
+        SliceTime          = SF_GC_DEFAULT_SLICE_TIME;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -145,57 +165,128 @@ void ASRefCountCollector::AdvanceFrame
     ++FrameCnt;
     PeakRootCount = Alg::Max(PeakRootCount, curRootCount);
 
+    if (!IsSuspended() && IsCollectingIncrementally())
+    {
+        // Continue the collection started at one of the previous frames.
+        CollectSlice(ampStats);
+    }
     // Collection occurs if:
     // 1) if number of root exceeds currently set MaxRootCount;
     // 2) if MaxFramesBetweenCollections is set to value higher than 0 and the
     //    frame counter (FrameCnt) exceeds this value, and number of roots
     //    exceeds PresetMaxRootCount.
-    if (!IsSuspended() && ((PresetMaxRootCount != 0 && curRootCount > MaxRootCount) || 
+    else if (!IsSuspended() && ((PresetMaxRootCount != 0 && curRootCount > MaxRootCount) || 
         (MaxFramesBetweenCollections != 0 && 
         FrameCnt >= MaxFramesBetweenCollections && 
         curRootCount > PresetMaxRootCount)))
     {
-        ASRefCountCollector::Stats stats(ampStats);
-        Collect(gen, upgradeGen, &stats);
-        ++RunsCnt;
+        if (SliceTime != 0)
+        {
+            IncrementalGen        = gen;
+            IncrementalUpgradeGen = upgradeGen;
+            IncrementalStartRoots = curRootCount;
+            IncrementalFreedRoots = 0;
+            CollectSlice(ampStats);
+        }
+        else
+        {
+            ASRefCountCollector::Stats stats(ampStats);
+            Collect(gen, upgradeGen, &stats);
 
 #ifdef SF_TRACE_COLLECTIONS        
-        printf("Collect! Total roots %d, Roots Processed %d, MaxRoots %d, Peak %d, Iterated %d, "
-            "Freed %d, Gens %d, frames between %d, upgradeGen '%s'\n", 
-            curRootCount, stats.RootsNumber, MaxRootCount, PeakRootCount, stats.ObjectsIteratedNumber, 
-            stats.ObjectsFreedTotal, stats.GensNumber, (TotalFramesCount - LastCollectionFrameNum), 
-            (upgradeGen)?"true":"false");
+            printf("Collect! Total roots %d, Roots Processed %d, MaxRoots %d, Peak %d, Iterated %d, "
+                "Freed %d, Gens %d, frames between %d, upgradeGen '%s'\n", 
+                curRootCount, stats.RootsNumber, MaxRootCount, PeakRootCount, stats.ObjectsIteratedNumber, 
+                stats.ObjectsFreedTotal, stats.GensNumber, (TotalFramesCount - LastCollectionFrameNum), 
+                (upgradeGen)?"true":"false");
 #endif
-
-        // If number of roots exceeds the preset max root count then we need to reset the PeakRootCount
-        // in order to decrease currently set MaxRootCount.
-        if (stats.RootsFreedTotal > PresetMaxRootCount)
-        {
-            PeakRootCount = curRootCount; // reset peak count
-            MaxRootCount = PresetMaxRootCount;
+            OnCollected(curRootCount, stats.RootsFreedTotal);
         }
+    }
+    LastRootCount = curRootCount;
+    *movieFrameCnt = FrameCnt;
+    *movieLastCollectFrame = LastCollectionFrameNum;
+}
+
+// Updates the counters after a regular collection of rootCount roots.
+void ASRefCountCollector::OnCollected(unsigned rootCount, unsigned rootsFreed)
+{
+    ++RunsCnt;
 
-        // MaxRootCount has been updated every collection event
-        //MaxRootCount = Alg::Max(PresetMaxRootCount, PeakRootCount - stats.RootsFreedTotal);
-        MaxRootCount = Alg::Max(MaxRootCount, curRootCount - stats.RootsFreedTotal);
+    // If number of roots exceeds the preset max root count then we need to reset the PeakRootCount
+    // in order to decrease currently set MaxRootCount.
+    if (rootsFreed > PresetMaxRootCount)
+    {
+        PeakRootCount = rootCount; // reset peak count
+        MaxRootCount = PresetMaxRootCount;
+    }
 
-        if (PeakRootCount < (unsigned)(MaxRootCount * 0.7))
-            MaxRootCount = (unsigned)(MaxRootCount * 0.7);
+    // MaxRootCount has been updated every collection event
+    //MaxRootCount = Alg::Max(PresetMaxRootCount, PeakRootCount - rootsFreed);
+    MaxRootCount = Alg::Max(MaxRootCount, rootCount - Alg::Min(rootCount, rootsFreed));
+
+    if (PeakRootCount < (unsigned)(MaxRootCount * 0.7))
+        MaxRootCount = (unsigned)(MaxRootCount * 0.7);
 
 #ifdef SF_TRACE_COLLECTIONS        
-        SF_ASSERT((int)MaxRootCount >= 0);
-        printf("new maxroots %d\n", MaxRootCount);
+    SF_ASSERT((int)MaxRootCount >= 0);
+    printf("new maxroots %d\n", MaxRootCount);
 #endif
 
-        LastCollectionFrameNum = TotalFramesCount;
+    LastCollectionFrameNum = TotalFramesCount;
+
+    FrameCnt          = 0;
+    LastPeakRootCount = PeakRootCount;
+    LastCollectedRoots= rootsFreed;
+}
+
+// Runs one slice of an incremental collection. Each slice is a complete 
+// collection of the roots it takes: MarkInCycle stops taking roots when its
+// share of SliceTime is used, and the objects marked so far are scanned and 
+// freed before returning. Since the trial decrements of refcounts are undone
+// within the slice, AS code running between slices only adds and removes 
+// roots as usual; roots added meanwhile are processed by the next slices.
+void ASRefCountCollector::CollectSlice(AmpStats* ampStats)
+{
+    SF_AMP_SCOPE_TIMER(ampStats, "GC::CollectSlice", Amp_Profile_Level_Low);
+    SF_ASSERT(IsCollectingIncrementally());
+
+    // If roots are added faster than slices process them, finish the 
+    // collection at once rather than let it run forever.
+    unsigned curRootCount  = (unsigned)GetRootsCount(IncrementalGen);
+    UInt64   markTimeLimit = 0;
+    if (curRootCount <= IncrementalStartRoots * 2)
+        markTimeLimit = Alg::Max<UInt64>(1, (UInt64)SliceTime * MarkTimePercent / 100);
 
-        FrameCnt          = 0;
-        LastPeakRootCount = PeakRootCount;
-        LastCollectedRoots= stats.RootsFreedTotal;
+    ASRefCountCollector::Stats stats(ampStats);
+    UInt64 startTime = Timer::GetProfileTicks();
+    Collect(IncrementalGen, IncrementalUpgradeGen, &stats, markTimeLimit);
+    UInt64 sliceTime = Timer::GetProfileTicks() - startTime;
+
+    IncrementalFreedRoots += stats.RootsFreedTotal;
+
+#ifdef SF_TRACE_COLLECTIONS        
+    printf("Collect slice! Total roots %d, Roots Processed %d, Iterated %d, Freed %d, "
+        "Gens %d, mark time %d, slice time %d, complete '%s'\n", 
+        curRootCount, stats.RootsNumber, stats.ObjectsIteratedNumber, stats.ObjectsFreedTotal, 
+        stats.GensNumber, (int)stats.MarkTime, (int)sliceTime, (stats.Complete)?"true":"false");
+#endif
+
+    if (!stats.Complete)
+    {
+        // MarkInCycle used all of its share; scale the share so that the 
+        // whole slice fits SliceTime next time.
+        if (sliceTime > 0)
+        {
+            unsigned percent = (unsigned)Alg::Min<UInt64>(100, stats.MarkTime * 100 / sliceTime);
+            MarkTimePercent = Alg::Max<unsigned>(SF_GC_MIN_MARK_TIME_PERCENT, 
+                                                 (MarkTimePercent + percent) / 2);
+        }
+        return;
     }
-    LastRootCount = curRootCount;
-    *movieFrameCnt = FrameCnt;
-    *movieLastCollectFrame = LastCollectionFrameNum;
+
+    IncrementalGen = ~0u;
+    OnCollected(IncrementalStartRoots, IncrementalFreedRoots);
 }
 
 void ASRefCountCollector::ForceCollect(AmpStats* ampStats, unsigned collectFlags)
@@ -203,6 +294,10 @@ void ASRefCountCollector::ForceCollect(AmpStats* ampStats, unsigned collectFlags
     if (IsSuspended())
         return;
 
+    // A forced collection ends the incremental one; the roots it doesn't
+    // process stay buffered and count towards the next collection.
+    IncrementalGen = ~0u;
+
     bool upgradeGen = false;
     // Determine if we need to upgrade generations.
     unsigned gen = CheckGenerations(&upgradeGen);
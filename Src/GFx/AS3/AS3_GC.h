@@ -20,6 +20,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "AS3_Value.h" // Because of ValueArray
 #include "Kernel/SF_ArrayPaged.h"
 #include "Kernel/SF_AmpInterface.h"
+#include "Kernel/SF_Timer.h"
 
 // Uncomment the line below to enable recursionless Release. This will avoid recursions
 // during execution of Release but will make it slower.
@@ -498,11 +499,18 @@ public:
         unsigned ObjectsIteratedNumber;     // total number of objects iterated by the Collector (might be > RootsNumber)
         unsigned ObjectsFreedTotal;         // total number of objects freed during collection (might be > RootsFreedTotal)
         unsigned GensNumber;                // number of generations collected (1..3)
+        UInt64   MarkTime;                  // microseconds spent in MarkInCycle, measured only if time limited
+        bool     Complete;                  // false if roots were left for the next call by the time limit
 
         Stats(AmpStats* advanceStats) 
             : AdvanceStats(advanceStats) { ResetStats(); } 
 
-        void ResetStats() { RootsNumber = RootsFreedTotal = ObjectsIteratedNumber = ObjectsFreedTotal = GensNumber = 0; }
+        void ResetStats() 
+        { 
+            RootsNumber = RootsFreedTotal = ObjectsIteratedNumber = ObjectsFreedTotal = GensNumber = 0; 
+            MarkTime = 0;
+            Complete = false;
+        }
     };
 
 public:
@@ -523,7 +531,12 @@ public:
 
     // Perform collection. Returns 'true' if collection process was 
     // executed.
-    bool Collect(unsigned uptoGeneration, bool upgradeGen, Stats* pstat = NULL);
+    // If markTimeLimit (in microseconds) is not 0, no more roots are taken once
+    // MarkInCycle has run for that long; the roots taken so far are scanned and
+    // freed as usual, and the rest stay in the roots list for the next call.
+    // Refcounts of all the processed objects are restored before returning, 
+    // so the mutator may run between such calls.
+    bool Collect(unsigned uptoGeneration, bool upgradeGen, Stats* pstat = NULL, UInt64 markTimeLimit = 0);
 
     // Returns number of roots; might be used to determine necessity
     // of call to Collect.
@@ -891,7 +904,7 @@ void RefCountCollector<Stat>::RemoveFromRoots(const RefCountBaseGC<Stat>* root)
 
 template <int Stat>
 inline
-bool RefCountCollector<Stat>::Collect(unsigned uptoGeneration, bool upgradeGen, Stats* pstat)
+bool RefCountCollector<Stat>::Collect(unsigned uptoGeneration, bool upgradeGen, Stats* pstat, UInt64 markTimeLimit)
 {
     Flags &= ~Flags_RequireMoreCollect;
 
@@ -915,11 +928,14 @@ bool RefCountCollector<Stat>::Collect(unsigned uptoGeneration, bool upgradeGen,
     unsigned initialNRoots     = 0;
     unsigned totalKillListSize = 0;
     unsigned totalObjsProcessed= 0;
+    UInt64   markTime          = 0;
+    bool     timedOut          = false;
 
     if (Flags & Flags_ForcedCleanup)
     {
         upgradeGen = false;
         uptoGeneration = RefCountBaseGC<Stat>::Gen_Max;
+        markTimeLimit = 0;
     }
     CurrentMaxGen = uptoGeneration;
 
@@ -946,6 +962,8 @@ bool RefCountCollector<Stat>::Collect(unsigned uptoGeneration, bool upgradeGen,
             SF_AMP_SCOPE_TIMER_ID(ampStats, "GC::MarkInCycle", Amp_Native_Function_Id_GcMarkInCycle);
 
             Flags |= Flags_MarkInCycle;
+            UInt64 markStartTime = (markTimeLimit) ? Timer::GetProfileTicks() : 0;
+
             // Mark roots stage.
             // For each root from Roots array:
             //   1) if not marked as root - skip (clear "buffered" flag);
@@ -955,13 +973,23 @@ bool RefCountCollector<Stat>::Collect(unsigned uptoGeneration, bool upgradeGen,
             //      decrementing their refcnt; if a child is already in the list then just decrement refcnt
             //      and mark it as "in cycle".
             //   4) repeat steps 1-4 until end of the list.
-            for (unsigned i = 0; i <= uptoGeneration; ++i)
+            // If the time limit is reached, stop at a root boundary: the subgraphs of the
+            // roots taken so far are complete, so they can be scanned as usual.
+            for (unsigned i = 0; i <= uptoGeneration && !timedOut; ++i)
             {
                 RootDesc& rootsHead = Roots[i];
                 const RefCountBaseGC<Stat>* cur = rootsHead.pRootHead;
 
                 while(cur)
                 {
+                    // Take at least one root per call, so collection always progresses.
+                    if (markTimeLimit && (initialNRoots + rootsIterated) > 0 &&
+                        markTime + (Timer::GetProfileTicks() - markStartTime) >= markTimeLimit)
+                    {
+                        timedOut = true;
+                        break;
+                    }
+
                     // remove cur from the roots list
                     rootsHead.pRootHead = cur->pNextRoot;
                     if (rootsHead.pRootHead)
@@ -1034,8 +1062,10 @@ bool RefCountCollector<Stat>::Collect(unsigned uptoGeneration, bool upgradeGen,
                     cur = rootsHead.pRootHead;
                     ++rootsIterated;
                 }
-                SF_ASSERT(!rootsHead.pRootHead);
+                SF_ASSERT(timedOut || !rootsHead.pRootHead);
             }
+            if (markTimeLimit)
+                markTime += Timer::GetProfileTicks() - markStartTime;
             Flags &= ~Flags_MarkInCycle;
         }
 
@@ -1246,9 +1276,9 @@ bool RefCountCollector<Stat>::Collect(unsigned uptoGeneration, bool upgradeGen,
         }
         upgradeGen = false;
         //uptoGeneration = RefCountBaseGC<Stat>::Gen_NewBorn;
-    } while (Roots[0].pRootHead != NULL || 
+    } while (!timedOut && (Roots[0].pRootHead != NULL || 
             (uptoGeneration == RefCountBaseGC<Stat>::Gen_Old && Roots[RefCountBaseGC<Stat>::Gen_Old].pRootHead) ||
-            (uptoGeneration >= RefCountBaseGC<Stat>::Gen_Young && Roots[RefCountBaseGC<Stat>::Gen_Young].pRootHead));
+            (uptoGeneration >= RefCountBaseGC<Stat>::Gen_Young && Roots[RefCountBaseGC<Stat>::Gen_Young].pRootHead)));
     
     if (pstat)
     {
@@ -1260,6 +1290,8 @@ bool RefCountCollector<Stat>::Collect(unsigned uptoGeneration, bool upgradeGen,
         pstat->ObjectsIteratedNumber    = totalObjsProcessed;
         pstat->ObjectsFreedTotal        = totalKillListSize;
         pstat->GensNumber               = gensProcessed;
+        pstat->MarkTime                 = markTime;
+        pstat->Complete                 = !timedOut;
         if (ampStats)
         {
             ampStats->AddGcRoots(pstat->RootsNumber);
@@ -1295,17 +1327,32 @@ class ASRefCountCollector : public RefCountCollector<Mem_Stat>
     unsigned    CollectionScheduledFlags;
     UInt8       SuspendCnt;
 
-    void Collect(unsigned uptoGeneration, bool upgradeGen, Stats* pstat = NULL)
+    // Incremental collection. If SliceTime is not 0, a collection triggered by
+    // AdvanceFrame is split into slices, one per frame, until all the roots
+    // buffered for IncrementalGen are processed.
+    unsigned    SliceTime;          // time budget of a slice, in microseconds
+    unsigned    MarkTimePercent;    // share of SliceTime given to MarkInCycle
+    unsigned    IncrementalGen;     // generation being collected, ~0u if none
+    bool        IncrementalUpgradeGen;
+    unsigned    IncrementalStartRoots;
+    unsigned    IncrementalFreedRoots;
+
+    void Collect(unsigned uptoGeneration, bool upgradeGen, Stats* pstat = NULL, UInt64 markTimeLimit = 0)
     {
-        RefCountCollector<Mem_Stat>::Collect(uptoGeneration, upgradeGen, pstat);
+        RefCountCollector<Mem_Stat>::Collect(uptoGeneration, upgradeGen, pstat, markTimeLimit);
     }
     unsigned CheckGenerations(bool* upgradeGen);
+    void     CollectSlice(AmpStats* ampStats);
+    void     OnCollected(unsigned rootCount, unsigned rootsFreed);
 public:
     ASRefCountCollector();
 
     void SetParams(unsigned frameBetweenCollections, unsigned maxRootCount, 
         unsigned runsToUpgradeGen = ~0u, unsigned runsToCollectYoung = ~0u,
-        unsigned runsToCollectOld = ~0u);
+        unsigned runsToCollectOld = ~0u, unsigned sliceTime = ~0u);
+
+    // Returns true while an incremental collection is spread over frames.
+    bool IsCollectingIncrementally() const { return IncrementalGen != ~0u; }
 
     // This method should be called every frame (every full advance). 
     // It evaluates necessity of collection and performs it if necessary.
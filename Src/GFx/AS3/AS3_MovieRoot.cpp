@@ -327,6 +327,11 @@ bool MovieRoot::CheckAvm()
         } l;
 
         pAVM = SF_HEAP_NEW(GetMovieHeap()) ASVM(this, *this, l, *GetStringManager(), *(MemContext->ASGC));
+        if (pac != NULL)
+            pAVM->SetPreTraceTime(pac->GetPreTraceTime());
+        Ptr<ASSupport> pas3Support = pMovieImpl->pStateBag->GetAS3Support();
+        if (pas3Support)
+            pAVM->SetOpCodeCache(static_cast<AS3Support*>(pas3Support.GetPtr())->GetOpCodeCache());
         pAVM->ExecuteCode();
     }
     return (pAVM.GetPtr() != NULL);
@@ -351,7 +356,7 @@ bool MovieRoot::ExecuteAbc(AbcDataBuffer* pabc, DisplayObjContainer* m)
 
     if (!vmAbc)
     {
-        AutoPtr<Abc::Reader> pReader = SF_HEAP_NEW(GetMovieHeap()) Abc::Reader(pabc->Data, pabc->DataSize);
+        AutoPtr<Abc::Reader> pReader = SF_HEAP_NEW(GetMovieHeap()) Abc::Reader(pabc->pData, pabc->DataSize);
         Ptr<Abc::File>  pAbcFile = *SF_HEAP_NEW(GetMovieHeap()) ASVM::AbcFileWithMovieDef(pdefImpl, pabc);
 
         //pAbcFile->SetSource(pdefImpl->GetFileURL());
@@ -1408,6 +1413,13 @@ void MovieRoot::AdvanceFrame(bool nextFrame)
                 (&NumAdvancesSinceCollection, &LastCollectionFrame, pMovieImpl->AdvanceStats);
 #endif // SF_NO_GC
         }
+
+        // Trace methods of the classes created so far ahead of their first call.
+        if (pAVM && pAVM->GetPreTraceTime() != 0)
+        {
+            SF_AMP_SCOPE_TIMER(pMovieImpl->AdvanceStats, "VM::PreTrace", Amp_Profile_Level_Low);
+            pAVM->PreTrace();
+        }
     }
 }
 
@@ -0,0 +1,349 @@
+/**************************************************************************
+
+Filename    :   AS3_OpCodeCache.cpp
+Content     :   Persistent cache of traced AS3 method code.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "GFx/AS3/AS3_OpCodeCache.h"
+#include "Kernel/SF_SysFile.h"
+#include "Kernel/SF_HeapNew.h"
+#include "Kernel/SF_Debug.h"
+
+namespace Scaleform { namespace GFx { namespace AS3 {
+
+// File layout, header values are little-endian:
+//   "SFOC", Version, ByteOrder, WordSize, EntryCount, then for each entry
+//   FileHash, FilesHash, MethodBodyInd, CodeSize, Code, ExceptionCount,
+//   Exceptions, RelocCount, Relocs and Checksum.
+// Code is stored in native byte order and word size, so files are rejected
+// if ByteOrder or WordSize don't match. Checksum is the 64-bit FNV-1a of
+// the bytes of the entry that precede it; entries that don't match it 
+// are dropped.
+
+static const UByte OpCodeCache_Magic[4] = { 'S', 'F', 'O', 'C' };
+
+// Reads or writes the data of an entry, computing its checksum.
+class OpCodeCache_Stream
+{
+public:
+    OpCodeCache_Stream(File* pfile) : pFile(pfile), Checksum(SF_UINT64(0xCBF29CE484222325)) { }
+
+    File*   GetFile() const     { return pFile; }
+    UInt64  GetChecksum() const { return Checksum; }
+
+    bool    Write(const void* data, UPInt size)
+    {
+        addChecksum(data, size);
+        return pFile->Write((const UByte*)data, (int)size) == (int)size;
+    }
+    bool    Read(void* data, UPInt size)
+    {
+        if (pFile->Read((UByte*)data, (int)size) != (int)size)
+            return false;
+        addChecksum(data, size);
+        return true;
+    }
+
+    void    WriteUInt32(UInt32 v)
+    {
+        v = (UInt32)Alg::ByteUtil::SystemToLE(v);
+        Write(&v, sizeof(v));
+    }
+    void    WriteUInt64(UInt64 v)
+    {
+        v = (UInt64)Alg::ByteUtil::SystemToLE(v);
+        Write(&v, sizeof(v));
+    }
+    UInt32  ReadUInt32()
+    {
+        UInt32 v = 0;
+        Read(&v, sizeof(v));
+        return (UInt32)Alg::ByteUtil::LEToSystem(v);
+    }
+    UInt64  ReadUInt64()
+    {
+        UInt64 v = 0;
+        Read(&v, sizeof(v));
+        return (UInt64)Alg::ByteUtil::LEToSystem(v);
+    }
+
+    void    WriteString(const String& str)
+    {
+        WriteUInt32((UInt32)str.GetSize());
+        Write(str.ToCStr(), str.GetSize());
+    }
+    bool    ReadString(String* str)
+    {
+        UInt32 size = ReadUInt32();
+        if (size > (UInt32)pFile->BytesAvailable())
+            return false;
+        ArrayPOD<char> buffer;
+        buffer.Resize(size + 1);
+        if (!Read(buffer.GetDataPtr(), size))
+            return false;
+        buffer[size] = 0;
+        *str = String(buffer.GetDataPtr(), size);
+        return true;
+    }
+
+private:
+    void    addChecksum(const void* data, UPInt size)
+    {
+        const UByte* bytes = (const UByte*)data;
+        for (UPInt i = 0; i < size; ++i)
+        {
+            Checksum ^= bytes[i];
+            Checksum *= SF_UINT64(0x100000001B3);
+        }
+    }
+
+    File*   pFile;
+    UInt64  Checksum;
+};
+
+
+OpCodeCache::OpCodeCache() : Modified(false)
+{
+}
+
+OpCodeCache::~OpCodeCache()
+{
+}
+
+UPInt OpCodeCache::GetEntryCount() const
+{
+    Lock::Locker lock(&CacheLock);
+    return Entries.GetSize();
+}
+
+void OpCodeCache::Clear()
+{
+    Lock::Locker lock(&CacheLock);
+    if (Entries.GetSize())
+        Modified = true;
+    Entries.Clear();
+}
+
+void OpCodeCache::makeKey(EntryKeyType* key, UInt64 fileHash, UInt32 methodBodyInd, UInt64 filesHash)
+{
+    key->FileHash      = fileHash;
+    key->FilesHash     = filesHash;
+    key->MethodBodyInd = methodBodyInd;
+    key->Pad           = 0;
+}
+
+Ptr<OpCodeCache::Entry> OpCodeCache::GetEntry(UInt64 fileHash, UInt32 methodBodyInd, UInt64 filesHash)
+{
+    EntryKeyType key;
+    makeKey(&key, fileHash, methodBodyInd, filesHash);
+
+    Lock::Locker lock(&CacheLock);
+    Ptr<Entry>* pentry = Entries.Get(key);
+    return pentry ? *pentry : Ptr<Entry>();
+}
+
+void OpCodeCache::AddEntry(UInt64 fileHash, UInt32 methodBodyInd, UInt64 filesHash, Entry* entry)
+{
+    EntryKeyType key;
+    makeKey(&key, fileHash, methodBodyInd, filesHash);
+
+    Lock::Locker lock(&CacheLock);
+    if (Entries.Get(key))
+        return;
+    Entries.Set(key, entry);
+    Modified = true;
+}
+
+
+//------------------------------------------------------------------------
+bool OpCodeCache::writeEntry(File* pfile, const EntryKeyType& key, const Entry* entry)
+{
+    OpCodeCache_Stream stream(pfile);
+    stream.WriteUInt64(key.FileHash);
+    stream.WriteUInt64(key.FilesHash);
+    stream.WriteUInt32(key.MethodBodyInd);
+
+    UPInt i, size = entry->Code.GetSize() * sizeof(Abc::TOpCode::ValueType);
+    stream.WriteUInt32((UInt32)entry->Code.GetSize());
+    if (!stream.Write(entry->Code.GetDataPtr(), size))
+        return false;
+
+    stream.WriteUInt32((UInt32)entry->Exceptions.GetSize());
+    for (i = 0; i < entry->Exceptions.GetSize(); ++i)
+    {
+        const Abc::MethodBodyInfo::ExceptionInfo& ei = entry->Exceptions[i];
+        stream.WriteUInt32((UInt32)ei.GetFrom());
+        stream.WriteUInt32((UInt32)ei.GetTo());
+        stream.WriteUInt32((UInt32)ei.GetTargetPos());
+        stream.WriteUInt32((UInt32)ei.GetExceptionTypeInd());
+        stream.WriteUInt32(ei.GetVariableNameInd());
+    }
+
+    stream.WriteUInt32((UInt32)entry->Relocs.GetSize());
+    for (i = 0; i < entry->Relocs.GetSize(); ++i)
+    {
+        const Reloc& reloc = entry->Relocs[i];
+        stream.WriteUInt32(reloc.Pos);
+        stream.WriteUInt32(reloc.Type);
+        stream.WriteUInt32(reloc.Tag);
+        stream.WriteUInt32(reloc.Index);
+        stream.WriteString(reloc.Uri);
+        stream.WriteString(reloc.Name);
+    }
+
+    pfile->WriteUInt64(stream.GetChecksum());
+    return true;
+}
+
+bool OpCodeCache::readEntry(File* pfile)
+{
+    OpCodeCache_Stream stream(pfile);
+    EntryKeyType key;
+    UInt64 fileHash      = stream.ReadUInt64();
+    UInt64 filesHash     = stream.ReadUInt64();
+    UInt32 methodBodyInd = stream.ReadUInt32();
+    makeKey(&key, fileHash, methodBodyInd, filesHash);
+
+    Ptr<Entry> entry = *SF_HEAP_AUTO_NEW(this) Entry;
+    if (!entry)
+        return false;
+
+    UInt32 codeSize = stream.ReadUInt32();
+    UPInt  size     = (UPInt)codeSize * sizeof(Abc::TOpCode::ValueType);
+    if (codeSize == 0 || size > (UPInt)pfile->BytesAvailable())
+        return false;
+    entry->Code.Resize(codeSize);
+    if (!stream.Read(entry->Code.GetDataPtr(), size))
+        return false;
+
+    UInt32 i, count = stream.ReadUInt32();
+    if (count > 0xFFFF)
+        return false;
+    for (i = 0; i < count; ++i)
+    {
+        UInt32 from    = stream.ReadUInt32();
+        UInt32 to      = stream.ReadUInt32();
+        UInt32 target  = stream.ReadUInt32();
+        UInt32 excType = stream.ReadUInt32();
+        UInt32 varName = stream.ReadUInt32();
+        if (from > codeSize || to > codeSize || target > codeSize)
+            return false;
+        entry->Exceptions.PushBack(Abc::MethodBodyInfo::ExceptionInfo(
+            static_cast<Abc::UInd>(from), static_cast<Abc::UInd>(to), static_cast<Abc::UInd>(target),
+            static_cast<Abc::UInd>(excType), varName));
+    }
+
+    count = stream.ReadUInt32();
+    if (count > codeSize)
+        return false;
+    entry->Relocs.Resize(count);
+    for (i = 0; i < count; ++i)
+    {
+        Reloc& reloc = entry->Relocs[i];
+        reloc.Pos    = stream.ReadUInt32();
+        reloc.Type   = stream.ReadUInt32();
+        reloc.Tag    = stream.ReadUInt32();
+        reloc.Index  = stream.ReadUInt32();
+        if (reloc.Pos == 0 || reloc.Pos >= codeSize ||
+            entry->Code[reloc.Pos - 1] != Abc::Code::op_getabsobject ||
+            reloc.Type > Reloc_Class)
+            return false;
+        if (!stream.ReadString(&reloc.Uri) || !stream.ReadString(&reloc.Name))
+            return false;
+    }
+
+    UInt64 checksum = pfile->ReadUInt64();
+    if (checksum != stream.GetChecksum())
+    {
+        // The entry was read in full, so the following ones can still be used.
+        SF_DEBUG_WARNING1(1, "OpCodeCache - checksum mismatch for method body %u", methodBodyInd);
+        return true;
+    }
+
+    // Every op_getabsobject must be relocated, same as in 
+    // VMAbcFile::AddCachedOpCode; any other would keep a stale address.
+    // Such entries are dropped and the method is traced as usual.
+    UPInt opCount = 0;
+    for (i = 0; i < codeSize; ++i)
+    {
+        if (entry->Code[i] == Abc::Code::op_getabsobject)
+            ++opCount;
+    }
+    if (opCount != entry->Relocs.GetSize())
+        return true;
+
+    Entries.Set(key, entry);
+    return true;
+}
+
+bool OpCodeCache::LoadFile(const String& path)
+{
+    Lock::Locker lock(&CacheLock);
+    Entries.Clear();
+    FilePath = path;
+    Modified = false;
+
+    SysFile file(path);
+    if (!file.IsValid())
+        return false;
+
+    UByte magic[4];
+    if (file.Read(magic, 4) != 4 || memcmp(magic, OpCodeCache_Magic, 4) != 0 ||
+        file.ReadUInt32() != Version ||
+        file.ReadUInt32() != SF_BYTE_ORDER ||
+        file.ReadUInt32() != sizeof(Abc::TOpCode::ValueType))
+    {
+        SF_DEBUG_WARNING1(1, "OpCodeCache - incompatible file '%s'", path.ToCStr());
+        return false;
+    }
+
+    UInt32 entryCount = file.ReadUInt32();
+    for (UInt32 i = 0; i < entryCount; ++i)
+    {
+        if (!readEntry(&file))
+        {
+            SF_DEBUG_WARNING1(1, "OpCodeCache - corrupt file '%s'", path.ToCStr());
+            Entries.Clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OpCodeCache::SaveFile(const String& path)
+{
+    Lock::Locker lock(&CacheLock);
+    const String& filePath = path.IsEmpty() ? FilePath : path;
+    if (filePath.IsEmpty())
+        return false;
+
+    SysFile file(filePath, File::Open_Write | File::Open_Truncate | File::Open_Create | File::Open_Buffered);
+    if (!file.IsValid())
+        return false;
+
+    file.Write(OpCodeCache_Magic, 4);
+    file.WriteUInt32(Version);
+    file.WriteUInt32(SF_BYTE_ORDER);
+    file.WriteUInt32(sizeof(Abc::TOpCode::ValueType));
+    file.WriteUInt32((UInt32)Entries.GetSize());
+
+    for (EntryHashType::ConstIterator it = Entries.Begin(); it != Entries.End(); ++it)
+    {
+        if (!writeEntry(&file, it->First, it->Second))
+            return false;
+    }
+
+    Modified = false;
+    return file.Close();
+}
+
+}}} // namespace Scaleform { namespace GFx { namespace AS3 {
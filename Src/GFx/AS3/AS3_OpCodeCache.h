@@ -0,0 +1,130 @@
+/**************************************************************************
+
+Filename    :   AS3_OpCodeCache.h
+Content     :   Persistent cache of traced AS3 method code.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_AS3_OpCodeCache_H
+#define INC_AS3_OpCodeCache_H
+
+#include "Kernel/SF_RefCount.h"
+#include "Kernel/SF_Hash.h"
+#include "Kernel/SF_String.h"
+#include "Kernel/SF_File.h"
+#include "Kernel/SF_Atomic.h"
+#include "GFx/AS3/Abc/AS3_Abc.h"
+
+namespace Scaleform { namespace GFx { namespace AS3 {
+
+// OpCodeCache keeps the code generated by the Tracer, so that it can be
+// saved to a file and loaded on the next run instead of tracing methods
+// again on their first call.
+//
+// Code is keyed by the content hash of its ABC file (Abc::File::GetContentHash),
+// the method body index, and a hash of all the ABC files loaded by the VM at
+// the time the method was traced, since the traced code depends on the
+// traits of classes from other files. A different set of loaded files
+// misses the cache, and the method is traced as usual.
+//
+// Traced code refers to classes and global objects by address with
+// op_getabsobject; such operands are stored as relocations and resolved
+// when the code is loaded. If any of them can't be resolved, or doesn't
+// resolve to a class that has been created, the cached code is ignored.
+//
+// The cache is installed with AS3Support::SetOpCodeCache and can be shared
+// by several movies.
+
+class OpCodeCache : public RefCountBase<OpCodeCache, StatMV_VM_Tracer_Mem>
+{
+public:
+    enum { Version = 2 };
+
+    // How an op_getabsobject operand is resolved.
+    enum RelocType
+    {
+        Reloc_GlobalObjectCPP,  // Global object of the VM.
+        Reloc_Script,           // Global object of script Index of the method's file.
+        Reloc_Class             // Class Name in public namespace Uri.
+    };
+
+    struct Reloc
+    {
+        UInt32      Pos;        // Position of the operand in Code.
+        UInt32      Type;
+        UInt32      Tag;        // Value::ObjectTag of the operand.
+        UInt32      Index;
+        String      Uri;
+        String      Name;
+    };
+
+    class Entry : public RefCountBase<Entry, StatMV_VM_Tracer_Mem>
+    {
+    public:
+        // Relocated operands are stored as 0.
+        ArrayLH_POD<Abc::TOpCode::ValueType, StatMV_VM_Tracer_Mem>                  Code;
+        ArrayLH_POD<Abc::MethodBodyInfo::ExceptionInfo, StatMV_VM_Tracer_Mem>       Exceptions;
+        ArrayLH<Reloc, StatMV_VM_Tracer_Mem>                                        Relocs;
+    };
+
+    OpCodeCache();
+    ~OpCodeCache();
+
+    // Loads code from file, replacing the current entries, and remembers the
+    // path for SaveFile. Returns false if the file doesn't exist or has
+    // an incompatible format; the cache is empty in that case. Entries that
+    // don't match their checksum are skipped.
+    bool            LoadFile(const String& path);
+    // Saves all entries to file; an empty path uses the one given to LoadFile.
+    bool            SaveFile(const String& path = String());
+
+    const String&   GetFilePath() const { return FilePath; }
+    // Returns true if entries were added since the last LoadFile or SaveFile.
+    bool            IsModified() const  { return Modified; }
+    UPInt           GetEntryCount() const;
+    void            Clear();
+
+    // Returns the code of a method body traced with the same set of loaded
+    // files, or NULL.
+    Ptr<Entry>      GetEntry(UInt64 fileHash, UInt32 methodBodyInd, UInt64 filesHash);
+    void            AddEntry(UInt64 fileHash, UInt32 methodBodyInd, UInt64 filesHash, Entry* entry);
+
+private:
+    struct EntryKeyType
+    {
+        UInt64  FileHash;
+        UInt64  FilesHash;
+        UInt32  MethodBodyInd;
+        UInt32  Pad;
+
+        bool operator == (const EntryKeyType& other) const
+        {
+            return memcmp(this, &other, sizeof(EntryKeyType)) == 0;
+        }
+    };
+
+    typedef HashLH<EntryKeyType, Ptr<Entry>, FixedSizeHash<EntryKeyType>, StatMV_VM_Tracer_Mem> EntryHashType;
+
+    static void     makeKey(EntryKeyType* key, UInt64 fileHash, UInt32 methodBodyInd, UInt64 filesHash);
+
+    bool            writeEntry(File* pfile, const EntryKeyType& key, const Entry* entry);
+    bool            readEntry(File* pfile);
+
+    EntryHashType   Entries;
+    String          FilePath;
+    bool            Modified;
+    // Movies using the cache may run on different threads.
+    mutable Lock    CacheLock;
+};
+
+}}} // namespace Scaleform { namespace GFx { namespace AS3 {
+
+#endif // INC_AS3_OpCodeCache_H
@@ -3799,6 +3799,7 @@ Tracer::Tracer(
     , NewOpcodePos(heap)
     , PosToRecalculate(heap)
     , Orig2newPosMap(heap)
+    , AbsObjectRefs(heap)
     , States(heap)
     , CatchTraits(heap)
 #if defined(SF_AS3_AOTC) || defined(SF_AS3_AOTC2)
@@ -8007,6 +8008,9 @@ bool Tracer::EmitGetAbsObject(TR::State& st, const Value& value, bool objOnStack
             Code::op_getabsobject,
             reinterpret_cast<UPInt>(value.GetObject()) + tag
             );
+        const UPInt pos = WCode.GetSize() - 1;
+        AbsObjectRef ref = { pos, WCode[pos] };
+        AbsObjectRefs.PushBack(ref);
 
 #if defined(SF_AS3_AOTC2)
         if (!simulate)
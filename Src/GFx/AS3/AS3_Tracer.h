@@ -1312,6 +1312,18 @@ public:
     // Can throw exceptions.
     void EmitCode();
 
+    // op_getabsobject operands emitted into the generated code. Opcodes can
+    // be popped after they are emitted, so entries may be stale.
+    struct AbsObjectRef
+    {
+        UPInt   Pos;    // Position of the operand.
+        UPInt   Addr;   // Object address and tag.
+    };
+    const ArrayDH_POD<AbsObjectRef, Mem_Stat>& GetAbsObjectRefs() const
+    {
+        return AbsObjectRefs;
+    }
+
 public:
     //
     MemoryHeap* GetHeap() const
@@ -1803,6 +1815,7 @@ private:
     ArrayDH_POD<Recalculate, Mem_Stat>      PosToRecalculate;
     // Map of original position to new (long) position.
     ArrayDH_POD<Abc::TCodeOffset, Mem_Stat> Orig2newPosMap;
+    ArrayDH_POD<AbsObjectRef, Mem_Stat>     AbsObjectRefs;
 
     ArrayDH<TR::State*, Mem_Stat>           States;
     List<TR::Block>                         Blocks;
@@ -600,6 +600,7 @@ VMAbcFile::~VMAbcFile()
 {
     SF_DEBUG_MESSAGE2(GFX_UNLOAD_TRACE_ENABLED, "~VMAbcFile %s %p\n", File->GetName().ToCStr(), this);
     GetVM().RemoveVMAbcFileWeak(this);
+    GetVM().RemovePreTrace(*this);
     if (GetAppDomain().IsEmpty())
     {
         GetVM().RemoveAppDomain(GetAppDomain());
@@ -937,6 +938,9 @@ CheckResult VMAbcFile::Load(bool to_execute)
 
 void VMAbcFile::UnRegister()
 {
+    // Traits of this file are about to go away.
+    GetVM().RemovePreTrace(*this);
+
     if (!GetVM().RemoveVMAbcFileWeak(this))
         return; // already unregistered
 
@@ -980,7 +984,7 @@ const Abc::TOpCode& VMAbcFile::GetOpCode(Abc::MbiInd ind, const CallFrame& cf)
 {
     SF_ASSERT(ind.IsValid() && static_cast<UPInt>(ind.Get()) < OpCodeArray.GetSize());
 
-    if (OpCodeArray[ind.Get()].GetSize() == 0)
+    if (OpCodeArray[ind.Get()].GetSize() == 0 && !LoadCachedOpCode(ind))
     {
         VM& vm = GetVM();
         Tracer tracer(
@@ -993,12 +997,249 @@ const Abc::TOpCode& VMAbcFile::GetOpCode(Abc::MbiInd ind, const CallFrame& cf)
         );
 
         if (!vm.IsException())
+        {
             tracer.EmitCode();
+
+            if (!vm.IsException())
+                AddCachedOpCode(ind, tracer);
+        }
     }
 
     return OpCodeArray[ind.Get()];
 }
 
+bool VMAbcFile::PreTraceOpCode(const CallFrame& cf)
+{
+    const Abc::MbiInd ind = cf.GetMethodBodyInd();
+    SF_ASSERT(ind.IsValid() && static_cast<UPInt>(ind.Get()) < OpCodeArray.GetSize());
+
+    if (OpCodeArray[ind.Get()].GetSize() != 0 || LoadCachedOpCode(ind))
+        return true;
+
+    VM& vm = GetVM();
+    SF_ASSERT(!vm.IsException());
+
+    {
+        Tracer tracer(
+            vm.GetMemoryHeap(), 
+            cf, 
+            OpCodeArray[ind.Get()], 
+            Exceptions[ind.Get()]
+            SF_AOTC_ARG(pIC)
+            SF_AOTC2_ARG(pIC)
+            );
+
+        tracer.EmitCode();
+
+        if (!vm.IsException())
+            AddCachedOpCode(ind, tracer);
+    }
+
+    // Exception info is only written by a complete trace, and the original
+    // code is only cleared by it, so dropping the partial code is enough.
+    if (vm.IsException())
+    {
+        vm.IgnoreException();
+        OpCodeArray[ind.Get()].Clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool VMAbcFile::LoadCachedOpCode(Abc::MbiInd ind)
+{
+#if defined(SF_AS3_USE_WORDCODE) && defined(SF_AS3_ENABLE_GETABSOBJECT)
+    VM& vm = GetVM();
+    OpCodeCache* cache = vm.GetOpCodeCache();
+    if (cache == NULL)
+        return false;
+
+    Ptr<OpCodeCache::Entry> entry = cache->GetEntry(GetAbcFile().GetContentHash(), ind.Get(), vm.GetAbcFilesHash());
+    if (!entry)
+        return false;
+
+    // Resolve all objects first, so that nothing is changed if one of them
+    // is missing. The method is traced as usual in that case.
+    const UPInt relocCount = entry->Relocs.GetSize();
+    ArrayDH_POD<Object*, Mem_Stat> objects(vm.GetMemoryHeap());
+    objects.Resize(relocCount);
+    for (UPInt i = 0; i < relocCount; ++i)
+    {
+        objects[i] = ResolveCachedObject(entry->Relocs[i]);
+        if (objects[i] == NULL)
+            return false;
+    }
+
+    Abc::TOpCode& code = OpCodeArray[ind.Get()];
+    code.Resize(entry->Code.GetSize());
+    memcpy(code.GetDataPtr(), entry->Code.GetDataPtr(), entry->Code.GetSize() * sizeof(Abc::TOpCode::ValueType));
+
+    for (UPInt i = 0; i < relocCount; ++i)
+    {
+        const OpCodeCache::Reloc& reloc = entry->Relocs[i];
+        code[reloc.Pos] = reinterpret_cast<UPInt>(objects[i]) + reloc.Tag;
+
+        // Same as Tracer::EmitGetAbsObject().
+        if (objects[i] != (Object*)&vm.GetGlobalObjectCPP())
+            AbsObjects.Set(objects[i]);
+    }
+
+    Abc::MethodBodyInfo::Exception& e = Exceptions[ind.Get()];
+    e.info.Clear();
+    for (UPInt i = 0; i < entry->Exceptions.GetSize(); ++i)
+        e.info.PushBack(entry->Exceptions[i]);
+
+    // Original code is not needed any more, same as after tracing.
+    const_cast<Abc::MethodBodyInfo&>(GetMethodBody().Get(ind)).ClearCode();
+    return true;
+#else
+    SF_UNUSED1(ind);
+    return false;
+#endif
+}
+
+void VMAbcFile::AddCachedOpCode(Abc::MbiInd ind, const Tracer& tracer)
+{
+#if defined(SF_AS3_USE_WORDCODE) && defined(SF_AS3_ENABLE_GETABSOBJECT)
+    VM& vm = GetVM();
+    OpCodeCache* cache = vm.GetOpCodeCache();
+    const Abc::TOpCode& code = OpCodeArray[ind.Get()];
+    if (cache == NULL || code.GetSize() == 0)
+        return;
+
+    Ptr<OpCodeCache::Entry> entry = *SF_HEAP_AUTO_NEW(cache) OpCodeCache::Entry;
+    if (!entry)
+        return;
+    entry->Code.Resize(code.GetSize());
+    memcpy(entry->Code.GetDataPtr(), code.GetDataPtr(), code.GetSize() * sizeof(Abc::TOpCode::ValueType));
+
+    // Operands that are still in the code are relocated. The same position
+    // can be recorded twice if an opcode was popped and emitted again.
+    const ArrayDH_POD<Tracer::AbsObjectRef, Mem_Stat>& refs = tracer.GetAbsObjectRefs();
+    for (UPInt i = 0; i < refs.GetSize(); ++i)
+    {
+        const Tracer::AbsObjectRef& ref = refs[i];
+        if (ref.Pos == 0 || ref.Pos >= code.GetSize() || 
+            code[ref.Pos - 1] != Abc::Code::op_getabsobject || code[ref.Pos] != ref.Addr ||
+            entry->Code[ref.Pos] == 0)
+            continue;
+
+        OpCodeCache::Reloc reloc;
+        if (!MakeCachedObjectReloc(ref.Addr, reloc))
+            return;
+        reloc.Pos = static_cast<UInt32>(ref.Pos);
+        entry->Relocs.PushBack(reloc);
+        entry->Code[ref.Pos] = 0;
+    }
+
+    // Any other op_getabsobject would keep a stale address. Operands equal
+    // to the opcode only make the method not cacheable.
+    UPInt opCount = 0;
+    for (UPInt i = 0; i < code.GetSize(); ++i)
+    {
+        if (code[i] == Abc::Code::op_getabsobject)
+            ++opCount;
+    }
+    if (opCount != entry->Relocs.GetSize())
+        return;
+
+    const Abc::MethodBodyInfo::Exception& e = Exceptions[ind.Get()];
+    for (UPInt i = 0; i < e.GetSize(); ++i)
+        entry->Exceptions.PushBack(e.Get(i));
+
+    cache->AddEntry(GetAbcFile().GetContentHash(), ind.Get(), vm.GetAbcFilesHash(), entry);
+#else
+    SF_UNUSED2(ind, tracer);
+#endif
+}
+
+Object* VMAbcFile::ResolveCachedObject(const OpCodeCache::Reloc& reloc)
+{
+    VM& vm = GetVM();
+    switch (reloc.Type)
+    {
+    case OpCodeCache::Reloc_GlobalObjectCPP:
+        return &vm.GetGlobalObjectCPP();
+    case OpCodeCache::Reloc_Script:
+        if (reloc.Index < GetAbcFile().GetScripts().GetSize())
+        {
+            const Abc::ScriptInfo& script = GetAbcFile().GetScripts().Get(reloc.Index);
+            TGlobalObjectScriptSet::Iterator it = GlobalObjects.Begin();
+            for (; !it.IsEnd(); ++it)
+            {
+                if (&(*it)->GetScript() == &script)
+                    return it->GetPtr();
+            }
+        }
+        break;
+    case OpCodeCache::Reloc_Class:
+        {
+            StringManager& sm = vm.GetStringManager();
+            SPtr<Instances::fl::Namespace> ns = vm.MakeInternedNamespace(
+                Abc::NS_Public, sm.CreateString(reloc.Uri.ToCStr(), reloc.Uri.GetSize()));
+            const Multiname mn(*ns, Value(sm.CreateString(reloc.Name.ToCStr(), reloc.Name.GetSize())));
+            const ClassTraits::Traits* ctr = FindClassTraits(vm, mn, GetAppDomain());
+
+            // The Tracer only refers to classes that are already created.
+            if (ctr && ctr->IsValid() && ctr->GetInstanceTraits().HasConstructorSetup())
+                return &ctr->GetInstanceTraits().GetClass();
+        }
+        break;
+    }
+    return NULL;
+}
+
+bool VMAbcFile::MakeCachedObjectReloc(UPInt addr, OpCodeCache::Reloc& reloc)
+{
+    VM& vm = GetVM();
+    const Value value = GetAbsObject(addr);
+    Object* obj = value.GetObject();
+
+    reloc.Tag   = static_cast<UInt32>(addr & Value::ObjectTagMask);
+    reloc.Index = 0;
+    if (obj == (Object*)&vm.GetGlobalObjectCPP())
+    {
+        reloc.Type = OpCodeCache::Reloc_GlobalObjectCPP;
+        return true;
+    }
+    else if (value.IsClass())
+    {
+        // Private and internal classes can't be looked up by name.
+        const InstanceTraits::Traits& itr = value.AsClass().GetClassTraits().GetInstanceTraits();
+        const Instances::fl::Namespace& ns = itr.GetNamespace();
+        if (ns.GetKind() != Abc::NS_Public)
+            return false;
+
+        reloc.Type = OpCodeCache::Reloc_Class;
+        reloc.Uri  = String(ns.GetUri().ToCStr(), ns.GetUri().GetSize());
+        reloc.Name = String(itr.GetName().ToCStr(), itr.GetName().GetSize());
+
+        // The class must be found again by name, or the cached code would
+        // refer to a different one.
+        return ResolveCachedObject(reloc) == obj;
+    }
+    else if (obj->GetTraits().IsGlobal())
+    {
+        // Only global objects of the method's own file are cached.
+        const Instances::fl::GlobalObjectScript* gos = static_cast<const Instances::fl::GlobalObjectScript*>(obj);
+        if (&gos->GetFile() != this)
+            return false;
+
+        const Abc::ScriptTable& scripts = GetAbcFile().GetScripts();
+        for (UPInt i = 0; i < scripts.GetSize(); ++i)
+        {
+            if (&scripts.Get(i) == &gos->GetScript())
+            {
+                reloc.Type  = OpCodeCache::Reloc_Script;
+                reloc.Index = static_cast<UInt32>(i);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 Value VMAbcFile::GetDetailValue(const Abc::ValueDetail& d)
 {
     const int value_ind = d.GetIndex();
@@ -1911,6 +2152,8 @@ VM::VM(FlashUI& _ui, FileLoader& loader, StringManager& sm, ASRefCountCollector&
 , TraitaGlobalObject(MakePickable(SF_HEAP_NEW_ID(GetMemoryHeap(), StatMV_VM_ITraits_Mem) InstanceTraits::fl::GlobalObject(GetSelf())))
 , GlobalObject(MakePickable(new(Memory::AllocInHeap(GetMemoryHeap(), sizeof(Instances::fl::GlobalObjectCPP))) Instances::fl::GlobalObjectCPP(GetSelf(), *TraitaGlobalObject)))
 , GlobalObjectValue(GlobalObject)
+, PreTraceTime(0)
+, PreTracePos(0)
 SF_AOTC_ARG(pIC(ic))
 SF_AOTC2_ARG(pIC(ic))
 {
@@ -2042,9 +2285,154 @@ void VM::UnregisterAllAbcFiles()
         VMAbcFilesWeak[i]->UnRegister();
     }
     VMAbcFilesWeak.Clear();
+    PreTraceQueue.Clear();
+    PreTracePos = 0;
     InDestructor = oi;
 }
 
+void VM::SetOpCodeCache(OpCodeCache* cache)
+{
+#if defined(SF_AS3_AOTC) || defined(SF_AS3_AOTC2)
+    // Code must be traced to be collected.
+    SF_UNUSED1(cache);
+#else
+    pOpCodeCache = cache;
+#endif
+}
+
+UInt64 VM::GetAbcFilesHash() const
+{
+    // 64-bit FNV-1a of the content hashes in load order, since files 
+    // loaded in a different order can define different traits.
+    UInt64 hash = SF_UINT64(0xCBF29CE484222325);
+    for (UPInt i = 0, n = VMAbcFilesWeak.GetSize(); i < n; ++i)
+    {
+        UInt64 fileHash = VMAbcFilesWeak[i]->GetAbcFile().GetContentHash();
+        for (unsigned j = 0; j < sizeof(fileHash); ++j, fileHash >>= 8)
+        {
+            hash ^= (UByte)fileHash;
+            hash *= SF_UINT64(0x100000001B3);
+        }
+    }
+    return hash;
+}
+
+void VM::SetPreTraceTime(UInt32 maxTime)
+{
+    PreTraceTime = maxTime;
+    if (maxTime == 0)
+    {
+        PreTraceQueue.Clear();
+        PreTracePos = 0;
+    }
+}
+
+void VM::QueuePreTrace(const ClassTraits::UserDefined& ctr)
+{
+    const InstanceTraits::Traits& itr = ctr.GetInstanceTraits();
+
+    // The instance constructor is usually the first method to be called.
+    // The static constructor is called right away, so it is not queued.
+    QueuePreTraceMethod(itr, ctr.GetClassInfo().GetInstanceInfo().GetMethodInfoInd());
+    QueuePreTraceVTable(itr);
+    QueuePreTraceVTable(ctr);
+}
+
+void VM::QueuePreTraceVTable(const Traits& tr)
+{
+    // Inherited methods refer to the traits of their base classes, which
+    // are also their origination traits when they are called.
+    const VTable& vt = tr.GetVT();
+    for (UPInt i = 0, n = vt.GetSize(); i < n; ++i)
+    {
+        const Value& m = vt.GetRaw(AbsoluteIndex(i));
+        if (m.GetKind() == Value::kMethodInd)
+            QueuePreTraceMethod(m.GetTraits(), m.GetMethodInfoInd());
+    }
+}
+
+void VM::QueuePreTraceMethod(const Traits& ot, Abc::MiInd ind)
+{
+    VMAbcFile* file = ot.GetFilePtr();
+    if (file == NULL)
+        return;
+
+    // Interface methods have no body.
+    const Abc::MbiInd mbi_ind = file->GetMethodBodyInfoInd(ind);
+    if (!mbi_ind.IsValid() || file->IsOpCodeTraced(mbi_ind))
+        return;
+
+    PreTraceEntry entry;
+    entry.pFile = file;
+    entry.pTraits = &ot;
+    entry.Ind = mbi_ind;
+    PreTraceQueue.PushBack(entry);
+}
+
+bool VM::PreTrace()
+{
+    // Tracing may throw, so it only runs between calls.
+    if (PreTraceTime == 0 || IsException() || !HasFinished())
+        return PreTracePos < PreTraceQueue.GetSize();
+
+    const UInt64 endTime = Timer::GetTicks() + PreTraceTime;
+    while (PreTracePos < PreTraceQueue.GetSize())
+    {
+        const PreTraceEntry& entry = PreTraceQueue[PreTracePos++];
+        VMAbcFile& file = *entry.pFile;
+        if (file.IsOpCodeTraced(entry.Ind))
+            continue;
+
+        const Traits& ot = *entry.pTraits;
+#ifdef SF_AS3_ENABLE_EXPLICIT_GO
+        Instances::fl::GlobalObjectScript* gos = ot.GetGlobalObjectScript();
+        if (gos == NULL)
+            continue;
+#endif
+
+        // The same frame AddFrame() sets up for a call through a VTable,
+        // without reserving stack and registers, since nothing is executed.
+        // The code may still differ from what the first call would trace.
+        // Class references are bound directly (getabsobject) only to
+        // classes that have already been created; the others are looked up
+        // by name at run time, which is correct but slower.
+        // Classes that aren't found at all, as argument types or coerce
+        // targets, fail the trace, which is then redone on the first call.
+        CallFrame cf(GetMemoryHeap());
+        cf.pFile = &file;
+        cf.MBIIndex = entry.Ind;
+        cf.pSavedScope = &ot.GetStoredScopeStack();
+        cf.OriginationTraits = &ot;
+#ifdef SF_AS3_ENABLE_EXPLICIT_GO
+        cf.GOS = gos;
+#endif
+        SF_DEBUG_CODE(cf.Name = ot.GetName().GetNode();)
+
+        file.PreTraceOpCode(cf);
+
+        if (Timer::GetTicks() >= endTime)
+            break;
+    }
+
+    if (PreTracePos == PreTraceQueue.GetSize())
+    {
+        PreTraceQueue.Clear();
+        PreTracePos = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void VM::RemovePreTrace(const VMAbcFile& file)
+{
+    for (UPInt i = PreTraceQueue.GetSize(); i > PreTracePos; --i)
+    {
+        if (PreTraceQueue[i - 1].pFile == &file)
+            PreTraceQueue.RemoveAt(i - 1);
+    }
+}
+
 SPtr<VMAbcFile> VM::FindVMAbcFileWeak(const char* name, VMAppDomain& appDomain) const 
 {
     for (UPInt i = 0, n = VMAbcFilesWeak.GetSize(); i < n; ++i)
@@ -3721,7 +4109,12 @@ void VM::exec_newclass(VMAbcFile& file, UInt32 v)
             // This class was already created by another script. It happens.
             value = &cud.GetInstanceTraits().GetConstructor();
         else
+        {
             value = cud.MakeClass();
+
+            if (PreTraceTime != 0)
+                QueuePreTrace(cud);
+        }
     }
 
 }
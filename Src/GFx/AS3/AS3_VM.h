@@ -30,6 +30,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 
 #include "AS3_ValueStack.h"
 #include "AS3_ObjCollector.h"
+#include "AS3_OpCodeCache.h"
 #include <math.h>
 
 // Enabling of CallFrameCache is supposed to speed up VM. In reality it slows
@@ -45,6 +46,14 @@ otherwise accompanies this software in either electronic or hard copy form.
 
 // #define SF_AS3_ENABLE_EXPLICIT_GO
 
+// Threaded (computed goto) opcode dispatch in VM::ExecuteCode. It requires
+// labels as values, so it is only available with GCC and Clang; elsewhere
+// opcodes are dispatched by a switch. Define SF_AS3_DISABLE_THREADED_DISPATCH
+// to use the switch with these compilers too.
+#if (defined(SF_CC_GNU) || defined(SF_CC_CLANG)) && !defined(SF_AS3_DISABLE_THREADED_DISPATCH)
+    #define SF_AS3_ENABLE_THREADED_DISPATCH
+#endif
+
 #if !defined(SF_AS3_ENABLE_EXPLICIT_GO) && (defined(SF_AS3_AOTC) || defined(SF_AS3_AOTC2))
     #define SF_AS3_ENABLE_EXPLICIT_GO
 #endif
@@ -476,6 +485,14 @@ public:
     }
 
     const Abc::TOpCode& GetOpCode(Abc::MbiInd ind, const CallFrame& cf);
+    bool IsOpCodeTraced(Abc::MbiInd ind) const
+    {
+        return OpCodeArray[ind.Get()].GetSize() != 0;
+    }
+    // Traces the method of cf ahead of its first call. Code is kept only
+    // if tracing succeeds; otherwise the method is traced again on its
+    // first call, which reports the error.
+    bool PreTraceOpCode(const CallFrame& cf);
 
     const Abc::MethodBodyInfo::Exception& GetException(Abc::MbiInd ind) const
     {
@@ -506,6 +523,15 @@ private:
     bool            RegisterUserDefinedClassTraits();
     bool            RegisterScrips(bool to_execute);
 
+    // Installs code of the method body from the VM's OpCodeCache, returns
+    // false if there is no valid entry for it.
+    bool            LoadCachedOpCode(Abc::MbiInd ind);
+    // Records the code generated by a successful trace in the OpCodeCache.
+    void            AddCachedOpCode(Abc::MbiInd ind, const Tracer& tracer);
+    // Returns the object an op_getabsobject operand refers to, or NULL.
+    Object*         ResolveCachedObject(const OpCodeCache::Reloc& reloc);
+    bool            MakeCachedObjectReloc(UPInt addr, OpCodeCache::Reloc& reloc);
+
     CheckResult     Load(bool to_execute);
 public: //?
     // UnRegister() will unregister this file with VM. It won't automatically
@@ -2550,6 +2576,32 @@ private:
         return Pickable<T>(p);
     }
 
+public:
+    // Ahead-of-time tracing of method bodies. When maxTime isn't zero, the
+    // methods of classes created by the newclass opcode are queued, and each
+    // PreTrace() call traces them for up to maxTime microseconds, so that
+    // their first call doesn't have to. Pre-traced code is not always the
+    // code the first call would trace, since classes created later are
+    // looked up by name instead of being bound directly.
+    void SetPreTraceTime(UInt32 maxTime);
+    UInt32 GetPreTraceTime() const { return PreTraceTime; }
+    // Returns true if there are methods left in the queue.
+    bool PreTrace();
+    void RemovePreTrace(const VMAbcFile& file);
+
+    // Traced code is taken from the cache when it has an entry for the
+    // method, and new traces are added to it. Pass NULL to remove it.
+    void SetOpCodeCache(OpCodeCache* cache);
+    OpCodeCache* GetOpCodeCache() const { return pOpCodeCache; }
+    // Hash of the content of all registered ABC files in load order,
+    // which traced code depends on.
+    UInt64 GetAbcFilesHash() const;
+
+private:
+    void QueuePreTrace(const ClassTraits::UserDefined& ctr);
+    void QueuePreTraceVTable(const Traits& tr);
+    void QueuePreTraceMethod(const Traits& ot, Abc::MiInd ind);
+
 public:
     void AddVMAbcFileWeak(VMAbcFile* f);
     bool RemoveVMAbcFileWeak(VMAbcFile* f);
@@ -2677,6 +2729,20 @@ private:
 
     ArrayLH_POD<VMAbcFile*, StatMV_VM_VM_Mem>   VMAbcFilesWeak;
 
+    // Methods waiting for ahead-of-time tracing. Traits are kept alive by
+    // their files, which remove their entries when they are unregistered.
+    struct PreTraceEntry
+    {
+        VMAbcFile*      pFile;
+        const Traits*   pTraits;    // Origination traits.
+        Abc::MbiInd     Ind;
+    };
+    UInt32                                          PreTraceTime;
+    UPInt                                           PreTracePos;
+    ArrayLH_POD<PreTraceEntry, StatMV_VM_VM_Mem>    PreTraceQueue;
+
+    Ptr<OpCodeCache>                                pOpCodeCache;
+
 #if defined(SF_AS3_AOTC) || defined(SF_AS3_AOTC2)
     AOT::InfoCollector* pIC;
 #endif
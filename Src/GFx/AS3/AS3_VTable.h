@@ -46,6 +46,10 @@ public:
     }
     // Similar to Get(), but it will convert MethodInd to VTableInd.
     Value GetValue(AbsoluteIndex ind) const;
+    UPInt GetSize() const
+    {
+        return VTMethods.GetSize();
+    }
 	SF_DEBUG_CODE(const ASString& GetName(AbsoluteIndex ind) const { return Names[ind.Get()]; } )
     Traits& GetTraits() const
     {
@@ -478,7 +478,7 @@ CheckResult Value::Convert2NumberInternal(Number& result, KindType kind) const
 {
     if (kind == kString)
     {
-        const ASStringNode* sn = value.VS._1.VStr;
+        const ASStringNode* sn = GetStringNode();
         if (sn)
         {
             // String is not null.
@@ -1121,7 +1121,7 @@ CheckResult Value::Convert2String(StringBuffer& result) const
         break;
     case kString:
         {
-            ASStringNode* snode = value.VS._1.VStr;
+            ASStringNode* snode = GetStringNode();
 
             if (snode)
                 result.AppendString(snode->pData, snode->Size);
@@ -967,6 +967,13 @@ public:
         SF_ASSERT(GetStringNode());
         return ASString(value);
     }
+    // Unlike AsStringNode(), doesn't flatten a concatenation node
+    // (see ASStringManager::CreateConcatNode).
+    ASStringNode* AsRawStringNode() const
+    {
+        SF_ASSERT(GetKind() == kString);
+        return value.VS._1.VStr;
+    }
 
     // Although value itself is const it may contain a non-const Object.
     Object* GetObject() const
@@ -1614,8 +1621,8 @@ private:
         operator Number&() { return VNumber; }
         operator Number() const { return VNumber; }
 
-        ///
-        operator ASStringNode*() const { return VS._1.VStr; }
+        /// Concatenation nodes are flattened, see ASStringManager::CreateConcatNode.
+        operator ASStringNode*() const { return VS._1.VStr ? VS._1.VStr->GetFlatNode() : NULL; }
 
         ///
         operator Object*() const { return VS._1.VObj; }
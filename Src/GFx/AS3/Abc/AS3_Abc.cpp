@@ -654,6 +654,17 @@ File::~File()
 {
 }
 
+UInt64 File::CalcContentHash(const UInt8* data, UPInt size)
+{
+    UInt64 h = SF_UINT64(0xCBF29CE484222325);
+    for (UPInt i = 0; i < size; ++i)
+    {
+        h ^= data[i];
+        h *= SF_UINT64(0x100000001B3);
+    }
+    return h;
+}
+
 ///////////////////////////////////////////////////////////////////////////
 MethodBodyTable::~MethodBodyTable()
 {
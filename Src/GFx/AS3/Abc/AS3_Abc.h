@@ -1433,6 +1433,7 @@ class MethodBodyInfo : public HasTraits
 {
     friend class Reader;
     friend class AS3::Tracer; // Because of ClearCode().
+    friend class AS3::VMAbcFile; // Because of ClearCode().
 
 public:
     // Required for Array<MethodBodyInfo>
@@ -1483,6 +1484,7 @@ public:
     {
         friend class Reader;
         friend class AS3::Tracer;
+        friend class AS3::VMAbcFile; // Because of OpCodeCache.
 
     public:
         UPInt GetSize() const
@@ -1604,6 +1606,7 @@ class File : public NewOverrideBase<StatMV_VM_AbcFile_Mem>, public RefCountImpl
 public:
     File()
         : DataSize(0)
+        , ContentHash(0)
 #ifdef SF_AMP_SERVER
         , FileHandle(0), SwfFileOffset(0)
 #endif
@@ -1621,6 +1624,14 @@ public:
         DataSize = value;
     }
 
+    // 64-bit FNV-1a hash of the file data, computed by Reader::Read().
+    // It identifies the file across runs, see OpCodeCache.
+    UInt64 GetContentHash() const
+    {
+        return ContentHash;
+    }
+    static UInt64 CalcContentHash(const UInt8* data, UPInt size);
+
 #ifdef SF_AMP_SERVER
     UInt32 GetFileHandle() const
     {
@@ -1702,6 +1713,7 @@ private:
 
 private:
     UInt32          DataSize; // temporarily for parsing ...
+    UInt64          ContentHash;
     String          Source; // File name of the source ABC file.
 
     SF_AMP_CODE(UInt32 FileHandle;)
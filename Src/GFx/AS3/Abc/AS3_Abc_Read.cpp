@@ -24,6 +24,7 @@ bool Reader::Read(File& obj)
     bool result = true;
 
     obj.Clear();
+    obj.ContentHash = File::CalcContentHash(CP, Size);
 
     result = result &&
         Read16(obj.MinorVersion) && 
@@ -91,76 +91,153 @@ int CompareValuePtr::Compare(const Value& a, const Value& b) const
     return (n == 0.0 ? 0 : (n < 0.0 ? -1 : 1));
 }
 
-Value::Number CompareOn::Compare(const Value& a, const Value& b) const
+UInt64 NumberSortKey(Value::Number v, bool desc)
 {
-    Value::Number result = 0.0;
-
-    const UPInt size = Fields.GetSize();
-    for (UPInt i = 0; i < size && result == 0.0; ++i)
+    union
     {
-        const Multiname name(GetVM().GetPublicNamespace(), Fields[i]);
-        PropRef prop_a;
-        PropRef prop_b;
+        Value::Number   N;
+        UInt64          U;
+    } bits;
 
-        FindObjProperty(prop_a, GetVM(), a, name);
-        FindObjProperty(prop_b, GetVM(), b, name);
+    if (NumberUtil::IsNaN(v))
+        bits.U = SF_UINT64(0x7FF8000000000000);
+    else
+        // Turns -0 into +0.
+        bits.N = v + 0.0;
 
-        if (prop_a && prop_b)
-        {
-            Value value_a;
-            Value value_b;
+    // Flip negative numbers entirely and the sign bit of the others.
+    if (bits.U & SF_UINT64(0x8000000000000000))
+        bits.U = ~bits.U;
+    else
+        bits.U |= SF_UINT64(0x8000000000000000);
 
-            // Read slot values.
-            if (!prop_a.GetSlotValueUnsafe(GetVM(), value_a) || !prop_b.GetSlotValueUnsafe(GetVM(), value_b))
-                // Exception.
-                break;
+    return desc ? ~bits.U : bits.U;
+}
+
+ASString FoldSortKey(MemoryHeap* heap, const ASString& str)
+{
+    const char*  src  = str.ToCStr();
+    const UPInt  size = str.GetSize();
+
+    UPInt i = 0;
+    while (i < size && SFtolower(src[i]) == src[i])
+        ++i;
+    if (i == size)
+        return str;
+
+    ArrayDH_POD<char> buff(heap);
+    buff.Resize(size);
+    for (i = 0; i < size; ++i)
+        buff[i] = (char)SFtolower(src[i]);
+
+    return str.GetManager()->CreateString(buff.GetDataPtr(), size);
+}
+
+CheckResult MakeSortOnKeys(
+    VM& vm,
+    const ValueArrayDH& fields,
+    const ArrayDH<UInt32>& flags,
+    const ArrayDH<ValuePtrPair>& values,
+    ArrayDH<KeyRowValueTriple>& rows,
+    ValueArrayDH& keys
+    )
+{
+    StringManager& sm = vm.GetStringManager();
+    const UPInt field_num = fields.GetSize();
+    const UPInt size = values.GetSize();
 
-            const UInt32 flags = Flags[i];
-            const bool descending = (flags & Instances::fl::Array::SortFlags_Descending) != 0;
+    rows.Reserve(size);
+    keys.Reserve(size * field_num);
 
-            if ((flags & Instances::fl::Array::SortFlags_Numeric) != 0)
+    for (UPInt i = 0; i < size; ++i)
+    {
+        const Value& v = *values[i].First;
+        rows.PushBack(KeyRowValueTriple(keys.GetSize(), &v, values[i].Second));
+
+        for (UPInt j = 0; j < field_num; ++j)
+        {
+            const Multiname name(vm.GetPublicNamespace(), fields[j]);
+            PropRef prop;
+            Value value;
+
+            FindObjProperty(prop, vm, v, name);
+            if (!prop)
             {
-                // Compare as numerics.
+                keys.PushBack(Value::GetUndefined());
+                continue;
+            }
 
-                Value::Number num_a = 0;
-                Value::Number num_b = 0;
+            // Read slot value.
+            if (!prop.GetSlotValueUnsafe(vm, value))
+                // Exception.
+                return false;
 
-                if (!value_a.Convert2Number(num_a) || !value_b.Convert2Number(num_b))
+            const UInt32 cur_flags = flags[j];
+            if ((cur_flags & Instances::fl::Array::SortFlags_Numeric) != 0)
+            {
+                Value::Number num = 0;
+                if (!value.Convert2Number(num))
                     // Exception.
-                    break;
+                    return false;
 
-                result = num_a - num_b;
+                keys.PushBack(Value(num));
             }
             else
             {
-                // Compare as strings.
-
-                // Convert slot values to string.
-                StringManager& sm = GetVM().GetStringManager();
-                ASString str_a = sm.CreateEmptyString();
-                ASString str_b = str_a;
-
-                if (!value_a.Convert2String(str_a) || !value_b.Convert2String(str_b))
+                ASString str = sm.CreateEmptyString();
+                if (!value.Convert2String(str))
                     // Exception.
-                    break;
+                    return false;
 
-                // Compare string.
-                const bool case_sensitive = (flags & Instances::fl::Array::SortFlags_CaseInsensitive) == 0;
+                if ((cur_flags & Instances::fl::Array::SortFlags_CaseInsensitive) != 0 &&
+                    (cur_flags & Instances::fl::Array::SortFlags_Locale) == 0)
+                    str = FoldSortKey(vm.GetMemoryHeap(), str);
 
-                if ((flags & Instances::fl::Array::SortFlags_Locale) != 0)
-                    result = str_a.LocaleCompare_CaseCheck(str_b, case_sensitive);
-                else
-                {
-                    if (case_sensitive)
-                        result = SFstrcmp(str_a.ToCStr(), str_b.ToCStr());
-                    else
-                        result = String::CompareNoCase(str_a.ToCStr(), str_b.ToCStr());
-                }
+                keys.PushBack(Value(str));
             }
+        }
+    }
+
+    return true;
+}
+
+Value::Number CompareOn::Compare(UPInt a, UPInt b) const
+{
+    Value::Number result = 0.0;
 
-            if (descending)
-                result = -result;
+    const UPInt size = Flags.GetSize();
+    for (UPInt i = 0; i < size && result == 0.0; ++i)
+    {
+        const Value& value_a = Keys[a + i];
+        const Value& value_b = Keys[b + i];
+
+        // One of the values doesn't have this field.
+        if (value_a.IsUndefined() || value_b.IsUndefined())
+            continue;
+
+        const UInt32 flags = Flags[i];
+
+        if ((flags & Instances::fl::Array::SortFlags_Numeric) != 0)
+            // Compare as numerics.
+            result = value_a.AsNumber() - value_b.AsNumber();
+        else
+        {
+            // Compare as strings.
+            // Keys of case-insensitive fields are already folded.
+            const ASString str_a = value_a.AsString();
+            const ASString str_b = value_b.AsString();
+
+            if ((flags & Instances::fl::Array::SortFlags_Locale) != 0)
+            {
+                const bool case_sensitive = (flags & Instances::fl::Array::SortFlags_CaseInsensitive) == 0;
+                result = str_a.LocaleCompare_CaseCheck(str_b, case_sensitive);
+            }
+            else
+                result = SFstrcmp(str_a.ToCStr(), str_b.ToCStr());
         }
+
+        if ((flags & Instances::fl::Array::SortFlags_Descending) != 0)
+            result = -result;
     }
 
     return result;
@@ -1303,10 +1380,11 @@ namespace Instances { namespace fl
                 SA.ForEach(vc);
 
                 // Choose a correct sorting function.
-                Impl::CompareAsNumber functor((flags & Instances::fl::Array::SortFlags_Descending) != 0);
+                const bool desc = (flags & Instances::fl::Array::SortFlags_Descending) != 0;
+                Impl::CompareAsNumber functor(desc);
 
                 // Sort.
-                Alg::QuickSortSafe(pairs, functor);
+                Impl::RadixSortByNumber(GetVM().GetMemoryHeap(), pairs, desc, functor);
                 const UPInt size = pairs.GetSize();
 
                 // Check for UNIQUESORT
@@ -1348,11 +1426,20 @@ namespace Instances { namespace fl
                 Impl::Value2StrCollector vc(GetVM(), pairs);
                 SA.ForEach(vc);
 
+                // Fold case of keys once instead of in every comparison.
+                const bool use_locale = (flags & Instances::fl::Array::SortFlags_Locale) != 0;
+                bool ci = (flags & Instances::fl::Array::SortFlags_CaseInsensitive) != 0;
+                if (ci && !use_locale)
+                {
+                    Impl::FoldSortKeys(GetVM().GetMemoryHeap(), pairs);
+                    ci = false;
+                }
+
                 // Choose a correct sorting function.
                 Impl::CompareAsString functor (
                     (flags & Instances::fl::Array::SortFlags_Descending) != 0,
-                    (flags & Instances::fl::Array::SortFlags_CaseInsensitive) != 0,
-                    (flags & Instances::fl::Array::SortFlags_Locale) != 0
+                    ci,
+                    use_locale
                     );
 
 
@@ -1536,12 +1623,18 @@ namespace Instances { namespace fl
             Impl::SparseArray newSA(heap);
 
             // Collect values into an array.
-            ArrayDH<Impl::ValuePtrPair> pairs(GetVM().GetMemoryHeap());
-            Impl::ValuePtrCollector vc(pairs);
+            ArrayDH<Impl::ValuePtrPair> values(GetVM().GetMemoryHeap());
+            Impl::ValuePtrCollector vc(values);
             SA.ForEach(vc);
 
+            // Extract sort keys once.
+            ArrayDH<Impl::KeyRowValueTriple> pairs(GetVM().GetMemoryHeap());
+            ValueArrayDH keys(heap);
+            if (!Impl::MakeSortOnKeys(GetVM(), fields, flags, values, pairs, keys))
+                return;
+
             // Sort.
-            Impl::CompareOn functor(GetVM(), fields, flags);
+            Impl::CompareOn functor(keys, flags);
             Alg::QuickSortSafe(pairs, functor);
 
             const UInt32 cur_flags = flags[0];
@@ -1567,10 +1660,10 @@ namespace Instances { namespace fl
             {
                 if (cur_flags & Instances::fl::Array::SortFlags_ReturnIndexedArray)
                     for (UPInt i = 0; i < size; ++i)
-                        newSA.PushBack(Value(pairs[i].Second));
+                        newSA.PushBack(Value(pairs[i].Third));
                 else
                     for (UPInt i = 0; i < size; ++i)
-                        newSA.PushBack(*pairs[i].First);
+                        newSA.PushBack(*pairs[i].Second);
 
                 // Preserve old size of Array.
                 if (size < GetSize())
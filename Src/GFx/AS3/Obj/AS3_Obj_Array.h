@@ -78,6 +78,107 @@ struct Triple : public Pair<T1, T2>
 typedef Triple<ASString, const Value*, UInt32> StringValueTriple;
 typedef Triple<Value::Number, const Value*, UInt32> NumberValueTriple;
 typedef Pair<const Value*, UInt32> ValuePtrPair;
+// First is the offset of the element's sort keys, see MakeSortOnKeys().
+typedef Triple<UPInt, const Value*, UInt32> KeyRowValueTriple;
+
+///////////////////////////////////////////////////////////////////////////////
+// Sort key helpers.
+// Keys are extracted once before sorting rather than converted in
+// every comparison. Sorting is stable: comparators order elements with
+// equal keys by their original index.
+
+// Returns a key that compares as an unsigned integer in the same order as
+// the number. -0 and +0 get the same key, and NaN is greater than any number.
+UInt64 NumberSortKey(Value::Number v, bool desc);
+
+// Returns the string with ASCII letters lowercased, so that keys compared
+// with SFstrcmp() are ordered the same way as by String::CompareNoCase().
+ASString FoldSortKey(MemoryHeap* heap, const ASString& str);
+
+template <typename T>
+void FoldSortKeys(MemoryHeap* heap, ArrayDH<T>& data)
+{
+    const UPInt size = data.GetSize();
+    for (UPInt i = 0; i < size; ++i)
+        data[i].First = FoldSortKey(heap, data[i].First);
+}
+
+// Stable LSD radix sort of pairs by their Number key (First), used for
+// NUMERIC sorting. Bytes shared by all keys, such as the high bytes of
+// integer values, are skipped. If the temporary arrays can't be allocated
+// the data is sorted in place with QuickSortSafe and 'less' instead.
+template <typename T, typename Less>
+void RadixSortByNumber(MemoryHeap* heap, ArrayDH<T>& data, bool desc, Less less)
+{
+    const UPInt size = data.GetSize();
+    if (size < 2)
+        return;
+
+    ArrayDH_POD<UInt64> keys(heap);
+    ArrayDH_POD<UInt64> keysTmp(heap);
+    ArrayDH_POD<UInt32> order(heap);
+    ArrayDH_POD<UInt32> orderTmp(heap);
+    keys.Resize(size);
+    keysTmp.Resize(size);
+    order.Resize(size);
+    orderTmp.Resize(size);
+    ArrayDH<T> sorted(heap);
+    sorted.Reserve(size);
+    if (orderTmp.GetSize() != size || sorted.GetCapacity() < size)
+    {
+        Alg::QuickSortSafe(data, less);
+        return;
+    }
+
+    UInt32 counts[8][256];
+    memset(counts, 0, sizeof(counts));
+
+    UPInt i;
+    unsigned b;
+    for (i = 0; i < size; ++i)
+    {
+        const UInt64 key = NumberSortKey(data[i].First, desc);
+        keys[i]  = key;
+        order[i] = static_cast<UInt32>(i);
+        for (b = 0; b < 8; ++b)
+            ++counts[b][(key >> (b * 8)) & 0xFF];
+    }
+
+    UInt64* srcKeys  = &keys[0];
+    UInt64* dstKeys  = &keysTmp[0];
+    UInt32* srcOrder = &order[0];
+    UInt32* dstOrder = &orderTmp[0];
+    for (b = 0; b < 8; ++b)
+    {
+        const unsigned shift = b * 8;
+        UInt32* count = counts[b];
+        if (count[(srcKeys[0] >> shift) & 0xFF] == size)
+            continue;
+
+        UInt32 offset = 0;
+        for (unsigned j = 0; j < 256; ++j)
+        {
+            const UInt32 c = count[j];
+            count[j] = offset;
+            offset += c;
+        }
+
+        for (i = 0; i < size; ++i)
+        {
+            const UInt32 pos = count[(srcKeys[i] >> shift) & 0xFF]++;
+            dstKeys[pos]  = srcKeys[i];
+            dstOrder[pos] = srcOrder[i];
+        }
+
+        Alg::Swap(srcKeys, dstKeys);
+        Alg::Swap(srcOrder, dstOrder);
+    }
+
+    for (i = 0; i < size; ++i)
+        sorted.PushBack(data[srcOrder[i]]);
+    for (i = 0; i < size; ++i)
+        data[i] = sorted[i];
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 class CompareAsNumber
@@ -126,7 +227,8 @@ public:
 public:
     bool operator ()(const DataType& a, const DataType& b) const
     {
-        return Compare(a.First, b.First) < 0;
+        const int r = Compare(a.First, b.First);
+        return r < 0 || (r == 0 && a.Third < b.Third);
     }
     bool Equal(const DataType& a, const DataType& b) const
     {
@@ -156,7 +258,8 @@ public:
 public:
     bool operator ()(const DataType& a, const DataType& b) const
     {
-        return Compare(*a.First, *b.First) < 0;
+        const int r = Compare(*a.First, *b.First);
+        return r < 0 || (r == 0 && a.Second < b.Second);
     }
     bool Equal(const DataType& a, const DataType& b) const
     {
@@ -176,20 +279,32 @@ private:
     const Value& Func;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// Collects the sort keys of sortOn() fields for each value: a Number or a
+// String (case-folded for CASEINSENSITIVE) per field, or undefined if the
+// value has no such property. Keys of rows[i] start at rows[i].First.
+// Returns false in case of exception.
+CheckResult MakeSortOnKeys(
+    VM& vm,
+    const ValueArrayDH& fields,
+    const ArrayDH<UInt32>& flags,
+    const ArrayDH<ValuePtrPair>& values,
+    ArrayDH<KeyRowValueTriple>& rows,
+    ValueArrayDH& keys
+    );
+
 ///////////////////////////////////////////////////////////////////////////////
 class CompareOn
 {
 public:
-    typedef ValuePtrPair DataType;
+    typedef KeyRowValueTriple DataType;
     typedef DataType KeyType;
 
     CompareOn(
-        VM& vm, 
-        const ValueArrayDH& fields,
+        const ValueArrayDH& keys,
         const ArrayDH<UInt32>& flags
         ) 
-        : Vm(vm)
-        , Fields(fields)
+        : Keys(keys)
         , Flags(flags)
     {
     }
@@ -198,25 +313,22 @@ public:
     // Operator *less*.
     bool operator ()(const DataType& a, const DataType& b) const
     {
-        return Compare(*a.First, *b.First) < 0;
+        const Value::Number r = Compare(a.First, b.First);
+        return r < 0 || (r == 0 && a.Third < b.Third);
     }
     bool Equal(const DataType& a, const DataType& b) const
     {
-        return Compare(*a.First, *b.First) == 0;
+        return Compare(a.First, b.First) == 0;
     }
 
-public:
-    VM& GetVM() const { return Vm; }
-
 private:
-    Value::Number Compare(const Value& a, const Value& b) const;
+    Value::Number Compare(UPInt a, UPInt b) const;
 
 private:
     CompareOn& operator = (const CompareOn&);
 
 private:
-    VM& Vm;
-    const ValueArrayDH& Fields;
+    const ValueArrayDH& Keys;
     const ArrayDH<UInt32>& Flags;
 };
 
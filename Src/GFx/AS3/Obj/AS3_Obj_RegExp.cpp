@@ -29,6 +29,85 @@ namespace Scaleform { namespace GFx { namespace AS3
 {
 
 //##protect##"methods"
+#ifdef SF_ENABLE_PCRE
+RegExpCode::RegExpCode(pcre* pre, pcre_extra* pextra)
+: pRE(pre), pExtra(pextra), JITCompiled(false)
+{
+    int jit = 0;
+    if (pExtra && pcre_fullinfo(pRE, pExtra, PCRE_INFO_JIT, &jit) == 0)
+        JITCompiled = (jit != 0);
+}
+
+RegExpCode::~RegExpCode()
+{
+    if (pExtra)
+        pcre_free_study(pExtra);
+    pcre_free(pRE);
+}
+
+///////////////////////////////////////////////////////////////////////////
+RegExpCache::RegExpCache() : pJITStack(NULL)
+{
+}
+
+RegExpCache::~RegExpCache()
+{
+    Clear();
+}
+
+void RegExpCache::Clear()
+{
+    Codes.Clear();
+    if (pJITStack)
+    {
+        pcre_jit_stack_free(pJITStack);
+        pJITStack = NULL;
+    }
+}
+
+Ptr<RegExpCode> RegExpCache::GetCode(const String& pattern, int options)
+{
+    Key key(pattern, options);
+    Ptr<RegExpCode>* pfound = Codes.Get(key);
+    if (pfound)
+        return *pfound;
+
+    const char* error;
+    int         errorOffset;
+    pcre*       pre = pcre_compile(pattern.ToCStr(), options, &error, &errorOffset, NULL);
+    // If pre is NULL - compilation failed at errorOffset
+    if (!pre)
+        return NULL;
+
+    // pcre_study returns NULL if there is nothing to optimize and the pattern
+    // could not be JIT-compiled; the pattern is then interpreted.
+    pcre_extra*     pextra = pcre_study(pre, PCRE_STUDY_JIT_COMPILE, &error);
+    Ptr<RegExpCode> pcode  = *SF_NEW RegExpCode(pre, pextra);
+
+    // Code still used by RegExp instances stays alive after the cache drops it.
+    if (Codes.GetSize() >= MaxEntries)
+        Codes.Clear();
+    Codes.Add(key, pcode);
+    return pcode;
+}
+
+int RegExpCache::Exec(const RegExpCode& code, const char* subject, int length,
+                      int startOffset, int* ovector, int ovecSize)
+{
+    pcre_extra* pextra = code.GetExtra();
+
+    // The default JIT stack is 32K on the machine stack, which deeply recursive
+    // patterns can overflow. The shared stack is assigned before every match,
+    // since code may outlive the cache it was compiled by.
+    if (code.IsJITCompiled())
+    {
+        if (!pJITStack)
+            pJITStack = pcre_jit_stack_alloc(JITStackStart, JITStackMax);
+        pcre_assign_jit_stack(pextra, NULL, pJITStack);
+    }
+    return pcre_exec(code.GetPattern(), pextra, subject, length, startOffset, 0, ovector, ovecSize);
+}
+#endif
 //##protect##"methods"
 
 // Values of default arguments.
@@ -64,7 +143,6 @@ namespace Instances { namespace fl
     : Instances::fl::Object(t)
 //##protect##"instance::RegExp::RegExp()$data"
 #ifdef SF_ENABLE_PCRE
-    , CompRegExp(NULL)
     , MatchOffset(-1)
     , MatchLength(0)
     , IsGlobal(false)
@@ -176,8 +254,7 @@ namespace Instances { namespace fl
 
         // Match a pattern
         if (startIndex < 0 || startIndex > subjectLen || (
-            matchCount = pcre_exec(CompRegExp, NULL, subject, subjectLen, startIndex, 0,
-                                   outputVector, OUTPUT_VECTOR_SIZE)) < 0)
+            matchCount = exec(subject, subjectLen, startIndex, outputVector, OUTPUT_VECTOR_SIZE)) < 0)
         {
             MatchOffset = matchCount;
             result = NULL;
@@ -213,9 +290,9 @@ namespace Instances { namespace fl
 		{
             int nameCount, nameEntrySize;
             char *nameTable;
-            pcre_fullinfo(CompRegExp, NULL, PCRE_INFO_NAMECOUNT, &nameCount);
-			pcre_fullinfo(CompRegExp, NULL, PCRE_INFO_NAMEENTRYSIZE, &nameEntrySize);
-            pcre_fullinfo(CompRegExp, NULL, PCRE_INFO_NAMETABLE, &nameTable);
+            pcre_fullinfo(pCode->GetPattern(), NULL, PCRE_INFO_NAMECOUNT, &nameCount);
+			pcre_fullinfo(pCode->GetPattern(), NULL, PCRE_INFO_NAMEENTRYSIZE, &nameEntrySize);
+            pcre_fullinfo(pCode->GetPattern(), NULL, PCRE_INFO_NAMETABLE, &nameTable);
 
 			for (int i = 0; i < nameCount; i++)
 			{
@@ -336,18 +413,28 @@ namespace Instances { namespace fl
                 }
             }
 
-            // Compile source pattern
-            const char *error;
-            int errorOffset;
-            CompRegExp = pcre_compile(Pattern.ToCStr(), OptionFlags, &error, &errorOffset, NULL);
-            // If CompRegExp is NULL - compilation failed at errorOffset
+            // Compile source pattern, or reuse code compiled for an identical one.
+            pCode = getCodeCache().GetCode(Pattern, OptionFlags);
         }
     }
 
-    RegExp::~RegExp()
+    RegExpCache& RegExp::getCodeCache()
+    {
+        // Instances of classes extending RegExp have user-defined traits and
+        // classes; the cache is kept by the built-in RegExp class.
+        const AS3::Traits* ptraits = &GetTraits();
+        while (ptraits->IsUserDefined())
+            ptraits = ptraits->GetParent();
+        SF_ASSERT(ptraits->GetName() == "RegExp");
+        return static_cast<Classes::fl::RegExp&>(const_cast<AS3::Traits*>(ptraits)->GetClass()).GetCodeCache();
+    }
+
+    int RegExp::exec(const char* subject, int length, int startOffset, int* ovector, int ovecSize)
     {
-        pcre_free(CompRegExp);
-        CompRegExp = NULL;
+        // Same result as pcre_exec on a pattern that failed to compile.
+        if (!pCode)
+            return PCRE_ERROR_NULL;
+        return getCodeCache().Exec(*pCode, subject, length, startOffset, ovector, ovecSize);
     }
 
     bool RegExp::hasOption(int mask)
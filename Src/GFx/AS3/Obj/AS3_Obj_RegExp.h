@@ -60,6 +60,80 @@ namespace Classes { namespace fl
 }}
 
 //##protect##"forward_declaration"
+#ifdef SF_ENABLE_PCRE
+// RegExpCode is a compiled and studied PCRE pattern. It is shared by all
+// RegExp instances created from the same source and options; on platforms
+// supporting it, pcre_study also JIT-compiles the pattern.
+class RegExpCode : public RefCountBase<RegExpCode, StatMV_VM_VM_Mem>
+{
+public:
+    RegExpCode(pcre* pre, pcre_extra* pextra);
+    ~RegExpCode();
+
+    pcre*       GetPattern() const  { return pRE; }
+    pcre_extra* GetExtra() const    { return pExtra; }
+    bool        IsJITCompiled() const { return JITCompiled; }
+
+private:
+    pcre*       pRE;
+    pcre_extra* pExtra;
+    bool        JITCompiled;
+};
+
+// RegExpCache maps pattern source and option flags to compiled code, so that
+// patterns created repeatedly, such as the ones String.match, replace, search
+// and split construct from string arguments, are compiled only once per VM.
+// It also owns the stack JIT-compiled patterns execute on.
+class RegExpCache
+{
+public:
+    enum
+    {
+        MaxEntries      = 256,
+        JITStackStart   = 32 * 1024,
+        JITStackMax     = 512 * 1024
+    };
+
+    RegExpCache();
+    ~RegExpCache();
+
+    // Returns compiled code for the pattern, or NULL if it fails to compile.
+    Ptr<RegExpCode> GetCode(const String& pattern, int options);
+    // Matches code against the subject; arguments and return value
+    // are the same as those of pcre_exec.
+    int             Exec(const RegExpCode& code, const char* subject, int length,
+                         int startOffset, int* ovector, int ovecSize);
+    void            Clear();
+
+private:
+    struct Key
+    {
+        String  Pattern;
+        int     Options;
+
+        Key() : Options(0) {}
+        Key(const String& pattern, int options) : Pattern(pattern), Options(options) {}
+
+        bool operator == (const Key& other) const
+        {
+            return Options == other.Options && Pattern == other.Pattern;
+        }
+
+        struct HashFunctor
+        {
+            UPInt operator()(const Key& key) const
+            {
+                return String::BernsteinHashFunction(key.Pattern.ToCStr(), key.Pattern.GetSize()) ^
+                       (UPInt)key.Options;
+            }
+        };
+    };
+    typedef HashLH<Key, Ptr<RegExpCode>, Key::HashFunctor, StatMV_VM_VM_Mem> CodeHash;
+
+    CodeHash        Codes;
+    pcre_jit_stack* pJITStack;
+};
+#endif
 //##protect##"forward_declaration"
 
 namespace Instances { namespace fl
@@ -95,13 +169,15 @@ namespace Instances { namespace fl
         bool        hasOption(int mask);
         ASString    optionFlagsGet();
 
+        RegExpCache& getCodeCache();
+        // Matches the compiled pattern; returns the same as pcre_exec.
+        int         exec(const char* subject, int length, int startOffset, int* ovector, int ovecSize);
+
     public:
         void        SetGlobal(bool global) { IsGlobal = global; }
         SInt32      GetMatchOffset() { return MatchOffset; }
         SInt32      GetMatchLength() { return MatchLength; }
         ASString    ToString();
-
-        ~RegExp();
 #else
     public:
         void        SetGlobal(bool)  {}
@@ -202,7 +278,7 @@ namespace Instances { namespace fl
         static const UInt32 OUTPUT_VECTOR_SIZE  = 99;   // Output 32 matches (32+1)*3
         static const UInt32 MATCH_BUFFER_SIZE   = 1024; // 1K for match
 
-        pcre*   CompRegExp;     // Compiled regexp pattern
+        Ptr<RegExpCode> pCode;  // Compiled regexp pattern, shared through RegExpCache
         SInt32  MatchOffset;    // Last match offset
         SInt32  MatchLength;    // Last match length
 
@@ -300,12 +376,21 @@ namespace Classes { namespace fl
         }
 
 //##protect##"class_$methods"
+    public:
+#ifdef SF_ENABLE_PCRE
+        RegExpCache& GetCodeCache() { return CodeCache; }
+#endif
+
+    private:
         void Call(const Value& _this, Value& result, unsigned argc, const Value* const argv);
         virtual Pickable<AS3::Object> MakePrototype() const;
         virtual void InitPrototype(AS3::Object& obj) const;       
 //##protect##"class_$methods"
 
 //##protect##"class_$data"
+#ifdef SF_ENABLE_PCRE
+        RegExpCache CodeCache;
+#endif
 //##protect##"class_$data"
 
     };
@@ -527,36 +527,44 @@ namespace Instances { namespace fl_events
         case EventId::Event_Activate:
         case EventId::Event_Deactivate:
             {
-                SPtr<fl_events::Event> efe = evtDispClass.CreateEventObject(
+                SPtr<fl_events::Event> efe = evtDispClass.AcquireEventObject(
                     (evtId.Id == EventId::Event_Activate) ? vm.GetBuiltin(AS3Builtin_activate) : vm.GetBuiltin(AS3Builtin_deactivate), false, false); 
                 efe->Target  = this;
                 if (!DispatchSingleEvent(efe, false) && dispObject)
                     dispObject->SetExecutionAborted();
-                return !efe->IsDefaultPrevented();
+                const bool notPrevented = !efe->IsDefaultPrevented();
+                evtDispClass.ReleaseEventObject(efe);
+                return notPrevented;
             }
         case EventId::Event_EnterFrame:
             {
-                SPtr<fl_events::Event> efe = evtDispClass.CreateEventObject(vm.GetBuiltin(AS3Builtin_enterFrame)); 
+                SPtr<fl_events::Event> efe = evtDispClass.AcquireEventObject(vm.GetBuiltin(AS3Builtin_enterFrame)); 
                 efe->Target  = this;
                 if (!DispatchSingleEvent(efe, false) && dispObject)
                     dispObject->SetExecutionAborted();
-                return !efe->IsDefaultPrevented();
+                const bool notPrevented = !efe->IsDefaultPrevented();
+                evtDispClass.ReleaseEventObject(efe);
+                return notPrevented;
             }
         case EventId::Event_Render:
             {
-                SPtr<fl_events::Event> efe = evtDispClass.CreateEventObject(vm.GetBuiltin(AS3Builtin_render)); 
+                SPtr<fl_events::Event> efe = evtDispClass.AcquireEventObject(vm.GetBuiltin(AS3Builtin_render)); 
                 efe->Target  = this;
                 if (!DispatchSingleEvent(efe, false) && dispObject)
                     dispObject->SetExecutionAborted();
-                return !efe->IsDefaultPrevented();
+                const bool notPrevented = !efe->IsDefaultPrevented();
+                evtDispClass.ReleaseEventObject(efe);
+                return notPrevented;
             }
 		case EventId::Event_Resize:
 			{
-				SPtr<fl_events::Event> efe = evtDispClass.CreateEventObject(vm.GetBuiltin(AS3Builtin_resize)); 
+				SPtr<fl_events::Event> efe = evtDispClass.AcquireEventObject(vm.GetBuiltin(AS3Builtin_resize)); 
 				efe->Target  = this;
                 if (!DispatchSingleEvent(efe, false) && dispObject)
                     dispObject->SetExecutionAborted();
-				return !efe->IsDefaultPrevented();
+                const bool notPrevented = !efe->IsDefaultPrevented();
+                evtDispClass.ReleaseEventObject(efe);
+                return notPrevented;
 			}
         case EventId::Event_KeyDown:
             {
@@ -928,12 +936,14 @@ namespace Instances { namespace fl_events
         }
         Classes::fl_events::EventDispatcher& evtDispClass = 
             static_cast<Classes::fl_events::EventDispatcher&>(GetClass());
-        SPtr<Instances::fl_events::Event> evtObj = evtDispClass.CreateEventObject(type); 
+        SPtr<Instances::fl_events::Event> evtObj = evtDispClass.AcquireEventObject(type); 
         evtObj->Target = target;
         evtObj->CurrentTarget = target;
         if (!DispatchSingleEvent(evtObj, useCapture) && dispObject)
             dispObject->SetExecutionAborted();
-        return !evtObj->IsDefaultPrevented();
+        const bool notPrevented = !evtObj->IsDefaultPrevented();
+        evtDispClass.ReleaseEventObject(evtObj);
+        return notPrevented;
     }
 
     bool EventDispatcher::MayHaveEnterFrameHandler() const
@@ -1175,6 +1185,8 @@ namespace Classes { namespace fl_events
 
         AS3::ForEachChild_GC<InstanceTraits::Traits, Mem_Stat>(prcc, EventTraits, op SF_DEBUG_ARG(*this));
         AS3::ForEachChild_GC<InstanceTraits::Traits, Mem_Stat>(prcc, MouseEventTraits, op SF_DEBUG_ARG(*this));
+        for (UPInt i = 0, n = EventPool.GetSize(); i < n; ++i)
+            AS3::ForEachChild_GC<Instances::fl_events::Event, Mem_Stat>(prcc, EventPool[i], op SF_DEBUG_ARG(*this));
     }
 
     void EventDispatcher::CacheEventTraits()
@@ -1194,6 +1206,41 @@ namespace Classes { namespace fl_events
         SF_ASSERT(evt);
         return evt;
     }
+
+    SPtr<Instances::fl_events::Event>       EventDispatcher::AcquireEventObject(const ASString& type, bool bubbles, bool cancelable)
+    {
+        if (EventPool.GetSize() == 0)
+            return CreateEventObject(type, bubbles, cancelable);
+
+        SPtr<Instances::fl_events::Event> evt = EventPool.Back();
+        EventPool.PopBack();
+
+        // Same state as after AS3Constructor.
+        evt->Type                   = type;
+        evt->Phase                  = Instances::fl_events::Event::Phase_Target;
+        evt->Bubbles                = bubbles;
+        evt->Cancelable             = cancelable;
+        evt->DefaultPrevented       = false;
+        evt->PropagationStopped     = false;
+        evt->ImmPropagationStopped  = false;
+        evt->WasDispatched          = false;
+        return evt;
+    }
+
+    void EventDispatcher::ReleaseEventObject(SPtr<Instances::fl_events::Event>& evt)
+    {
+        // An event referenced by script (stored in a variable, a closure, a
+        // weak dictionary and so on) is left alone and freed as usual.
+        if (evt && evt->GetRefCount() == 1 && !evt->HasWeakRef() &&
+            EventPool.GetSize() < EventPoolSize)
+        {
+            // Don't keep targets alive while the event is in the pool.
+            evt->Target         = NULL;
+            evt->CurrentTarget  = NULL;
+            EventPool.PushBack(evt);
+        }
+        evt = NULL;
+    }
 #ifdef GFX_ENABLE_MOBILE_APP_SUPPORT
     SPtr<Instances::fl_events::StageOrientationEvent> EventDispatcher::CreateStageOrientationEventObject
         (const ASString& type, bool bubbles, bool cancelable, const ASString& beforeOr, const ASString& afterOr)
@@ -373,6 +373,13 @@ namespace Classes { namespace fl_events
         void CacheEventTraits();
 
         SPtr<Instances::fl_events::Event>           CreateEventObject(const ASString& type, bool bubbles = false, bool cancelable = false);
+
+        // Pooled Event objects for events dispatched by the player itself.
+        // ReleaseEventObject returns the event to the pool only if nothing
+        // but evt references it, so events retained by script stay intact.
+        SPtr<Instances::fl_events::Event>           AcquireEventObject(const ASString& type, bool bubbles = false, bool cancelable = false);
+        void                                        ReleaseEventObject(SPtr<Instances::fl_events::Event>& evt);
+
         SPtr<Instances::fl_events::MouseEvent>      CreateMouseEventObject(
             const GFx::EventId& evtId, const ASString& type, Instances::fl::Object* target);
         SPtr<Instances::fl_events::KeyboardEvent>   CreateKeyboardEventObject(
@@ -409,6 +416,9 @@ namespace Classes { namespace fl_events
 //##protect##"class_$data"
         SPtr<InstanceTraits::Traits> EventTraits;
         SPtr<InstanceTraits::Traits> MouseEventTraits;
+
+        enum { EventPoolSize = 8 };
+        ArrayLH<SPtr<Instances::fl_events::Event> > EventPool;
 //##protect##"class_$data"
 
     };
@@ -19,6 +19,14 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "../../AS3_VM.h"
 #include "../../AS3_Marshalling.h"
 //##protect##"includes"
+#include "../AS3_Obj_Array.h"
+#include "../AS3_Obj_Date.h"
+#include "AS3_Obj_Utils_Dictionary.h"
+#include "../Vec/AS3_Obj_Vec_Vector_int.h"
+#include "../Vec/AS3_Obj_Vec_Vector_uint.h"
+#include "../Vec/AS3_Obj_Vec_Vector_double.h"
+#include "../Vec/AS3_Obj_Vec_Vector_String.h"
+#include "../Vec/AS3_Obj_Vec_Vector_object.h"
 #ifdef SF_ENABLE_ZLIB
 #include <zlib.h>
 #endif
@@ -98,6 +106,1730 @@ ZStream::~ZStream()
     SF_UNUSED1(error);
 }
 #endif // SF_ENABLE_ZLIB
+
+///////////////////////////////////////////////////////////////////////////////
+// AMF0/AMF3 serialization used by ByteArray::readObject() and writeObject().
+// Values are encoded straight into the ByteArray buffer at its current
+// position. AMF is always big-endian, independent of ByteArray::endian.
+
+namespace AMF
+{
+    enum
+    {
+        // AMF3 integers are 29 bit.
+        IntMax      = 0x0FFFFFFF,
+        IntMin      = -0x10000000,
+        // Maximum nesting of objects accepted by the reader.
+        MaxDepth    = 256
+    };
+
+    enum AMF0Marker
+    {
+        amf0Number          = 0x00,
+        amf0Boolean         = 0x01,
+        amf0String          = 0x02,
+        amf0Object          = 0x03,
+        amf0MovieClip       = 0x04,
+        amf0Null            = 0x05,
+        amf0Undefined       = 0x06,
+        amf0Reference       = 0x07,
+        amf0ECMAArray       = 0x08,
+        amf0ObjectEnd       = 0x09,
+        amf0StrictArray     = 0x0A,
+        amf0Date            = 0x0B,
+        amf0LongString      = 0x0C,
+        amf0Unsupported     = 0x0D,
+        amf0RecordSet       = 0x0E,
+        amf0XMLDocument     = 0x0F,
+        amf0TypedObject     = 0x10,
+        amf0AVMPlus         = 0x11
+    };
+
+    enum AMF3Marker
+    {
+        amf3Undefined       = 0x00,
+        amf3Null            = 0x01,
+        amf3False           = 0x02,
+        amf3True            = 0x03,
+        amf3Integer         = 0x04,
+        amf3Double          = 0x05,
+        amf3String          = 0x06,
+        amf3XMLDocument     = 0x07,
+        amf3Date            = 0x08,
+        amf3Array           = 0x09,
+        amf3Object          = 0x0A,
+        amf3XML             = 0x0B,
+        amf3ByteArray       = 0x0C,
+        amf3VectorInt       = 0x0D,
+        amf3VectorUInt      = 0x0E,
+        amf3VectorDouble    = 0x0F,
+        amf3VectorObject    = 0x10,
+        amf3Dictionary      = 0x11
+    };
+
+    // Object kinds with a dedicated encoding.
+    enum ObjectKind
+    {
+        okObject,
+        okArray,
+        okDate,
+        okXML,
+        okByteArray,
+        okVectorInt,
+        okVectorUInt,
+        okVectorDouble,
+        okVectorString,
+        okVectorObject,
+        okDictionary,
+        okFunction
+    };
+}
+
+// Property name of an array element.
+static ASString makeIndexName(StringManager& sm, UPInt ind)
+{
+    char buff[24];
+    SFsprintf(buff, sizeof(buff), "%u", static_cast<unsigned>(ind));
+    return sm.CreateString(buff);
+}
+
+class AMFWriter
+{
+public:
+    AMFWriter(Instances::fl_utils::ByteArray& ba);
+
+    void WriteAMF0(const Value& v);
+    void WriteAMF3(const Value& v);
+
+private:
+    VM& GetVM() const { return *pVM; }
+    AMF::ObjectKind getObjectKind(const AS3::Object& obj) const;
+
+    void writeU8(UInt8 v) { pBA->Write(v); }
+    void writeU16(UInt16 v);
+    void writeU32(UInt32 v);
+    void writeDouble(Value::Number v);
+    void writeU29(UInt32 v);
+    void writeUTF8(const ASString& str);
+
+    // Public sealed properties of typed objects; cached per Traits.
+    struct SealedInfo
+    {
+        UInt32  Start;
+        UInt32  Count;
+    };
+    SealedInfo getSealedInfo(const Traits& tr);
+    bool getSealedValue(AS3::Object& obj, const Value& name, Value& value);
+
+    // AMF0.
+    void writeString0(const ASString& str);
+    void writeKey0(const ASString& key);
+    void writeObject0(AS3::Object& obj);
+    void writeProperties0(AS3::Object& obj);
+    void writeArray0(Instances::fl::Array& arr);
+    void writeAMF3Switch(const Value& v);
+
+    // AMF3.
+    void writeInt3(SInt32 v);
+    void writeNumber3(Value::Number v);
+    void writeString3(const ASString& str);
+    bool writeObjectRef3(const AS3::Object& obj);
+    void writeObject3(AS3::Object& obj);
+    void writePlainObject3(AS3::Object& obj);
+    void writeArray3(Instances::fl::Array& arr);
+    void writeVector3(AS3::Object& obj, AMF::ObjectKind kind);
+    void writeDictionary3(AS3::Object& obj);
+
+private:
+    Instances::fl_utils::ByteArray*     pBA;
+    VM*                                 pVM;
+    Instances::fl::Namespace*           pPublicNs;
+
+    HashLH<const AS3::Object*, UInt32>  ObjectRefs;
+    HashLH<const ASStringNode*, UInt32> StringRefs;
+    HashLH<const Traits*, UInt32>       TraitsRefs;
+
+    HashLH<const Traits*, SealedInfo>   SealedCache;
+    ArrayLH<Value>                      SealedNames;
+};
+
+AMFWriter::AMFWriter(Instances::fl_utils::ByteArray& ba)
+: pBA(&ba)
+, pVM(&ba.GetVM())
+, pPublicNs(&ba.GetVM().GetPublicNamespace())
+{
+}
+
+AMF::ObjectKind AMFWriter::getObjectKind(const AS3::Object& obj) const
+{
+    const Traits& tr = obj.GetTraits();
+    if (!tr.IsInstanceTraits())
+        return AMF::okFunction;
+
+    switch (tr.GetTraitsType())
+    {
+    case Traits_Array:
+        return AMF::okArray;
+    case Traits_Date:
+        return AMF::okDate;
+    case Traits_XML:
+    case Traits_XMLList:
+        return AMF::okXML;
+    case Traits_Dictionary:
+        return AMF::okDictionary;
+    case Traits_Vector_object:
+        return AMF::okVectorObject;
+    case Traits_Function:
+        return AMF::okFunction;
+    default:
+        break;
+    }
+
+    VM& vm = GetVM();
+    if (&tr == &vm.GetITraitsVectorSInt())
+        return AMF::okVectorInt;
+    if (&tr == &vm.GetITraitsVectorUInt())
+        return AMF::okVectorUInt;
+    if (&tr == &vm.GetITraitsVectorNumber())
+        return AMF::okVectorDouble;
+    if (&tr == &vm.GetITraitsVectorString())
+        return AMF::okVectorString;
+    if (static_cast<const InstanceTraits::Traits&>(tr).IsOfType(static_cast<const InstanceTraits::Traits&>(pBA->GetTraits())))
+        return AMF::okByteArray;
+
+    return AMF::okObject;
+}
+
+void AMFWriter::writeU16(UInt16 v)
+{
+    v = Alg::ByteUtil::SystemToBE(v);
+    pBA->Write(&v, sizeof(v));
+}
+
+void AMFWriter::writeU32(UInt32 v)
+{
+    v = Alg::ByteUtil::SystemToBE(v);
+    pBA->Write(&v, sizeof(v));
+}
+
+void AMFWriter::writeDouble(Value::Number v)
+{
+    v = Alg::ByteUtil::SystemToBE(v);
+    pBA->Write(&v, sizeof(v));
+}
+
+void AMFWriter::writeU29(UInt32 v)
+{
+    UInt8       buff[4];
+    UInt32      size;
+
+    v &= 0x1FFFFFFF;
+    if (v < 0x80)
+    {
+        buff[0] = UInt8(v);
+        size = 1;
+    }
+    else if (v < 0x4000)
+    {
+        buff[0] = UInt8((v >> 7) | 0x80);
+        buff[1] = UInt8(v & 0x7F);
+        size = 2;
+    }
+    else if (v < 0x200000)
+    {
+        buff[0] = UInt8((v >> 14) | 0x80);
+        buff[1] = UInt8(((v >> 7) & 0x7F) | 0x80);
+        buff[2] = UInt8(v & 0x7F);
+        size = 3;
+    }
+    else
+    {
+        // The last byte holds full 8 bits.
+        buff[0] = UInt8((v >> 22) | 0x80);
+        buff[1] = UInt8(((v >> 15) & 0x7F) | 0x80);
+        buff[2] = UInt8(((v >> 8) & 0x7F) | 0x80);
+        buff[3] = UInt8(v & 0xFF);
+        size = 4;
+    }
+
+    pBA->Write(buff, size);
+}
+
+void AMFWriter::writeUTF8(const ASString& str)
+{
+    if (str.GetSize())
+        pBA->Write(str.ToCStr(), static_cast<UInt32>(str.GetSize()));
+}
+
+AMFWriter::SealedInfo AMFWriter::getSealedInfo(const Traits& tr)
+{
+    const SealedInfo* pcached = SealedCache.Get(&tr);
+    if (pcached)
+        return *pcached;
+
+    SealedInfo info;
+    info.Start = static_cast<UInt32>(SealedNames.GetSize());
+
+    // Plain objects have no sealed members.
+    if (&tr != &GetVM().GetITraitsObject())
+    {
+        HashLH<const ASStringNode*, bool> handled;
+
+        // Slots already include members of all parent classes.
+        const Slots::CIterator& eit = tr.REnd();
+        for (Slots::CIterator it = tr.RBegin(); it > eit; --it)
+        {
+            const SlotInfo& si = it.GetSlotInfo();
+
+            // Only public variables and read/write accessors are serialized.
+            if (si.GetNamespace() != *pPublicNs || si.IsClassOrConst())
+                continue;
+
+            const SlotInfo::BindingType bt = si.GetBindingType();
+            if (si.IsCode() && bt != SlotInfo::BT_GetSet)
+                continue;
+
+            ASStringNode* name = it.GetSlotName();
+            if (handled.Get(name))
+                continue;
+
+            handled.Add(name, true);
+            SealedNames.PushBack(Value(name));
+        }
+    }
+
+    info.Count = static_cast<UInt32>(SealedNames.GetSize()) - info.Start;
+    SealedCache.Add(&tr, info);
+    return info;
+}
+
+bool AMFWriter::getSealedValue(AS3::Object& obj, const Value& name, Value& value)
+{
+    const Multiname mn(*pPublicNs, name);
+    if (!obj.GetProperty(mn, value))
+        value.SetUndefined();
+
+    return !GetVM().IsException();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AMFWriter::WriteAMF0(const Value& v)
+{
+    if (v.IsNull())
+        return writeU8(AMF::amf0Null);
+
+    switch (v.GetKind())
+    {
+    case Value::kUndefined:
+        writeU8(AMF::amf0Undefined);
+        break;
+    case Value::kBoolean:
+        writeU8(AMF::amf0Boolean);
+        writeU8(v.AsBool() ? 1 : 0);
+        break;
+    case Value::kInt:
+        writeU8(AMF::amf0Number);
+        writeDouble(v.AsInt());
+        break;
+    case Value::kUInt:
+        writeU8(AMF::amf0Number);
+        writeDouble(v.AsUInt());
+        break;
+    case Value::kNumber:
+        writeU8(AMF::amf0Number);
+        writeDouble(v.AsNumber());
+        break;
+    case Value::kString:
+        writeString0(v.AsString());
+        break;
+    case Value::kObject:
+        writeObject0(*v.GetObject());
+        break;
+    default:
+        // Functions, classes, closures and namespaces have no AMF representation.
+        writeU8(AMF::amf0Undefined);
+        break;
+    }
+}
+
+void AMFWriter::writeString0(const ASString& str)
+{
+    if (str.GetSize() > 0xFFFF)
+    {
+        writeU8(AMF::amf0LongString);
+        writeU32(static_cast<UInt32>(str.GetSize()));
+    }
+    else
+    {
+        writeU8(AMF::amf0String);
+        writeU16(static_cast<UInt16>(str.GetSize()));
+    }
+    writeUTF8(str);
+}
+
+void AMFWriter::writeKey0(const ASString& key)
+{
+    // Keys are limited to 64K; longer keys are truncated.
+    const UInt16 size = static_cast<UInt16>(Alg::Min<UPInt>(key.GetSize(), 0xFFFF));
+    writeU16(size);
+    if (size)
+        pBA->Write(key.ToCStr(), size);
+}
+
+void AMFWriter::writeObject0(AS3::Object& obj)
+{
+    const AMF::ObjectKind kind = getObjectKind(obj);
+
+    switch (kind)
+    {
+    case AMF::okFunction:
+        return writeU8(AMF::amf0Undefined);
+    case AMF::okDate:
+        {
+            Value::Number time;
+            static_cast<Instances::fl::Date&>(obj).AS3getTime(time);
+            writeU8(AMF::amf0Date);
+            writeDouble(time);
+            // Time zone is reserved and should be zero.
+            writeU16(0);
+        }
+        return;
+    case AMF::okXML:
+        {
+            Value str = obj.CallProperty("toXMLString");
+            if (GetVM().IsException() || !str.IsString())
+                return;
+
+            writeU8(AMF::amf0XMLDocument);
+            writeU32(static_cast<UInt32>(str.AsString().GetSize()));
+            writeUTF8(str.AsString());
+        }
+        return;
+    case AMF::okObject:
+    case AMF::okArray:
+        break;
+    default:
+        // Types introduced by AMF3.
+        return writeAMF3Switch(Value(&obj));
+    }
+
+    const UInt32* pref = ObjectRefs.Get(&obj);
+    if (pref && *pref <= 0xFFFF)
+    {
+        writeU8(AMF::amf0Reference);
+        writeU16(static_cast<UInt16>(*pref));
+        return;
+    }
+    ObjectRefs.Set(&obj, static_cast<UInt32>(ObjectRefs.GetSize()));
+
+    if (kind == AMF::okArray)
+        return writeArray0(static_cast<Instances::fl::Array&>(obj));
+
+    writeU8(AMF::amf0Object);
+    writeProperties0(obj);
+}
+
+void AMFWriter::writeProperties0(AS3::Object& obj)
+{
+    // Sealed members.
+    const SealedInfo sealed = getSealedInfo(obj.GetTraits());
+    for (UInt32 i = 0; i < sealed.Count; ++i)
+    {
+        Value name = SealedNames[sealed.Start + i];
+        Value value;
+        if (!getSealedValue(obj, name, value))
+            return;
+
+        writeKey0(name.AsString());
+        WriteAMF0(value);
+        if (GetVM().IsException())
+            return;
+    }
+
+    // Dynamic members.
+    const AS3::Object::DynAttrsType* da = obj.GetDynamicAttrs();
+    for (AS3::Object::DynAttrsType::ConstIterator it = da->Begin(); !it.IsEnd(); ++it)
+    {
+        if (it->First.IsDoNotEnum())
+            continue;
+
+        writeKey0(it->First.GetName());
+        WriteAMF0(it->Second);
+        if (GetVM().IsException())
+            return;
+    }
+
+    writeU16(0);
+    writeU8(AMF::amf0ObjectEnd);
+}
+
+void AMFWriter::writeArray0(Instances::fl::Array& arr)
+{
+    const UPInt size = arr.GetSize();
+    const AS3::Object::DynAttrsType* da = arr.GetDynamicAttrs();
+
+    bool hasNamed = false;
+    for (AS3::Object::DynAttrsType::ConstIterator it = da->Begin(); !it.IsEnd(); ++it)
+    {
+        if (!it->First.IsDoNotEnum())
+        {
+            hasNamed = true;
+            break;
+        }
+    }
+
+    if (!hasNamed && !arr.IsSparse())
+    {
+        // Dense arrays are written as strict arrays.
+        writeU8(AMF::amf0StrictArray);
+        writeU32(static_cast<UInt32>(size));
+        for (UPInt i = 0; i < size; ++i)
+        {
+            WriteAMF0(arr.At(i));
+            if (GetVM().IsException())
+                return;
+        }
+        return;
+    }
+
+    // ECMA array: all defined elements and named properties as key/value pairs.
+    StringManager& sm = GetVM().GetStringManager();
+
+    writeU8(AMF::amf0ECMAArray);
+    writeU32(static_cast<UInt32>(size));
+    for (AbsoluteIndex ind = arr.GetNextArrayIndex(AbsoluteIndex(-1)); ind.IsValid(); ind = arr.GetNextArrayIndex(ind))
+    {
+        writeKey0(makeIndexName(sm, ind.Get()));
+        WriteAMF0(arr.At(ind.Get()));
+        if (GetVM().IsException())
+            return;
+    }
+
+    for (AS3::Object::DynAttrsType::ConstIterator it = da->Begin(); !it.IsEnd(); ++it)
+    {
+        if (it->First.IsDoNotEnum())
+            continue;
+
+        writeKey0(it->First.GetName());
+        WriteAMF0(it->Second);
+        if (GetVM().IsException())
+            return;
+    }
+
+    writeU16(0);
+    writeU8(AMF::amf0ObjectEnd);
+}
+
+void AMFWriter::writeAMF3Switch(const Value& v)
+{
+    // Each switch starts a new set of AMF3 reference tables.
+    writeU8(AMF::amf0AVMPlus);
+    AMFWriter writer(*pBA);
+    writer.WriteAMF3(v);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AMFWriter::WriteAMF3(const Value& v)
+{
+    if (v.IsNull())
+        return writeU8(AMF::amf3Null);
+
+    switch (v.GetKind())
+    {
+    case Value::kUndefined:
+        writeU8(AMF::amf3Undefined);
+        break;
+    case Value::kBoolean:
+        writeU8(v.AsBool() ? AMF::amf3True : AMF::amf3False);
+        break;
+    case Value::kInt:
+        writeInt3(v.AsInt());
+        break;
+    case Value::kUInt:
+        if (v.AsUInt() <= AMF::IntMax)
+            writeInt3(static_cast<SInt32>(v.AsUInt()));
+        else
+            writeNumber3(v.AsUInt());
+        break;
+    case Value::kNumber:
+        writeNumber3(v.AsNumber());
+        break;
+    case Value::kString:
+        writeU8(AMF::amf3String);
+        writeString3(v.AsString());
+        break;
+    case Value::kObject:
+        writeObject3(*v.GetObject());
+        break;
+    default:
+        // Functions, classes, closures and namespaces have no AMF representation.
+        writeU8(AMF::amf3Undefined);
+        break;
+    }
+}
+
+void AMFWriter::writeInt3(SInt32 v)
+{
+    if (v < AMF::IntMin || v > AMF::IntMax)
+        return writeNumber3(v);
+
+    writeU8(AMF::amf3Integer);
+    writeU29(static_cast<UInt32>(v));
+}
+
+void AMFWriter::writeNumber3(Value::Number v)
+{
+    writeU8(AMF::amf3Double);
+    writeDouble(v);
+}
+
+void AMFWriter::writeString3(const ASString& str)
+{
+    // Empty strings are never sent by reference.
+    if (str.IsEmpty())
+        return writeU29(0x01);
+
+    const UInt32* pref = StringRefs.Get(str.GetNode());
+    if (pref)
+        return writeU29(*pref << 1);
+
+    StringRefs.Add(str.GetNode(), static_cast<UInt32>(StringRefs.GetSize()));
+    writeU29((static_cast<UInt32>(str.GetSize()) << 1) | 1);
+    writeUTF8(str);
+}
+
+bool AMFWriter::writeObjectRef3(const AS3::Object& obj)
+{
+    const UInt32* pref = ObjectRefs.Get(&obj);
+    if (pref)
+    {
+        writeU29(*pref << 1);
+        return true;
+    }
+
+    ObjectRefs.Add(&obj, static_cast<UInt32>(ObjectRefs.GetSize()));
+    return false;
+}
+
+void AMFWriter::writeObject3(AS3::Object& obj)
+{
+    const AMF::ObjectKind kind = getObjectKind(obj);
+
+    switch (kind)
+    {
+    case AMF::okFunction:
+        return writeU8(AMF::amf3Undefined);
+    case AMF::okArray:
+        writeU8(AMF::amf3Array);
+        if (!writeObjectRef3(obj))
+            writeArray3(static_cast<Instances::fl::Array&>(obj));
+        break;
+    case AMF::okDate:
+        writeU8(AMF::amf3Date);
+        if (!writeObjectRef3(obj))
+        {
+            Value::Number time;
+            static_cast<Instances::fl::Date&>(obj).AS3getTime(time);
+            writeU29(0x01);
+            writeDouble(time);
+        }
+        break;
+    case AMF::okXML:
+        writeU8(AMF::amf3XML);
+        if (!writeObjectRef3(obj))
+        {
+            Value str = obj.CallProperty("toXMLString");
+            if (GetVM().IsException() || !str.IsString())
+                return;
+
+            writeU29((static_cast<UInt32>(str.AsString().GetSize()) << 1) | 1);
+            writeUTF8(str.AsString());
+        }
+        break;
+    case AMF::okByteArray:
+        writeU8(AMF::amf3ByteArray);
+        if (!writeObjectRef3(obj))
+        {
+            const Instances::fl_utils::ByteArray& ba = static_cast<Instances::fl_utils::ByteArray&>(obj);
+            const UInt32 length = ba.GetLength();
+            writeU29((length << 1) | 1);
+            if (&ba == pBA)
+            {
+                // Writing a ByteArray into itself; copy the original contents first.
+                ArrayLH<UInt8> copy;
+                copy.Resize(length);
+                if (length)
+                {
+                    memcpy(copy.GetDataPtr(), ba.GetDataPtr(), length);
+                    pBA->Write(copy.GetDataPtr(), length);
+                }
+            }
+            else if (length)
+                pBA->Write(ba.GetDataPtr(), length);
+        }
+        break;
+    case AMF::okVectorInt:
+    case AMF::okVectorUInt:
+    case AMF::okVectorDouble:
+    case AMF::okVectorString:
+    case AMF::okVectorObject:
+        writeVector3(obj, kind);
+        break;
+    case AMF::okDictionary:
+        writeU8(AMF::amf3Dictionary);
+        if (!writeObjectRef3(obj))
+            writeDictionary3(obj);
+        break;
+    default:
+        writeU8(AMF::amf3Object);
+        if (!writeObjectRef3(obj))
+            writePlainObject3(obj);
+        break;
+    }
+}
+
+void AMFWriter::writePlainObject3(AS3::Object& obj)
+{
+    const Traits& tr = obj.GetTraits();
+    const SealedInfo sealed = getSealedInfo(tr);
+    const bool dynamic = tr.IsDynamic();
+
+    // Traits.
+    const UInt32* pref = TraitsRefs.Get(&tr);
+    if (pref)
+        writeU29((*pref << 2) | 0x01);
+    else
+    {
+        TraitsRefs.Add(&tr, static_cast<UInt32>(TraitsRefs.GetSize()));
+        writeU29((sealed.Count << 4) | (dynamic ? 0x08 : 0) | 0x03);
+        // There is no class alias registry; objects are sent anonymously.
+        writeString3(GetVM().GetStringManager().CreateEmptyString());
+        for (UInt32 i = 0; i < sealed.Count; ++i)
+            writeString3(SealedNames[sealed.Start + i].AsString());
+    }
+
+    // Sealed member values in traits order.
+    for (UInt32 i = 0; i < sealed.Count; ++i)
+    {
+        Value value;
+        if (!getSealedValue(obj, SealedNames[sealed.Start + i], value))
+            return;
+
+        WriteAMF3(value);
+        if (GetVM().IsException())
+            return;
+    }
+
+    if (!dynamic)
+        return;
+
+    const AS3::Object::DynAttrsType* da = obj.GetDynamicAttrs();
+    for (AS3::Object::DynAttrsType::ConstIterator it = da->Begin(); !it.IsEnd(); ++it)
+    {
+        // Empty name terminates the dynamic member list.
+        if (it->First.IsDoNotEnum() || it->First.GetName().IsEmpty())
+            continue;
+
+        writeString3(it->First.GetName());
+        WriteAMF3(it->Second);
+        if (GetVM().IsException())
+            return;
+    }
+    writeU29(0x01);
+}
+
+void AMFWriter::writeArray3(Instances::fl::Array& arr)
+{
+    // Dense part are the elements stored contiguously from index zero.
+    const UPInt dense = arr.IsSparse() ? arr.GetContiguousPart().GetSize() : arr.GetSize();
+    writeU29((static_cast<UInt32>(dense) << 1) | 1);
+
+    // Associative part: elements past the dense part and named properties.
+    if (arr.IsSparse())
+    {
+        StringManager& sm = GetVM().GetStringManager();
+        AbsoluteIndex ind(static_cast<SPInt>(dense) - 1);
+
+        for (ind = arr.GetNextArrayIndex(ind); ind.IsValid(); ind = arr.GetNextArrayIndex(ind))
+        {
+            writeString3(makeIndexName(sm, ind.Get()));
+            WriteAMF3(arr.At(ind.Get()));
+            if (GetVM().IsException())
+                return;
+        }
+    }
+
+    const AS3::Object::DynAttrsType* da = arr.GetDynamicAttrs();
+    for (AS3::Object::DynAttrsType::ConstIterator it = da->Begin(); !it.IsEnd(); ++it)
+    {
+        if (it->First.IsDoNotEnum() || it->First.GetName().IsEmpty())
+            continue;
+
+        writeString3(it->First.GetName());
+        WriteAMF3(it->Second);
+        if (GetVM().IsException())
+            return;
+    }
+    writeU29(0x01);
+
+    for (UPInt i = 0; i < dense; ++i)
+    {
+        WriteAMF3(arr.At(i));
+        if (GetVM().IsException())
+            return;
+    }
+}
+
+void AMFWriter::writeVector3(AS3::Object& obj, AMF::ObjectKind kind)
+{
+    const ArrayBase* parr;
+    UInt8 marker;
+
+    switch (kind)
+    {
+    case AMF::okVectorInt:
+        marker = AMF::amf3VectorInt;
+        parr = &static_cast<Instances::fl_vec::Vector_int&>(obj).GetArrayBase();
+        break;
+    case AMF::okVectorUInt:
+        marker = AMF::amf3VectorUInt;
+        parr = &static_cast<Instances::fl_vec::Vector_uint&>(obj).GetArrayBase();
+        break;
+    case AMF::okVectorDouble:
+        marker = AMF::amf3VectorDouble;
+        parr = &static_cast<Instances::fl_vec::Vector_double&>(obj).GetArrayBase();
+        break;
+    case AMF::okVectorString:
+        marker = AMF::amf3VectorObject;
+        parr = &static_cast<Instances::fl_vec::Vector_String&>(obj).GetArrayBase();
+        break;
+    default:
+        marker = AMF::amf3VectorObject;
+        parr = &static_cast<Instances::fl_vec::Vector_object&>(obj).GetArrayBase();
+        break;
+    }
+
+    writeU8(marker);
+    if (writeObjectRef3(obj))
+        return;
+
+    const UInt32 size = parr->GetArraySize();
+    writeU29((size << 1) | 1);
+    writeU8(parr->GetFixed() ? 1 : 0);
+
+    Value v;
+    switch (kind)
+    {
+    case AMF::okVectorInt:
+    case AMF::okVectorUInt:
+        for (UInt32 i = 0; i < size; ++i)
+        {
+            parr->GetValueUnsafe(i, v);
+            writeU32(v.AsUInt());
+        }
+        break;
+    case AMF::okVectorDouble:
+        for (UInt32 i = 0; i < size; ++i)
+        {
+            parr->GetValueUnsafe(i, v);
+            writeDouble(v.AsNumber());
+        }
+        break;
+    default:
+        {
+            StringManager& sm = GetVM().GetStringManager();
+            if (kind == AMF::okVectorString)
+                writeString3(sm.CreateConstString("String"));
+            else
+            {
+                const ClassTraits::Traits& ctr = static_cast<Instances::fl_vec::Vector_object&>(obj).GetEnclosedClassTraits();
+                const InstanceTraits::Traits& itr = ctr.GetInstanceTraits();
+                // Vector.<Object> and Vector.<*> are sent with an empty type name.
+                if (&itr == &GetVM().GetITraitsObject())
+                    writeString3(sm.CreateEmptyString());
+                else
+                    writeString3(itr.GetQualifiedName(Traits::qnfWithDot));
+            }
+
+            for (UInt32 i = 0; i < size; ++i)
+            {
+                parr->GetValue(i, v);
+                WriteAMF3(v);
+                if (GetVM().IsException())
+                    return;
+            }
+        }
+        break;
+    }
+}
+
+void AMFWriter::writeDictionary3(AS3::Object& obj)
+{
+    UInt32 count = 0;
+    GlobalSlotIndex ind(0);
+    while ((ind = obj.GetNextDynPropIndex(ind)).Get())
+        ++count;
+
+    writeU29((count << 1) | 1);
+    writeU8(static_cast<Instances::fl_utils::Dictionary&>(obj).IsWeakKeys() ? 1 : 0);
+
+    ind = GlobalSlotIndex(0);
+    while ((ind = obj.GetNextDynPropIndex(ind)).Get())
+    {
+        Value key, value;
+        obj.GetNextPropertyName(key, ind);
+        obj.GetNextPropertyValue(value, ind);
+        if (GetVM().IsException())
+            return;
+
+        WriteAMF3(key);
+        WriteAMF3(value);
+        if (GetVM().IsException())
+            return;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+class AMFReader
+{
+public:
+    AMFReader(Instances::fl_utils::ByteArray& ba);
+
+    // Return false in case of an exception.
+    CheckResult ReadAMF0(Value& v);
+    CheckResult ReadAMF3(Value& v);
+
+private:
+    VM& GetVM() const { return *pVM; }
+
+    CheckResult readU8(UInt8& v);
+    CheckResult readU16(UInt16& v);
+    CheckResult readU32(UInt32& v);
+    CheckResult readDouble(Value::Number& v);
+    CheckResult readU29(UInt32& v);
+    CheckResult readUTF8(ASString& str, UInt32 len);
+
+    CheckResult throwRangeError();
+    CheckResult enter();
+    void leave() { --Depth; }
+
+    // AMF0.
+    CheckResult readValue0(Value& v);
+    CheckResult readKey0(ASString& key);
+    CheckResult readProperties0(AS3::Object& obj);
+
+    // AMF3.
+    CheckResult readValue3(Value& v);
+    CheckResult readString3(ASString& str);
+    // Reads an object header; returns true in isRef if the object was sent by reference.
+    CheckResult readObjectHeader3(UInt32& header, Value& v, bool& isRef);
+    CheckResult readObject3(Value& v);
+    CheckResult readArray3(Value& v);
+    CheckResult readVector3(UInt8 marker, Value& v);
+    CheckResult readDictionary3(Value& v);
+
+private:
+    struct TraitsInfo
+    {
+        UInt32  Start;
+        UInt32  Count;
+        bool    Dynamic;
+    };
+
+    Instances::fl_utils::ByteArray*     pBA;
+    VM*                                 pVM;
+    Instances::fl::Namespace*           pPublicNs;
+    unsigned                            Depth;
+
+    ArrayLH<Value>                      Objects;
+    ArrayLH<Value>                      Strings;
+    ArrayLH<TraitsInfo>                 TraitsTable;
+    ArrayLH<Value>                      TraitsNames;
+};
+
+AMFReader::AMFReader(Instances::fl_utils::ByteArray& ba)
+: pBA(&ba)
+, pVM(&ba.GetVM())
+, pPublicNs(&ba.GetVM().GetPublicNamespace())
+, Depth(0)
+{
+}
+
+CheckResult AMFReader::readU8(UInt8& v)
+{
+    if (pBA->EOFError())
+        return false;
+
+    v = pBA->Data[pBA->Position++];
+    return true;
+}
+
+CheckResult AMFReader::readU16(UInt16& v)
+{
+    if (!pBA->Read(&v, sizeof(v)))
+        return false;
+
+    v = Alg::ByteUtil::BEToSystem(v);
+    return true;
+}
+
+CheckResult AMFReader::readU32(UInt32& v)
+{
+    if (!pBA->Read(&v, sizeof(v)))
+        return false;
+
+    v = Alg::ByteUtil::BEToSystem(v);
+    return true;
+}
+
+CheckResult AMFReader::readDouble(Value::Number& v)
+{
+    if (!pBA->Read(&v, sizeof(v)))
+        return false;
+
+    v = Alg::ByteUtil::BEToSystem(v);
+    return true;
+}
+
+CheckResult AMFReader::readU29(UInt32& v)
+{
+    v = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        UInt8 b;
+        if (!readU8(b))
+            return false;
+
+        if (i == 3)
+        {
+            // The last byte holds full 8 bits.
+            v = (v << 8) | b;
+            break;
+        }
+
+        v = (v << 7) | (b & 0x7F);
+        if ((b & 0x80) == 0)
+            break;
+    }
+
+    return true;
+}
+
+CheckResult AMFReader::readUTF8(ASString& str, UInt32 len)
+{
+    if (!pBA->CanRead(len))
+    {
+        pBA->ThrowEOFError();
+        return false;
+    }
+
+    str = GetVM().GetStringManager().CreateString(reinterpret_cast<const char*>(pBA->Data.GetDataPtr() + pBA->Position), len);
+    pBA->Position += len;
+    return true;
+}
+
+CheckResult AMFReader::throwRangeError()
+{
+    VM& vm = GetVM();
+    vm.ThrowRangeError(VM::Error(VM::eParamRangeError, vm));
+    return false;
+}
+
+CheckResult AMFReader::enter()
+{
+    if (++Depth > AMF::MaxDepth)
+    {
+        VM& vm = GetVM();
+        vm.ThrowError(VM::Error(VM::eStackOverflowError, vm));
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+CheckResult AMFReader::ReadAMF0(Value& v)
+{
+    if (!enter())
+        return false;
+
+    const bool result = readValue0(v);
+    leave();
+    return result;
+}
+
+CheckResult AMFReader::readKey0(ASString& key)
+{
+    UInt16 len;
+    if (!readU16(len))
+        return false;
+
+    return readUTF8(key, len);
+}
+
+CheckResult AMFReader::readProperties0(AS3::Object& obj)
+{
+    ASString key = GetVM().GetStringManager().CreateEmptyString();
+
+    while (true)
+    {
+        if (!readKey0(key))
+            return false;
+
+        if (key.IsEmpty())
+        {
+            UInt8 marker;
+            if (!readU8(marker))
+                return false;
+            if (marker == AMF::amf0ObjectEnd)
+                return true;
+
+            // Empty key is not followed by the end marker; step back and read its value.
+            --pBA->Position;
+        }
+
+        Value value;
+        if (!ReadAMF0(value))
+            return false;
+
+        if (!obj.SetProperty(Multiname(*pPublicNs, Value(key)), value))
+            return false;
+    }
+}
+
+CheckResult AMFReader::readValue0(Value& v)
+{
+    VM& vm = GetVM();
+    UInt8 marker;
+    if (!readU8(marker))
+        return false;
+
+    switch (marker)
+    {
+    case AMF::amf0Number:
+        {
+            Value::Number n;
+            if (!readDouble(n))
+                return false;
+            v.SetNumber(n);
+        }
+        break;
+    case AMF::amf0Boolean:
+        {
+            UInt8 b;
+            if (!readU8(b))
+                return false;
+            v.SetBool(b != 0);
+        }
+        break;
+    case AMF::amf0String:
+    case AMF::amf0LongString:
+    case AMF::amf0XMLDocument:
+        {
+            UInt32 len;
+            if (marker == AMF::amf0String)
+            {
+                UInt16 len16;
+                if (!readU16(len16))
+                    return false;
+                len = len16;
+            }
+            else if (!readU32(len))
+                return false;
+
+            ASString str = vm.GetStringManager().CreateEmptyString();
+            if (!readUTF8(str, len))
+                return false;
+
+            if (marker != AMF::amf0XMLDocument)
+                v = str;
+            else
+            {
+                const Value arg(str);
+                if (!vm.ConstructBuiltinValue(v, "XML", 1, &arg))
+                    return false;
+            }
+        }
+        break;
+    case AMF::amf0Object:
+    case AMF::amf0TypedObject:
+        {
+            if (marker == AMF::amf0TypedObject)
+            {
+                // There is no class alias registry; typed objects are read as plain objects.
+                ASString className = vm.GetStringManager().CreateEmptyString();
+                if (!readKey0(className))
+                    return false;
+            }
+
+            SPtr<Instances::fl::Object> obj = vm.MakeObject();
+            v = Value(obj);
+            Objects.PushBack(v);
+            if (!readProperties0(*obj))
+                return false;
+        }
+        break;
+    case AMF::amf0Null:
+        v.SetNull();
+        break;
+    case AMF::amf0Undefined:
+    case AMF::amf0Unsupported:
+        v.SetUndefined();
+        break;
+    case AMF::amf0Reference:
+        {
+            UInt16 ref;
+            if (!readU16(ref))
+                return false;
+            if (ref >= Objects.GetSize())
+                return throwRangeError();
+            v = Objects[ref];
+        }
+        break;
+    case AMF::amf0ECMAArray:
+        {
+            // The count is only a hint; the pairs are terminated by the end marker.
+            UInt32 count;
+            if (!readU32(count))
+                return false;
+
+            SPtr<Instances::fl::Array> arr = vm.MakeArray();
+            v = Value(arr);
+            Objects.PushBack(v);
+            if (!readProperties0(*arr))
+                return false;
+        }
+        break;
+    case AMF::amf0StrictArray:
+        {
+            UInt32 count;
+            if (!readU32(count))
+                return false;
+
+            SPtr<Instances::fl::Array> arr = vm.MakeArray();
+            v = Value(arr);
+            Objects.PushBack(v);
+            for (UInt32 i = 0; i < count; ++i)
+            {
+                Value value;
+                if (!ReadAMF0(value))
+                    return false;
+                arr->PushBack(value);
+            }
+        }
+        break;
+    case AMF::amf0Date:
+        {
+            Value::Number time;
+            UInt16 tz;
+            if (!readDouble(time) || !readU16(tz))
+                return false;
+
+            const Value arg(time);
+            if (!vm.ConstructBuiltinValue(v, "Date", 1, &arg))
+                return false;
+        }
+        break;
+    case AMF::amf0AVMPlus:
+        {
+            // Each switch starts a new set of AMF3 reference tables.
+            AMFReader reader(*pBA);
+            reader.Depth = Depth;
+            if (!reader.ReadAMF3(v))
+                return false;
+        }
+        break;
+    default:
+        // MovieClip, RecordSet and unknown markers.
+        return throwRangeError();
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+CheckResult AMFReader::ReadAMF3(Value& v)
+{
+    if (!enter())
+        return false;
+
+    const bool result = readValue3(v);
+    leave();
+    return result;
+}
+
+CheckResult AMFReader::readString3(ASString& str)
+{
+    UInt32 header;
+    if (!readU29(header))
+        return false;
+
+    if ((header & 1) == 0)
+    {
+        const UInt32 ref = header >> 1;
+        if (ref >= Strings.GetSize())
+            return throwRangeError();
+
+        str = Strings[ref].AsString();
+        return true;
+    }
+
+    const UInt32 len = header >> 1;
+    if (len == 0)
+    {
+        str = GetVM().GetStringManager().CreateEmptyString();
+        return true;
+    }
+
+    if (!readUTF8(str, len))
+        return false;
+
+    Strings.PushBack(Value(str));
+    return true;
+}
+
+CheckResult AMFReader::readObjectHeader3(UInt32& header, Value& v, bool& isRef)
+{
+    if (!readU29(header))
+        return false;
+
+    isRef = (header & 1) == 0;
+    header >>= 1;
+    if (!isRef)
+        return true;
+
+    if (header >= Objects.GetSize())
+        return throwRangeError();
+
+    v = Objects[header];
+    return true;
+}
+
+CheckResult AMFReader::readValue3(Value& v)
+{
+    VM& vm = GetVM();
+    UInt8 marker;
+    if (!readU8(marker))
+        return false;
+
+    switch (marker)
+    {
+    case AMF::amf3Undefined:
+        v.SetUndefined();
+        break;
+    case AMF::amf3Null:
+        v.SetNull();
+        break;
+    case AMF::amf3False:
+        v.SetBool(false);
+        break;
+    case AMF::amf3True:
+        v.SetBool(true);
+        break;
+    case AMF::amf3Integer:
+        {
+            UInt32 u;
+            if (!readU29(u))
+                return false;
+
+            // Sign extend 29 bits.
+            if (u & 0x10000000)
+                u |= 0xE0000000;
+            v.SetSInt32(static_cast<SInt32>(u));
+        }
+        break;
+    case AMF::amf3Double:
+        {
+            Value::Number n;
+            if (!readDouble(n))
+                return false;
+            v.SetNumber(n);
+        }
+        break;
+    case AMF::amf3String:
+        {
+            ASString str = vm.GetStringManager().CreateEmptyString();
+            if (!readString3(str))
+                return false;
+            v = str;
+        }
+        break;
+    case AMF::amf3XMLDocument:
+    case AMF::amf3XML:
+        {
+            UInt32 header;
+            bool isRef;
+            if (!readObjectHeader3(header, v, isRef))
+                return false;
+            if (isRef)
+                break;
+
+            ASString str = vm.GetStringManager().CreateEmptyString();
+            if (!readUTF8(str, header))
+                return false;
+
+            const Value arg(str);
+            if (!vm.ConstructBuiltinValue(v, "XML", 1, &arg))
+                return false;
+            Objects.PushBack(v);
+        }
+        break;
+    case AMF::amf3Date:
+        {
+            UInt32 header;
+            bool isRef;
+            if (!readObjectHeader3(header, v, isRef))
+                return false;
+            if (isRef)
+                break;
+
+            Value::Number time;
+            if (!readDouble(time))
+                return false;
+
+            const Value arg(time);
+            if (!vm.ConstructBuiltinValue(v, "Date", 1, &arg))
+                return false;
+            Objects.PushBack(v);
+        }
+        break;
+    case AMF::amf3Array:
+        return readArray3(v);
+    case AMF::amf3Object:
+        return readObject3(v);
+    case AMF::amf3ByteArray:
+        {
+            UInt32 header;
+            bool isRef;
+            if (!readObjectHeader3(header, v, isRef))
+                return false;
+            if (isRef)
+                break;
+
+            if (!pBA->CanRead(header))
+            {
+                pBA->ThrowEOFError();
+                return false;
+            }
+
+            SPtr<Instances::fl_utils::ByteArray> ba;
+            if (!vm.ConstructBuiltinObject(ba, "flash.utils.ByteArray"))
+                return false;
+
+            if (header)
+            {
+                ba->Write(pBA->Data.GetDataPtr() + pBA->Position, header);
+                ba->Position = 0;
+                pBA->Position += header;
+            }
+
+            v = Value(ba);
+            Objects.PushBack(v);
+        }
+        break;
+    case AMF::amf3VectorInt:
+    case AMF::amf3VectorUInt:
+    case AMF::amf3VectorDouble:
+    case AMF::amf3VectorObject:
+        return readVector3(marker, v);
+    case AMF::amf3Dictionary:
+        return readDictionary3(v);
+    default:
+        return throwRangeError();
+    }
+
+    return true;
+}
+
+CheckResult AMFReader::readObject3(Value& v)
+{
+    VM& vm = GetVM();
+    UInt32 header;
+    bool isRef;
+    if (!readObjectHeader3(header, v, isRef))
+        return false;
+    if (isRef)
+        return true;
+
+    TraitsInfo info;
+    if ((header & 1) == 0)
+    {
+        // Traits reference.
+        const UInt32 ref = header >> 1;
+        if (ref >= TraitsTable.GetSize())
+            return throwRangeError();
+
+        info = TraitsTable[ref];
+    }
+    else
+    {
+        if (header & 2)
+        {
+            // Externalizable objects require class aliases and IExternalizable.
+            vm.ThrowArgumentError(VM::Error(VM::eInvalidArgumentError, vm SF_DEBUG_ARG("IExternalizable")));
+            return false;
+        }
+
+        // There is no class alias registry; objects are read as plain dynamic objects.
+        ASString className = vm.GetStringManager().CreateEmptyString();
+        if (!readString3(className))
+            return false;
+
+        info.Start = static_cast<UInt32>(TraitsNames.GetSize());
+        info.Count = header >> 3;
+        info.Dynamic = (header & 4) != 0;
+
+        ASString name = vm.GetStringManager().CreateEmptyString();
+        for (UInt32 i = 0; i < info.Count; ++i)
+        {
+            if (!readString3(name))
+                return false;
+            TraitsNames.PushBack(Value(name));
+        }
+
+        TraitsTable.PushBack(info);
+    }
+
+    SPtr<Instances::fl::Object> obj = vm.MakeObject();
+    v = Value(obj);
+    Objects.PushBack(v);
+
+    for (UInt32 i = 0; i < info.Count; ++i)
+    {
+        Value value;
+        if (!ReadAMF3(value))
+            return false;
+
+        obj->AddDynamicSlotValuePair(TraitsNames[info.Start + i].AsString(), value);
+    }
+
+    if (info.Dynamic)
+    {
+        ASString key = vm.GetStringManager().CreateEmptyString();
+        while (true)
+        {
+            if (!readString3(key))
+                return false;
+            if (key.IsEmpty())
+                break;
+
+            Value value;
+            if (!ReadAMF3(value))
+                return false;
+
+            obj->AddDynamicSlotValuePair(key, value);
+        }
+    }
+
+    return true;
+}
+
+CheckResult AMFReader::readArray3(Value& v)
+{
+    VM& vm = GetVM();
+    UInt32 dense;
+    bool isRef;
+    if (!readObjectHeader3(dense, v, isRef))
+        return false;
+    if (isRef)
+        return true;
+
+    SPtr<Instances::fl::Array> arr = vm.MakeArray();
+    v = Value(arr);
+    Objects.PushBack(v);
+
+    // Associative part.
+    ASString key = vm.GetStringManager().CreateEmptyString();
+    while (true)
+    {
+        if (!readString3(key))
+            return false;
+        if (key.IsEmpty())
+            break;
+
+        Value value;
+        if (!ReadAMF3(value))
+            return false;
+
+        if (!arr->SetProperty(Multiname(*pPublicNs, Value(key)), value))
+            return false;
+    }
+
+    // Dense part.
+    for (UInt32 i = 0; i < dense; ++i)
+    {
+        Value value;
+        if (!ReadAMF3(value))
+            return false;
+
+        if (i == arr->GetSize())
+            arr->PushBack(value);
+        else
+            arr->Set(i, value);
+    }
+
+    return true;
+}
+
+CheckResult AMFReader::readVector3(UInt8 marker, Value& v)
+{
+    VM& vm = GetVM();
+    UInt32 size;
+    bool isRef;
+    if (!readObjectHeader3(size, v, isRef))
+        return false;
+    if (isRef)
+        return true;
+
+    UInt8 fixed;
+    if (!readU8(fixed))
+        return false;
+
+    switch (marker)
+    {
+    case AMF::amf3VectorInt:
+    case AMF::amf3VectorUInt:
+    case AMF::amf3VectorDouble:
+        {
+            const UInt32 elemSize = (marker == AMF::amf3VectorDouble) ? 8 : 4;
+            if (!pBA->CanRead(size * elemSize))
+            {
+                pBA->ThrowEOFError();
+                return false;
+            }
+
+            const UInt8* p = pBA->Data.GetDataPtr() + pBA->Position;
+            if (marker == AMF::amf3VectorInt)
+            {
+                SPtr<Instances::fl_vec::Vector_int> vec;
+                if (!vm.ConstructBuiltinObject(vec, "Vector.<int>"))
+                    return false;
+                for (UInt32 i = 0; i < size; ++i, p += 4)
+                {
+                    SInt32 e;
+                    memcpy(&e, p, 4);
+                    vec->PushBack(Alg::ByteUtil::BEToSystem(e));
+                }
+                vec->fixedSet(fixed != 0);
+                v = Value(vec);
+            }
+            else if (marker == AMF::amf3VectorUInt)
+            {
+                SPtr<Instances::fl_vec::Vector_uint> vec;
+                if (!vm.ConstructBuiltinObject(vec, "Vector.<uint>"))
+                    return false;
+                for (UInt32 i = 0; i < size; ++i, p += 4)
+                {
+                    UInt32 e;
+                    memcpy(&e, p, 4);
+                    vec->PushBack(Alg::ByteUtil::BEToSystem(e));
+                }
+                vec->fixedSet(fixed != 0);
+                v = Value(vec);
+            }
+            else
+            {
+                SPtr<Instances::fl_vec::Vector_double> vec;
+                if (!vm.ConstructBuiltinObject(vec, "Vector.<Number>"))
+                    return false;
+                for (UInt32 i = 0; i < size; ++i, p += 8)
+                {
+                    Double e;
+                    memcpy(&e, p, 8);
+                    vec->PushBack(Alg::ByteUtil::BEToSystem(e));
+                }
+                vec->fixedSet(fixed != 0);
+                v = Value(vec);
+            }
+
+            pBA->Position += size * elemSize;
+            Objects.PushBack(v);
+        }
+        break;
+    default:
+        {
+            ASString typeName = vm.GetStringManager().CreateEmptyString();
+            if (!readString3(typeName))
+                return false;
+
+            // Unknown element types fall back to Vector.<Object>.
+            Class* vecClass = NULL;
+            if (!typeName.IsEmpty() && typeName != "*")
+            {
+                String className("Vector.<", typeName.ToCStr(), ">");
+                vecClass = vm.GetClass(StringDataPtr(className.ToCStr(), className.GetSize()), vm.GetFrameAppDomain());
+                if (vm.IsException())
+                    return false;
+            }
+            if (!vecClass)
+            {
+                vecClass = vm.GetClass(StringDataPtr("Vector.<Object>"), vm.GetFrameAppDomain());
+                if (!vecClass)
+                    return throwRangeError();
+            }
+
+            vecClass->Construct(v, 0, NULL, true);
+            if (vm.IsException() || !v.IsObject() || v.IsNull())
+                return false;
+            Objects.PushBack(v);
+
+            AS3::Object* vec = v.GetObject();
+            Value ind;
+            for (UInt32 i = 0; i < size; ++i)
+            {
+                Value value;
+                if (!ReadAMF3(value))
+                    return false;
+
+                ind.SetUInt32(i);
+                if (!vec->SetProperty(Multiname(*pPublicNs, ind), value))
+                    return false;
+            }
+
+            if (fixed)
+            {
+                const Value arg(true);
+                if (!vec->SetProperty(Multiname(*pPublicNs, Value(vm.GetStringManager().CreateConstString("fixed"))), arg))
+                    return false;
+            }
+        }
+        break;
+    }
+
+    return true;
+}
+
+CheckResult AMFReader::readDictionary3(Value& v)
+{
+    VM& vm = GetVM();
+    UInt32 count;
+    bool isRef;
+    if (!readObjectHeader3(count, v, isRef))
+        return false;
+    if (isRef)
+        return true;
+
+    UInt8 weakKeys;
+    if (!readU8(weakKeys))
+        return false;
+
+    const Value arg(weakKeys != 0);
+    if (!vm.ConstructBuiltinValue(v, "flash.utils.Dictionary", 1, &arg))
+        return false;
+    Objects.PushBack(v);
+
+    AS3::Object* dict = v.GetObject();
+    for (UInt32 i = 0; i < count; ++i)
+    {
+        Value key, value;
+        if (!ReadAMF3(key) || !ReadAMF3(value))
+            return false;
+
+        dict->AddDynamicSlotValuePair(key, value);
+    }
+
+    return true;
+}
 //##protect##"methods"
 
 // Values of default arguments.
@@ -453,8 +2185,11 @@ namespace Instances { namespace fl_utils
     void ByteArray::readObject(Value& result)
     {
 //##protect##"instance::ByteArray::readObject()"
-        SF_UNUSED1(result);
-        NOT_IMPLEMENTED("ByteArray::readObject()");
+        AMFReader reader(*this);
+        if (Encoding == encAMF0)
+            reader.ReadAMF0(result).DoNotCheck();
+        else
+            reader.ReadAMF3(result).DoNotCheck();
 //##protect##"instance::ByteArray::readObject()"
     }
     void ByteArray::readShort(SInt32& result)
@@ -685,8 +2420,13 @@ namespace Instances { namespace fl_utils
     void ByteArray::writeObject(const Value& result, const Value& object)
     {
 //##protect##"instance::ByteArray::writeObject()"
-        SF_UNUSED2(result, object);
-        NOT_IMPLEMENTED("ByteArray::writeObject()");
+        SF_UNUSED1(result);
+
+        AMFWriter writer(*this);
+        if (Encoding == encAMF0)
+            writer.WriteAMF0(object);
+        else
+            writer.WriteAMF3(object);
 //##protect##"instance::ByteArray::writeObject()"
     }
     void ByteArray::writeShort(const Value& result, SInt32 value)
@@ -65,6 +65,8 @@ namespace Classes { namespace fl_utils
 }}
 
 //##protect##"forward_declaration"
+class AMFReader;
+class AMFWriter;
 //##protect##"forward_declaration"
 
 namespace Instances { namespace fl_utils
@@ -99,6 +101,10 @@ namespace Instances { namespace fl_utils
         enum EndianType { endianBig = 0, endianLittle = 1 };
 
     protected:
+        // AMF serialization for readObject()/writeObject().
+        friend class AS3::AMFReader;
+        friend class AS3::AMFWriter;
+
         ByteArray(InstanceTraits::Traits& t, EncodingType enc);
 
         void ThrowEOFError();
@@ -86,6 +86,8 @@ namespace Instances { namespace fl_utils
     public:
         virtual ~Dictionary();
 
+        bool IsWeakKeys() const { return WeakKeys; }
+
         virtual CheckResult SetProperty(const Multiname& prop_name, const Value& value);
         virtual CheckResult GetProperty(const Multiname& prop_name, Value& value);
         virtual void GetDynamicProperty(AbsoluteIndex ind, Value& value);
@@ -98,7 +98,8 @@ public:
 public:
     bool operator ()(const DataType& a, const DataType& b) const
     {
-        return Compare(a.First, b.First) < 0;
+        const int r = Compare(a.First, b.First);
+        return r < 0 || (r == 0 && a.Second < b.Second);
     }
     bool Equal(const DataType& a, const DataType& b) const
     {
@@ -248,7 +249,9 @@ public:
     public:
         bool operator ()(const T* a, const T* b) const
         {
-            return Impl::CompareFunct(GetVM(), Func, Value(*a), Value(*b)) < 0;
+            // Elements are contiguous, so pointer order is index order.
+            const int r = Impl::CompareFunct(GetVM(), Func, Value(*a), Value(*b));
+            return r < 0 || (r == 0 && a < b);
         }
         bool Equal(const T* a, const T* b) const
         {
@@ -689,10 +692,11 @@ public:
                 ForEach(vc);
 
                 // Choose a correct sorting function.
-                Impl::CompareAsNumberInd functor((flags & Instances::fl::Array::SortFlags_Descending) != 0);
+                const bool desc = (flags & Instances::fl::Array::SortFlags_Descending) != 0;
+                Impl::CompareAsNumberInd functor(desc);
 
                 // Sort.
-                Alg::QuickSortSafe(pairs, functor);
+                Impl::RadixSortByNumber(GetVM().GetMemoryHeap(), pairs, desc, functor);
 
                 // Check for UNIQUESORT
                 if ((flags & Instances::fl::Array::SortFlags_UniqueSort) != 0)
@@ -721,11 +725,20 @@ public:
                 Value2StrCollector vc(GetVM(), pairs);
                 ForEach(vc);
 
+                // Fold case of keys once instead of in every comparison.
+                const bool use_locale = (flags & Instances::fl::Array::SortFlags_Locale) != 0;
+                bool ci = (flags & Instances::fl::Array::SortFlags_CaseInsensitive) != 0;
+                if (ci && !use_locale)
+                {
+                    Impl::FoldSortKeys(GetVM().GetMemoryHeap(), pairs);
+                    ci = false;
+                }
+
                 // Choose a correct sorting function.
                 Impl::CompareAsStringInd functor (
                     (flags & Instances::fl::Array::SortFlags_Descending) != 0,
-                    (flags & Instances::fl::Array::SortFlags_CaseInsensitive) != 0,
-                    (flags & Instances::fl::Array::SortFlags_Locale) != 0
+                    ci,
+                    use_locale
                     );
 
 
@@ -1051,7 +1064,8 @@ template<>
 inline
 bool VectorBase<Value>::CompareValuePtr::operator()(const Value* a, const Value* b) const
 {
-    return Impl::CompareFunct(GetVM(), Func, *a, *b) < 0;
+    const int r = Impl::CompareFunct(GetVM(), Func, *a, *b);
+    return r < 0 || (r == 0 && a < b);
 }
 
 template<>
@@ -455,8 +455,7 @@ public:
         const Environment *penv = avm->GetASEnvironment();
         if (pBuf && !pBuf->IsNull())
         {
-            Ptr<ActionBuffer> pbuff =
-                *SF_HEAP_NEW(penv->GetHeap()) ActionBuffer(penv->GetSC(), pBuf);
+            Ptr<ActionBuffer> pbuff = penv->GetGC()->GetActionBuffer(pBuf);
             avm->AddActionBuffer(pbuff.GetPtr());
         }
     }
@@ -467,8 +466,7 @@ public:
         if (pBuf && !pBuf->IsNull())
         {
             const Environment *penv = avm->GetASEnvironment();
-            Ptr<ActionBuffer> pbuff =
-                *SF_HEAP_NEW(penv->GetHeap()) ActionBuffer(penv->GetSC(), pBuf);
+            Ptr<ActionBuffer> pbuff = penv->GetGC()->GetActionBuffer(pBuf);
             avm->AddActionBuffer(pbuff.GetPtr(), prio);
         }
     }
@@ -503,8 +501,7 @@ public:
         {
             AvmSprite* avm = ToAvmSprite(m);
             const Environment *penv  = avm->GetASEnvironment();
-            Ptr<ActionBuffer> pbuff = 
-                *SF_HEAP_NEW(penv->GetHeap()) ActionBuffer(penv->GetSC(), pBuf);
+            Ptr<ActionBuffer> pbuff = penv->GetGC()->GetActionBuffer(pBuf);
             avm->AddActionBuffer(pbuff.GetPtr(), ActionPriority::AP_InitClip);
         }
     }
@@ -158,13 +158,18 @@ void    SF_STDCALL DoAbcLoader(LoadProcess* p, const TagInfo& tagInfo)
         name = buf;
     }
 
+    // If the file is memory mapped, reference ABC code in place and keep
+    // the file alive instead of copying it.
+    const UByte* pmapped = pin->ReadDirect(dataSize);
     void*   pbuf = 
-        SF_HEAP_ALLOC(Memory::GetGlobalHeap(), dataSize + sizeof(AbcDataBuffer) - 1, StatMD_ASBinaryData_Mem);
+        SF_HEAP_ALLOC(Memory::GetGlobalHeap(), (pmapped ? 0 : dataSize) + sizeof(AbcDataBuffer) - 1, StatMD_ASBinaryData_Mem);
     Ptr<AbcDataBuffer> pabc = *new (pbuf) AbcDataBuffer(name, flags, dataSize);
 //#ifdef SF_BUILD_DEBUG
     pabc->FileName = p->GetDataDef_Unsafe()->GetFileURL();
 //#endif
-    if (pin->ReadToBuffer(pabc->Data, pabc->DataSize) != (int)pabc->DataSize)
+    if (pmapped)
+        pabc->SetMappedData(pmapped, pin->GetDirectDataFile());
+    else if (pin->ReadToBuffer(pabc->Data, pabc->DataSize) != (int)pabc->DataSize)
     {
         pin->LogError("Can't read completely ABCData at offset %d",
                        tagInfo.TagOffset);
@@ -254,7 +259,8 @@ MemoryContext* AS3Support::CreateMemoryContext(const char* heapName,
 #ifdef GFX_AS_ENABLE_GC
     memContext->ASGC = *SF_HEAP_NEW(heap) AS3::ASRefCountCollector();
     memContext->ASGC->SetParams(memParams.FramesBetweenCollections, memParams.MaxCollectionRoots,
-        memParams.RunsToUpgradeGen, memParams.RunsToCollectYoung, memParams.RunsToCollectOld);
+        memParams.RunsToUpgradeGen, memParams.RunsToCollectYoung, memParams.RunsToCollectOld,
+        memParams.CollectionSliceTime);
 #endif
     memContext->StringMgr = *SF_HEAP_NEW(heap) ASStringManager(heap);
 
@@ -21,6 +21,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "GFx/GFx_Resource.h"
 #include "GFx/GFx_Loader.h"
 #include "GFx/AS3/AS3_StringManager.h"
+#include "GFx/AS3/AS3_OpCodeCache.h"
 
 namespace Scaleform { namespace GFx {
 
@@ -82,6 +83,14 @@ public:
         (LoadProcess* , ButtonDef* , TagType ) {}
     virtual void ReadButton2ActionConditions
         (LoadProcess* , ButtonDef* , TagType ) {}
+
+    // Cache of traced AS3 code, used by movies created after it is set;
+    // see AS3::OpCodeCache. Pass NULL to remove it.
+    void              SetOpCodeCache(AS3::OpCodeCache* cache) { pOpCodeCache = cache; }
+    AS3::OpCodeCache* GetOpCodeCache() const                  { return pOpCodeCache; }
+
+private:
+    Ptr<AS3::OpCodeCache> pOpCodeCache;
 };
 }} // namespace Scaleform::GFx
 
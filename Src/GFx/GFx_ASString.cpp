@@ -336,6 +336,12 @@ void   ASStringNode::ReleaseNode()
 {
     SF_ASSERT(RefCount == 0);
 
+    if (HashFlags & ASString::Flag_ConcatNode)
+    {
+        pManager->ReleaseConcatNode(this);
+        return;
+    }
+
     // If we had a lowercase version, release its ref count.
     if ((pLower != this) && pLower)
         pLower->Release();
@@ -358,6 +364,9 @@ ASStringManager::ASStringManager(MemoryHeap* pheap)
     pFreeTextBuffers = 0;
     pTextBufferPages = 0;
 
+    pConcatReleaseList   = 0;
+    ReleasingConcatNodes = false;
+
     // Empty data - refcount 1, so never released.
     EmptyStringNode.RefCount    = 1;
     EmptyStringNode.Size        = 0;
@@ -398,8 +407,11 @@ ASStringManager::~ASStringManager()
             {   
                 if (ileaks < 16)
                 {
+                    // Concatenation nodes that weren't flattened have no text.
+                    bool concat = (ppage->Nodes[i].HashFlags & ASString::Flag_ConcatNode) &&
+                                  !ppage->Nodes[i].pLower;
                     leakReport += (ileaks > 0) ? ", '" : "'";
-                    leakReport += ppage->Nodes[i].pData;
+                    leakReport += concat ? "<concatenation>" : ppage->Nodes[i].pData;
                     leakReport += "'";
                 }
                 ileaks++;
@@ -733,6 +745,162 @@ ASStringNode*  ASStringManager::CreateStringNode(const char* pstr1, UPInt l1,
     return &EmptyStringNode;
 }
 
+
+// *** Concatenation nodes
+
+ASStringNode*  ASStringManager::CreateConcatNode(ASStringNode* pleft, ASStringNode* pright)
+{
+    if (pleft->Size == 0)
+        return pright;
+    if (pright->Size == 0)
+        return pleft;
+
+    UPInt length = (UPInt)pleft->Size + pright->Size;
+    if (length < ConcatNode_MinSize)
+    {
+        // Concatenation nodes are never this short, so both sides have text.
+        ASStringNode* pnode = CreateStringNode(pleft->pData, pleft->Size,
+                                               pright->pData, pright->Size);
+        if (pleft->HashFlags & pright->HashFlags & ASString::Flag_LengthIsSize)
+            // Inherit Flag_LengthIsSize.
+            pnode->HashFlags |= ASString::Flag_LengthIsSize;
+        return pnode;
+    }
+
+    // Refer to the interned nodes of flattened children directly, so that
+    // their forwarding nodes can go away.
+    if ((pleft->HashFlags & ASString::Flag_ConcatNode) && pleft->pLower)
+        pleft = pleft->pLower;
+    if ((pright->HashFlags & ASString::Flag_ConcatNode) && pright->pLower)
+        pright = pright->pLower;
+
+    ConcatNodes* pchildren = (ConcatNodes*)AllocTextBuffer(sizeof(ConcatNodes) - 1);
+    if (!pchildren)
+        return &EmptyStringNode;
+
+    ASStringNode* pnode = AllocStringNode();
+    if (!pnode)
+    {
+        FreeTextBuffer((char*)pchildren, sizeof(ConcatNodes) - 1);
+        return &EmptyStringNode;
+    }
+
+    pchildren->pLeft  = pleft;
+    pchildren->pRight = pright;
+    pleft->AddRef();
+    pright->AddRef();
+
+    pnode->RefCount = 0;
+    pnode->Size     = (unsigned)length;
+    pnode->pData    = (const char*)pchildren;
+    pnode->HashFlags= ASString::Flag_ConcatNode | ASString::Flag_ConstData;
+    pnode->pLower   = 0;
+    return pnode;
+}
+
+ASStringNode*  ASStringManager::FlattenConcatNode(ASStringNode* pnode)
+{
+    SF_ASSERT((pnode->HashFlags & ASString::Flag_ConcatNode) && !pnode->pLower);
+
+    UPInt length  = pnode->Size;
+    char* pbuffer = AllocTextBuffer(length);
+    if (!pbuffer)
+        return &EmptyStringNode;
+
+    // Copy the text of the leaves from right to left. The tree is walked
+    // with an explicit stack, since strings built in a loop are nested
+    // once per iteration.
+    ArrayDH_POD<ASStringNode*, StatMV_ASString_Mem> stack(pHeap);
+    ASStringNode* pcur = pnode;
+    UPInt         end  = length;
+    for (;;)
+    {
+        if ((pcur->HashFlags & ASString::Flag_ConcatNode) && !pcur->pLower)
+        {
+            ConcatNodes* pchildren = (ConcatNodes*)pcur->pData;
+            stack.PushBack(pchildren->pLeft);
+            pcur = pchildren->pRight;
+            continue;
+        }
+        end -= pcur->Size;
+        memcpy(pbuffer + end, pcur->pData, pcur->Size);
+        if (stack.GetSize() == 0)
+            break;
+        pcur = stack.Pop();
+    }
+    SF_ASSERT(end == 0);
+    pbuffer[length] = 0;
+
+    ConcatNodes*  pchildren = (ConcatNodes*)pnode->pData;
+    ASStringNode* pleft     = pchildren->pLeft;
+    ASStringNode* pright    = pchildren->pRight;
+    FreeTextBuffer((char*)pchildren, sizeof(ConcatNodes) - 1);
+
+    ASStringNode* pflat;
+    ASStringKey   key(pbuffer, ASString::HashFunction(pbuffer, length), length);
+
+    if (StringSet.GetAlt(key, &pflat))
+    {
+        // The text is already interned, so this node just forwards to
+        // that node until released.
+        FreeTextBuffer(pbuffer, length);
+        pflat->AddRef();
+        pnode->pData  = pflat->pData;
+        pnode->pLower = pflat;
+    }
+    else
+    {
+        // Intern this node itself; it becomes a regular node.
+        pnode->pData     = pbuffer;
+        pnode->HashFlags = (UInt32)key.HashValue;
+        pnode->pLower    = 0;
+        StringSet.Add(pnode);
+        pflat = pnode;
+    }
+
+    pleft->Release();
+    pright->Release();
+    return pflat;
+}
+
+void  ASStringManager::ReleaseConcatNode(ASStringNode* pnode)
+{
+    SF_ASSERT(pnode->RefCount == 0);
+
+    if (pnode->pLower)
+    {
+        // Flattened, only forwards to the interned node.
+        pnode->pLower->Release();
+        FreeStringNode(pnode);
+        return;
+    }
+
+    // Releasing children can release nested concatenation nodes; these are
+    // queued and handled by the outermost call rather than recursively,
+    // since strings built in a loop are nested once per iteration.
+    pnode->pNextAlloc  = pConcatReleaseList;
+    pConcatReleaseList = pnode;
+    if (ReleasingConcatNodes)
+        return;
+
+    ReleasingConcatNodes = true;
+    while (pConcatReleaseList)
+    {
+        ASStringNode* pconcat = pConcatReleaseList;
+        pConcatReleaseList = pconcat->pNextAlloc;
+
+        ConcatNodes*  pchildren = (ConcatNodes*)pconcat->pData;
+        ASStringNode* pleft     = pchildren->pLeft;
+        ASStringNode* pright    = pchildren->pRight;
+        FreeTextBuffer((char*)pchildren, sizeof(ConcatNodes) - 1);
+        FreeStringNode(pconcat);
+
+        pleft->Release();
+        pright->Release();
+    }
+    ReleasingConcatNodes = false;
+}
+
 // Shared-code Helpers to be used by ASStringBuiltinManager
 void  ASStringManager::InitBuiltinArray(ASStringNodeHolder* nodes, const char** strings,
                                         unsigned count)
@@ -47,6 +47,8 @@ struct  ASStringNode;
 class   LogState;
 
 // String node - stored in the manager table.
+// Nodes created by ASStringManager::CreateConcatNode are not interned and
+// don't have their text until flattened, see GetFlatNode.
 
 struct ASStringNode
 {        
@@ -97,6 +99,10 @@ struct ASStringNode
     }
 
     bool    IsNull() const;
+
+    // Returns the interned node with the text of a concatenation node,
+    // flattening it on first use; returns this for other nodes.
+    inline ASStringNode* GetFlatNode();
 };
 
 
@@ -131,7 +137,7 @@ class ASConstString : protected ASStringNodeHolder
 {
 public:
     explicit ASConstString(ASStringNode *pnode)
-    : ASStringNodeHolder(pnode)
+    : ASStringNodeHolder(pnode->GetFlatNode())
     {
         SF_ASSERT(pNode);
         SF_ASSERT(pNode->pData);
@@ -164,7 +170,13 @@ public:
         // Flag_IsNotPath is set if we have determined that this string is not to be a path.
         // If a check was not made yet, Flag_IsNotPath is always cleared.
         Flag_PathCheck      = 0x04000000,
-        Flag_IsNotPath      = 0x02000000
+        Flag_IsNotPath      = 0x02000000,
+
+        // Node created by ASStringManager::CreateConcatNode. Until flattened,
+        // pData points to its two children and the node is not in StringSet;
+        // once flattened, pLower points to the interned node with its text.
+        // Such nodes are never held by an ASString.
+        Flag_ConcatNode     = 0x01000000
     };
 
 public:
@@ -520,6 +532,7 @@ public:
     SF_INLINE void    AssignNode(ASStringNode *pnode)
     {
         SF_ASSERT(pnode);
+        pnode = pnode->GetFlatNode();
         SF_ASSERT(pnode->pData);
         pnode->AddRef();
         pNode->Release();
@@ -673,6 +686,13 @@ class ASStringManager : public RefCountBase<ASStringManager, StatMV_ASString_Mem
     ASStringNodeHash StringSet;
     MemoryHeap*      pHeap;
 
+    // Children of a concatenation node, stored in place of its text.
+    struct ConcatNodes
+    {
+        ASStringNode*   pLeft;
+        ASStringNode*   pRight;
+    };
+
 
     // Allocation Page structures, used to avoid many small allocations.
     struct StringNodePage
@@ -724,6 +744,11 @@ class ASStringManager : public RefCountBase<ASStringManager, StatMV_ASString_Mem
 
     ASStringNode    NullStringNode;
 
+    // Concatenation nodes waiting for their children to be released,
+    // linked through pNextAlloc.
+    ASStringNode*   pConcatReleaseList;
+    bool            ReleasingConcatNodes;
+
     // Log object used for reporting AS leaks.
     Ptr<LogState>   pLog;
     StringLH        FileName;
@@ -762,7 +787,13 @@ class ASStringManager : public RefCountBase<ASStringManager, StatMV_ASString_Mem
     char*           AllocTextBuffer(const char* pbuffer, UPInt length);
     void            FreeTextBuffer(char* pbuffer, UPInt length);
 
+    // Concatenation node support, see CreateConcatNode.
+    ASStringNode*   FlattenConcatNode(ASStringNode* pnode);
+    void            ReleaseConcatNode(ASStringNode* pnode);
+
 public:
+    // Concatenations shorter than this are copied and interned right away.
+    enum { ConcatNode_MinSize = 64 };
 
     ASStringManager(MemoryHeap* pheap);
     ~ASStringManager();
@@ -821,6 +852,15 @@ public:
     // Wide character; use special type of counting.
     ASStringNode*  CreateStringNode(const wchar_t* pwstr, SPInt len = -1);  
 
+    // Concatenates two strings lazily, for script string addition. Unless the
+    // result is short, it is a concatenation node referencing both arguments
+    // that is neither copied nor interned until its text is needed, which
+    // happens when it is wrapped in an ASString or GetFlatNode is called.
+    // This keeps strings built by appending in a loop linear in time.
+    // The node can be kept in script values, but any code accessing the
+    // node fields directly must go through GetFlatNode.
+    ASStringNode*  CreateConcatNode(ASStringNode* pleft, ASStringNode* pright);
+
     ASStringNode* GetEmptyStringNode() { return &EmptyStringNode;  }
 
     ASStringNode* GetNullStringNode() { return &NullStringNode;  }
@@ -837,6 +877,14 @@ bool ASStringNode::IsNull() const
     return this == pManager->GetNullStringNode();
 }
 
+inline
+ASStringNode* ASStringNode::GetFlatNode()
+{
+    if (!(HashFlags & ASConstString::Flag_ConcatNode))
+        return this;
+    return pLower ? pLower : pManager->FlattenConcatNode(this);
+}
+
 inline
 bool ASConstString::IsNull() const
 {
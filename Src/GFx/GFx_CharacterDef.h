@@ -50,6 +50,7 @@ class SoundStreamDef;
 class DisplayObjectBase;
 class InteractiveObject;
 class TimelineDef;
+class TimelineKeyframes;
 
 // "newable" Scale9Grid rectangle.
 struct Scale9Grid : public NewOverrideBase<StatMD_CharDefs_Mem>
@@ -194,6 +195,10 @@ public:
     // fills array of labels for the passed frame. One frame may have multiple labels.
     virtual Array<String>*      GetFrameLabels(unsigned frameNumber, Array<String>* destArr) const =0;
 
+    // Returns keyframe snapshots used by backward gotoFrame, or NULL if the
+    // timeline doesn't keep them.
+    virtual TimelineKeyframes*  GetKeyframes() const                                    { return NULL; }
+
 #ifdef GFX_ENABLE_SOUND
     virtual SoundStreamDef*     GetSoundStream() const                                  = 0;
     virtual void                SetSoundStream(SoundStreamDef*)                      = 0;
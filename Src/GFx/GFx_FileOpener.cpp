@@ -17,6 +17,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 
 #include "GFx/GFx_Loader.h"
 #include "Kernel/SF_SysFile.h"
+#include "Kernel/SF_MappedFile.h"
 #include "GFx/GFx_Log.h"
 
 namespace Scaleform { namespace GFx {
@@ -26,6 +27,13 @@ namespace Scaleform { namespace GFx {
 // Default implementation - use SysFile.
 File* FileOpener::OpenFile(const char *purl, int flags, int modes)
 {
+    if (MapFiles && !(flags & FileConstants::Open_Write))
+    {
+        MappedFile* pfile = new MappedFile(purl);
+        if (pfile->IsValid())
+            return pfile;
+        pfile->Release();
+    }
     // Buffered file wrapper is faster to use because it optimizes seeks.
     return new SysFile(purl, flags, modes);
 }
@@ -63,6 +63,7 @@ LoadStates::LoadStates(LoaderImpl* pimpl, StateBag* pstates,
     // Record render config so that it can be used for image creation during loading.
     pImageFileHandlerRegistry = pstates->GetImageFileHandlerRegistry();
     pZlibSupport        = pstates->GetZlibSupport();
+    pLzmaSupport        = pstates->GetLzmaSupport();
 #ifdef GFX_AS2_SUPPORT
     pAS2Support         = pstates->GetAS2Support();
 #endif
@@ -162,6 +163,7 @@ LoadStates*  LoadStates::CloneForImport() const
         pnewStates->pWeakResourceLib    = pWeakResourceLib;
         pnewStates->pImageFileHandlerRegistry = pImageFileHandlerRegistry;
         pnewStates->pZlibSupport        = pZlibSupport;
+        pnewStates->pLzmaSupport        = pLzmaSupport;
         pnewStates->pAS2Support         = pAS2Support;
         pnewStates->pAS3Support         = pAS3Support;
 #ifdef GFX_ENABLE_SOUND
@@ -292,7 +294,8 @@ bool    LoadProcess::BeginSWFLoading(File *pfile)
 #endif
     // Read header while logging messages as appropriate, fail on wrong file format.
     if (!ProcessInfo.Initialize(pfile, GetLogState(),
-                                pLoadStates->GetZlibSupport(), pLoadStates->pParseControl, true))
+                                pLoadStates->GetZlibSupport(), pLoadStates->GetLzmaSupport(),
+                                pLoadStates->pParseControl, true))
         return false;
     pLoadData->SetFileAttributes(ProcessInfo.FileAttributes);
     pLoadData->BeginSWFLoading(ProcessInfo.Header);
@@ -186,10 +186,11 @@ Loader::Loader(const Loader::LoaderConfig& config)
 }
 
 Loader::Loader(const Ptr<FileOpenerBase>& pfileOpener, 
-                     const Ptr<ZlibSupportBase>& pzlib
+                     const Ptr<ZlibSupportBase>& pzlib,
+                     const Ptr<LzmaSupportBase>& plzma
                      )
 {
-    LoaderConfig config(0, pfileOpener, pzlib/*, pjpeg*/);
+    LoaderConfig config(0, pfileOpener, pzlib, plzma);
     InitLoader(config);
 }
 
@@ -233,6 +234,7 @@ void Loader::InitLoader(const LoaderConfig& cfg)
         SetFileOpener(cfg.pFileOpener);
         SetParseControl(Ptr<ParseControl>(*SF_NEW ParseControl(ParseControl::VerboseParseNone)));
         SetZlibSupport(cfg.pZLibSupport);
+        SetLzmaSupport(cfg.pLzmaSupport);
     }    
 
 #ifdef SF_AMP_SERVER
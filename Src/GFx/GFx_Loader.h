@@ -92,6 +92,7 @@ class   TaskManager;
 class   FontLib;
 class   IMEManagerBase;
 class   ZlibSupportBase;
+class   LzmaSupportBase;
 class   FontCompactorParams;
 class   SharedObjectManagerBase;
 
@@ -175,6 +176,7 @@ public:
         State_IMEManager,
         State_XMLSupport,
         State_ZlibSupport,
+        State_LzmaSupport,
         State_FontCompactorParams,
         State_ImagePackerParams,
         State_Audio,
@@ -350,6 +352,8 @@ class ActionControl : public State
 {
 protected:
     unsigned        ActionFlags;
+    unsigned        PreTraceTime;
+    unsigned        TimelineKeyframeMemory;
 
 public:
 
@@ -364,8 +368,11 @@ public:
         Action_LongFilenames        = 0x10  //Display full path
     };
 
+    enum { DefaultTimelineKeyframeMemory = 64 * 1024 };
+
     ActionControl(unsigned actionFlags = Action_LogChildFilenames)
-        : State(State_ActionControl),  ActionFlags(actionFlags)
+        : State(State_ActionControl),  ActionFlags(actionFlags), PreTraceTime(0),
+          TimelineKeyframeMemory(DefaultTimelineKeyframeMemory)
     { }       
     
     inline void     SetActionFlags(unsigned actionFlags)   { ActionFlags = actionFlags; }
@@ -405,6 +412,20 @@ public:
         ActionFlags = (ActionFlags & ~(Action_LongFilenames)) | (longFilenames ? Action_LongFilenames : 0);
     } 
 
+    // ActionScript 3 only. Traces the methods of classes ahead of their
+    // first call, spending at most preTraceTime microseconds at the end of
+    // each frame, so that opening a screen doesn't have to trace all of its
+    // code at once. 0 (default) disables it. Read when the movie is created.
+    inline void     SetPreTraceTime(unsigned preTraceTime) { PreTraceTime = preTraceTime; }
+    inline unsigned GetPreTraceTime() const                { return PreTraceTime; }
+
+    // Memory limit, in bytes, of the keyframe snapshots each movie clip 
+    // timeline keeps to speed up backward gotoAndPlay/gotoAndStop. Keyframes
+    // belong to the movie definition and are shared by the instances of the
+    // clip. 0 disables them; by default, DefaultTimelineKeyframeMemory.
+    inline void     SetTimelineKeyframeMemory(unsigned size) { TimelineKeyframeMemory = size; }
+    inline unsigned GetTimelineKeyframeMemory() const      { return TimelineKeyframeMemory; }
+
 };
 
 
@@ -503,6 +524,15 @@ class FileOpener : public FileOpenerBase
 {
 public:
 
+    // If mapFiles is true, files opened for reading only are memory mapped
+    // with MappedFile, falling back to SysFile if that fails. Uncompressed
+    // movies are then parsed directly out of the mapped pages, which are
+    // shared between processes loading the same file.
+    FileOpener(bool mapFiles = false) : MapFiles(mapFiles) { }
+
+    void            SetMapFiles(bool mapFiles)  { MapFiles = mapFiles; }
+    bool            GetMapFiles() const         { return MapFiles; }
+
     // Override to opens a file using user-defined function and/or File class.
     // The default implementation uses buffer-wrapped SysFile, but only
     // if SF_ENABLE_SYSFILE is defined.
@@ -523,6 +553,9 @@ public:
     virtual File* OpenFileEx(const char* purl, Log *plog, 
         int flags = FileConstants::Open_Read|FileConstants::Open_Buffered, 
         int mode = FileConstants::Mode_ReadWrite);
+
+private:
+    bool            MapFiles;
 };
 
 
@@ -1102,6 +1135,33 @@ public:
     virtual void    InflateWrapper(Stream* pinStream, void* buffer, int BufferBytes);
 };
 
+// ***** LzmaSupportBase
+// The purpose of this interface is to provide LZMA decompresser to the loader,
+// used to read LZMA compressed SWF (ZWS) and GFX (ZFX) files.
+
+class LzmaSupportBase : public State
+{
+public:
+    LzmaSupportBase() : State(State_LzmaSupport) {}
+
+    // Creates a file decompressing the LZMA stream that starts, with its
+    // properties header, at the current position of 'in'. unpackedSize is
+    // the size of decompressed data, or 0 if it is terminated by an end marker.
+    virtual File*   CreateLzmaFile(File* in, UInt32 unpackedSize) = 0;
+};
+
+// ***** LzmaSupport
+// Default implementation of LzmaSupportBase interface
+// The instance of this class is set on the loader contractor
+// If the application does not need LZMA support the loader constructor
+// should be called with the LzmaSupport parameter set to NULL
+
+class LzmaSupport : public LzmaSupportBase
+{
+public:
+    virtual File*   CreateLzmaFile(File* in, UInt32 unpackedSize);
+};
+
 // ***** ASSupport
 // Interface for ActionScript support
 class ASSupport : public State
@@ -1326,6 +1386,9 @@ public:
     inline void                 SetZlibSupport(ZlibSupportBase *ptr) { SetState(State::State_ZlibSupport, ptr); }
     inline Ptr<ZlibSupportBase> GetZlibSupport() const              { return *(ZlibSupportBase*) GetStateAddRef(State::State_ZlibSupport); }
 
+    inline void                 SetLzmaSupport(LzmaSupportBase *ptr) { SetState(State::State_LzmaSupport, ptr); }
+    inline Ptr<LzmaSupportBase> GetLzmaSupport() const              { return *(LzmaSupportBase*) GetStateAddRef(State::State_LzmaSupport); }
+
     inline void                 SetFontCompactorParams(FontCompactorParams *ptr) { SetState(State::State_FontCompactorParams, ptr); }
     inline Ptr<FontCompactorParams> GetFontCompactorParams() const  { return *(FontCompactorParams*) GetStateAddRef(State::State_FontCompactorParams); }
 
@@ -1487,6 +1550,11 @@ public:
 #else
     #define GFX_LOADER_NEW_ZLIBSUPPORT ((ZlibSupport*)0)
 #endif
+#ifdef SF_ENABLE_LZMA
+    #define GFX_LOADER_NEW_LZMASUPPORT *new LzmaSupport
+#else
+    #define GFX_LOADER_NEW_LZMASUPPORT ((LzmaSupport*)0)
+#endif
 
     // A structure wrapping together different loader parameters into one,
     // including default loading flags and optional link-dependent states.
@@ -1497,17 +1565,19 @@ public:
         unsigned                 DefLoadFlags;
         Ptr<FileOpenerBase>  pFileOpener;
         Ptr<ZlibSupportBase> pZLibSupport;
+        Ptr<LzmaSupportBase> pLzmaSupport;
         
         LoaderConfig(unsigned loadFlags = 0,
                      const Ptr<FileOpenerBase>& pfileOpener = *new FileOpener,
-                     const Ptr<ZlibSupportBase>& pzlib = GFX_LOADER_NEW_ZLIBSUPPORT
+                     const Ptr<ZlibSupportBase>& pzlib = GFX_LOADER_NEW_ZLIBSUPPORT,
+                     const Ptr<LzmaSupportBase>& plzma = GFX_LOADER_NEW_LZMASUPPORT
                      )
             : DefLoadFlags(loadFlags), 
-              pFileOpener(pfileOpener), pZLibSupport(pzlib)
+              pFileOpener(pfileOpener), pZLibSupport(pzlib), pLzmaSupport(plzma)
         { }
         LoaderConfig(const LoaderConfig& src)
             : DefLoadFlags(src.DefLoadFlags), pFileOpener(src.pFileOpener),
-            pZLibSupport(src.pZLibSupport)
+            pZLibSupport(src.pZLibSupport), pLzmaSupport(src.pLzmaSupport)
         { }
     };
 
@@ -1518,7 +1588,8 @@ public:
     Loader(const LoaderConfig& config);
 
     Loader(const Ptr<FileOpenerBase>& pfileOpener = *new FileOpener,
-              const Ptr<ZlibSupportBase>& zlib = GFX_LOADER_NEW_ZLIBSUPPORT
+              const Ptr<ZlibSupportBase>& zlib = GFX_LOADER_NEW_ZLIBSUPPORT,
+              const Ptr<LzmaSupportBase>& lzma = GFX_LOADER_NEW_LZMASUPPORT
               );
 
     // Create a new loader, copying it's library and states.
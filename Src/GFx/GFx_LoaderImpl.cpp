@@ -133,10 +133,12 @@ void    ExporterInfoImpl::ReadExporterInfoTag(Stream *pin, TagType tagType)
 // Processes and reads in a SWF file header and opens the Stream
 // If 0 is returned, there was an error and error message is already displayed
 bool    SWFProcessInfo::Initialize(File *pin, LogState *plog, ZlibSupportBase* zlib,
-                                   ParseControl* pparseControl, bool parseMsg)
+                                   LzmaSupportBase* lzma, ParseControl* pparseControl,
+                                   bool parseMsg)
 {
     UInt32  header;
     bool    compressed;
+    bool    lzmaCompressed;
 
     FileStartPos        = pin->Tell();
     header              = pin->ReadUInt32();
@@ -146,13 +148,16 @@ bool    SWFProcessInfo::Initialize(File *pin, LogState *plog, ZlibSupportBase* z
     Header.Version      = (header >> 24) & 255;
     Header.SWFFlags     = 0;
     compressed          = (header & 255) == 'C';
+    lzmaCompressed      = (header & 255) == 'Z';
     FileAttributes      = 0;
 
     // Verify header
     if ( ((header & 0x0FFFFFF) != 0x00535746) && // FWS
         ((header & 0x0FFFFFF) != 0x00535743) && // CWS
+        ((header & 0x0FFFFFF) != 0x0053575A) && // ZWS
         ((header & 0x0FFFFFF) != 0x00584647) && // GFX
-        ((header & 0x0FFFFFF) != 0x00584643) )  // CFX
+        ((header & 0x0FFFFFF) != 0x00584643) && // CFX
+        ((header & 0x0FFFFFF) != 0x0058465A) )  // ZFX
     {
         // ERROR
         if (plog)
@@ -161,7 +166,7 @@ bool    SWFProcessInfo::Initialize(File *pin, LogState *plog, ZlibSupportBase* z
     }
     if (((header >> 16) & 0xFF) == 'X')
         Header.SWFFlags |= MovieInfo::SWF_Stripped;
-    if (compressed)
+    if (compressed || lzmaCompressed)
         Header.SWFFlags |= MovieInfo::SWF_Compressed;
 
     // Parse messages will not be generated if they are disabled by ParseControl.
@@ -201,6 +206,45 @@ bool    SWFProcessInfo::Initialize(File *pin, LogState *plog, ZlibSupportBase* z
         FileEndPos = Header.FileLength - 8;
 #endif
     }
+    else if (lzmaCompressed)
+    {
+#ifndef SF_ENABLE_LZMA
+        SF_UNUSED(lzma);
+        if (plog)
+            plog->LogError("Loader - unable to read LZMA compressed SWF data; SF_ENABLE_LZMA not defined");
+        return 0;
+#else
+        if (!lzma)
+        {
+            if (plog)
+                plog->LogError("Loader - unable to read LZMA compressed SWF data; LzmaSupport is not set.");
+            return 0;
+        }
+        if (parseMsg)
+            plog->LogMessageByType(Log_Parse, "SWF file is LZMA compressed.\n");
+
+        // The 8-byte header is followed by the size of compressed data, which
+        // we do not need since decompressed size is known, and then by the
+        // LZMA properties and stream.
+        pfileIn->ReadUInt32();
+        if (Header.FileLength < 8)
+        {
+            if (plog)
+                plog->LogError("Loader read failed - invalid LZMA compressed SWF file length");
+            return 0;
+        }
+
+        // Uncompress the input as we read it.
+        pfileIn = *lzma->CreateLzmaFile(pfileIn, Header.FileLength - 8);
+        if (!pfileIn || !pfileIn->IsValid() || pfileIn->GetErrorCode())
+        {
+            if (plog)
+                plog->LogError("Loader read failed - invalid LZMA stream header");
+            return 0;
+        }
+        FileEndPos = Header.FileLength - 8;
+#endif
+    }
 
     // Initialize stream, this AddRefs to file
     Stream.Initialize(pfileIn, plog->GetLog(), pparseControl);
@@ -432,7 +476,8 @@ bool    LoaderImpl::GetMovieInfo(const char *pfilename, MovieInfo *pinfo,
 
         // Open and real file header, failing if it doesn't match.
         SWFProcessInfo pi(Memory::GetGlobalHeap());
-        if (!pi.Initialize(pin, pls->GetLogState(), pls->GetZlibSupport(), pls->pParseControl))
+        if (!pi.Initialize(pin, pls->GetLogState(), pls->GetZlibSupport(),
+                           pls->GetLzmaSupport(), pls->pParseControl))
             return 0;
 
         // Store header data.
@@ -1460,6 +1505,7 @@ Loader::FileFormatType LoaderImpl::DetectFileFormat(File *pfile)
     {
     case 0x43:
     case 0x46:    
+    case 0x5A:
         if ((buffer[1] == 0x57) && (buffer[2] == 0x53))
             format = Loader::File_SWF;
         else if ((buffer[1] == 0x46) && (buffer[2] == 0x58))
@@ -159,7 +159,8 @@ struct SWFProcessInfo
     // 'parseMsg' flag specifies whether parse log messages are to be generated.
     // If 0 is returned, there was an error and error message is already displayed
     bool    Initialize(File *pfile, LogState *plog, ZlibSupportBase* zlib,
-                       ParseControl* pparseControl, bool parseMsg = 0);
+                       LzmaSupportBase* lzma, ParseControl* pparseControl,
+                       bool parseMsg = 0);
 
     void    ShutDown() { Stream.ShutDown(); }
 };
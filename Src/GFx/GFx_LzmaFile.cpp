@@ -0,0 +1,791 @@
+/**************************************************************************
+
+Filename    :   GFx_LzmaFile.cpp
+Content     :   LZMA wrapped file input and LzmaSupport state
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+///////////// WARNING ///////////////////////////////////////////////
+// LzmaSupport::CreateLzmaFile is the only reference to LzmaFile, so the
+// decoder is not linked into the application unless LzmaSupport state
+// is created and set on the loader.
+
+#include "GFx/GFx_LzmaFile.h"
+#include "GFx/GFx_Loader.h"
+#include "Kernel/SF_HeapNew.h"
+#include "Kernel/SF_Debug.h"
+
+#ifdef SF_ENABLE_LZMA
+
+namespace Scaleform { namespace GFx {
+
+// ***** LZMA decoder
+
+// Internal class holding the decoder state and the dictionary window.
+// The decoder follows the LZMA specification; it decodes whole symbols,
+// pulling compressed bytes from the source file as needed, into a circular
+// dictionary window that the file data is then copied from.
+class LzmaFileImpl : public NewOverrideBase<Stat_Default_Mem>
+{
+public:
+    enum LzmaConstants
+    {
+        Lzma_BuffSize           = 4096,
+        Lzma_PropsSize          = 5,
+        Lzma_MinDictSize        = 1 << 12,
+        Lzma_MaxMatchLen        = 273,
+
+        NumBitModelTotalBits    = 11,
+        BitModelTotal           = 1 << NumBitModelTotalBits,
+        NumMoveBits             = 5,
+        TopValue                = 1 << 24,
+
+        NumStates               = 12,
+        NumPosBitsMax           = 4,
+        NumLenToPosStates       = 4,
+        NumAlignBits            = 4,
+        EndPosModelIndex        = 14,
+        NumFullDistances        = 1 << (EndPosModelIndex >> 1),
+        MatchMinLen             = 2
+    };
+
+    typedef UInt16 Prob;
+
+    struct LenDecoder
+    {
+        Prob    Choice;
+        Prob    Choice2;
+        Prob    Low[1 << NumPosBitsMax][1 << 3];
+        Prob    Mid[1 << NumPosBitsMax][1 << 3];
+        Prob    High[1 << 8];
+    };
+
+    Ptr<File>   pIn;
+    int         InitialStreamPos;   // position of the input stream where LZMA properties start.
+    UInt32      UnpackedSize;       // 0 if the stream is terminated by an end marker.
+    bool        AtEofFlag;
+    int         ErrorCode;
+
+    // Stream properties.
+    unsigned    Lc, Lp, Pb;
+    UInt32      DictSize;
+
+    // Dictionary window; holds the last DictCapacity bytes decoded.
+    UByte*      pDict;
+    UInt32      DictCapacity;
+    UInt32      DictPos;            // Write position in pDict.
+    UInt32      LogicalStreamPos;   // Number of bytes decoded.
+    UInt32      UserPos;            // User position in file, can be < then LogicalStreamPos.
+
+    // Range decoder.
+    UInt32      Range;
+    UInt32      Code;
+    bool        InputError;
+    int         DataPos;
+    int         DataSize;
+
+    // Decoder state and probability models.
+    unsigned    DState;
+    UInt32      Rep0, Rep1, Rep2, Rep3;
+    Prob*       pLitProbs;
+    Prob        IsMatch[NumStates << NumPosBitsMax];
+    Prob        IsRep[NumStates];
+    Prob        IsRepG0[NumStates];
+    Prob        IsRepG1[NumStates];
+    Prob        IsRepG2[NumStates];
+    Prob        IsRep0Long[NumStates << NumPosBitsMax];
+    Prob        PosSlot[NumLenToPosStates][1 << 6];
+    Prob        PosDecoders[1 + NumFullDistances - EndPosModelIndex];
+    Prob        Align[1 << NumAlignBits];
+    LenDecoder  LenDec;
+    LenDecoder  RepLenDec;
+
+    // Data buffer used for compressed input.
+    UByte       DataBuffer[Lzma_BuffSize];
+
+
+    // Constructor.
+    LzmaFileImpl(File* pin, UInt32 unpackedSize)
+    {
+        pIn                 = pin;
+        InitialStreamPos    = pIn->Tell();
+        UnpackedSize        = unpackedSize;
+        pDict               = 0;
+        DictCapacity        = 0;
+        pLitProbs           = 0;
+        Lc = Lp = Pb        = 0;
+        DictSize            = 0;
+        Reset();
+    }
+
+    ~LzmaFileImpl()
+    {
+        if (pDict)
+            SF_FREE(pDict);
+        if (pLitProbs)
+            SF_FREE(pLitProbs);
+    }
+
+    // Discard current results and rewind to the beginning.
+    // Necessary in order to seek backwards.
+    void    Reset()
+    {
+        ErrorCode           = 0;
+        AtEofFlag           = 0;
+        InputError          = 0;
+        DataPos = DataSize  = 0;
+        LogicalStreamPos    = 0;
+        UserPos             = 0;
+        DictPos             = 0;
+
+        // Rewind the underlying stream.
+        pIn->Seek(InitialStreamPos);
+
+        UByte props[Lzma_PropsSize];
+        for (unsigned i = 0; i < Lzma_PropsSize; i++)
+            props[i] = readInputByte();
+
+        unsigned d = props[0];
+        if (InputError || d >= (9 * 5 * 5))
+        {
+            ErrorCode = 1;
+            return;
+        }
+        Lc = d % 9;
+        d /= 9;
+        Lp = d % 5;
+        Pb = d / 5;
+        DictSize = props[1] | ((UInt32)props[2] << 8) | ((UInt32)props[3] << 16) | ((UInt32)props[4] << 24);
+
+        // The window does not need to be larger than the decompressed data.
+        UInt32 capacity = DictSize;
+        if (UnpackedSize && UnpackedSize < capacity)
+            capacity = UnpackedSize;
+        if (capacity < Lzma_MinDictSize)
+            capacity = Lzma_MinDictSize;
+
+        if (!pDict || capacity != DictCapacity)
+        {
+            if (pDict)
+                SF_FREE(pDict);
+            if (pLitProbs)
+                SF_FREE(pLitProbs);
+            DictCapacity = capacity;
+            pDict        = (UByte*)SF_HEAP_AUTO_ALLOC(this, DictCapacity);
+            pLitProbs    = (Prob*)SF_HEAP_AUTO_ALLOC(this, (0x300 << (Lc + Lp)) * sizeof(Prob));
+            if (!pDict || !pLitProbs)
+            {
+                ErrorCode = 1;
+                return;
+            }
+        }
+
+        // Initialize probability models.
+        initProbs(pLitProbs, 0x300 << (Lc + Lp));
+        initProbs(IsMatch, sizeof(IsMatch) / sizeof(Prob));
+        initProbs(IsRep, NumStates);
+        initProbs(IsRepG0, NumStates);
+        initProbs(IsRepG1, NumStates);
+        initProbs(IsRepG2, NumStates);
+        initProbs(IsRep0Long, sizeof(IsRep0Long) / sizeof(Prob));
+        initProbs(&PosSlot[0][0], sizeof(PosSlot) / sizeof(Prob));
+        initProbs(PosDecoders, sizeof(PosDecoders) / sizeof(Prob));
+        initProbs(Align, sizeof(Align) / sizeof(Prob));
+        initProbs((Prob*)&LenDec, sizeof(LenDec) / sizeof(Prob));
+        initProbs((Prob*)&RepLenDec, sizeof(RepLenDec) / sizeof(Prob));
+        DState = 0;
+        Rep0 = Rep1 = Rep2 = Rep3 = 0;
+
+        // Initialize range decoder; the first byte is always 0.
+        UByte first = readInputByte();
+        Range = 0xFFFFFFFF;
+        Code  = 0;
+        for (unsigned i = 0; i < 4; i++)
+            Code = (Code << 8) | readInputByte();
+        if (InputError || first != 0 || Code == Range)
+            ErrorCode = 1;
+    }
+
+
+    // General reading.
+    // Copies data from the dictionary window, decoding more as needed.
+    int     Decode(void* dst, int bytes)
+    {
+        UByte*  pdst        = (UByte*)dst;
+        int     bytesOutput = 0;
+
+        while (bytes > 0)
+        {
+            if (UserPos == LogicalStreamPos && !decodeChunk())
+                break;
+
+            UInt32 copySize = Alg::Min<UInt32>(LogicalStreamPos - UserPos, (UInt32)bytes);
+            copyFromWindow(pdst, UserPos, copySize);
+            pdst        += copySize;
+            bytes       -= (int)copySize;
+            bytesOutput += (int)copySize;
+            UserPos     += copySize;
+        }
+        return bytesOutput;
+    }
+
+    // Seek to the target position.
+    int    SetPosition(int offset)
+    {
+        UInt32 target = (offset < 0) ? 0 : (UInt32)offset;
+
+        if (target <= LogicalStreamPos)
+        {
+            // If we can seek within the dictionary window, do so.
+            if (target >= LogicalStreamPos - getHistorySize())
+            {
+                UserPos = target;
+                return (int)UserPos;
+            }
+
+            SF_DEBUG_MESSAGE1(1, "LzmaFileImpl::SetPosition(%d) - Restarting\n", offset);
+
+            // Otherwise we must re-decode.
+            Reset();
+        }
+        else
+            UserPos = LogicalStreamPos;
+
+        // Now seek forwards, by decoding data in chunks.
+        while (UserPos < target)
+        {
+            if (UserPos == LogicalStreamPos && !decodeChunk())
+                break;
+            UserPos = Alg::Min(target, LogicalStreamPos);
+        }
+
+        // Return new location.
+        return (int)UserPos;
+    }
+
+    // If we have unused bytes in our input buffer, rewind
+    // to before they started.
+    void    RewindUnusedBytes()
+    {
+        if (DataPos < DataSize)
+            pIn->Seek(pIn->Tell() - (DataSize - DataPos));
+        DataPos = DataSize = 0;
+    }
+
+private:
+
+    static void initProbs(Prob* p, UPInt count)
+    {
+        for (UPInt i = 0; i < count; i++)
+            p[i] = BitModelTotal >> 1;
+    }
+
+    UInt32  getHistorySize() const
+    {
+        return Alg::Min(LogicalStreamPos, DictCapacity);
+    }
+
+    // Copies decoded data at logical position pos from the window.
+    void    copyFromWindow(UByte* pdst, UInt32 pos, UInt32 size)
+    {
+        UInt32 back  = LogicalStreamPos - pos;
+        UInt32 start = (DictPos >= back) ? (DictPos - back) : (DictPos + DictCapacity - back);
+        UInt32 first = Alg::Min(size, DictCapacity - start);
+        memcpy(pdst, pDict + start, first);
+        if (size > first)
+            memcpy(pdst + first, pDict, size - first);
+    }
+
+    // Decodes the next chunk of data after UserPos, which must equal LogicalStreamPos.
+    // Returns false if no data could be decoded.
+    bool    decodeChunk()
+    {
+        if (ErrorCode || AtEofFlag)
+            return 0;
+
+        // Matches are copied in full, so stop early enough for the largest match
+        // not to overwrite data that has not been read yet.
+        UInt32 chunk  = Alg::Min<UInt32>(Lzma_BuffSize, DictCapacity - Lzma_MaxMatchLen);
+        UInt32 target = LogicalStreamPos + chunk;
+        UInt32 start  = LogicalStreamPos;
+
+        while (LogicalStreamPos < target && decodeSymbol())
+        { }
+        return LogicalStreamPos > start;
+    }
+
+    // *** Range decoder
+
+    UByte   readInputByte()
+    {
+        if (DataPos == DataSize)
+        {
+            int newBytes = pIn->Read(DataBuffer, Lzma_BuffSize);
+            if (newBytes <= 0)
+            {
+                // The cupboard is bare! Compressed data ended early.
+                InputError = 1;
+                return 0;
+            }
+            DataPos  = 0;
+            DataSize = newBytes;
+        }
+        return DataBuffer[DataPos++];
+    }
+
+    SF_INLINE void normalize()
+    {
+        if (Range < (UInt32)TopValue)
+        {
+            Range <<= 8;
+            Code = (Code << 8) | readInputByte();
+        }
+    }
+
+    SF_INLINE unsigned decodeBit(Prob* p)
+    {
+        unsigned v     = *p;
+        UInt32   bound = (Range >> NumBitModelTotalBits) * v;
+        unsigned symbol;
+        if (Code < bound)
+        {
+            v += (BitModelTotal - v) >> NumMoveBits;
+            Range  = bound;
+            symbol = 0;
+        }
+        else
+        {
+            v -= v >> NumMoveBits;
+            Code  -= bound;
+            Range -= bound;
+            symbol = 1;
+        }
+        *p = (Prob)v;
+        normalize();
+        return symbol;
+    }
+
+    UInt32  decodeDirectBits(unsigned numBits)
+    {
+        UInt32 res = 0;
+        do
+        {
+            Range >>= 1;
+            Code   -= Range;
+            UInt32 t = 0 - (Code >> 31);
+            Code   += Range & t;
+            normalize();
+            res <<= 1;
+            res += t + 1;
+        } while (--numBits);
+        return res;
+    }
+
+    unsigned decodeBitTree(Prob* probs, unsigned numBits)
+    {
+        unsigned m = 1;
+        for (unsigned i = 0; i < numBits; i++)
+            m = (m << 1) + decodeBit(&probs[m]);
+        return m - (1u << numBits);
+    }
+
+    unsigned decodeReverseBitTree(Prob* probs, unsigned numBits)
+    {
+        unsigned m = 1;
+        unsigned symbol = 0;
+        for (unsigned i = 0; i < numBits; i++)
+        {
+            unsigned bit = decodeBit(&probs[m]);
+            m <<= 1;
+            m += bit;
+            symbol |= (bit << i);
+        }
+        return symbol;
+    }
+
+    // *** LZMA symbols
+
+    unsigned decodeLen(LenDecoder& ld, unsigned posState)
+    {
+        if (decodeBit(&ld.Choice) == 0)
+            return decodeBitTree(ld.Low[posState], 3);
+        if (decodeBit(&ld.Choice2) == 0)
+            return 8 + decodeBitTree(ld.Mid[posState], 3);
+        return 16 + decodeBitTree(ld.High, 8);
+    }
+
+    UInt32  decodeDistance(unsigned len)
+    {
+        unsigned lenState = Alg::Min<unsigned>(len, NumLenToPosStates - 1);
+        unsigned posSlot  = decodeBitTree(PosSlot[lenState], 6);
+        if (posSlot < 4)
+            return posSlot;
+
+        unsigned numDirectBits = (posSlot >> 1) - 1;
+        UInt32   dist = ((2 | (posSlot & 1)) << numDirectBits);
+        if (posSlot < EndPosModelIndex)
+            dist += decodeReverseBitTree(PosDecoders + dist - posSlot, numDirectBits);
+        else
+        {
+            dist += decodeDirectBits(numDirectBits - NumAlignBits) << NumAlignBits;
+            dist += decodeReverseBitTree(Align, NumAlignBits);
+        }
+        return dist;
+    }
+
+    // Returns byte decoded dist bytes back; dist must be within history.
+    SF_INLINE UByte getByte(UInt32 dist) const
+    {
+        return pDict[(dist <= DictPos) ? (DictPos - dist) : (DictCapacity - dist + DictPos)];
+    }
+
+    SF_INLINE void putByte(UByte b)
+    {
+        pDict[DictPos] = b;
+        if (++DictPos == DictCapacity)
+            DictPos = 0;
+        LogicalStreamPos++;
+    }
+
+    void    decodeLiteral()
+    {
+        unsigned prevByte = LogicalStreamPos ? getByte(1) : 0;
+        unsigned litState = ((LogicalStreamPos & ((1u << Lp) - 1)) << Lc) + (prevByte >> (8 - Lc));
+        Prob*    probs    = pLitProbs + 0x300 * litState;
+        unsigned symbol   = 1;
+
+        if (DState >= 7)
+        {
+            unsigned matchByte = getByte(Rep0 + 1);
+            do
+            {
+                unsigned matchBit = (matchByte >> 7) & 1;
+                matchByte <<= 1;
+                unsigned bit = decodeBit(&probs[((1 + matchBit) << 8) + symbol]);
+                symbol = (symbol << 1) | bit;
+                if (matchBit != bit)
+                    break;
+            } while (symbol < 0x100);
+        }
+        while (symbol < 0x100)
+            symbol = (symbol << 1) | decodeBit(&probs[symbol]);
+
+        putByte((UByte)(symbol - 0x100));
+    }
+
+    void    copyMatch(UInt32 dist, UInt32 len)
+    {
+        UInt32 src = (dist <= DictPos) ? (DictPos - dist) : (DictCapacity - dist + DictPos);
+        LogicalStreamPos += len;
+        for (; len > 0; len--)
+        {
+            pDict[DictPos] = pDict[src];
+            if (++src == DictCapacity)
+                src = 0;
+            if (++DictPos == DictCapacity)
+                DictPos = 0;
+        }
+    }
+
+    // Decodes one literal or match. Returns false at the end of stream or on error.
+    bool    decodeSymbol()
+    {
+        if (UnpackedSize && LogicalStreamPos >= UnpackedSize)
+        {
+            AtEofFlag = 1;
+            return 0;
+        }
+
+        unsigned posState = LogicalStreamPos & ((1u << Pb) - 1);
+
+        if (decodeBit(&IsMatch[(DState << NumPosBitsMax) + posState]) == 0)
+        {
+            decodeLiteral();
+            DState = (DState < 4) ? 0 : ((DState < 10) ? DState - 3 : DState - 6);
+            return checkInput();
+        }
+
+        unsigned len;
+        if (decodeBit(&IsRep[DState]) != 0)
+        {
+            if (LogicalStreamPos == 0)
+                return setError();
+
+            if (decodeBit(&IsRepG0[DState]) == 0)
+            {
+                // Single byte repeated from rep0.
+                if (decodeBit(&IsRep0Long[(DState << NumPosBitsMax) + posState]) == 0)
+                {
+                    DState = (DState < 7) ? 9 : 11;
+                    putByte(getByte(Rep0 + 1));
+                    return checkInput();
+                }
+            }
+            else
+            {
+                UInt32 dist;
+                if (decodeBit(&IsRepG1[DState]) == 0)
+                    dist = Rep1;
+                else
+                {
+                    if (decodeBit(&IsRepG2[DState]) == 0)
+                        dist = Rep2;
+                    else
+                    {
+                        dist = Rep3;
+                        Rep3 = Rep2;
+                    }
+                    Rep2 = Rep1;
+                }
+                Rep1 = Rep0;
+                Rep0 = dist;
+            }
+            len    = decodeLen(RepLenDec, posState);
+            DState = (DState < 7) ? 8 : 11;
+        }
+        else
+        {
+            Rep3   = Rep2;
+            Rep2   = Rep1;
+            Rep1   = Rep0;
+            len    = decodeLen(LenDec, posState);
+            DState = (DState < 7) ? 7 : 10;
+            Rep0   = decodeDistance(len);
+
+            if (Rep0 == 0xFFFFFFFF)
+            {
+                // End marker.
+                AtEofFlag = 1;
+                return 0;
+            }
+            if (Rep0 >= DictSize || Rep0 >= getHistorySize())
+                return setError();
+        }
+
+        len += MatchMinLen;
+        if (UnpackedSize && len > UnpackedSize - LogicalStreamPos)
+            len = UnpackedSize - LogicalStreamPos;
+        copyMatch(Rep0 + 1, len);
+        return checkInput();
+    }
+
+    bool    checkInput()
+    {
+        return InputError ? setError() : 1;
+    }
+
+    bool    setError()
+    {
+        ErrorCode = 1;
+        return 0;
+    }
+};
+
+
+// ***** LzmaFile Implementation
+
+// LzmaFile must be constructed with a source file
+LzmaFile::LzmaFile(File *psourceFile, UInt32 unpackedSize)
+{
+    pImpl = 0;
+    if (psourceFile && psourceFile->IsValid())
+        pImpl = SF_HEAP_AUTO_NEW(this) LzmaFileImpl(psourceFile, unpackedSize);
+    else
+    {
+        SF_DEBUG_WARNING(1, "LzmaFile constructor failed, psourceFile is not valid");
+    }
+}
+
+LzmaFile::~LzmaFile()
+{
+    if (pImpl)
+    {
+        pImpl->RewindUnusedBytes();
+        delete pImpl;
+    }
+}
+
+
+// ** File Information
+const char* LzmaFile::GetFilePath()
+{
+    return pImpl ? pImpl->pIn->GetFilePath() : 0;
+}
+
+// Return 1 if file's usable (open)
+bool    LzmaFile::IsValid()
+{
+    return pImpl ? 1 : 0;
+}
+
+// Return position
+int    LzmaFile::Tell ()
+{
+    if (!pImpl) return -1;
+    return (int)pImpl->UserPos;
+}
+SInt64  LzmaFile::LTell ()
+    { return Tell(); }
+
+
+int LzmaFile::GetLength ()
+{
+    if (!pImpl) return 0;
+    if (pImpl->ErrorCode)
+        return 0;
+    if (pImpl->UnpackedSize)
+        return (int)pImpl->UnpackedSize;
+
+    // This is expensive..
+    int oldPos = (int)pImpl->UserPos;
+    int endPos = SeekToEnd();
+    Seek(oldPos);
+    return endPos;
+}
+
+SInt64  LzmaFile::LGetLength ()
+{
+    return GetLength();
+}
+
+// Return errno-based error code
+int LzmaFile::GetErrorCode()
+{
+    return pImpl ? pImpl->ErrorCode : 0;
+}
+
+
+// ** Stream implementation & I/O
+
+int LzmaFile::Write(const UByte *pbuffer, int numBytes)
+{
+    SF_UNUSED2(pbuffer, numBytes);
+    SF_DEBUG_WARNING(1, "LzmaFile::Write is not supported");
+    return 0;
+}
+
+int LzmaFile::Read(UByte *pbuffer, int numBytes)
+{
+    if (!pImpl) return -1;
+    return pImpl->Decode(pbuffer, numBytes);
+}
+
+int LzmaFile::SkipBytes(int numBytes)
+{
+    return Seek(numBytes, SEEK_CUR);
+}
+
+int LzmaFile::BytesAvailable()
+{
+    if (!pImpl) return 0;
+    if (pImpl->ErrorCode)
+        return 0;
+    return GetLength() - (int)pImpl->UserPos;
+}
+
+bool    LzmaFile::Flush()
+{
+    return 1;
+}
+
+
+// Returns new position, -1 for error
+int LzmaFile::Seek(int offset, int origin)
+{
+    if (!pImpl) return -1;
+
+    //If there us an error, bail
+    if (pImpl->ErrorCode)
+        return (int)pImpl->UserPos;
+
+    switch(origin)
+    {
+        case Seek_Cur:
+            pImpl->SetPosition(offset + (int)pImpl->UserPos);
+            break;
+
+        case Seek_Set:
+            pImpl->SetPosition(offset);
+            break;
+
+        case Seek_End:
+            // Seek forward as far as possible (till end).
+            pImpl->SetPosition(0x7FFFFFFF);
+
+            // If offset is not at the end (i.e. usually negative), seek back
+            if (offset != 0)
+                pImpl->SetPosition((int)pImpl->UserPos + offset);
+            break;
+    }
+
+    return (int)pImpl->UserPos;
+}
+
+
+SInt64  LzmaFile::LSeek(SInt64 offset, int origin)
+{
+    SF_DEBUG_WARNING(offset > (SInt64)0x7FFFFFFF, "LzmaFile::LSeek offset out of range, 64bit seek not supported" );
+    return Seek((int)offset, origin);
+}
+
+// Writing not supported..
+bool LzmaFile::ChangeSize(int newSize)
+{
+    SF_UNUSED(newSize);
+    SF_DEBUG_WARNING(1, "LzmaFile::ChangeSize is not supported");
+    return 0;
+}
+int LzmaFile::CopyFromStream(File *pstream, int byteSize)
+{
+    SF_UNUSED2(pstream, byteSize);
+    SF_DEBUG_WARNING(1, "LzmaFile::CopyFromStream is not supported");
+    return 0;
+}
+
+// Closes the file
+bool LzmaFile::Close()
+{
+    if (!pImpl) return 0;
+
+    pImpl->RewindUnusedBytes();
+    bool ok = (pImpl->ErrorCode == 0);
+
+    //  Close & release the file
+    pImpl->pIn->Close();
+    delete pImpl;
+    pImpl = 0;
+    return ok;
+}
+
+
+// ***** LzmaSupport
+
+File* LzmaSupport::CreateLzmaFile(File* in, UInt32 unpackedSize)
+{
+    return SF_HEAP_AUTO_NEW(this) LzmaFile(in, unpackedSize);
+}
+
+}} //namespace Scaleform { namespace GFx {
+
+#else
+
+namespace Scaleform { namespace GFx {
+
+File* LzmaSupport::CreateLzmaFile(File* in, UInt32 unpackedSize)
+{
+    SF_UNUSED2(in, unpackedSize);
+    SF_DEBUG_WARNING(1, "LzmaSupport::CreateLzmaFile failed - SF_ENABLE_LZMA not defined");
+    return NULL;
+}
+
+}} //namespace Scaleform { namespace GFx {
+
+#endif // SF_ENABLE_LZMA
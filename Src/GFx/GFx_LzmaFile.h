@@ -0,0 +1,91 @@
+/**************************************************************************
+
+Filename    :   GFx_LzmaFile.h
+Content     :   Header for LZMA wrapped file input
+Created     :
+Authors     :
+
+Notes       :   LzmaFile is Read Only
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_GFX_LzmaFile_H
+#define INC_SF_GFX_LzmaFile_H
+
+#include "Kernel/SF_File.h"
+
+namespace Scaleform { namespace GFx {
+
+// LZMA functionality is only available if SF_ENABLE_LZMA is defined
+#ifdef SF_ENABLE_LZMA
+
+class LzmaFileImpl;
+
+// LzmaFile decompresses an LZMA stream, as stored in ZWS/ZFX files, while it
+// is being read. The source file must be positioned at the 5-byte LZMA
+// properties header, which is immediately followed by compressed data.
+// Decompression happens on demand in Read, so tags can be parsed before
+// the whole stream is decoded. Seeking back within the most recently
+// decoded dictionary window is cheap; seeking further back restarts
+// decompression from the beginning.
+
+class LzmaFile : public File
+{
+    friend class LzmaFileImpl;
+
+    class LzmaFileImpl   *pImpl;
+
+public:
+
+    // LzmaFile must be constructed with a source file. If unpackedSize is not 0
+    // the stream ends after that many bytes; otherwise it must contain
+    // an end marker.
+    LzmaFile(File *psourceFile = 0, UInt32 unpackedSize = 0);
+    ~LzmaFile();
+
+    // ** File Information
+    virtual const char* GetFilePath();
+
+    // Return 1 if file's usable (open)
+    virtual bool        IsValid();
+    // Return 0; LZMA files are not writable
+    virtual bool        IsWritable() { return 0; }
+
+    // Return position
+    // Position position is reported in relation to the decompressed stream, NOT the source file
+    virtual int         Tell ();
+    virtual SInt64      LTell ();
+    virtual int         GetLength ();
+    virtual SInt64      LGetLength ();
+    // Return errno-based error code
+    virtual int         GetErrorCode();
+
+    // ** Stream implementation & I/O
+
+    virtual int         Write(const UByte *pbufer, int numBytes);
+    virtual int         Read(UByte *pbufer, int numBytes);
+    virtual int         SkipBytes(int numBytes);
+    virtual int         BytesAvailable();
+    virtual bool        Flush();
+    // Returns new position, -1 for error
+    // Position seeking works in relation to the decompressed stream, NOT the source file
+    virtual int         Seek(int offset, int origin=SEEK_SET);
+    virtual SInt64      LSeek(SInt64 offset, int origin=SEEK_SET);
+    // Writing not supported..
+    virtual bool        ChangeSize(int newSize);
+    virtual int         CopyFromStream(File *pstream, int byteSize);
+    // Closes the file
+    virtual bool        Close();
+};
+
+#endif // SF_ENABLE_LZMA
+
+}} //namespace Scaleform { namespace GFx {
+
+#endif // INC_SF_GFX_LzmaFile_H
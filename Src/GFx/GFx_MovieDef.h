@@ -1028,6 +1028,7 @@ public:
     Ptr<ImageFileHandlerRegistry> pImageFileHandlerRegistry;
 
     Ptr<ZlibSupportBase>    pZlibSupport;
+    Ptr<LzmaSupportBase>    pLzmaSupport;
 #ifdef GFX_ENABLE_VIDEO
     Ptr<Video::VideoBase>   pVideoPlayerState;
 #endif
@@ -1088,6 +1089,7 @@ public:
     ImageFileHandlerRegistry* GetImageFileHandlerRegistry() const { return pImageFileHandlerRegistry; }
  
     ZlibSupportBase*     GetZlibSupport() const      { return pZlibSupport; }
+    LzmaSupportBase*     GetLzmaSupport() const      { return pLzmaSupport; }
     FontCompactorParams* GetFontCompactorParams() const { return pBindStates->pFontCompactorParams; }
 
     FileOpener*          GetFileOpener() const       { return pBindStates->pFileOpener;  }
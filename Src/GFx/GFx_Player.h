@@ -149,6 +149,13 @@ struct MemoryParams
     // before GC collects 'old' objects.
     unsigned    RunsToCollectOld;
 
+    // Time budget, in microseconds, of incremental collection (AS3 only). If set,
+    // regular collections are spread over several frames, each frame collecting 
+    // as many roots as fit the budget, instead of processing all the roots at once.
+    // Collections forced by the user or by the heap limit are not affected.
+    // 0 (default) turns incremental collection off.
+    unsigned    CollectionSliceTime;
+
     MemoryParams(UPInt memoryArena = 0)
     {
         Desc.Arena                 = memoryArena;
@@ -159,6 +166,7 @@ struct MemoryParams
         RunsToUpgradeGen           = ~0u; // Default value will be used.
         RunsToCollectYoung         = ~0u; // Default value will be used.
         RunsToCollectOld           = ~0u; // Default value will be used.
+        CollectionSliceTime        = ~0u; // Default value will be used.
     }
 };
 
@@ -400,6 +400,7 @@ MovieImpl::MovieImpl(MemoryHeap* pheap)
     UserData(NULL),
     Flags(0),
     Flags2(0),
+    TimelineKeyframeMemory(ActionControl::DefaultTimelineKeyframeMemory),
     RenderContext(Memory::GetGlobalHeap()),
     DIContext(0),
     pRTCommandQueue(0)
@@ -1515,6 +1516,7 @@ float MovieImpl::Advance(float deltaT, unsigned frameCatchUpCount, bool capture)
         G_SetFlag<Flag_LogRootFilenames>(Flags, (pac->GetActionFlags() & ActionControl::Action_LogRootFilenames) != 0);
         G_SetFlag<Flag_LogLongFilenames>(Flags, (pac->GetActionFlags() & ActionControl::Action_LongFilenames) != 0);
         G_SetFlag<Flag_LogChildFilenames>(Flags, (pac->GetActionFlags() & ActionControl::Action_LogChildFilenames) != 0);
+        TimelineKeyframeMemory = pac->GetTimelineKeyframeMemory();
     }
     else
     {
@@ -1523,6 +1525,7 @@ float MovieImpl::Advance(float deltaT, unsigned frameCatchUpCount, bool capture)
         G_SetFlag<Flag_LogRootFilenames>(Flags, 0);
         G_SetFlag<Flag_LogLongFilenames>(Flags, 0);
         G_SetFlag<Flag_LogChildFilenames>(Flags, 0);
+        TimelineKeyframeMemory = ActionControl::DefaultTimelineKeyframeMemory;
     }
 
 #ifdef GFX_ENABLE_SOUND
@@ -905,6 +905,7 @@ public:
     bool                IsLogRootFilenames() const  { return G_IsFlagSet<Flag_LogRootFilenames>(Flags); }
     bool                IsLogChildFilenames() const { return G_IsFlagSet<Flag_LogChildFilenames>(Flags); }
     bool                IsLogLongFilenames() const  { return G_IsFlagSet<Flag_LogLongFilenames>(Flags); }
+    unsigned            GetTimelineKeyframeMemory() const { return TimelineKeyframeMemory; }
     bool                IsAlwaysEnableKeyboardPress() const; 
     bool                IsAlwaysEnableKeyboardPressSet() const;
     void                SetAlwaysEnableKeyboardPress(bool f);
@@ -1346,6 +1347,9 @@ public:
     UInt32                                  Flags;
     UInt32                                  Flags2;
 
+    // Assigned from ActionControl.
+    unsigned                                TimelineKeyframeMemory;
+
     IMECandidateListStyle*                  pIMECandidateListStyle; // stored candidate list style
 #if defined(SF_OS_WIN32) && defined(GFX_ENABLE_BUILTIN_KOREAN_IME) && defined(GFX_ENABLE_IME)
     GFxIMEImm32Dll                          Imm32Dll;
@@ -1154,7 +1154,13 @@ void    Sprite::GotoFrame(unsigned targetFrameNumber)
                 GetId(), (GetName().ToCStr() ? GetName().ToCStr() : ""),
                 0, targetFrameNumber, CurrentFrame);
 #endif
-            snapshot.MakeSnapshot(pDef, 0, targetFrameNumber-1);
+            // Start from the nearest keyframe of the timeline, if it keeps them.
+            TimelineKeyframes* pkeyframes = pDef->GetKeyframes();
+            unsigned keyframeMemory = GetMovieImpl()->GetTimelineKeyframeMemory();
+            if (pkeyframes && keyframeMemory)
+                pkeyframes->MakeSnapshot(&snapshot, pDef, targetFrameNumber-1, keyframeMemory);
+            else
+                snapshot.MakeSnapshot(pDef, 0, targetFrameNumber-1);
 
             // Set the current frame to target one and execute the snapshot
             CurrentFrame = targetFrameNumber;
@@ -34,6 +34,7 @@ SpriteDef::SpriteDef(MovieDataDef* pmd)
     FrameCount(0),
     LoadingFrame(0),
     pScale9Grid(0),
+    pKeyframes(0),
     //pSoundStream(NULL), //@SOUND
     Flags(0)
 {   
@@ -48,6 +49,7 @@ SpriteDef::~SpriteDef()
     for(i=0; i<Playlist.GetSize(); i++)
         Playlist[i].DestroyTags();        
     delete pScale9Grid;
+    delete pKeyframes;
     //#ifdef GFX_ENABLE_SOUND
     //    if (pSoundStream) //@SOUND
     //        pSoundStream->Release();
@@ -106,6 +108,10 @@ void    SpriteDef::Read(LoadProcess* p, ResourceId charId)
         FrameCount = 1;    
     Playlist.Resize(FrameCount);    // need a playlist for each frame
 
+    // Only timelines longer than the keyframe interval benefit from keyframes.
+    if (FrameCount > TimelineKeyframes::InitialInterval)
+        pKeyframes = SF_HEAP_AUTO_NEW(this) TimelineKeyframes;
+
     pin->LogParse("  frames = %d\n", FrameCount);
 
     LoadingFrame = 0;
@@ -341,6 +347,130 @@ void    TimelineSnapshot::ExecuteSnapshot(DisplayObjContainer* pdispObj)
     }
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Timeline keyframes
+//
+TimelineKeyframes::~TimelineKeyframes()
+{
+    for (UPInt i = 0; i < Keyframes.GetSize(); ++i)
+        delete Keyframes[i];
+}
+
+// Returns the last keyframe at or before the frame.
+TimelineKeyframes::Keyframe* TimelineKeyframes::FindKeyframe(unsigned frame) const
+{
+    Keyframe* pkeyframe = NULL;
+    UPInt lo = 0, hi = Keyframes.GetSize();
+    while (lo < hi)
+    {
+        UPInt mid = (lo + hi) / 2;
+        if (Keyframes[mid]->FrameNumber <= frame)
+        {
+            pkeyframe = Keyframes[mid];
+            lo = mid + 1;
+        }
+        else
+            hi = mid;
+    }
+    return pkeyframe;
+}
+
+void TimelineKeyframes::DoubleInterval()
+{
+    Interval *= 2;
+    UPInt j = 0;
+    for (UPInt i = 0; i < Keyframes.GetSize(); ++i)
+    {
+        Keyframe* pkeyframe = Keyframes[i];
+        if ((pkeyframe->FrameNumber + 1) % Interval == 0)
+            Keyframes[j++] = pkeyframe;
+        else
+        {
+            MemorySize -= pkeyframe->GetMemorySize();
+            delete pkeyframe;
+        }
+    }
+    Keyframes.Resize(j);
+}
+
+void TimelineKeyframes::AddKeyframe(const TimelineSnapshot& snapshot, unsigned frame, UPInt memoryLimit)
+{
+    Keyframe* pkeyframe = SF_HEAP_AUTO_NEW(this) Keyframe;
+    if (!pkeyframe)
+        return;
+    pkeyframe->FrameNumber = frame;
+    if (!snapshot.SnapshotList.IsEmpty())
+    {
+        const TimelineSnapshot::SnapshotElement* pe;
+        for (pe = snapshot.SnapshotList.GetFirst(); ; pe = snapshot.SnapshotList.GetNext(pe))
+        {
+            Element e;
+            e.Tags        = pe->Tags;
+            e.CreateFrame = pe->CreateFrame;
+            e.Depth       = pe->Depth;
+            e.PlaceType   = pe->PlaceType;
+            e.Flags       = pe->Flags;
+            pkeyframe->Elements.PushBack(e);
+
+            if (snapshot.SnapshotList.IsLast(pe))
+                break;
+        }
+    }
+
+    UPInt size = pkeyframe->GetMemorySize();
+    while (MemorySize + size > memoryLimit && Keyframes.GetSize() > 0)
+        DoubleInterval();
+    if (MemorySize + size > memoryLimit || (frame + 1) % Interval != 0)
+    {
+        delete pkeyframe;
+        return;
+    }
+
+    // Keyframes are mostly added in order of frames.
+    UPInt i = Keyframes.GetSize();
+    while (i > 0 && Keyframes[i - 1]->FrameNumber > frame)
+        --i;
+    Keyframes.InsertAt(i, pkeyframe);
+    MemorySize += size;
+}
+
+void TimelineKeyframes::MakeSnapshot(TimelineSnapshot* psnapshot, TimelineDef* pdef, 
+                                     unsigned endFrame, UPInt memoryLimit)
+{
+    SF_ASSERT(psnapshot->Direction == TimelineSnapshot::Direction_Backward);
+    SF_ASSERT(psnapshot->SnapshotList.IsEmpty());
+
+    Lock::Locker lock(&KeyframesLock);
+
+    unsigned startFrame = 0;
+    const Keyframe* pkeyframe = FindKeyframe(endFrame);
+    if (pkeyframe)
+    {
+        // Re-adding elements in their original order restores both the list
+        // and the depth-sorted array of the snapshot.
+        for (UPInt i = 0; i < pkeyframe->Elements.GetSize(); ++i)
+        {
+            const Element& e = pkeyframe->Elements[i];
+            TimelineSnapshot::SnapshotElement* pe = psnapshot->Add(e.Depth);
+            if (!pe)
+                break;
+            pe->Tags        = e.Tags;
+            pe->CreateFrame = e.CreateFrame;
+            pe->PlaceType   = e.PlaceType;
+            pe->Flags       = e.Flags;
+        }
+        startFrame = pkeyframe->FrameNumber + 1;
+    }
+
+    for (unsigned f = startFrame; f <= endFrame; ++f)
+    {
+        psnapshot->MakeSnapshot(pdef, f, f);
+        if ((f + 1) % Interval == 0)
+            AddKeyframe(*psnapshot, f, memoryLimit);
+    }
+}
+
+
 void TimelineSnapshot::SourceTags::Unpack(GFxPlaceObjectBase::UnpackedData& data) const
 {
     SF_ASSERT(pMainTag);
@@ -25,6 +25,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 //#include "GFx/GFx_Scale9Grid.h"
 #include "Kernel/SF_ListAlloc.h"
 #include "Kernel/SF_Alg.h"
+#include "Kernel/SF_Atomic.h"
 
 #ifdef GFX_ENABLE_SOUND
 #include "GFx/Audio/GFx_Sound.h"
@@ -69,6 +70,7 @@ class SpriteDef : public TimelineIODef
     ArrayLH<Frame, StatMD_Other_Mem> Playlist;
 
     Scale9Grid*         pScale9Grid;
+    TimelineKeyframes*  pKeyframes;
 #ifdef GFX_ENABLE_SOUND
     Ptr<SoundStreamDef> pSoundStream;
 #endif
@@ -153,6 +155,7 @@ public:
         // Only the root sprite (MovieDataDef) does.
         return false;
     }    
+    virtual TimelineKeyframes* GetKeyframes() const { return pKeyframes; }
 
 #ifdef GFX_ENABLE_SOUND
     virtual SoundStreamDef* GetSoundStream() const;
@@ -327,6 +330,59 @@ public:
     void ExecuteSnapshot(DisplayObjContainer* pdispObj);
 };
 
+
+// TimelineKeyframes keeps copies of the backward timeline snapshot taken at
+// every Interval-th frame, so that the snapshot for a backward gotoFrame
+// can be started from the nearest preceding keyframe instead of frame 0.
+// A backward snapshot depends on the timeline's tags only, so keyframes
+// belong to the SpriteDef and are shared by all of its instances. They are
+// recorded while making snapshots; when they exceed the memory limit, the
+// interval is doubled and every other keyframe is dropped.
+class TimelineKeyframes : public NewOverrideBase<StatMD_Other_Mem>
+{
+public:
+    enum { InitialInterval = 16 };
+
+    TimelineKeyframes() : Interval(InitialInterval), MemorySize(0) {}
+    ~TimelineKeyframes();
+
+    // Makes a backward snapshot of frames 0 to endFrame into the empty 
+    // psnapshot, recording new keyframes within memoryLimit bytes.
+    void MakeSnapshot(TimelineSnapshot* psnapshot, TimelineDef* pdef, 
+                      unsigned endFrame, UPInt memoryLimit);
+
+    UPInt GetMemorySize() const { return MemorySize; }
+
+private:
+    struct Element
+    {
+        TimelineSnapshot::SourceTags    Tags;
+        unsigned                        CreateFrame;
+        int                             Depth;
+        UInt8                           PlaceType;
+        UInt8                           Flags;
+    };
+    struct Keyframe : public NewOverrideBase<StatMD_Other_Mem>
+    {
+        // State of the snapshot after frames 0 to FrameNumber, in order of addition.
+        unsigned                                FrameNumber;
+        ArrayLH_POD<Element, StatMD_Other_Mem>  Elements;
+
+        UPInt GetMemorySize() const { return sizeof(Keyframe) + Elements.GetSize() * sizeof(Element); }
+    };
+
+    Keyframe*   FindKeyframe(unsigned frame) const;
+    void        AddKeyframe(const TimelineSnapshot& snapshot, unsigned frame, UPInt memoryLimit);
+    void        DoubleInterval();
+
+    // Sorted by FrameNumber.
+    ArrayLH<Keyframe*, StatMD_Other_Mem>    Keyframes;
+    unsigned                                Interval;
+    UPInt                                   MemorySize;
+    // Instances of the sprite may be advanced on different threads.
+    Lock                                    KeyframesLock;
+};
+
 }} // namespace Scaleform::GFx
 
 #endif // INC_SF_GFX_SPRITEDEF_H
@@ -36,9 +36,6 @@ Stream::Stream(File* pinput, MemoryHeap* pheap,
                      Log *plog, ParseControl *pparseControl) 
     : FileName(pheap)
 {
-    BufferSize  = sizeof(BuiltinBuffer);
-    pBuffer     = BuiltinBuffer;
-
     Initialize(pinput, plog, pparseControl);
 }
 
@@ -46,16 +43,18 @@ Stream::Stream(const UByte* pbuffer, unsigned bufSize, MemoryHeap* pheap,
                      Log *plog, ParseControl *pparseControl)
     : FileName(pheap)
 {
-    pBuffer     = const_cast<UByte*>(pbuffer);
-    if (pBuffer)
-        BufferSize  = bufSize;
-    else
-        BufferSize  = 0;
-
     Initialize(NULL, plog, pparseControl);
 
-    DataSize    = BufferSize;
-    FilePos     = BufferSize;
+    // Parse directly out of the user buffer.
+    if (pbuffer)
+    {
+        pDirectData = pbuffer;
+        DirectSize  = bufSize;
+        pBuffer     = const_cast<UByte*>(pbuffer);
+        BufferSize  = bufSize;
+        DataSize    = bufSize;
+        FilePos     = bufSize;
+    }
 }
 
 Stream::~Stream()
@@ -80,10 +79,29 @@ void    Stream::Initialize(File* pinput, Log *plog, ParseControl *pparseControl)
     TagStack[0] = 0;
     TagStack[1] = 0;
 
-    Pos         = 0;
-    DataSize    = 0;
     ResyncFile  = false;
-    FilePos     = pinput ? pinput->Tell() : 0;
+    pDirectData = pinput ? pinput->GetMappedData() : 0;
+
+    if (pDirectData)
+    {
+        // The whole file is in memory, so use it as the buffer; the
+        // underlying file position is only updated by SyncFileStream.
+        DirectSize  = (unsigned)pinput->GetLength();
+        pBuffer     = const_cast<UByte*>(pDirectData);
+        BufferSize  = DirectSize;
+        DataSize    = DirectSize;
+        FilePos     = DirectSize;
+        Pos         = (unsigned)pinput->Tell();
+    }
+    else
+    {
+        DirectSize  = 0;
+        pBuffer     = BuiltinBuffer;
+        BufferSize  = sizeof(BuiltinBuffer);
+        Pos         = 0;
+        DataSize    = 0;
+        FilePos     = pinput ? pinput->Tell() : 0;
+    }
 }
 
 
@@ -92,6 +110,13 @@ void    Stream::ShutDown()
     // Clear FileName since it contains allocation from the users heap.
     FileName.Clear();
     pInput = 0;
+    // Direct data belonged to the file.
+    pDirectData = 0;
+    DirectSize  = 0;
+    pBuffer     = BuiltinBuffer;
+    BufferSize  = sizeof(BuiltinBuffer);
+    Pos         = 0;
+    DataSize    = 0;
     pLog   = 0;
     pParseControl = 0;
 }
@@ -190,6 +215,9 @@ int    Stream::ReadSInt(unsigned bitcount)
 // Makes data available in buffer. Stores zeros if not available.
 bool    Stream::PopulateBuffer(int size)
 {
+    if (pDirectData)
+        return PopulateDirectBuffer(size);
+
     if (DataSize == 0)
     {
         // In case Underlying file position was changed.
@@ -269,9 +297,42 @@ bool    Stream::PopulateBuffer1()
     return PopulateBuffer(1);
 }
 
+// In direct mode all of the data is already in the buffer, so we only get
+// here on an attempt to read past its end. Move the remaining bytes into
+// BuiltinBuffer and pad them with zeros, as PopulateBuffer does for files;
+// SetPosition switches back to the direct data.
+bool    Stream::PopulateDirectBuffer(int size)
+{
+    SF_ASSERT(ResyncFile == false);
+    SF_ASSERT(size <= (int)sizeof(BuiltinBuffer));
+
+    unsigned remaining = DataSize - Pos;
+    memmove(BuiltinBuffer, pBuffer + Pos, remaining);
+    memset(BuiltinBuffer + remaining, 0, sizeof(BuiltinBuffer) - remaining);
+    pBuffer     = BuiltinBuffer;
+    BufferSize  = sizeof(BuiltinBuffer);
+    Pos         = 0;
+    DataSize    = remaining;
+
+    if ((int)DataSize < size)
+    {
+        int extraBytes = size - (int)DataSize;
+        SF_DEBUG_ERROR3(1, "Read error: attempt to read %d bytes beyond the EOF, file %s, filepos %d", 
+            extraBytes, FileName.ToCStr(), (int)FilePos);
+        DataSize += (unsigned) extraBytes;
+    }
+    return false;
+}
+
 // Reposition the underlying file to the desired location
 void    Stream::SyncFileStream()
 {
+    if (pDirectData)
+    {
+        // The buffer is the file data itself, so it stays valid.
+        pInput->Seek(Tell());
+        return;
+    }
     int pos = pInput->Seek(Tell());
     if (pos != -1)
     {
@@ -380,6 +441,16 @@ char*   Stream::ReadStringWithLength(MemoryHeap* pheap)
 
 int   Stream::ReadToBuffer(UByte* pdestBuf, unsigned sz)
 {
+    if (pDirectData)
+    {
+        unsigned szFromBuf = Alg::Min(sz, DataSize - Pos);
+        memcpy(pdestBuf, pBuffer + Pos, szFromBuf);
+        Pos += szFromBuf;
+        if (szFromBuf < sz)
+            memset(pdestBuf + szFromBuf, 0, sz - szFromBuf);
+        return (int)szFromBuf;
+    }
+
     unsigned bytes_read = 0;
     if (DataSize == 0)
     {
@@ -419,6 +490,18 @@ int   Stream::ReadToBuffer(UByte* pdestBuf, unsigned sz)
     return (int)bytes_read;
 }
 
+const UByte* Stream::ReadDirect(unsigned sz)
+{
+    // Memory of streams created on a user buffer is not owned by a file, so
+    // it can't be referenced past the lifetime of the stream.
+    Align();
+    if (!pDirectData || !pInput || pBuffer != pDirectData || (DataSize - Pos) < sz)
+        return 0;
+    const UByte* pdata = pBuffer + Pos;
+    Pos += sz;
+    return pdata;
+}
+
 
 
 // Set the file position to the given value.
@@ -432,6 +515,20 @@ void    Stream::SetPosition(int pos)
         SF_ASSERT(pos <= GetTagEndPosition());
         // @@ check start pos somehow???
     }
+
+    if (pDirectData)
+    {
+        // All of the data is in memory; restore the direct buffer in case we
+        // have read past its end.
+        pBuffer     = const_cast<UByte*>(pDirectData);
+        BufferSize  = DirectSize;
+        DataSize    = DirectSize;
+        FilePos     = DirectSize;
+        ResyncFile  = false;
+        if (pos >= 0 && pos <= (int)DirectSize)
+            Pos = (unsigned)pos;
+        return;
+    }
             
     if ((pos >= (int)(FilePos - DataSize) && (pos < (int)FilePos)))
     {
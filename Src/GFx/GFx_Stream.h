@@ -51,6 +51,12 @@ struct TagInfo
 };
 
 // Stream is used to encapsulate bit-packed file reads.
+//
+// If the input file exposes its contents in memory through File::GetMappedData,
+// as MappedFile does, the stream parses directly out of that memory instead of
+// copying through its BuiltinBuffer; streams created on a memory buffer work
+// the same way. In this mode ReadDirect can also be used to reference tag
+// payloads in place.
 class Stream : public LogBase<Stream>
 {
 public:
@@ -147,6 +153,13 @@ public:
     
     int             ReadToBuffer(UByte* pdestBuf, unsigned sz);
 
+    // Returns a pointer to the next 'sz' bytes and skips them, if the stream
+    // parses directly out of a mapped file; otherwise returns 0 without
+    // advancing, and the data should be read with ReadToBuffer. The returned
+    // memory stays valid as long as GetDirectDataFile() is referenced.
+    const UByte*    ReadDirect(unsigned sz);
+    File*           GetDirectDataFile() const { return pDirectData ? pInput.GetPtr() : 0; }
+
     // *** Delegated Logging Support 
 
     // GFxLogBase will output log messages to the appropriate logging stream,
@@ -216,6 +229,11 @@ private:
     UByte*          pBuffer;
     unsigned        BufferSize;
     UByte           BuiltinBuffer[Stream_BufferSize];
+    // Input data, if it is all accessible in memory. pBuffer points to
+    // it except after a read past its end, when the zero padded remainder is
+    // in BuiltinBuffer.
+    const UByte*    pDirectData;
+    unsigned        DirectSize;
 
     // Buffer initialization.
     SF_INLINE bool  EnsureBufferSize1();
@@ -224,6 +242,7 @@ private:
     // Makes data available in buffer. Stores zeros if not available.
     bool            PopulateBuffer(int size); // returns true, if all requested bytes were read.
     bool            PopulateBuffer1();         // returns true, if byte was read from the stream
+    bool            PopulateDirectBuffer(int size);
 };
 
 
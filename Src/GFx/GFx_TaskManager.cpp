@@ -19,407 +19,826 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "GFx/GFx_TaskManager.h"
 #include "Kernel/SF_Threads.h"
 #include "Kernel/SF_Debug.h"
-
-#ifdef SF_ENABLE_THREADS
+#include "Kernel/SF_Alg.h"
 
 namespace Scaleform { namespace GFx {
 
-// ***** TasksContainer
+// ***** Task
+
+Task::~Task()
+{
+    // A child released without being run must not keep its parent pending.
+    if (pParent)
+    {
+        pParent->releasePart();
+        pParent->Release();
+    }
+}
+
+Task::TaskPriority Task::GetDefaultPriority(TaskId id)
+{
+    switch(id)
+    {
+    case Id_MovieDecoding:
+    case Id_MovieDataLoad:
+    case Id_MovieBind:
+        return Priority_High;
+    default:
+        return Priority_Normal;
+    }
+}
+
+void Task::SetParent(Task* pparent)
+{
+    SF_ASSERT(CurrentState == State_Idle);
+    SF_ASSERT(!pParent);
+    if (pparent)
+    {
+        SF_ASSERT(!pparent->IsCompleted());
+        pparent->PendingParts.ExchangeAdd_Sync(1);
+        pparent->AddRef();
+    }
+    pParent = pparent;
+}
+
+void Task::Finish(bool abandoned)
+{
+    CurrentState = abandoned ? State_Abandoned : State_Finished;
+    releasePart();
+}
+
+void Task::releasePart()
+{
+    if (PendingParts.ExchangeAdd_Sync(-1) != 1)
+        return;
+
+    OnComplete();
+    Task* pparent = pParent;
+    pParent = 0;
+    if (pparent)
+    {
+        pparent->releasePart();
+        pparent->Release();
+    }
+}
+
+#ifdef SF_ENABLE_THREADS
+
+// ***** TaskRing
 
-// This class is used to keep track of currently running tasks by a task manager.
-// and it is needed for TaskManager to send an abandon signal for running tasks.
-class TasksContainer
+// Circular double-ended queue of task pointers; holds a reference to each task.
+// Not thread safe, TaskWorker protects it with its QueueLock. The count is
+// atomic so that other workers can skip an empty queue without locking it.
+class TaskRing
 {
 public:
-    TasksContainer(Mutex* ptaskMutex) : pTasksMutex(ptaskMutex) {}
-    ~TasksContainer() 
+    TaskRing() : Head(0), Count(0) { }
+    ~TaskRing()
     {
-        AbandonAllTask();
+        while (Count)
+            PopBack()->Release();
     }
 
-    void AddTask(Task* ptask) 
+    unsigned    GetCount() const { return Count.Load_Acquire(); }
+
+    void PushBack(Task* ptask)
     {
-        SF_ASSERT(ptask);
-        if (!ptask) return;
-        Mutex::Locker guard(pTasksMutex);
-        Tasks.PushBack(ptask);
+        if (Count == Items.GetSize())
+            grow();
+        ptask->AddRef();
+        Items[(Head + Count) & (Items.GetSize() - 1)] = ptask;
+        Count++;
     }
-    bool RemoveTask(Task* ptask)
+    // Returned tasks keep the reference that was held by the ring.
+    Task* PopBack()
     {
-        SF_ASSERT(ptask);
-        if (!ptask) return false;
-        Mutex::Locker guard(pTasksMutex);
-        for(unsigned i=0; i<Tasks.GetSize(); i++)
-        {
-            if (Tasks[i] == ptask)
-            {
-                Tasks.RemoveAt(i);
-                return true;
-            }
-        }
-        return false;
+        if (!Count)
+            return 0;
+        Count--;
+        return Items[(Head + Count) & (Items.GetSize() - 1)];
     }
-    bool FindTask(Task* ptask)
+    Task* PopFront()
     {
-        SF_ASSERT(ptask);
-        if (!ptask) return false;
-        Mutex::Locker guard(pTasksMutex);
-        for(unsigned i=0; i<Tasks.GetSize(); i++)
-        {
-            if (Tasks[i] == ptask)
-                return true;
-        }
-        return false;
+        if (!Count)
+            return 0;
+        Task* ptask = Items[Head];
+        Head = (Head + 1) & (Items.GetSize() - 1);
+        Count--;
+        return ptask;
     }
-    bool AbandonTask(Task* ptask)
+    Task* Remove(Task* ptask)
     {
-        SF_ASSERT(ptask);
-        if (!ptask) return false;
-        Mutex::Locker guard(pTasksMutex);
-        for(unsigned i=0; i<Tasks.GetSize(); i++)
+        UPInt mask = Items.GetSize() - 1;
+        for (unsigned i = 0; i < Count; i++)
         {
-            if (Tasks[i] == ptask)
+            if (Items[(Head + i) & mask] == ptask)
             {
-                Tasks[i]->OnAbandon(true);
-                return true;
+                for (; i + 1 < Count; i++)
+                    Items[(Head + i) & mask] = Items[(Head + i + 1) & mask];
+                Count--;
+                return ptask;
             }
         }
-        return false;
+        return 0;
     }
-    void AbandonAllTask() 
+
+private:
+    void grow()
     {
-        Mutex::Locker guard(pTasksMutex);
-        for(unsigned i=0; i<Tasks.GetSize(); i++)
-            Tasks[i]->OnAbandon(true);
+        UPInt          oldSize = Items.GetSize();
+        ArrayPOD<Task*> items;
+        items.Resize(oldSize ? oldSize * 2 : 16);
+        for (unsigned i = 0; i < Count; i++)
+            items[i] = Items[(Head + i) & (oldSize - 1)];
+        Items = items;
+        Head = 0;
     }
-private:
-    Mutex*             pTasksMutex;
-    Array<Task*>    Tasks;
+
+    ArrayPOD<Task*>     Items;  // Size is a power of two.
+    unsigned            Head;
+    AtomicInt<unsigned> Count;
 };
 
-// ***** GFxThreadTaskManagerImpl
 
-// Threaded Task Manager is divided in two part to avoid circular dependences. 
-// a task can created another tasks and can hold a strong pointer to ThreadedTaskManager
-// a task thread also need task manager so it holds a strong pointer to ThreadedTaskManagerImpl
-class TaskThreadPool;
-class ThreadedTaskManagerImpl: public RefCountBase<ThreadedTaskManagerImpl, Stat_Default_Mem>
+// ***** TaskWorker
+
+// Worker thread slot of a TaskWorkerGroup, with its own queues of pending tasks.
+class TaskWorkerGroup;
+class TaskWorker : public NewOverrideBase<Stat_Default_Mem>
 {
 public:
-    ThreadedTaskManagerImpl();
-    ~ThreadedTaskManagerImpl();
-
-    bool               AddWorkerThreads(unsigned taskMask, unsigned count, UPInt stackSize, int processor = -1);
-    TasksContainer* GetRunningTasks () { return &RunningTasks; }
-    TaskThreadPool* GetThreadPool   ()   { return pThreadPool; }
-    bool               AbandonTask     (Task* ptask);
-
-    void               RequestShutdown ();
-private:
-    friend class TaskThreadPool;
-    Mutex             TasksMutex;
-    TasksContainer  RunningTasks;
-    TaskThreadPool* pThreadPool;
+    TaskWorker(TaskWorkerGroup* pgroup, unsigned index, bool temporary)
+        : pGroup(pgroup), Index(index), Temporary(temporary), Active(false), pRunning(0)
+    { }
+
+    TaskWorkerGroup*    pGroup;
+    unsigned            Index;
+    Ptr<Thread>         pThread;
+    // Temporary workers are added when the group stops making progress,
+    // and exit once they have been idle for a while.
+    bool                Temporary;
+    // Set while the slot's thread is running, modified under the IdleMutex 
+    // of the group.
+    volatile bool       Active;
+
+    // QueueLock protects Queues and pRunning. A task is moved from a queue
+    // to pRunning under the locks of both workers, taken in Index order.
+    Lock                QueueLock;
+    TaskRing            Queues[Task::Priority_Count];
+    Task*               pRunning;
 };
 
-// ***** TaskThread
 
-// an object of this class execute a tasks in a separate thread
-// upon task completion the thread object gets delete
+// ***** TaskWorkerGroup
 
-class TaskThread : public Thread
+// Group of workers serving the tasks that match its task mask. The worker
+// array has a fixed capacity, so that workers can be added while other
+// threads look for tasks to steal; slots are never removed.
+class ThreadedTaskManagerImpl;
+class TaskWorkerGroup : public NewOverrideBase<Stat_Default_Mem>
 {
 public:
-    TaskThread(Task* ptask, ThreadedTaskManagerImpl* ptm, UPInt stackSize = 128 * 1024, int processor = -1)
-        : Thread(stackSize,processor), pTask(ptask), pTaskManager(ptm)
-    { 
-    //    printf("TaskThread::TaskThread : %x, thread: %d\n", this, GetCurrentThreadId()); 
-    }
-    ~TaskThread();
+    enum { MaxWorkers = 64 };
 
-    virtual int  Run();
-protected:
-    Ptr<Task>                    pTask;
-    Ptr<ThreadedTaskManagerImpl> pTaskManager;
-};
+    TaskWorkerGroup(ThreadedTaskManagerImpl* ptm, unsigned taskMask, UPInt stackSize, int processor);
+    ~TaskWorkerGroup();
 
-// ***** TaskThreadInPool
+    unsigned    GetTaskMask() const { return TaskMask; }
 
-// objects of this call should be added into a thread pool. 
-// after tasks completion thread stays in the pool waiting 
-// for anther task
+    // Starts count permanent workers.
+    bool        AddWorkers(unsigned count);
+    // Called by the monitor; adds a temporary worker if all workers have been
+    // busy without completing a task for a while. Returns true if all workers
+    // are busy and tasks are pending, in which case it should be called again
+    // after StallCheckMs.
+    bool        CheckProgress();
 
-class TaskThreadInPool : public TaskThread
-{
-public:
-    TaskThreadInPool(unsigned taskMask, ThreadedTaskManagerImpl* ptm, UPInt stackSize = 128 * 1024, int processor = -1)
-       : TaskThread(0, ptm, stackSize, processor), TaskMask(taskMask)
-    {}
-    ~TaskThreadInPool() {}
-
-    bool         SetTask(Task* ptask);
-    virtual int  Run();
+    void        AddTask(Task* ptask);
+    bool        AbandonTask(Task* ptask);
+    void        RequestShutdown();
+    // Waits for the worker threads, except the calling one, to exit.
+    void        WaitWorkers();
 
-    unsigned     GetTaskType() const { return TaskMask; }
+    static int  WorkerThreadFn(Thread* pthread, void* h);
 
 private:
-    unsigned TaskMask;    
+    TaskWorker* getCurrentWorker() const;
+    Task*       findTask(TaskWorker* pworker);
+    void        runWorker(TaskWorker* pworker);
+    bool        startWorker(TaskWorker* pworker);
+    void        addTemporaryWorker();
+
+    ThreadedTaskManagerImpl*    pTaskManager;
+    unsigned                    TaskMask;
+    UPInt                       StackSize;
+    int                         Processor;
+
+    TaskWorker*                 Workers[MaxWorkers];
+    AtomicInt<unsigned>         WorkerCount;
+    // Round-robin counter used to distribute tasks added from other threads.
+    AtomicInt<unsigned>         NextWorker;
+
+    // Number of queued tasks per priority, and in total.
+    AtomicInt<int>              Pending[Task::Priority_Count];
+    AtomicInt<int>              PendingTotal;
+    AtomicInt<unsigned>         CompletedCount;
+
+    // Progress check state, only used by the monitor thread.
+    unsigned                    LastCompletedCount;
+    bool                        Busy;
+    // Number of checks to wait before adding the next temporary worker, 
+    // doubled each time one is added while the group stays stalled.
+    unsigned                    StallChecks;
+    unsigned                    StallLimit;
+
+    // Idle workers wait on IdleCondition.
+    Mutex                       IdleMutex;
+    WaitCondition               IdleCondition;
+    AtomicInt<int>              IdleWorkers;
+    volatile bool               ShutdownRequested;
 };
 
-// ***** TaskThreadPool
 
-// Threaded pool implementation
-class TaskThreadPool: public NewOverrideBase<Stat_Default_Mem>
+// ***** GFxThreadTaskManagerImpl
+
+// Threaded Task Manager is divided in two part to avoid circular dependences. 
+// a task can created another tasks and can hold a strong pointer to ThreadedTaskManager
+// a task thread also need task manager so it holds a strong pointer to ThreadedTaskManagerImpl
+class ThreadedTaskManagerImpl: public RefCountBase<ThreadedTaskManagerImpl, Stat_Default_Mem>
 {
 public:
-    TaskThreadPool(ThreadedTaskManagerImpl* ptm);
-    ~TaskThreadPool();
-
-    bool     AddTask      (Task* ptask);
-    bool     AbandonTask  (Task* ptask);
-    bool     AddThreads   (unsigned taskMask, unsigned count, UPInt stackSize, int processor = -1);
-    bool     RemoveThread (TaskThread*);
+    enum
+    {
+        // Interval of the progress checks while all workers of a group are 
+        // busy; the monitor sleeps otherwise.
+        StallCheckMs        = 20,
+        // Limit of the StallLimit backoff, in checks.
+        MaxStallChecks      = 16,
+        // Temporary workers exit after being idle for this long.
+        TemporaryIdleMs     = 2000
+    };
+
+    ThreadedTaskManagerImpl(UPInt stackSize, unsigned threadCount);
+    ~ThreadedTaskManagerImpl();
 
-    // adds a task's ref count and returns it from the tasks queue. 
-    // if there is no task in the queue waits on a condition variable until 
-    // queue is not empty. Returns 0 if shutdown is requested. 
-    Task* GetTaskAddRef(unsigned taskMask);
+    bool    AddWorkerThreads(unsigned taskMask, unsigned count, UPInt stackSize, int processor = -1);
+    bool    AddTask         (Task* ptask);
+    bool    AbandonTask     (Task* ptask);
+    void    RequestShutdown ();
 
-    // instruct the pool to stop accepting new task and send abandon signal 
-    // for all tasks (in the task queue and currently running)
-    void     RequestShutdown();
+    bool    IsShutdownRequested() const { return ShutdownRequested; }
+    // Called when tasks are pending while all workers of a group are busy.
+    void    WakeMonitor();
 
 private:
-    Task* FindTaskByMask(unsigned taskMask);
-
-    Array<Ptr<Task> >          TasksQueue;
-    Array<TaskThreadInPool*>    Threads;
-    Lock                           ThreadsLock;
-    WaitCondition                  TaskWaitCondition;
-    volatile bool                   ShutdownRequested;
-    ThreadedTaskManagerImpl*     pTaskManager;
+    TaskWorkerGroup*    findGroup(unsigned taskType);
+    void                startMonitor();
+    static int          monitorThreadFn(Thread* pthread, void* h);
+
+    UPInt                       DefaultStackSize;
+    unsigned                    DefaultThreadCount;
+
+    // Groups are only added, under GroupsLock.
+    Lock                        GroupsLock;
+    ArrayLH<TaskWorkerGroup*>   Groups;
+    TaskWorkerGroup*            pDefaultGroup;
+
+    Ptr<Thread>                 pMonitorThread;
+    Mutex                       MonitorMutex;
+    WaitCondition               MonitorCondition;
+    // Set while the monitor checks the groups periodically, 
+    // modified under MonitorMutex.
+    bool                        MonitorPolling;
+    volatile bool               ShutdownRequested;
 };
 
+
 /******************************************************************/
-ThreadedTaskManagerImpl::ThreadedTaskManagerImpl()
-    : RunningTasks(&TasksMutex), pThreadPool(0)
+TaskWorkerGroup::TaskWorkerGroup(ThreadedTaskManagerImpl* ptm, unsigned taskMask, 
+                                 UPInt stackSize, int processor)
+    : pTaskManager(ptm), TaskMask(taskMask), StackSize(stackSize), Processor(processor),
+      WorkerCount(0), NextWorker(0), PendingTotal(0), CompletedCount(0), 
+      LastCompletedCount(0), Busy(false), StallChecks(0), StallLimit(1),
+      IdleWorkers(0), ShutdownRequested(false)
 {
-    //printf("ThreadedTaskManagerImpl::ThreadedTaskManagerImpl : %x, thread : %d\n", this, GetCurrentThreadId());    
+    for (unsigned i = 0; i < Task::Priority_Count; i++)
+        Pending[i] = 0;
 }
 
-ThreadedTaskManagerImpl::~ThreadedTaskManagerImpl()
+TaskWorkerGroup::~TaskWorkerGroup()
 {
-    //printf("ThreadedTaskManagerImpl::~ThreadedTaskManagerImpl : %x, thread : %d\n", this,GetCurrentThreadId());
-    RunningTasks.AbandonAllTask();
-    delete pThreadPool;
+    for (unsigned i = 0; i < WorkerCount; i++)
+        delete Workers[i];
 }
 
-bool ThreadedTaskManagerImpl::AddWorkerThreads(unsigned taskMask, unsigned count, UPInt stackSize, int processor)
+bool TaskWorkerGroup::startWorker(TaskWorker* pworker)
 {
-    if (!pThreadPool)
-        pThreadPool = new TaskThreadPool(this);
-    return pThreadPool->AddThreads(taskMask,count,stackSize,processor);
+    // Each worker thread holds a reference to the task manager, so that the
+    // groups outlive their threads.
+    pTaskManager->AddRef();
+    pworker->Active  = true;
+    pworker->pThread = *new Thread(WorkerThreadFn, pworker, StackSize, Processor);
+    if (!pworker->pThread || !pworker->pThread->Start())
+    {
+        pworker->Active = false;
+        pTaskManager->Release();
+        return false;
+    }
+    pworker->pThread->SetThreadName(pworker->Temporary ? "Scaleform Temporary Task Worker" : 
+                                                         "Scaleform Task Worker");
+    return true;
 }
 
-void ThreadedTaskManagerImpl::RequestShutdown() 
-{ 
-    RunningTasks.AbandonAllTask();
-    if (pThreadPool) pThreadPool->RequestShutdown(); 
+bool TaskWorkerGroup::AddWorkers(unsigned count)
+{
+    Mutex::Locker lock(&IdleMutex);
+    while (count-- > 0)
+    {
+        if (WorkerCount >= (unsigned)MaxWorkers)
+            return false;
+        TaskWorker* pworker = new TaskWorker(this, WorkerCount, false);
+        if (!startWorker(pworker))
+        {
+            delete pworker;
+            return false;
+        }
+        // Publish the slot only after it is initialized.
+        Workers[WorkerCount] = pworker;
+        WorkerCount.ExchangeAdd_Sync(1);
+    }
+    return true;
 }
 
-bool ThreadedTaskManagerImpl::AbandonTask(Task* ptask)
+bool TaskWorkerGroup::CheckProgress()
 {
-    if (pThreadPool) 
-        return pThreadPool->AbandonTask(ptask);
-    return RunningTasks.AbandonTask(ptask);
+    unsigned completed  = CompletedCount;
+    bool     progressed = (completed != LastCompletedCount);
+    bool     wasBusy    = Busy;
+    LastCompletedCount  = completed;
+    Busy = !ShutdownRequested && PendingTotal > 0 && IdleWorkers <= 0;
+    if (!Busy || progressed)
+    {
+        StallChecks = 0;
+        StallLimit  = 1;
+        return Busy;
+    }
+
+    // All workers have been busy since the previous check and none of them 
+    // has finished a task; some of them are likely blocked waiting for queued
+    // tasks. Workers running long computations look the same, so the wait 
+    // before the next temporary worker grows while the group stays stalled.
+    if (!wasBusy || ++StallChecks < StallLimit)
+        return true;
+    StallChecks = 0;
+    if (StallLimit < (unsigned)ThreadedTaskManagerImpl::MaxStallChecks)
+        StallLimit *= 2;
+    addTemporaryWorker();
+    return true;
 }
 
-/******************************************************************/
-TaskThread::~TaskThread()
+void TaskWorkerGroup::addTemporaryWorker()
 {
-    //printf("TaskThread::TaskThread : %x, thread : %d\n", this, GetCurrentThreadId());
-    if (pTask)
+    Mutex::Locker lock(&IdleMutex);
+    TaskWorker* pworker = 0;
+    for (unsigned i = 0; i < WorkerCount; i++)
+    {
+        // Reuse the slot of an exited temporary worker.
+        if (Workers[i]->Temporary && !Workers[i]->Active && 
+            (!Workers[i]->pThread || Workers[i]->pThread->IsFinished()))
+        {
+            pworker = Workers[i];
+            break;
+        }
+    }
+    if (pworker)
+    {
+        startWorker(pworker);
+    }
+    else if (WorkerCount < (unsigned)MaxWorkers)
     {
-        pTask->OnAbandon(true);
-        pTaskManager->GetRunningTasks()->RemoveTask(pTask);
+        pworker = new TaskWorker(this, WorkerCount, true);
+        if (!startWorker(pworker))
+        {
+            delete pworker;
+            return;
+        }
+        Workers[WorkerCount] = pworker;
+        WorkerCount.ExchangeAdd_Sync(1);
     }
-    TaskThreadPool* pool = pTaskManager->GetThreadPool();
-    if (pool) pool->RemoveThread(this);
 }
 
-int  TaskThread::Run()
+TaskWorker* TaskWorkerGroup::getCurrentWorker() const
 {
-    SF_ASSERT(pTask);
-    if (pTask) 
+    // Only permanent workers queue tasks; the threads of temporary slots
+    // can be replaced by the monitor at any time.
+    ThreadId id = GetCurrentThreadId();
+    for (unsigned i = 0, n = WorkerCount; i < n; i++)
     {
-        //pTaskManager->GetRunningTasks()->AddTask(pTask);
-        pTask->Execute();        
-        pTaskManager->GetRunningTasks()->RemoveTask(pTask);
-        pTask = 0; // Release task's resources.
+        TaskWorker* pworker = Workers[i];
+        if (!pworker->Temporary && pworker->pThread && pworker->pThread->GetThreadId() == id)
+            return pworker;
     }
-    return 1;
+    return 0;
 }
 
-bool TaskThreadInPool::SetTask(Task* ptask) 
+void TaskWorkerGroup::AddTask(Task* ptask)
 {
-    SF_ASSERT(!pTask);
-    SF_ASSERT(ptask);
-    if (pTask) return false;
-    pTask = ptask;
-    return true;
+    unsigned priority = (unsigned)ptask->GetPriority();
+    SF_ASSERT(priority < (unsigned)Task::Priority_Count);
+
+    // Tasks added by a worker of this group are queued by it, since they 
+    // often work on the data it has just produced. Others are distributed
+    // between permanent workers.
+    TaskWorker* pworker = getCurrentWorker();
+    if (!pworker)
+    {
+        unsigned n = WorkerCount;
+        SF_ASSERT(n > 0);
+        unsigned start = NextWorker.ExchangeAdd_NoSync(1);
+        for (unsigned i = 0; i < n; i++)
+        {
+            TaskWorker* pcandidate = Workers[(start + i) % n];
+            if (!pcandidate->Temporary)
+            {
+                pworker = pcandidate;
+                break;
+            }
+        }
+    }
+
+    {
+        Lock::Locker guard(&pworker->QueueLock);
+        pworker->Queues[priority].PushBack(ptask);
+    }
+    // Counters are incremented once the task can be taken, so that workers 
+    // don't look for it before. Workers register in IdleWorkers before they
+    // check PendingTotal, so either the worker sees the task or it is notified.
+    Pending[priority].ExchangeAdd_Sync(1);
+    PendingTotal.ExchangeAdd_Sync(1);
+
+    if (IdleWorkers > 0)
+    {
+        Mutex::Locker lock(&IdleMutex);
+        IdleCondition.Notify();
+    }
+    else
+    {
+        pTaskManager->WakeMonitor();
+    }
 }
 
-int  TaskThreadInPool::Run()
-{   
-    Ptr<Task> ptask;
-    while ((ptask = *pTaskManager->GetThreadPool()->GetTaskAddRef(TaskMask)))
+bool TaskWorkerGroup::AbandonTask(Task* ptask)
+{
+    unsigned priority = (unsigned)ptask->GetPriority();
+    unsigned n        = WorkerCount;
+    unsigned i;
+    // All queues are locked, so that a task that is being moved from one 
+    // worker's queue to another's pRunning is found in one of them. Workers 
+    // added later can't take a task from the locked queues.
+    for (i = 0; i < n; i++)
+        Workers[i]->QueueLock.DoLock();
+
+    Task* premoved = 0;
+    bool  started  = false;
+    for (i = 0; i < n && !premoved; i++)
     {
-        SetTask(ptask);
-        TaskThread::Run();
-        ptask = 0; // if ptask is not release here it would lead to memory leak.
+        TaskWorker* pworker = Workers[i];
+        premoved = pworker->Queues[priority].Remove(ptask);
+        if (!premoved && pworker->pRunning == ptask)
+        {
+            // The task has already been started.
+            ptask->OnAbandon(true);
+            started = true;
+            break;
+        }
     }
-    return 1;
+
+    for (i = n; i > 0; i--)
+        Workers[i - 1]->QueueLock.Unlock();
+
+    if (premoved)
+    {
+        Pending[priority].ExchangeAdd_Sync(-1);
+        PendingTotal.ExchangeAdd_Sync(-1);
+        premoved->OnAbandon(false);
+        premoved->Finish(true);
+        premoved->Release();
+        return true;
+    }
+    return started;
 }
 
-/******************************************************************/
-TaskThreadPool::TaskThreadPool(ThreadedTaskManagerImpl* ptm) 
-    : ShutdownRequested(false), pTaskManager(ptm)
+void TaskWorkerGroup::RequestShutdown()
 {
-    SF_ASSERT(pTaskManager);
+    {
+        Mutex::Locker lock(&IdleMutex);
+        ShutdownRequested = true;
+        IdleCondition.NotifyAll();
+    }
+
+    // Abandon the queued tasks and notify the running ones.
+    for (unsigned i = 0, n = WorkerCount; i < n; i++)
+    {
+        TaskWorker* pworker = Workers[i];
+        for (unsigned priority = 0; priority < Task::Priority_Count; priority++)
+        {
+            Task* ptask;
+            while(1)
+            {
+                {
+                    Lock::Locker guard(&pworker->QueueLock);
+                    ptask = pworker->Queues[priority].PopFront();
+                }
+                if (!ptask)
+                    break;
+                Pending[priority].ExchangeAdd_Sync(-1);
+                PendingTotal.ExchangeAdd_Sync(-1);
+                ptask->OnAbandon(false);
+                ptask->Finish(true);
+                ptask->Release();
+            }
+        }
+        Lock::Locker guard(&pworker->QueueLock);
+        if (pworker->pRunning)
+            pworker->pRunning->OnAbandon(true);
+    }
 }
 
-TaskThreadPool::~TaskThreadPool() 
+void TaskWorkerGroup::WaitWorkers()
 {
-    RequestShutdown();
-    for (unsigned i=0; i<Threads.GetSize(); i++)
-        Threads[i]->Wait();
+    ThreadId currentId = GetCurrentThreadId();
+    for (unsigned i = 0, n = WorkerCount; i < n; i++)
+    {
+        Thread* pthread = Workers[i]->pThread;
+        if (pthread && pthread->GetThreadId() != currentId)
+            pthread->Wait();
+    }
 }
 
-bool TaskThreadPool::AddTask(Task* ptask) 
+Task* TaskWorkerGroup::findTask(TaskWorker* pworker)
 {
-    SF_ASSERT(ptask);
-    if (ShutdownRequested) 
-        return false;
+    unsigned n = WorkerCount;
+    for (int priority = Task::Priority_Count - 1; priority >= 0; priority--)
     {
-        Lock::Locker guard(&ThreadsLock);
-        unsigned i;
-        for (i=0; i<Threads.GetSize(); i++)
+        if (Pending[priority] <= 0)
+            continue;
+
+        // Newest task from our own queue first. The task becomes pRunning
+        // under the lock it is taken with, so that AbandonTask always finds it.
+        Task* ptask;
         {
-            if ((unsigned)ptask->GetTaskType() == Threads[i]->GetTaskType())
-                break;
+            Lock::Locker guard(&pworker->QueueLock);
+            ptask = pworker->Queues[priority].PopBack();
+            pworker->pRunning = ptask;
+        }
+        // Otherwise steal the oldest task of another worker, starting
+        // from a different victim for every worker.
+        unsigned start = pworker->Index + NextWorker;
+        for (unsigned i = 0; !ptask && i < n; i++)
+        {
+            TaskWorker* pvictim = Workers[(start + i) % n];
+            if (pvictim == pworker || pvictim->Queues[priority].GetCount() == 0)
+                continue;
+            bool        victimFirst = pvictim->Index < pworker->Index;
+            Lock::Locker guard1(victimFirst ? &pvictim->QueueLock : &pworker->QueueLock);
+            Lock::Locker guard2(victimFirst ? &pworker->QueueLock : &pvictim->QueueLock);
+            ptask = pvictim->Queues[priority].PopFront();
+            pworker->pRunning = ptask;
+        }
+
+        if (ptask)
+        {
+            Pending[priority].ExchangeAdd_Sync(-1);
+            PendingTotal.ExchangeAdd_Sync(-1);
+            return ptask;
         }
-        SF_DEBUG_ERROR(i == Threads.GetSize(), "There is no a thread in thread pool which can process a given task");
-        if (i == Threads.GetSize())
-            return false;
     }
-    Mutex::Locker guard(&pTaskManager->TasksMutex);
-    TasksQueue.PushBack(ptask);
-    TaskWaitCondition.NotifyAll();
-    return true;
+    return 0;
+}
+
+void TaskWorkerGroup::runWorker(TaskWorker* pworker)
+{
+    while (!ShutdownRequested)
+    {
+        Task* ptask = findTask(pworker);
+        if (ptask)
+        {
+            // The group may become busy when an idle worker takes a task 
+            // rather than when one is added; let the monitor know in case
+            // this task blocks.
+            if (PendingTotal > 0 && IdleWorkers <= 0)
+                pTaskManager->WakeMonitor();
+            // findTask has set pRunning.
+            ptask->CurrentState = Task::State_Running;
+            ptask->Execute();
+            {
+                Lock::Locker guard(&pworker->QueueLock);
+                pworker->pRunning = 0;
+            }
+            ptask->Finish(false);
+            ptask->Release();
+            CompletedCount.ExchangeAdd_NoSync(1);
+            continue;
+        }
+
+        // Nothing to do; sleep until a task is added.
+        Mutex::Locker lock(&IdleMutex);
+        IdleWorkers.ExchangeAdd_Sync(1);
+        if (!ShutdownRequested && PendingTotal <= 0)
+        {
+            bool notified = IdleCondition.Wait(&IdleMutex, pworker->Temporary ? 
+                (unsigned)ThreadedTaskManagerImpl::TemporaryIdleMs : SF_WAIT_INFINITE);
+            if (!notified && pworker->Temporary && PendingTotal <= 0)
+            {
+                IdleWorkers.ExchangeAdd_Sync(-1);
+                pworker->Active = false;
+                return;
+            }
+        }
+        IdleWorkers.ExchangeAdd_Sync(-1);
+    }
+
+    Mutex::Locker lock(&IdleMutex);
+    pworker->Active = false;
 }
 
+int TaskWorkerGroup::WorkerThreadFn(Thread*, void* h)
+{
+    TaskWorker*              pworker = (TaskWorker*)h;
+    ThreadedTaskManagerImpl* ptm     = pworker->pGroup->pTaskManager;
+    pworker->pGroup->runWorker(pworker);
+    // This may destroy the task manager along with the worker.
+    ptm->Release();
+    return 0;
+}
 
-bool TaskThreadPool::AddThreads(unsigned taskMask, unsigned count, UPInt stackSize, int processor)
+/******************************************************************/
+ThreadedTaskManagerImpl::ThreadedTaskManagerImpl(UPInt stackSize, unsigned threadCount)
+    : DefaultStackSize(stackSize), DefaultThreadCount(threadCount), pDefaultGroup(0),
+      MonitorPolling(false), ShutdownRequested(false)
 {
-    if (ShutdownRequested)
-        return false;
-    // TODO: it may be useful to check and give an warring if stackSize is deferent from the one
-    // that has already been set for threads with a given taskMask
-    Lock::Locker guard(&ThreadsLock);
-    while (count-- > 0)
+    if (DefaultThreadCount == 0)
+        DefaultThreadCount = (unsigned)Alg::Max(2, Thread::GetCPUCount());
+}
+
+ThreadedTaskManagerImpl::~ThreadedTaskManagerImpl()
+{
+    RequestShutdown();
+    if (pMonitorThread && pMonitorThread->GetThreadId() != GetCurrentThreadId())
+        pMonitorThread->Wait();
+    for (UPInt i = 0; i < Groups.GetSize(); i++)
+        Groups[i]->WaitWorkers();
+    for (UPInt i = 0; i < Groups.GetSize(); i++)
+        delete Groups[i];
+}
+
+void ThreadedTaskManagerImpl::startMonitor()
+{
+    // Called under GroupsLock.
+    if (pMonitorThread)
+        return;
+    AddRef();
+    pMonitorThread = *new Thread(monitorThreadFn, this);
+    if (!pMonitorThread || !pMonitorThread->Start())
     {
-        Ptr<TaskThreadInPool> thread = *new TaskThreadInPool(taskMask, pTaskManager, stackSize, processor);
-        thread->Start();
-        Threads.PushBack(thread);
+        pMonitorThread = 0;
+        Release();
+        return;
     }
-    return true;
+    pMonitorThread->SetThreadName("Scaleform Task Monitor");
 }
-bool TaskThreadPool::RemoveThread(TaskThread* thread)
+
+int ThreadedTaskManagerImpl::monitorThreadFn(Thread*, void* h)
 {
-    Lock::Locker guard(&ThreadsLock);
-    for (unsigned i=0; i<Threads.GetSize(); i++)
+    ThreadedTaskManagerImpl* ptm = (ThreadedTaskManagerImpl*)h;
     {
-        if (Threads[i] == thread) 
+        // Checks the groups every StallCheckMs while all workers of one of 
+        // them are busy, and sleeps until WakeMonitor otherwise. Groups are
+        // checked before waiting, so that wake-ups that came before the wait
+        // are not lost.
+        Mutex::Locker lock(&ptm->MonitorMutex);
+        while (!ptm->ShutdownRequested)
         {
-            Threads.RemoveAt(i);
-            return true;
+            bool busy = false;
+            {
+                Lock::Locker guard(&ptm->GroupsLock);
+                for (UPInt i = 0; i < ptm->Groups.GetSize(); i++)
+                {
+                    if (ptm->Groups[i]->CheckProgress())
+                        busy = true;
+                }
+            }
+            ptm->MonitorPolling = busy;
+            ptm->MonitorCondition.Wait(&ptm->MonitorMutex, 
+                busy ? (unsigned)StallCheckMs : SF_WAIT_INFINITE);
         }
     }
-    return false;
+    ptm->Release();
+    return 0;
 }
 
-Task* TaskThreadPool::GetTaskAddRef(unsigned taskMask)
+void ThreadedTaskManagerImpl::WakeMonitor()
 {
-    if (ShutdownRequested)
-        return 0;
-    Mutex::Locker guard(&pTaskManager->TasksMutex);
-    Task* ptask = 0;
-    while (!ShutdownRequested && (ptask = FindTaskByMask(taskMask)) == 0)
-        TaskWaitCondition.Wait(&pTaskManager->TasksMutex);
-    if (ptask)
-        pTaskManager->GetRunningTasks()->AddTask(ptask);
-    return ptask;
+    // While polling, the monitor doesn't need to be woken; early wake-ups
+    // would also shorten the stall checks.
+    Mutex::Locker lock(&MonitorMutex);
+    if (!MonitorPolling)
+        MonitorCondition.Notify();
 }
 
-Task* TaskThreadPool::FindTaskByMask(unsigned taskMask)
+bool ThreadedTaskManagerImpl::AddWorkerThreads(unsigned taskMask, unsigned count, UPInt stackSize, int processor)
 {
-    Task *ptask = 0;
-    for (unsigned i=0; i<TasksQueue.GetSize(); i++)
+    if (ShutdownRequested)
+        return false;
+    Lock::Locker guard(&GroupsLock);
+    TaskWorkerGroup* pgroup = 0;
+    for (UPInt i = 0; i < Groups.GetSize(); i++)
     {
-        if (TasksQueue[i]->GetTaskType() & taskMask)
+        if (Groups[i]->GetTaskMask() == taskMask && Groups[i] != pDefaultGroup)
         {
-            ptask = TasksQueue[i];
-            ptask->AddRef();
-            TasksQueue.RemoveAt(i);
+            pgroup = Groups[i];
             break;
         }
     }
-    return ptask;
+    if (!pgroup)
+    {
+        pgroup = new TaskWorkerGroup(this, taskMask, stackSize, processor);
+        // Dedicated groups are searched before the default one.
+        Groups.InsertAt(0, pgroup);
+    }
+    startMonitor();
+    return pgroup->AddWorkers(count);
 }
 
-void TaskThreadPool::RequestShutdown() 
-{ 
-    Mutex::Locker guard(&pTaskManager->TasksMutex);
+TaskWorkerGroup* ThreadedTaskManagerImpl::findGroup(unsigned taskType)
+{
+    Lock::Locker guard(&GroupsLock);
+    for (UPInt i = 0; i < Groups.GetSize(); i++)
+    {
+        if (Groups[i]->GetTaskMask() & taskType)
+            return Groups[i];
+    }
+    if (!pDefaultGroup)
+    {
+        pDefaultGroup = new TaskWorkerGroup(this, Task::Type_Mask, DefaultStackSize, -1);
+        if (!pDefaultGroup->AddWorkers(DefaultThreadCount) && !pDefaultGroup->AddWorkers(1))
+        {
+            delete pDefaultGroup;
+            pDefaultGroup = 0;
+            return 0;
+        }
+        Groups.PushBack(pDefaultGroup);
+        startMonitor();
+    }
+    return pDefaultGroup;
+}
+
+bool ThreadedTaskManagerImpl::AddTask(Task* ptask)
+{
     if (ShutdownRequested)
-        return;
-    ShutdownRequested = true;
-    for (unsigned i=0; i<TasksQueue.GetSize(); i++)
-        TasksQueue[i]->OnAbandon(false);
-    TasksQueue.Clear();
-    TaskWaitCondition.NotifyAll();
+        return false;
+    TaskWorkerGroup* pgroup = findGroup((unsigned)ptask->GetTaskType());
+    if (!pgroup)
+        return false;
+    ptask->CurrentState = Task::State_Pending;
+    pgroup->AddTask(ptask);
+    return true;
 }
 
-bool TaskThreadPool::AbandonTask(Task* ptask)
+bool ThreadedTaskManagerImpl::AbandonTask(Task* ptask)
 {
-    SF_ASSERT(ptask);
-    if (!ptask) return false;
-    Mutex::Locker guard(&pTaskManager->TasksMutex);
-    //fist check in the task queue
-    for (unsigned i=0; i<TasksQueue.GetSize(); i++)
+    Lock::Locker guard(&GroupsLock);
+    for (UPInt i = 0; i < Groups.GetSize(); i++)
     {
-        if (TasksQueue[i] == ptask)
-        {
-            TasksQueue[i]->OnAbandon(false);
-            TasksQueue.RemoveAt(i);
+        if (Groups[i]->AbandonTask(ptask))
             return true;
-        }
     }
-    // if did not find there try running tasks
-    return pTaskManager->GetRunningTasks()->AbandonTask(ptask);
+    return false;
+}
+
+void ThreadedTaskManagerImpl::RequestShutdown() 
+{ 
+    {
+        Mutex::Locker lock(&MonitorMutex);
+        if (ShutdownRequested)
+            return;
+        ShutdownRequested = true;
+        MonitorCondition.NotifyAll();
+    }
+    Lock::Locker guard(&GroupsLock);
+    for (UPInt i = 0; i < Groups.GetSize(); i++)
+        Groups[i]->RequestShutdown();
 }
 
 
 /******************************************************************/
-ThreadedTaskManager::ThreadedTaskManager(UPInt stackSize) 
-    : ThreadStackSize(stackSize)
+ThreadedTaskManager::ThreadedTaskManager(UPInt stackSize, unsigned threadCount) 
 {
-    //printf("ThreadedTaskManager::ThreadedTaskManager : %x, thread: %d\n", this, GetCurrentThreadId());
-    pImpl = new ThreadedTaskManagerImpl;
+    pImpl = new ThreadedTaskManagerImpl(stackSize, threadCount);
 }
 
 ThreadedTaskManager::~ThreadedTaskManager()
 {
-    //printf("ThreadedTaskManager::~ThreadedTaskManager : %x, thread: %d\n", this, GetCurrentThreadId());
     if (pImpl) 
     {
         pImpl->RequestShutdown();
@@ -431,23 +850,13 @@ bool ThreadedTaskManager::AddTask(Task* ptask)
 {    
     SF_ASSERT(ptask != 0);
     if (!ptask) return false;
-    TaskThreadPool* pthreadPool = pImpl->GetThreadPool();
-    if (pthreadPool && pthreadPool->AddTask(ptask)) 
-        return true;
-    
-    Ptr<TaskThread> ptaskThread = *new TaskThread(ptask, pImpl, ThreadStackSize);
-    if (ptaskThread)
-    {        
-        pImpl->GetRunningTasks()->AddTask(ptask);
-        ptaskThread->Start();
-        // Thread will release itself once the task is finished.
-        return true;
-    }
-    return false;
+    return pImpl->AddTask(ptask);
 }
 
 bool ThreadedTaskManager::AbandonTask(Task* ptask)
 {
+    SF_ASSERT(ptask != 0);
+    if (!ptask) return false;
     return pImpl->AbandonTask(ptask);
 }
 
@@ -460,6 +869,6 @@ void ThreadedTaskManager::RequestShutdown()
     pImpl->RequestShutdown();
 }
 
-}} // namespace Scaleform { namespace GFx {
+#endif // SF_ENABLE_THREADS
 
-#endif
+}} // namespace Scaleform { namespace GFx {
@@ -22,6 +22,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 
 #include "Kernel/SF_Types.h"
 #include "Kernel/SF_RefCount.h"
+#include "Kernel/SF_Atomic.h"
 // Include loader because task manager is a state.
 #include "GFx/GFx_Loader.h"
 
@@ -36,6 +37,10 @@ namespace Scaleform { namespace GFx {
 // point they become pending execution. Task objects will be AddRefed
 // by the task manager and then by the container thread; once the task
 // has completed it will be released.
+//
+// A task can be made a child of another task with SetParent. A task is
+// completed once it has finished (or was abandoned before it started) and
+// all of its children have completed; OnComplete is called at that point.
 
 class Task : public RefCountBase<Task, Stat_Default_Mem>
 {
@@ -78,24 +83,61 @@ public:
         State_Finished,
     };
 
+    // Pending tasks with higher priority are started first. The default
+    // priority is derived from the task id by GetDefaultPriority.
+    enum TaskPriority
+    {
+        Priority_Low,       // Background work, such as font rasterization.
+        Priority_Normal,    // Resource decoding, such as image loading.
+        Priority_High,      // Loading a movie needs to display its first frame.
+        Priority_Count
+    };
+
 
 protected:
+    // Task managers update CurrentState as the task is queued and run.
+    friend class TaskWorkerGroup;
+    friend class ThreadedTaskManagerImpl;
+
     TaskId               ThisTaskId;
     volatile TaskState   CurrentState;
+    TaskPriority         Priority;
+    // Parent task, AddRefed until this task completes.
+    Task*                pParent;
+    // Number of parts of this task that have not completed yet: 
+    // the task itself and each of its children.
+    AtomicInt<int>       PendingParts;
 public:
 
     // Creates a task initializing it with the correct id.
     Task(TaskId id = Id_Unknown)
-        : ThisTaskId(id), CurrentState(State_Idle)
+        : ThisTaskId(id), CurrentState(State_Idle), Priority(GetDefaultPriority(id)),
+          pParent(0), PendingParts(1)
     { }
 
-    virtual ~Task() { }
+    virtual ~Task();
     
     // Obtains Id describing this task.    
     inline TaskId      GetTaskId() const    { return ThisTaskId; }
     inline TaskType    GetTaskType() const  { return (TaskType)(GetTaskId() & Type_Mask); }
     inline TaskState   GetTaskState() const { return CurrentState; }
 
+    inline TaskPriority GetPriority() const { return Priority; }
+    // Priority should be changed before the task is added to a task manager.
+    inline void        SetPriority(TaskPriority priority) { Priority = priority; }
+    static TaskPriority GetDefaultPriority(TaskId id);
+
+    // Makes this task a child of pparent. Must be called before this task is
+    // added to a task manager, and before pparent has finished.
+    void               SetParent(Task* pparent);
+    inline Task*       GetParent() const    { return pParent; }
+    // Returns true once this task and all of its children have completed.
+    inline bool        IsCompleted() const  { return PendingParts == 0; }
+
+    // Called by task managers after Execute returns, or when the task is
+    // abandoned before it was started.
+    void               Finish(bool abandoned);
+
 
     // *** Task Virual Overrides
 
@@ -111,6 +153,14 @@ public:
     //  - If the task was started, it can choose to either follow a
     //    custom cancel work protocol, or just run to completion.
     virtual void    OnAbandon(bool started) { SF_UNUSED(started); }
+
+    // Override OnComplete to be notified when this task and all of its
+    // children have completed. It is called on the thread that completed
+    // the last of them.
+    virtual void    OnComplete() { }
+
+private:
+    void            releasePart();
 };
 
 
@@ -164,26 +214,33 @@ inline  Ptr<TaskManager> StateBag::GetTaskManager() const
 
 // ***** GFxThreadTaskManager
 
-// Implementation of TaskManager interface based on thread pool
-// Worker threads for a particular task type can be add by call to AddWorkerThreads
-// method. 
-// Then a task is added to the task manager:
-//   1. if no worker threads with a given task type were added to the manager then 
-//      a new temporary thread is created for running only this task. 
-//   2. if there are worker nodes for a give task in the thread pool but all of them
-//      are busy with running other tasks then this task will be added to the task queue
+// Implementation of TaskManager interface based on a work-stealing thread pool.
+// Worker threads are organized in groups, each serving the task types in its
+// task mask. Groups for particular task types can be added by calls to
+// AddWorkerThreads; tasks that match none of them are executed by a default
+// group of threadCount workers created on first use.
+//
+// Every worker has its own queue of pending tasks, one per task priority.
+// Tasks added from a worker thread go to its own queue, other tasks are
+// distributed between the workers of the group. Workers take the newest task
+// from their own queue and steal the oldest task from the other workers when
+// they run out, always taking the highest priority task available.
+//
+// Loading tasks can block waiting for other tasks. If all workers of a group
+// are busy and no task completes for a while, a temporary worker is added to
+// the group; it exits once it has been idle for a while.
 
 class ThreadedTaskManagerImpl;
 class ThreadedTaskManager : public TaskManager
 {
 public:
-    // Constructs a task manager and specifies thread
-    // stack size required for each task.
-    ThreadedTaskManager(UPInt stackSize = 128 * 1024);    
+    // Constructs a task manager and specifies thread stack size and number of
+    // workers in the default group; threadCount of 0 creates one per CPU.
+    ThreadedTaskManager(UPInt stackSize = 128 * 1024, unsigned threadCount = 0);    
     ~ThreadedTaskManager();
 
-    // Adds a specified number of worker threads working on a given processor.
-    // If this is not called, threads will be created for each task.
+    // Adds a specified number of worker threads working on a given processor,
+    // serving tasks whose type matches taskMask.
     bool AddWorkerThreads(unsigned taskMask, unsigned count, 
                           UPInt stackSize = 128 * 1024, int processor = -1);
 
@@ -194,7 +251,6 @@ public:
 
 private:
     ThreadedTaskManagerImpl*    pImpl;
-    UPInt                       ThreadStackSize;
 };
 
 #endif // SF_ENABLE_THREADS
@@ -20,6 +20,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "HeapPT_AllocEngine.h"
 #include "HeapPT_DebugInfo.h"
 #include "HeapPT_MemoryHeap.h"
+#include "HeapPT_ThreadCache.h"
 #include "../SF_Debug.h"
 #include "../SF_Memory.h"
 
@@ -149,6 +150,9 @@ bool MemoryHeap::ReleaseRootHeapPT() // static
         SF_HEAP_ASSERT(0);
         return true;
     }
+#ifdef SF_HEAP_THREAD_CACHE
+    HeapPT::ThreadCache::ReleaseAll();
+#endif
     LockSafe::Locker locker(HeapPT::GlobalRoot->GetLock());
     if (Memory::pGlobalHeap == 0)
     {
@@ -164,7 +168,7 @@ bool MemoryHeap::ReleaseRootHeapPT() // static
 
 
 //------------------------------------------------------------------------
-MemoryHeapPT::MemoryHeapPT() : MemoryHeap(), pEngine(0), pDebugStorage(0)
+MemoryHeapPT::MemoryHeapPT() : MemoryHeap(), pEngine(0), pDebugStorage(0), UseThreadCache(false)
 {
 }
 
@@ -610,6 +614,14 @@ void* MemoryHeapPT::Alloc(UPInt size, const AllocInfo* info)
     SF_UNUSED(info);
     return gSysAlloc.Alloc(size, 8);
 #else
+#ifdef SF_HEAP_THREAD_CACHE
+    if (UseThreadCache)
+    {
+        void* ptr = HeapPT::ThreadCache::Alloc(this, size);
+        if (ptr)
+            return ptr;
+    }
+#endif
     if (UseLocks)
     {
         Lock::Locker locker(&HeapLock);
@@ -692,6 +704,13 @@ void  MemoryHeapPT::Free(void* ptr)
         SF_HEAP_ASSERT(seg && seg->pHeap);
         MemoryHeapPT* heap = seg->pHeap;
 
+#ifdef SF_HEAP_THREAD_CACHE
+        if (heap->UseThreadCache && ptr != heap->pAutoRelease &&
+            HeapPT::ThreadCache::Free(heap, seg, ptr))
+        {
+            return;
+        }
+#endif
         if (heap->UseLocks)
         {
             {
@@ -756,6 +775,14 @@ void* MemoryHeapPT::AllocAutoHeap(const void *thisPtr, UPInt size,
     HeapSegment* seg = HeapPT::GlobalPageTable->GetSegment(UPInt(thisPtr));
     SF_HEAP_ASSERT(seg && seg->pHeap);
     MemoryHeapPT* heap = seg->pHeap;
+#ifdef SF_HEAP_THREAD_CACHE
+    if (heap->UseThreadCache)
+    {
+        void* ptr = HeapPT::ThreadCache::Alloc(heap, size);
+        if (ptr)
+            return ptr;
+    }
+#endif
     if (heap->UseLocks)
     {
         Lock::Locker locker(&heap->HeapLock);
@@ -844,6 +871,12 @@ void MemoryHeapPT::releaseCachedMem()
         heap->releaseCachedMem();
         heap = heap->pNext;
     }
+#ifdef SF_HEAP_THREAD_CACHE
+    // Only the blocks of the calling thread can be returned; other
+    // threads return theirs when they exit.
+    if (UseThreadCache)
+        HeapPT::ThreadCache::Flush(this);
+#endif
     pEngine->ReleaseCachedMem();
 }
 
@@ -26,6 +26,7 @@ namespace HeapPT
     class  HeapRoot;
     class  AllocEngine;
     class  DebugStorage;
+    class  ThreadCache;
 }
 
 namespace Heap
@@ -43,6 +44,7 @@ class MemoryHeapPT : public MemoryHeap
 private:
     friend class HeapPT::HeapRoot;
     friend class HeapMH::RootMH;
+    friend class HeapPT::ThreadCache;
 
     MemoryHeapPT();  // Explicit creation and destruction is prohibited
     virtual ~MemoryHeapPT() {}
@@ -126,6 +128,7 @@ private:
     //--------------------------------------------------------------------
     HeapPT::AllocEngine*  pEngine;
     HeapPT::DebugStorage* pDebugStorage;
+    bool                  UseThreadCache;
 };
 
 } // Scaleform
@@ -18,6 +18,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "HeapPT_Root.h"
 #include "HeapPT_DebugInfo.h"
 #include "HeapPT_AllocEngine.h"
+#include "HeapPT_ThreadCache.h"
 
 namespace Scaleform { namespace HeapPT {
 
@@ -461,6 +462,10 @@ MemoryHeapPT* HeapRoot::CreateHeap(const char* name,
                                      debugStorageSize;
     heap->UseLocks          = (desc.Flags & MemoryHeap::Heap_ThreadUnsafe) == 0;
     heap->TrackDebugInfo    = (desc.Flags & MemoryHeap::Heap_NoDebugInfo)  == 0;
+#ifdef SF_HEAP_THREAD_CACHE
+    heap->UseThreadCache    = parent == 0 && heap->UseLocks &&
+                              (desc.Flags & MemoryHeap::Heap_ThreadCache) != 0;
+#endif
     heap->pEngine           = engine;
 
 #ifdef SF_MEMORY_ENABLE_DEBUG_INFO
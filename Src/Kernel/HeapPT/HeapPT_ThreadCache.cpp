@@ -0,0 +1,203 @@
+/**************************************************************************
+
+Filename    :   HeapPT_ThreadCache.cpp
+Content     :   Per-thread cache of small blocks for the root heap
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "HeapPT_ThreadCache.h"
+#include "HeapPT_Root.h"
+#include "HeapPT_AllocEngine.h"
+#include "HeapPT_MemoryHeap.h"
+
+#include <string.h>
+
+namespace Scaleform {
+
+//------------------------------------------------------------------------
+void MemoryHeap::ReleaseThreadCache() // static
+{
+#ifdef SF_HEAP_THREAD_CACHE
+    HeapPT::ThreadCache::ReleaseCurrent();
+#endif
+}
+
+namespace HeapPT {
+
+#ifdef SF_HEAP_THREAD_CACHE
+
+// The cache of the calling thread. It is only valid if CurrentGeneration
+// matches CacheGeneration, which ReleaseAll increments to invalidate
+// the caches of all threads at once.
+static SF_HEAP_THREAD_LOCAL ThreadCache*    pCurrentCache     = 0;
+static SF_HEAP_THREAD_LOCAL unsigned        CurrentGeneration = 0;
+// Set once the thread has released its cache. Blocks freed or allocated
+// by the thread after that, such as during Thread cleanup, bypass the cache,
+// since a new one would not be released until the heap is.
+static SF_HEAP_THREAD_LOCAL bool            CacheReleased     = false;
+static unsigned                             CacheGeneration   = 1;
+
+// All the caches, linked under GlobalRoot->GetLock().
+static ThreadCache*                         pFirstCache       = 0;
+
+//------------------------------------------------------------------------
+inline ThreadCache* ThreadCache::getCache(MemoryHeapPT* heap)
+{
+    ThreadCache* cache = pCurrentCache;
+    if (cache && CurrentGeneration == CacheGeneration)
+    {
+        SF_HEAP_ASSERT(cache->pHeap == heap);
+        return cache;
+    }
+    if (CacheReleased)
+        return 0;
+    return createCache(heap);
+}
+
+//------------------------------------------------------------------------
+ThreadCache* ThreadCache::createCache(MemoryHeapPT* heap)
+{
+    LockSafe::Locker lock(GlobalRoot->GetLock());
+    ThreadCache* cache = (ThreadCache*)GlobalRoot->GetBookkeeper()->Alloc(sizeof(ThreadCache));
+    if (cache)
+    {
+        memset(cache, 0, sizeof(ThreadCache));
+        cache->pHeap = heap;
+        cache->pNext = pFirstCache;
+        if (pFirstCache)
+            pFirstCache->pPrev = cache;
+        pFirstCache = cache;
+    }
+    pCurrentCache     = cache;
+    CurrentGeneration = CacheGeneration;
+    return cache;
+}
+
+//------------------------------------------------------------------------
+void ThreadCache::destroyCache(ThreadCache* cache)
+{
+    // Locked by Root::Lock in the caller.
+    if (cache->pPrev)
+        cache->pPrev->pNext = cache->pNext;
+    else
+        pFirstCache = cache->pNext;
+    if (cache->pNext)
+        cache->pNext->pPrev = cache->pPrev;
+    GlobalRoot->GetBookkeeper()->Free(cache, sizeof(ThreadCache));
+}
+
+//------------------------------------------------------------------------
+void ThreadCache::freeBlocks()
+{
+    // Locked by the heap lock in the caller.
+    for (unsigned i = 0; i < ClassCount; ++i)
+    {
+        Magazine& m = Classes[i];
+        while (m.Count)
+            pHeap->pEngine->Free(m.Blocks[--m.Count]);
+    }
+}
+
+//------------------------------------------------------------------------
+void* ThreadCache::Alloc(MemoryHeapPT* heap, UPInt size)
+{
+    if (size > MaxSize)
+        return 0;
+    ThreadCache* cache = getCache(heap);
+    if (cache == 0)
+        return 0;
+
+    UPInt     sizeClass = size ? (size - 1) >> SizeShift : 0;
+    Magazine& m         = cache->Classes[sizeClass];
+    if (m.Count)
+        return m.Blocks[--m.Count];
+
+    // Refill the magazine with blocks of the largest size of the class.
+    UPInt blockSize = (sizeClass + 1) << SizeShift;
+    Lock::Locker locker(&heap->HeapLock);
+    while (m.Count < BatchSize)
+    {
+        void* ptr = heap->pEngine->Alloc(blockSize);
+        if (ptr == 0)
+            break;
+        m.Blocks[m.Count++] = ptr;
+    }
+    return m.Count ? m.Blocks[--m.Count] : 0;
+}
+
+//------------------------------------------------------------------------
+bool ThreadCache::Free(MemoryHeapPT* heap, HeapSegment* seg, void* ptr)
+{
+    // The size of an allocated block is only changed by its owner, so
+    // it can be read without the heap lock. Blocks bigger than their 
+    // size class are cached in the class they fully cover.
+    UPInt size = heap->pEngine->GetUsableSize(seg, ptr);
+    if (size < (UPInt(1) << SizeShift) || size > MaxSize)
+        return false;
+    ThreadCache* cache = getCache(heap);
+    if (cache == 0)
+        return false;
+
+    Magazine& m = cache->Classes[(size >> SizeShift) - 1];
+    if (m.Count == MagazineSize)
+    {
+        Lock::Locker locker(&heap->HeapLock);
+        for (unsigned i = 0; i < BatchSize; ++i)
+            heap->pEngine->Free(m.Blocks[--m.Count]);
+    }
+    m.Blocks[m.Count++] = ptr;
+    return true;
+}
+
+//------------------------------------------------------------------------
+void ThreadCache::Flush(MemoryHeapPT* heap)
+{
+    ThreadCache* cache = pCurrentCache;
+    if (cache && CurrentGeneration == CacheGeneration && cache->pHeap == heap)
+        cache->freeBlocks();
+}
+
+//------------------------------------------------------------------------
+void ThreadCache::ReleaseCurrent()
+{
+    ThreadCache* cache = pCurrentCache;
+    pCurrentCache = 0;
+    CacheReleased = true;
+    if (cache == 0 || CurrentGeneration != CacheGeneration)
+        return;
+    {
+        Lock::Locker locker(&cache->pHeap->HeapLock);
+        cache->freeBlocks();
+    }
+    LockSafe::Locker lock(GlobalRoot->GetLock());
+    destroyCache(cache);
+}
+
+//------------------------------------------------------------------------
+void ThreadCache::ReleaseAll()
+{
+    LockSafe::Locker lock(GlobalRoot->GetLock());
+    while (pFirstCache)
+    {
+        ThreadCache* cache = pFirstCache;
+        {
+            Lock::Locker locker(&cache->pHeap->HeapLock);
+            cache->freeBlocks();
+        }
+        destroyCache(cache);
+    }
+    CacheGeneration++;
+    pCurrentCache = 0;
+}
+
+#endif // SF_HEAP_THREAD_CACHE
+
+}} // Scaleform::HeapPT
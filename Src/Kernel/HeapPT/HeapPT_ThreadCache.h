@@ -0,0 +1,121 @@
+/**************************************************************************
+
+Filename    :   HeapPT_ThreadCache.h
+Content     :   Per-thread cache of small blocks for the root heap
+Created     :
+Authors     :
+
+Notes       :   Enabled with SF_MEMORY_ENABLE_THREAD_CACHE and the
+                Heap_ThreadCache flag of the root heap descriptor.
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Kernel_HeapPT_ThreadCache_H
+#define INC_SF_Kernel_HeapPT_ThreadCache_H
+
+#include "../SF_Types.h"
+
+// The thread cache needs compiler-supported thread local storage. It is 
+// disabled when every allocation must go through the heap, to be tracked
+// or filled.
+#if defined(SF_MEMORY_ENABLE_THREAD_CACHE) && defined(SF_ENABLE_THREADS) && \
+    !defined(SF_MEMORY_ENABLE_DEBUG_INFO) && !defined(SF_MEMORY_TRACE_ALL) && \
+    !defined(SF_MEMORY_MEMSET_ALL) && \
+    !defined(SF_MEMORY_FORCE_MALLOC) && !defined(SF_MEMORY_FORCE_SYSALLOC)
+#if defined(SF_CC_MSVC)
+#define SF_HEAP_THREAD_LOCAL __declspec(thread)
+#elif defined(SF_CC_GNU) || defined(SF_CC_CLANG) || defined(SF_CC_SNC)
+#define SF_HEAP_THREAD_LOCAL __thread
+#endif
+#endif
+
+#ifdef SF_HEAP_THREAD_LOCAL
+#define SF_HEAP_THREAD_CACHE
+#endif
+
+namespace Scaleform {
+
+class MemoryHeapPT;
+namespace Heap { struct HeapSegment; }
+
+namespace HeapPT {
+
+// ***** ThreadCache
+//
+// Keeps small blocks freed by a thread in magazines, one per size class,
+// and reuses them for the allocations of the same thread without taking
+// the heap lock. Empty magazines are refilled from the AllocEngine and 
+// full ones are returned to it BatchSize blocks at a time, so the heap 
+// lock is taken once per batch instead of once per block.
+//
+// Only the root heap is cached. It is destroyed after all the threads have
+// exited, so cached blocks never outlive their heap; the cache of a thread
+// belongs to it alone and is accessed without locks. Blocks cached by
+// a thread remain allocated from the heap point of view until the thread
+// calls MemoryHeap::ReleaseThreadCache, which Thread does on exit; the
+// thread allocates from the heap directly after that.
+//------------------------------------------------------------------------
+class ThreadCache
+{
+public:
+    enum
+    {
+        SizeShift       = 4,
+        // Size classes of 16 to 256 bytes.
+        ClassCount      = 16,
+        MaxSize         = ClassCount << SizeShift,
+        MagazineSize    = 32,
+        // Number of blocks moved between a magazine and the heap at once.
+        BatchSize       = 16
+    };
+
+#ifdef SF_HEAP_THREAD_CACHE
+    // Returns a block of at least size bytes, refilling the magazine from 
+    // the heap if necessary. Returns 0 if the size is not cached or the 
+    // cache could not be created; the caller then allocates from the heap.
+    static void*    Alloc(MemoryHeapPT* heap, UPInt size);
+
+    // Keeps a freed block in the cache of the calling thread. Returns false
+    // if the block is not cached and must be freed by the caller.
+    static bool     Free(MemoryHeapPT* heap, Heap::HeapSegment* seg, void* ptr);
+
+    // Returns the blocks of the calling thread to the heap; the caller
+    // holds the heap lock.
+    static void     Flush(MemoryHeapPT* heap);
+
+    // Returns the blocks of the calling thread to the heap and frees its cache.
+    // The thread doesn't use a cache after that.
+    static void     ReleaseCurrent();
+
+    // Returns the blocks of all threads and frees the caches. Called
+    // before the root heap is destroyed, once the other threads have exited.
+    static void     ReleaseAll();
+
+private:
+    struct Magazine
+    {
+        unsigned    Count;
+        void*       Blocks[MagazineSize];
+    };
+
+    static ThreadCache* getCache(MemoryHeapPT* heap);
+    static ThreadCache* createCache(MemoryHeapPT* heap);
+    static void         destroyCache(ThreadCache* cache);
+    void                freeBlocks();
+
+    ThreadCache*    pPrev;
+    ThreadCache*    pNext;
+    MemoryHeapPT*   pHeap;
+    Magazine        Classes[ClassCount];
+#endif
+};
+
+}} // Scaleform::HeapPT
+
+#endif
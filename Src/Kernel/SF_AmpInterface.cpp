@@ -48,6 +48,9 @@ public:
     virtual void    SetMemReports(bool memReports, bool lock) { SF_UNUSED2(memReports, lock); }
     virtual void    SetAppControlCaps(const GFx::AMP::MessageAppControl* caps){ SF_UNUSED(caps); }
     virtual void    ToggleInternalStatRecording() {} ;
+    virtual bool    StartCapture(const char* filename) { SF_UNUSED(filename); return false; }
+    virtual void    StopCapture() { }
+    virtual bool    IsCapturing() const { return false; }
     virtual bool    HandleNextMessage() { return false; }
     virtual void    SendLog(const char* message, int messageLength, LogMessageId msgType) { SF_UNUSED3(message, messageLength, msgType); }
     virtual void    SendCurrentState() { }
@@ -202,6 +202,13 @@ public:
     virtual void        SetAppControlCaps(const GFx::AMP::MessageAppControl* caps) = 0;
     virtual void        ToggleInternalStatRecording() = 0;
 
+    // Writes the messages that would be sent to the AMP client to a file,
+    // whether or not a client is connected. Profiling stays on while
+    // capturing, see GFx::AMP::CaptureWriter for the file format.
+    virtual bool        StartCapture(const char* filename) = 0;
+    virtual void        StopCapture() = 0;
+    virtual bool        IsCapturing() const = 0;
+
     // Configuration options
     virtual void        SetListeningPort(UInt32 port) = 0;
     virtual void        SetBroadcastPort(UInt32 port) = 0;
@@ -197,6 +197,12 @@ public:
     // Closes the file & recovers it to initial state, if supported
     //virtual bool      CloseCancel()                                                       = 0;
 
+    // Returns the whole contents of the file if they can be accessed directly
+    // in memory, as with MappedFile; 0 otherwise. The memory stays valid while
+    // the file is open, so users keeping pointers into it must also keep
+    // a reference to the file.
+    virtual const UByte* GetMappedData()                                                    { return 0; }
+
 
     // ***** Inlines for convenient primitive type serialization
 
@@ -0,0 +1,213 @@
+/**************************************************************************
+
+Filename    :   SF_MappedFile.cpp
+Content     :   Read-only memory mapped file.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "SF_MappedFile.h"
+#include "SF_Debug.h"
+
+#if defined(SF_OS_WIN32) && !defined(SF_OS_WINMETRO) && !defined(SF_OS_WINCE)
+#define SF_MAPPEDFILE_WIN32
+#include <windows.h>
+#include "SF_UTF8Util.h"
+#elif defined(SF_OS_LINUX) || defined(SF_OS_MAC) || defined(SF_OS_IPHONE) || defined(SF_OS_ANDROID)
+#define SF_MAPPEDFILE_POSIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+namespace Scaleform {
+
+MappedFile::MappedFile(const char* pfileName)
+    : FilePath(pfileName), pData(0), FileSize(0), FileIndex(0),
+      ErrorCode(0), Opened(false)
+{
+    open();
+}
+
+MappedFile::MappedFile(const String& fileName)
+    : FilePath(fileName), pData(0), FileSize(0), FileIndex(0),
+      ErrorCode(0), Opened(false)
+{
+    open();
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+void MappedFile::open()
+{
+#if defined(SF_MAPPEDFILE_WIN32)
+    wchar_t* pwFileName = (wchar_t*)SF_ALLOC((UTF8Util::GetLength(FilePath.ToCStr())+1) * sizeof(wchar_t), Stat_Default_Mem);
+    UTF8Util::DecodeString(pwFileName, FilePath.ToCStr());
+    HANDLE hfile = ::CreateFileW(pwFileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    SF_FREE(pwFileName);
+    if (hfile == INVALID_HANDLE_VALUE)
+    {
+        DWORD err = ::GetLastError();
+        ErrorCode = (err == ERROR_FILE_NOT_FOUND || err == ERROR_PATH_NOT_FOUND) ?
+                    Error_FileNotFound : ((err == ERROR_ACCESS_DENIED) ? Error_Access : Error_IOError);
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(hfile, &size) || size.QuadPart > 0x7FFFFFFF)
+    {
+        ErrorCode = Error_IOError;
+        ::CloseHandle(hfile);
+        return;
+    }
+    FileSize = (int)size.QuadPart;
+
+    if (FileSize > 0)
+    {
+        // The view keeps the mapping object alive, so both handles can be closed.
+        HANDLE hmapping = ::CreateFileMappingW(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (hmapping)
+        {
+            pData = (const UByte*)::MapViewOfFile(hmapping, FILE_MAP_READ, 0, 0, 0);
+            ::CloseHandle(hmapping);
+        }
+        if (!pData)
+            ErrorCode = Error_IOError;
+    }
+    ::CloseHandle(hfile);
+    Opened = (ErrorCode == 0);
+
+#elif defined(SF_MAPPEDFILE_POSIX)
+    int fd = ::open(FilePath.ToCStr(), O_RDONLY);
+    if (fd < 0)
+    {
+        ErrorCode = (errno == ENOENT) ? Error_FileNotFound :
+                    ((errno == EACCES || errno == EPERM) ? Error_Access : Error_IOError);
+        return;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size > 0x7FFFFFFF)
+    {
+        ErrorCode = Error_IOError;
+        ::close(fd);
+        return;
+    }
+    FileSize = (int)st.st_size;
+
+    if (FileSize > 0)
+    {
+        // The mapping stays valid after the descriptor is closed.
+        void* p = ::mmap(0, (size_t)FileSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED)
+            pData = (const UByte*)p;
+        else
+            ErrorCode = Error_IOError;
+    }
+    ::close(fd);
+    Opened = (ErrorCode == 0);
+
+#else
+    // Memory mapping is not supported on this platform.
+    ErrorCode = Error_IOError;
+#endif
+}
+
+bool MappedFile::Close()
+{
+    if (pData)
+    {
+#if defined(SF_MAPPEDFILE_WIN32)
+        ::UnmapViewOfFile(pData);
+#elif defined(SF_MAPPEDFILE_POSIX)
+        ::munmap((void*)pData, (size_t)FileSize);
+#endif
+        pData = 0;
+    }
+    FileSize  = 0;
+    FileIndex = 0;
+    Opened    = false;
+    return true;
+}
+
+int MappedFile::Write(const UByte *pbuffer, int numBytes)
+{
+    SF_UNUSED2(pbuffer, numBytes);
+    return -1;
+}
+
+int MappedFile::Read(UByte *pbuffer, int numBytes)
+{
+    if (FileIndex + numBytes > FileSize)
+        numBytes = FileSize - FileIndex;
+
+    if (numBytes > 0)
+    {
+        memcpy(pbuffer, pData + FileIndex, numBytes);
+        FileIndex += numBytes;
+    }
+    return numBytes;
+}
+
+int MappedFile::SkipBytes(int numBytes)
+{
+    if (FileIndex + numBytes > FileSize)
+        numBytes = FileSize - FileIndex;
+
+    FileIndex += numBytes;
+    return numBytes;
+}
+
+int MappedFile::BytesAvailable()
+{
+    return FileSize - FileIndex;
+}
+
+int MappedFile::Seek(int offset, int origin)
+{
+    int pos;
+    switch (origin)
+    {
+    case Seek_Set : pos = offset;               break;
+    case Seek_Cur : pos = FileIndex + offset;   break;
+    case Seek_End : pos = FileSize + offset;    break;
+    default:        return -1;
+    }
+    if (pos < 0 || pos > FileSize)
+        return -1;
+    FileIndex = pos;
+    return FileIndex;
+}
+
+SInt64 MappedFile::LSeek(SInt64 offset, int origin)
+{
+    return (SInt64) Seek((int) offset, origin);
+}
+
+bool MappedFile::ChangeSize(int newSize)
+{
+    SF_UNUSED(newSize);
+    return false;
+}
+
+int MappedFile::CopyFromStream(File *pstream, int byteSize)
+{
+    SF_UNUSED2(pstream, byteSize);
+    return -1;
+}
+
+} // Scaleform
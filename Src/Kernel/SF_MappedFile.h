@@ -0,0 +1,89 @@
+/**************************************************************************
+
+PublicHeader:   Kernel
+Filename    :   SF_MappedFile.h
+Content     :   Read-only memory mapped file.
+Created     :
+Authors     :
+
+Notes       :   MappedFile is Read Only
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Kernel_MappedFile_H
+#define INC_SF_Kernel_MappedFile_H
+
+#include "SF_File.h"
+
+namespace Scaleform {
+
+// ***** MappedFile
+
+// MappedFile maps the whole file into the address space for reading. Reads
+// are copies out of the mapped pages, and GetMappedData exposes the pages
+// directly, so that parsers such as GFx::Stream can work on them without
+// copying. Pages are loaded on demand by the OS and are shared with other
+// processes mapping the same file.
+//
+// Mapping is supported on Win32 and POSIX systems; on other platforms, or if
+// the file can't be mapped, IsValid returns false and the caller should fall
+// back to SysFile. The mapped memory stays valid until the file is closed or
+// destroyed, so users that keep pointers into it must hold a reference to
+// the file.
+
+class MappedFile : public File
+{
+public:
+    // pfileName should be encoded as UTF-8 to support international file names.
+    MappedFile(const char* pfileName);
+    MappedFile(const String& fileName);
+    ~MappedFile();
+
+    // ** File Information
+    virtual const char* GetFilePath()       { return FilePath.ToCStr(); }
+
+    virtual bool        IsValid()           { return Opened; }
+    virtual bool        IsWritable()        { return false; }
+
+    virtual int         Tell()              { return FileIndex; }
+    virtual SInt64      LTell()             { return (SInt64) FileIndex; }
+    virtual int         GetLength()         { return FileSize; }
+    virtual SInt64      LGetLength()        { return (SInt64) FileSize; }
+
+    virtual int         GetErrorCode()      { return ErrorCode; }
+
+    // ** Stream implementation & I/O
+    virtual int         Write(const UByte *pbuffer, int numBytes);
+    virtual int         Read(UByte *pbuffer, int numBytes);
+    virtual int         SkipBytes(int numBytes);
+    virtual int         BytesAvailable();
+    virtual bool        Flush()             { return true; }
+    virtual int         Seek(int offset, int origin=Seek_Set);
+    virtual SInt64      LSeek(SInt64 offset, int origin=Seek_Set);
+    virtual bool        ChangeSize(int newSize);
+    virtual int         CopyFromStream(File *pstream, int byteSize);
+    // Unmaps the file; any pointers into the mapping become invalid.
+    virtual bool        Close();
+
+    virtual const UByte* GetMappedData()    { return pData; }
+
+private:
+    void                open();
+
+    String              FilePath;
+    const UByte*        pData;
+    int                 FileSize;
+    int                 FileIndex;
+    int                 ErrorCode;
+    bool                Opened;
+};
+
+} // Scaleform
+
+#endif
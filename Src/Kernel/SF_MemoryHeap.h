@@ -119,6 +119,12 @@ public:
         // If not, then this heap does not track debug information.
         Heap_NoDebugInfo        = 0x0010,
 
+        // Keeps small blocks freed by a thread in a per-thread cache, and 
+        // reuses them without locking the heap. Only used by the root heap,
+        // if SF_MEMORY_ENABLE_THREAD_CACHE is defined. The cached blocks
+        // remain allocated until the thread calls ReleaseThreadCache.
+        Heap_ThreadCache        = 0x0020,
+
         // This flag can be set by the user for debug tool allocations, such as the
         // player HUD.  Scaleform tools can choose to omit these heaps from information
         // reporting or report them separately. This flag is for user information only,
@@ -320,6 +326,12 @@ public:
     static bool SF_STDCALL ReleaseRootHeapPT();
     static bool SF_STDCALL ReleaseRootHeapMH();
 
+    // Returns the blocks cached by the calling thread for a root heap 
+    // created with Heap_ThreadCache. Thread calls it when its thread
+    // function returns; other threads can call it before exiting.
+    // The calling thread doesn't cache blocks after that.
+    static void SF_STDCALL ReleaseThreadCache();
+
 
     // *** Operations with memory arenas
     //
@@ -493,6 +493,8 @@ int Thread::PRun()
     }
 
     ExitCode = Run();    
+    // Return the blocks that the thread cached for the global heap.
+    MemoryHeap::ReleaseThreadCache();
     return ExitCode;
 }
 
@@ -804,6 +804,8 @@ int     Thread::PRun()
 
     // Call the virtual run function
     ExitCode = Run();    
+    // Return the blocks that the thread cached for the global heap.
+    MemoryHeap::ReleaseThreadCache();
     return ExitCode;
 }
 
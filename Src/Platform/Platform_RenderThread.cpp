@@ -42,6 +42,7 @@ bool RenderThread::initGraphics(const Platform::ViewConfig& config, Device::Wind
     pRenderer = *new Render::Renderer2D(getHAL());    
     pRenderer->GetGlyphCacheConfig()->SetParams(GCParams);
     pRenderer->SetToleranceParams(TolParams);
+    pRenderer->SetMeshDiskCache(pMeshDiskCache);
 
     if (!RenderHALThread::initGraphics(config, window, renderThreadId))
     {
@@ -84,6 +85,8 @@ void RenderThread::destroyGraphics()
     }
 
     Windows.Clear();
+    if (pMeshDiskCache && pMeshDiskCache->IsModified())
+        pMeshDiskCache->SaveFile();
     pRenderer.Clear();
     RenderHALThread::destroyGraphics();
 }
@@ -105,6 +108,13 @@ void RenderThread::setToleranceParams(const Render::ToleranceParams& params)
 	}
 }
 
+void RenderThread::setMeshDiskCache(Render::MeshDiskCache* cache)
+{
+    pMeshDiskCache = cache;
+    if (pRenderer)
+        pRenderer->SetMeshDiskCache(pMeshDiskCache);
+}
+
 void RenderThread::getToleranceParams(Render::ToleranceParams* params)
 {
 	if (pRenderer && params)
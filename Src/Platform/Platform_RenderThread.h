@@ -24,6 +24,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 #endif
 #include "Render/Render_Primitive.h"
 #include "Render/Render_GlyphCacheConfig.h"
+#include "Render/Render_MeshDiskCache.h"
 
 namespace Scaleform { namespace Platform {
 
@@ -135,6 +136,13 @@ public:
 		PushCallAndWait(&RenderThread::getToleranceParams, params);
 	}
 
+    // Installs a mesh disk cache in the renderer; the cache is saved to its
+    // file on shutdown if new meshes were added to it.
+    void    SetMeshDiskCache(Render::MeshDiskCache* cache)
+    {
+        PushCall(&RenderThread::setMeshDiskCache, cache);
+    }
+
     unsigned GetGlyphRasterizationCount() const;
     void     ResetRasterizationCount();
 
@@ -151,6 +159,7 @@ protected:
     void    setGlyphCacheParams(const Render::GlyphCacheParams& params);
     void    setToleranceParams(const Render::ToleranceParams& params);
 	void    getToleranceParams(Render::ToleranceParams* params);
+    void    setMeshDiskCache(Render::MeshDiskCache* cache);
 
 
     virtual void updateConfiguration()
@@ -196,6 +205,7 @@ protected:
     Ptr<Render::Renderer2D>     pRenderer;
     Render::GlyphCacheParams    GCParams;  // Parameters copy stored before Renderer2D creation.
     Render::ToleranceParams     TolParams; // Parameters copy stored before Renderer2D creation.
+    Ptr<Render::MeshDiskCache>  pMeshDiskCache;
     UInt32                      ViewportFlags;
     unsigned                    PresentMode;
 
@@ -17,6 +17,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 
 #include "Render/Render_DrawableImage.h"
 #include "Render/Render_DrawableImage_Queue.h"
+#include "Render/Render_DrawableImage_Bands.h"
 #include "Render/Render_HAL.h"
 #include "Kernel/SF_HeapNew.h"
 #include "Render/Render_TreeShape.h"
@@ -146,6 +147,13 @@ void DrawableImageContext::RemoveCaptureNotify(DICommandQueue* notify)
     }
 }
 
+DIRowBandPool* DrawableImageContext::GetRowBandPoolRT()
+{
+    if (!pRowBandPool)
+        pRowBandPool = *SF_HEAP_AUTO_NEW(this) DIRowBandPool();
+    return pRowBandPool;
+}
+
 void DrawableImageContext::processTreeRootKillList()
 {
     if (!RContext)
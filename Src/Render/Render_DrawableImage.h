@@ -29,6 +29,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 namespace Scaleform { namespace Render {
 
 class DICommandQueue;
+class DIRowBandPool;
 
 // One DrawableImageContext may be shared between multiple DrawableImages.
 
@@ -79,6 +80,10 @@ public:
     void AddTreeRootToKillList( TreeRoot* proot );
 	bool IsShutdownComplete() const { return !RContext || RContext->IsShutdownComplete(); }
 
+    // Returns the worker pool used to split software command execution into
+    // row bands; created on first use. Render thread only.
+    DIRowBandPool* GetRowBandPoolRT();
+
 protected:
 
     void processTreeRootKillList();
@@ -101,6 +106,8 @@ protected:
     ArrayLH<TreeRoot*>      TreeRootKillList;
     List<DICommandQueue>    QueueList;
 
+    Ptr<DIRowBandPool>      pRowBandPool;
+
 private:
     // Default interface to be used if none are provided by render thread.
     // TBD: We can provide an extra interface on top that for customizable lookup.
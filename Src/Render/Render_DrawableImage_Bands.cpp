@@ -0,0 +1,86 @@
+/**************************************************************************
+
+Filename    :   Render_DrawableImage_Bands.cpp
+Content     :   Worker pool splitting software DrawableImage commands
+                into row bands.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Render/Render_DrawableImage_Bands.h"
+#include "Kernel/SF_Alg.h"
+#include "Kernel/SF_HeapNew.h"
+
+namespace Scaleform { namespace Render {
+
+DIRowBandPool::DIRowBandPool() :
+    WorkerPool("Scaleform DrawableImage"),
+    pKernel(0), FirstRow(0), LastRow(0), BandRows(0), BandCount(0)
+{
+}
+
+DIRowBandPool::~DIRowBandPool()
+{
+    Shutdown();
+}
+
+void DIRowBandPool::processParallel()
+{
+    while(1)
+    {
+        int band = NextBand.ExchangeAdd_Sync(1);
+        if (band >= BandCount)
+            break;
+        SInt32 y1 = FirstRow + band * BandRows;
+        pKernel->ExecuteRows(y1, Alg::Min(y1 + BandRows, LastRow));
+    }
+}
+
+void DIRowBandPool::Execute(const DIRowBandKernel& kernel, SInt32 y1, SInt32 y2, unsigned rowPixels)
+{
+    if (y2 <= y1)
+        return;
+
+#ifdef SF_ENABLE_THREADS
+    SInt32 rows = y2 - y1;
+    if ((UPInt)rows * rowPixels >= (UPInt)MinParallelPixels)
+    {
+        Initialize();
+
+        if (GetWorkerCount())
+        {
+            // Aim for several bands per thread, but keep each band large enough
+            // to amortize the per band swizzler setup.
+            SInt32 threads  = (SInt32)GetWorkerCount() + 1;
+            SInt32 minRows  = (SInt32)((MinBandPixels + rowPixels - 1) / Alg::Max(rowPixels, 1u));
+            pKernel   = &kernel;
+            FirstRow  = y1;
+            LastRow   = y2;
+            BandRows  = Alg::Max((rows + threads * BandsPerThread - 1) / (threads * BandsPerThread), minRows);
+            BandCount = (int)((rows + BandRows - 1) / BandRows);
+            NextBand  = 0;
+
+            if (BandCount > 1)
+            {
+                RunParallel();
+                pKernel = 0;
+                return;
+            }
+            pKernel = 0;
+        }
+    }
+#else
+    SF_UNUSED(rowPixels);
+#endif
+
+    kernel.ExecuteRows(y1, y2);
+}
+
+}}; // namespace Scaleform::Render
@@ -0,0 +1,87 @@
+/**************************************************************************
+
+Filename    :   Render_DrawableImage_Bands.h
+Content     :   Worker pool splitting software DrawableImage commands
+                into row bands.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_DrawableImage_Bands_H
+#define INC_SF_Render_DrawableImage_Bands_H
+
+#include "Kernel/SF_RefCount.h"
+#include "Kernel/SF_Array.h"
+#include "Kernel/SF_Threads.h"
+#include "Kernel/SF_Atomic.h"
+#include "Render/Render_Stats.h"
+#include "Render/Render_WorkerPool.h"
+
+namespace Scaleform { namespace Render {
+
+// DIRowBandKernel is implemented by software DrawableImage commands that can
+// process disjoint ranges of destination rows independently.
+class DIRowBandKernel
+{
+public:
+    virtual ~DIRowBandKernel() { }
+
+    // Processes destination rows [y1, y2). May be called concurrently
+    // from several threads, always with non-overlapping ranges.
+    virtual void ExecuteRows(SInt32 y1, SInt32 y2) const = 0;
+};
+
+// DIRowBandPool splits the rows of a DIRowBandKernel into bands, which are
+// processed by the worker threads together with the calling thread.
+// Execute returns once all the bands are complete. Small images, where the
+// thread handoff would cost more than the work, are processed serially.
+//
+// The pool is owned by DrawableImageContext and is only used from the render
+// thread; worker threads are started on first parallel Execute.
+
+class DIRowBandPool : public RefCountBase<DIRowBandPool, StatRender_Mem>,
+                      public WorkerPool
+{
+public:
+    enum
+    {
+        // Images with fewer pixels than this are processed on the calling thread.
+        MinParallelPixels   = 256 * 256,
+        // Minimum number of pixels in one band.
+        MinBandPixels       = 16 * 1024,
+        // Bands per thread, allowing for unevenly expensive rows.
+        BandsPerThread      = 4
+    };
+
+    DIRowBandPool();
+    ~DIRowBandPool();
+
+    // Starts the worker threads; threadCount of 0 picks one fewer than the
+    // number of CPUs.
+    void            Initialize(unsigned threadCount = 0) { StartWorkers(threadCount); }
+    void            Shutdown()                           { StopWorkers(); }
+
+    // Processes rows [y1, y2) with the kernel; rowPixels is the number of
+    // pixels in each row and is used to decide on the band size.
+    void            Execute(const DIRowBandKernel& kernel, SInt32 y1, SInt32 y2, unsigned rowPixels);
+
+private:
+    // Processes bands until none are left.
+    virtual void    processParallel();
+
+    const DIRowBandKernel*  pKernel;
+    SInt32                  FirstRow, LastRow, BandRows;
+    int                     BandCount;
+    AtomicInt<int>          NextBand;
+};
+
+}}; // namespace Scaleform::Render
+
+#endif
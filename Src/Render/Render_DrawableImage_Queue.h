@@ -520,7 +520,11 @@ struct DICommand_ApplyFilter : public DICommand_SourceRectImpl<DICommand_ApplyFi
     { }
 
     virtual DICommandType GetType() const { return DICommandType_ApplyFilter; }
-    virtual unsigned GetCPUCaps() const { return 0; }
+    // CPU execution is available for the filters supported by ApplyFilterSW.
+    virtual unsigned GetCPUCaps() const;
+
+    virtual void ExecuteSW(DICommandContext& context,
+        ImageData& dest, ImageData** src = 0) const;
 
     virtual void ExecuteHWGetImages( DrawableImage** images, Size<float>* readOffsets) const;
     virtual void ExecuteHWCopyAction( DICommandContext& context, Render::Texture** tex, const Matrix2F* texgen) const;
@@ -16,6 +16,9 @@ otherwise accompanies this software in either electronic or hard copy form.
 
 #include "Render_DrawableImage_Queue.h"
 #include "Render/Render_HAL.h"
+#include "Render/Render_FiltersSW.h"
+#include "Render/Render_DrawableImage_Bands.h"
+#include "Kernel/SF_SIMD.h"
 #include "Kernel/SF_Random.h"
 
 namespace Scaleform { namespace Render {
@@ -81,73 +84,344 @@ bool DICommand_SourceRect::CalculateDestClippedRect( const ImageSize &srcSize, c
     return true;
 }
 
-void DICommand_ColorTransform::ExecuteSW(DICommandContext& context,
-										 ImageData& dest,
-										 ImageData** psrc) const
+//--------------------------------------------------------------------
+// ***** Row band execution
+
+// Byte offsets of the red, green, blue and alpha channels within a pixel, for
+// images whose pixels can be accessed directly by the software commands.
+static const UByte DirectOffsets_R8G8B8A8[4] = { 0, 1, 2, 3 };
+static const UByte DirectOffsets_B8G8R8A8[4] = { 2, 1, 0, 3 };
+
+// Returns the channel offsets for the image, or null if its pixels must be
+// accessed through the ImageSwizzler.
+static const UByte* getDirectChannelOffsets(const ImageSwizzler& swizzler, const ImageData* pdata)
+{
+    if (!pdata || !swizzler.IsLinear())
+        return 0;
+    switch(pdata->Format)
+    {
+    case Image_R8G8B8A8:    return DirectOffsets_R8G8B8A8;
+    case Image_B8G8R8A8:    return DirectOffsets_B8G8R8A8;
+    default:                return 0;
+    }
+}
+
+static inline UInt32 loadDirectPixel(const UByte* p, const UByte* offsets)
+{
+    return ((UInt32)p[offsets[3]] << 24) | ((UInt32)p[offsets[0]] << 16) |
+           ((UInt32)p[offsets[1]] << 8)  |  (UInt32)p[offsets[2]];
+}
+
+static inline void storeDirectPixel(UByte* p, const UByte* offsets, UInt32 c)
+{
+    p[offsets[0]] = (UByte)(c >> 16);
+    p[offsets[1]] = (UByte)(c >> 8);
+    p[offsets[2]] = (UByte)c;
+    p[offsets[3]] = (UByte)(c >> 24);
+}
+
+#if defined(SF_ENABLE_SIMD) && defined(SF_CPU_SSE)
+// Swaps the first and third byte of every pixel, converting between the
+// R8G8B8A8 layout and the B8G8R8A8 layout of Color32 values.
+static inline __m128i swapRedBlueSSE(__m128i v)
+{
+    const __m128i ga  = _mm_set1_epi32((int)0xFF00FF00);
+    const __m128i low = _mm_set1_epi32(0xFF);
+    return _mm_or_si128(_mm_and_si128(v, ga),
+                        _mm_or_si128(_mm_and_si128(_mm_srli_epi32(v, 16), low),
+                                     _mm_slli_epi32(_mm_and_si128(v, low), 16)));
+}
+#endif
+
+// DIRowKernel executes a command over the rows of its destination rectangle.
+// When the images are in a linear 32-bit format, rows are processed directly
+// by executeRowDirect, which may use SIMD; otherwise executeRowsSwizzled
+// accesses pixels through the ImageSwizzler. Large images are split into row
+// bands processed in parallel by the DrawableImageContext row band pool.
+class DIRowKernel : public DIRowBandKernel
+{
+public:
+    DIRowKernel(DICommandContext& context, ImageData& dest, ImageData* psrc,
+                const Rect<SInt32>& destRect, const Point<SInt32>& delta);
+
+    // Runs the kernel over all the rows of the destination rectangle, using the
+    // row band pool of the given context if it is not null.
+    void            Run(DrawableImageContext* pcontext) const;
+
+    virtual void    ExecuteRows(SInt32 y1, SInt32 y2) const;
+
+protected:
+    virtual void    executeRowsSwizzled(SInt32 y1, SInt32 y2) const = 0;
+    // Processes 'count' pixels of row y; pdest and psrc point to the first pixel.
+    virtual void    executeRowDirect(SInt32 y, UByte* pdest, const UByte* psrc, unsigned count) const = 0;
+
+    ImageSwizzler*  pSwizzler;
+    ImageData*      pDest;
+    ImageData*      pSrc;
+    Rect<SInt32>    DestRect;
+    Point<SInt32>   Delta;
+    const UByte*    pDestOffsets;
+    const UByte*    pSrcOffsets;
+    bool            Direct;     // Pixels of both images are accessed directly.
+    bool            Aliased;    // Source and destination share the pixel data.
+    bool            SIMDSafe;   // Several pixels of a row may be processed at once.
+};
+
+DIRowKernel::DIRowKernel(DICommandContext& context, ImageData& dest, ImageData* psrc,
+                         const Rect<SInt32>& destRect, const Point<SInt32>& delta) :
+    pSwizzler(&context.pHAL->GetTextureManager()->GetImageSwizzler()),
+    pDest(&dest), pSrc(psrc), DestRect(destRect), Delta(delta)
+{
+    pDestOffsets = getDirectChannelOffsets(*pSwizzler, pDest);
+    pSrcOffsets  = getDirectChannelOffsets(*pSwizzler, pSrc);
+    Direct       = pDestOffsets && (!pSrc || pSrcOffsets);
+    Aliased      = pSrc && pSrc->pPlanes[0].pData == pDest->pPlanes[0].pData;
+
+    // When a row is read while it is being written, the serial order has to be
+    // kept for pixels closer than one SIMD block.
+    SIMDSafe     = !Aliased || Delta.y != 0 || Delta.x <= 0 || Delta.x >= 4;
+}
+
+void DIRowKernel::Run(DrawableImageContext* pcontext) const
+{
+    // Rows can only be processed out of order if none of them reads another one.
+    if (pcontext && (!Aliased || Delta.y == 0))
+        pcontext->GetRowBandPoolRT()->Execute(*this, DestRect.y1, DestRect.y2, (unsigned)DestRect.Width());
+    else
+        ExecuteRows(DestRect.y1, DestRect.y2);
+}
+
+void DIRowKernel::ExecuteRows(SInt32 y1, SInt32 y2) const
+{
+    if (!Direct)
+    {
+        executeRowsSwizzled(y1, y2);
+        return;
+    }
+
+    unsigned count = (unsigned)DestRect.Width();
+    for (SInt32 y = y1; y < y2; ++y)
+    {
+        UByte*       pd = pDest->GetScanline((unsigned)y) + DestRect.x1 * 4;
+        const UByte* ps = pSrc ? pSrc->GetScanline((unsigned)(y - Delta.y)) + (DestRect.x1 - Delta.x) * 4 : 0;
+        executeRowDirect(y, pd, ps, count);
+    }
+}
+
+unsigned DICommand_ApplyFilter::GetCPUCaps() const
+{
+    return IsFilterSupportedSW(pFilter) ? RC_CPU : 0;
+}
+
+void DICommand_ApplyFilter::ExecuteSW(DICommandContext& context,
+									  ImageData& dest,
+									  ImageData** psrc) const
 {
 	const ImageData& src = *psrc[0];
-	ImagePlane d, s;
-	dest.GetPlane(0, &d);
-	src.GetPlane(0, &s);
 
-	Point<SInt32> delta;
-	Rect<SInt32> dstClippedRect;
+	// The filter result covers the source rectangle expanded by the filter bounds;
+	// all of it is written to the destination, mapped by DestPoint - SourceRect.TopLeft.
+	RectF filterRectF, sourceRectF = SourceRect;
+	DrawableImage::CalcFilterRect(&filterRectF, PixelsToTwips(sourceRectF), pFilter);
+	filterRectF = TwipsToPixels(filterRectF);
+	Rect<SInt32> filterRect((SInt32)floorf(filterRectF.x1), (SInt32)floorf(filterRectF.y1),
+							(SInt32)ceilf(filterRectF.x2),  (SInt32)ceilf(filterRectF.y2));
 
-	if(!CalculateDestClippedRect(src, dest, SourceRect, dstClippedRect, delta))
+	Point<SInt32> delta = DestPoint - SourceRect.TopLeft();
+	Rect<SInt32>  dstClippedRect;
+	if (filterRect.IsEmpty() ||
+		!(filterRect + delta).IntersectRect(&dstClippedRect, Rect<SInt32>(dest.GetSize())))
 	{
 		return;
 	}
 
-	// If the image is not transparent, then the Cxform multiplies all components by the alpha offset + alpha multiplier.
-	Cxform cx = Cx;
-	if ( !pImage->IsTransparent() )
+	// Filter in R8G8B8A8 scratch planes the size of the filter rectangle. The input is copied
+	// first, so the source may be the destination image itself.
+	unsigned width = (unsigned)filterRect.Width(), height = (unsigned)filterRect.Height();
+	UPInt    pitch = width * 4;
+	UByte*   pdata = (UByte*)SF_ALLOC(pitch * height * 2, StatRender_Mem);
+	if (!pdata)
+		return;
+	memset(pdata, 0, pitch * height);
+	ImagePlane filterSrc(width, height, pitch, pitch * height, pdata);
+	ImagePlane filterDest(width, height, pitch, pitch * height, pdata + pitch * height);
+
+	ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &(*psrc[0]));
+
+	Rect<SInt32> srcClippedRect;
+	if (Rect<SInt32>(src.GetSize()).IntersectRect(&srcClippedRect, SourceRect))
 	{
-		float falpha = cx.M[0][3] + cx.M[1][3];
-		for ( int i = 0; i < 3; ++i)
+		SInt32 x, y;
+		for (y = srcClippedRect.y1; y < srcClippedRect.y2; y++)
 		{
-			cx.M[0][i] *= falpha;
-			cx.M[1][i] *= falpha;
+			srcSwiz.CacheScanline(y);
+			UByte* prow = filterSrc.pData + (y - filterRect.y1) * pitch;
+
+			for (x = srcClippedRect.x1; x < srcClippedRect.x2; x++)
+			{
+				Color  sCol = srcSwiz.GetPixelInScanline(x);
+				UByte* p    = prow + (x - filterRect.x1) * 4;
+				p[0] = sCol.GetRed();
+				p[1] = sCol.GetGreen();
+				p[2] = sCol.GetBlue();
+				p[3] = pSource->IsTransparent() ? sCol.GetAlpha() : 255;
+			}
 		}
-		cx.M[0][3] = 1.0f;
-		cx.M[1][3] = 0.0f;
 	}
 
+	ApplyFilterSW(pFilter, filterDest, filterSrc);
+
 	ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &dest);
-	ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &(*psrc[0]));
 
 	SInt32 x, y;
 	for (y = dstClippedRect.y1; y < dstClippedRect.y2; y++)
 	{
 		dstSwiz.CacheScanline(y);
-		srcSwiz.CacheScanline(y - delta.y);
+		const UByte* prow = filterDest.pData + (y - delta.y - filterRect.y1) * pitch;
 
 		for (x = dstClippedRect.x1; x < dstClippedRect.x2; x++)
 		{
-			Color sCol = srcSwiz.GetPixelInScanline(x - delta.x);
+			const UByte* p = prow + (x - delta.x - filterRect.x1) * 4;
+			Color dCol(p[0], p[1], p[2], pImage->IsTransparent() ? p[3] : 255);
+			dstSwiz.SetPixelInScanline(x, dCol.ToColor32());
+		}
+	}
 
-			if (!pSource->IsTransparent())
-				sCol.SetAlpha(255);
+	SF_FREE(pdata);
+}
 
-			// Note: More or less a duplicate of the implementation in the Cxform class itself,
-			// but requires rescaling by 256 rather than 255 in order to be pixel-exact. Using
-			// Cxform.Transform causes the resulting colors to be off by 1 in
-			// test_bitmapdata_colorTransform.swf.
-			float rgbaM[4] = { ((float)sCol.GetRed()   / 255.0f) * cx.M[0][0],
-							   ((float)sCol.GetGreen() / 255.0f) * cx.M[0][1],
-							   ((float)sCol.GetBlue()  / 255.0f) * cx.M[0][2],
-							   ((float)sCol.GetAlpha() / 255.0f) * cx.M[0][3] };
-			Color  dCol(
-				(UByte)Alg::Clamp<float>((rgbaM[0] + cx.M[1][0]) * 256.0f, 0, 255),
-				(UByte)Alg::Clamp<float>((rgbaM[1] + cx.M[1][1]) * 256.0f, 0, 255),
-				(UByte)Alg::Clamp<float>((rgbaM[2] + cx.M[1][2]) * 256.0f, 0, 255),
-				(UByte)Alg::Clamp<float>((rgbaM[3] + cx.M[1][3]) * 256.0f, 0, 255) );
+class DIColorTransformKernel : public DIRowKernel
+{
+public:
+    DIColorTransformKernel(DICommandContext& context, ImageData& dest, ImageData* psrc,
+                           const Rect<SInt32>& destRect, const Point<SInt32>& delta,
+                           const Cxform& cx, bool srcTransparent, bool destTransparent) :
+        DIRowKernel(context, dest, psrc, destRect, delta),
+        Cx(cx), SrcTransparent(srcTransparent), DestTransparent(destTransparent)
+    { }
+
+protected:
+    Cxform  Cx;
+    bool    SrcTransparent, DestTransparent;
+
+    // Note: More or less a duplicate of the implementation in the Cxform class itself,
+    // but requires rescaling by 256 rather than 255 in order to be pixel-exact. Using
+    // Cxform.Transform causes the resulting colors to be off by 1 in
+    // test_bitmapdata_colorTransform.swf.
+    Color transform(Color sCol) const
+    {
+        if (!SrcTransparent)
+            sCol.SetAlpha(255);
+
+        float rgbaM[4] = { ((float)sCol.GetRed()   / 255.0f) * Cx.M[0][0],
+                           ((float)sCol.GetGreen() / 255.0f) * Cx.M[0][1],
+                           ((float)sCol.GetBlue()  / 255.0f) * Cx.M[0][2],
+                           ((float)sCol.GetAlpha() / 255.0f) * Cx.M[0][3] };
+        Color  dCol(
+            (UByte)Alg::Clamp<float>((rgbaM[0] + Cx.M[1][0]) * 256.0f, 0, 255),
+            (UByte)Alg::Clamp<float>((rgbaM[1] + Cx.M[1][1]) * 256.0f, 0, 255),
+            (UByte)Alg::Clamp<float>((rgbaM[2] + Cx.M[1][2]) * 256.0f, 0, 255),
+            (UByte)Alg::Clamp<float>((rgbaM[3] + Cx.M[1][3]) * 256.0f, 0, 255) );
+
+        if (!DestTransparent)
+            dCol.SetAlpha(255);
+        return dCol;
+    }
 
-			if (!pImage->IsTransparent())
-				dCol.SetAlpha(255);
+    virtual void executeRowsSwizzled(SInt32 y1, SInt32 y2) const
+    {
+        ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(*pSwizzler, pDest);
+        ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(*pSwizzler, pSrc);
 
-			dstSwiz.SetPixelInScanline(x, dCol.ToColor32());
+        for (SInt32 y = y1; y < y2; y++)
+        {
+            dstSwiz.CacheScanline(y);
+            srcSwiz.CacheScanline(y - Delta.y);
+
+            for (SInt32 x = DestRect.x1; x < DestRect.x2; x++)
+                dstSwiz.SetPixelInScanline(x, transform(srcSwiz.GetPixelInScanline(x - Delta.x)).ToColor32());
+        }
+    }
+
+    virtual void executeRowDirect(SInt32, UByte* pd, const UByte* ps, unsigned count) const
+    {
+        unsigned x = 0;
+#if defined(SF_ENABLE_SIMD) && defined(SF_CPU_SSE)
+        if (SIMDSafe && SIMD::IS::SupportsIntegerIntrinsics())
+        {
+            // Channels are processed in the source byte order, with the coefficients
+            // permuted to match; the divide is kept to produce the same results as
+            // the scalar code.
+            SF_SIMD_ALIGN(float mul[4]);
+            SF_SIMD_ALIGN(float add[4]);
+            for (unsigned c = 0; c < 4; ++c)
+            {
+                mul[pSrcOffsets[c]] = Cx.M[0][c];
+                add[pSrcOffsets[c]] = Cx.M[1][c];
+            }
+            const __m128  vmul   = _mm_load_ps(mul);
+            const __m128  vadd   = _mm_load_ps(add);
+            const __m128  v255   = _mm_set1_ps(255.0f);
+            const __m128  v256   = _mm_set1_ps(256.0f);
+            const __m128  vzero  = _mm_setzero_ps();
+            const __m128i zero   = _mm_setzero_si128();
+            const int     srcOr  = SrcTransparent  ? 0 : (int)0xFF000000;
+            const int     destOr = DestTransparent ? 0 : (int)0xFF000000;
+            const bool    swap   = pSrcOffsets != pDestOffsets;
+
+            for (; x < count; ++x)
+            {
+                __m128i p = _mm_cvtsi32_si128(*(const int*)(ps + x * 4) | srcOr);
+                __m128  f = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(p, zero), zero));
+                f = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_div_ps(f, v255), vmul), vadd), v256);
+                __m128i r = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(f, vzero), v255));
+                if (swap)
+                    r = _mm_shuffle_epi32(r, _MM_SHUFFLE(3,0,1,2));
+                r = _mm_packs_epi32(r, r);
+                r = _mm_packus_epi16(r, r);
+                *(int*)(pd + x * 4) = _mm_cvtsi128_si32(r) | destOr;
+            }
+        }
+#endif
+        for (; x < count; ++x)
+        {
+            Color sCol(loadDirectPixel(ps + x * 4, pSrcOffsets));
+            storeDirectPixel(pd + x * 4, pDestOffsets, transform(sCol).ToColor32());
+        }
+    }
+};
+
+void DICommand_ColorTransform::ExecuteSW(DICommandContext& context,
+										 ImageData& dest,
+										 ImageData** psrc) const
+{
+	const ImageData& src = *psrc[0];
+
+	Point<SInt32> delta;
+	Rect<SInt32> dstClippedRect;
+
+	if(!CalculateDestClippedRect(src, dest, SourceRect, dstClippedRect, delta))
+	{
+		return;
+	}
+
+	// If the image is not transparent, then the Cxform multiplies all components by the alpha offset + alpha multiplier.
+	Cxform cx = Cx;
+	if ( !pImage->IsTransparent() )
+	{
+		float falpha = cx.M[0][3] + cx.M[1][3];
+		for ( int i = 0; i < 3; ++i)
+		{
+			cx.M[0][i] *= falpha;
+			cx.M[1][i] *= falpha;
 		}
+		cx.M[0][3] = 1.0f;
+		cx.M[1][3] = 0.0f;
 	}
+
+	DIColorTransformKernel kernel(context, dest, psrc[0], dstClippedRect, delta, cx,
+	                              pSource->IsTransparent(), pImage->IsTransparent());
+	kernel.Run(pImage->GetContext());
 }
 
 void DICommand_Compare::ExecuteSW(DICommandContext& context,
@@ -206,14 +480,96 @@ void DICommand_Compare::ExecuteSW(DICommandContext& context,
 	}
 }
 
+class DICopyChannelKernel : public DIRowKernel
+{
+public:
+    DICopyChannelKernel(DICommandContext& context, ImageData& dest, ImageData* psrc,
+                        const Rect<SInt32>& destRect, const Point<SInt32>& delta,
+                        UByte sCI, UByte dCI, bool srcTransparent, bool destTransparent) :
+        DIRowKernel(context, dest, psrc, destRect, delta),
+        SrcChannel(sCI), DestChannel(dCI), SrcTransparent(srcTransparent), DestTransparent(destTransparent)
+    { }
+
+protected:
+    UByte   SrcChannel, DestChannel;
+    bool    SrcTransparent, DestTransparent;
+
+    virtual void executeRowsSwizzled(SInt32 y1, SInt32 y2) const
+    {
+        ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(*pSwizzler, pDest);
+        ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(*pSwizzler, pSrc);
+
+        for (SInt32 y = y1; y < y2; y++)
+        {
+            dstSwiz.CacheScanline(y);
+            srcSwiz.CacheScanline(y - Delta.y);
+
+            for (SInt32 x = DestRect.x1; x < DestRect.x2; x++)
+            {
+                Color dCol = dstSwiz.GetPixelInScanline(x);
+                Color sCol = srcSwiz.GetPixelInScanline(x - Delta.x);
+
+                UByte dChannels[4] = { dCol.GetRed(), dCol.GetGreen(), dCol.GetBlue(), dCol.GetAlpha() };
+                UByte sChannels[4] = { sCol.GetRed(), sCol.GetGreen(), sCol.GetBlue(), sCol.GetAlpha() };
+
+                if (!SrcTransparent)
+                    sChannels[3] = 255;
+
+                dChannels[DestChannel] = sChannels[SrcChannel];
+
+                if (!DestTransparent)
+                    dChannels[3] = 255;
+
+                dCol.SetRGBA(dChannels[0], dChannels[1], dChannels[2], dChannels[3]);
+
+                dstSwiz.SetPixelInScanline(x, dCol.ToColor32());
+            }
+        }
+    }
+
+    virtual void executeRowDirect(SInt32, UByte* pd, const UByte* ps, unsigned count) const
+    {
+        unsigned    srcOffset  = pSrcOffsets[SrcChannel];
+        unsigned    destOffset = pDestOffsets[DestChannel];
+        bool        srcOpaque  = (SrcChannel == 3) && !SrcTransparent;
+        unsigned    x = 0;
+
+#if defined(SF_ENABLE_SIMD) && defined(SF_CPU_SSE)
+        if (SIMDSafe && SIMD::IS::SupportsIntegerIntrinsics())
+        {
+            // Alpha is the last byte of the pixel in both formats.
+            const __m128i alpha     = _mm_set1_epi32((int)0xFF000000);
+            const __m128i low       = _mm_set1_epi32(0xFF);
+            const __m128i srcShift  = _mm_cvtsi32_si128(srcOffset * 8);
+            const __m128i destShift = _mm_cvtsi32_si128(destOffset * 8);
+            const __m128i destMask  = _mm_sll_epi32(low, destShift);
+            const __m128i srcOr     = srcOpaque ? alpha : _mm_setzero_si128();
+            const __m128i destOr    = DestTransparent ? _mm_setzero_si128() : alpha;
+
+            for (; x + 4 <= count; x += 4)
+            {
+                __m128i s = _mm_or_si128(_mm_loadu_si128((const __m128i*)(ps + x * 4)), srcOr);
+                __m128i d = _mm_loadu_si128((const __m128i*)(pd + x * 4));
+                __m128i v = _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(s, srcShift), low), destShift);
+                d = _mm_or_si128(_mm_or_si128(_mm_andnot_si128(destMask, d), v), destOr);
+                _mm_storeu_si128((__m128i*)(pd + x * 4), d);
+            }
+        }
+#endif
+        for (; x < count; ++x)
+        {
+            pd[x * 4 + destOffset] = srcOpaque ? 255 : ps[x * 4 + srcOffset];
+            if (!DestTransparent)
+                pd[x * 4 + pDestOffsets[3]] = 255;
+        }
+    }
+};
+
 void DICommand_CopyChannel::ExecuteSW(DICommandContext& context,
                                       ImageData& dest,
                                       ImageData** psrc) const
 {
     const ImageData& src = *psrc[0];
-    ImagePlane d, s;
-    dest.GetPlane(0, &d);
-    src.GetPlane(0, &s);
 
 	Point<SInt32> delta;
 	Rect<SInt32> dstClippedRect;
@@ -223,43 +579,15 @@ void DICommand_CopyChannel::ExecuteSW(DICommandContext& context,
 		return;
 	}
     
-	// Iterate & Copy
-    SInt32 x, y;
     UByte sCI = MapChannelIndex(SourceChannel);
     UByte dCI = MapChannelIndex(DestChannel);
 
     if ((sCI == 0xFF) || (dCI == 0xFF))
         return;
 
-	ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &dest);
-	ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &(*psrc[0]));
-
-    for (y = dstClippedRect.y1; y < dstClippedRect.y2; y++)
-    {
-        dstSwiz.CacheScanline(y);
-        srcSwiz.CacheScanline(y - delta.y);
-
-		for (x = dstClippedRect.x1; x < dstClippedRect.x2; x++)
-		{
-			Color dCol = dstSwiz.GetPixelInScanline(x);
-			Color sCol = srcSwiz.GetPixelInScanline(x - delta.x);
-			
-			UByte dChannels[4] = { dCol.GetRed(), dCol.GetGreen(), dCol.GetBlue(), dCol.GetAlpha() };
-			UByte sChannels[4] = { sCol.GetRed(), sCol.GetGreen(), sCol.GetBlue(), sCol.GetAlpha() };
-			
-			if (!pSource->IsTransparent())
-				sChannels[3] = 255;
-
-			dChannels[dCI] = sChannels[sCI];
-
-			if (!pImage->IsTransparent())
-				dChannels[3] = 255;
-
-			dCol.SetRGBA(dChannels[0], dChannels[1], dChannels[2], dChannels[3]);
-			
-			dstSwiz.SetPixelInScanline(x, dCol.ToColor32());
-		}
-    }
+    DICopyChannelKernel kernel(context, dest, psrc[0], dstClippedRect, delta, sCI, dCI,
+                               pSource->IsTransparent(), pImage->IsTransparent());
+    kernel.Run(pImage->GetContext());
 }
 
 void DICommand_CopyPixels::ExecuteSW(DICommandContext& context,
@@ -555,12 +883,116 @@ void DICommand_HitTest::ExecuteSW(DICommandContext& context, ImageData& dest, Im
         *Result = false;
 }
 
+class DIMergeKernel : public DIRowKernel
+{
+public:
+    DIMergeKernel(DICommandContext& context, ImageData& dest, ImageData* psrc,
+                  const Rect<SInt32>& destRect, const Point<SInt32>& delta,
+                  const UInt32* factors, bool srcTransparent, bool destTransparent) :
+        DIRowKernel(context, dest, psrc, destRect, delta),
+        SrcTransparent(srcTransparent), DestTransparent(destTransparent)
+    {
+        memcpy(Factors, factors, sizeof(Factors));
+    }
+
+protected:
+    UInt32  Factors[4];
+    bool    SrcTransparent, DestTransparent;
+
+    Color blend(Color sCol, Color dCol) const
+    {
+        UInt32 sChan[4] = { sCol.GetRed(), sCol.GetGreen(), sCol.GetBlue(), sCol.GetAlpha() };
+        UInt32 dChan[4] = { dCol.GetRed(), dCol.GetGreen(), dCol.GetBlue(), dCol.GetAlpha() };
+        UByte bChan[4];
+
+        if (!SrcTransparent)
+            sChan[3] = 255;
+        if (!DestTransparent)
+            dChan[3] = 255;
+
+        for(unsigned channel = 0; channel < 4; channel++)
+        {
+            bChan[channel] = (UByte)((sChan[channel] * Factors[channel] + dChan[channel] * (256 - Factors[channel])) >> 8);
+        }
+
+        if (!DestTransparent)
+            bChan[3] = 255;
+
+        return Color(bChan[0], bChan[1], bChan[2], bChan[3]);
+    }
+
+    virtual void executeRowsSwizzled(SInt32 y1, SInt32 y2) const
+    {
+        ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(*pSwizzler, pDest);
+        ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(*pSwizzler, pSrc);
+
+        for (SInt32 y = y1; y < y2; y++)
+        {
+            dstSwiz.CacheScanline(y);
+            srcSwiz.CacheScanline(y - Delta.y);
+
+            for (SInt32 x = DestRect.x1; x < DestRect.x2; x++)
+            {
+                Color dCol = dstSwiz.GetPixelInScanline(x);
+                Color sCol = srcSwiz.GetPixelInScanline(x - Delta.x);
+                dstSwiz.SetPixelInScanline(x, blend(sCol, dCol).ToColor32());
+            }
+        }
+    }
+
+    virtual void executeRowDirect(SInt32, UByte* pd, const UByte* ps, unsigned count) const
+    {
+        unsigned x = 0;
+#if defined(SF_ENABLE_SIMD) && defined(SF_CPU_SSE)
+        // The 16-bit lanes hold the blended sums only while all multipliers are in range.
+        if (SIMDSafe && SIMD::IS::SupportsIntegerIntrinsics() &&
+            Factors[0] <= 256 && Factors[1] <= 256 && Factors[2] <= 256 && Factors[3] <= 256)
+        {
+            // Multipliers are placed in destination byte order; source pixels of the
+            // other format have red and blue swapped to match.
+            SInt16 f[4];
+            for (unsigned c = 0; c < 4; ++c)
+                f[pDestOffsets[c]] = (SInt16)Factors[c];
+            const __m128i factor    = _mm_setr_epi16(f[0], f[1], f[2], f[3], f[0], f[1], f[2], f[3]);
+            const __m128i invFactor = _mm_sub_epi16(_mm_set1_epi16(256), factor);
+            const __m128i zero      = _mm_setzero_si128();
+            const __m128i alpha     = _mm_set1_epi32((int)0xFF000000);
+            const __m128i srcOr     = SrcTransparent  ? zero : alpha;
+            const __m128i destOr    = DestTransparent ? zero : alpha;
+            const bool    swap      = pSrcOffsets != pDestOffsets;
+
+            for (; x + 4 <= count; x += 4)
+            {
+                __m128i s   = _mm_or_si128(_mm_loadu_si128((const __m128i*)(ps + x * 4)), srcOr);
+                __m128i d   = _mm_loadu_si128((const __m128i*)(pd + x * 4));
+                __m128i slo = _mm_unpacklo_epi8(s, zero);
+                __m128i shi = _mm_unpackhi_epi8(s, zero);
+                if (swap)
+                {
+                    slo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, _MM_SHUFFLE(3,0,1,2)), _MM_SHUFFLE(3,0,1,2));
+                    shi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, _MM_SHUFFLE(3,0,1,2)), _MM_SHUFFLE(3,0,1,2));
+                }
+                __m128i rlo = _mm_add_epi16(_mm_mullo_epi16(slo, factor),
+                                            _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), invFactor));
+                __m128i rhi = _mm_add_epi16(_mm_mullo_epi16(shi, factor),
+                                            _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), invFactor));
+                __m128i r   = _mm_packus_epi16(_mm_srli_epi16(rlo, 8), _mm_srli_epi16(rhi, 8));
+                _mm_storeu_si128((__m128i*)(pd + x * 4), _mm_or_si128(r, destOr));
+            }
+        }
+#endif
+        for (; x < count; ++x)
+        {
+            Color sCol(loadDirectPixel(ps + x * 4, pSrcOffsets));
+            Color dCol(loadDirectPixel(pd + x * 4, pDestOffsets));
+            storeDirectPixel(pd + x * 4, pDestOffsets, blend(sCol, dCol).ToColor32());
+        }
+    }
+};
+
 void DICommand_Merge::ExecuteSW(DICommandContext& context, ImageData& dest, ImageData** psrc) const
 {
 	const ImageData& src = *psrc[0];
-	ImagePlane d, s;
-	dest.GetPlane(0, &d);
-	src.GetPlane(0, &s);
 
 	Point<SInt32> delta;
 	Rect<SInt32> dstClippedRect;
@@ -570,41 +1002,10 @@ void DICommand_Merge::ExecuteSW(DICommandContext& context, ImageData& dest, Imag
 		return;
 	}
 
-	ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &dest);
-	ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &(*psrc[0]));
-
-	SInt32 x, y, channel;
-	for (y = dstClippedRect.y1; y < dstClippedRect.y2; y++)
-	{
-		dstSwiz.CacheScanline(y);
-		srcSwiz.CacheScanline(y - delta.y);
-
-		for (x = dstClippedRect.x1; x < dstClippedRect.x2; x++)
-		{
-			Color dCol = dstSwiz.GetPixelInScanline(x);
-			Color sCol = srcSwiz.GetPixelInScanline(x - delta.x);
-			UInt32 factors[4] = { RedMultiplier, GreenMultiplier, BlueMultiplier, AlphaMultiplier };
-			UInt32 sChan[4] = { sCol.GetRed(), sCol.GetGreen(), sCol.GetBlue(), sCol.GetAlpha() };
-			UInt32 dChan[4] = { dCol.GetRed(), dCol.GetGreen(), dCol.GetBlue(), dCol.GetAlpha() };
-			UByte bChan[4];
-
-			if (!pSource->IsTransparent())
-				sChan[3] = 255;
-			if (!pImage->IsTransparent())
-				dChan[3] = 255;
-
-			for(channel = 0; channel < 4; channel++)
-			{
-				bChan[channel] = (UByte)((sChan[channel] * factors[channel] + dChan[channel] * (256 - factors[channel])) >> 8);
-			}
-
-			if (!pImage->IsTransparent())
-				bChan[3] = 255;
-
-			Color blendedCol(bChan[0], bChan[1], bChan[2], bChan[3]);
-			dstSwiz.SetPixelInScanline(x, blendedCol.ToColor32());
-		}
-	}
+	UInt32 factors[4] = { RedMultiplier, GreenMultiplier, BlueMultiplier, AlphaMultiplier };
+	DIMergeKernel kernel(context, dest, psrc[0], dstClippedRect, delta, factors,
+	                     pSource->IsTransparent(), pImage->IsTransparent());
+	kernel.Run(pImage->GetContext());
 }
 
 //---------------------------------------------------------------------------------------
@@ -649,12 +1050,86 @@ void DICommand_Noise::ExecuteSW(DICommandContext& context, ImageData& dest, Imag
     }
 }
 
+class DIPaletteMapKernel : public DIRowKernel
+{
+public:
+    DIPaletteMapKernel(DICommandContext& context, ImageData& dest, ImageData* psrc,
+                       const Rect<SInt32>& destRect, const Point<SInt32>& delta,
+                       const DICommand_PaletteMap& cmd, bool srcTransparent, bool destTransparent) :
+        DIRowKernel(context, dest, psrc, destRect, delta),
+        pChannels(cmd.Channels), ChannelMask(cmd.ChannelMask),
+        SrcTransparent(srcTransparent), DestTransparent(destTransparent)
+    { }
+
+protected:
+    const UInt32*   pChannels;
+    unsigned        ChannelMask;
+    bool            SrcTransparent, DestTransparent;
+
+    UInt32 map(Color sCol) const
+    {
+        if (!SrcTransparent)
+            sCol.SetAlpha(255);
+
+        // Retrieve source channels
+        UByte rgba[4];
+        UInt32 outCols[4];
+        UInt32 total = 0;
+        sCol.GetRGBA(rgba + 0, rgba + 1, rgba + 2, rgba + 3);
+
+        outCols[3] = rgba[3] << 24;
+        outCols[0] = rgba[0] << 16;
+        outCols[1] = rgba[1] << 8;
+        outCols[2] = rgba[2];
+
+        // Remap channels as necessary
+        for(unsigned channel = 0; channel < 4; channel++)
+        {
+            if(ChannelMask & (1 << channel))
+            {
+                outCols[channel] = pChannels[channel*(DICommand_PaletteMap::ChannelSize/sizeof(UInt32)) + rgba[channel]];
+            }
+            total += outCols[channel];
+        }
+
+        if (!DestTransparent)
+            total |= (UInt32)255 << 24;
+        return total;
+    }
+
+    virtual void executeRowsSwizzled(SInt32 y1, SInt32 y2) const
+    {
+        ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(*pSwizzler, pDest);
+        ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(*pSwizzler, pSrc);
+
+        for (SInt32 y = y1; y < y2; y++)
+        {
+            dstSwiz.CacheScanline(y);
+            srcSwiz.CacheScanline(y - Delta.y);
+
+            for (SInt32 x = DestRect.x1; x < DestRect.x2; x++)
+            {
+                Color dCol(map(srcSwiz.GetPixelInScanline(x - Delta.x)));
+                dstSwiz.SetPixelInScanline(x, dCol.ToColor32());
+            }
+        }
+    }
+
+    // Table lookups have no SSE2 equivalent, so the direct path only avoids
+    // the per pixel swizzler calls.
+    virtual void executeRowDirect(SInt32, UByte* pd, const UByte* ps, unsigned count) const
+    {
+        for (unsigned x = 0; x < count; ++x)
+        {
+            Color sCol(loadDirectPixel(ps + x * 4, pSrcOffsets));
+            storeDirectPixel(pd + x * 4, pDestOffsets, map(sCol));
+        }
+    }
+};
+
 void DICommand_PaletteMap::ExecuteSW(DICommandContext& context, ImageData& dest, ImageData** psrc) const
 {
 	const ImageData& src = *psrc[0];
-	ImagePlane d, s;
-	dest.GetPlane(0, &d);
-	src.GetPlane(0, &s);
 
 	Point<SInt32> delta;
 	Rect<SInt32> dstClippedRect;
@@ -664,51 +1139,9 @@ void DICommand_PaletteMap::ExecuteSW(DICommandContext& context, ImageData& dest,
 		return;
 	}
 
-	ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &dest);
-	ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &(*psrc[0]));
-
-	SInt32 x, y, channel;
-	for (y = dstClippedRect.y1; y < dstClippedRect.y2; y++)
-	{
-		dstSwiz.CacheScanline(y);
-		srcSwiz.CacheScanline(y - delta.y);
-
-		for (x = dstClippedRect.x1; x < dstClippedRect.x2; x++)
-		{
-			Color sCol = srcSwiz.GetPixelInScanline(x - delta.x);
-			
-			if (!pSource->IsTransparent())
-				sCol.SetAlpha(255);
-
-			// Retrieve source channels
-			UByte rgba[4];
-			UInt32 outCols[4];
-			UInt32 total = 0;
-			sCol.GetRGBA(rgba + 0, rgba + 1, rgba + 2, rgba + 3);
-			
-			outCols[3] = rgba[3] << 24;
-			outCols[0] = rgba[0] << 16;
-			outCols[1] = rgba[1] << 8;
-			outCols[2] = rgba[2];
-			
-			// Remap channels as necessary
-			for(channel = 0; channel < 4; channel++)
-			{
-				if(ChannelMask & (1 << channel))
-				{
-					outCols[channel] = Channels[channel*(ChannelSize/sizeof(UInt32)) + rgba[channel]];
-				}
-				total += outCols[channel];
-			}
-
-			if (!pImage->IsTransparent())
-                total |= (UInt32)255 << 24;
-
-			Color  dCol(total);
-
-			dstSwiz.SetPixelInScanline(x, dCol.ToColor32());
-		}
-	}
+	DIPaletteMapKernel kernel(context, dest, psrc[0], dstClippedRect, delta, *this,
+	                          pSource->IsTransparent(), pImage->IsTransparent());
+	kernel.Run(pImage->GetContext());
 }
 
 // PerlineGenerator is dervied from: http://freespace.virgin.net/hugo.elias/models/m_perlin.htm
@@ -793,6 +1226,100 @@ const PerlinGenerator::NoisePrimeSet PerlinGenerator::NoisePrimeFactors[] =
     {{ 43, 28657, 199669, 2299553}}
 };
 
+class DIPerlinNoiseKernel : public DIRowKernel
+{
+public:
+    DIPerlinNoiseKernel(DICommandContext& context, ImageData& dest,
+                        const DICommand_PerlinNoise& cmd, unsigned channelMask, bool destTransparent) :
+        DIRowKernel(context, dest, 0, Rect<SInt32>(dest.GetSize()), Point<SInt32>(0, 0)),
+        pCmd(&cmd), ChannelMask(channelMask), DestTransparent(destTransparent)
+    { }
+
+protected:
+    const DICommand_PerlinNoise* pCmd;
+    unsigned                     ChannelMask;
+    bool                         DestTransparent;
+
+    Color computeColor(PerlinGenerator* generators, unsigned x, unsigned y) const
+    {
+        Color color(0xFF000000);
+        unsigned channelCount = DestTransparent ? 4 : 3;
+        for ( unsigned channel = 0; channel < channelCount; ++ channel )
+        {
+            if ( (ChannelMask & 1<<channel ) == 0 )
+                continue;
+            PerlinGenerator& generator = generators[channel];
+
+            // Compute all the octaves/channels for the particular pixel.
+            float freqX = 2.0f / pCmd->FrequencyX;
+            float freqY = 2.0f / pCmd->FrequencyY;
+            float amplitude = 1.0f;
+            float noise = 0.0f;
+            float fmax  = 0.0f;
+            for ( unsigned octave = 0; octave < pCmd->NumOctaves; ++octave )
+            {
+                float xPos = x*freqX;
+                float yPos = y*freqY;
+                if(octave < pCmd->OffsetCount)
+                {
+                    xPos += pCmd->Offsets[octave*2+0];
+                    yPos += pCmd->Offsets[octave*2+1];
+                }
+                noise += (1.0f + generator.InterpolatedNoise(xPos, yPos)) * 0.5f * amplitude;
+                freqX *= 2.0f;
+                freqY *= 2.0f;
+                fmax += amplitude;
+                amplitude /= 2.0f;
+            }
+            noise /= fmax;
+
+            if ( pCmd->GrayScale && channel != 3)
+            {
+                color.SetRGBFloat(noise,noise,noise);
+            }
+            else
+            {
+                switch(channel)
+                {
+                default:
+                case 0: color.SetRed((UByte)(255*noise)); break;
+                case 1: color.SetGreen((UByte)(255*noise)); break;
+                case 2: color.SetBlue((UByte)(255*noise)); break;
+                case 3: color.SetAlpha((UByte)(255*noise)); break;
+                }
+            }
+        }
+
+        if (!DestTransparent)
+            color.SetAlpha(255);
+        return color;
+    }
+
+    // Generators only depend on the seed and channel, so they are created once
+    // per call rather than for every pixel.
+    virtual void executeRowsSwizzled(SInt32 y1, SInt32 y2) const
+    {
+        PerlinGenerator generators[4] = { PerlinGenerator(pCmd->RandomSeed, 0), PerlinGenerator(pCmd->RandomSeed, 1),
+                                          PerlinGenerator(pCmd->RandomSeed, 2), PerlinGenerator(pCmd->RandomSeed, 3) };
+        ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(*pSwizzler, pDest);
+
+        for (SInt32 y = y1; y < y2; ++y)
+        {
+            dstSwiz.CacheScanline(y);
+            for (SInt32 x = DestRect.x1; x < DestRect.x2; ++x)
+                dstSwiz.SetPixelInScanline(x, computeColor(generators, x, y).ToColor32());
+        }
+    }
+
+    virtual void executeRowDirect(SInt32 y, UByte* pd, const UByte*, unsigned count) const
+    {
+        PerlinGenerator generators[4] = { PerlinGenerator(pCmd->RandomSeed, 0), PerlinGenerator(pCmd->RandomSeed, 1),
+                                          PerlinGenerator(pCmd->RandomSeed, 2), PerlinGenerator(pCmd->RandomSeed, 3) };
+        for (unsigned x = 0; x < count; ++x)
+            storeDirectPixel(pd + x * 4, pDestOffsets, computeColor(generators, x, y).ToColor32());
+    }
+};
+
 void DICommand_PerlinNoise::ExecuteSW(DICommandContext& context, ImageData& dest, ImageData**) const
 {
 	unsigned channelMask = ChannelMask;
@@ -805,68 +1332,10 @@ void DICommand_PerlinNoise::ExecuteSW(DICommandContext& context, ImageData& dest
 		channelMask |=  DrawableImage::Channel_Red;
 	}
 
-	ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &dest);
-
-	for ( unsigned y = 0; y < dest.GetSize().Height; ++y )
-	{
-		dstSwiz.CacheScanline(y);
-		for ( unsigned x = 0; x < dest.GetSize().Width; ++x )
-		{
-			Color color(0xFF000000);
-			unsigned channelCount = pImage->IsTransparent() ? 4 : 3;
-			for ( unsigned channel = 0; channel < channelCount; ++ channel )
-			{
-				if ( (channelMask & 1<<channel ) == 0 )
-					continue;
-				PerlinGenerator generator(RandomSeed, channel);
-
-				// Compute all the octaves/channels for the particular pixel.
-                float freqX = 2.0f / FrequencyX;
-                float freqY = 2.0f / FrequencyY;
-                float amplitude = 1.0f;
-                float noise = 0.0f;
-                float fmax  = 0.0f;
-                for ( unsigned octave = 0; octave < NumOctaves; ++octave )
-                {
-					float xPos = x*freqX;
-					float yPos = y*freqY;
-					if(octave < OffsetCount)
-					{
-						xPos += Offsets[octave*2+0];
-						yPos += Offsets[octave*2+1];
-					}
-                    noise += (1.0f + generator.InterpolatedNoise(xPos, yPos)) * 0.5f * amplitude;
-                    freqX *= 2.0f;
-                    freqY *= 2.0f;
-                    fmax += amplitude;
-                    amplitude /= 2.0f;
-                }
-                noise /= fmax;
-
-                if ( GrayScale && channel != 3)
-                {
-                    color.SetRGBFloat(noise,noise,noise);
-                }
-                else
-                {
-                    switch(channel)
-                    {
-                    default:
-                    case 0: color.SetRed((UByte)(255*noise)); break;
-                    case 1: color.SetGreen((UByte)(255*noise)); break;
-                    case 2: color.SetBlue((UByte)(255*noise)); break;
-                    case 3: color.SetAlpha((UByte)(255*noise)); break;
-                    }
-                }
-			}
-			
-			if (!pImage->IsTransparent())
-				color.SetAlpha(255);
-
-			// Now actually set the pixel
-			dstSwiz.SetPixelInScanline(x, color.ToColor32());
-        }
-    }
+	// Noise is computed independently for every pixel, so this is the command that
+	// gains the most from row band parallelism.
+	DIPerlinNoiseKernel kernel(context, dest, *this, channelMask, pImage->IsTransparent());
+	kernel.Run(pImage->GetContext());
 }
 
 // PixelDisolve
@@ -1066,12 +1535,138 @@ void DICommand_SetPixels::ExecuteSW(DICommandContext& context, ImageData& dest,
     if(Result)
         *Result = true;
 }
+class DIThresholdKernel : public DIRowKernel
+{
+public:
+    DIThresholdKernel(DICommandContext& context, ImageData& dest, ImageData* psrc,
+                      const Rect<SInt32>& destRect, const Point<SInt32>& delta,
+                      const DICommand_Threshold& cmd, bool srcTransparent, bool destTransparent) :
+        DIRowKernel(context, dest, psrc, destRect, delta),
+        Operation(cmd.Operation), Threshold(cmd.Threshold), ThresholdColor(cmd.ThresholdColor), Mask(cmd.Mask),
+        SrcTransparent(srcTransparent), DestTransparent(destTransparent)
+    { }
+
+protected:
+    DrawableImage::OperationType Operation;
+    UInt32  Threshold, ThresholdColor, Mask;
+    bool    SrcTransparent, DestTransparent;
+
+    UInt32 threshold(Color sCol) const
+    {
+        UInt32 rVal = Threshold & Mask;
+        UInt32 lVal = sCol.ToColor32() & Mask;
+
+        bool compareSuccess = false;
+
+        switch(Operation)
+        {
+        case DrawableImage::Operator_EQ:
+            compareSuccess = (lVal == rVal);
+            break;
+        case DrawableImage::Operator_GE:
+            compareSuccess = (lVal >= rVal);
+            break;
+        case DrawableImage::Operator_GT:
+            compareSuccess = (lVal > rVal);
+            break;
+        case DrawableImage::Operator_LE:
+            compareSuccess = (lVal <= rVal);
+            break;
+        case DrawableImage::Operator_LT:
+            compareSuccess = (lVal < rVal);
+            break;
+        case DrawableImage::Operator_NE:
+            compareSuccess = (lVal != rVal);
+            break;
+        }
+
+        if (!SrcTransparent)
+            sCol.SetAlpha(255);
+
+        UInt32 outColor = compareSuccess ? ThresholdColor : sCol.ToColor32();
+
+        if (!DestTransparent)
+            outColor |= (UInt32)255 << 24;
+        return outColor;
+    }
+
+    virtual void executeRowsSwizzled(SInt32 y1, SInt32 y2) const
+    {
+        ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(*pSwizzler, pDest);
+        ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(*pSwizzler, pSrc);
+
+        for (SInt32 y = y1; y < y2; y++)
+        {
+            dstSwiz.CacheScanline(y);
+            srcSwiz.CacheScanline(y - Delta.y);
+
+            for (SInt32 x = DestRect.x1; x < DestRect.x2; x++)
+                dstSwiz.SetPixelInScanline(x, threshold(srcSwiz.GetPixelInScanline(x - Delta.x)));
+        }
+    }
+
+#if defined(SF_ENABLE_SIMD) && defined(SF_CPU_SSE)
+    // Returns all bits set in the lanes where the comparison of the masked
+    // Color32 values succeeds. SSE2 only compares signed integers, so both
+    // sides are biased by 0x80000000 first.
+    __m128i compareSSE(__m128i l, __m128i r) const
+    {
+        switch(Operation)
+        {
+        case DrawableImage::Operator_EQ:    return _mm_cmpeq_epi32(l, r);
+        case DrawableImage::Operator_NE:    return _mm_xor_si128(_mm_cmpeq_epi32(l, r), _mm_set1_epi32(-1));
+        case DrawableImage::Operator_GT:    return _mm_cmpgt_epi32(l, r);
+        case DrawableImage::Operator_LT:    return _mm_cmpgt_epi32(r, l);
+        case DrawableImage::Operator_GE:    return _mm_xor_si128(_mm_cmpgt_epi32(r, l), _mm_set1_epi32(-1));
+        case DrawableImage::Operator_LE:    return _mm_xor_si128(_mm_cmpgt_epi32(l, r), _mm_set1_epi32(-1));
+        default:                            return _mm_setzero_si128();
+        }
+    }
+#endif
+
+    virtual void executeRowDirect(SInt32, UByte* pd, const UByte* ps, unsigned count) const
+    {
+        unsigned x = 0;
+#if defined(SF_ENABLE_SIMD) && defined(SF_CPU_SSE)
+        if (SIMDSafe && SIMD::IS::SupportsIntegerIntrinsics())
+        {
+            // Pixels are compared as Color32 values, which share the B8G8R8A8 layout.
+            const __m128i bias     = _mm_set1_epi32((int)0x80000000);
+            const __m128i mask     = _mm_set1_epi32((int)Mask);
+            const __m128i rVal     = _mm_xor_si128(_mm_set1_epi32((int)(Threshold & Mask)), bias);
+            const __m128i color    = _mm_set1_epi32((int)ThresholdColor);
+            const __m128i alpha    = _mm_set1_epi32((int)0xFF000000);
+            const __m128i srcOr    = SrcTransparent  ? _mm_setzero_si128() : alpha;
+            const __m128i destOr   = DestTransparent ? _mm_setzero_si128() : alpha;
+            const bool    srcSwap  = pSrcOffsets  == DirectOffsets_R8G8B8A8;
+            const bool    destSwap = pDestOffsets == DirectOffsets_R8G8B8A8;
+
+            for (; x + 4 <= count; x += 4)
+            {
+                __m128i s = _mm_loadu_si128((const __m128i*)(ps + x * 4));
+                if (srcSwap)
+                    s = swapRedBlueSSE(s);
+                __m128i success = compareSSE(_mm_xor_si128(_mm_and_si128(s, mask), bias), rVal);
+                s = _mm_or_si128(s, srcOr);
+                __m128i out = _mm_or_si128(_mm_or_si128(_mm_and_si128(success, color),
+                                                        _mm_andnot_si128(success, s)), destOr);
+                if (destSwap)
+                    out = swapRedBlueSSE(out);
+                _mm_storeu_si128((__m128i*)(pd + x * 4), out);
+            }
+        }
+#endif
+        for (; x < count; ++x)
+        {
+            Color sCol(loadDirectPixel(ps + x * 4, pSrcOffsets));
+            storeDirectPixel(pd + x * 4, pDestOffsets, threshold(sCol));
+        }
+    }
+};
+
 void DICommand_Threshold::ExecuteSW(DICommandContext& context, ImageData& dest, ImageData** psrc) const
 {
 	const ImageData& src = *psrc[0];
-	ImagePlane d, s;
-	dest.GetPlane(0, &d);
-	src.GetPlane(0, &s);
 
 	Point<SInt32> delta;
 	Rect<SInt32> dstClippedRect;
@@ -1081,57 +1676,9 @@ void DICommand_Threshold::ExecuteSW(DICommandContext& context, ImageData& dest,
 		return;
 	}
 
-	ImageSwizzlerContext dstSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &dest);
-	ImageSwizzlerContext srcSwiz = ImageSwizzlerContext(context.pHAL->GetTextureManager()->GetImageSwizzler(), &(*psrc[0]));
-
-	// Iterate & Copy
-	SInt32 x, y;
-	for (y = dstClippedRect.y1; y < dstClippedRect.y2; y++)
-	{
-		dstSwiz.CacheScanline(y);
-		srcSwiz.CacheScanline(y - delta.y);
-
-		for (x = dstClippedRect.x1; x < dstClippedRect.x2; x++)
-		{
-			Color sCol = srcSwiz.GetPixelInScanline(x - delta.x);
-			UInt32 rVal = Threshold & Mask;
-			UInt32 lVal = sCol.ToColor32() & Mask;
-
-			bool compareSuccess = false;
-			
-			switch(Operation)
-			{
-			case DrawableImage::Operator_EQ:
-				compareSuccess = (lVal == rVal);
-				break;
-			case DrawableImage::Operator_GE:
-				compareSuccess = (lVal >= rVal);
-				break;
-			case DrawableImage::Operator_GT:
-				compareSuccess = (lVal > rVal);
-				break;
-			case DrawableImage::Operator_LE:
-				compareSuccess = (lVal <= rVal);
-				break;
-			case DrawableImage::Operator_LT:
-				compareSuccess = (lVal < rVal);
-				break;
-			case DrawableImage::Operator_NE:
-				compareSuccess = (lVal != rVal);
-				break;
-			}
-
-			if (!pSource->IsTransparent())
-				sCol.SetAlpha(255);
-
-			UInt32 outColor = compareSuccess ? ThresholdColor : sCol.ToColor32();
-			
-			if (!pImage->IsTransparent())
-                outColor |= (UInt32)255 << 24;
-
-			dstSwiz.SetPixelInScanline(x, outColor);
-		}
-	}
+	DIThresholdKernel kernel(context, dest, psrc[0], dstClippedRect, delta, *this,
+	                         pSource->IsTransparent(), pImage->IsTransparent());
+	kernel.Run(pImage->GetContext());
 }
 
 }}; // namespace Scaleform::Render
@@ -0,0 +1,447 @@
+/**************************************************************************
+
+Filename    :   Render_FiltersSW.cpp
+Content     :   Software (CPU) implementation of the renderer filters.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Render/Render_FiltersSW.h"
+#include "Kernel/SF_Alg.h"
+#include "Kernel/SF_Memory.h"
+#include "Kernel/SF_Math.h"
+#include "Kernel/SF_SIMD.h"
+
+namespace Scaleform { namespace Render {
+
+//------------------------------------------------------------------------
+// Box blur of one line of pixels, in place. Matches the box blur shaders:
+// a kernel of 'width' samples centered on the pixel; even widths sample
+// between texels, which is equivalent to width+1 taps with half-weighted
+// ends. Texture clamping is reproduced by replicating the edge pixels.
+//
+// The window sum S covers padded samples x .. x + 2*half, where padded sample
+// i is source pixel i - half clamped to the line; even widths use
+// 2*S - p(x) - p(x + 2*half). pline is first copied into pscratch, which must
+// hold 'count' pixels.
+
+static inline const UByte* paddedPixel(const UInt32* pscratch, int i, int half, int last)
+{
+    return (const UByte*)(pscratch + Alg::Clamp<int>(i - half, 0, last));
+}
+
+#if defined(SF_ENABLE_SIMD) && defined(SF_CPU_SSE)
+
+// Blurs all four channels at once, one pixel per 32-bit lane set.
+static inline __m128i loadPixelSSE(const UInt32* pscratch, int i, int half, int last)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i p = _mm_cvtsi32_si128(*(const int*)paddedPixel(pscratch, i, half, last));
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(p, zero), zero);
+}
+
+static void boxBlurLineSSE(UByte* pline, SPInt stride, unsigned count, unsigned width,
+                           const UInt32* pscratch)
+{
+    const int    half = (int)(width / 2);
+    const bool   even = (width & 1) == 0;
+    const int    den  = even ? (int)width * 2 : (int)width;
+    const int    last = (int)count - 1;
+
+    // (total + den/2) / den, computed in float. The quotient estimated with the
+    // reciprocal can be off by one; it is corrected with the remainder, which
+    // is exact in float since both total and quotient * den are below 2^24.
+    const __m128  denf    = _mm_set1_ps((float)den);
+    const __m128  recip   = _mm_set1_ps(1.0f / (float)den);
+    const __m128  one     = _mm_set1_ps(1.0f);
+    const __m128  zero    = _mm_setzero_ps();
+    const __m128i rounder = _mm_set1_epi32(den / 2);
+
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i <= 2*half; ++i)
+        sum = _mm_add_epi32(sum, loadPixelSSE(pscratch, i, half, last));
+
+    for (int x = 0; x < (int)count; ++x)
+    {
+        __m128i first = loadPixelSSE(pscratch, x, half, last);
+        __m128i total = sum;
+        if (even)
+        {
+            __m128i end = loadPixelSSE(pscratch, x + 2*half, half, last);
+            total = _mm_sub_epi32(_mm_add_epi32(sum, sum), _mm_add_epi32(first, end));
+        }
+
+        __m128  n = _mm_cvtepi32_ps(_mm_add_epi32(total, rounder));
+        __m128  q = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(n, recip)));
+        __m128  r = _mm_sub_ps(n, _mm_mul_ps(q, denf));
+        q = _mm_add_ps(q, _mm_and_ps(_mm_cmpge_ps(r, denf), one));
+        q = _mm_sub_ps(q, _mm_and_ps(_mm_cmplt_ps(r, zero), one));
+
+        __m128i result = _mm_cvttps_epi32(q);
+        result = _mm_packs_epi32(result, result);
+        result = _mm_packus_epi16(result, result);
+        *(int*)(pline + x * stride) = _mm_cvtsi128_si32(result);
+
+        sum = _mm_add_epi32(sum, _mm_sub_epi32(loadPixelSSE(pscratch, x + 2*half + 1, half, last), first));
+    }
+}
+
+#endif // SF_ENABLE_SIMD && SF_CPU_SSE
+
+static void boxBlurLine(UByte* pline, SPInt stride, unsigned count, unsigned width,
+                        unsigned firstChannel, UInt32* pscratch)
+{
+    if (width <= 1 || count == 0)
+        return;
+
+    for (unsigned i = 0; i < count; ++i)
+        memcpy(pscratch + i, pline + i * stride, 4);
+
+#if defined(SF_ENABLE_SIMD) && defined(SF_CPU_SSE)
+    // The SSE division is exact for denominators below 2^16.
+    if (firstChannel == 0 && width < 0x8000 && SIMD::IS::SupportsIntegerIntrinsics())
+    {
+        boxBlurLineSSE(pline, stride, count, width, pscratch);
+        return;
+    }
+#endif
+
+    const int      half = (int)(width / 2);
+    const bool     even = (width & 1) == 0;
+    const UInt32   den  = even ? width * 2 : width;
+    const int      last = (int)count - 1;
+
+    for (unsigned c = firstChannel; c < 4; ++c)
+    {
+        UInt32 sum = 0;
+        for (int i = 0; i <= 2*half; ++i)
+            sum += paddedPixel(pscratch, i, half, last)[c];
+
+        for (int x = 0; x < (int)count; ++x)
+        {
+            UInt32 first = paddedPixel(pscratch, x, half, last)[c];
+            UInt32 total = sum;
+            if (even)
+                total = sum * 2 - first - paddedPixel(pscratch, x + 2*half, half, last)[c];
+
+            pline[x * stride + c] = (UByte)((total + den / 2) / den);
+            sum += paddedPixel(pscratch, x + 2*half + 1, half, last)[c] - first;
+        }
+    }
+}
+
+static void copyPlane(const ImagePlane& dest, const ImagePlane& src)
+{
+    if (dest.pData == src.pData)
+        return;
+    UPInt rowSize = src.Width * 4;
+    for (unsigned y = 0; y < src.Height; ++y)
+        memcpy(dest.pData + y * dest.Pitch, src.pData + y * src.Pitch, rowSize);
+}
+
+void BlurPlaneSW(const ImagePlane& dest, const ImagePlane& src,
+                 unsigned blurX, unsigned blurY, unsigned passes, bool alphaOnly)
+{
+    SF_ASSERT(dest.Width == src.Width && dest.Height == src.Height);
+    copyPlane(dest, src);
+
+    if (dest.Width == 0 || dest.Height == 0)
+        return;
+
+    unsigned firstChannel = alphaOnly ? 3 : 0;
+    unsigned maxCount     = Alg::Max(dest.Width, dest.Height);
+    UInt32*  pscratch     = (UInt32*)SF_ALLOC(sizeof(UInt32) * maxCount, StatRender_Mem);
+    if (!pscratch)
+        return;
+
+    for (unsigned pass = 0; pass < passes; ++pass)
+    {
+        if (blurX > 1)
+        {
+            for (unsigned y = 0; y < dest.Height; ++y)
+                boxBlurLine(dest.pData + y * dest.Pitch, 4, dest.Width, blurX, firstChannel, pscratch);
+        }
+        if (blurY > 1)
+        {
+            for (unsigned x = 0; x < dest.Width; ++x)
+                boxBlurLine(dest.pData + x * 4, (SPInt)dest.Pitch, dest.Height, blurY, firstChannel, pscratch);
+        }
+    }
+    SF_FREE(pscratch);
+}
+
+
+//------------------------------------------------------------------------
+// Bilinear, clamped fetch of the alpha channel at pixel coordinates (x,y),
+// where integer coordinates address texel centers.
+static inline float sampleAlpha(const ImagePlane& plane, float x, float y)
+{
+    float fx = floorf(x), fy = floorf(y);
+    float tx = x - fx,    ty = y - fy;
+    int   x0 = (int)fx,   y0 = (int)fy;
+    int   maxx = (int)plane.Width - 1, maxy = (int)plane.Height - 1;
+    int   x1 = Alg::Clamp(x0 + 1, 0, maxx), y1 = Alg::Clamp(y0 + 1, 0, maxy);
+    x0 = Alg::Clamp(x0, 0, maxx);
+    y0 = Alg::Clamp(y0, 0, maxy);
+
+    const UByte* row0 = plane.pData + y0 * plane.Pitch + 3;
+    const UByte* row1 = plane.pData + y1 * plane.Pitch + 3;
+    float a0 = row0[x0*4] + (row0[x1*4] - row0[x0*4]) * tx;
+    float a1 = row1[x0*4] + (row1[x1*4] - row1[x0*4]) * tx;
+    return (a0 + (a1 - a0) * ty) * (1.0f / 255.0f);
+}
+
+static inline UByte toByte(float v)
+{
+    return (UByte)(Alg::Clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// Composes the shadow, glow and bevel filters from the original image and its
+// blurred alpha; the per-pixel math follows the corresponding final-pass shaders.
+static void composeShadow(const BlurFilterParams& params, const ImagePlane& dest,
+                          const ImagePlane& src, const ImagePlane& blurred)
+{
+    FilterType type  = params.GetFilterType();
+    unsigned   mode  = params.Mode;
+    float      str   = params.Strength;
+    float      offx  = -TwipsToPixels(params.Offset.x);
+    float      offy  = -TwipsToPixels(params.Offset.y);
+    float      scolor[4], scolor2[4];
+    params.Colors[0].GetRGBAFloat(scolor);
+    params.Colors[1].GetRGBAFloat(scolor2);
+
+    const bool inner     = (mode & BlurFilterParams::Mode_Inner) != 0;
+    const bool knockout  = (mode & BlurFilterParams::Mode_Knockout) != 0;
+    const bool hide      = (mode & BlurFilterParams::Mode_HideObject) != 0;
+    const bool highlight = (mode & BlurFilterParams::Mode_Highlight) != 0;
+
+    for (unsigned y = 0; y < dest.Height; ++y)
+    {
+        const UByte* psrc  = src.pData + y * src.Pitch;
+        UByte*       pdest = dest.pData + y * dest.Pitch;
+
+        for (unsigned x = 0; x < dest.Width; ++x, psrc += 4, pdest += 4)
+        {
+            float base[4] = { psrc[0] * (1.0f/255.0f), psrc[1] * (1.0f/255.0f),
+                              psrc[2] * (1.0f/255.0f), psrc[3] * (1.0f/255.0f) };
+            float out[4];
+
+            if (type == Filter_Bevel)
+            {
+                float a = sampleAlpha(blurred, x + offx, y + offy);
+                float r = sampleAlpha(blurred, x - offx, y - offy);
+                float sa = Alg::Clamp((r - a) * str, 0.0f, 1.0f);
+                float hr = Alg::Clamp((a - r) * str, 0.0f, 1.0f);
+                float rest = 1.0f - sa - hr;
+
+                for (unsigned c = 0; c < 4; ++c)
+                {
+                    float bevel = scolor[c] * sa + scolor2[c] * hr;
+                    if (inner)
+                    {
+                        out[c] = (bevel + base[c] * rest) * base[3];
+                        if (knockout)
+                            out[c] -= base[c] * rest * base[3];
+                    }
+                    else if (highlight)
+                    {
+                        if (knockout)
+                            out[c] = bevel;
+                        else
+                            out[c] = bevel + base[c] * rest;
+                    }
+                    else
+                    {
+                        out[c] = bevel * (1.0f - base[3]) + base[c];
+                        if (knockout)
+                            out[c] -= base[c];
+                    }
+                }
+            }
+            else
+            {
+                float a = sampleAlpha(blurred, x + offx, y + offy);
+
+                if (inner)
+                {
+                    // Inner+Hide is identical to Inner+Knockout.
+                    float lerp = Alg::Clamp((base[3] - a) * str, 0.0f, 1.0f);
+                    for (unsigned c = 0; c < 4; ++c)
+                    {
+                        out[c] = (base[c] + (scolor[c] - base[c]) * lerp) * base[3];
+                        if (knockout || hide)
+                            out[c] -= base[c] * (1.0f - lerp) * base[3];
+                    }
+                }
+                else if (hide && !knockout)
+                {
+                    float k = Alg::Clamp(a * str, 0.0f, 1.0f);
+                    for (unsigned c = 0; c < 4; ++c)
+                        out[c] = scolor[c] * k;
+                }
+                else
+                {
+                    float k = Alg::Clamp(a * (1.0f - base[3]) * str, 0.0f, 1.0f);
+                    for (unsigned c = 0; c < 4; ++c)
+                    {
+                        out[c] = scolor[c] * k + base[c];
+                        if (knockout)
+                            out[c] -= base[c];
+                    }
+                }
+            }
+
+            pdest[0] = toByte(out[0]);
+            pdest[1] = toByte(out[1]);
+            pdest[2] = toByte(out[2]);
+            pdest[3] = toByte(out[3]);
+        }
+    }
+}
+
+static void applyColorMatrix(const ColorMatrixFilter& filter, const ImagePlane& dest, const ImagePlane& src)
+{
+    float m[ColorMatrixFilter::ColorMatrixEntries];
+    for (unsigned i = 0; i < ColorMatrixFilter::ColorMatrixEntries; ++i)
+        m[i] = filter[i];
+    const float* add = m + 16;
+
+#if defined(SF_ENABLE_SIMD)
+    using namespace Scaleform::SIMD;
+
+    // Transposed matrix, so that each input channel scales one column.
+    SF_SIMD_ALIGN(float columns[5][4]);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        for (unsigned j = 0; j < 4; ++j)
+            columns[i][j] = m[j*4 + i];
+        columns[4][i] = add[i];
+    }
+    SF_SIMD_ALIGN(float limits[2][4]) = { { 0.0f, 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f } };
+    SF_SIMD_ALIGN(float factors[2][4]) = { { 255.0f, 255.0f, 255.0f, 255.0f }, { 0.5f, 0.5f, 0.5f, 0.5f } };
+
+    Vector4f col0   = IS::LoadAligned(columns[0]);
+    Vector4f col1   = IS::LoadAligned(columns[1]);
+    Vector4f col2   = IS::LoadAligned(columns[2]);
+    Vector4f col3   = IS::LoadAligned(columns[3]);
+    Vector4f addv   = IS::LoadAligned(columns[4]);
+    Vector4f addA   = IS::Splat<3>(addv);
+    Vector4f zero   = IS::LoadAligned(limits[0]);
+    Vector4f one    = IS::LoadAligned(limits[1]);
+    Vector4f scale  = IS::LoadAligned(factors[0]);
+    Vector4f bias   = IS::LoadAligned(factors[1]);
+
+    SF_SIMD_ALIGN(float c[4]);
+    for (unsigned y = 0; y < dest.Height; ++y)
+    {
+        const UByte* psrc  = src.pData + y * src.Pitch;
+        UByte*       pdest = dest.pData + y * dest.Pitch;
+
+        for (unsigned x = 0; x < dest.Width; ++x, psrc += 4, pdest += 4)
+        {
+            c[0] = psrc[0] * (1.0f/255.0f);
+            c[1] = psrc[1] * (1.0f/255.0f);
+            c[2] = psrc[2] * (1.0f/255.0f);
+            c[3] = psrc[3] * (1.0f/255.0f);
+            Vector4f cv = IS::LoadAligned(c);
+
+            Vector4f v = IS::Multiply(addv, IS::Add(IS::Splat<3>(cv), addA));
+            v = IS::MultiplyAdd(IS::Splat<0>(cv), col0, v);
+            v = IS::MultiplyAdd(IS::Splat<1>(cv), col1, v);
+            v = IS::MultiplyAdd(IS::Splat<2>(cv), col2, v);
+            v = IS::MultiplyAdd(IS::Splat<3>(cv), col3, v);
+            v = IS::MultiplyAdd(IS::Min(IS::Max(v, zero), one), scale, bias);
+            IS::StoreAligned(c, v);
+
+            pdest[0] = (UByte)c[0];
+            pdest[1] = (UByte)c[1];
+            pdest[2] = (UByte)c[2];
+            pdest[3] = (UByte)c[3];
+        }
+    }
+#else
+    for (unsigned y = 0; y < dest.Height; ++y)
+    {
+        const UByte* psrc  = src.pData + y * src.Pitch;
+        UByte*       pdest = dest.pData + y * dest.Pitch;
+
+        for (unsigned x = 0; x < dest.Width; ++x, psrc += 4, pdest += 4)
+        {
+            float c[4] = { psrc[0] * (1.0f/255.0f), psrc[1] * (1.0f/255.0f),
+                           psrc[2] * (1.0f/255.0f), psrc[3] * (1.0f/255.0f) };
+            float addScale = c[3] + add[3];
+            for (unsigned j = 0; j < 4; ++j)
+            {
+                const float* row = m + j*4;
+                float v = c[0]*row[0] + c[1]*row[1] + c[2]*row[2] + c[3]*row[3] + add[j] * addScale;
+                pdest[j] = toByte(v);
+            }
+        }
+    }
+#endif
+}
+
+
+//------------------------------------------------------------------------
+bool IsFilterSupportedSW(const Filter* filter)
+{
+    if (!filter)
+        return false;
+    FilterType type = filter->GetFilterType();
+    return (type <= Filter_Blur_End) || (type == Filter_ColorMatrix);
+}
+
+bool ApplyFilterSW(const Filter* filter, const ImagePlane& dest, const ImagePlane& src)
+{
+    if (!IsFilterSupportedSW(filter))
+        return false;
+
+    SF_ASSERT(dest.Width == src.Width && dest.Height == src.Height);
+    SF_ASSERT(dest.pData != src.pData);
+
+    if (filter->GetFilterType() == Filter_ColorMatrix)
+    {
+        applyColorMatrix(*(const ColorMatrixFilter*)filter, dest, src);
+        return true;
+    }
+
+    const BlurFilterParams& params = ((const BlurFilterImpl*)filter)->GetParams();
+    unsigned blurX = (unsigned)Alg::Max(1.0f, floorf(TwipsToPixels(params.BlurX)));
+    unsigned blurY = (unsigned)Alg::Max(1.0f, floorf(TwipsToPixels(params.BlurY)));
+
+    switch(params.GetFilterType())
+    {
+    case Filter_Shadow:
+    case Filter_Glow:
+    case Filter_Bevel:
+        {
+            // Shadows only need the blurred alpha; blur into a scratch plane
+            // so that the original pixels remain available as the 'base'.
+            UPInt   pitch = src.Width * 4;
+            UByte*  pdata = (UByte*)SF_ALLOC(pitch * src.Height, StatRender_Mem);
+            if (!pdata)
+                return false;
+            ImagePlane blurred(src.Width, src.Height, pitch, pitch * src.Height, pdata);
+            BlurPlaneSW(blurred, src, blurX, blurY, params.Passes, true);
+            composeShadow(params, dest, src, blurred);
+            SF_FREE(pdata);
+            break;
+        }
+
+    default:
+        // Filter_Blur, as well as the unimplemented gradient filters, which
+        // the shaders also render as a plain blur.
+        BlurPlaneSW(dest, src, blurX, blurY, params.Passes, false);
+        break;
+    }
+    return true;
+}
+
+}} // Scaleform::Render
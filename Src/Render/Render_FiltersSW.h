@@ -0,0 +1,47 @@
+/**************************************************************************
+
+Filename    :   Render_FiltersSW.h
+Content     :   Software (CPU) implementation of the renderer filters.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_FiltersSW_H
+#define INC_SF_Render_FiltersSW_H
+
+#include "Render/Render_Filters.h"
+#include "Render/Render_Image.h"
+
+namespace Scaleform { namespace Render {
+
+// The functions below implement the filters on the CPU, producing the same
+// results as the filter shaders used by the hardware HALs (see
+// ShaderManager::GetFilterPasses and the Box1/Box2 shaders). All planes hold
+// premultiplied 32-bit pixels in R8G8B8A8 byte order, which is how render
+// target contents are stored; source and destination must have the same size.
+
+// Returns true if ApplyFilterSW can process the given filter. CacheAsBitmap
+// and the unimplemented filter types are not supported, just as they are
+// not by the filter shaders.
+bool    IsFilterSupportedSW(const Filter* filter);
+
+// Applies a single filter to src, writing the result into dest. dest and src
+// must not overlap. Returns false if the filter is not supported.
+bool    ApplyFilterSW(const Filter* filter, const ImagePlane& dest, const ImagePlane& src);
+
+// Box blurs src into dest (which may be the same plane) 'passes' times,
+// with the given kernel size in pixels. If alphaOnly is true, only the alpha
+// channel of dest is written, which is all the shadow filters need.
+void    BlurPlaneSW(const ImagePlane& dest, const ImagePlane& src,
+                    unsigned blurX, unsigned blurY, unsigned passes, bool alphaOnly = false);
+
+}} // Scaleform::Render
+
+#endif // INC_SF_Render_FiltersSW_H
@@ -98,6 +98,9 @@ bool GlyphTextureMapper::Create(unsigned method, MemoryHeap* heap,
             PrimitiveFillData fillData(PrimFill_UVTextureAlpha_VColor, &RasterGlyphVertex::Format, 
                                        pRawImg->GetTexture(texMan), ImageFillMode(Wrap_Clamp, Sample_Linear));
             pFill = *fillMan->CreateFill(fillData);
+            PrimitiveFillData dfFillData(PrimFill_UVTextureDFAlpha_VColor, &RasterGlyphVertex::Format, 
+                                         pRawImg->GetTexture(texMan), ImageFillMode(Wrap_Clamp, Sample_Linear));
+            pDFFill = *fillMan->CreateFill(dfFillData);
         }
     }
     else
@@ -115,6 +118,9 @@ bool GlyphTextureMapper::Create(unsigned method, MemoryHeap* heap,
             PrimitiveFillData fillData(PrimFill_UVTextureAlpha_VColor, &RasterGlyphVertex::Format, 
                                        pTexImg->GetTexture(texMan), ImageFillMode(Wrap_Clamp, Sample_Linear));
             pFill = *fillMan->CreateFill(fillData);
+            PrimitiveFillData dfFillData(PrimFill_UVTextureDFAlpha_VColor, &RasterGlyphVertex::Format, 
+                                         pTexImg->GetTexture(texMan), ImageFillMode(Wrap_Clamp, Sample_Linear));
+            pDFFill = *fillMan->CreateFill(dfFillData);
         }
     }
     return Valid = ret;
@@ -275,6 +281,11 @@ GlyphCache::~GlyphCache()
 //------------------------------------------------------------------------
 void GlyphCache::Destroy()
 {
+    RasterPool.Shutdown();
+    for (UPInt i = 0; i < PendingTexts.GetSize(); ++i)
+        PendingTexts[i]->SetPendingGlyphs(false);
+    PendingTexts.Clear();
+
     UnpinAllSlots();
     Queue.Clear();
     releaseAllTextures();
@@ -302,6 +313,9 @@ void GlyphCache::Destroy()
 //------------------------------------------------------------------------
 void GlyphCache::ClearCache()
 {
+    RasterPool.CancelJobs();
+    releasePendingTexts();
+
     UnpinAllSlots();
     Queue.Clear();
     UpdatePacker.Clear();
@@ -453,10 +467,92 @@ void GlyphCache::OnEndFrame()
 {
 }
 
+//------------------------------------------------------------------------
+void GlyphCache::AddPendingText(TextMeshProvider* tm)
+{
+    if (!tm->HasPendingGlyphs())
+    {
+        tm->SetPendingGlyphs(true);
+        PendingTexts.PushBack(tm);
+    }
+}
+
+//------------------------------------------------------------------------
+void GlyphCache::RemovePendingText(TextMeshProvider* tm)
+{
+    tm->SetPendingGlyphs(false);
+    for (UPInt i = 0; i < PendingTexts.GetSize(); ++i)
+    {
+        if (PendingTexts[i] == tm)
+        {
+            PendingTexts[i] = PendingTexts.Back();
+            PendingTexts.PopBack();
+            break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------
+// Clears the texts waiting for asynchronously rasterized glyphs, so that
+// they are rebuilt, now finding the glyphs in the cache.
+void GlyphCache::releasePendingTexts()
+{
+    ArrayLH<TextMeshProvider*, SID> texts;
+    texts = PendingTexts;
+    PendingTexts.Clear();
+    for (UPInt i = 0; i < texts.GetSize(); ++i)
+    {
+        texts[i]->SetPendingGlyphs(false);
+        texts[i]->Clear();
+    }
+}
+
+//------------------------------------------------------------------------
+// Copies the glyphs finished by RasterPool into the cache textures. Called
+// at the beginning of the frame, after the HAL has started it.
+void GlyphCache::UpdateRasterizedGlyphs()
+{
+    if (!checkInitialization())
+        return;
+
+    SF_AMP_SCOPE_RENDER_TIMER("GlyphCache::UpdateRasterizedGlyphs", Amp_Profile_Level_Medium);
+
+    bool installed = false;
+    GlyphRasterJob* job;
+    while((job = RasterPool.GetFinishedJob()) != 0)
+    {
+        if (!job->IsCancelled() && job->Width && job->Height && 
+            MaxNumTextures && Queue.FindGlyph(job->Param) == 0)
+        {
+            GlyphNode* node = Queue.AllocateGlyph(job->Param, job->Width, job->Height);
+            if (node)
+            {
+                node->Origin.x = SInt16(job->X1 * 16);
+                node->Origin.y = SInt16(job->Y1 * 16);
+                node->Scale = 1;
+
+                RasterData.Resize(job->Raster.GetSize());
+                RasterPitch = job->Width;
+                memcpy(&RasterData[0], &job->Raster[0], job->Raster.GetSize());
+
+                updateTextureGlyph(node);
+                ++RasterizationCount;
+                installed = true;
+            }
+        }
+        delete job;
+    }
+
+    // Glyphs that didn't fit are left to the next rebuild of their texts.
+    if (installed)
+        releasePendingTexts();
+}
+
 //------------------------------------------------------------------------
 void GlyphCache::CleanUpFont(FontCacheHandle* font)
 {
     SF_ASSERT(font->pFont == 0);
+    RasterPool.CancelJobs(font);
     ApplyInUseList();
     UpdatePinList();
     Queue.CleanUpFont(font);
@@ -488,6 +584,9 @@ PrimitiveFill* GlyphCache::GetFill(TextLayerType type, unsigned textureId)
     case TextLayer_RasterText:
         return Textures[textureId].GetFill();
 
+    case TextLayer_RasterDFAText:
+        return Textures[textureId].GetDFFill();
+
     case TextLayer_PackedText:
     case TextLayer_PackedDFAText:
     case TextLayer_Images:
@@ -1429,7 +1528,8 @@ void GlyphCache::knockOut(UByte* raster)
 
 
 //-----------------------------------------------------------------------
-void GlyphCache::addShapeToRasterizer(const ShapeDataInterface* shape, float scaleX, float scaleY)
+void GlyphCache::addShapeToRasterizer(Rasterizer* ras, const ShapeDataInterface* shape, 
+                                      float scaleX, float scaleY)
 {
     if (shape->IsEmpty())
         return;
@@ -1453,14 +1553,14 @@ void GlyphCache::addShapeToRasterizer(const ShapeDataInterface* shape, float sca
         {
             coord[0] *= scaleX;
             coord[1] *= scaleY;
-            Ras.MoveTo(coord[0], coord[1]);
+            ras->MoveTo(coord[0], coord[1]);
             while((pathEdge = shape->ReadEdge(&pos, coord)) != Edge_EndPath)
             {
                 if (pathEdge == Edge_LineTo)
                 {
                     coord[0] *= scaleX;
                     coord[1] *= scaleY;
-                    Ras.LineTo(coord[0], coord[1]);
+                    ras->LineTo(coord[0], coord[1]);
                 }
                 else
                 {
@@ -1468,10 +1568,10 @@ void GlyphCache::addShapeToRasterizer(const ShapeDataInterface* shape, float sca
                     coord[1] *= scaleY;
                     coord[2] *= scaleX;
                     coord[3] *= scaleY;
-                    TessellateQuadCurve(&Ras, param, coord[0], coord[1], coord[2], coord[3]);
+                    TessellateQuadCurve(ras, param, coord[0], coord[1], coord[2], coord[3]);
                 }
             }
-            Ras.ClosePath();
+            ras->ClosePath();
         }
         else
         {
@@ -1483,11 +1583,12 @@ void GlyphCache::addShapeToRasterizer(const ShapeDataInterface* shape, float sca
 
 
 //-----------------------------------------------------------------------
-void GlyphCache::addShapeAutoFit(const ShapeDataInterface* shape, unsigned nomHeight, 
+void GlyphCache::addShapeAutoFit(Rasterizer* ras, GlyphFitter* fitter, 
+                                 const ShapeDataInterface* shape, unsigned nomHeight, 
                                  int lowerCaseTop, int upperCaseTop,
                                  float screenSize, float stretch)
 {
-    Fitter.Clear();
+    fitter->Clear();
 
     if (shape->IsEmpty())
         return;
@@ -1496,7 +1597,7 @@ void GlyphCache::addShapeAutoFit(const ShapeDataInterface* shape, unsigned nomHe
     if (nominalSize > 2048)
         nominalSize = 2048;
 
-    Fitter.SetNominalFontHeight(nominalSize);
+    fitter->SetNominalFontHeight(nominalSize);
     float scale = float(nominalSize) / float(nomHeight);
 
     float tolerance = 0.5f * float(nominalSize) / screenSize;
@@ -1522,14 +1623,14 @@ void GlyphCache::addShapeAutoFit(const ShapeDataInterface* shape, unsigned nomHe
         {
             coord[0] *=  scale;
             coord[1] *= -scale;
-            Fitter.MoveTo(coord[0], coord[1]);
+            fitter->MoveTo(coord[0], coord[1]);
             while((pathEdge = shape->ReadEdge(&pos, coord)) != Edge_EndPath)
             {
                 if (pathEdge == Edge_LineTo)
                 {
                     coord[0] *=  scale;
                     coord[1] *= -scale;
-                    Fitter.LineTo(coord[0], coord[1]);
+                    fitter->LineTo(coord[0], coord[1]);
                 }
                 else
                 {
@@ -1537,10 +1638,10 @@ void GlyphCache::addShapeAutoFit(const ShapeDataInterface* shape, unsigned nomHe
                     coord[1] *= -scale;
                     coord[2] *=  scale;
                     coord[3] *= -scale;
-                    TessellateQuadCurve(&Fitter, param, coord[0], coord[1], coord[2], coord[3]);
+                    TessellateQuadCurve(fitter, param, coord[0], coord[1], coord[2], coord[3]);
                 }
             }
-            Fitter.ClosePath();
+            fitter->ClosePath();
         }
         else
         {
@@ -1548,30 +1649,30 @@ void GlyphCache::addShapeAutoFit(const ShapeDataInterface* shape, unsigned nomHe
         }
     }
 
-    Fitter.FitGlyph(int(screenSize), 0, int(lowerCaseTop * scale), int(upperCaseTop * scale));
+    fitter->FitGlyph(int(screenSize), 0, int(lowerCaseTop * scale), int(upperCaseTop * scale));
 
-    scale = 1.0f / Fitter.GetUnitsPerPixelY();
+    scale = 1.0f / fitter->GetUnitsPerPixelY();
 
     unsigned i, j;
-    for(i = 0; i < Fitter.GetNumContours(); ++i)
+    for(i = 0; i < fitter->GetNumContours(); ++i)
     {
-        const GlyphFitter::ContourType& c = Fitter.GetContour(i);
+        const GlyphFitter::ContourType& c = fitter->GetContour(i);
         if(c.NumVertices > 2)
         {
-            GlyphFitter::VertexType v = Fitter.GetVertex(c, 0);
-            Fitter.SnapVertex(v);
+            GlyphFitter::VertexType v = fitter->GetVertex(c, 0);
+            fitter->SnapVertex(v);
 
-            Ras.MoveTo(v.x * scale * stretch, -v.y * scale);
+            ras->MoveTo(v.x * scale * stretch, -v.y * scale);
             for(j = 1; j < c.NumVertices; ++j)
             {
-                v = Fitter.GetVertex(c, j);
-                Fitter.SnapVertex(v);
-                Ras.LineTo(v.x * scale * stretch, -v.y * scale);
+                v = fitter->GetVertex(c, j);
+                fitter->SnapVertex(v);
+                ras->LineTo(v.x * scale * stretch, -v.y * scale);
             }
-            Ras.ClosePath();
+            ras->ClosePath();
         }
     }
-    Fitter.Clear();
+    fitter->Clear();
 }
 
 
@@ -1705,7 +1806,7 @@ GlyphNode* GlyphCache::getPrerasterizedGlyph(GlyphRunData& data, TextMeshProvide
 
 
 //-----------------------------------------------------------------------
-void GlyphCache::filterScanline(UByte* sl, unsigned w) const
+void GlyphCache::filterScanline(const GlyphScanlineFilter& filter, UByte* sl, unsigned w)
 {
     unsigned i;
     UByte buf[256];
@@ -1715,12 +1816,59 @@ void GlyphCache::filterScanline(UByte* sl, unsigned w) const
     memset(buf, 0, w);
     for(i = 2; i+2 < w; ++i)
     {
-        ScanlineFilter.Filter(src++, dst++);
+        filter.Filter(src++, dst++);
     }
     memcpy(sl, buf, w);
 }
 
 
+//-----------------------------------------------------------------------
+// Converts coverage to a signed distance field; 128 is the outline, and
+// values reach 0 or 255 at spread pixels outside or inside of it. Pixels
+// partially covered give the sub-pixel position of the outline. The search
+// is brute force within the spread, which is cheap for glyph sized images
+// rasterized once.
+void GlyphCache::makeDistanceField(UByte* dst, const UByte* src, unsigned w, unsigned h, 
+                                   unsigned spread)
+{
+    int   r = int(spread);
+    float k = 127.0f / float(spread);
+    for(int y = 0; y < int(h); ++y)
+    {
+        for(int x = 0; x < int(w); ++x)
+        {
+            unsigned cov    = src[y*w + x];
+            bool     inside = cov >= 128;
+            int      minD2  = (r+1) * (r+1);
+            int y1 = Alg::Max(y - r, 0);
+            int y2 = Alg::Min(y + r, int(h) - 1);
+            int x1 = Alg::Max(x - r, 0);
+            int x2 = Alg::Min(x + r, int(w) - 1);
+            for(int sy = y1; sy <= y2; ++sy)
+            {
+                const UByte* sl = src + sy*w;
+                for(int sx = x1; sx <= x2; ++sx)
+                {
+                    if ((sl[sx] >= 128) != inside)
+                    {
+                        int d2 = (sx-x)*(sx-x) + (sy-y)*(sy-y);
+                        if (d2 < minD2)
+                            minD2 = d2;
+                    }
+                }
+            }
+
+            // The outline is about half way to the nearest pixel on the other side.
+            float d = sqrtf(float(minD2)) - 0.5f;
+            if (cov > 0 && cov < 255)
+                d = Alg::Min(d, fabsf(float(cov) / 255.0f - 0.5f));
+            float v = 128.0f + (inside ? d : -d) * k;
+            dst[y*w + x] = UByte(Alg::Clamp(v, 0.0f, 255.0f));
+        }
+    }
+}
+
+
 //-----------------------------------------------------------------------
 GlyphNode* GlyphCache::RasterizeGlyph(GlyphRunData& data, TextMeshProvider* tm, const GlyphParam& gp)
 {
@@ -1771,7 +1919,10 @@ GlyphNode* GlyphCache::RasterizeGlyph(GlyphRunData& data, TextMeshProvider* tm,
     if (y1 >= y2)
         y1 = y2 = 0;
 
-    unsigned h = unsigned(y2 - y1) + 2*SlotPadding;
+    // Distance fields need room for the outside distances.
+    unsigned spread  = gp.IsDistField() ? Param.DistanceFieldSpread : 0;
+    unsigned padding = SlotPadding + spread;
+    unsigned h = unsigned(y2 - y1) + 2*padding;
 
     if (h >= MaxSlotHeight)
     {
@@ -1779,17 +1930,28 @@ GlyphNode* GlyphCache::RasterizeGlyph(GlyphRunData& data, TextMeshProvider* tm,
         return 0;
     }
 
+    if (Param.UseAsyncRasterization)
+    {
+        // The caller draws the glyph as a vector shape until it is ready.
+        if (RasterPool.IsPending(gp) ||
+            queueGlyphRaster(data, gp, scale, stretch, autoFit, lowerCaseTop, upperCaseTop, spread))
+        {
+            Result = Res_Pending;
+            return 0;
+        }
+    }
+
     GlyphNode* node = 0;
 
     // Rasterization
     Ras.Clear();
     if (autoFit)
-        addShapeAutoFit(data.pShape, (unsigned)data.NomHeight, lowerCaseTop, upperCaseTop, gp.GetFontSize(), stretch);
+        addShapeAutoFit(&Ras, &Fitter, data.pShape, (unsigned)data.NomHeight, lowerCaseTop, upperCaseTop, gp.GetFontSize(), stretch);
     else
-        addShapeToRasterizer(data.pShape, scale*stretch, scale);
+        addShapeToRasterizer(&Ras, data.pShape, scale*stretch, scale);
 
-    int padX = SlotPadding;
-    int padY = SlotPadding;
+    int padX = padding;
+    int padY = padding;
 
     int imgX1 = 0;
     int imgX2 = 0;
@@ -1850,10 +2012,16 @@ GlyphNode* GlyphCache::RasterizeGlyph(GlyphRunData& data, TextMeshProvider* tm,
         UByte* sl = &RasterData[(padY+i)*RasterPitch];
         Ras.SweepScanline(i, sl+padX, 1, 0);
         if (filter)
-            filterScanline(sl, imgW);
+            filterScanline(ScanlineFilter, sl, imgW);
         ++numSl;
     }
 
+    if (spread)
+    {
+        RasterDataSrc = RasterData;
+        makeDistanceField(&RasterData[0], &RasterDataSrc[0], imgW, imgH, spread);
+    }
+
     updateTextureGlyph(node); 
     ++RasterizationCount;
 
@@ -1864,6 +2032,31 @@ GlyphNode* GlyphCache::RasterizeGlyph(GlyphRunData& data, TextMeshProvider* tm,
 
 
 
+//-----------------------------------------------------------------------
+bool GlyphCache::queueGlyphRaster(GlyphRunData& data, const GlyphParam& gp, float scale, float stretch,
+                                  bool autoFit, int lowerCaseTop, int upperCaseTop, unsigned spread)
+{
+    if (!RasterPool.IsAvailable())
+        return false;
+
+    GlyphRasterJob* job = SF_NEW GlyphRasterJob(gp, data.pShape);
+    if (job == 0)
+        return false;
+
+    job->pFilter      = &ScanlineFilter;
+    job->Scale        = scale;
+    job->Stretch      = stretch;
+    job->AutoFit      = autoFit;
+    job->NomHeight    = (unsigned)data.NomHeight;
+    job->LowerCaseTop = lowerCaseTop;
+    job->UpperCaseTop = upperCaseTop;
+    job->Padding      = SlotPadding + spread;
+    job->Spread       = spread;
+    job->MaxHeight    = MaxSlotHeight;
+    RasterPool.QueueJob(job);
+    return true;
+}
+
 //-----------------------------------------------------------------------
 GlyphNode* GlyphCache::createShadowFromRaster(GlyphRunData& data, TextMeshProvider* tm, const GlyphParam& gp, float screenSize, const GlyphRaster* ras)
 {
@@ -2021,7 +2214,7 @@ GlyphNode* GlyphCache::RasterizeShadow(GlyphRunData& data, TextMeshProvider* tm,
 
     // Rasterization
     Ras.Clear();
-    addShapeToRasterizer(data.pShape, vectorScale, vectorScale);
+    addShapeToRasterizer(&Ras, data.pShape, vectorScale, vectorScale);
 
     int padX = SlotPadding + intBlurX;
     int padY = SlotPadding + intBlurY;
@@ -30,6 +30,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "Render_GlyphFitter.h"
 #include "Render_Rasterizer.h"
 #include "Render_Stroker.h"
+#include "Render_GlyphRasterPool.h"
 
 namespace Scaleform { namespace Render {
 
@@ -101,6 +102,8 @@ public:
 
     const PrimitiveFill* GetFill() const { return pFill; }
           PrimitiveFill* GetFill()       { return pFill; }
+    // Fill of the same texture for distance field glyphs.
+          PrimitiveFill* GetDFFill()     { return pDFFill; }
 
     Image* GetImage() { return pRawImg.GetPtr() ? (Image*)pRawImg : (Image*)pTexImg; }
 
@@ -114,6 +117,7 @@ private:
     Ptr<RawImage>           pRawImg;
     Ptr<GlyphTextureImage>  pTexImg;
     Ptr<PrimitiveFill>      pFill;
+    Ptr<PrimitiveFill>      pDFFill;
     bool                    Mapped;
 public:
     unsigned                NumGlyphsToUpdate;
@@ -244,7 +248,8 @@ public:
         Res_ShapeNotFound,
         Res_ShapeIsTooBig,
         Res_NoRasterCache,
-        Res_CacheFull
+        Res_CacheFull,
+        Res_Pending         // Queued for asynchronous rasterization.
     };
 
     GlyphCache(MemoryHeap* heap);
@@ -288,6 +293,14 @@ public:
     void UnpinSlot(GlyphSlot* s, Fence*f) { Queue.UnpinSlot(s,f); }
     void RemoveNotifier(TextNotifier* n)        { Queue.RemoveNotifier(n); }
 
+    // Texts drawing vector placeholders of glyphs being rasterized
+    // asynchronously; they are rebuilt once the glyphs are in the cache.
+    void AddPendingText(TextMeshProvider* tm);
+    void RemovePendingText(TextMeshProvider* tm);
+
+    // Uploads the glyphs rasterized asynchronously since the last frame.
+    void UpdateRasterizedGlyphs();
+
     int CmpFills(unsigned texId1, unsigned texId2) const
     {
         if (texId1 == texId2) return 0;
@@ -336,6 +349,8 @@ public:
     UPInt       GetBytes() const { return Queue.GetBytes(); }
 
 private:
+    friend class GlyphRasterJob;
+
     void initialize();
 
     struct UpdateRect
@@ -361,10 +376,15 @@ private:
     void copyImageData(ImagePlane* pl, const UByte* data, unsigned pitch, 
                        unsigned dstX, unsigned dstY, unsigned w, unsigned h);
     void releaseAllTextures();
-    void addShapeToRasterizer(const ShapeDataInterface* shape, float scaleX, float scaleY);
-    void addShapeAutoFit(const ShapeDataInterface* shape, unsigned nomHeight, 
-                         int lowerCaseTop, int upperCaseTop,
-                         float screenSize, float stretch);
+    static void addShapeToRasterizer(Rasterizer* ras, const ShapeDataInterface* shape, 
+                                     float scaleX, float scaleY);
+    static void addShapeAutoFit(Rasterizer* ras, GlyphFitter* fitter, 
+                                const ShapeDataInterface* shape, unsigned nomHeight, 
+                                int lowerCaseTop, int upperCaseTop,
+                                float screenSize, float stretch);
+    bool queueGlyphRaster(GlyphRunData& data, const GlyphParam& gp, float scale, float stretch,
+                          bool autoFit, int lowerCaseTop, int upperCaseTop, unsigned spread);
+    void releasePendingTexts();
 
     void recursiveBlur(UByte* img, unsigned pitch, unsigned  sx, unsigned  sy, 
                        unsigned  w,  unsigned  h, float rx, float ry);
@@ -372,7 +392,9 @@ private:
     void strengthenImage(UByte* img, unsigned pitch, unsigned  sx, unsigned  sy, 
                          unsigned  w,  unsigned  h, float ratio, int  bias);
 
-    void filterScanline(UByte* sl, unsigned w) const;
+    static void filterScanline(const GlyphScanlineFilter& filter, UByte* sl, unsigned w);
+    static void makeDistanceField(UByte* dst, const UByte* src, unsigned w, unsigned h, 
+                                  unsigned spread);
     void knockOut(UByte* raster);
     void cacheFullWarning();
     void rasterTooBigWarning();
@@ -437,6 +459,8 @@ private:
     VertexPath              TmpPath1;
     VertexPath              TmpPath2;
     unsigned                RasterizationCount;
+    GlyphRasterPool         RasterPool;
+    ArrayLH<TextMeshProvider*, SID> PendingTexts;
     bool                    RasterCacheWarning;
     bool                    RasterTooBigWarning;
 };
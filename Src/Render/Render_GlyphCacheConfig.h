@@ -48,6 +48,21 @@ struct GlyphCacheParams
     // during a single frame of rendering.
     bool     FenceWaitOnFullCache;
 
+    // If true, glyphs that are not in the cache are rasterized on worker threads,
+    // and drawn as vectors until their rasters are uploaded on a later frame.
+    // Has no effect without thread support or on single CPU systems.
+    bool     UseAsyncRasterization;
+
+    // If true, glyphs of text not optimized for readability are cached once as
+    // signed distance fields of DistanceFieldSize pixels and drawn at any scale,
+    // with drop shadows taken from the same field. DistanceFieldSpread is the
+    // distance in pixels covered by the field on each side of the outline;
+    // glyphs need DistanceFieldSize plus twice (SlotPadding + DistanceFieldSpread)
+    // to fit in MaxSlotHeight. Requires HAL support of distance field fills.
+    bool     UseDistanceField;
+    unsigned DistanceFieldSize;
+    unsigned DistanceFieldSpread;
+
     // Configures dynamic GlyphCache rendering.
     // Pass NumTextures == 0 to disable dynamic cache.
     GlyphCacheParams(unsigned numTextures = 1,
@@ -70,7 +85,11 @@ struct GlyphCacheParams
         ShadowQuality(1.0f),
         UseAutoFit(true),
         UseVectorOnFullCache(false),
-        FenceWaitOnFullCache(true)
+        FenceWaitOnFullCache(true),
+        UseAsyncRasterization(false),
+        UseDistanceField(false),
+        DistanceFieldSize(24),
+        DistanceFieldSpread(3)
     {}
 
 };
@@ -36,6 +36,7 @@ enum TextLayerType
     TextLayer_Shadow,
     TextLayer_ShadowText,
     TextLayer_RasterText,
+    TextLayer_RasterDFAText,
     TextLayer_PackedText,
     TextLayer_PackedDFAText,
     TextLayer_Images,
@@ -96,6 +97,7 @@ struct GlyphParam
         FineBlur   = 0x0080,
         BitmapFont = 0x0100,
         UseRaster  = 0x0200,
+        DistField  = 0x0400,
         OutlineMask= 0xF000
     };
 
@@ -111,6 +113,7 @@ struct GlyphParam
     bool     IsBitmapFont()    const { return (Flags & BitmapFont) != 0; }
     float    GetStretch()      const { return (Flags & Stretch) ? 2.5f : 1.0f; }
     bool     GetUseRaster()    const { return (Flags & UseRaster) != 0; }
+    bool     IsDistField()     const { return (Flags & DistField) != 0; }
     bool     IsFauxBold()      const { return (Flags & FauxBold) != 0; }
     bool     IsFauxItalic()    const { return (Flags & FauxItalic) != 0; }
     bool     IsKnockOut()      const { return (Flags & KnockOut) != 0; }
@@ -126,6 +129,7 @@ struct GlyphParam
     void SetAutoFit(bool f)       { if(f) Flags |= AutoFit;    else Flags &= ~AutoFit; }
     void SetStretch(bool f)       { if(f) Flags |= Stretch;    else Flags &= ~Stretch; }
     void SetUseRaster(bool f)     { if(f) Flags |= UseRaster;  else Flags &= ~UseRaster; }
+    void SetDistField(bool f)     { if(f) Flags |= DistField;  else Flags &= ~DistField; }
     void SetFauxBold(bool f)      { if(f) Flags |= FauxBold;   else Flags &= ~FauxBold; }
     void SetFauxItalic(bool f)    { if(f) Flags |= FauxItalic; else Flags &= ~FauxItalic; }
     void SetKnockOut(bool f)      { if(f) Flags |= KnockOut;   else Flags &= ~KnockOut; }
@@ -0,0 +1,312 @@
+/**************************************************************************
+
+Filename    :   Render_GlyphRasterPool.cpp
+Content     :   Worker pool rasterizing glyphs off the render thread.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Render/Render_GlyphRasterPool.h"
+#include "Render/Render_GlyphCache.h"
+#include "Kernel/SF_Alg.h"
+#include "Kernel/SF_HeapNew.h"
+
+namespace Scaleform { namespace Render {
+
+// ***** GlyphRasterJob
+
+GlyphRasterJob::GlyphRasterJob(const GlyphParam& gp, const ShapeDataInterface* shape) :
+    Param(gp), pFilter(0), Scale(1), Stretch(1), AutoFit(false), NomHeight(0),
+    LowerCaseTop(0), UpperCaseTop(0), Padding(0), Spread(0), MaxHeight(0),
+    X1(0), Y1(0), Width(0), Height(0),
+    State(Job_Queued), Cancelled(false)
+{
+    // Only the first layer is rasterized, see GlyphCache::addShapeToRasterizer.
+    ShapePosInfo pos(shape->GetStartingPos());
+    ShapePathType pathType;
+    PathEdgeType pathEdge;
+    float coord[Edge_MaxCoord];
+    unsigned styles[3];
+    bool first = true;
+    while((pathType = shape->ReadPathInfo(&pos, coord, styles)) != Shape_EndShape)
+    {
+        if (!first && pathType == Shape_NewLayer)
+            break;
+        first = false;
+
+        if (styles[0] != styles[1])
+        {
+            Shape.StartPath(styles[0], styles[1], 0);
+            Shape.MoveTo(coord[0], coord[1]);
+            while((pathEdge = shape->ReadEdge(&pos, coord)) != Edge_EndPath)
+            {
+                if (pathEdge == Edge_LineTo)
+                    Shape.LineTo(coord[0], coord[1]);
+                else
+                    Shape.QuadTo(coord[0], coord[1], coord[2], coord[3]);
+            }
+            Shape.ClosePath();
+            Shape.EndPath();
+        }
+        else
+        {
+            shape->SkipPathData(&pos);
+        }
+    }
+    Shape.EndShape();
+}
+
+void GlyphRasterJob::Execute(Rasterizer* ras, GlyphFitter* fitter)
+{
+    // Same as the rasterization part of GlyphCache::RasterizeGlyph.
+    ras->Clear();
+    if (AutoFit)
+        GlyphCache::addShapeAutoFit(ras, fitter, &Shape, NomHeight, LowerCaseTop, UpperCaseTop,
+                                    Param.GetFontSize(), Stretch);
+    else
+        GlyphCache::addShapeToRasterizer(ras, &Shape, Scale*Stretch, Scale);
+
+    int imgX1 = 0;
+    int imgX2 = 0;
+    int imgY1 = 0;
+    int imgY2 = 0;
+
+    if (ras->SortCells())
+    {
+        imgX1 = ras->GetMinX() - Padding;
+        imgX2 = ras->GetMaxX() + Padding;
+        imgY1 = ras->GetMinY() - Padding;
+        imgY2 = ras->GetMaxY() + Padding;
+    }
+
+    X1     = imgX1;
+    Y1     = imgY1;
+    Width  = imgX2 - imgX1 + 1;
+    Height = imgY2 - imgY1 + 1;
+    if (Height > MaxHeight)
+        Height = MaxHeight;
+
+    Raster.Resize(Width * Height);
+    if (Raster.GetSize() != Width * Height)
+    {
+        Width = Height = 0;
+        ras->Clear();
+        return;
+    }
+    memset(&Raster[0], 0, Width * Height);
+
+    if (ras->GetGamma1() != 1.0f)
+        ras->SetGamma1(1.0f);
+
+    bool filter = Width >= 5 && Stretch > 1;
+
+    unsigned i;
+    for(i = 0; i < ras->GetNumScanlines() && (Padding+i) < Height; ++i)
+    {
+        UByte* sl = &Raster[(Padding+i)*Width];
+        ras->SweepScanline(i, sl+Padding, 1, 0);
+        if (filter)
+            GlyphCache::filterScanline(*pFilter, sl, Width);
+    }
+    ras->Clear();
+
+    if (Spread)
+    {
+        ArrayLH_POD<UByte> coverage;
+        coverage = Raster;
+        GlyphCache::makeDistanceField(&Raster[0], &coverage[0], Width, Height, Spread);
+    }
+}
+
+
+// ***** GlyphRasterPool
+
+GlyphRasterPool::GlyphRasterPool() :
+    WorkerPool("Scaleform Glyph Rasterizer")
+{
+}
+
+GlyphRasterPool::~GlyphRasterPool()
+{
+    Shutdown();
+}
+
+void GlyphRasterPool::Shutdown()
+{
+    StopWorkers();
+
+#ifdef SF_ENABLE_THREADS
+    // No workers are left, so the lists can be accessed without the lock.
+    List<GlyphRasterJob>* lists[3] = { &QueuedJobs, &RunningJobs, &DoneJobs };
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        while (!lists[i]->IsEmpty())
+        {
+            GlyphRasterJob* job = lists[i]->GetFirst();
+            job->RemoveNode();
+            delete job;
+        }
+    }
+#endif
+    PendingJobs.Clear();
+}
+
+bool GlyphRasterPool::IsAvailable()
+{
+    // A single CPU gets no workers, and glyphs are rasterized
+    // synchronously as before.
+    Initialize();
+    return GetWorkerCount() != 0;
+}
+
+bool GlyphRasterPool::IsPending(const GlyphParam& gp) const
+{
+    return PendingJobs.Get(GlyphParamHash(&gp)) != 0;
+}
+
+void GlyphRasterPool::removePending(GlyphRasterJob* job)
+{
+    // A job of a cancelled font may have been replaced by a newer one
+    // with the same key.
+    GlyphRasterJob** pjob = PendingJobs.Get(GlyphParamHash(&job->Param));
+    if (pjob && *pjob == job)
+        PendingJobs.Remove(GlyphParamHash(&job->Param));
+}
+
+// Per worker data, passed to executeJob.
+struct GlyphRasterWorkerContext
+{
+    Rasterizer*     pRas;
+    GlyphFitter*    pFitter;
+};
+
+void GlyphRasterPool::workerMain()
+{
+    // Each worker has its own rasterizer and fitter, allocating from the
+    // thread-safe global heap.
+    Rasterizer               ras(Memory::GetGlobalHeap());
+    GlyphFitter              fitter(Memory::GetGlobalHeap());
+    GlyphRasterWorkerContext context = { &ras, &fitter };
+    runWorker(&context);
+}
+
+void* GlyphRasterPool::beginJob()
+{
+#ifdef SF_ENABLE_THREADS
+    if (QueuedJobs.IsEmpty())
+        return 0;
+    GlyphRasterJob* job = QueuedJobs.GetFirst();
+    job->RemoveNode();
+    job->State = GlyphRasterJob::Job_Running;
+    RunningJobs.PushBack(job);
+    return job;
+#else
+    return 0;
+#endif
+}
+
+void GlyphRasterPool::executeJob(void* job, void* context)
+{
+    GlyphRasterWorkerContext* pcontext = (GlyphRasterWorkerContext*)context;
+    ((GlyphRasterJob*)job)->Execute(pcontext->pRas, pcontext->pFitter);
+}
+
+void GlyphRasterPool::endJob(void* job)
+{
+#ifdef SF_ENABLE_THREADS
+    GlyphRasterJob* pjob = (GlyphRasterJob*)job;
+    pjob->RemoveNode();
+    pjob->State = GlyphRasterJob::Job_Done;
+    DoneJobs.PushBack(pjob);
+#else
+    SF_UNUSED(job);
+#endif
+}
+
+void GlyphRasterPool::QueueJob(GlyphRasterJob* job)
+{
+#ifdef SF_ENABLE_THREADS
+    SF_ASSERT(GetWorkerCount() && !IsPending(job->Param));
+    PendingJobs.Set(GlyphParamHash(&job->Param), job);
+
+    Mutex::Locker lock(&PoolLock);
+    QueuedJobs.PushBack(job);
+    notifyJobQueued();
+#else
+    delete job;
+#endif
+}
+
+GlyphRasterJob* GlyphRasterPool::GetFinishedJob()
+{
+#ifdef SF_ENABLE_THREADS
+    GlyphRasterJob* job = 0;
+    {
+        Mutex::Locker lock(&PoolLock);
+        if (DoneJobs.IsEmpty())
+            return 0;
+        job = DoneJobs.GetFirst();
+        job->RemoveNode();
+    }
+    removePending(job);
+    return job;
+#else
+    return 0;
+#endif
+}
+
+void GlyphRasterPool::CancelJobs(FontCacheHandle* font)
+{
+#ifdef SF_ENABLE_THREADS
+    List<GlyphRasterJob> releaseList;
+    {
+        Mutex::Locker lock(&PoolLock);
+
+        // Queued jobs are dropped; the others are marked, since workers
+        // may still be using them.
+        GlyphRasterJob* job = QueuedJobs.GetFirst();
+        while (!QueuedJobs.IsNull(job))
+        {
+            GlyphRasterJob* next = QueuedJobs.GetNext(job);
+            if (!font || job->Param.pFont == font)
+            {
+                job->RemoveNode();
+                releaseList.PushBack(job);
+            }
+            job = next;
+        }
+
+        List<GlyphRasterJob>* lists[2] = { &RunningJobs, &DoneJobs };
+        for (unsigned i = 0; i < 2; ++i)
+        {
+            for (job = lists[i]->GetFirst(); !lists[i]->IsNull(job); job = lists[i]->GetNext(job))
+            {
+                if (!font || job->Param.pFont == font)
+                {
+                    removePending(job);
+                    job->Cancelled = true;
+                }
+            }
+        }
+    }
+
+    while (!releaseList.IsEmpty())
+    {
+        GlyphRasterJob* job = releaseList.GetFirst();
+        job->RemoveNode();
+        removePending(job);
+        delete job;
+    }
+#else
+    SF_UNUSED(font);
+#endif
+}
+
+}}; // namespace Scaleform::Render
@@ -0,0 +1,146 @@
+/**************************************************************************
+
+Filename    :   Render_GlyphRasterPool.h
+Content     :   Worker pool rasterizing glyphs off the render thread.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_GlyphRasterPool_H
+#define INC_SF_Render_GlyphRasterPool_H
+
+#include "Kernel/SF_List.h"
+#include "Kernel/SF_Array.h"
+#include "Kernel/SF_Hash.h"
+#include "Kernel/SF_Threads.h"
+#include "Render/Render_GlyphQueue.h"
+#include "Render/Render_ShapeDataFloat.h"
+#include "Render/Render_WorkerPool.h"
+
+namespace Scaleform { namespace Render {
+
+class Rasterizer;
+class GlyphFitter;
+class GlyphScanlineFilter;
+
+// GlyphRasterJob rasterizes one glyph on a worker thread into its own
+// staging bitmap.
+//
+// The outline is copied from the font on the render thread when the job is
+// created, so workers never touch font data; if the font goes away while
+// the job is in flight, the job is only marked as cancelled.
+
+class GlyphRasterJob : public ListNode<GlyphRasterJob>,
+                       public NewOverrideBase<StatRender_Font_Mem>
+{
+public:
+    enum JobState
+    {
+        Job_Queued,     // Waiting for a worker.
+        Job_Running,    // Being rasterized by a worker.
+        Job_Done        // Raster is ready to be copied into the cache.
+    };
+
+    GlyphRasterJob(const GlyphParam& gp, const ShapeDataInterface* shape);
+
+    // Runs the rasterization; called by a worker.
+    void            Execute(Rasterizer* ras, GlyphFitter* fitter);
+
+    // True if the font was released while the job was in flight.
+    bool            IsCancelled() const { return Cancelled; }
+
+    // Set up by GlyphCache before queuing.
+    GlyphParam                  Param;
+    ShapeDataFloat              Shape;
+    const GlyphScanlineFilter*  pFilter;
+    float                       Scale;
+    float                       Stretch;
+    bool                        AutoFit;
+    unsigned                    NomHeight;
+    int                         LowerCaseTop;
+    int                         UpperCaseTop;
+    int                         Padding;
+    unsigned                    Spread;     // Distance field spread, 0 for coverage.
+    unsigned                    MaxHeight;
+
+    // Results; the glyph image is Width x Height with its top left
+    // corner at (X1, Y1) pixels from the glyph origin.
+    int                         X1, Y1;
+    unsigned                    Width, Height;
+    ArrayLH_POD<UByte>          Raster;
+
+private:
+    friend class GlyphRasterPool;
+
+    JobState                    State;
+    bool                        Cancelled;
+};
+
+
+// GlyphRasterPool runs GlyphRasterJobs on a pool of worker threads, each
+// having its own Rasterizer and GlyphFitter. GlyphCache queues the glyphs
+// that miss the cache when UseAsyncRasterization is set, and collects the
+// finished ones in OnBeginFrame, where only the copy into the texture
+// update buffers is left to the render thread.
+//
+// The pool is owned by GlyphCache and is only used from the render thread;
+// worker threads are started on first use.
+
+class GlyphRasterPool : public WorkerPool
+{
+public:
+    GlyphRasterPool();
+    ~GlyphRasterPool();
+
+    // Starts the worker threads; threadCount of 0 picks one fewer than the
+    // number of CPUs, leaving one to the render thread.
+    void            Initialize(unsigned threadCount = 0) { StartWorkers(threadCount); }
+    // Drops all the jobs and stops the worker threads.
+    void            Shutdown();
+
+    // Returns true if jobs can be queued, starting the workers if needed.
+    bool            IsAvailable();
+
+    // Returns true if the glyph is queued or being rasterized.
+    bool            IsPending(const GlyphParam& gp) const;
+
+    // Takes ownership of the job and queues it.
+    void            QueueJob(GlyphRasterJob* job);
+
+    // Returns a finished job, or 0 if there are none; the caller must
+    // delete it. Cancelled jobs are returned as well.
+    GlyphRasterJob* GetFinishedJob();
+
+    // Cancels the jobs of the font, or all the jobs if font is 0.
+    void            CancelJobs(FontCacheHandle* font = 0);
+
+private:
+    typedef HashLH<GlyphParamHash, GlyphRasterJob*, GlyphParamHash, StatRender_Font_Mem> PendingHashType;
+
+    void            removePending(GlyphRasterJob* job);
+
+    // *** WorkerPool implementation
+    virtual void*   beginJob();
+    virtual void    executeJob(void* job, void* context);
+    virtual void    endJob(void* job);
+    virtual void    workerMain();
+
+    PendingHashType             PendingJobs;
+
+#ifdef SF_ENABLE_THREADS
+    List<GlyphRasterJob>        QueuedJobs;
+    List<GlyphRasterJob>        RunningJobs;
+    List<GlyphRasterJob>        DoneJobs;
+#endif
+};
+
+}}; // namespace Scaleform::Render
+
+#endif
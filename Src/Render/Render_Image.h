@@ -668,6 +668,10 @@ public:
     virtual void SetPixelInScanline(ImageSwizzlerContext& ctx, unsigned x, Color c);
     virtual void SetPixelInScanline(ImageSwizzlerContext& ctx, unsigned x, UInt32 c);
     virtual Color GetPixelInScanline(ImageSwizzlerContext& ctx,unsigned x);
+
+    // Returns true if the swizzler accesses pixels through the ImageData scanlines,
+    // so that software DrawableImage commands may read and write them directly.
+    virtual bool  IsLinear() const { return true; }
 };
 
 struct ImageSwizzlerContext
@@ -14,6 +14,7 @@ otherwise accompanies this software in either electronic or hard copy form.
 **************************************************************************/
 
 #include "Render_MeshCache.h"
+#include "Render/Renderer2DImpl.h"
 #include "Kernel/SF_HeapNew.h"
 #include "Kernel/SF_Debug.h"
 
@@ -889,7 +890,9 @@ MeshCache::MeshResult MeshCache::GenerateMesh(
     MeshVertexOutput out(mesh, this,
                          sourceFormat, singleFormat, batchFormat,
                          waitForCache);
-    mesh->GetProvider()->GetData(mesh, &out, mesh->GetMeshGenFlags());
+    // Meshes tessellated in the background or cached on disk only need
+    // to be copied.
+    mesh->GetRenderer()->GetMeshData(mesh, &out);
     return out.GetResult();
 }
 
@@ -904,7 +907,7 @@ bool MeshCache::PrepareComplexMesh(ComplexMesh* mesh, bool waitForCache)
     {
         // Determine tessellation size, tessellate.
         ComplexMeshVertexOutput out(mesh, this, mesh->GetHAL(), waitForCache);
-        mesh->GetProvider()->GetData(mesh, &out, mesh->GetMeshGenFlags());
+        mesh->GetRenderer()->GetMeshData(mesh, &out);
         
         // Standard failure means there wasn't enough space; return false to retry.
         if (out.GetResult() == Alloc_Fail)
@@ -0,0 +1,329 @@
+/**************************************************************************
+
+Filename    :   Render_MeshDiskCache.cpp
+Content     :   Persistent cache of tessellated shape meshes.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Render/Render_MeshDiskCache.h"
+#include "Render/Render_ToleranceParams.h"
+#include "Render/Render_Vertex.h"
+#include "Kernel/SF_SysFile.h"
+#include "Kernel/SF_HeapNew.h"
+#include "Kernel/SF_Debug.h"
+
+namespace Scaleform { namespace Render {
+
+// File layout, header values are little-endian:
+//   "SFMC", Version, ByteOrder, ToleranceHash, MeshCount, then for each mesh
+//   MeshKeyType, FillCount, VertexMatrix, Fills, DataSize and Data.
+// Vertex and index data is stored in native byte order, so files are
+// rejected if ByteOrder doesn't match.
+
+static const UByte MeshDiskCache_Magic[4] = { 'S', 'F', 'M', 'C' };
+
+// Vertex formats are stored as indices into this table; meshes using other
+// formats are not cached.
+static const VertexFormat* const MeshDiskCache_Formats[] =
+{
+    &VertexXY16iC32::Format,
+    &VertexXY16iCF32::Format,
+    &VertexXY16iAlpha::Format,
+    &VertexXY16iInstance::Format
+};
+
+enum { MeshDiskCache_FormatCount = sizeof(MeshDiskCache_Formats) / sizeof(MeshDiskCache_Formats[0]) };
+
+static int MeshDiskCache_FindFormat(const VertexFormat* format)
+{
+    for (int i = 0; i < MeshDiskCache_FormatCount; ++i)
+        if (MeshDiskCache_Formats[i] == format)
+            return i;
+    return -1;
+}
+
+// Rounds float bits to a 10-bit mantissa, so that matrices differing only by
+// float noise produce the same key.
+static UInt32 MeshDiskCache_QuantizeFloat(float v)
+{
+    union { float f; UInt32 u; } bits;
+    bits.f = v;
+    return (bits.u + 0x1000) & ~UInt32(0x1FFF);
+}
+
+
+MeshDiskCache::MeshDiskCache() : ToleranceHash(0), Modified(false)
+{
+}
+
+MeshDiskCache::~MeshDiskCache()
+{
+}
+
+void MeshDiskCache::Clear()
+{
+    if (Meshes.GetSize())
+        Modified = true;
+    Meshes.Clear();
+}
+
+bool MeshDiskCache::makeKey(MeshKeyType* key, MeshBase* mesh)
+{
+    if (mesh->GetScale9Grid() || !mesh->GetProvider())
+        return false;
+    UInt64 id = mesh->GetProvider()->GetPersistentId();
+    if (id == 0)
+        return false;
+
+    const Matrix2F& m = mesh->GetViewMatrix();
+    key->ShapeId      = id;
+    key->Layer        = mesh->GetLayer();
+    key->MeshGenFlags = mesh->GetMeshGenFlags();
+    key->Matrix[0]    = MeshDiskCache_QuantizeFloat(m.Sx());
+    key->Matrix[1]    = MeshDiskCache_QuantizeFloat(m.Shx());
+    key->Matrix[2]    = MeshDiskCache_QuantizeFloat(m.Shy());
+    key->Matrix[3]    = MeshDiskCache_QuantizeFloat(m.Sy());
+    key->MorphRatio   = MeshDiskCache_QuantizeFloat(mesh->GetMorphRatio());
+    key->Pad          = 0;
+    return true;
+}
+
+void MeshDiskCache::checkTolerances(const ToleranceParams& tol)
+{
+    UInt32 hash = (UInt32)FixedSizeHash<ToleranceParams>::SDBM_Hash(&tol, sizeof(ToleranceParams));
+    if (hash != ToleranceHash)
+    {
+        Clear();
+        ToleranceHash = hash;
+    }
+}
+
+bool MeshDiskCache::HasMesh(MeshBase* mesh, const ToleranceParams& tol)
+{
+    MeshKeyType key;
+    checkTolerances(tol);
+    return makeKey(&key, mesh) && (Meshes.Get(key) != 0);
+}
+
+bool MeshDiskCache::GetMeshData(MeshBase* mesh, VertexOutput* out,
+                                const ToleranceParams& tol)
+{
+    MeshKeyType key;
+    checkTolerances(tol);
+    if (!makeKey(&key, mesh))
+        return false;
+
+    Ptr<MeshDataRecord>* precord = Meshes.Get(key);
+    if (!precord)
+    {
+        Ptr<MeshDataRecord> record = *SF_HEAP_AUTO_NEW(this) MeshDataRecord;
+        if (!record)
+            return false;
+        mesh->GetProvider()->GetData(mesh, record, mesh->GetMeshGenFlags());
+        if (!record->IsRecorded())
+            return false;
+        Meshes.Set(key, record);
+        Modified = true;
+        precord = Meshes.Get(key);
+    }
+    (*precord)->Replay(out);
+    return true;
+}
+
+void MeshDiskCache::AddMesh(MeshBase* mesh, MeshDataRecord* record,
+                            const ToleranceParams& tol)
+{
+    MeshKeyType key;
+    checkTolerances(tol);
+    if (!record->IsRecorded() || !makeKey(&key, mesh) || Meshes.Get(key))
+        return;
+    Meshes.Set(key, record);
+    Modified = true;
+}
+
+
+//------------------------------------------------------------------------
+bool MeshDiskCache::writeRecord(File* pfile, const MeshKeyType& key, const MeshDataRecord* record)
+{
+    UPInt i, fillCount = record->Fills.GetSize();
+    for (i = 0; i < fillCount; ++i)
+    {
+        if (MeshDiskCache_FindFormat(record->Fills[i].pFormat) < 0)
+            return true; // Not cacheable, skip.
+    }
+
+    pfile->WriteUInt64(key.ShapeId);
+    pfile->WriteUInt32(key.Layer);
+    pfile->WriteUInt32(key.MeshGenFlags);
+    for (i = 0; i < 4; ++i)
+        pfile->WriteUInt32(key.Matrix[i]);
+    pfile->WriteUInt32(key.MorphRatio);
+
+    pfile->WriteUInt32((UInt32)fillCount);
+    for (i = 0; i < 6; ++i)
+        pfile->WriteFloat(record->VertexMatrix.M[i / 3][i % 3]);
+    for (i = 0; i < fillCount; ++i)
+    {
+        const VertexOutput::Fill& fill = record->Fills[i];
+        pfile->WriteUInt32((UInt32)MeshDiskCache_FindFormat(fill.pFormat));
+        pfile->WriteUInt32(fill.VertexCount);
+        pfile->WriteUInt32(fill.IndexCount);
+        pfile->WriteUInt32(fill.FillIndex0);
+        pfile->WriteUInt32(fill.FillIndex1);
+        pfile->WriteUInt32(fill.MergeFlags);
+        pfile->WriteUInt32(fill.MeshIndex);
+    }
+
+    UPInt size = record->Data.GetSize();
+    pfile->WriteUInt32((UInt32)size);
+    return pfile->Write(record->Data.GetDataPtr(), (int)size) == (int)size;
+}
+
+bool MeshDiskCache::readRecord(File* pfile)
+{
+    MeshKeyType key;
+    UPInt       i;
+    key.ShapeId      = pfile->ReadUInt64();
+    key.Layer        = pfile->ReadUInt32();
+    key.MeshGenFlags = pfile->ReadUInt32();
+    for (i = 0; i < 4; ++i)
+        key.Matrix[i] = pfile->ReadUInt32();
+    key.MorphRatio   = pfile->ReadUInt32();
+    key.Pad          = 0;
+
+    Ptr<MeshDataRecord> record = *SF_HEAP_AUTO_NEW(this) MeshDataRecord;
+    if (!record)
+        return false;
+
+    UInt32 fillCount = pfile->ReadUInt32();
+    if (fillCount > 0xFFFF)
+        return false;
+    for (i = 0; i < 6; ++i)
+        record->VertexMatrix.M[i / 3][i % 3] = pfile->ReadFloat();
+
+    record->Fills.Resize(fillCount);
+    record->DataOffsets.Resize(fillCount * 2);
+    UPInt size = 0;
+    for (i = 0; i < fillCount; ++i)
+    {
+        VertexOutput::Fill& fill = record->Fills[i];
+        UInt32 format    = pfile->ReadUInt32();
+        if (format >= (UInt32)MeshDiskCache_FormatCount)
+            return false;
+        fill.pFormat     = MeshDiskCache_Formats[format];
+        fill.VertexCount = pfile->ReadUInt32();
+        fill.IndexCount  = pfile->ReadUInt32();
+        fill.FillIndex0  = pfile->ReadUInt32();
+        fill.FillIndex1  = pfile->ReadUInt32();
+        fill.MergeFlags  = pfile->ReadUInt32();
+        fill.MeshIndex   = pfile->ReadUInt32();
+
+        // Same layout as MeshDataRecord::BeginOutput.
+        record->DataOffsets[i*2]   = size;
+        size += (UPInt)fill.VertexCount * fill.pFormat->Size;
+        size  = (size + 1) & ~UPInt(1);
+        record->DataOffsets[i*2+1] = size;
+        size += (UPInt)fill.IndexCount * sizeof(UInt16);
+    }
+
+    UInt32 dataSize = pfile->ReadUInt32();
+    if (dataSize != size || size > (UPInt)pfile->BytesAvailable())
+        return false;
+    record->Data.Resize(size);
+    if (pfile->Read(record->Data.GetDataPtr(), (int)size) != (int)size)
+        return false;
+
+    // Indices are used as is by the mesh cache, so one past the fill's
+    // vertices would read outside of its vertex buffer.
+    for (i = 0; i < fillCount; ++i)
+    {
+        const VertexOutput::Fill& fill = record->Fills[i];
+        const UInt16* pindices = (const UInt16*)(record->Data.GetDataPtr() + record->DataOffsets[i*2+1]);
+        for (unsigned j = 0; j < fill.IndexCount; ++j)
+        {
+            if (pindices[j] >= fill.VertexCount)
+                return false;
+        }
+    }
+
+    record->Recorded = true;
+    Meshes.Set(key, record);
+    return true;
+}
+
+bool MeshDiskCache::LoadFile(const String& path)
+{
+    Meshes.Clear();
+    FilePath = path;
+    Modified = false;
+
+    SysFile file(path);
+    if (!file.IsValid())
+        return false;
+
+    UByte magic[4];
+    if (file.Read(magic, 4) != 4 || memcmp(magic, MeshDiskCache_Magic, 4) != 0 ||
+        file.ReadUInt32() != Version ||
+        file.ReadUInt32() != SF_BYTE_ORDER)
+    {
+        SF_DEBUG_WARNING1(1, "MeshDiskCache - incompatible file '%s'", path.ToCStr());
+        return false;
+    }
+
+    ToleranceHash    = file.ReadUInt32();
+    UInt32 meshCount = file.ReadUInt32();
+    for (UInt32 i = 0; i < meshCount; ++i)
+    {
+        if (!readRecord(&file))
+        {
+            SF_DEBUG_WARNING1(1, "MeshDiskCache - corrupt file '%s'", path.ToCStr());
+            Meshes.Clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MeshDiskCache::SaveFile(const String& path)
+{
+    const String& filePath = path.IsEmpty() ? FilePath : path;
+    if (filePath.IsEmpty())
+        return false;
+
+    SysFile file(filePath, File::Open_Write | File::Open_Truncate | File::Open_Create | File::Open_Buffered);
+    if (!file.IsValid())
+        return false;
+
+    // The count is patched after writing, since uncacheable meshes are skipped.
+    file.Write(MeshDiskCache_Magic, 4);
+    file.WriteUInt32(Version);
+    file.WriteUInt32(SF_BYTE_ORDER);
+    file.WriteUInt32(ToleranceHash);
+    int countPos = file.Tell();
+    file.WriteUInt32(0);
+
+    UInt32 meshCount = 0;
+    for (MeshHashType::ConstIterator it = Meshes.Begin(); it != Meshes.End(); ++it)
+    {
+        int pos = file.Tell();
+        if (!writeRecord(&file, it->First, it->Second))
+            return false;
+        if (file.Tell() != pos)
+            meshCount++;
+    }
+    file.Seek(countPos);
+    file.WriteUInt32(meshCount);
+
+    Modified = false;
+    return file.Close();
+}
+
+}}; // namespace Scaleform::Render
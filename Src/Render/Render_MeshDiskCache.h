@@ -0,0 +1,112 @@
+/**************************************************************************
+
+PublicHeader:   Render
+Filename    :   Render_MeshDiskCache.h
+Content     :   Persistent cache of tessellated shape meshes.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_MeshDiskCache_H
+#define INC_SF_Render_MeshDiskCache_H
+
+#include "Kernel/SF_RefCount.h"
+#include "Kernel/SF_Hash.h"
+#include "Kernel/SF_String.h"
+#include "Kernel/SF_File.h"
+#include "Render/Render_TessellationPool.h"
+
+namespace Scaleform { namespace Render {
+
+struct ToleranceParams;
+
+// MeshDiskCache keeps tessellated shape meshes so that they can be saved to
+// a file and loaded on the next run, removing tessellation from the first
+// frames that display the same shapes.
+//
+// Meshes are keyed by the persistent id of their provider (a hash of the
+// shape data, see MeshProvider::GetPersistentId), the draw layer, mesh
+// generation flags and the scale/rotation part of the view matrix the mesh
+// was tessellated for, rounded so that small float noise doesn't miss the
+// cache. Meshes with Scale9Grid are not cached. Cached data is only valid for
+// the ToleranceParams it was generated with; a change of tolerances drops
+// all of the meshes.
+//
+// The cache is installed with Renderer2D::SetMeshDiskCache, and is used
+// from the render thread only. Running a title once with an empty cache and
+// saving it populates the file for later runs.
+
+class MeshDiskCache : public RefCountBase<MeshDiskCache, StatRender_Mem>
+{
+public:
+    enum { Version = 1 };
+
+    MeshDiskCache();
+    ~MeshDiskCache();
+
+    // Loads meshes from file, replacing the current ones, and remembers the
+    // path for SaveFile. Returns false if the file doesn't exist or has
+    // an incompatible format; the cache is empty in that case.
+    bool            LoadFile(const String& path);
+    // Saves all meshes to file; an empty path uses the one given to LoadFile.
+    bool            SaveFile(const String& path = String());
+
+    const String&   GetFilePath() const { return FilePath; }
+    // Returns true if meshes were added since the last LoadFile or SaveFile.
+    bool            IsModified() const  { return Modified; }
+    UPInt           GetMeshCount() const { return Meshes.GetSize(); }
+    void            Clear();
+
+    // Returns true if the mesh data can be provided by GetMeshData.
+    bool            HasMesh(MeshBase* mesh, const ToleranceParams& tol);
+
+    // Outputs cached data of the mesh. On a miss, cacheable meshes are
+    // tessellated by their provider and recorded for later runs.
+    // Returns false if the caller must call MeshProvider::GetData itself.
+    bool            GetMeshData(MeshBase* mesh, VertexOutput* out,
+                                const ToleranceParams& tol);
+
+    // Adds a mesh tessellated elsewhere, such as by MeshTessellationPool.
+    void            AddMesh(MeshBase* mesh, MeshDataRecord* record,
+                            const ToleranceParams& tol);
+
+private:
+    struct MeshKeyType
+    {
+        UInt64  ShapeId;
+        UInt32  Layer;
+        UInt32  MeshGenFlags;
+        UInt32  Matrix[4];
+        UInt32  MorphRatio;
+        UInt32  Pad;
+
+        bool operator == (const MeshKeyType& other) const
+        {
+            return memcmp(this, &other, sizeof(MeshKeyType)) == 0;
+        }
+    };
+
+    typedef HashLH<MeshKeyType, Ptr<MeshDataRecord> > MeshHashType;
+
+    bool            makeKey(MeshKeyType* key, MeshBase* mesh);
+    void            checkTolerances(const ToleranceParams& tol);
+
+    bool            writeRecord(File* pfile, const MeshKeyType& key, const MeshDataRecord* record);
+    bool            readRecord(File* pfile);
+
+    MeshHashType    Meshes;
+    String          FilePath;
+    UInt32          ToleranceHash;
+    bool            Modified;
+};
+
+}}; // namespace Scaleform::Render
+
+#endif
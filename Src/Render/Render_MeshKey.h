@@ -209,6 +209,8 @@ public:
     virtual void        GetFillMatrix(MeshBase *mesh, Matrix2F* matrix, unsigned layer,
                                       unsigned fillIndex, unsigned meshGenFlags)
     { pDelegate->GetFillMatrix(mesh, matrix, layer, fillIndex, meshGenFlags); }
+    virtual UInt64      GetPersistentId()
+    { return pDelegate ? pDelegate->GetPersistentId() : 0; }
 
     virtual bool IsValid() const { return (pDelegate != 0); }
 
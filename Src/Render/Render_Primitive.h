@@ -49,6 +49,7 @@ class MeshCacheItem;
 class PrimitiveBatch;
 class FillData;
 class Mesh;
+class MeshTessellationJob;
 
 
 // MeshUseStatus describes current statues of MeshCacheItem. This status is used
@@ -194,6 +195,11 @@ public:
         SF_ASSERT(0); SF_UNUSED5(mesh, matrix, layer, fillIndex, meshGenFlags);
     }
 
+    // Returns an identifier of the source data that stays the same across runs,
+    // used to find meshes in MeshDiskCache. 0 means that meshes of this provider
+    // can't be cached on disk.
+    virtual UInt64      GetPersistentId() { return 0; }
+
     // Checks if the meshprovider is valid or not. Used by MeshKeySet, it returns false 
     // if pDelegate is null.
     virtual bool IsValid() const { return true; }
@@ -237,13 +243,17 @@ class MeshBase : public RefCountBase<MeshBase, StatRender_Mesh_Mem>, public Mesh
     // MeshGenFlags to use for accessing MeshProvider.
     unsigned    MGFlags;
 
+    // Background tessellation of the mesh, owned by MeshTessellationPool.
+    // Only accessed on the render thread.
+    MeshTessellationJob* pTessJob;
+
 public:
 
     MeshBase(Renderer2DImpl* prenderer, MeshProvider *provider,
              const Matrix2F& viewMatrix, float morphRatio, 
              unsigned layer, unsigned meshGenFlags)
     : pRenderer2D(prenderer), pProvider(provider), ViewMatrix(viewMatrix),
-      MorphRatio(morphRatio), Layer(layer), MGFlags(meshGenFlags)
+      MorphRatio(morphRatio), Layer(layer), MGFlags(meshGenFlags), pTessJob(0)
     { }
 
     MeshProvider*   GetProvider() const { return pProvider; }
@@ -260,6 +270,9 @@ public:
     Scale9GridData* GetScale9Grid()   const { return pScale9Grid; }
     void            SetScale9Grid(Scale9GridData* s9g) { pScale9Grid = s9g; }
 
+    MeshTessellationJob* GetTessellationJob() const        { return pTessJob; }
+    void            SetTessellationJob(MeshTessellationJob* job) { pTessJob = job; }
+
     virtual bool    IsEvicted() const { return StagingBufferSize == 0; }
 };
 
@@ -176,7 +176,8 @@ MorphShapeData::MorphShapeData(ShapeDataInterface* morphTo) :
 
 //------------------------------------------------------------------------
 ShapeMeshProvider::ShapeMeshProvider(ShapeDataInterface* shape, ShapeDataInterface* shapeMorph)
-    : pShapeData(shape), pMorphData(0), IdentityBounds(), GradientMorph(false), Strokes(false)
+    : pShapeData(shape), pMorphData(0), IdentityBounds(), PersistentId(0),
+      GradientMorph(false), Strokes(false)
 {
     if (shapeMorph)
     {
@@ -1218,15 +1219,14 @@ bool ShapeMeshProvider::acquireTessMeshes(TessBase* tess, const Matrix2F& mtx, V
 }
 
 //------------------------------------------------------------------------
-bool ShapeMeshProvider::tessellateFill(const Scale9GridInfo* s9g, unsigned drawLayerIdx, 
-                                       MeshBase *pmesh, VertexOutput* pout,
-                                       unsigned meshGenFlags)
+bool ShapeMeshProvider::tessellateFill(MeshGenerator* gen, const Scale9GridInfo* s9g,
+                                       unsigned drawLayerIdx, MeshBase *pmesh,
+                                       VertexOutput* pout, unsigned meshGenFlags)
 {
 //float morphRatio = pmesh->GetMorphRatio(); // DBG
 //printf("\n%f ", morphRatio);
 
     Renderer2DImpl* ren = pmesh->GetRenderer();
-    MeshGenerator*  gen = ren->GetMeshGen();
     const Matrix2F& mtx = pmesh->GetViewMatrix(); // tbd: Better passed as argument.
     float           morphRatio = pmesh->GetMorphRatio();
     ToleranceParams param = ren->GetToleranceParams();
@@ -1311,13 +1311,12 @@ bool ShapeMeshProvider::tessellateFill(const Scale9GridInfo* s9g, unsigned drawL
 
 
 //------------------------------------------------------------------------
-bool ShapeMeshProvider::tessellateStroke(const Scale9GridInfo* s9g, 
+bool ShapeMeshProvider::tessellateStroke(MeshGenerator* gen, const Scale9GridInfo* s9g,
                                          unsigned strokeStyleIdx, unsigned drawLayerIdx,
                                          MeshBase *pmesh, VertexOutput* pout,
                                          unsigned meshGenFlags)
 {
     Renderer2DImpl* ren = pmesh->GetRenderer();
-    MeshGenerator*  gen = ren->GetMeshGen();
     Matrix2F        mtx = pmesh->GetViewMatrix(); // tbd: Better passed as argument.
     float           morphRatio = pmesh->GetMorphRatio();
     const ToleranceParams& param = ren->GetToleranceParams();
@@ -1568,8 +1567,95 @@ bool ShapeMeshProvider::generateImage9Grid(Scale9GridInfo* s9g, MeshBase *mesh,
     return true;
 }
 
+//------------------------------------------------------------------------
+// 64-bit FNV-1a, used for persistent ids.
+static UInt64 ShapeHash_Add(UInt64 h, const void* pdata, UPInt size)
+{
+    const UByte* p = (const UByte*)pdata;
+    for (UPInt i = 0; i < size; ++i)
+    {
+        h ^= p[i];
+        h *= SF_UINT64(0x100000001B3);
+    }
+    return h;
+}
+
+static UInt64 ShapeHash_AddShape(UInt64 h, const ShapeDataInterface* shape)
+{
+    unsigned i;
+    unsigned fillCount   = shape->GetFillStyleCount();
+    unsigned strokeCount = shape->GetStrokeStyleCount();
+    h = ShapeHash_Add(h, &fillCount, sizeof(fillCount));
+    h = ShapeHash_Add(h, &strokeCount, sizeof(strokeCount));
+
+    // Complex fill data is provided with GetFillData and isn't part of
+    // the mesh; only the fact that the fill is complex affects tessellation.
+    for (i = 1; i <= fillCount; ++i)
+    {
+        FillStyleType fill;
+        shape->GetFillStyle(i, &fill);
+        UInt32 data[2] = { fill.Color, fill.pFill ? 1u : 0u };
+        h = ShapeHash_Add(h, data, sizeof(data));
+    }
+    for (i = 1; i <= strokeCount; ++i)
+    {
+        StrokeStyleType stroke;
+        shape->GetStrokeStyle(i, &stroke);
+        float    fdata[3] = { stroke.Width, stroke.Units, stroke.Miter };
+        UInt32   udata[3] = { stroke.Flags, stroke.Color, stroke.pFill ? 1u : 0u };
+        h = ShapeHash_Add(h, fdata, sizeof(fdata));
+        h = ShapeHash_Add(h, udata, sizeof(udata));
+        if (stroke.pDashes)
+        {
+            h = ShapeHash_Add(h, stroke.pDashes->Dashes, stroke.pDashes->DashCount * sizeof(float));
+            h = ShapeHash_Add(h, &stroke.pDashes->DashStart, sizeof(float));
+        }
+    }
+
+    ShapePosInfo  pos(shape->GetStartingPos());
+    ShapePathType pathType;
+    float    coord[Edge_MaxCoord];
+    unsigned styles[3];
+    while((pathType = shape->ReadPathInfo(&pos, coord, styles)) != Shape_EndShape)
+    {
+        h = ShapeHash_Add(h, &pathType, sizeof(pathType));
+        h = ShapeHash_Add(h, coord, 2 * sizeof(float));
+        h = ShapeHash_Add(h, styles, sizeof(styles));
+
+        PathEdgeType edgeType;
+        while((edgeType = shape->ReadEdge(&pos, coord)) != Edge_EndPath)
+        {
+            h = ShapeHash_Add(h, &edgeType, sizeof(edgeType));
+            h = ShapeHash_Add(h, coord, ((edgeType == Edge_LineTo) ? 2 : 
+                                         ((edgeType == Edge_QuadTo) ? 4 : 6)) * sizeof(float));
+        }
+    }
+    return h;
+}
+
+UInt64 ShapeMeshProvider::GetPersistentId()
+{
+    if (PersistentId == 0 && pShapeData)
+    {
+        UInt64 h = SF_UINT64(0xCBF29CE484222325);
+        h = ShapeHash_AddShape(h, pShapeData);
+        if (pMorphData)
+            h = ShapeHash_AddShape(h, pMorphData->pMorphTo);
+        // 0 is reserved for "not cacheable".
+        PersistentId = h ? h : 1;
+    }
+    return PersistentId;
+}
+
+
 //------------------------------------------------------------------------
 bool ShapeMeshProvider::GetData(MeshBase *mesh, VertexOutput* verOut, unsigned meshGenFlags)
+{
+    return GetData(mesh, verOut, meshGenFlags, mesh->GetRenderer()->GetMeshGen());
+}
+
+bool ShapeMeshProvider::GetData(MeshBase *mesh, VertexOutput* verOut, unsigned meshGenFlags,
+                                MeshGenerator* gen)
 {
     Ptr<Scale9GridInfo> s9g;
     unsigned drawLayer = mesh->GetLayer();
@@ -1589,11 +1675,11 @@ bool ShapeMeshProvider::GetData(MeshBase *mesh, VertexOutput* verOut, unsigned m
     if (strokeStyleIdx == 0)
     {
         // Fill
-        return tessellateFill(s9g, drawLayer, mesh, verOut, meshGenFlags);
+        return tessellateFill(gen, s9g, drawLayer, mesh, verOut, meshGenFlags);
     }
 
     // Stroke
-    return tessellateStroke(s9g, strokeStyleIdx, drawLayer, mesh, verOut, meshGenFlags);
+    return tessellateStroke(gen, s9g, strokeStyleIdx, drawLayer, mesh, verOut, meshGenFlags);
 }
 
 
@@ -90,7 +90,7 @@ public:
     enum { VerBufSize = 256, TriBufSize = 256 };
 
     ShapeMeshProvider()
-        : pShapeData(0), pMorphData(0), IdentityBounds()
+        : pShapeData(0), pMorphData(0), IdentityBounds(), PersistentId(0)
     {}
 
     ShapeMeshProvider(ShapeDataInterface* shape, ShapeDataInterface* shapeMorph = 0);
@@ -105,6 +105,10 @@ public:
 
     // Mesh provider virtual function
     virtual bool    GetData(MeshBase *pmesh, VertexOutput* pout, unsigned meshGenFlags);
+    // GetData using the specified generator instead of the renderer one,
+    // so that meshes can be tessellated outside of the render thread.
+    bool            GetData(MeshBase *pmesh, VertexOutput* pout, unsigned meshGenFlags,
+                            MeshGenerator* gen);
     virtual void    OnEvict(MeshBase *pmesh) { SF_UNUSED(pmesh); }
     virtual RectF   GetIdentityBounds() const { return IdentityBounds; }
     virtual RectF   GetBounds(const Matrix2F& m) const;
@@ -126,6 +130,8 @@ public:
                                     unsigned fillIndex, unsigned meshGenFlags);
     virtual void        GetFillMatrix(MeshBase *mesh, Matrix2F* matrix, unsigned drawLayer,
                                       unsigned fillIndex, unsigned meshGenFlags);
+    // Hash of the shape and style data, computed on first use.
+    virtual UInt64      GetPersistentId();
 
     // Shape data specific functions (non-virtual)
     unsigned GetFillStyleCount() const { return pShapeData->GetFillStyleCount(); }
@@ -175,11 +181,12 @@ private:
 
     bool generateImage9Grid(Scale9GridInfo* s9g, MeshBase *mesh, VertexOutput* verOut, unsigned drawLayer);
 
-    bool tessellateFill(const Scale9GridInfo* s9g, unsigned drawLayerIdx, MeshBase *pmesh, 
-                        VertexOutput* pout, unsigned meshGenFlags);
+    bool tessellateFill(MeshGenerator* gen, const Scale9GridInfo* s9g, unsigned drawLayerIdx,
+                        MeshBase *pmesh, VertexOutput* pout, unsigned meshGenFlags);
 
-    bool tessellateStroke(const Scale9GridInfo* s9g, unsigned drawStyleIdx, unsigned shapeLayerIdx,
-                          MeshBase *pmesh, VertexOutput* pout, unsigned meshGenFlags);
+    bool tessellateStroke(MeshGenerator* gen, const Scale9GridInfo* s9g, unsigned drawStyleIdx,
+                          unsigned shapeLayerIdx, MeshBase *pmesh, VertexOutput* pout,
+                          unsigned meshGenFlags);
 
     void computeImgAdjustMatrix(const Scale9GridData* s9g, unsigned drawLayer, 
                                 unsigned imgFillStyle, Matrix2F* mtx);
@@ -217,6 +224,7 @@ private:
     Ptr<ShapeDataInterface>     pShapeData;
     Ptr<MorphShapeData>         pMorphData;
     RectF                       IdentityBounds;
+    UInt64                      PersistentId;
     bool                        GradientMorph;
     bool                        Strokes;
 };
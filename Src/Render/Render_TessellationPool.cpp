@@ -0,0 +1,266 @@
+/**************************************************************************
+
+Filename    :   Render_TessellationPool.cpp
+Content     :   Worker pool tessellating shape meshes off the render thread.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Render/Render_TessellationPool.h"
+#include "Render/Render_ShapeMeshProvider.h"
+#include "Render/Render_TessGen.h"
+#include "Kernel/SF_Alg.h"
+#include "Kernel/SF_HeapNew.h"
+
+namespace Scaleform { namespace Render {
+
+// ***** MeshDataRecord
+
+bool MeshDataRecord::BeginOutput(const Fill* fills, unsigned fillCount,
+                                 const Matrix2F& vertexMatrix)
+{
+    Recorded = false;
+    Fills.Resize(fillCount);
+    DataOffsets.Resize(fillCount * 2);
+
+    UPInt size = 0;
+    for (unsigned i = 0; i < fillCount; ++i)
+    {
+        Fills[i] = fills[i];
+        DataOffsets[i*2]   = size;
+        size += fills[i].VertexCount * fills[i].pFormat->Size;
+        size  = (size + 1) & ~UPInt(1);
+        DataOffsets[i*2+1] = size;
+        size += fills[i].IndexCount * sizeof(UInt16);
+    }
+    Data.Resize(size);
+    VertexMatrix = vertexMatrix;
+    return Data.GetSize() == size;
+}
+
+void MeshDataRecord::EndOutput()
+{
+    Recorded = true;
+}
+
+void MeshDataRecord::SetVertices(unsigned fillIndex, unsigned vertexOffset,
+                                 void* pvertices, unsigned vertexCount)
+{
+    unsigned vertexSize = Fills[fillIndex].pFormat->Size;
+    memcpy(&Data[DataOffsets[fillIndex*2] + vertexOffset * vertexSize],
+           pvertices, vertexCount * vertexSize);
+}
+
+void MeshDataRecord::SetIndices(unsigned fillIndex, unsigned indexOffset,
+                                UInt16* pindices, unsigned indexCount)
+{
+    memcpy(&Data[DataOffsets[fillIndex*2+1] + indexOffset * sizeof(UInt16)],
+           pindices, indexCount * sizeof(UInt16));
+}
+
+void MeshDataRecord::Replay(VertexOutput* out) const
+{
+    SF_ASSERT(Recorded);
+
+    // Outputs that fail to allocate report it through their own result, the
+    // same way as with a direct GetData call.
+    unsigned fillCount = (unsigned)Fills.GetSize();
+    if (!out->BeginOutput(Fills.GetDataPtr(), fillCount, VertexMatrix))
+        return;
+
+    UByte* pdata = const_cast<UByte*>(Data.GetDataPtr());
+    for (unsigned i = 0; i < fillCount; ++i)
+    {
+        if (Fills[i].VertexCount)
+            out->SetVertices(i, 0, pdata + DataOffsets[i*2], Fills[i].VertexCount);
+        if (Fills[i].IndexCount)
+            out->SetIndices(i, 0, (UInt16*)(pdata + DataOffsets[i*2+1]), Fills[i].IndexCount);
+    }
+    out->EndOutput();
+}
+
+
+// ***** MeshTessellationJob
+
+MeshTessellationJob::MeshTessellationJob(MeshBase* mesh, ShapeMeshProvider* provider) :
+    pMesh(mesh), pProvider(provider), State(Job_Queued)
+{
+    pRecord = *SF_NEW MeshDataRecord;
+}
+
+MeshTessellationJob::~MeshTessellationJob()
+{
+}
+
+void MeshTessellationJob::Execute(MeshGenerator* gen)
+{
+    pProvider->GetData(pMesh, pRecord, pMesh->GetMeshGenFlags(), gen);
+}
+
+
+// ***** MeshTessellationPool
+
+// Tessellators and acquireTessMeshes need more than the default stack.
+MeshTessellationPool::MeshTessellationPool() :
+    WorkerPool("Scaleform Tessellation", 256 * 1024)
+{
+}
+
+MeshTessellationPool::~MeshTessellationPool()
+{
+    Shutdown();
+}
+
+void MeshTessellationPool::Shutdown()
+{
+#ifdef SF_ENABLE_THREADS
+    releaseJobs(true);
+#endif
+    StopWorkers();
+}
+
+void MeshTessellationPool::workerMain()
+{
+    // Each worker has its own generator; its heaps are only touched by
+    // this thread, but are allocated from the thread-safe global heap.
+    MeshGenerator gen(Memory::GetGlobalHeap());
+    runWorker(&gen);
+}
+
+void* MeshTessellationPool::beginJob()
+{
+#ifdef SF_ENABLE_THREADS
+    if (QueuedJobs.IsEmpty())
+        return 0;
+    MeshTessellationJob* job = QueuedJobs.GetFirst();
+    job->RemoveNode();
+    job->State = MeshTessellationJob::Job_Running;
+    ActiveJobs.PushBack(job);
+    return job;
+#else
+    return 0;
+#endif
+}
+
+void MeshTessellationPool::executeJob(void* job, void* context)
+{
+    ((MeshTessellationJob*)job)->Execute((MeshGenerator*)context);
+}
+
+void MeshTessellationPool::endJob(void* job)
+{
+    ((MeshTessellationJob*)job)->State = MeshTessellationJob::Job_Done;
+}
+
+#ifdef SF_ENABLE_THREADS
+void MeshTessellationPool::releaseJobs(bool waitForRunning)
+{
+    List<MeshTessellationJob> releaseList;
+    {
+        Mutex::Locker lock(&PoolLock);
+        releaseList.PushListToBack(QueuedJobs);
+
+        MeshTessellationJob* job = ActiveJobs.GetFirst();
+        while (!ActiveJobs.IsNull(job))
+        {
+            MeshTessellationJob* next = ActiveJobs.GetNext(job);
+            if (job->State == MeshTessellationJob::Job_Running)
+            {
+                if (!waitForRunning)
+                {
+                    job = next;
+                    continue;
+                }
+                while (job->State == MeshTessellationJob::Job_Running)
+                    JobDone.Wait(&PoolLock);
+                // Other jobs may have moved while waiting.
+                next = ActiveJobs.GetNext(job);
+            }
+            job->RemoveNode();
+            releaseList.PushBack(job);
+            job = next;
+        }
+    }
+
+    // Destroy jobs outside of the lock, since they may release
+    // the last reference to their mesh.
+    while (!releaseList.IsEmpty())
+    {
+        MeshTessellationJob* job = releaseList.GetFirst();
+        job->RemoveNode();
+        if (job->pMesh->GetTessellationJob() == job)
+            job->pMesh->SetTessellationJob(0);
+        delete job;
+    }
+}
+#endif
+
+void MeshTessellationPool::QueueMesh(MeshBase* mesh, ShapeMeshProvider* provider)
+{
+#ifdef SF_ENABLE_THREADS
+    Initialize();
+    if (!GetWorkerCount() || mesh->GetTessellationJob())
+        return;
+
+    MeshTessellationJob* job = SF_NEW MeshTessellationJob(mesh, provider);
+    if (!job)
+        return;
+    if (!job->pRecord)
+    {
+        delete job;
+        return;
+    }
+    mesh->SetTessellationJob(job);
+
+    Mutex::Locker lock(&PoolLock);
+    QueuedJobs.PushBack(job);
+    notifyJobQueued();
+#else
+    SF_UNUSED2(mesh, provider);
+#endif
+}
+
+MeshDataRecord* MeshTessellationPool::GetMeshRecord(MeshBase* mesh)
+{
+#ifdef SF_ENABLE_THREADS
+    MeshTessellationJob* job = mesh->GetTessellationJob();
+    if (!job)
+        return 0;
+    {
+        Mutex::Locker lock(&PoolLock);
+        if (job->State == MeshTessellationJob::Job_Queued)
+        {
+            // No worker got to it yet; it is faster to tessellate it here
+            // than to wait.
+            job->RemoveNode();
+            job->State = MeshTessellationJob::Job_Claimed;
+            ActiveJobs.PushBack(job);
+            return 0;
+        }
+        while (job->State == MeshTessellationJob::Job_Running)
+            JobDone.Wait(&PoolLock);
+    }
+    if ((job->State != MeshTessellationJob::Job_Done) || !job->pRecord->IsRecorded())
+        return 0;
+    return job->pRecord;
+#else
+    SF_UNUSED(mesh);
+    return 0;
+#endif
+}
+
+void MeshTessellationPool::ReleaseJobs()
+{
+#ifdef SF_ENABLE_THREADS
+    releaseJobs(false);
+#endif
+}
+
+}}; // namespace Scaleform::Render
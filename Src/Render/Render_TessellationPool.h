@@ -0,0 +1,161 @@
+/**************************************************************************
+
+Filename    :   Render_TessellationPool.h
+Content     :   Worker pool tessellating shape meshes off the render thread.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_TessellationPool_H
+#define INC_SF_Render_TessellationPool_H
+
+#include "Kernel/SF_List.h"
+#include "Kernel/SF_Array.h"
+#include "Kernel/SF_Threads.h"
+#include "Render/Render_Primitive.h"
+#include "Render/Render_WorkerPool.h"
+
+namespace Scaleform { namespace Render {
+
+class ShapeMeshProvider;
+struct MeshGenerator;
+class MeshDiskCache;
+
+// MeshDataRecord records the VertexOutput calls of MeshProvider::GetData, so
+// that they can be replayed into the mesh cache later or on another thread.
+// It is used to hand over meshes tessellated by MeshTessellationPool workers
+// and to keep meshes in MeshDiskCache.
+
+class MeshDataRecord : public RefCountBase<MeshDataRecord, StatRender_Mem>,
+                       public VertexOutput
+{
+    friend class MeshDiskCache;
+public:
+    MeshDataRecord() : Recorded(false) { }
+
+    // Returns true once a complete mesh has been recorded.
+    bool            IsRecorded() const { return Recorded; }
+
+    // Feeds the recorded mesh data to the output.
+    void            Replay(VertexOutput* out) const;
+
+    // *** VertexOutput recording implementation
+    virtual bool    BeginOutput(const Fill* fills, unsigned fillCount,
+                                const Matrix2F& vertexMatrix);
+    virtual void    EndOutput();
+    virtual void    SetVertices(unsigned fillIndex, unsigned vertexOffset,
+                                void* pvertices, unsigned vertexCount);
+    virtual void    SetIndices(unsigned fillIndex, unsigned indexOffset,
+                               UInt16* pindices, unsigned indexCount);
+
+private:
+    bool                    Recorded;
+    ArrayLH_POD<Fill>       Fills;
+    Matrix2F                VertexMatrix;
+    // Vertex and index data of all fills; for fill i, vertices start at
+    // DataOffsets[i*2] and indices at DataOffsets[i*2+1].
+    ArrayLH_POD<UByte>      Data;
+    ArrayLH_POD<UPInt>      DataOffsets;
+};
+
+
+// MeshTessellationJob tessellates one mesh on a worker thread into
+// a MeshDataRecord.
+//
+// The job holds references to both the mesh and its provider, so neither of
+// them can be destroyed while the job is in flight; jobs are only created
+// and destroyed on the render thread.
+
+class MeshTessellationJob : public ListNode<MeshTessellationJob>,
+                            public NewOverrideBase<StatRender_Mem>
+{
+public:
+    enum JobState
+    {
+        Job_Queued,     // Waiting for a worker.
+        Job_Running,    // Being tessellated by a worker.
+        Job_Done,       // Recorded data is ready.
+        Job_Claimed     // Taken by the render thread before a worker started it.
+    };
+
+    MeshTessellationJob(MeshBase* mesh, ShapeMeshProvider* provider);
+    ~MeshTessellationJob();
+
+    MeshBase*       GetMesh() const     { return pMesh; }
+    JobState        GetState() const    { return State; }
+
+    // Runs the tessellation, recording results; called by a worker.
+    void            Execute(MeshGenerator* gen);
+
+private:
+    friend class MeshTessellationPool;
+
+    Ptr<MeshBase>           pMesh;
+    Ptr<ShapeMeshProvider>  pProvider;
+    Ptr<MeshDataRecord>     pRecord;
+    JobState                State;
+};
+
+
+// MeshTessellationPool runs MeshTessellationJobs on a pool of worker threads,
+// each having its own MeshGenerator. Meshes are queued as they are created
+// during the tree update, so that by the time the frame is drawn and the
+// MeshCache misses on them, their tessellation has already been done in
+// parallel. Renderer2DImpl::GetMeshData asks for the finished record before
+// calling MeshProvider::GetData; jobs that workers haven't started yet are claimed
+// and tessellated on the render thread as before, so a frame never waits
+// for queued work.
+//
+// The pool is owned by Renderer2DImpl and is only used from the render
+// thread; worker threads are started on first QueueMesh. Jobs are released
+// in ReleaseJobs at the end of the frame, later cache misses of the same
+// mesh tessellate it on the render thread.
+
+class MeshTessellationPool : public WorkerPool
+{
+public:
+    MeshTessellationPool();
+    ~MeshTessellationPool();
+
+    // Starts the worker threads; threadCount of 0 picks one fewer than the
+    // number of CPUs, since the render thread tessellates the meshes it claims.
+    void            Initialize(unsigned threadCount = 0) { StartWorkers(threadCount); }
+    // Releases all the jobs and stops the worker threads.
+    void            Shutdown();
+
+    // Queues background tessellation of a newly created mesh.
+    void            QueueMesh(MeshBase* mesh, ShapeMeshProvider* provider);
+
+    // Returns the data of the mesh queued earlier, waiting for it if it is
+    // being tessellated. Returns 0 if the mesh has no finished job, and must
+    // be tessellated by the caller.
+    MeshDataRecord* GetMeshRecord(MeshBase* mesh);
+
+    // Releases the jobs of this frame, except the ones still running.
+    void            ReleaseJobs();
+
+private:
+    // *** WorkerPool implementation
+    virtual void*   beginJob();
+    virtual void    executeJob(void* job, void* context);
+    virtual void    endJob(void* job);
+    virtual void    workerMain();
+
+#ifdef SF_ENABLE_THREADS
+    void            releaseJobs(bool waitForRunning);
+
+    List<MeshTessellationJob>   QueuedJobs;
+    List<MeshTessellationJob>   ActiveJobs;
+#endif
+};
+
+}}; // namespace Scaleform::Render
+
+#endif
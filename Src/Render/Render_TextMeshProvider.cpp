@@ -327,6 +327,10 @@ void TextMeshProvider::ClearEntries()
         pCache->RemoveNotifier(Notifiers[i]);
     }
     Notifiers.ClearAndRelease();
+    if (HasPendingGlyphs())
+    {
+        pCache->RemovePendingText(this);
+    }
     for(i = 0; i < Entries.GetSize(); ++i)
     {
         TextMeshEntry& ent = Entries[i];
@@ -474,7 +478,7 @@ MeshUseStatus TextMeshProvider::GetMeshUseStatus() const
     for (UPInt i=0; i< GetLayerCount(); i++)
     {
         const TextMeshLayer& l = GetLayer((unsigned)i);
-        if (l.Type > TextLayer_RasterText)
+        if (l.Type > TextLayer_RasterDFAText)
             break;
         if ((l.Type >= TextLayer_Shadow) && l.pMesh)
         {
@@ -1226,6 +1230,7 @@ bool TextMeshProvider::GetData(MeshBase *mesh, VertexOutput* verOut, unsigned me
     case TextLayer_Shadow:
     case TextLayer_ShadowText:
     case TextLayer_RasterText:
+    case TextLayer_RasterDFAText:
         return generateRasterMesh(verOut, layer);
 
     case TextLayer_PackedText:
@@ -1295,6 +1300,15 @@ void TextMeshProvider::GetFillData(FillData* data, unsigned layer,
             break;
         }
 
+    case TextLayer_RasterDFAText:
+        {
+            Image* img = pCache->GetImage(Entries[Layers[layer].Start].TextureId);
+            *data = FillData(img, ImageFillMode(Wrap_Clamp, Sample_Linear));
+            data->PrimFill = PrimFill_UVTextureDFAlpha_VColor;
+            data->pVFormat = &RasterGlyphVertex::Format;
+            break;
+        }
+
     case TextLayer_PackedText:
         {
             Image* img = Entries[Layers[layer].Start].EntryData.PackedData.pGlyph->pImage;
@@ -1705,6 +1719,8 @@ void TextMeshProvider::addRasterGlyph(TmpTextStorage& storage, TextLayerType typ
         e.EntryData.RasterData.Coord[3] = rect.y2;
         e.EntryData.RasterData.pGlyph = node;
         storage.Entries.PushBack(e);
+        if (type == TextLayer_RasterDFAText)
+            Flags |= BF_DistField;
     }
 }
 
@@ -1781,7 +1797,7 @@ bool TextMeshProvider::addGlyph(TmpTextStorage& storage, GlyphRunData& data, uns
     bool drawShadow = true;
     float screenSize = data.FontSize * data.HeightRatio;
     GlyphParam gp;
-    GlyphNode* node;
+    GlyphNode* node = 0;
 
     const TextureGlyph* tgl = data.pFont->GetTextureGlyph(glyphIndex);
     if (tgl)
@@ -1837,13 +1853,33 @@ bool TextMeshProvider::addGlyph(TmpTextStorage& storage, GlyphRunData& data, uns
 
     gp.SetAutoFit(autoFit);
 
+    // Glyphs of scaled or animated text are cached once as distance fields,
+    // readability text keeps its size specific hinted rasters.
+    const GlyphCacheParams& cacheParams = pCache->GetParams();
+    TextLayerType textLayer = TextLayer_RasterText;
+    if ( cacheParams.UseDistanceField &&
+        !gp.IsOptRead() &&
+        !gp.IsBitmapFont() &&
+         gp.GetOutline() == 0 &&
+         data.VectorSize == 0 &&
+         data.RasterSize == 0 &&
+        !gp.pFont->pFont->IsRasterOnly() &&
+        !data.Param.ShadowParam.IsHiddenObject())
+    {
+        gp.SetDistField(true);
+        gp.SetStretch(false);
+        gp.SetAutoFit(false);
+        gp.SetFontSize(float(cacheParams.DistanceFieldSize));
+        textLayer = TextLayer_RasterDFAText;
+    }
+
     if (!data.Param.ShadowParam.IsKnockOut() && !needVector)
     {
         float stretch = gp.GetStretch();
         node = pCache->FindGlyph(this, gp);
         if (node)
         {
-            addRasterGlyph(storage, TextLayer_RasterText, data, data.mColor, node, screenSize, snap, stretch);
+            addRasterGlyph(storage, textLayer, data, data.mColor, node, screenSize, snap, stretch);
         }
         else
         {
@@ -1854,7 +1890,7 @@ bool TextMeshProvider::addGlyph(TmpTextStorage& storage, GlyphRunData& data, uns
 
             if (node)
             {
-                addRasterGlyph(storage, TextLayer_RasterText, data, data.mColor, node, screenSize, snap, stretch);
+                addRasterGlyph(storage, textLayer, data, data.mColor, node, screenSize, snap, stretch);
             }
             else
             {
@@ -1882,6 +1918,13 @@ bool TextMeshProvider::addGlyph(TmpTextStorage& storage, GlyphRunData& data, uns
 
                 if (res == GlyphCache::Res_ShapeIsTooBig || res == GlyphCache::Res_NoRasterCache)
                     needVector = true;
+
+                if (res == GlyphCache::Res_Pending)
+                {
+                    // Draw the vector shape until the raster is in the cache.
+                    pCache->AddPendingText(this);
+                    needVector = true;
+                }
             }
         }
     }
@@ -1892,6 +1935,11 @@ bool TextMeshProvider::addGlyph(TmpTextStorage& storage, GlyphRunData& data, uns
                        data.FontSize, data.NewLineX, data.NewLineY);
         Flags |= BF_HasVectorGlyphs;
     }
+    else if (node && gp.IsDistField() && data.Param.ShadowParam.BlurX)
+    {
+        // The blurred drop shadow is drawn from the distance field.
+        drawShadow = false;
+    }
 
     if (data.Param.ShadowColor && drawShadow)
     {
@@ -2204,6 +2252,7 @@ bool TextMeshProvider::CreateMeshData(const TextLayout* layout, Renderer2DImpl*
             switch(ent.LayerType)
             {
             case TextLayer_RasterText:
+            case TextLayer_RasterDFAText:
                 bounds.x1 = ent.EntryData.RasterData.Coord[0];
                 bounds.y1 = ent.EntryData.RasterData.Coord[1];
                 bounds.x2 = ent.EntryData.RasterData.Coord[2];
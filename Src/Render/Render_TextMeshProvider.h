@@ -324,6 +324,7 @@ public:
         BF_HasMask         = 0x0100,
 
         BF_DistField       = 0x0200,
+        BF_PendingGlyphs   = 0x0400,
     };
 
     TextMeshProvider(GlyphCache* cache);
@@ -355,6 +356,11 @@ public:
     bool HasVectorGlyphs() const { return (Flags & BF_HasVectorGlyphs) != 0; }
     bool HasDistanceField() const { return (Flags & BF_DistField) != 0; }
 
+    // Set while vector glyphs are drawn in place of glyphs being rasterized
+    // asynchronously; maintained by GlyphCache::AddPendingText.
+    bool HasPendingGlyphs() const { return (Flags & BF_PendingGlyphs) != 0; }
+    void SetPendingGlyphs(bool f) { if(f) Flags |= BF_PendingGlyphs; else Flags &= ~BF_PendingGlyphs; }
+
     void PinSlots();
     void UnpinSlots();
     void OnEvictSlots();
@@ -727,6 +727,14 @@ bool TreeCacheShapeLayer::updateMeshKey(Renderer2DImpl* r2D, ShapeMeshProvider*
             Ptr<Scale9GridData> p = *SF_HEAP_AUTO_NEW(this) Scale9GridData(s9g);
             newKey->pMesh->SetScale9Grid(p);
         }
+        else if (!(flags & MeshKey::KF_Degenerate) &&
+                 !(r2D->GetMeshDiskCache() &&
+                   r2D->GetMeshDiskCache()->HasMesh(newKey->pMesh, r2D->GetToleranceParams())))
+        {
+            // Start tessellating the mesh in the background while the rest of
+            // the tree is updated; MeshCache picks up the result when drawing.
+            r2D->GetTessellationPool().QueueMesh(newKey->pMesh, provider);
+        }
     }
 
 //if (pMeshKey)
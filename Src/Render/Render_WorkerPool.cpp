@@ -0,0 +1,188 @@
+/**************************************************************************
+
+Filename    :   Render_WorkerPool.cpp
+Content     :   Pool of worker threads shared by the renderer systems
+                that split their work between threads.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Render/Render_WorkerPool.h"
+#include "Kernel/SF_Alg.h"
+#include "Kernel/SF_HeapNew.h"
+
+namespace Scaleform { namespace Render {
+
+WorkerPool::WorkerPool(const char* threadName, UPInt stackSize)
+{
+#ifdef SF_ENABLE_THREADS
+    ThreadName     = threadName;
+    StackSize      = stackSize;
+    Generation     = 0;
+    PendingWorkers = 0;
+    Started        = false;
+    Exiting        = false;
+#else
+    SF_UNUSED2(threadName, stackSize);
+#endif
+}
+
+WorkerPool::~WorkerPool()
+{
+#ifdef SF_ENABLE_THREADS
+    // Derived classes stop the workers, before their data is destroyed.
+    SF_ASSERT(Workers.GetSize() == 0);
+#endif
+}
+
+void WorkerPool::StartWorkers(unsigned threadCount)
+{
+#ifdef SF_ENABLE_THREADS
+    if (Started)
+        return;
+    Started = true;
+
+    if (threadCount == 0)
+        threadCount = (unsigned)Alg::Max(1, Thread::GetCPUCount()) - 1;
+    threadCount = Alg::Min(threadCount, (unsigned)MaxWorkers);
+
+    Generation = 0;
+    Exiting    = false;
+    for (unsigned i = 0; i < threadCount; ++i)
+    {
+        Ptr<Thread> pthread = *SF_NEW Thread(workerThreadFn, this, StackSize);
+        if (!pthread || !pthread->Start())
+            break;
+        pthread->SetThreadName(ThreadName);
+        Workers.PushBack(pthread);
+    }
+#else
+    SF_UNUSED(threadCount);
+#endif
+}
+
+void WorkerPool::StopWorkers()
+{
+#ifdef SF_ENABLE_THREADS
+    if (Workers.GetSize())
+    {
+        {
+            Mutex::Locker lock(&PoolLock);
+            Exiting = true;
+            WorkQueued.NotifyAll();
+        }
+        for (UPInt i = 0; i < Workers.GetSize(); ++i)
+            Workers[i]->Wait();
+        Workers.Clear();
+    }
+    Exiting = false;
+    Started = false;
+#endif
+}
+
+bool WorkerPool::AreWorkersStarted() const
+{
+#ifdef SF_ENABLE_THREADS
+    return Started;
+#else
+    return false;
+#endif
+}
+
+unsigned WorkerPool::GetWorkerCount() const
+{
+#ifdef SF_ENABLE_THREADS
+    return (unsigned)Workers.GetSize();
+#else
+    return 0;
+#endif
+}
+
+void WorkerPool::RunParallel()
+{
+#ifdef SF_ENABLE_THREADS
+    unsigned workerCount = (unsigned)Workers.GetSize();
+    if (workerCount)
+    {
+        Mutex::Locker lock(&PoolLock);
+        PendingWorkers = workerCount;
+        ++Generation;
+        WorkQueued.NotifyAll();
+    }
+#endif
+
+    processParallel();
+
+#ifdef SF_ENABLE_THREADS
+    if (workerCount)
+    {
+        Mutex::Locker lock(&PoolLock);
+        while (PendingWorkers)
+            JobDone.Wait(&PoolLock);
+    }
+#endif
+}
+
+void WorkerPool::notifyJobQueued()
+{
+#ifdef SF_ENABLE_THREADS
+    WorkQueued.Notify();
+#endif
+}
+
+void WorkerPool::runWorker(void* context)
+{
+#ifdef SF_ENABLE_THREADS
+    // Generation is reset before the workers are started, so a RunParallel
+    // issued before this thread gets here is not missed.
+    unsigned seenGeneration = 0;
+
+    PoolLock.DoLock();
+    while(1)
+    {
+        void* job = 0;
+        while (!Exiting && Generation == seenGeneration && (job = beginJob()) == 0)
+            WorkQueued.Wait(&PoolLock);
+        if (Exiting)
+            break;
+
+        if (job)
+        {
+            PoolLock.Unlock();
+            executeJob(job, context);
+            PoolLock.DoLock();
+            endJob(job);
+            JobDone.NotifyAll();
+        }
+        else
+        {
+            seenGeneration = Generation;
+            PoolLock.Unlock();
+            processParallel();
+            PoolLock.DoLock();
+            if (--PendingWorkers == 0)
+                JobDone.NotifyAll();
+        }
+    }
+    PoolLock.Unlock();
+#else
+    SF_UNUSED(context);
+#endif
+}
+
+#ifdef SF_ENABLE_THREADS
+int WorkerPool::workerThreadFn(Thread*, void* h)
+{
+    ((WorkerPool*)h)->workerMain();
+    return 0;
+}
+#endif
+
+}}; // namespace Scaleform::Render
@@ -0,0 +1,102 @@
+/**************************************************************************
+
+Filename    :   Render_WorkerPool.h
+Content     :   Pool of worker threads shared by the renderer systems
+                that split their work between threads.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_WorkerPool_H
+#define INC_SF_Render_WorkerPool_H
+
+#include "Kernel/SF_Array.h"
+#include "Kernel/SF_Threads.h"
+#include "Render/Render_Stats.h"
+
+namespace Scaleform { namespace Render {
+
+// WorkerPool owns a set of worker threads and hands them work in one of
+// two ways, implemented by derived classes:
+//  - RunParallel calls processParallel on every worker and on the calling
+//    thread, and returns once all of them have returned. The work is
+//    typically split into pieces taken with an atomic counter.
+//  - Queued jobs: workers take jobs with beginJob, run them with executeJob
+//    and hand them back with endJob. The derived class keeps the jobs in
+//    its own lists, protected by PoolLock, and calls notifyJobQueued after
+//    adding one. JobDone is notified after every endJob.
+//
+// Worker threads run workerMain, which can be overridden to set up data
+// owned by the thread, such as a tessellator, before calling runWorker.
+//
+// The pool is used from one thread. Derived classes must call StopWorkers
+// in their destructor, since workers call their virtual functions.
+
+class WorkerPool
+{
+public:
+    enum { MaxWorkers = 15 };
+
+    WorkerPool(const char* threadName, UPInt stackSize = 128 * 1024);
+    virtual ~WorkerPool();
+
+    // Starts the worker threads unless they were already started;
+    // threadCount of 0 picks one fewer than the number of CPUs, leaving one
+    // to the calling thread. A single CPU gets no workers at all.
+    void            StartWorkers(unsigned threadCount = 0);
+    // Stops the worker threads, waiting for the running jobs to complete.
+    void            StopWorkers();
+
+    bool            AreWorkersStarted() const;
+    unsigned        GetWorkerCount() const;
+
+    // Calls processParallel on all workers and on the calling thread.
+    void            RunParallel();
+
+protected:
+    virtual void    processParallel() { }
+
+    // Called with PoolLock held; removes the next job from the queue and
+    // returns it, or returns 0 if there is none.
+    virtual void*   beginJob() { return 0; }
+    // Runs the job on a worker thread, without the lock; context is the
+    // value workerMain passed to runWorker.
+    virtual void    executeJob(void* job, void* context) { SF_UNUSED2(job, context); }
+    // Called with PoolLock held after the job has been executed.
+    virtual void    endJob(void* job) { SF_UNUSED(job); }
+
+    virtual void    workerMain() { runWorker(0); }
+    // Processes work until the workers are stopped.
+    void            runWorker(void* context);
+
+    // Wakes a worker to take a queued job; called with PoolLock held.
+    void            notifyJobQueued();
+
+#ifdef SF_ENABLE_THREADS
+    Mutex           PoolLock;
+    WaitCondition   JobDone;
+
+private:
+    static int      workerThreadFn(Thread* pthread, void* h);
+
+    const char*             ThreadName;
+    UPInt                   StackSize;
+    ArrayLH<Ptr<Thread> >   Workers;
+    WaitCondition           WorkQueued;
+    unsigned                Generation;
+    unsigned                PendingWorkers;
+    bool                    Started;
+    bool                    Exiting;
+#endif
+};
+
+}}; // namespace Scaleform::Render
+
+#endif
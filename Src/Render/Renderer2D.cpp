@@ -63,6 +63,15 @@ void Renderer2D::SetToleranceParams(const ToleranceParams& params)
     pImpl->SetToleranceParams(params);
 }
 
+MeshDiskCache* Renderer2D::GetMeshDiskCache() const
+{
+    return pImpl->GetMeshDiskCache();
+}
+void Renderer2D::SetMeshDiskCache(MeshDiskCache* cache)
+{
+    pImpl->SetMeshDiskCache(cache);
+}
+
 // Delegated interface.
 bool Renderer2D::BeginFrame()
 {
@@ -26,6 +26,7 @@ namespace Scaleform { namespace Render {
 
 class Renderer2DImpl;
 class GlyphCache;
+class MeshDiskCache;
 struct ToleranceParams;
 
 // Parameter to Display, specifying which pass to render.
@@ -66,6 +67,11 @@ public:
 
     const ToleranceParams&  GetToleranceParams() const;
     void                    SetToleranceParams(const ToleranceParams& params);
+
+    // Installs a cache of tessellated meshes that persists across runs;
+    // see MeshDiskCache. Pass 0 to remove it.
+    MeshDiskCache*          GetMeshDiskCache() const;
+    void                    SetMeshDiskCache(MeshDiskCache* cache);
         
     // Delegated interface.
     bool    BeginFrame();
@@ -55,6 +55,7 @@ Renderer2DImpl::Renderer2DImpl(HAL* hal)
 
 Renderer2DImpl::~Renderer2DImpl()
 {
+    TessPool.Shutdown();
     ReleaseAllContextData();
     pMeshKeyManager->DestroyAllKeys();
     pHal->RemoveNotify(this);
@@ -66,18 +67,38 @@ MeshCacheConfig* Renderer2DImpl::GetMeshCacheConfig() const
     return &pHal->GetMeshCache();
 }
 
+bool Renderer2DImpl::GetMeshData(MeshBase* mesh, VertexOutput* out)
+{
+    MeshDataRecord* record = TessPool.GetMeshRecord(mesh);
+    if (record)
+    {
+        if (pMeshDiskCache)
+            pMeshDiskCache->AddMesh(mesh, record, Tolerances);
+        record->Replay(out);
+        return true;
+    }
+    if (pMeshDiskCache && pMeshDiskCache->GetMeshData(mesh, out, Tolerances))
+        return true;
+    return mesh->GetProvider()->GetData(mesh, out, mesh->GetMeshGenFlags());
+}
+
 bool Renderer2DImpl::BeginFrame()
 {
     SF_AMP_SCOPE_RENDER_TIMER("Renderer2DImpl::BeginFrame", Amp_Profile_Level_Medium);
     pMeshKeyManager->ProcessKillList();
     if (pGlyphCache)
         pGlyphCache->OnBeginFrame();
-    return pHal->BeginFrame();
+    if (!pHal->BeginFrame())
+        return false;
+    if (pGlyphCache)
+        pGlyphCache->UpdateRasterizedGlyphs();
+    return true;
 }
 void Renderer2DImpl::EndFrame()
 {
     SF_AMP_SCOPE_RENDER_TIMER("Renderer2DImpl::EndFrame", Amp_Profile_Level_Medium);
     pHal->EndFrame();
+    TessPool.ReleaseJobs();
     EndFrameContextNotify();
     if (pGlyphCache)
         pGlyphCache->OnEndFrame();
@@ -387,6 +408,7 @@ void Renderer2DImpl::OnHALEvent(HALNotifyType type)
         break;
 
     case HAL_Shutdown:
+        TessPool.Shutdown();
         ReleaseAllContextData();
         pMeshKeyManager->DestroyAllKeys();
         pGlyphCache->Destroy();
@@ -25,6 +25,8 @@ otherwise accompanies this software in either electronic or hard copy form.
 #include "Render_HAL.h"
 #include "Render_TessGen.h"
 #include "Render_MeshKey.h"
+#include "Render_TessellationPool.h"
+#include "Render_MeshDiskCache.h"
 
 #include "Kernel/SF_HeapNew.h"
 
@@ -60,6 +62,8 @@ class Renderer2DImpl : public NewOverrideBase<StatRender_Mem>,
     Ptr<HAL>                pHal;
     MeshGenerator           MeshGen;
     StrokeGenerator         StrokeGen;
+    MeshTessellationPool    TessPool;
+    Ptr<MeshDiskCache>      pMeshDiskCache;
     ToleranceParams         Tolerances;
     PrimitiveFillManager    FillManager;
     MatrixPool              MPool;
@@ -79,10 +83,18 @@ public:
     MeshKeyManager*         GetMeshKeyManager() const { return pMeshKeyManager; }
     GlyphCache*             GetGlyphCache() const { return pGlyphCache; }
     StrokeGenerator*        GetStrokeGen()        { return &StrokeGen; }
+    MeshTessellationPool&   GetTessellationPool() { return TessPool; }
 
     const ToleranceParams&  GetToleranceParams() const { return Tolerances; }
     void                    SetToleranceParams(const ToleranceParams& params) { Tolerances=params; }
 
+    MeshDiskCache*          GetMeshDiskCache() const { return pMeshDiskCache; }
+    void                    SetMeshDiskCache(MeshDiskCache* cache) { pMeshDiskCache = cache; }
+
+    // Outputs the vertex data of a mesh, taking it from the tessellation pool or
+    // the disk cache if possible, and calling MeshProvider::GetData otherwise.
+    bool                    GetMeshData(MeshBase* mesh, VertexOutput* out);
+
     MeshCacheConfig*        GetMeshCacheConfig() const;
 
     // Call this function to make the glyph cache work.
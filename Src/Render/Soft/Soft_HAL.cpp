@@ -0,0 +1,1544 @@
+/**************************************************************************
+
+Filename    :   Soft_HAL.cpp
+Content     :   Software rasterizing Renderer HAL implementation.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Kernel/SF_Debug.h"
+#include "Kernel/SF_HeapNew.h"
+#include "Render/Render_BufferGeneric.h"
+#include "Render/Render_FiltersSW.h"
+#include "Render/Soft/Soft_HAL.h"
+
+#include <string.h> // memcpy, memset
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+
+//------------------------------------------------------------------------
+// ***** Vertex processing helpers
+
+// MeshTransform maps vertex positions to clip space, with the same matrices the
+// hardware HALs pass to the vertex shaders through SU_mvp.
+class MeshTransform
+{
+public:
+    MeshTransform(const Matrix2F& mvp) : Has3D(false), MVP2D(mvp)
+    { }
+
+    MeshTransform(const Matrix2F& vertexMatrix, const HMatrix& hm, const Render::MatrixState* matrices)
+        : Has3D(hm.Has3D())
+    {
+        if (Has3D)
+            MVP3D = Matrix4F(matrices->GetUVP(), Matrix3F(hm.GetMatrix3D(), vertexMatrix));
+        else
+            MVP2D = Matrix2F(vertexMatrix, hm.GetMatrix2D(), matrices->UserView);
+    }
+
+    // Transforms (x,y) to clip space. Returns false if the point is behind the
+    // viewer, in which case triangles using it are dropped; there is no near
+    // plane clipping.
+    bool Apply(float x, float y, float* cx, float* cy) const
+    {
+        if (!Has3D)
+        {
+            *cx = x;
+            *cy = y;
+            MVP2D.Transform(cx, cy);
+            return true;
+        }
+
+        float w = MVP3D.M[3][0] * x + MVP3D.M[3][1] * y + MVP3D.M[3][3];
+        if (w <= 1e-6f)
+            return false;
+        float invW = 1.0f / w;
+        *cx = (MVP3D.M[0][0] * x + MVP3D.M[0][1] * y + MVP3D.M[0][3]) * invW;
+        *cy = (MVP3D.M[1][0] * x + MVP3D.M[1][1] * y + MVP3D.M[1][3]) * invW;
+        return true;
+    }
+
+    bool        Has3D;
+    Matrix2F    MVP2D;
+    Matrix4F    MVP3D;
+};
+
+// VertexReader locates the elements of a vertex format that the rasterizer uses.
+struct VertexReader
+{
+    const VertexElement* pPos;
+    const VertexElement* pColor;
+    const VertexElement* pFactor;
+    const VertexElement* pWeight;
+    const VertexElement* pUV;
+    unsigned             Stride;
+
+    VertexReader(const VertexFormat* pformat)
+    {
+        const unsigned mask = VET_Usage_Mask|VET_Index_Mask;
+        Stride  = pformat->Size;
+        pPos    = pformat->GetElement(VET_Pos, VET_Usage_Mask);
+        pColor  = pformat->GetElement(VET_Color, mask);
+        pFactor = pformat->GetElement(VET_Color | (1 << VET_Index_Shift), mask);
+        pWeight = pformat->GetElement(VET_Color | (2 << VET_Index_Shift), mask);
+        pUV     = pformat->GetElement(VET_TexCoord, VET_Usage_Mask);
+
+        // Batch indices share the factor slot; they are not interpolated.
+        if (pFactor && (pFactor->Attribute & VET_CompType_Mask) != VET_U8N)
+            pFactor = 0;
+    }
+
+    void ReadPosition(const UByte* pv, float* x, float* y) const
+    {
+        if ((pPos->Attribute & VET_CompType_Mask) == VET_F32)
+        {
+            float p[2];
+            memcpy(p, pv + pPos->Offset, sizeof(p));
+            *x = p[0];
+            *y = p[1];
+        }
+        else
+        {
+            SInt16 p[2];
+            memcpy(p, pv + pPos->Offset, sizeof(p));
+            *x = (float)p[0];
+            *y = (float)p[1];
+        }
+    }
+
+    void ReadAttributes(const UByte* pv, float* attr) const
+    {
+        const float s = 1.0f / 255.0f;
+        if (pColor)
+        {
+            const UByte* pc = pv + pColor->Offset;
+            if ((pColor->Attribute & VET_CompType_Mask) == VET_U32)
+            {
+                UInt32 c;
+                memcpy(&c, pc, sizeof(c));
+                attr[RasterAttr_Color + 0] = ((c >> 16) & 0xFF) * s;
+                attr[RasterAttr_Color + 1] = ((c >> 8)  & 0xFF) * s;
+                attr[RasterAttr_Color + 2] = ( c        & 0xFF) * s;
+                attr[RasterAttr_Color + 3] = ((c >> 24) & 0xFF) * s;
+            }
+            else
+            {
+                for (unsigned i = 0; i < 4; ++i)
+                    attr[RasterAttr_Color + i] = pc[i] * s;
+            }
+        }
+        if (pFactor)
+            attr[RasterAttr_Factor] = pv[pFactor->Offset] * s;
+        if (pWeight)
+            attr[RasterAttr_Weight] = pv[pWeight->Offset] * s;
+    }
+
+    void ReadUV(const UByte* pv, float* uv) const
+    {
+        memcpy(uv, pv + pUV->Offset, sizeof(float) * 2);
+    }
+};
+
+static void setSampler(RasterSampler* psampler, Texture* ptexture, const ImageFillMode& fm)
+{
+    *psampler = RasterSampler();
+    if (!ptexture || !ptexture->pTextures)
+        return;
+
+    const Texture::HWTextureDesc& tdesc = ptexture->pTextures[0];
+    psampler->pData         = tdesc.pTexData;
+    psampler->Pitch         = tdesc.Pitch;
+    psampler->Width         = (int)tdesc.Size.Width;
+    psampler->Height        = (int)tdesc.Size.Height;
+    psampler->BytesPerPixel = ptexture->GetBytesPerPixel();
+    psampler->Clamp         = (fm.GetWrapMode() == Wrap_Clamp);
+    psampler->Linear        = (fm.GetSampleMode() == Sample_Linear);
+}
+
+// Returns the plane of a render target covering its rectangle.
+static bool getTargetPlane(RenderTarget* prt, ImagePlane* pplane)
+{
+    RenderTargetData* phd = (RenderTargetData*)prt->GetRenderTargetData();
+    Texture* ptexture = phd ? phd->GetColorTexture() : 0;
+    if (!ptexture || !ptexture->pTextures || !ptexture->pTextures[0].pTexData)
+        return false;
+
+    const Rect<int>& rect = prt->GetRect();
+    ptexture->GetPlane(pplane);
+    pplane->pData   += rect.y1 * pplane->Pitch + rect.x1 * ptexture->GetBytesPerPixel();
+    pplane->Width    = (unsigned)rect.Width();
+    pplane->Height   = (unsigned)rect.Height();
+    pplane->DataSize = pplane->Pitch * pplane->Height;
+    return true;
+}
+
+
+//------------------------------------------------------------------------
+// ***** HAL
+
+HAL::HAL(ThreadCommandQueue* commandQueue)
+:   Render::HAL(commandQueue),
+    Cache(Memory::GetGlobalHeap(), MeshCacheParams::PC_Defaults, &RSync),
+    FramebufferSize(0, 0)
+{
+    ClipScale[0]  = ClipScale[1]  = 0.0f;
+    ClipOffset[0] = ClipOffset[1] = 0.0f;
+    ScreenQuad.TextureCount = 0;
+}
+
+HAL::~HAL()
+{
+    ShutdownHAL();
+}
+
+bool HAL::InitHAL(const Soft::HALInitParams& params)
+{
+    if ( !Render::HAL::initHAL(params))
+        return false;
+
+    FramebufferSize = params.FramebufferSize;
+
+    pTextureManager = params.GetTextureManager();
+    if (!pTextureManager)
+    {
+        pTextureManager =
+            *SF_HEAP_AUTO_NEW(this) TextureManager(params.RenderThreadId, pRTCommandQueue);
+    }
+    // Textures must not change while queued triangles still sample them.
+    pTextureManager->SetRasterQueue(&Raster);
+
+    // Allocate our matrix state
+    Matrices = *SF_HEAP_AUTO_NEW(this) MatrixState(this);
+
+    Raster.Initialize(params.RasterThreads);
+
+    pRenderBufferManager = params.pRenderBufferManager;
+    if (!pRenderBufferManager)
+    {
+        pRenderBufferManager = *SF_HEAP_AUTO_NEW(this) RenderBufferManagerGeneric();
+        if ( !pRenderBufferManager || !createDefaultRenderBuffer())
+        {
+            ShutdownHAL();
+            return false;
+        }
+    }
+
+    if (!Cache.Initialize())
+        return false;
+
+    HALState|= HS_ModeSet;
+    notifyHandlers(HAL_Initialize);
+    return true;
+}
+
+// Returns back to original mode (cleanup)
+bool HAL::ShutdownHAL()
+{
+    if (!(HALState & HS_ModeSet))
+        return true;
+
+    if (!shutdownHAL())
+        return false;
+
+    // Rasterize anything still queued, and stop using the target memory.
+    Raster.Flush();
+    Raster.SetTarget(RasterTarget());
+    Raster.Shutdown();
+
+    destroyRenderBuffers();
+    pRenderBufferManager.Clear();
+    pTextureManager->SetRasterQueue(0);
+    pTextureManager->ProcessQueues();
+    pTextureManager.Clear();
+    Cache.Reset();
+    return true;
+}
+
+
+// ***** Rendering
+
+bool HAL::BeginScene()
+{
+    if ( !Render::HAL::BeginScene())
+        return false;
+
+    DrawState.ColorWrite    = true;
+    DrawState.StencilEnable = false;
+
+    if (RenderTargetStack.GetSize() > 0)
+        setRasterTarget(RenderTargetStack.Back().pRenderTarget);
+    return true;
+}
+
+bool HAL::EndScene()
+{
+    if ( !Render::HAL::EndScene())
+        return false;
+
+    // The frame must be complete in the target memory once the scene ends.
+    Raster.Flush();
+    return true;
+}
+
+void HAL::Flush()
+{
+    Render::HAL::Flush();
+    Raster.Flush();
+}
+
+void HAL::beginDisplay(BeginDisplayData* data)
+{
+    DrawState.StencilEnable = false;
+
+    Render::HAL::beginDisplay(data);
+}
+
+// Updates the raster clip rectangle and ViewportMatrix based on provided viewport
+// and view rectangle.
+void HAL::updateViewport()
+{
+    Rect<int> clip(0, 0, 0, 0);
+
+    if (HALState & HS_ViewValid)
+    {
+        int dx = ViewRect.x1 - VP.Left,
+            dy = ViewRect.y1 - VP.Top;
+
+        // All targets are stored top-down, so they all use the render texture mapping.
+        CalcHWViewMatrix(VP.Flags | Viewport::View_IsRenderTexture, &Matrices->View2D, ViewRect, dx, dy);
+        Matrices->SetUserMatrix(Matrices->User);
+        Matrices->ViewRect    = ViewRect;
+        Matrices->UVPOChanged = 1;
+
+        Rect<int> viewport;
+        if ( HALState & HS_InRenderTarget )
+        {
+            viewport = Rect<int>(VP.Left, VP.Top, VP.Left + VP.Width, VP.Top + VP.Height);
+            clip     = viewport;
+        }
+        else
+        {
+            viewport = ViewRect;
+            clip     = viewport;
+            if (VP.Flags & Viewport::View_UseScissorRect)
+            {
+                Rect<int> scissor(VP.ScissorLeft, VP.ScissorTop,
+                                  VP.ScissorLeft + VP.ScissorWidth, VP.ScissorTop + VP.ScissorHeight);
+                if (!clip.IntersectRect(&clip, scissor))
+                    clip.Clear();
+            }
+        }
+
+        ClipScale[0]  = viewport.Width()  * 0.5f;
+        ClipScale[1]  = viewport.Height() * 0.5f;
+        ClipOffset[0] = viewport.x1 + ClipScale[0];
+        ClipOffset[1] = viewport.y1 + ClipScale[1];
+
+        const RasterTarget& target = Raster.GetTarget();
+        if (!clip.IntersectRect(&clip, Rect<int>(0, 0, target.Width, target.Height)))
+            clip.Clear();
+    }
+
+    DrawState.Clip = clip;
+}
+
+void   HAL::MapVertexFormat(PrimitiveFillType, const VertexFormat* sourceFormat,
+                            const VertexFormat** single,
+                            const VertexFormat** batch, const VertexFormat** instanced, unsigned)
+{
+    // Vertices are read on the CPU in their source format, and every mesh is
+    // drawn on its own; batching would only add copies.
+    *single    = sourceFormat;
+    *batch     = 0;
+    *instanced = 0;
+}
+
+// Draws a range of pre-cached and preprocessed primitives
+void        HAL::DrawProcessedPrimitive(Primitive* pprimitive,
+                                        PrimitiveBatch* pstart, PrimitiveBatch *pend)
+{
+    SF_AMP_SCOPE_RENDER_TIMER("HAL::DrawProcessedPrimitive", Amp_Profile_Level_High);
+    if (!checkState(HS_InDisplay, __FUNCTION__) ||
+        !pprimitive->GetMeshCount() )
+        return;
+
+    // If in overdraw profile mode, and this primitive is part of a mask, draw it in color mode.
+    static bool drawingMask = false;
+    if ( !Profiler.ShouldDrawMask() && !drawingMask && (HALState & HS_DrawingMask) )
+    {
+        drawingMask = true;
+        DrawState.ColorWrite    = true;
+        DrawState.StencilEnable = false;
+        DrawProcessedPrimitive(pprimitive, pstart, pend );
+        DrawState.ColorWrite    = false;
+        DrawState.StencilEnable = true;
+        drawingMask = false;
+    }
+
+    SF_ASSERT(pend != 0);
+
+    PrimitiveBatch* pbatch = pstart ? pstart : pprimitive->Batches.GetFirst();
+
+    unsigned bidx = 0;
+    while (pbatch != pend)
+    {
+        // pBatchMesh can be null in case of error, such as VB/IB lock failure.
+        MeshCacheItem* pmesh = (MeshCacheItem*)pbatch->GetCacheItem();
+        unsigned       meshIndex = pbatch->GetMeshIndex();
+
+        if (pmesh)
+        {
+            Profiler.SetBatch((UPInt)pprimitive, bidx);
+
+            // MapVertexFormat never provides batch or instanced formats.
+            SF_ASSERT(pbatch->Type == PrimitiveBatch::DP_Single);
+
+            const Primitive::MeshEntry& mesh = pprimitive->Meshes[meshIndex];
+            PrimitiveFill* pfill = pprimitive->pFill;
+
+            unsigned fillFlags = FillFlags;
+            fillFlags |= mesh.M.Has3D() ? FF_3DProjection : 0;
+            if (pfill->RequiresBlend())
+                fillFlags |= FF_Blending;
+
+            Cxform cx = Profiler.GetCxform(mesh.M.GetCxform());
+            if (cx != Cxform::Identity)
+            {
+                fillFlags |= FF_Cxform;
+                if (cx.RequiresBlend())
+                    fillFlags |= FF_Blending;
+            }
+
+            if (HALState & HS_ViewValid)
+            {
+                RasterState state(DrawState);
+                Texture*    textures[2];
+                unsigned    textureCount = setRasterFill(&state, pfill->GetType(), fillFlags, pfill, textures);
+                if (state.Flags & RasterFlag_Cxform)
+                    setRasterCxform(&state, cx);
+                state.BlendEnable = (fillFlags & FF_Blending) != 0;
+                Raster.SetState(state, textures, textureCount);
+                Profiler.SetFillFlags(fillFlags);
+
+                Matrix2F texgen[2];
+                for (unsigned tm = 0; tm < textureCount; tm++)
+                {
+                    texgen[tm] = mesh.pMesh->VertexMatrix;
+                    texgen[tm].Append(mesh.M.GetTextureMatrix(tm));
+                }
+
+                const UByte* pbuffer = (const UByte*)pmesh->GetBuffer()->pData;
+                drawMesh(MeshTransform(mesh.pMesh->VertexMatrix, mesh.M, Matrices), pbatch->pFormat,
+                         pbuffer + pmesh->GetVertexOffset(), pmesh->VertexCount,
+                         (const UInt16*)(pbuffer + pmesh->GetIndexOffset()), pmesh->IndexCount,
+                         texgen, textureCount);
+            }
+
+            pmesh->MoveToCacheListFront(MCL_ThisFrame);
+        }
+
+        pbatch = pbatch->GetNext();
+        bidx++;
+    }
+}
+
+
+void HAL::DrawProcessedComplexMeshes(ComplexMesh* complexMesh,
+                                     const StrideArray<HMatrix>& matrices)
+{
+    typedef ComplexMesh::FillRecord   FillRecord;
+
+    MeshCacheItem* pmesh = (MeshCacheItem*)complexMesh->GetCacheItem();
+    if (!checkState(HS_InDisplay, __FUNCTION__) || !pmesh)
+        return;
+
+    // If in overdraw profile mode, and this primitive is part of a mask, draw it in color mode.
+    static bool drawingMask = false;
+    if ( !Profiler.ShouldDrawMask() && !drawingMask && (HALState & HS_DrawingMask) )
+    {
+        drawingMask = true;
+        DrawState.ColorWrite    = true;
+        DrawState.StencilEnable = false;
+        DrawProcessedComplexMeshes(complexMesh, matrices);
+        DrawState.ColorWrite    = false;
+        DrawState.StencilEnable = true;
+        drawingMask = false;
+    }
+
+    const FillRecord* fillRecords = complexMesh->GetFillRecords();
+    unsigned    fillCount     = complexMesh->GetFillRecordCount();
+    unsigned    instanceCount = (unsigned)matrices.GetSize();
+    const Matrix2F& vertexMatrix = complexMesh->GetVertexMatrix();
+    const Matrix2F* textureMatrices = complexMesh->GetFillMatrixCache();
+    const UByte*    pbuffer = (const UByte*)pmesh->GetBuffer()->pData;
+
+    for (unsigned fillIndex = 0; fillIndex < fillCount; fillIndex++)
+    {
+        const FillRecord& fr = fillRecords[fillIndex];
+
+        Profiler.SetBatch((UPInt)complexMesh, fillIndex);
+
+        unsigned fillFlags = FillFlags;
+        if ( instanceCount > 0 )
+        {
+            const HMatrix& hm = matrices[0];
+            fillFlags |= hm.Has3D() ? FF_3DProjection : 0;
+
+            for (unsigned i = 0; i < instanceCount; i++)
+            {
+                const HMatrix& hm = matrices[i];
+                Cxform finalCx = Profiler.GetCxform(hm.GetCxform());
+                if (!(finalCx == Cxform::Identity))
+                    fillFlags |= FF_Cxform;
+                if (finalCx.RequiresBlend())
+                    fillFlags |= FF_Blending;
+            }
+        }
+        if (fr.pFill->RequiresBlend())
+            fillFlags |= FF_Blending;
+
+        // Apply fill.
+        PrimitiveFillType fillType = Profiler.GetFillType(fr.pFill->GetType());
+        RasterState state(DrawState);
+        Texture*    textures[2];
+        unsigned    textureCount = setRasterFill(&state, fillType, fillFlags, fr.pFill, textures);
+        state.BlendEnable = (fillFlags & FF_Blending) != 0;
+
+        Profiler.SetFillFlags(fillFlags);
+
+        const UByte*  pvertices = pbuffer + pmesh->GetVertexOffset() + fr.VertexByteOffset;
+        const UInt16* pindices  = (const UInt16*)(pbuffer + pmesh->GetIndexOffset()) + fr.IndexOffset;
+
+        Matrix2F texgen[2];
+        for (unsigned tm = 0; tm < textureCount; tm++)
+            texgen[tm] = textureMatrices[fr.FillMatrixIndex[tm]];
+
+        for (unsigned i = 0; i < instanceCount; i++)
+        {
+            const HMatrix& hm = matrices[i];
+
+            if (state.Flags & RasterFlag_Cxform)
+                setRasterCxform(&state, Profiler.GetCxform(hm.GetCxform()));
+            Raster.SetState(state, textures, textureCount);
+
+            if (HALState & HS_ViewValid)
+            {
+                drawMesh(MeshTransform(vertexMatrix, hm, Matrices), fr.pFormats[0],
+                         pvertices, fr.VertexCount, pindices, fr.IndexCount,
+                         texgen, textureCount);
+            }
+        }
+    } // for (fill record)
+
+    pmesh->MoveToCacheListFront(MCL_ThisFrame);
+}
+
+
+unsigned HAL::setRasterFill(RasterState* pstate, PrimitiveFillType fillType, unsigned fillFlags,
+                            PrimitiveFill* pfill, Texture** ptextures)
+{
+    unsigned flags = 0;
+    unsigned textureCount = 0;
+
+    switch(fillType)
+    {
+    case PrimFill_Mask:
+        pstate->Fill = RasterFill_Solid;
+        Color(128, 0, 0, 128).GetRGBAFloat(pstate->SolidColor);
+        break;
+
+    case PrimFill_VColor_EAlpha:
+        flags |= RasterFlag_EAlpha;
+        // Fall through.
+    case PrimFill_VColor:
+        pstate->Fill = RasterFill_VColor;
+        break;
+
+    case PrimFill_Texture_EAlpha:
+        flags |= RasterFlag_EAlpha;
+        // Fall through.
+    case PrimFill_Texture:
+    case PrimFill_UVTexture:
+        pstate->Fill = RasterFill_Texture;
+        textureCount = 1;
+        break;
+
+    case PrimFill_Texture_VColor_EAlpha:
+        flags |= RasterFlag_EAlpha;
+        // Fall through.
+    case PrimFill_Texture_VColor:
+        pstate->Fill = RasterFill_TextureVColor;
+        textureCount = 1;
+        break;
+
+    case PrimFill_2Texture_EAlpha:
+        flags |= RasterFlag_EAlpha;
+        // Fall through.
+    case PrimFill_2Texture:
+        pstate->Fill = RasterFill_2Texture;
+        textureCount = 2;
+        break;
+
+    case PrimFill_UVTextureAlpha_VColor:
+        pstate->Fill = RasterFill_TextureAlphaVColor;
+        textureCount = 1;
+        break;
+
+    case PrimFill_UVTextureDFAlpha_VColor:
+        pstate->Fill = RasterFill_TextureDFAlphaVColor;
+        textureCount = 1;
+        break;
+
+    default:
+        pstate->Fill = RasterFill_Solid;
+        Profiler.GetColor(pfill->GetSolidColor()).GetRGBAFloat(pstate->SolidColor);
+        break;
+    }
+
+    if (pstate->Fill != RasterFill_Solid && (fillFlags & FF_Cxform))
+    {
+        flags |= RasterFlag_Cxform;
+        if (fillFlags & FF_AlphaWrite)
+            flags |= RasterFlag_CxformAc;
+    }
+    if (fillFlags & FF_Multiply)
+        flags |= RasterFlag_Multiply;
+    else if (fillFlags & FF_Invert)
+        flags |= RasterFlag_Invert;
+    pstate->Flags = flags;
+
+    textureCount = Alg::Min<unsigned>(textureCount, pfill->GetTextureCount());
+    for (unsigned i = 0; i < textureCount; i++)
+    {
+        ptextures[i] = (Texture*)pfill->GetTexture(i);
+        setSampler(&pstate->Samplers[i], ptextures[i], pfill->GetFillMode(i));
+    }
+    return textureCount;
+}
+
+void HAL::setRasterCxform(RasterState* pstate, const Cxform& cx)
+{
+    for (unsigned i = 0; i < 4; i++)
+    {
+        pstate->CxMul[i] = cx.M[0][i];
+        pstate->CxAdd[i] = cx.M[1][i];
+    }
+}
+
+void HAL::drawMesh(const MeshTransform& transform, const VertexFormat* pformat,
+                   const UByte* pvertices, unsigned vertexCount,
+                   const UInt16* pindices, unsigned indexCount,
+                   const Matrix2F* texgen, unsigned texgenCount)
+{
+    VertexReader reader(pformat);
+    if (!reader.pPos || !vertexCount)
+        return;
+
+    // UV filled meshes carry their own texture coordinates.
+    bool vertexUV = (reader.pUV != 0) && (texgenCount == 0);
+
+    TransformedVertices.Resize(vertexCount);
+    VertexVisible.Resize(vertexCount);
+
+    for (unsigned i = 0; i < vertexCount; i++)
+    {
+        const UByte*  pv = pvertices + i * reader.Stride;
+        RasterVertex& v  = TransformedVertices[i];
+        float x, y, cx = 0.0f, cy = 0.0f;
+
+        reader.ReadPosition(pv, &x, &y);
+        VertexVisible[i] = transform.Apply(x, y, &cx, &cy);
+        v.X = cx * ClipScale[0] + ClipOffset[0];
+        v.Y = cy * ClipScale[1] + ClipOffset[1];
+
+        memset(v.A, 0, sizeof(v.A));
+        for (unsigned tm = 0; tm < texgenCount; tm++)
+        {
+            float u = x, t = y;
+            texgen[tm].Transform(&u, &t);
+            v.A[RasterAttr_UV0 + tm * 2]     = u;
+            v.A[RasterAttr_UV0 + tm * 2 + 1] = t;
+        }
+        if (vertexUV)
+            reader.ReadUV(pv, &v.A[RasterAttr_UV0]);
+        reader.ReadAttributes(pv, v.A);
+    }
+
+    TriangleVertices.Clear();
+    for (unsigned i = 0; i + 2 < indexCount; i += 3)
+    {
+        unsigned i0 = pindices[i], i1 = pindices[i + 1], i2 = pindices[i + 2];
+        if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+            continue;
+        if (!VertexVisible[i0] || !VertexVisible[i1] || !VertexVisible[i2])
+            continue;
+        TriangleVertices.PushBack(TransformedVertices[i0]);
+        TriangleVertices.PushBack(TransformedVertices[i1]);
+        TriangleVertices.PushBack(TransformedVertices[i2]);
+    }
+    Raster.AddTriangles(TriangleVertices.GetDataPtr(), (unsigned)TriangleVertices.GetSize() / 3);
+
+#if !defined(SF_BUILD_SHIPPING)
+    AccumulatedStats.Meshes++;
+    AccumulatedStats.Triangles += indexCount / 3;
+    AccumulatedStats.Primitives++;
+#endif
+}
+
+void HAL::drawQuad(const MeshTransform& transform, const Matrix2F* texgen, unsigned texgenCount)
+{
+    static const float corners[6][2] =
+    {
+        { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f },
+        { 0.0f, 1.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }
+    };
+
+    RasterVertex vertices[6];
+    for (unsigned i = 0; i < 6; i++)
+    {
+        RasterVertex& v = vertices[i];
+        float cx = 0.0f, cy = 0.0f;
+        if (!transform.Apply(corners[i][0], corners[i][1], &cx, &cy))
+            return;
+        v.X = cx * ClipScale[0] + ClipOffset[0];
+        v.Y = cy * ClipScale[1] + ClipOffset[1];
+
+        memset(v.A, 0, sizeof(v.A));
+        for (unsigned tm = 0; tm < texgenCount; tm++)
+        {
+            float u = corners[i][0], t = corners[i][1];
+            texgen[tm].Transform(&u, &t);
+            v.A[RasterAttr_UV0 + tm * 2]     = u;
+            v.A[RasterAttr_UV0 + tm * 2 + 1] = t;
+        }
+    }
+    Raster.AddTriangles(vertices, 2);
+
+#if !defined(SF_BUILD_SHIPPING)
+    AccumulatedStats.Meshes++;
+    AccumulatedStats.Triangles += 2;
+    AccumulatedStats.Primitives++;
+#endif
+}
+
+void HAL::drawSolidQuad(const Matrix2F& mvp, Color color, bool blend)
+{
+    RasterState state(DrawState);
+    state.Fill        = RasterFill_Solid;
+    state.Flags       = 0;
+    state.BlendEnable = blend;
+    color.GetRGBAFloat(state.SolidColor);
+    Raster.SetState(state);
+    drawQuad(MeshTransform(mvp), 0, 0);
+}
+
+
+//--------------------------------------------------------------------
+// Background clear helper, expects viewport coordinates.
+void HAL::clearSolidRectangle(const Rect<int>& r, Color color)
+{
+    color = Profiler.GetClearColor(color);
+
+    if (color.GetAlpha() == 0xFF)
+    {
+        PointF tl((float)(VP.Left + r.x1), (float)(VP.Top + r.y1));
+        PointF br((float)(VP.Left + r.x2), (float)(VP.Top + r.y2));
+        tl = Matrices->Orient2D * tl;
+        br = Matrices->Orient2D * br;
+        Rect<int> clearRect((int)Alg::Min(tl.x, br.x), (int)Alg::Min(tl.y,br.y), (int)Alg::Max(tl.x,br.x), (int)Alg::Max(tl.y,br.y));
+
+        const RasterTarget& target = Raster.GetTarget();
+        if (clearRect.IntersectRect(&clearRect, Rect<int>(0, 0, target.Width, target.Height)))
+        {
+            float colorf[4];
+            color.GetRGBAFloat(colorf);
+            colorf[3] = 1.0f;
+            Raster.ClearColor(clearRect, colorf);
+        }
+    }
+    else
+    {
+        Matrix2F m((float)r.Width(), 0.0f, (float)r.x1,
+                   0.0f, (float)r.Height(), (float)r.y1);
+        drawSolidQuad(Matrix2F(m, Matrices->UserView), color, (FillFlags & FF_Blending) != 0);
+    }
+}
+
+//--------------------------------------------------------------------
+// *** Mask / Stencil support
+//--------------------------------------------------------------------
+
+// Masks follow the hardware HAL implementation (see GL::HAL), with the stencil
+// plane of the target holding the mask nesting level.
+
+void HAL::PushMask_BeginSubmit(MaskPrimitive* prim)
+{
+    if (!checkState(HS_InDisplay, __FUNCTION__))
+        return;
+
+    Profiler.SetDrawMode(1);
+
+    DrawState.ColorWrite    = false;            // disable framebuffer writes
+    DrawState.StencilEnable = true;
+
+    bool viewportValid = (HALState & HS_ViewValid) != 0;
+
+    // Erase previous mask if it existed above our current stack top.
+    if (MaskStackTop && (MaskStack.GetSize() > MaskStackTop) && viewportValid)
+    {
+        DrawState.StencilFunc = RasterStencil_LEqual;
+        DrawState.StencilRef  = (UByte)MaskStackTop;
+        DrawState.StencilOp   = RasterStencil_Replace;
+
+        MaskPrimitive* erasePrim = MaskStack[MaskStackTop].pPrimitive;
+        drawMaskClearRectangles(erasePrim->GetMaskAreaMatrices(), erasePrim->GetMaskCount());
+    }
+
+    MaskStack.Resize(MaskStackTop+1);
+    MaskStackEntry &e = MaskStack[MaskStackTop];
+    e.pPrimitive       = prim;
+    e.OldViewportValid = viewportValid;
+    e.OldViewRect      = ViewRect;
+    MaskStackTop++;
+
+    HALState |= HS_DrawingMask;
+
+    if (prim->IsClipped() && viewportValid)
+    {
+        Rect<int> boundClip;
+
+        // Apply new viewport clipping.
+        if (!Matrices->OrientationSet)
+        {
+            const Matrix2F& m = prim->GetMaskAreaMatrix(0).GetMatrix2D();
+
+            // Clipped matrices are always in View coordinate space, to allow
+            // matrix to be use for erase operation above. This means that we don't
+            // have to do an EncloseTransform.
+            SF_ASSERT((m.Shx() == 0.0f) && (m.Shy() == 0.0f));
+            boundClip = Rect<int>(VP.Left + (int)m.Tx(), VP.Top + (int)m.Ty(),
+                                  VP.Left + (int)(m.Tx() + m.Sx()), VP.Top + (int)(m.Ty() + m.Sy()));
+        }
+        else
+        {
+            Matrix2F m = prim->GetMaskAreaMatrix(0).GetMatrix2D();
+            m.Append(Matrices->Orient2D);
+
+            RectF rect = m.EncloseTransform(RectF(0,0,1,1));
+            boundClip = Rect<int>(VP.Left + (int)rect.x1, VP.Top + (int)rect.y1,
+                                  VP.Left + (int)rect.x2, VP.Top + (int)rect.y2);
+        }
+
+        if (!ViewRect.IntersectRect(&ViewRect, boundClip))
+        {
+            ViewRect.Clear();
+            HALState &= ~HS_ViewValid;
+            viewportValid = false;
+        }
+        updateViewport();
+
+        // Clear full viewport area, which has been resized to our smaller bounds.
+        if ((MaskStackTop == 1) && viewportValid)
+            Raster.ClearStencil(DrawState.Clip, 0);
+    }
+    else
+        if ((MaskStackTop == 1) && viewportValid)
+    {
+        DrawState.StencilFunc = RasterStencil_Always;
+        DrawState.StencilRef  = 0;
+        DrawState.StencilOp   = RasterStencil_Replace;
+
+        drawMaskClearRectangles(prim->GetMaskAreaMatrices(), prim->GetMaskCount());
+    }
+
+    DrawState.StencilFunc = RasterStencil_Equal;
+    DrawState.StencilRef  = (UByte)(MaskStackTop-1);
+    DrawState.StencilOp   = RasterStencil_Incr;
+    ++AccumulatedStats.Masks;
+}
+
+
+void HAL::EndMaskSubmit()
+{
+    Profiler.SetDrawMode(0);
+
+    if (!checkState(HS_InDisplay|HS_DrawingMask, __FUNCTION__))
+        return;
+
+    HALState &= ~HS_DrawingMask;
+    SF_ASSERT(MaskStackTop);
+
+    DrawState.ColorWrite  = true;
+    DrawState.StencilFunc = RasterStencil_LEqual;
+    DrawState.StencilRef  = (UByte)MaskStackTop;
+    DrawState.StencilOp   = RasterStencil_Keep;
+}
+
+
+void HAL::PopMask()
+{
+    if (!checkState(HS_InDisplay, __FUNCTION__))
+        return;
+
+    SF_ASSERT(MaskStackTop);
+    MaskStackTop--;
+
+    if (MaskStack[MaskStackTop].pPrimitive->IsClipped())
+    {
+        // Restore viewport
+        ViewRect      = MaskStack[MaskStackTop].OldViewRect;
+
+        if (MaskStack[MaskStackTop].OldViewportValid)
+            HALState |= HS_ViewValid;
+        else
+            HALState &= ~HS_ViewValid;
+        updateViewport();
+    }
+
+    if (MaskStackTop == 0)
+        DrawState.StencilEnable = false;
+    else
+    {
+        DrawState.StencilFunc = RasterStencil_LEqual;
+        DrawState.StencilRef  = (UByte)MaskStackTop;
+    }
+}
+
+void HAL::drawMaskClearRectangles(const HMatrix* matrices, UPInt count)
+{
+    // Color writes are disabled, so the solid color does not matter.
+    RasterState state(DrawState);
+    state.Fill        = RasterFill_Solid;
+    state.Flags       = 0;
+    state.BlendEnable = false;
+    Raster.SetState(state);
+
+    for (UPInt i = 0; i < count; i++)
+        drawQuad(MeshTransform(Matrix2F::Identity, matrices[i], Matrices), 0, 0);
+}
+
+//--------------------------------------------------------------------
+// *** BlendMode Stack support
+//--------------------------------------------------------------------
+
+void HAL::applyBlendModeImpl(BlendMode mode, bool sourceAc, bool forceAc)
+{
+    static const RasterBlendOp BlendOps[BlendOp_Count] =
+    {
+        RasterBlend_Add,            // BlendOp_ADD
+        RasterBlend_Max,            // BlendOp_MAX
+        RasterBlend_Min,            // BlendOp_MIN
+        RasterBlend_RevSubtract,    // BlendOp_REVSUBTRACT
+    };
+
+    static const RasterBlendFactor BlendFactors[BlendFactor_Count] =
+    {
+        RasterFactor_Zero,          // BlendFactor_ZERO
+        RasterFactor_One,           // BlendFactor_ONE
+        RasterFactor_SrcAlpha,      // BlendFactor_SRCALPHA
+        RasterFactor_InvSrcAlpha,   // BlendFactor_INVSRCALPHA
+        RasterFactor_DestColor,     // BlendFactor_DESTCOLOR
+        RasterFactor_InvDestColor,  // BlendFactor_INVDESTCOLOR
+    };
+
+    RasterBlendFactor sourceColor = BlendFactors[BlendModeTable[mode].SourceColor];
+    if ( sourceAc && sourceColor == RasterFactor_SrcAlpha )
+        sourceColor = RasterFactor_One;
+
+    DrawState.SrcColor  = sourceColor;
+    DrawState.DestColor = BlendFactors[BlendModeTable[mode].DestColor];
+    if (VP.Flags & Viewport::View_AlphaComposite || forceAc)
+    {
+        DrawState.SrcAlpha  = BlendFactors[BlendModeTable[mode].SourceAlpha];
+        DrawState.DestAlpha = BlendFactors[BlendModeTable[mode].DestAlpha];
+    }
+    else
+    {
+        DrawState.SrcAlpha  = DrawState.SrcColor;
+        DrawState.DestAlpha = DrawState.DestColor;
+    }
+    DrawState.BlendOp = BlendOps[BlendModeTable[mode].Operator];
+}
+
+//--------------------------------------------------------------------
+// *** Render targets
+//--------------------------------------------------------------------
+
+RenderTarget* HAL::CreateRenderTarget(Render::Texture* texture, bool needsStencil)
+{
+    Soft::Texture* pt = (Soft::Texture*)texture;
+
+    // Cannot render to textures which have multiple planes.
+    if ( !pt || pt->TextureCount != 1 )
+        return 0;
+
+    RenderTarget* prt = pRenderBufferManager->CreateRenderTarget(
+        texture->GetSize(), RBuffer_Texture, texture->GetFormat(), texture);
+    if ( !prt )
+        return 0;
+
+    Ptr<DepthStencilBuffer> pdsb;
+    if ( needsStencil )
+        pdsb = *pRenderBufferManager->CreateDepthStencilBuffer(texture->GetSize());
+
+    RenderTargetData::UpdateData(prt, this, 0, 0, pdsb);
+    return prt;
+}
+
+RenderTarget* HAL::CreateTempRenderTarget(const ImageSize& size, bool needsStencil)
+{
+    RenderTarget* prt = pRenderBufferManager->CreateTempRenderTarget(size);
+    if ( !prt )
+        return 0;
+    Texture* pt = (Texture*)prt->GetTexture();
+    if ( !pt )
+        return 0;
+
+    RenderTargetData* phd = (RenderTargetData*)prt->GetRenderTargetData();
+    if ( phd && (!needsStencil || phd->pDepthStencilBuffer != 0 ))
+        return prt;
+
+    Ptr<DepthStencilBuffer> pdsb = 0;
+    if ( needsStencil )
+        pdsb = *pRenderBufferManager->CreateDepthStencilBuffer(size);
+
+    RenderTargetData::UpdateData(prt, this, 0, 0, pdsb);
+    return prt;
+}
+
+bool HAL::SetRenderTarget(RenderTarget* ptarget, bool setState)
+{
+    // When changing the render target while in a scene, we must flush all drawing.
+    if ( HALState & HS_InScene)
+        Flush();
+
+    // Cannot set the bottom level render target if already in display.
+    if ( HALState & HS_InDisplay )
+        return false;
+
+    RenderTargetEntry entry;
+    if ( setState )
+        setRasterTarget(ptarget);
+
+    entry.pRenderTarget = ptarget;
+
+    // Replace the stack entry at the bottom, or if the stack is empty, add one.
+    if ( RenderTargetStack.GetSize() > 0 )
+        RenderTargetStack[0] = entry;
+    else
+        RenderTargetStack.PushBack(entry);
+    return true;
+}
+
+void HAL::PushRenderTarget(const RectF& frameRect, RenderTarget* prt, unsigned flags)
+{
+    // Setup the render target/depth stencil on the device.
+    HALState |= HS_InRenderTarget;
+    RenderTargetEntry entry;
+    entry.pRenderTarget = prt;
+    entry.OldViewport = VP;
+    entry.OldViewRect = ViewRect;
+    entry.OldMatrixState.CopyFrom(Matrices);
+    Matrices->Orient2D.SetIdentity();
+    Matrices->Orient3D.SetIdentity();
+    Matrices->SetUserMatrix(Matrix2F::Identity);
+
+    // Setup the render target/depth stencil.
+    if ( !prt )
+    {
+        SF_DEBUG_WARNING(1, "HAL::PushRenderTarget - invalid render target.");
+        RenderTargetStack.PushBack(entry);
+        return;
+    }
+    setRasterTarget(prt);
+    ++AccumulatedStats.RTChanges;
+
+    // Setup viewport.
+    Rect<int> viewRect = prt->GetRect(); // On the render texture, might not be the entire surface.
+    const ImageSize& bs = prt->GetBufferSize();
+
+    // Clear, if not specifically excluded
+    if ( (flags & PRT_NoClear) == 0 )
+    {
+        const RasterTarget& target = Raster.GetTarget();
+        const float clearColor[4] = { 0, 0, 0, 0 };
+        Raster.ClearColor(Rect<int>(0, 0, target.Width, target.Height), clearColor);
+    }
+
+    VP = Viewport(bs.Width, bs.Height, viewRect.x1, viewRect.y1, viewRect.Width(), viewRect.Height());
+    VP.Flags |= Viewport::View_IsRenderTexture;
+
+    ViewRect.x1 = (int)frameRect.x1;
+    ViewRect.y1 = (int)frameRect.y1;
+    ViewRect.x2 = (int)frameRect.x2;
+    ViewRect.y2 = (int)frameRect.y2;
+
+    // Must offset the 'original' viewrect, otherwise the 3D compensation matrix will be offset.
+    Matrices->ViewRectOriginal.Offset(-entry.OldViewport.Left, -entry.OldViewport.Top);
+    Matrices->UVPOChanged = true;
+
+    HALState |= HS_ViewValid;
+    RenderTargetStack.PushBack(entry);
+    updateViewport();
+}
+
+void HAL::PopRenderTarget(unsigned)
+{
+    RenderTargetEntry& entry = RenderTargetStack.Back();
+    RenderTarget* prt = entry.pRenderTarget;
+    if ( prt )
+    {
+        prt->SetInUse(false);
+        if ( prt->GetType() == RBuffer_Temporary )
+        {
+            // Strip off the depth stencil surface/buffer from temporary targets.
+            RenderTargetData* plasthd = (RenderTargetData*)prt->GetRenderTargetData();
+            if ( plasthd->pDepthStencilBuffer )
+            {
+                // Pending triangles may still test against it.
+                Raster.Flush();
+                plasthd->pDepthStencilBuffer = 0;
+            }
+        }
+    }
+    Matrices->CopyFrom(&entry.OldMatrixState);
+    ViewRect = entry.OldViewRect;
+    VP = entry.OldViewport;
+
+    RenderTargetStack.PopBack();
+    if ( RenderTargetStack.GetSize() == 1 )
+        HALState &= ~HS_InRenderTarget;
+
+    // Restore the old render target.
+    if ( RenderTargetStack.GetSize() > 0 )
+        setRasterTarget(RenderTargetStack.Back().pRenderTarget);
+    ++AccumulatedStats.RTChanges;
+
+    // Reset the viewport to the last render target on the stack.
+    HALState |= HS_ViewValid;
+    updateViewport();
+}
+
+bool HAL::createDefaultRenderBuffer()
+{
+    ImageSize rtSize;
+
+    if ( GetDefaultRenderTarget() )
+    {
+        RenderTarget* prt = GetDefaultRenderTarget();
+        rtSize = prt->GetSize();
+    }
+    else
+    {
+        rtSize = FramebufferSize;
+        if ( rtSize.Width == 0 || rtSize.Height == 0 )
+        {
+            SF_DEBUG_WARNING(1, "Soft::HAL::InitHAL - FramebufferSize must be specified.");
+            return false;
+        }
+
+        Ptr<Render::Texture> pcolor = *pTextureManager->CreateTexture(Image_R8G8B8A8, 1, rtSize, ImageUse_RenderTarget, 0);
+        Ptr<Render::DepthStencilSurface> pstencil = *pTextureManager->CreateDepthStencilSurface(rtSize);
+        if ( !pcolor || !pstencil )
+            return false;
+
+        Ptr<RenderTarget> ptarget = *SF_HEAP_AUTO_NEW(this) RenderTarget(0, RBuffer_Default, rtSize );
+        Ptr<DepthStencilBuffer> pdsb = *SF_HEAP_AUTO_NEW(this) DepthStencilBuffer(0, rtSize);
+        RenderTargetData::UpdateData(ptarget, this, (Texture*)pcolor.GetPtr(),
+                                     (DepthStencilSurface*)pstencil.GetPtr(), pdsb);
+
+        if (!SetRenderTarget(ptarget))
+            return false;
+    }
+
+    return pRenderBufferManager->Initialize(pTextureManager, Image_R8G8B8A8, rtSize );
+}
+
+Texture* HAL::GetFramebufferTexture()
+{
+    RenderTarget* prt = GetDefaultRenderTarget();
+    RenderTargetData* phd = prt ? (RenderTargetData*)prt->GetRenderTargetData() : 0;
+    return phd ? phd->pColor.GetPtr() : 0;
+}
+
+void HAL::setRasterTarget(RenderTarget* prt)
+{
+    RasterTarget target;
+
+    RenderTargetData* phd = prt ? (RenderTargetData*)prt->GetRenderTargetData() : 0;
+    Texture* pcolor = phd ? phd->GetColorTexture() : 0;
+    if ( pcolor && pcolor->pTextures )
+    {
+        const Texture::HWTextureDesc& tdesc = pcolor->pTextures[0];
+        target.pColor = tdesc.pTexData;
+        target.Pitch  = tdesc.Pitch;
+        target.Width  = (int)tdesc.Size.Width;
+        target.Height = (int)tdesc.Size.Height;
+
+        // Depth stencil buffers may be shared between targets, and can be larger than the color buffer.
+        DepthStencilSurface* pstencil = phd->GetStencilSurface();
+        if ( pstencil && pstencil->pStencil &&
+             pstencil->GetSize().Width >= tdesc.Size.Width && pstencil->GetSize().Height >= tdesc.Size.Height )
+        {
+            target.pStencil     = pstencil->pStencil;
+            target.StencilPitch = pstencil->Pitch;
+        }
+    }
+    Raster.SetTarget(target);
+}
+
+//--------------------------------------------------------------------
+// *** Filters
+//--------------------------------------------------------------------
+
+// Filters are computed on the CPU (see Render_FiltersSW.h) directly from the
+// temporary target contents, so the result is always cached as a final target.
+
+void HAL::PushFilters(FilterPrimitive* prim)
+{
+    if (!checkState(HS_InDisplay, __FUNCTION__))
+        return;
+
+    FilterStackEntry e = {prim, 0};
+
+    // Queue the profiler off of whether masks should be draw or not.
+    if ( !Profiler.ShouldDrawMask() )
+    {
+        Profiler.SetDrawMode(2);
+
+        Matrix2F mvp(prim->GetFilterAreaMatrix().GetMatrix2D(), Matrices->UserView);
+        drawSolidQuad(mvp, Profiler.GetColor(0xFFFFFFFF), true);
+        FilterStack.PushBack(e);
+        return;
+    }
+
+    if ( (HALState & HS_CachedFilter) )
+    {
+        FilterStack.PushBack(e);
+        return;
+    }
+
+    // Disable masking from previous target, if this filter primitive doesn't have any masking.
+    if ( MaskStackTop != 0 && !prim->GetMaskPresent() && prim->GetCacheState() != FilterPrimitive::Cache_Target)
+        DrawState.StencilEnable = false;
+
+    HALState |= HS_DrawingFilter;
+
+    if ( prim->GetCacheState() ==  FilterPrimitive::Cache_Uncached )
+    {
+        // Draw the filter from scratch.
+        const Matrix2F& m = e.pPrimitive->GetFilterAreaMatrix().GetMatrix2D();
+        e.pRenderTarget = *CreateTempRenderTarget(ImageSize((UInt32)m.Sx(), (UInt32)m.Sy()), prim->GetMaskPresent());
+        RectF frameRect(m.Tx(), m.Ty(), m.Tx() + m.Sx(), m.Ty() + m.Sy());
+        PushRenderTarget(frameRect, e.pRenderTarget);
+        applyBlendMode(BlendModeStack.GetSize()>=1 ? BlendModeStack.Back() : Blend_Normal, false, true);
+
+        // If this primitive has masking, then clear the entire area to the current mask level, because
+        // the depth stencil target may be different, and thus does not contain the previously written values.
+        if ( prim->GetMaskPresent())
+        {
+            const RasterTarget& target = Raster.GetTarget();
+            Raster.ClearStencil(Rect<int>(0, 0, target.Width, target.Height), (UByte)MaskStackTop);
+        }
+    }
+    else
+    {
+        // Drawing a cached filter, ignore all draw calls until the corresponding PopFilters.
+        // Keep track of the level at which we need to draw the cached filter, by adding entries to the stack.
+        HALState |= HS_CachedFilter;
+        CachedFilterIndex = (int)FilterStack.GetSize();
+        GetRQProcessor().SetQueueEmitFilter(RenderQueueProcessor::QPF_Filters);
+    }
+    FilterStack.PushBack(e);
+}
+
+void HAL::drawUncachedFilter(const FilterStackEntry& e)
+{
+    // Invalid primitive or rendertarget.
+    if ( !e.pPrimitive || !e.pRenderTarget )
+        return;
+
+    const FilterSet* filters = e.pPrimitive->GetFilters();
+    unsigned filterCount = filters->GetFilterCount();
+
+    SF_ASSERT(RenderTargetStack.Back().pRenderTarget == e.pRenderTarget);
+
+    // The filters read the target memory, so the sub-scene must be rasterized first.
+    Raster.Flush();
+
+    ImageSize size = e.pRenderTarget->GetSize();
+    Ptr<RenderTarget> source = e.pRenderTarget;
+
+    for ( unsigned i = 0; i < filterCount; ++i )
+    {
+        const Filter* filter = filters->GetFilter(i);
+        if ( !IsFilterSupportedSW(filter) )
+            continue;
+
+        Ptr<RenderTarget> dest = *CreateTempRenderTarget(size, false);
+        ImagePlane sourcePlane, destPlane;
+        if ( !dest || !getTargetPlane(source, &sourcePlane) || !getTargetPlane(dest, &destPlane) )
+        {
+            if ( dest )
+                dest->SetInUse(false);
+            break;
+        }
+        ApplyFilterSW(filter, destPlane, sourcePlane);
+
+        // Intermediate results are not needed anymore; the original target is released by PopRenderTarget.
+        if ( source != e.pRenderTarget )
+            source->SetInUse(false);
+        source = dest;
+    }
+
+    // Cache the result, so it can be drawn directly next time.
+    RenderTarget* cacheResults[1] = { source };
+    e.pPrimitive->SetCacheResults(FilterPrimitive::Cache_Target, cacheResults, 1);
+    ((RenderTargetData*)source->GetRenderTargetData())->CacheID = reinterpret_cast<UPInt>(e.pPrimitive.GetPtr());
+
+    // Pop the temporary target, begin rendering to the previous surface.
+    PopRenderTarget();
+
+    // Re-[en/dis]able masking from previous target, if available.
+    if ( MaskStackTop != 0 )
+        DrawState.StencilEnable = true;
+
+    // Now actually draw the filtered sub-scene to the target below.
+    drawCachedFilter(e.pPrimitive);
+
+    // Cleanup.
+    source->SetInUse(false);
+    AccumulatedStats.Filters += filterCount;
+}
+
+void HAL::drawCachedFilter(FilterPrimitive* primitive)
+{
+    switch(primitive->GetCacheState())
+    {
+        // We have a final filtered texture. Just apply it to a screen quad.
+        case FilterPrimitive::Cache_Target:
+        {
+            RenderTarget* results;
+            primitive->GetCacheResults(&results, 1);
+            Texture* ptexture = (Texture*)results->GetTexture();
+            Matrix2F mvp = Matrices->UserView * primitive->GetFilterAreaMatrix().GetMatrix2D();
+            const Rect<int>& srect = results->GetRect();
+            Matrix2F texgen;
+            texgen.AppendTranslation((float)srect.x1, (float)srect.y1);
+            texgen.AppendScaling((float)srect.Width() / ptexture->GetSize().Width, (float)srect.Height() / ptexture->GetSize().Height);
+
+            applyBlendMode(BlendModeStack.GetSize()>=1 ? BlendModeStack.Back() : Blend_Normal, true, true);
+
+            RasterState state(DrawState);
+            state.Fill        = RasterFill_Texture;
+            state.Flags       = RasterFlag_Cxform|RasterFlag_CxformAc;
+            state.BlendEnable = true;
+            if (FillFlags & FF_Multiply)
+                state.Flags |= RasterFlag_Multiply;
+            else if (FillFlags & FF_Invert)
+                state.Flags |= RasterFlag_Invert;
+            setRasterCxform(&state, primitive->GetFilterAreaMatrix().GetCxform());
+            setSampler(&state.Samplers[0], ptexture, ImageFillMode(Wrap_Clamp, Sample_Linear));
+            Raster.SetState(state, &ptexture, 1);
+            drawQuad(MeshTransform(mvp), &texgen, 1);
+
+            applyBlendMode(BlendModeStack.GetSize()>=1 ? BlendModeStack.Back() : Blend_Normal, false, (HALState&HS_InRenderTarget)!=0);
+
+            // Cleanup.
+            results->SetInUse(false);
+            if ( !Profiler.IsFilterCachingEnabled() )
+                primitive->SetCacheResults(FilterPrimitive::Cache_Uncached, 0, 0);
+            break;
+        }
+
+        // Filters are never cached one step before the final target.
+        default: SF_ASSERT(0); break;
+    }
+}
+
+//--------------------------------------------------------------------
+// *** DrawableImage
+//--------------------------------------------------------------------
+
+void HAL::setDrawableQuad(RasterFillType fill, unsigned flags, Render::Texture** tex,
+                          const Matrix2F* texgen, unsigned textureCount, const Matrix2F& mvp)
+{
+    ScreenQuad.State             = DrawState;
+    ScreenQuad.State.Fill        = fill;
+    ScreenQuad.State.Flags       = flags;
+    ScreenQuad.State.BlendEnable = true;
+
+    // Targets are stored top-down, like the inverted viewports of GL.
+    ScreenQuad.MVP = mvp;
+    ScreenQuad.MVP.PrependTranslation(0.0f, 1.0f);
+    ScreenQuad.MVP.PrependScaling(1.0f, -1.0f);
+
+    for (unsigned i = 0; i < textureCount; ++i)
+    {
+        ScreenQuad.Textures[i] = (Texture*)tex[i];
+        ScreenQuad.Texgen[i]   = texgen[i];
+        setSampler(&ScreenQuad.State.Samplers[i], ScreenQuad.Textures[i], ImageFillMode(Wrap_Clamp, Sample_Point));
+    }
+    ScreenQuad.TextureCount = textureCount;
+}
+
+void HAL::drawScreenQuad()
+{
+    Raster.SetState(ScreenQuad.State, ScreenQuad.Textures, ScreenQuad.TextureCount);
+    drawQuad(MeshTransform(ScreenQuad.MVP), ScreenQuad.Texgen, ScreenQuad.TextureCount);
+}
+
+void HAL::DrawableCxform( Render::Texture** tex, const Matrix2F* texgen, const Cxform* cx)
+{
+    Matrix2F mvp = Matrix2F::Scaling(2,-2) * Matrix2F::Translation(-0.5f, -0.5f);
+    setDrawableQuad(RasterFill_Texture, RasterFlag_Cxform, tex, texgen, 1, mvp);
+    setRasterCxform(&ScreenQuad.State, *cx);
+    drawScreenQuad();
+}
+
+void HAL::DrawableCompare( Render::Texture** tex, const Matrix2F* texgen )
+{
+    Matrix2F mvp = Matrix2F::Scaling(2,-2) * Matrix2F::Translation(-0.5f, -0.5f);
+    setDrawableQuad(RasterFill_Compare, 0, tex, texgen, 2, mvp);
+    drawScreenQuad();
+}
+
+void HAL::DrawableCopyChannel( Render::Texture** tex, const Matrix2F* texgen, const Matrix4F* cxmul )
+{
+    DrawableMerge(tex, texgen, cxmul);
+}
+
+void HAL::DrawableMerge( Render::Texture** tex, const Matrix2F* texgen, const Matrix4F* cxmul )
+{
+    Matrix2F mvp = Matrix2F::Scaling(2,-2) * Matrix2F::Translation(-0.5f, -0.5f);
+    setDrawableQuad(RasterFill_Merge, 0, tex, texgen, 2, mvp);
+
+    // Set the color matrices which will perform the operation.
+    memcpy(ScreenQuad.State.Matrix[0], &cxmul[0].M[0][0], sizeof(ScreenQuad.State.Matrix[0]));
+    memcpy(ScreenQuad.State.Matrix[1], &cxmul[1].M[0][0], sizeof(ScreenQuad.State.Matrix[1]));
+    drawScreenQuad();
+}
+
+void HAL::DrawableCopyPixels( Render::Texture** tex, const Matrix2F* texgen, const Matrix2F& mvp,
+                              bool mergeAlpha, bool destAlpha )
+{
+    unsigned flags = 0;
+    if ( tex[2] )
+        flags |= RasterFlag_AlphaTexture;
+    if ( !destAlpha )
+        flags |= RasterFlag_NoDestAlpha;
+    else if ( mergeAlpha )
+        flags |= RasterFlag_MergeAlpha;
+
+    setDrawableQuad(RasterFill_CopyPixels, flags, tex, texgen, 2 + (tex[2] ? 1 : 0), mvp);
+    drawScreenQuad();
+}
+
+void HAL::DrawablePaletteMap( Render::Texture** tex, const Matrix2F* texgen, const Matrix2F& mvp,
+                              unsigned channelMask, const UInt32* values)
+{
+    // Create a temporary texture with the palette map.
+    ImageData data;
+    Render::TextureManager* mgr = GetTextureManager();
+    Ptr<Render::Texture> ptex = *mgr->CreateTexture(mgr->GetDrawableImageFormat(), 1, ImageSize(256, 4), ImageUse_Map_Mask, 0);
+    if ( !ptex || !ptex->Map(&data, 0, 1) )
+        return;
+    for ( int channel = 0; channel < 4; ++channel )
+    {
+        UInt32* dataPtr = (UInt32*)data.GetScanline(channel);
+        if ( channelMask & (1<<channel))
+        {
+            memcpy(dataPtr, values + channel*256, 256*sizeof(UInt32));
+        }
+        else
+        {
+            // Channel was not provided, just do a straight mapping.
+            for ( unsigned i = 0; i < 256; ++i )
+                *dataPtr++ = (i << (channel*8));
+        }
+    }
+    if (!ptex->Unmap())
+        return;
+
+    // First pass overwrites everything.
+    applyBlendMode(Blend_OverwriteAll, true, true);
+
+    Render::Texture* textures[2] = { tex[0], ptex };
+    Matrix2F         texgens[2]  = { texgen[0], Matrix2F::Identity };
+    setDrawableQuad(RasterFill_PaletteMap, 0, textures, texgens, 2, mvp);
+    drawScreenQuad();
+}
+
+void HAL::DrawableCopyback( Render::Texture* source, const Matrix2F& mvp, const Matrix2F& texgen )
+{
+    ScreenQuad.State             = DrawState;
+    ScreenQuad.State.Fill        = RasterFill_Texture;
+    ScreenQuad.State.Flags       = 0;
+    ScreenQuad.State.BlendEnable = true;
+    ScreenQuad.MVP               = mvp;
+    ScreenQuad.Texgen[0]         = texgen;
+    ScreenQuad.Textures[0]       = (Texture*)source;
+    ScreenQuad.TextureCount      = 1;
+    setSampler(&ScreenQuad.State.Samplers[0], ScreenQuad.Textures[0], ImageFillMode());
+    drawScreenQuad();
+}
+
+//--------------------------------------------------------------------
+
+Texture* RenderTargetData::GetColorTexture() const
+{
+    if (pColor)
+        return pColor;
+    return (Texture*)((RenderTarget*)pBuffer)->GetTexture();
+}
+
+DepthStencilSurface* RenderTargetData::GetStencilSurface() const
+{
+    if (pStencil)
+        return pStencil;
+    return pDepthStencilBuffer ? (DepthStencilSurface*)pDepthStencilBuffer->GetSurface() : 0;
+}
+
+void MatrixState::recalculateUVPOC() const
+{
+    if (UVPOChanged)
+    {
+        // Recalculated the view compensation matrix.
+        if ( ViewRect != ViewRectOriginal && !ViewRectOriginal.IsNull())
+        {
+            Point<int> dc = ViewRect.Center() - ViewRectOriginal.Center();
+            float      dx = ((float)ViewRectOriginal.Width()) / ViewRect.Width();
+            float      dy = ((float)ViewRectOriginal.Height()) / ViewRect.Height();
+            float      ox = 2.0f * dc.x / ViewRect.Width();
+            float      oy = 2.0f * dc.y / ViewRect.Height();
+            ViewRectCompensated3D.MultiplyMatrix(Matrix4F::Translation(-ox, oy, 0), Matrix4F::Scaling(dx, dy, 1));
+        }
+        else
+        {
+            ViewRectCompensated3D = Matrix4F::Identity;
+        }
+
+        const Matrix4F& Projection = updateStereoProjection();
+
+        // All targets are stored top-down, so the render texture flip always applies.
+        Matrix4F flipmat;
+        flipmat.SetIdentity();
+        flipmat.Append(Matrix4F::Scaling(1.0f, -1.0f, 1.0f));
+
+        Matrix4F FV(flipmat, ViewRectCompensated3D);
+        Matrix4F UO(User3D, FV);
+        Matrix4F VRP(Orient3D, Projection);
+        UVPO = Matrix4F(Matrix4F(UO, VRP), View3D);
+        UVPOChanged = 0;
+    }
+}
+
+}}} // Scaleform::Render::Soft
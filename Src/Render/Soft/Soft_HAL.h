@@ -0,0 +1,281 @@
+/**************************************************************************
+
+Filename    :   Soft_HAL.h
+Content     :   Software rasterizing Renderer HAL header.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_Soft_HAL_H
+#define INC_SF_Render_Soft_HAL_H
+
+#include "Render/Render_HAL.h"
+#include "Render/Soft/Soft_Sync.h"
+#include "Render/Soft/Soft_MeshCache.h"
+#include "Render/Soft/Soft_Texture.h"
+#include "Render/Soft/Soft_RasterQueue.h"
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+// Soft::HALInitParams provides software renderer initialization parameters
+// for HAL::InitHAL.
+//  - FramebufferSize is the size of the default render target allocated
+//    by the HAL; its contents are available through HAL::GetFramebufferTexture.
+//    It is ignored if a custom RenderBufferManager is passed in.
+//  - RasterThreads is the number of worker threads used to rasterize tiles,
+//    in addition to the render thread; 0 selects one thread per CPU core,
+//    counting the render thread.
+
+struct HALInitParams : public Render::HALInitParams
+{
+    ImageSize   FramebufferSize;
+    unsigned    RasterThreads;
+
+    HALInitParams(const ImageSize& framebufferSize = ImageSize(0, 0),
+                  unsigned rasterThreads = 0,
+                  UInt32 halConfigFlags = 0,
+                  ThreadId renderThreadId = ThreadId()) :
+        Render::HALInitParams(0, halConfigFlags, renderThreadId),
+        FramebufferSize(framebufferSize),
+        RasterThreads(rasterThreads)
+    { }
+
+    // Soft::TextureManager accessors for correct type.
+    void            SetTextureManager(TextureManager* manager) { pTextureManager = manager; }
+    TextureManager* GetTextureManager() const       { return (TextureManager*) pTextureManager.GetPtr(); }
+};
+
+class MatrixState : public Render::MatrixState
+{
+public:
+    MatrixState(HAL* phal) : Render::MatrixState((Render::HAL*)phal)
+    { }
+
+    MatrixState() : Render::MatrixState()
+    { }
+
+protected:
+    virtual void        recalculateUVPOC() const;
+};
+
+class MeshTransform;
+
+// Software HAL. Primitives are transformed on the CPU and queued into a
+// RasterQueue together with the render state they need; the queue is
+// rasterized into the current render target by a pool of tile workers
+// whenever the target changes, the scene ends, or the CPU needs the pixels.
+//
+// All render targets, including the default one, are system memory textures
+// stored top-down: clip space y = -1 maps to the first scanline, just as
+// render textures do on the hardware HALs.
+
+class HAL : public Render::HAL
+{
+public:
+    RenderSync           RSync;
+    MeshCache            Cache;
+    Ptr<TextureManager>  pTextureManager;
+    RasterQueue          Raster;
+
+    // Size of the default render target created in InitHAL.
+    ImageSize            FramebufferSize;
+
+    // Self-accessor used to avoid constructor warning.
+    HAL*      GetHAL() { return this; }
+
+public:
+
+    HAL(ThreadCommandQueue* commandQueue = 0);
+    virtual ~HAL();
+
+    // *** HAL Initialization and Shutdown
+
+    // Initializes HAL for rendering.
+    virtual bool        InitHAL(const Soft::HALInitParams& params);
+
+    // ShutdownHAL shuts down rendering, releasing resources allocated in InitHAL.
+    virtual bool        ShutdownHAL();
+
+    // *** Rendering
+
+    virtual bool        BeginScene();
+    virtual bool        EndScene();
+    // Flushes the render queue and rasterizes everything submitted so far.
+    virtual void        Flush();
+
+    // Bracket the displaying of a frame from a movie.
+    // Fill the background color, and set up default transforms, etc.
+    virtual void        beginDisplay(BeginDisplayData* data);
+
+    // Updates the raster viewport and ViewportMatrix based on the current
+    // values of VP, ViewRect and ViewportValid.
+    virtual void        updateViewport();
+
+
+    virtual void        DrawProcessedPrimitive(Primitive* pprimitive,
+                                               PrimitiveBatch* pstart, PrimitiveBatch *pend);
+
+    virtual void        DrawProcessedComplexMeshes(ComplexMesh* p,
+                                                   const StrideArray<HMatrix>& matrices);
+
+    // *** Mask Support
+    virtual void    PushMask_BeginSubmit(MaskPrimitive* primitive);
+    virtual void    EndMaskSubmit();
+    virtual void    PopMask();
+
+    virtual void    clearSolidRectangle(const Rect<int>& r, Color color);
+
+    // *** BlendMode
+    virtual void       applyBlendModeImpl(BlendMode mode, bool sourceAc = false, bool forceAc = false);
+
+    virtual Render::TextureManager* GetTextureManager() const
+    {
+        return pTextureManager.GetPtr();
+    }
+
+    virtual RenderTarget*   CreateRenderTarget(Render::Texture* texture, bool needsStencil);
+    virtual RenderTarget*   CreateTempRenderTarget(const ImageSize& size, bool needsStencil);
+    virtual bool            SetRenderTarget(RenderTarget* target, bool setState = 1);
+    virtual void            PushRenderTarget(const RectF& frameRect, RenderTarget* prt, unsigned flags=0);
+    virtual void            PopRenderTarget(unsigned flags = 0);
+
+    virtual bool            createDefaultRenderBuffer();
+
+    // Returns the color buffer of the default render target created by the HAL, or
+    // 0 if the default target was supplied by the user. Contents are only complete
+    // after EndScene or Flush.
+    Texture*                GetFramebufferTexture();
+
+    // *** Filters
+    virtual void          PushFilters(FilterPrimitive* primitive);
+    virtual void          drawUncachedFilter(const FilterStackEntry& e);
+    virtual void          drawCachedFilter(FilterPrimitive* primitive);
+
+    // *** DrawableImage
+    virtual void        DrawableCxform( Render::Texture** tex, const Matrix2F* texgen, const Cxform* cx);
+    virtual void        DrawableCompare( Render::Texture** tex, const Matrix2F* texgen);
+    virtual void        DrawableCopyChannel( Render::Texture** tex, const Matrix2F* texgen, const Matrix4F* cxmul );
+    virtual void        DrawableMerge( Render::Texture** tex, const Matrix2F* texgen, const Matrix4F* cxmul );
+    virtual void        DrawableCopyPixels( Render::Texture** tex, const Matrix2F* texgen, const Matrix2F& mvp,
+                                            bool mergeAlpha, bool destAlpha );
+    virtual void        DrawablePaletteMap( Render::Texture** tex, const Matrix2F* texgen, const Matrix2F& mvp,
+                                            unsigned channelMask, const UInt32* values);
+    virtual void        DrawableCopyback( Render::Texture* tex, const Matrix2F& mvp, const Matrix2F& texgen );
+
+    virtual class MeshCache&       GetMeshCache()        { return Cache; }
+    virtual Render::RenderSync*    GetRenderSync() const { return const_cast<RenderSync*>(&RSync); }
+
+    virtual float         GetViewportScaling() const { return 1.0f; }
+
+    virtual void    MapVertexFormat(PrimitiveFillType fill, const VertexFormat* sourceFormat,
+                                    const VertexFormat** single,
+                                    const VertexFormat** batch, const VertexFormat** instanced,
+                                    unsigned meshType = MeshCacheItem::Mesh_Regular);
+
+protected:
+
+    // Draws the unit square described by ScreenQuad.
+    virtual void        drawScreenQuad();
+
+    // Binds the color and stencil planes of the given render target to the raster queue.
+    void                setRasterTarget(RenderTarget* prt);
+    // Fills in the fill type, flags and samplers of state for a primitive fill;
+    // returns the number of textures stored in ptextures.
+    unsigned            setRasterFill(RasterState* pstate, PrimitiveFillType fillType, unsigned fillFlags,
+                                      PrimitiveFill* pfill, Texture** ptextures);
+    void                setRasterCxform(RasterState* pstate, const Cxform& cx);
+
+    // Transforms and queues indexed triangles of a mesh stored in the mesh cache.
+    void                drawMesh(const MeshTransform& transform, const VertexFormat* pformat,
+                                 const UByte* pvertices, unsigned vertexCount,
+                                 const UInt16* pindices, unsigned indexCount,
+                                 const Matrix2F* texgen, unsigned texgenCount);
+    // Queues the unit square transformed by 'transform'; texgen is applied to the
+    // unit square coordinates.
+    void                drawQuad(const MeshTransform& transform, const Matrix2F* texgen, unsigned texgenCount);
+
+    void                drawMaskClearRectangles(const HMatrix* matrices, UPInt count);
+    // Queues the unit square with a solid color fill.
+    void                drawSolidQuad(const Matrix2F& mvp, Color color, bool blend);
+
+    // Sets up ScreenQuad with a DrawableImage fill covering the current target.
+    void                setDrawableQuad(RasterFillType fill, unsigned flags, Render::Texture** tex,
+                                        const Matrix2F* texgen, unsigned textureCount, const Matrix2F& mvp);
+
+    // Raster state shared by all draws: blending, stencil, color writes and
+    // the viewport clip rectangle. Fills are set up per draw on a copy.
+    RasterState          DrawState;
+    // Maps clip space coordinates to target pixels: px = x * ClipScale + ClipOffset.
+    float                ClipScale[2], ClipOffset[2];
+
+    // Fill used by drawScreenQuad.
+    struct ScreenQuadDesc
+    {
+        RasterState      State;
+        Matrix2F         MVP;
+        Matrix2F         Texgen[3];
+        Texture*         Textures[3];
+        unsigned         TextureCount;
+    };
+    ScreenQuadDesc       ScreenQuad;
+
+    // Scratch arrays reused for transforming meshes.
+    typedef ArrayConstPolicy<0, 64, true> ScratchPolicy;
+    ArrayLH<RasterVertex, StatRender_Mem, ScratchPolicy> TransformedVertices;
+    ArrayLH<RasterVertex, StatRender_Mem, ScratchPolicy> TriangleVertices;
+    ArrayLH<UByte,        StatRender_Mem, ScratchPolicy> VertexVisible;
+};
+
+//--------------------------------------------------------------------
+// RenderTargetData, used for both RenderTargets and DepthStencilSurface implementations.
+// The default render target has no texture of its own in RenderBuffer, so its
+// color and stencil planes are held here.
+class RenderTargetData : public RenderBuffer::RenderTargetData
+{
+public:
+    friend class HAL;
+
+    HAL*                        pHAL;
+    Ptr<Texture>                pColor;         // Color plane of the default render target.
+    Ptr<DepthStencilSurface>    pStencil;       // Stencil plane of the default render target.
+
+    static void UpdateData( RenderBuffer* buffer, HAL* phal, Texture* pcolor, DepthStencilSurface* pstencil,
+                            DepthStencilBuffer* pdsb)
+    {
+        if ( !buffer )
+            return;
+
+        RenderTargetData* poldHD = (Soft::RenderTargetData*)buffer->GetRenderTargetData();
+        if ( !poldHD )
+        {
+            poldHD = SF_NEW RenderTargetData(buffer, phal, pcolor, pstencil, pdsb);
+            buffer->SetRenderTargetData(poldHD);
+            return;
+        }
+        poldHD->pDepthStencilBuffer = pdsb;
+    }
+
+    HAL* GetHAL() const     { return pHAL; }
+
+    // Returns the color and stencil planes rendering goes to.
+    Texture*                GetColorTexture() const;
+    DepthStencilSurface*    GetStencilSurface() const;
+
+private:
+    RenderTargetData( RenderBuffer* buffer, HAL* hal, Texture* pcolor, DepthStencilSurface* pstencil,
+                      DepthStencilBuffer* pdsb ) :
+       RenderBuffer::RenderTargetData(buffer, pdsb), pHAL(hal), pColor(pcolor), pStencil(pstencil)
+    { }
+};
+
+
+}}} // Scaleform::Render::Soft
+
+#endif
@@ -0,0 +1,117 @@
+/**************************************************************************
+
+Filename    :   Soft_MeshCache.cpp
+Content     :   Software renderer Mesh Cache implementation
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Render/Soft/Soft_MeshCache.h"
+#include "Kernel/SF_Debug.h"
+#include "Kernel/SF_HeapNew.h"
+
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+// ***** MeshCache
+
+MeshCache::MeshCache(MemoryHeap* pheap, const MeshCacheParams& params, RenderSync* rsync)
+    : SimpleMeshCache(pheap, params, rsync),
+      RSync(rsync)
+{
+    adjustMeshCacheParams(&Params);
+}
+
+MeshCache::~MeshCache()
+{
+    Reset(); 
+}
+
+// Initializes MeshCache for operation, including allocation of the reserve
+// buffer. Typically called from InitHAL.
+bool    MeshCache::Initialize()
+{
+    if (!StagingBuffer.Initialize(pHeap, Params.StagingBufferSize))
+        return false;
+
+    if (!allocateReserve())
+        return false;
+
+    return true;
+}
+
+void    MeshCache::Reset()
+{
+    releaseAllBuffers();
+}
+
+bool MeshCache::SetParams(const MeshCacheParams& argParams)
+{
+    MeshCacheParams oldParams(Params);
+    CacheList.EvictAll();
+    Params = argParams;
+    adjustMeshCacheParams(&Params);
+
+    if (Params.StagingBufferSize != oldParams.StagingBufferSize)
+    {
+        if (!StagingBuffer.Initialize(pHeap, Params.StagingBufferSize))
+        {
+            if (!StagingBuffer.Initialize(pHeap, Params.StagingBufferSize))
+            {
+                SF_DEBUG_ERROR(1, "MeshCache::SetParams - couldn't restore StagingBuffer after fail");
+            }
+            return false;
+        }
+    }
+
+    if ((Params.MemReserve != oldParams.MemReserve) ||
+        (Params.MemGranularity != oldParams.MemGranularity))
+    {
+        releaseAllBuffers();
+
+        // Allocate new reserve. If not possible, restore previous one and fail.
+        if (Params.MemReserve && !allocateReserve())
+        {
+            SF_DEBUG_ERROR(1, "MeshCache::SetParams - couldn't restore Reserve after fail");
+        }
+    }
+    return true;
+}
+
+void MeshCache::adjustMeshCacheParams(MeshCacheParams* p)
+{
+    // The raster queue reads source vertices directly, so neither batching
+    // nor instancing saves any work; they only add format conversion.
+    p->MaxBatchInstances    = 1;
+    p->InstancingThreshold  = 1<<30;
+}
+
+SimpleMeshBuffer*  MeshCache::createHWBuffer(UPInt size, AllocType atype, unsigned arena)
+{
+    SimpleMeshBuffer* pbuffer = SF_HEAP_NEW(pHeap) SimpleMeshBuffer(size, atype, arena);
+    if (!pbuffer)
+        return 0;
+
+    pbuffer->pData = (UByte*)SF_HEAP_MEMALIGN(pHeap, size, 16, StatRender_Buffers_Mem);
+    if (!pbuffer->pData)
+    {
+        delete pbuffer;
+        return 0;
+    }
+    return pbuffer;
+}
+
+void        MeshCache::destroyHWBuffer(SimpleMeshBuffer* pbuffer)
+{
+    SF_FREE_ALIGN(pbuffer->pData);
+    delete pbuffer;
+}
+
+}}}; // namespace Scaleform::Render::Soft
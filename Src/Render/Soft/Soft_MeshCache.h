@@ -0,0 +1,66 @@
+/**************************************************************************
+
+Filename    :   Soft_MeshCache.h
+Content     :   Software renderer Mesh Cache header
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_Soft_MeshCache_H
+#define INC_SF_Render_Soft_MeshCache_H
+
+#include "Render/Render_SimpleMeshCache.h"
+#include "Render/Soft/Soft_Sync.h"
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+class MeshCache;
+class HAL;
+
+// Software version of MeshCacheItem. 
+// We define this class primarily to allow HAL member access through friendship. 
+
+class MeshCacheItem : public SimpleMeshCacheItem
+{
+    friend class MeshCache;
+    friend class HAL;
+};
+
+// Software MeshCache keeps all vertex and index buffers in system memory
+// allocated from the cache heap; SimpleMeshCache does the rest of the work.
+
+class MeshCache : public SimpleMeshCache
+{       
+    friend class HAL;    
+
+    RenderSync*     RSync;
+
+    // SimpleMeshCache implementation
+    virtual SimpleMeshBuffer* createHWBuffer(UPInt size, AllocType atype, unsigned arena);
+    virtual void              destroyHWBuffer(SimpleMeshBuffer* pbuffer);
+
+    void            adjustMeshCacheParams(MeshCacheParams* p);    
+
+public:
+    MeshCache(MemoryHeap* pheap, const MeshCacheParams& params, RenderSync* rsync);
+    ~MeshCache();
+
+    // Initializes MeshCache for operation, including allocation of the reserve
+    // buffer. Typically called from InitHAL.
+    bool            Initialize();
+    // Resets MeshCache, releasing all buffers.
+    void            Reset();       
+
+    virtual bool    SetParams(const MeshCacheParams& params);
+};
+
+}}};  // namespace Scaleform::Render::Soft
+
+#endif
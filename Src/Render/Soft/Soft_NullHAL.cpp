@@ -0,0 +1,568 @@
+/**************************************************************************
+
+Filename    :   Soft_NullHAL.cpp
+Content     :   Recording Renderer HAL that discards all drawing.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Kernel/SF_Debug.h"
+#include "Kernel/SF_HeapNew.h"
+#include "Render/Render_BufferGeneric.h"
+#include "Render/Soft/Soft_NullHAL.h"
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+// ***** NullMeshCache
+
+NullMeshCache::NullMeshCache(MemoryHeap* pheap, const MeshCacheParams& params, RenderSync* rsync)
+    : SimpleMeshCache(pheap, params, rsync),
+      pStats(0)
+{
+}
+
+NullMeshCache::~NullMeshCache()
+{
+    Reset();
+}
+
+bool    NullMeshCache::Initialize()
+{
+    if (!StagingBuffer.Initialize(pHeap, Params.StagingBufferSize))
+        return false;
+
+    if (!allocateReserve())
+        return false;
+
+    return true;
+}
+
+void    NullMeshCache::Reset()
+{
+    releaseAllBuffers();
+    NewItems.Clear();
+}
+
+bool NullMeshCache::SetParams(const MeshCacheParams& argParams)
+{
+    MeshCacheParams oldParams(Params);
+    CacheList.EvictAll();
+    Params = argParams;
+
+    if (Params.StagingBufferSize != oldParams.StagingBufferSize)
+    {
+        if (!StagingBuffer.Initialize(pHeap, Params.StagingBufferSize))
+        {
+            if (!StagingBuffer.Initialize(pHeap, Params.StagingBufferSize))
+            {
+                SF_DEBUG_ERROR(1, "NullMeshCache::SetParams - couldn't restore StagingBuffer after fail");
+            }
+            return false;
+        }
+    }
+
+    if ((Params.MemReserve != oldParams.MemReserve) ||
+        (Params.MemGranularity != oldParams.MemGranularity))
+    {
+        releaseAllBuffers();
+
+        // Allocate new reserve. If not possible, restore previous one and fail.
+        if (Params.MemReserve && !allocateReserve())
+        {
+            SF_DEBUG_ERROR(1, "NullMeshCache::SetParams - couldn't restore Reserve after fail");
+        }
+    }
+    return true;
+}
+
+void NullMeshCache::BeginFrame()
+{
+    SimpleMeshCache::BeginFrame();
+    NewItems.Clear();
+}
+
+UPInt NullMeshCache::Evict(Render::MeshCacheItem* p, AllocAddr* pallocator, MeshBase* pmesh)
+{
+    // Forget the item while it is still valid, so that its address can be
+    // reused by a later allocation.
+    NewItems.Remove(p);
+    return SimpleMeshCache::Evict(p, pallocator, pmesh);
+}
+
+// Complex meshes and large meshes are allocated through AllocCacheItem.
+Render::MeshCache::AllocResult
+NullMeshCache::AllocCacheItem(Render::MeshCacheItem** pdata,
+                              UByte** pvertexDataStart, IndexType** pindexDataStart,
+                              MeshCacheItem::MeshType meshType,
+                              MeshCacheItem::MeshBaseContent &mc,
+                              UPInt vertexBufferSize,
+                              unsigned vertexCount, unsigned indexCount,
+                              bool waitForCache, const VertexFormat* pDestFormat)
+{
+    AllocResult result = SimpleMeshCache::AllocCacheItem(pdata, pvertexDataStart, pindexDataStart,
+                                                         meshType, mc, vertexBufferSize,
+                                                         vertexCount, indexCount,
+                                                         waitForCache, pDestFormat);
+    if (result == Alloc_Success)
+        recordMiss(*pdata, vertexBufferSize, indexCount * sizeof(IndexType));
+    return result;
+}
+
+bool NullMeshCache::PreparePrimitive(PrimitiveBatch* pbatch,
+                                     MeshCacheItem::MeshContent &mc,
+                                     bool waitForCache)
+{
+    bool largeMesh = mc.IsLargeMesh();
+    if (!SimpleMeshCache::PreparePrimitive(pbatch, mc, waitForCache))
+        return false;
+
+    // Regular batches are allocated directly by SimpleMeshCache.
+    Render::MeshCacheItem* pitem = pbatch->GetCacheItem();
+    if (!largeMesh && pitem)
+    {
+        recordMiss(pitem, pitem->VertexCount * pbatch->pFormat->Size,
+                   pitem->IndexCount * sizeof(IndexType));
+    }
+    return true;
+}
+
+void NullMeshCache::recordMiss(Render::MeshCacheItem* p, UPInt vertexBytes, UPInt indexBytes)
+{
+    NewItems.Set(p);
+    if (pStats)
+    {
+        pStats->MeshCacheMisses++;
+        pStats->VertexBytes += vertexBytes;
+        pStats->IndexBytes  += indexBytes;
+    }
+}
+
+SimpleMeshBuffer*  NullMeshCache::createHWBuffer(UPInt size, AllocType atype, unsigned arena)
+{
+    SimpleMeshBuffer* pbuffer = SF_HEAP_NEW(pHeap) SimpleMeshBuffer(size, atype, arena);
+    if (!pbuffer)
+        return 0;
+
+    pbuffer->pData = (UByte*)SF_HEAP_MEMALIGN(pHeap, size, 16, StatRender_Buffers_Mem);
+    if (!pbuffer->pData)
+    {
+        delete pbuffer;
+        return 0;
+    }
+    return pbuffer;
+}
+
+void        NullMeshCache::destroyHWBuffer(SimpleMeshBuffer* pbuffer)
+{
+    SF_FREE_ALIGN(pbuffer->pData);
+    delete pbuffer;
+}
+
+
+//------------------------------------------------------------------------
+// ***** NullHAL
+
+NullHAL::NullHAL(ThreadCommandQueue* commandQueue)
+:   Render::HAL(commandQueue),
+    Cache(Memory::GetGlobalHeap(), MeshCacheParams::PC_Defaults, &RSync),
+    FramebufferSize(0, 0)
+{
+    Cache.SetStats(&CurrentFrame);
+}
+
+NullHAL::~NullHAL()
+{
+    ShutdownHAL();
+}
+
+bool NullHAL::InitHAL(const Soft::HALInitParams& params)
+{
+    if ( !Render::HAL::initHAL(params))
+        return false;
+
+    FramebufferSize = params.FramebufferSize;
+
+    pTextureManager = params.GetTextureManager();
+    if (!pTextureManager)
+    {
+        pTextureManager =
+            *SF_HEAP_AUTO_NEW(this) TextureManager(params.RenderThreadId, pRTCommandQueue);
+    }
+
+    Matrices = *SF_HEAP_AUTO_NEW(this) Render::MatrixState(this);
+
+    pRenderBufferManager = params.pRenderBufferManager;
+    if (!pRenderBufferManager)
+    {
+        pRenderBufferManager = *SF_HEAP_AUTO_NEW(this) RenderBufferManagerGeneric();
+        if ( !pRenderBufferManager || !createDefaultRenderBuffer())
+        {
+            ShutdownHAL();
+            return false;
+        }
+    }
+
+    if (!Cache.Initialize())
+        return false;
+
+    HALState|= HS_ModeSet;
+    notifyHandlers(HAL_Initialize);
+    return true;
+}
+
+bool NullHAL::ShutdownHAL()
+{
+    if (!(HALState & HS_ModeSet))
+        return true;
+
+    if (!shutdownHAL())
+        return false;
+
+    destroyRenderBuffers();
+    pRenderBufferManager.Clear();
+    pTextureManager->ProcessQueues();
+    pTextureManager.Clear();
+    Cache.Reset();
+    return true;
+}
+
+
+// ***** Rendering
+
+bool NullHAL::BeginFrame()
+{
+    CurrentFrame.Clear();
+    return Render::HAL::BeginFrame();
+}
+
+void NullHAL::EndFrame()
+{
+    Render::HAL::EndFrame();
+    LastFrame = CurrentFrame;
+}
+
+void NullHAL::updateViewport()
+{
+    if (HALState & HS_ViewValid)
+    {
+        int dx = ViewRect.x1 - VP.Left,
+            dy = ViewRect.y1 - VP.Top;
+
+        CalcHWViewMatrix(VP.Flags, &Matrices->View2D, ViewRect, dx, dy);
+        Matrices->SetUserMatrix(Matrices->User);
+        Matrices->ViewRect    = ViewRect;
+        Matrices->UVPOChanged = 1;
+    }
+}
+
+void   NullHAL::MapVertexFormat(PrimitiveFillType, const VertexFormat* sourceFormat,
+                                const VertexFormat** single,
+                                const VertexFormat** batch, const VertexFormat** instanced, unsigned)
+{
+    // Batches are formed as on the hardware HALs, but the vertices are never read,
+    // so they do not need the instance index a shader would use.
+    *single    = sourceFormat;
+    *batch     = sourceFormat;
+    *instanced = 0;
+}
+
+void NullHAL::recordCacheUse(Render::MeshCacheItem* pmesh)
+{
+    if (!Cache.IsNewItem(pmesh))
+        CurrentFrame.MeshCacheHits++;
+    pmesh->MoveToCacheListFront(MCL_ThisFrame);
+}
+
+void        NullHAL::DrawProcessedPrimitive(Primitive* pprimitive,
+                                            PrimitiveBatch* pstart, PrimitiveBatch *pend)
+{
+    SF_AMP_SCOPE_RENDER_TIMER("NullHAL::DrawProcessedPrimitive", Amp_Profile_Level_High);
+    if (!checkState(HS_InDisplay, __FUNCTION__) ||
+        !pprimitive->GetMeshCount() )
+        return;
+
+    SF_ASSERT(pend != 0);
+    CurrentFrame.Primitives++;
+
+    PrimitiveBatch* pbatch = pstart ? pstart : pprimitive->Batches.GetFirst();
+    while (pbatch != pend)
+    {
+        // pBatchMesh can be null in case of error, such as VB/IB lock failure.
+        Render::MeshCacheItem* pmesh = pbatch->GetCacheItem();
+        if (pmesh)
+        {
+            CurrentFrame.Batches++;
+            CurrentFrame.Meshes    += pbatch->GetMeshCount();
+            CurrentFrame.Triangles += pmesh->IndexCount / 3;
+            AccumulatedStats.Primitives++;
+            AccumulatedStats.Meshes    += pbatch->GetMeshCount();
+            AccumulatedStats.Triangles += pmesh->IndexCount / 3;
+            recordCacheUse(pmesh);
+        }
+        pbatch = pbatch->GetNext();
+    }
+}
+
+void NullHAL::DrawProcessedComplexMeshes(ComplexMesh* complexMesh,
+                                         const StrideArray<HMatrix>& matrices)
+{
+    typedef ComplexMesh::FillRecord   FillRecord;
+
+    Render::MeshCacheItem* pmesh = complexMesh->GetCacheItem();
+    if (!checkState(HS_InDisplay, __FUNCTION__) || !pmesh)
+        return;
+
+    const FillRecord* fillRecords = complexMesh->GetFillRecords();
+    unsigned    fillCount     = complexMesh->GetFillRecordCount();
+    unsigned    instanceCount = (unsigned)matrices.GetSize();
+
+    // MapVertexFormat provides no instanced format, so every fill of every
+    // instance is a separate draw call.
+    CurrentFrame.Primitives++;
+    CurrentFrame.Meshes += instanceCount;
+    AccumulatedStats.Meshes += instanceCount;
+    for (unsigned fillIndex = 0; fillIndex < fillCount; fillIndex++)
+    {
+        const FillRecord& fr = fillRecords[fillIndex];
+        CurrentFrame.Batches   += instanceCount;
+        CurrentFrame.Triangles += (fr.IndexCount / 3) * instanceCount;
+        AccumulatedStats.Primitives += instanceCount;
+        AccumulatedStats.Triangles  += (fr.IndexCount / 3) * instanceCount;
+    }
+
+    recordCacheUse(pmesh);
+}
+
+void NullHAL::clearSolidRectangle(const Rect<int>& r, Color color)
+{
+    SF_UNUSED2(r, color);
+}
+
+void NullHAL::drawScreenQuad()
+{
+}
+
+//--------------------------------------------------------------------
+// *** Mask support
+//--------------------------------------------------------------------
+
+// Only the mask stack and viewport clipping are maintained, as they affect the
+// state seen by the renderer.
+
+void NullHAL::PushMask_BeginSubmit(MaskPrimitive* prim)
+{
+    if (!checkState(HS_InDisplay, __FUNCTION__))
+        return;
+
+    bool viewportValid = (HALState & HS_ViewValid) != 0;
+
+    MaskStack.Resize(MaskStackTop+1);
+    MaskStackEntry &e = MaskStack[MaskStackTop];
+    e.pPrimitive       = prim;
+    e.OldViewportValid = viewportValid;
+    e.OldViewRect      = ViewRect;
+    MaskStackTop++;
+
+    HALState |= HS_DrawingMask;
+
+    if (prim->IsClipped() && viewportValid)
+    {
+        Matrix2F m = prim->GetMaskAreaMatrix(0).GetMatrix2D();
+        m.Append(Matrices->Orient2D);
+
+        RectF     rect = m.EncloseTransform(RectF(0,0,1,1));
+        Rect<int> boundClip(VP.Left + (int)rect.x1, VP.Top + (int)rect.y1,
+                            VP.Left + (int)rect.x2, VP.Top + (int)rect.y2);
+
+        if (!ViewRect.IntersectRect(&ViewRect, boundClip))
+        {
+            ViewRect.Clear();
+            HALState &= ~HS_ViewValid;
+        }
+        updateViewport();
+    }
+
+    CurrentFrame.Masks++;
+    ++AccumulatedStats.Masks;
+}
+
+void NullHAL::EndMaskSubmit()
+{
+    if (!checkState(HS_InDisplay|HS_DrawingMask, __FUNCTION__))
+        return;
+
+    HALState &= ~HS_DrawingMask;
+    SF_ASSERT(MaskStackTop);
+}
+
+void NullHAL::PopMask()
+{
+    if (!checkState(HS_InDisplay, __FUNCTION__))
+        return;
+
+    SF_ASSERT(MaskStackTop);
+    MaskStackTop--;
+
+    if (MaskStack[MaskStackTop].pPrimitive->IsClipped())
+    {
+        // Restore viewport
+        ViewRect      = MaskStack[MaskStackTop].OldViewRect;
+
+        if (MaskStack[MaskStackTop].OldViewportValid)
+            HALState |= HS_ViewValid;
+        else
+            HALState &= ~HS_ViewValid;
+        updateViewport();
+    }
+}
+
+void NullHAL::applyBlendModeImpl(BlendMode mode, bool sourceAc, bool forceAc)
+{
+    SF_UNUSED3(mode, sourceAc, forceAc);
+}
+
+//--------------------------------------------------------------------
+// *** Render targets
+//--------------------------------------------------------------------
+
+RenderTarget* NullHAL::CreateRenderTarget(Render::Texture* texture, bool)
+{
+    if ( !texture )
+        return 0;
+    return pRenderBufferManager->CreateRenderTarget(
+        texture->GetSize(), RBuffer_Texture, texture->GetFormat(), texture);
+}
+
+RenderTarget* NullHAL::CreateTempRenderTarget(const ImageSize& size, bool)
+{
+    return pRenderBufferManager->CreateTempRenderTarget(size);
+}
+
+bool NullHAL::SetRenderTarget(RenderTarget* ptarget, bool)
+{
+    // Cannot set the bottom level render target if already in display.
+    if ( HALState & HS_InDisplay )
+        return false;
+
+    RenderTargetEntry entry;
+    entry.pRenderTarget = ptarget;
+
+    // Replace the stack entry at the bottom, or if the stack is empty, add one.
+    if ( RenderTargetStack.GetSize() > 0 )
+        RenderTargetStack[0] = entry;
+    else
+        RenderTargetStack.PushBack(entry);
+    return true;
+}
+
+void NullHAL::PushRenderTarget(const RectF& frameRect, RenderTarget* prt, unsigned)
+{
+    HALState |= HS_InRenderTarget;
+    RenderTargetEntry entry;
+    entry.pRenderTarget = prt;
+    entry.OldViewport = VP;
+    entry.OldViewRect = ViewRect;
+    entry.OldMatrixState.CopyFrom(Matrices);
+    Matrices->Orient2D.SetIdentity();
+    Matrices->Orient3D.SetIdentity();
+    Matrices->SetUserMatrix(Matrix2F::Identity);
+
+    if ( !prt )
+    {
+        SF_DEBUG_WARNING(1, "NullHAL::PushRenderTarget - invalid render target.");
+        RenderTargetStack.PushBack(entry);
+        return;
+    }
+    CurrentFrame.RTChanges++;
+    ++AccumulatedStats.RTChanges;
+
+    Rect<int> viewRect = prt->GetRect();
+    const ImageSize& bs = prt->GetBufferSize();
+    VP = Viewport(bs.Width, bs.Height, viewRect.x1, viewRect.y1, viewRect.Width(), viewRect.Height());
+    VP.Flags |= Viewport::View_IsRenderTexture;
+
+    ViewRect.x1 = (int)frameRect.x1;
+    ViewRect.y1 = (int)frameRect.y1;
+    ViewRect.x2 = (int)frameRect.x2;
+    ViewRect.y2 = (int)frameRect.y2;
+
+    // Must offset the 'original' viewrect, otherwise the 3D compensation matrix will be offset.
+    Matrices->ViewRectOriginal.Offset(-entry.OldViewport.Left, -entry.OldViewport.Top);
+    Matrices->UVPOChanged = true;
+
+    HALState |= HS_ViewValid;
+    RenderTargetStack.PushBack(entry);
+    updateViewport();
+}
+
+void NullHAL::PopRenderTarget(unsigned)
+{
+    RenderTargetEntry& entry = RenderTargetStack.Back();
+    if ( entry.pRenderTarget )
+        entry.pRenderTarget->SetInUse(false);
+
+    Matrices->CopyFrom(&entry.OldMatrixState);
+    ViewRect = entry.OldViewRect;
+    VP = entry.OldViewport;
+
+    RenderTargetStack.PopBack();
+    if ( RenderTargetStack.GetSize() == 1 )
+        HALState &= ~HS_InRenderTarget;
+    CurrentFrame.RTChanges++;
+    ++AccumulatedStats.RTChanges;
+
+    HALState |= HS_ViewValid;
+    updateViewport();
+}
+
+bool NullHAL::createDefaultRenderBuffer()
+{
+    ImageSize rtSize;
+
+    if ( GetDefaultRenderTarget() )
+    {
+        RenderTarget* prt = GetDefaultRenderTarget();
+        rtSize = prt->GetSize();
+    }
+    else
+    {
+        rtSize = FramebufferSize;
+        if ( rtSize.Width == 0 || rtSize.Height == 0 )
+        {
+            SF_DEBUG_WARNING(1, "Soft::NullHAL::InitHAL - FramebufferSize must be specified.");
+            return false;
+        }
+
+        // The default target has no storage; nothing is ever drawn into it.
+        Ptr<RenderTarget> ptarget = *SF_HEAP_AUTO_NEW(this) RenderTarget(0, RBuffer_Default, rtSize );
+        if (!SetRenderTarget(ptarget))
+            return false;
+    }
+
+    return pRenderBufferManager->Initialize(pTextureManager, Image_R8G8B8A8, rtSize );
+}
+
+//--------------------------------------------------------------------
+// *** Filters
+//--------------------------------------------------------------------
+
+void NullHAL::PushFilters(FilterPrimitive* prim)
+{
+    if (!checkState(HS_InDisplay, __FUNCTION__))
+        return;
+
+    // shouldRenderFilters always fails, so PopFilters just removes the entry.
+    FilterStackEntry e = {prim, 0};
+    FilterStack.PushBack(e);
+    CurrentFrame.Filters++;
+    ++AccumulatedStats.Filters;
+}
+
+}}} // Scaleform::Render::Soft
@@ -0,0 +1,200 @@
+/**************************************************************************
+
+Filename    :   Soft_NullHAL.h
+Content     :   Recording Renderer HAL that discards all drawing.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_Soft_NullHAL_H
+#define INC_SF_Render_Soft_NullHAL_H
+
+#include "Render/Soft/Soft_HAL.h"
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+// NullFrameStats holds the counters recorded by NullHAL for one frame.
+struct NullFrameStats
+{
+    unsigned Primitives;        // Primitives and complex meshes submitted by the renderer.
+    unsigned Batches;           // Draw calls a hardware HAL would have issued for them.
+    unsigned Meshes;            // Meshes drawn, including all instances of complex meshes.
+    unsigned Triangles;         // Triangles in all batches.
+    unsigned Masks;
+    unsigned Filters;
+    unsigned RTChanges;
+    unsigned MeshCacheHits;     // Batches drawn from cache items generated in an earlier frame.
+    unsigned MeshCacheMisses;   // Cache items generated in this frame.
+    UPInt    VertexBytes;       // Vertex data written into the mesh cache.
+    UPInt    IndexBytes;        // Index data written into the mesh cache.
+
+    NullFrameStats() { Clear(); }
+
+    void Clear()
+    {
+        Primitives = Batches = Meshes = Triangles = Masks = Filters = RTChanges = 0;
+        MeshCacheHits = MeshCacheMisses = 0;
+        VertexBytes = IndexBytes = 0;
+    }
+};
+
+// NullMeshCache is a system memory mesh cache that records how much data is
+// generated into it. Unlike Soft::MeshCache it keeps the default batching and
+// instancing parameters, so primitives are split into the same batches as on
+// the hardware HALs.
+
+class NullMeshCache : public SimpleMeshCache
+{
+public:
+    NullMeshCache(MemoryHeap* pheap, const MeshCacheParams& params, RenderSync* rsync);
+    ~NullMeshCache();
+
+    // Initializes MeshCache for operation, including allocation of the reserve
+    // buffer. Typically called from InitHAL.
+    bool            Initialize();
+    void            Reset();
+
+    virtual bool    SetParams(const MeshCacheParams& params);
+    virtual void    BeginFrame();
+
+    virtual UPInt   Evict(Render::MeshCacheItem* p, AllocAddr* pallocator = 0, MeshBase* pmesh = 0);
+
+    virtual AllocResult AllocCacheItem(Render::MeshCacheItem** pdata,
+        UByte** pvertexDataStart, IndexType** pindexDataStart,
+        MeshCacheItem::MeshType meshType,
+        MeshCacheItem::MeshBaseContent &mc,
+        UPInt vertexBufferSize,
+        unsigned vertexCount, unsigned indexCount,
+        bool waitForCache,
+        const VertexFormat* pDestFormat);
+
+    virtual bool    PreparePrimitive(PrimitiveBatch* pbatch, MeshCacheItem::MeshContent &mc, bool waitForCache);
+
+    // Sets the counters misses and generated bytes are recorded into.
+    void            SetStats(NullFrameStats* pstats) { pStats = pstats; }
+    // Returns true if the item was generated since the last BeginFrame.
+    bool            IsNewItem(Render::MeshCacheItem* p) const { return NewItems.Get(p) != 0; }
+
+protected:
+    virtual SimpleMeshBuffer* createHWBuffer(UPInt size, AllocType atype, unsigned arena);
+    virtual void              destroyHWBuffer(SimpleMeshBuffer* pbuffer);
+
+    void            recordMiss(Render::MeshCacheItem* p, UPInt vertexBytes, UPInt indexBytes);
+
+    NullFrameStats*     pStats;
+    CacheItemHashType   NewItems;
+};
+
+// NullHAL runs the complete renderer front end - tree and primitive processing,
+// batching, mesh generation and caching, texture creation - but discards every
+// draw call, recording per-frame counters instead. It is intended for measuring
+// the CPU cost of rendering in isolation from any graphics API or driver.
+//
+// Textures are created by Soft::TextureManager in system memory; filters are
+// counted but not applied, so filtered content is drawn unfiltered.
+
+class NullHAL : public Render::HAL
+{
+public:
+    RenderSync           RSync;
+    NullMeshCache        Cache;
+    Ptr<TextureManager>  pTextureManager;
+
+    // Size of the default render target created in InitHAL.
+    ImageSize            FramebufferSize;
+
+    // Self-accessor used to avoid constructor warning.
+    NullHAL*  GetHAL() { return this; }
+
+public:
+
+    NullHAL(ThreadCommandQueue* commandQueue = 0);
+    virtual ~NullHAL();
+
+    // *** HAL Initialization and Shutdown
+
+    // Initializes HAL for rendering; RasterThreads in params is ignored.
+    virtual bool        InitHAL(const Soft::HALInitParams& params);
+
+    // ShutdownHAL shuts down rendering, releasing resources allocated in InitHAL.
+    virtual bool        ShutdownHAL();
+
+    // *** Rendering
+
+    virtual bool        BeginFrame();
+    virtual void        EndFrame();
+
+    virtual void        updateViewport();
+
+    virtual void        DrawProcessedPrimitive(Primitive* pprimitive,
+                                               PrimitiveBatch* pstart, PrimitiveBatch *pend);
+
+    virtual void        DrawProcessedComplexMeshes(ComplexMesh* p,
+                                                   const StrideArray<HMatrix>& matrices);
+
+    // *** Mask Support
+    virtual void    PushMask_BeginSubmit(MaskPrimitive* primitive);
+    virtual void    EndMaskSubmit();
+    virtual void    PopMask();
+
+    virtual void    clearSolidRectangle(const Rect<int>& r, Color color);
+
+    // *** BlendMode
+    virtual void       applyBlendModeImpl(BlendMode mode, bool sourceAc = false, bool forceAc = false);
+
+    virtual Render::TextureManager* GetTextureManager() const
+    {
+        return pTextureManager.GetPtr();
+    }
+
+    virtual RenderTarget*   CreateRenderTarget(Render::Texture* texture, bool needsStencil);
+    virtual RenderTarget*   CreateTempRenderTarget(const ImageSize& size, bool needsStencil);
+    virtual bool            SetRenderTarget(RenderTarget* target, bool setState = 1);
+    virtual void            PushRenderTarget(const RectF& frameRect, RenderTarget* prt, unsigned flags=0);
+    virtual void            PopRenderTarget(unsigned flags = 0);
+
+    virtual bool            createDefaultRenderBuffer();
+
+    // *** Filters
+    virtual void          PushFilters(FilterPrimitive* primitive);
+
+    virtual Render::MeshCache&     GetMeshCache()        { return Cache; }
+    virtual Render::RenderSync*    GetRenderSync() const { return const_cast<RenderSync*>(&RSync); }
+
+    virtual float         GetViewportScaling() const { return 1.0f; }
+
+    virtual void    MapVertexFormat(PrimitiveFillType fill, const VertexFormat* sourceFormat,
+                                    const VertexFormat** single,
+                                    const VertexFormat** batch, const VertexFormat** instanced,
+                                    unsigned meshType = MeshCacheItem::Mesh_Regular);
+
+    // *** Recorded statistics
+
+    // Counters of the frame in progress; cleared by BeginFrame.
+    const NullFrameStats&   GetCurrentFrameStats() const { return CurrentFrame; }
+    // Counters of the last frame completed by EndFrame.
+    const NullFrameStats&   GetFrameStats() const        { return LastFrame; }
+
+protected:
+
+    virtual bool        shouldRenderFilters(const FilterPrimitive*) const { return false; }
+    virtual void        drawScreenQuad();
+
+    // Counts a mesh cache hit unless the item was generated in this frame, and
+    // marks the item as used.
+    void                recordCacheUse(Render::MeshCacheItem* pmesh);
+
+    NullFrameStats       CurrentFrame;
+    NullFrameStats       LastFrame;
+};
+
+}}} // Scaleform::Render::Soft
+
+#endif
@@ -0,0 +1,710 @@
+/**************************************************************************
+
+Filename    :   Soft_RasterQueue.cpp
+Content     :   Tile based triangle rasterizer used by the software HAL.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Render/Soft/Soft_RasterQueue.h"
+#include "Kernel/SF_Alg.h"
+#include "Kernel/SF_Math.h"
+#include "Kernel/SF_HeapNew.h"
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+static const float InvByte = 1.0f / 255.0f;
+
+static inline float mixf(float a, float b, float t)
+{
+    return a + (b - a) * t;
+}
+
+static inline float signf(float v)
+{
+    return (v > 0.0f) ? 1.0f : ((v < 0.0f) ? -1.0f : 0.0f);
+}
+
+static inline float fractf(float v)
+{
+    return v - floorf(v);
+}
+
+static inline float saturate(float v)
+{
+    return (v < 0.0f) ? 0.0f : ((v > 1.0f) ? 1.0f : v);
+}
+
+static inline UByte toByte(float v)
+{
+    return (UByte)(saturate(v) * 255.0f + 0.5f);
+}
+
+
+//------------------------------------------------------------------------
+// ***** RasterSampler
+
+inline void RasterSampler::fetch(int x, int y, float* out) const
+{
+    if (Clamp)
+    {
+        x = Alg::Clamp(x, 0, Width - 1);
+        y = Alg::Clamp(y, 0, Height - 1);
+    }
+    else
+    {
+        x %= Width;  if (x < 0) x += Width;
+        y %= Height; if (y < 0) y += Height;
+    }
+
+    const UByte* p = pData + y * Pitch + x * BytesPerPixel;
+    if (BytesPerPixel == 1)
+    {
+        // Alpha-only textures sample as (0,0,0,a), like Image_A8 on the GPU.
+        out[0] = out[1] = out[2] = 0.0f;
+        out[3] = p[0] * InvByte;
+    }
+    else
+    {
+        out[0] = p[0] * InvByte;
+        out[1] = p[1] * InvByte;
+        out[2] = p[2] * InvByte;
+        out[3] = p[3] * InvByte;
+    }
+}
+
+void RasterSampler::Sample(float u, float v, float* out) const
+{
+    if (!pData || Width <= 0 || Height <= 0)
+    {
+        out[0] = out[1] = out[2] = out[3] = 0.0f;
+        return;
+    }
+
+    float x = u * (float)Width;
+    float y = v * (float)Height;
+
+    if (!Linear)
+    {
+        fetch((int)floorf(x), (int)floorf(y), out);
+        return;
+    }
+
+    // Bilinear filtering; texel centers are at half-integer coordinates.
+    x -= 0.5f;
+    y -= 0.5f;
+    float fx = floorf(x), fy = floorf(y);
+    float tx = x - fx,    ty = y - fy;
+    int   ix = (int)fx,   iy = (int)fy;
+
+    float c00[4], c10[4], c01[4], c11[4];
+    fetch(ix,     iy,     c00);
+    fetch(ix + 1, iy,     c10);
+    fetch(ix,     iy + 1, c01);
+    fetch(ix + 1, iy + 1, c11);
+    for (unsigned i = 0; i < 4; ++i)
+        out[i] = mixf(mixf(c00[i], c10[i], tx), mixf(c01[i], c11[i], tx), ty);
+}
+
+
+//------------------------------------------------------------------------
+// ***** RasterState
+
+RasterState::RasterState()
+: Fill(RasterFill_Solid), Flags(0),
+  BlendEnable(false), BlendOp(RasterBlend_Add),
+  SrcColor(RasterFactor_One), DestColor(RasterFactor_Zero),
+  SrcAlpha(RasterFactor_One), DestAlpha(RasterFactor_Zero),
+  ColorWrite(true),
+  StencilEnable(false), StencilFunc(RasterStencil_Always), StencilOp(RasterStencil_Keep), StencilRef(0),
+  Clip(0, 0, 0, 0)
+{
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        SolidColor[i] = 0.0f;
+        CxMul[i]      = 1.0f;
+        CxAdd[i]      = 0.0f;
+    }
+    memset(Matrix, 0, sizeof(Matrix));
+}
+
+
+//------------------------------------------------------------------------
+// ***** Pixel pipeline
+
+// Computes the fragment color of a fill; equivalent to the fragment shaders
+// selected by StaticShaderForFill and the DrawableImage shaders. duv holds
+// the screen space derivatives of the UV0 pair, (du/dx, dv/dx, du/dy, dv/dy).
+static void shadePixel(const RasterState& s, const float* attr, const float* duv, float* c)
+{
+    float t0[4], t1[4];
+
+    switch(s.Fill)
+    {
+    case RasterFill_Solid:
+        c[0] = s.SolidColor[0]; c[1] = s.SolidColor[1];
+        c[2] = s.SolidColor[2]; c[3] = s.SolidColor[3];
+        break;
+
+    case RasterFill_VColor:
+        for (unsigned i = 0; i < 4; ++i)
+            c[i] = attr[RasterAttr_Color + i];
+        break;
+
+    case RasterFill_Texture:
+        s.Samplers[0].Sample(attr[RasterAttr_UV0], attr[RasterAttr_UV0+1], c);
+        break;
+
+    case RasterFill_TextureVColor:
+        s.Samplers[0].Sample(attr[RasterAttr_UV0], attr[RasterAttr_UV0+1], t0);
+        for (unsigned i = 0; i < 4; ++i)
+            c[i] = mixf(attr[RasterAttr_Color + i], t0[i], attr[RasterAttr_Weight]);
+        break;
+
+    case RasterFill_2Texture:
+        s.Samplers[0].Sample(attr[RasterAttr_UV0], attr[RasterAttr_UV0+1], t0);
+        s.Samplers[1].Sample(attr[RasterAttr_UV1], attr[RasterAttr_UV1+1], t1);
+        for (unsigned i = 0; i < 4; ++i)
+            c[i] = mixf(t1[i], t0[i], attr[RasterAttr_Weight]);
+        break;
+
+    case RasterFill_TextureAlphaVColor:
+        s.Samplers[0].Sample(attr[RasterAttr_UV0], attr[RasterAttr_UV0+1], t0);
+        for (unsigned i = 0; i < 4; ++i)
+            c[i] = attr[RasterAttr_Color + i];
+        c[3] *= t0[3];
+        break;
+
+    case RasterFill_TextureDFAlphaVColor:
+        {
+            // The outline is at 0.5 in the field. Like the distance field 
+            // shader, the edge is smoothed over the change of the field 
+            // across one pixel (fwidth), here from forward differences.
+            float u = attr[RasterAttr_UV0], v = attr[RasterAttr_UV0+1];
+            s.Samplers[0].Sample(u, v, t0);
+            s.Samplers[0].Sample(u + duv[0], v + duv[1], t1);
+            float dist  = t0[3];
+            float width = fabsf(t1[3] - dist);
+            s.Samplers[0].Sample(u + duv[2], v + duv[3], t1);
+            width = Alg::Max(width + fabsf(t1[3] - dist), InvByte);
+            float a = Alg::Clamp((dist - 0.5f) / width + 0.5f, 0.0f, 1.0f);
+            for (unsigned i = 0; i < 4; ++i)
+                c[i] = attr[RasterAttr_Color + i];
+            c[3] *= a * a * (3.0f - 2.0f * a);
+        }
+        break;
+
+    case RasterFill_CopyPixels:
+        {
+            // Sampler 0 is the original destination content, sampler 1 the source.
+            s.Samplers[0].Sample(attr[RasterAttr_UV0], attr[RasterAttr_UV0+1], t0);
+            s.Samplers[1].Sample(attr[RasterAttr_UV1], attr[RasterAttr_UV1+1], t1);
+            float inAlpha = t1[3];
+            if (s.Flags & RasterFlag_AlphaTexture)
+            {
+                float alp[4];
+                s.Samplers[2].Sample(attr[RasterAttr_UV2], attr[RasterAttr_UV2+1], alp);
+                inAlpha *= alp[3];
+            }
+            if (s.Flags & RasterFlag_NoDestAlpha)
+                c[3] = 1.0f;
+            else if (s.Flags & RasterFlag_MergeAlpha)
+                c[3] = mixf(inAlpha, 1.0f, t0[3]);
+            else
+                c[3] = inAlpha;
+            float k = (c[3] > 0.0f) ? (inAlpha / c[3]) : 0.0f;
+            for (unsigned i = 0; i < 3; ++i)
+                c[i] = mixf(t0[i], t1[i], k);
+        }
+        break;
+
+    case RasterFill_Merge:
+        s.Samplers[0].Sample(attr[RasterAttr_UV0], attr[RasterAttr_UV0+1], t0);
+        s.Samplers[1].Sample(attr[RasterAttr_UV1], attr[RasterAttr_UV1+1], t1);
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            const float* m0 = &s.Matrix[0][j*4];
+            const float* m1 = &s.Matrix[1][j*4];
+            c[j] = t0[0]*m0[0] + t0[1]*m0[1] + t0[2]*m0[2] + t0[3]*m0[3] +
+                   t1[0]*m1[0] + t1[1]*m1[1] + t1[2]*m1[2] + t1[3]*m1[3];
+        }
+        break;
+
+    case RasterFill_Compare:
+        {
+            s.Samplers[0].Sample(attr[RasterAttr_UV0], attr[RasterAttr_UV0+1], t0);
+            s.Samplers[1].Sample(attr[RasterAttr_UV1], attr[RasterAttr_UV1+1], t1);
+            float wrapDiff[4];
+            for (unsigned i = 0; i < 4; ++i)
+            {
+                float diff     = t0[i] - t1[i];
+                float ltZero   = (signf(diff) + 1.0f) * -0.25f;
+                float partDiff = InvByte * (signf(ltZero) + 1.0f);
+                wrapDiff[i]    = fractf(diff + 1.0f) + partDiff;
+            }
+            float rgbdiff = signf(wrapDiff[0] + wrapDiff[1] + wrapDiff[2]);
+            c[0] = mixf(1.0f, wrapDiff[0], rgbdiff);
+            c[1] = mixf(1.0f, wrapDiff[1], rgbdiff);
+            c[2] = mixf(1.0f, wrapDiff[2], rgbdiff);
+            c[3] = mixf(wrapDiff[3], 1.0f, rgbdiff);
+        }
+        break;
+
+    case RasterFill_PaletteMap:
+        {
+            // Sampler 1 holds the 256x4 palette, one row per channel.
+            s.Samplers[0].Sample(attr[RasterAttr_UV0], attr[RasterAttr_UV0+1], t0);
+            c[0] = c[1] = c[2] = c[3] = 0.0f;
+            for (unsigned ch = 0; ch < 4; ++ch)
+            {
+                s.Samplers[1].Sample(t0[ch], 0.125f + 0.25f * ch, t1);
+                c[0] += t1[0]; c[1] += t1[1]; c[2] += t1[2]; c[3] += t1[3];
+            }
+        }
+        break;
+    }
+
+    if (s.Flags & RasterFlag_Cxform)
+    {
+        if (s.Flags & RasterFlag_CxformAc)
+        {
+            c[0] *= s.CxMul[0] * s.CxMul[3];
+            c[1] *= s.CxMul[1] * s.CxMul[3];
+            c[2] *= s.CxMul[2] * s.CxMul[3];
+            c[3] *= s.CxMul[3];
+            for (unsigned i = 0; i < 4; ++i)
+                c[i] += s.CxAdd[i] * c[3];
+        }
+        else
+        {
+            for (unsigned i = 0; i < 4; ++i)
+                c[i] = c[i] * s.CxMul[i] + s.CxAdd[i];
+        }
+    }
+
+    if (s.Flags & RasterFlag_EAlpha)
+        c[3] *= attr[RasterAttr_Factor];
+
+    if (s.Flags & RasterFlag_Multiply)
+    {
+        c[0] *= c[3]; c[1] *= c[3]; c[2] *= c[3];
+    }
+    else if (s.Flags & RasterFlag_Invert)
+    {
+        c[0] = c[1] = c[2] = c[3];
+    }
+
+    for (unsigned i = 0; i < 4; ++i)
+        c[i] = saturate(c[i]);
+}
+
+static inline float blendFactor(RasterBlendFactor f, const float* s, const float* d, unsigned i)
+{
+    switch(f)
+    {
+    case RasterFactor_Zero:         return 0.0f;
+    case RasterFactor_One:          return 1.0f;
+    case RasterFactor_SrcAlpha:     return s[3];
+    case RasterFactor_InvSrcAlpha:  return 1.0f - s[3];
+    case RasterFactor_DestColor:    return d[i];
+    case RasterFactor_InvDestColor: return 1.0f - d[i];
+    }
+    return 1.0f;
+}
+
+static inline float blendChannel(RasterBlendOp op, float s, float fs, float d, float fd)
+{
+    switch(op)
+    {
+    case RasterBlend_Max:         return Alg::Max(s, d);
+    case RasterBlend_Min:         return Alg::Min(s, d);
+    case RasterBlend_RevSubtract: return d * fd - s * fs;
+    default:                      return s * fs + d * fd;
+    }
+}
+
+static inline void writePixel(const RasterState& s, const float* c, UByte* pd)
+{
+    if (!s.BlendEnable)
+    {
+        pd[0] = toByte(c[0]); pd[1] = toByte(c[1]);
+        pd[2] = toByte(c[2]); pd[3] = toByte(c[3]);
+        return;
+    }
+
+    float d[4] = { pd[0] * InvByte, pd[1] * InvByte, pd[2] * InvByte, pd[3] * InvByte };
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        float v = blendChannel(s.BlendOp, c[i], blendFactor(s.SrcColor, c, d, i),
+                                          d[i], blendFactor(s.DestColor, c, d, i));
+        pd[i] = toByte(v);
+    }
+    float a = blendChannel(s.BlendOp, c[3], blendFactor(s.SrcAlpha, c, d, 3),
+                                      d[3], blendFactor(s.DestAlpha, c, d, 3));
+    pd[3] = toByte(a);
+}
+
+// Applies the stencil test and operation; returns false if the pixel is rejected.
+static inline bool stencilPixel(const RasterState& s, UByte* ps)
+{
+    UByte value = *ps;
+    bool  pass;
+    switch(s.StencilFunc)
+    {
+    case RasterStencil_Equal:  pass = (s.StencilRef == value); break;
+    case RasterStencil_LEqual: pass = (s.StencilRef <= value); break;
+    default:                   pass = true; break;
+    }
+    if (!pass)
+        return false;
+
+    switch(s.StencilOp)
+    {
+    case RasterStencil_Replace: *ps = s.StencilRef; break;
+    case RasterStencil_Incr:    if (value < 255) *ps = (UByte)(value + 1); break;
+    default: break;
+    }
+    return true;
+}
+
+
+//------------------------------------------------------------------------
+// ***** RasterQueue
+
+RasterQueue::RasterQueue()
+: WorkerPool("Scaleform Soft Rasterizer"), StateDirty(true), TilesX(0), TilesY(0)
+{
+    NextTile = 0;
+}
+
+RasterQueue::~RasterQueue()
+{
+    Shutdown();
+}
+
+void RasterQueue::Initialize(unsigned threadCount)
+{
+    StartWorkers(threadCount);
+}
+
+void RasterQueue::Shutdown()
+{
+    releaseCommands();
+    StopWorkers();
+}
+
+void RasterQueue::SetTarget(const RasterTarget& target)
+{
+    if (target.pColor == Target.pColor && target.pStencil == Target.pStencil &&
+        target.Width == Target.Width && target.Height == Target.Height)
+        return;
+    Flush();
+    Target = target;
+}
+
+void RasterQueue::SetState(const RasterState& state, Texture** ptextures, unsigned textureCount)
+{
+    CurrentState = state;
+    StateDirty   = true;
+    for (unsigned i = 0; i < textureCount; ++i)
+    {
+        if (ptextures[i])
+            TextureRefs.PushBack(ptextures[i]);
+    }
+}
+
+void RasterQueue::AddTriangles(const RasterVertex* pvertices, unsigned triangleCount)
+{
+    if (!triangleCount)
+        return;
+
+    if (StateDirty)
+    {
+        States.PushBack(CurrentState);
+        StateDirty = false;
+    }
+
+    unsigned stateIndex  = (unsigned)States.GetSize() - 1;
+    unsigned firstVertex = (unsigned)Vertices.GetSize();
+    Vertices.Append(pvertices, triangleCount * 3);
+
+    // Merge with the previous command if it uses the same state.
+    if (Commands.GetSize() && Commands.Back().Type == Cmd_Triangles &&
+        Commands.Back().StateIndex == stateIndex)
+    {
+        Commands.Back().TriangleCount += triangleCount;
+        return;
+    }
+
+    Command cmd;
+    cmd.Type          = Cmd_Triangles;
+    cmd.StateIndex    = stateIndex;
+    cmd.FirstVertex   = firstVertex;
+    cmd.TriangleCount = triangleCount;
+    cmd.Bounds.Clear();
+    Commands.PushBack(cmd);
+}
+
+void RasterQueue::ClearColor(const Rect<int>& rect, const float* color)
+{
+    Command cmd;
+    cmd.Type          = Cmd_ClearColor;
+    cmd.StateIndex    = 0;
+    cmd.FirstVertex   = 0;
+    cmd.TriangleCount = 0;
+    cmd.Bounds        = rect;
+    for (unsigned i = 0; i < 4; ++i)
+        cmd.Color[i] = toByte(color[i]);
+    Commands.PushBack(cmd);
+}
+
+void RasterQueue::ClearStencil(const Rect<int>& rect, UByte value)
+{
+    Command cmd;
+    cmd.Type          = Cmd_ClearStencil;
+    cmd.StateIndex    = 0;
+    cmd.FirstVertex   = 0;
+    cmd.TriangleCount = 0;
+    cmd.Bounds        = rect;
+    cmd.Color[0]      = value;
+    Commands.PushBack(cmd);
+}
+
+void RasterQueue::releaseCommands()
+{
+    Commands.Clear();
+    Vertices.Clear();
+    Setups.Clear();
+    States.Clear();
+    TextureRefs.Clear();
+    StateDirty = true;
+}
+
+void RasterQueue::setupTriangles()
+{
+    UPInt triangleCount = Vertices.GetSize() / 3;
+    Setups.Resize(triangleCount);
+
+    const float maxCoord = 1.0e6f;
+
+    for (UPInt t = 0; t < triangleCount; ++t)
+    {
+        TriangleSetup&      tri = Setups[t];
+        const RasterVertex* v[3] = { &Vertices[t*3], &Vertices[t*3+1], &Vertices[t*3+2] };
+
+        float area = (v[1]->X - v[0]->X) * (v[2]->Y - v[0]->Y) -
+                     (v[2]->X - v[0]->X) * (v[1]->Y - v[0]->Y);
+        if (!(area > 0.0f || area < 0.0f))
+        {
+            // Degenerate (or NaN) triangles cover no pixels.
+            tri.Bounds.Clear();
+            continue;
+        }
+        if (area < 0.0f)
+        {
+            Alg::Swap(v[1], v[2]);
+            area = -area;
+        }
+
+        // Edge i is opposite to vertex i, so that its function is the (scaled)
+        // barycentric weight of that vertex. Equations are computed from a
+        // canonical endpoint order, which makes the two triangles sharing an
+        // edge evaluate exactly opposite values and never both draw a pixel.
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            const RasterVertex* a = v[(i + 1) % 3];
+            const RasterVertex* b = v[(i + 2) % 3];
+            bool swapped = (a->X > b->X) || (a->X == b->X && a->Y > b->Y);
+            if (swapped)
+                Alg::Swap(a, b);
+
+            float ea = -(b->Y - a->Y);
+            float eb =  (b->X - a->X);
+            float ec =  (b->Y - a->Y) * a->X - (b->X - a->X) * a->Y;
+            if (swapped)
+            {
+                ea = -ea; eb = -eb; ec = -ec;
+            }
+            tri.E[i][0] = ea;
+            tri.E[i][1] = eb;
+            tri.E[i][2] = ec;
+            // Left edges have an inward normal pointing right, top edges pointing down.
+            tri.TopLeft[i] = (ea > 0.0f) || (ea == 0.0f && eb > 0.0f);
+        }
+
+        // Attribute planes: attr(p) = sum(w_i(p) * attr_i) / area.
+        float invArea = 1.0f / area;
+        for (unsigned k = 0; k < RasterAttr_Count; ++k)
+        {
+            for (unsigned j = 0; j < 3; ++j)
+            {
+                tri.DA[k][j] = (tri.E[0][j] * v[0]->A[k] +
+                                tri.E[1][j] * v[1]->A[k] +
+                                tri.E[2][j] * v[2]->A[k]) * invArea;
+            }
+        }
+
+        float minx = Alg::Min(v[0]->X, Alg::Min(v[1]->X, v[2]->X));
+        float maxx = Alg::Max(v[0]->X, Alg::Max(v[1]->X, v[2]->X));
+        float miny = Alg::Min(v[0]->Y, Alg::Min(v[1]->Y, v[2]->Y));
+        float maxy = Alg::Max(v[0]->Y, Alg::Max(v[1]->Y, v[2]->Y));
+        minx = Alg::Clamp(minx, -maxCoord, maxCoord);
+        maxx = Alg::Clamp(maxx, -maxCoord, maxCoord);
+        miny = Alg::Clamp(miny, -maxCoord, maxCoord);
+        maxy = Alg::Clamp(maxy, -maxCoord, maxCoord);
+
+        // Pixel centers are at +0.5.
+        tri.Bounds.x1 = Alg::Max(0,             (int)ceilf(minx - 0.5f));
+        tri.Bounds.y1 = Alg::Max(0,             (int)ceilf(miny - 0.5f));
+        tri.Bounds.x2 = Alg::Min(Target.Width,  (int)floorf(maxx - 0.5f) + 1);
+        tri.Bounds.y2 = Alg::Min(Target.Height, (int)floorf(maxy - 0.5f) + 1);
+        if (tri.Bounds.IsEmpty())
+            tri.Bounds.Clear();
+    }
+}
+
+void RasterQueue::drawTriangle(const TriangleSetup& tri, const RasterState& state, const Rect<int>& area)
+{
+    const bool useStencil = state.StencilEnable && Target.pStencil;
+    float      attr[RasterAttr_Count];
+    float      color[4];
+    const float duv[4] = { tri.DA[RasterAttr_UV0][0], tri.DA[RasterAttr_UV0+1][0],
+                           tri.DA[RasterAttr_UV0][1], tri.DA[RasterAttr_UV0+1][1] };
+
+    for (int y = area.y1; y < area.y2; ++y)
+    {
+        float  py     = (float)y + 0.5f;
+        UByte* pcolor = Target.pColor + y * Target.Pitch + area.x1 * 4;
+        UByte* pstencil = useStencil ? (Target.pStencil + y * Target.StencilPitch + area.x1) : 0;
+
+        for (int x = area.x1; x < area.x2; ++x, pcolor += 4, pstencil += useStencil ? 1 : 0)
+        {
+            float px = (float)x + 0.5f;
+            bool  inside = true;
+            for (unsigned i = 0; i < 3 && inside; ++i)
+            {
+                float w = tri.E[i][0] * px + tri.E[i][1] * py + tri.E[i][2];
+                inside = tri.TopLeft[i] ? (w >= 0.0f) : (w > 0.0f);
+            }
+            if (!inside)
+                continue;
+
+            if (useStencil && !stencilPixel(state, pstencil))
+                continue;
+            if (!state.ColorWrite)
+                continue;
+
+            for (unsigned k = 0; k < RasterAttr_Count; ++k)
+                attr[k] = tri.DA[k][0] * px + tri.DA[k][1] * py + tri.DA[k][2];
+
+            shadePixel(state, attr, duv, color);
+            writePixel(state, color, pcolor);
+        }
+    }
+}
+
+void RasterQueue::processTile(int tileX, int tileY)
+{
+    Rect<int> tile(tileX * TileSize, tileY * TileSize,
+                   Alg::Min((tileX + 1) * TileSize, Target.Width),
+                   Alg::Min((tileY + 1) * TileSize, Target.Height));
+
+    for (UPInt c = 0; c < Commands.GetSize(); ++c)
+    {
+        const Command& cmd = Commands[c];
+        switch(cmd.Type)
+        {
+        case Cmd_Triangles:
+            {
+                const RasterState& state = States[cmd.StateIndex];
+                Rect<int> region(tile);
+                region.Intersect(state.Clip);
+                if (region.IsEmpty())
+                    break;
+
+                const TriangleSetup* ptri = &Setups[cmd.FirstVertex / 3];
+                for (unsigned t = 0; t < cmd.TriangleCount; ++t, ++ptri)
+                {
+                    if (ptri->Bounds.IsEmpty())
+                        continue;
+                    Rect<int> area(region);
+                    area.Intersect(ptri->Bounds);
+                    if (!area.IsEmpty())
+                        drawTriangle(*ptri, state, area);
+                }
+            }
+            break;
+
+        case Cmd_ClearColor:
+            {
+                Rect<int> area(tile);
+                area.Intersect(cmd.Bounds);
+                if (area.IsEmpty())
+                    break;
+                for (int y = area.y1; y < area.y2; ++y)
+                {
+                    UByte* p = Target.pColor + y * Target.Pitch + area.x1 * 4;
+                    for (int x = area.x1; x < area.x2; ++x, p += 4)
+                    {
+                        p[0] = cmd.Color[0]; p[1] = cmd.Color[1];
+                        p[2] = cmd.Color[2]; p[3] = cmd.Color[3];
+                    }
+                }
+            }
+            break;
+
+        case Cmd_ClearStencil:
+            {
+                Rect<int> area(tile);
+                area.Intersect(cmd.Bounds);
+                if (area.IsEmpty() || !Target.pStencil)
+                    break;
+                for (int y = area.y1; y < area.y2; ++y)
+                    memset(Target.pStencil + y * Target.StencilPitch + area.x1, cmd.Color[0], area.x2 - area.x1);
+            }
+            break;
+        }
+    }
+}
+
+void RasterQueue::processTiles()
+{
+    int tileCount = TilesX * TilesY;
+    while(1)
+    {
+        int tile = NextTile.ExchangeAdd_Sync(1);
+        if (tile >= tileCount)
+            break;
+        processTile(tile % TilesX, tile / TilesX);
+    }
+}
+
+void RasterQueue::Flush()
+{
+    if (Commands.GetSize() == 0)
+        return;
+
+    if (Target.pColor && Target.Width > 0 && Target.Height > 0)
+    {
+        setupTriangles();
+        TilesX   = (Target.Width  + TileSize - 1) / TileSize;
+        TilesY   = (Target.Height + TileSize - 1) / TileSize;
+        NextTile = 0;
+
+        if (GetWorkerCount() > 0 && (TilesX * TilesY) > 1)
+            RunParallel();
+        else
+            processTiles();
+    }
+
+    releaseCommands();
+}
+
+}}} // Scaleform::Render::Soft
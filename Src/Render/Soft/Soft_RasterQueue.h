@@ -0,0 +1,258 @@
+/**************************************************************************
+
+Filename    :   Soft_RasterQueue.h
+Content     :   Tile based triangle rasterizer used by the software HAL.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_Soft_RasterQueue_H
+#define INC_SF_Render_Soft_RasterQueue_H
+
+#include "Kernel/SF_Array.h"
+#include "Kernel/SF_Threads.h"
+#include "Kernel/SF_Atomic.h"
+#include "Render/Render_Types2D.h"
+#include "Render/Render_Color.h"
+#include "Render/Render_WorkerPool.h"
+#include "Render/Soft/Soft_Texture.h"
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+// RasterQueue collects triangles, clears and their render state submitted by the
+// HAL for one render target and rasterizes them on Flush. The target is split into
+// tiles, which are processed in parallel by a pool of worker threads (and the
+// calling thread); each tile replays the whole command list in submission order,
+// so the result is identical to rendering serially.
+//
+// Shading follows the hardware HAL shaders: colors are computed in floating point,
+// blended with the same equations as the GPU blend unit and stored as 8-bit RGBA.
+
+
+// Texture sampling description, filled in by the HAL from a Texture and its fill mode.
+struct RasterSampler
+{
+    const UByte*    pData;
+    UPInt           Pitch;
+    int             Width, Height;
+    unsigned        BytesPerPixel;  // 4 for R8G8B8A8, 1 for A8.
+    bool            Clamp;
+    bool            Linear;
+
+    RasterSampler() : pData(0), Pitch(0), Width(0), Height(0), BytesPerPixel(4), Clamp(true), Linear(false) { }
+
+    // Samples the texture at normalized coordinates (u,v), writing RGBA in [0,1].
+    void            Sample(float u, float v, float* out) const;
+
+private:
+    inline void     fetch(int x, int y, float* out) const;
+};
+
+enum RasterFillType
+{
+    RasterFill_Solid,
+    RasterFill_VColor,
+    RasterFill_Texture,
+    RasterFill_TextureVColor,       // mix(vcolor, tex0, weight)
+    RasterFill_2Texture,            // mix(tex1, tex0, weight)
+    RasterFill_TextureAlphaVColor,  // vcolor, alpha modulated by tex0 (text)
+    RasterFill_TextureDFAlphaVColor,// vcolor, alpha from the distance field in tex0
+    RasterFill_CopyPixels,          // DrawableImage fills, see HAL::Drawable*.
+    RasterFill_Merge,
+    RasterFill_Compare,
+    RasterFill_PaletteMap
+};
+
+enum RasterFillFlags
+{
+    RasterFlag_EAlpha       = 0x01,
+    RasterFlag_Cxform       = 0x02,
+    RasterFlag_CxformAc     = 0x04,
+    RasterFlag_Multiply     = 0x08,
+    RasterFlag_Invert       = 0x10,
+    RasterFlag_MergeAlpha   = 0x20,     // CopyPixels variants.
+    RasterFlag_NoDestAlpha  = 0x40,
+    RasterFlag_AlphaTexture = 0x80
+};
+
+enum RasterBlendOp
+{
+    RasterBlend_Add,
+    RasterBlend_Max,
+    RasterBlend_Min,
+    RasterBlend_RevSubtract
+};
+
+enum RasterBlendFactor
+{
+    RasterFactor_Zero,
+    RasterFactor_One,
+    RasterFactor_SrcAlpha,
+    RasterFactor_InvSrcAlpha,
+    RasterFactor_DestColor,
+    RasterFactor_InvDestColor
+};
+
+enum RasterStencilFunc
+{
+    RasterStencil_Always,
+    RasterStencil_Equal,
+    RasterStencil_LEqual
+};
+
+enum RasterStencilOp
+{
+    RasterStencil_Keep,
+    RasterStencil_Replace,
+    RasterStencil_Incr
+};
+
+// Per-vertex interpolated attributes.
+enum RasterAttribute
+{
+    RasterAttr_UV0      = 0,    // UV pairs for up to three textures.
+    RasterAttr_UV1      = 2,
+    RasterAttr_UV2      = 4,
+    RasterAttr_Color    = 6,    // RGBA, normalized.
+    RasterAttr_Factor   = 10,   // EAlpha factor.
+    RasterAttr_Weight   = 11,   // Texture/color blend weight.
+    RasterAttr_Count    = 12
+};
+
+struct RasterVertex
+{
+    float           X, Y;       // Position in target pixels.
+    float           A[RasterAttr_Count];
+};
+
+struct RasterState
+{
+    RasterFillType  Fill;
+    unsigned        Flags;
+    RasterSampler   Samplers[3];
+    float           SolidColor[4];
+    float           CxMul[4], CxAdd[4];
+    float           Matrix[2][16];  // Color matrices for RasterFill_Merge, row major.
+
+    bool            BlendEnable;
+    RasterBlendOp   BlendOp;
+    RasterBlendFactor SrcColor, DestColor, SrcAlpha, DestAlpha;
+    bool            ColorWrite;
+
+    bool            StencilEnable;
+    RasterStencilFunc StencilFunc;
+    RasterStencilOp StencilOp;
+    UByte           StencilRef;
+
+    Rect<int>       Clip;       // Pixels outside of Clip are never touched.
+
+    RasterState();
+};
+
+// Describes the memory the queue renders into; the stencil plane is optional.
+struct RasterTarget
+{
+    UByte*          pColor;
+    UPInt           Pitch;
+    int             Width, Height;
+    UByte*          pStencil;
+    UPInt           StencilPitch;
+
+    RasterTarget() : pColor(0), Pitch(0), Width(0), Height(0), pStencil(0), StencilPitch(0) { }
+};
+
+
+class RasterQueue : public WorkerPool
+{
+public:
+    enum
+    {
+        TileSize = 64
+    };
+
+    RasterQueue();
+    ~RasterQueue();
+
+    // Starts threadCount worker threads, which render tiles along with the
+    // calling thread; 0 picks one fewer than the number of CPUs.
+    void            Initialize(unsigned threadCount = 0);
+    void            Shutdown();
+
+    // Sets the target for the following commands; flushes any pending ones.
+    void            SetTarget(const RasterTarget& target);
+    const RasterTarget& GetTarget() const { return Target; }
+
+    // Makes the given state current for the subsequent AddTriangles calls. Textures
+    // referenced by the samplers are held until the queue is flushed.
+    void            SetState(const RasterState& state, Texture** ptextures = 0, unsigned textureCount = 0);
+    const RasterState& GetState() const { return CurrentState; }
+
+    // Queues triangles; 'pvertices' contains three vertices per triangle.
+    void            AddTriangles(const RasterVertex* pvertices, unsigned triangleCount);
+    void            ClearColor(const Rect<int>& rect, const float* color);
+    void            ClearStencil(const Rect<int>& rect, UByte value);
+
+    bool            IsEmpty() const { return Commands.GetSize() == 0; }
+    // Rasterizes all queued commands into the target.
+    void            Flush();
+
+private:
+    enum CommandType
+    {
+        Cmd_Triangles,
+        Cmd_ClearColor,
+        Cmd_ClearStencil
+    };
+    struct Command
+    {
+        CommandType Type;
+        unsigned    StateIndex;
+        unsigned    FirstVertex;
+        unsigned    TriangleCount;
+        Rect<int>   Bounds;
+        UByte       Color[4];
+    };
+
+    // Triangle setup data, shared by all tiles.
+    struct TriangleSetup
+    {
+        float       E[3][3];        // Edge equations: a*x + b*y + c.
+        bool        TopLeft[3];     // Top-left fill rule: pixels on the edge are included.
+        float       DA[RasterAttr_Count][3]; // Attribute planes.
+        Rect<int>   Bounds;
+    };
+
+    void            processTile(int tileX, int tileY);
+    void            processTiles();
+    virtual void    processParallel() { processTiles(); }
+    void            drawTriangle(const TriangleSetup& tri, const RasterState& state, const Rect<int>& area);
+    void            setupTriangles();
+    void            releaseCommands();
+
+    // Queue arrays are reused every flush, so they never shrink.
+    typedef ArrayConstPolicy<0, 64, true> QueuePolicy;
+
+    RasterTarget            Target;
+    RasterState             CurrentState;
+    bool                    StateDirty;
+
+    ArrayLH<RasterState,   StatRender_Mem, QueuePolicy> States;
+    ArrayLH<RasterVertex,  StatRender_Mem, QueuePolicy> Vertices;
+    ArrayLH<TriangleSetup, StatRender_Mem, QueuePolicy> Setups;
+    ArrayLH<Command,       StatRender_Mem, QueuePolicy> Commands;
+    ArrayLH<Ptr<Texture>,  StatRender_Mem, QueuePolicy> TextureRefs;
+
+    int                     TilesX, TilesY;
+    AtomicInt<int>          NextTile;
+};
+
+}}}; // Scaleform::Render::Soft
+
+#endif
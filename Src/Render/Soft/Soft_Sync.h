@@ -0,0 +1,61 @@
+/**********************************************************************
+
+PublicHeader:   Render
+Filename    :   Soft_Sync.h
+Content     :   Software renderer fencing implementation.
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+***********************************************************************/
+
+#ifndef INC_SF_Soft_Sync_H
+#define INC_SF_Soft_Sync_H
+
+#include "Render/Render_Sync.h"
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+// The software HAL copies vertex data out of the mesh cache into its own
+// raster queue when a primitive is submitted, so mesh cache memory is never
+// referenced after DrawProcessedPrimitive returns. Fences therefore only
+// need to be unique; they are never pending.
+
+class RenderSync : public Render::RenderSync
+{
+public:
+    RenderSync() : CurFence(0) { };
+
+    virtual void    KickOffFences(FenceType waitType)
+    {
+        SF_UNUSED(waitType);
+    }
+
+protected:
+
+    virtual UInt64  SetFence()
+    {
+        return ++CurFence;
+    }
+    virtual bool    IsPending(FenceType waitType, UInt64 handle, const FenceFrame& parent)
+    {
+        SF_UNUSED3(waitType, handle, parent);
+        return false;
+    }
+    virtual void    WaitFence(FenceType waitType, UInt64 handle, const FenceFrame& parent)
+    {
+        SF_UNUSED3(waitType, handle, parent);
+    }
+
+private:
+    UInt64          CurFence;
+};
+
+}}}; // Scaleform::Render::Soft
+
+#endif // INC_SF_Soft_Sync_H
@@ -0,0 +1,399 @@
+/**************************************************************************
+
+Filename    :   Soft_Texture.cpp
+Content     :   Software renderer Texture and TextureManager implementation
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#include "Render/Soft/Soft_Texture.h"
+#include "Render/Soft/Soft_RasterQueue.h"
+#include "Render/Render_TextureUtil.h"
+#include "Kernel/SF_Debug.h"
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+Texture::Texture(TextureManagerLocks* pmanagerLocks, const TextureFormat* pformat,
+                 unsigned mipLevels, const ImageSize& size, unsigned use,
+                 ImageBase* pimage) :
+    Render::Texture(pmanagerLocks, size, (UByte)mipLevels, (UInt16)use, pimage, pformat)
+{
+    TextureCount = (UByte) pformat->GetPlaneCount();
+    if (TextureCount > 1)
+    {
+        pTextures = (HWTextureDesc*)
+            SF_HEAP_AUTO_ALLOC(this, sizeof(HWTextureDesc) * TextureCount);
+    }
+    else
+    {
+        pTextures = &Texture0;
+    }
+    memset(pTextures, 0, sizeof(HWTextureDesc) * TextureCount);
+}
+
+Texture::~Texture()
+{
+    //  pImage must be null, since ImageLost had to be called externally.
+    SF_ASSERT(pImage == 0);
+
+    Mutex::Locker  lock(&pManagerLocks->TextureMutex);
+
+    if ((State == State_Valid) || (State == State_Lost))
+    {
+        // pManagerLocks->pManager should still be valid for these states.
+        SF_ASSERT(pManagerLocks->pManager);
+        RemoveNode();
+        pNext = pPrev = 0;
+    }
+    // Storage is plain memory, so it can be freed from any thread.
+    ReleaseHWTextures();
+
+    if ((pTextures != &Texture0) && pTextures)
+        SF_FREE(pTextures);
+}
+
+bool Texture::Initialize()
+{
+    const TextureFormat::Mapping* pmapping = GetTextureFormatMapping();
+    unsigned itex;
+
+    // Determine how many mipLevels we should have and whether we can
+    // auto-generate them or not.
+    if (Use & ImageUse_GenMipmaps)
+    {
+        SF_ASSERT(MipLevels == 1);
+        TextureFlags |= TF_SWMipGen;
+        MipLevels = (UByte)ImageSize_MipLevelCount(ImgSize);
+    }
+
+    // Create textures
+    for (itex = 0; itex < TextureCount; itex++)
+    {
+        HWTextureDesc& tdesc = pTextures[itex];
+        tdesc.Size    = ImageData::GetFormatPlaneSize(GetImageFormat(), ImgSize, itex);
+        tdesc.Pitch   = tdesc.Size.Width * pmapping->BytesPerPixel;
+        tdesc.TexSize = 0;
+
+        ImagePlane plane(tdesc.Size.Width, tdesc.Size.Height, tdesc.Pitch);
+        for (unsigned level = 0; level < MipLevels; level++)
+        {
+            tdesc.TexSize += plane.Width * pmapping->BytesPerPixel * plane.Height;
+            plane.SetNextMipSize();
+        }
+
+        tdesc.pTexData = (UByte*)SF_HEAP_AUTO_ALLOC(this, tdesc.TexSize);
+        if (!tdesc.pTexData)
+        {
+            SF_DEBUG_ERROR(1, "CreateTexture failed - memory allocation failed");
+            // Texture creation failed, release all textures and fail.
+            ReleaseHWTextures();
+            State = State_InitFailed;
+            return false;
+        }
+
+        // Render targets and RGB sources rely on a defined initial state.
+        memset(tdesc.pTexData, 0, tdesc.TexSize);
+    }
+
+    // Upload image content to texture, if any.
+    if (pImage && !Render::Texture::Update())
+    {
+        SF_DEBUG_ERROR(1, "CreateTexture failed - couldn't initialize texture");
+        ReleaseHWTextures();
+        State = State_InitFailed;
+        return false;
+    }
+
+    State = State_Valid;
+    return Render::Texture::Initialize();
+}
+
+void Texture::computeUpdateConvertRescaleFlags( bool rescale, bool swMipGen, ImageFormat format,
+                                                ImageRescaleType &rescaleType, ImageFormat &rescaleBuffFromat, bool &convert )
+{
+    const TextureFormat::Mapping* pmapping = GetTextureFormatMapping();
+    rescaleBuffFromat = pmapping->StorageFormat;
+    rescaleType = ResizeNone;
+
+    // Software textures never need to be resized to a power of two.
+    SF_UNUSED(rescale);
+
+    if (swMipGen && !(format == Image_R8G8B8A8 || format == Image_A8))
+        convert = true;
+}
+
+void Texture::ReleaseHWTextures(bool)
+{
+    Render::Texture::ReleaseHWTextures();
+
+    for (unsigned itex = 0; itex < TextureCount; itex++)
+    {
+        if (pTextures[itex].pTexData)
+            SF_FREE(pTextures[itex].pTexData);
+        pTextures[itex].pTexData = 0;
+        pTextures[itex].TexSize  = 0;
+    }
+}
+
+void Texture::ApplyTexture(unsigned stage, const ImageFillMode& fillMode)
+{
+    // Nothing to bind; the raster queue samples storage directly.
+    Render::Texture::ApplyTexture(stage, fillMode);
+}
+
+void Texture::GetPlane(ImagePlane* pplane, unsigned level) const
+{
+    const HWTextureDesc& tdesc = pTextures[0];
+    unsigned             bpp   = GetTextureFormatMapping()->BytesPerPixel;
+    ImagePlane           plane(tdesc.Size.Width, tdesc.Size.Height, tdesc.Pitch);
+    UByte*               pdata = tdesc.pTexData;
+
+    for (unsigned i = 0; i < level; i++)
+    {
+        pdata += plane.Pitch * plane.Height;
+        plane.SetNextMipSize();
+        plane.Pitch = plane.Width * bpp;
+    }
+    plane.pData    = pdata;
+    plane.DataSize = plane.Pitch * plane.Height;
+    *pplane = plane;
+}
+
+bool    Texture::Update(const UpdateDesc* updates, unsigned count, unsigned mipLevel)
+{
+    const TextureFormat::Mapping* pmapping = GetTextureFormatMapping();
+    if (!pmapping || !pTextures[0].pTexData)
+        return false;
+
+    if (GetManager())
+        GetManager()->FlushRasterQueue();
+
+    ImagePlane  dplane;
+    GetPlane(&dplane, mipLevel);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        const UpdateDesc &desc = updates[i];
+        ImagePlane        splane(desc.SourcePlane);
+        UPInt             width = (UPInt)desc.DestRect.Width();
+
+        SF_ASSERT(desc.DestRect.x2 <= dplane.Width && desc.DestRect.y2 <= dplane.Height);
+
+        UByte* pdest = dplane.pData + desc.DestRect.y1 * dplane.Pitch +
+                       desc.DestRect.x1 * pmapping->BytesPerPixel;
+
+        for (unsigned y = 0; y < (unsigned)desc.DestRect.Height(); y++, pdest += dplane.Pitch)
+            pmapping->CopyFunc(pdest, splane.GetScanline(y), width, 0, 0);
+    }
+    return true;
+}
+
+UPInt Texture::GetBytes(int* memRegion) const
+{
+    if (memRegion)
+        *memRegion = 0;
+    UPInt size = 0;
+    for (int i = 0; i < TextureCount; i++)
+        size += pTextures[i].TexSize;
+    return size;
+}
+
+#ifdef SF_AMP_SERVER
+bool Texture::Copy(ImageData* pdata)
+{
+    Image::CopyScanlineFunc puncopyFunc = pFormat->GetScanlineUncopyFn();
+    if ( !GetManager() || pFormat->GetImageFormat() != pdata->Format || !puncopyFunc)
+        return false;
+
+    for (unsigned mip = 0; mip < GetMipmapCount() && mip < pdata->GetMipLevelCount(); mip++)
+    {
+        ImagePlane splane, dplane;
+        GetPlane(&splane, mip);
+        pdata->GetMipLevelPlane(mip, 0, &dplane);
+        ConvertImagePlane(dplane, splane, GetFormat(), 0, puncopyFunc, 0);
+    }
+    return true;
+}
+#endif // SF_AMP_SERVER
+
+
+// ***** DepthStencilSurface
+
+DepthStencilSurface::DepthStencilSurface(TextureManagerLocks* pmanagerLocks, const ImageSize& size) :
+    Render::DepthStencilSurface(pmanagerLocks, size), pStencil(0), Pitch(size.Width)
+{
+}
+
+DepthStencilSurface::~DepthStencilSurface()
+{
+    if (pStencil)
+        SF_FREE(pStencil);
+}
+
+bool DepthStencilSurface::Initialize()
+{
+    Pitch    = (Size.Width + 15) & ~15;
+    pStencil = (UByte*)SF_HEAP_AUTO_ALLOC(this, Pitch * Size.Height);
+    if (!pStencil)
+    {
+        State = Texture::State_InitFailed;
+        return false;
+    }
+    memset(pStencil, 0, Pitch * Size.Height);
+    State = Texture::State_Valid;
+    return true;
+}
+
+
+// ***** MappedTexture
+
+bool MappedTexture::Map(Render::Texture* ptexture, unsigned mipLevel, unsigned levelCount)
+{
+    SF_ASSERT(!IsMapped());
+    SF_ASSERT((mipLevel + levelCount) <= ptexture->MipLevels);
+
+    // Initialize Data as efficiently as possible.
+    if (levelCount <= PlaneReserveSize)
+        Data.Initialize(ptexture->GetImageFormat(), levelCount, Planes, ptexture->GetPlaneCount(), true);
+    else if (!Data.Initialize(ptexture->GetImageFormat(), levelCount, true))
+        return false;
+
+    Texture* softTexture = reinterpret_cast<Texture*>(ptexture);
+    if (!softTexture->pTextures[0].pTexData)
+        return false;
+    if (softTexture->GetManager())
+        softTexture->GetManager()->FlushRasterQueue();
+
+    pTexture      = ptexture;
+    StartMipLevel = mipLevel;
+    LevelCount    = levelCount;
+
+    for (unsigned level = 0; level < levelCount; level++)
+    {
+        ImagePlane plane;
+        softTexture->GetPlane(&plane, StartMipLevel + level);
+        Data.SetPlane(level, plane);
+    }
+
+    pTexture->pMap = this;
+    return true;
+}
+
+
+// ***** TextureManager
+
+TextureManager::TextureManager(ThreadId renderThreadId, ThreadCommandQueue* commandQueue,
+                               TextureCache* texCache) :
+    Render::TextureManager(renderThreadId, commandQueue, texCache),
+    pRasterQueue(0)
+{
+    initTextureFormats();
+}
+
+TextureManager::~TextureManager()
+{
+    Mutex::Locker lock(&pLocks->TextureMutex);
+
+    // Notify all textures
+    while (!Textures.IsEmpty())
+        Textures.GetFirst()->LoseManager();
+
+    pLocks->pManager = 0;
+}
+
+// ***** Software Format mapping and conversion functions
+
+static TextureFormat::Mapping TextureFormatMapping[] =
+{
+    { Image_R8G8B8A8,   Image_R8G8B8A8, 4, &Image::CopyScanlineDefault,           &Image::CopyScanlineDefault },
+    { Image_B8G8R8A8,   Image_R8G8B8A8, 4, &Image_CopyScanline32_SwapBR,          &Image_CopyScanline32_SwapBR },
+    { Image_R8G8B8,     Image_R8G8B8A8, 4, &Image_CopyScanline24_Extend_RGB_RGBA, &Image_CopyScanline32_Retract_RGBA_RGB },
+    { Image_B8G8R8,     Image_R8G8B8A8, 4, &Image_CopyScanline24_Extend_RGB_BGRA, &Image_CopyScanline32_Retract_BGRA_RGB },
+    { Image_A8,         Image_A8,       1, &Image::CopyScanlineDefault,           &Image::CopyScanlineDefault },
+
+    { Image_None,       Image_None,     0, 0, 0 }
+};
+
+void TextureManager::initTextureFormats()
+{
+    TextureFormat::Mapping* pmapping;
+    for (pmapping = TextureFormatMapping; pmapping->Format != Image_None; pmapping++)
+    {
+        TextureFormat* tf = SF_HEAP_AUTO_NEW(this) TextureFormat(pmapping);
+        TextureFormats.PushBack(tf);
+    }
+}
+
+void TextureManager::processInitTextures()
+{
+    // TextureMutex lock expected externally.
+    if (!TextureInitQueue.IsEmpty())
+    {
+        while (!TextureInitQueue.IsEmpty())
+        {
+            Render::Texture* ptexture = TextureInitQueue.GetFirst();
+            ptexture->RemoveNode();
+            ptexture->pPrev = ptexture->pNext = 0;
+            if (ptexture->Initialize())
+                Textures.PushBack(ptexture);
+        }
+        pLocks->TextureInitWC.NotifyAll();
+    }
+}
+
+Render::Texture* TextureManager::CreateTexture(ImageFormat format, unsigned mipLevels,
+                                               const ImageSize& size,
+                                               unsigned use, ImageBase* pimage,
+                                               Render::MemoryManager* allocManager)
+{
+    SF_UNUSED(allocManager);
+
+    TextureFormat* ptformat = (TextureFormat*)precreateTexture(format, use, pimage);
+    if ( !ptformat )
+        return 0;
+
+    Texture* ptexture =
+        SF_HEAP_AUTO_NEW(this) Texture(pLocks, ptformat, mipLevels, size, use, pimage);
+
+    return postCreateTexture(ptexture, use);
+}
+
+Render::DepthStencilSurface* TextureManager::CreateDepthStencilSurface(const ImageSize& size,
+                                                                       Render::MemoryManager* manager)
+{
+    SF_UNUSED(manager);
+    DepthStencilSurface* pdss = SF_HEAP_AUTO_NEW(this) DepthStencilSurface(pLocks, size);
+    if (pdss && !pdss->Initialize())
+    {
+        pdss->Release();
+        return 0;
+    }
+    return pdss;
+}
+
+void TextureManager::FlushRasterQueue()
+{
+    if (pRasterQueue)
+        pRasterQueue->Flush();
+}
+
+unsigned TextureManager::GetTextureUseCaps(ImageFormat format)
+{
+    // ImageUse_InitOnly is ok since storage is never lost.
+    unsigned use = ImageUse_InitOnly | ImageUse_Update | ImageUse_PartialUpdate |
+                   ImageUse_GenMipmaps | ImageUse_MapRenderThread;
+
+    const Render::TextureFormat* ptformat = getTextureFormat(format);
+    if (!ptformat)
+        return 0;
+    return use;
+}
+
+}}};  // namespace Scaleform::Render::Soft
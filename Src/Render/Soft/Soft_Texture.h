@@ -0,0 +1,188 @@
+/**************************************************************************
+
+Filename    :   Soft_Texture.h
+Content     :   Software renderer Texture and TextureManager header
+Created     :
+Authors     :
+
+Copyright   :   Copyright 2011 Autodesk, Inc. All Rights reserved.
+
+Use of this software is subject to the terms of the Autodesk license
+agreement provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+**************************************************************************/
+
+#ifndef INC_SF_Render_Soft_Texture_H
+#define INC_SF_Render_Soft_Texture_H
+
+#include "Kernel/SF_List.h"
+#include "Kernel/SF_Threads.h"
+#include "Render/Render_Image.h"
+#include "Kernel/SF_HeapNew.h"
+
+namespace Scaleform { namespace Render { namespace Soft {
+
+
+// TextureFormat describes format of the texture and its caps.
+// Format includes allowed usage capabilities and ImageFormat
+// from which texture is supposed to be initialized.
+//
+// Software textures are always stored either as R8G8B8A8 or A8 in
+// system memory; the mapping CopyFunc converts source scanlines
+// into the storage format.
+
+struct TextureFormat : public Render::TextureFormat
+{
+    struct Mapping
+    {
+        ImageFormat              Format;
+        ImageFormat              StorageFormat;
+        UByte                    BytesPerPixel;
+        Image::CopyScanlineFunc  CopyFunc;
+        Image::CopyScanlineFunc  UncopyFunc;
+    };
+
+    const Mapping*  pMapping;
+
+    TextureFormat(const Mapping* pmapping = 0) : pMapping(pmapping) { }
+
+    virtual ImageFormat             GetImageFormat() const      { return pMapping->Format; }
+    virtual Image::CopyScanlineFunc GetScanlineCopyFn() const   { return pMapping->CopyFunc; }
+    virtual Image::CopyScanlineFunc GetScanlineUncopyFn() const { return pMapping->UncopyFunc; }
+};
+
+class MappedTexture;
+class TextureManager;
+class RasterQueue;
+
+
+// Software Texture class implementation. All levels of a texture are kept in
+// a single system memory block owned by the texture; the raster queue reads
+// them directly.
+
+class Texture : public Render::Texture
+{
+public:
+    struct HWTextureDesc
+    {
+        ImageSize           Size;
+        UPInt               Pitch;      // Pitch of the top level, in bytes.
+        UPInt               TexSize;    // Total allocation size of all levels.
+        UByte*              pTexData;
+    };
+
+    // TextureDesc array is allocated if more then one is needed.
+    HWTextureDesc*          pTextures;
+    HWTextureDesc           Texture0;
+
+    Texture(TextureManagerLocks* pmanagerLocks, const TextureFormat* pformat, unsigned mipLevels,
+            const ImageSize& size, unsigned use, ImageBase* pimage);
+    ~Texture();
+
+    TextureManager*         GetManager() const     { return (TextureManager*)pManagerLocks->pManager; }
+    bool                    IsValid() const        { return pTextures != 0; }
+
+    bool                    Initialize();
+    void                    ReleaseHWTextures(bool staging = true);
+    virtual void            ApplyTexture(unsigned stage, const ImageFillMode& fillMode);
+
+    // Returns a plane describing the top mip level of the storage.
+    void                    GetPlane(ImagePlane* pplane, unsigned level = 0) const;
+    // Returns 4 for RGBA textures, 1 for alpha-only textures.
+    unsigned                GetBytesPerPixel() const { return GetTextureFormatMapping()->BytesPerPixel; }
+
+    // *** Interface implementation
+    virtual Image*                GetImage() const                        { SF_ASSERT(!pImage || (pImage->GetImageType() != Image::Type_ImageBase)); return (Image*)pImage; }
+    virtual ImageFormat           GetFormat() const                       { return GetImageFormat(); }
+    virtual ImageSize             GetTextureSize(unsigned plane =0) const { return pTextures[plane].Size; }
+    const TextureFormat*          GetTextureFormat() const                { return reinterpret_cast<const TextureFormat*>(pFormat); }
+    const TextureFormat::Mapping* GetTextureFormatMapping() const         { return pFormat ? reinterpret_cast<const TextureFormat*>(pFormat)->pMapping : 0; }
+
+    virtual bool                  Update(const UpdateDesc* updates, unsigned count = 1, unsigned mipLevel = 0);
+    virtual UPInt                 GetBytes(int* memRegion) const;
+
+    // Copies the image data from the storage.
+    SF_AMP_CODE( virtual bool Copy(ImageData* pdata); )
+
+protected:
+    virtual void computeUpdateConvertRescaleFlags( bool rescale, bool swMipGen, ImageFormat inputFormat,
+                                                   ImageRescaleType &rescaleType, ImageFormat &rescaleBuffFromat, bool &convert );
+};
+
+
+// Software DepthStencilSurface only holds an 8-bit stencil plane; the
+// renderer never uses depth.
+class DepthStencilSurface : public Render::DepthStencilSurface
+{
+public:
+    DepthStencilSurface(TextureManagerLocks* pmanagerLocks, const ImageSize& size);
+    ~DepthStencilSurface();
+
+    bool                    Initialize();
+
+    UByte*                  pStencil;
+    UPInt                   Pitch;
+};
+
+
+// *** MappedTexture
+class MappedTexture : public MappedTextureBase
+{
+    friend class Texture;
+
+public:
+    MappedTexture() : MappedTextureBase() { }
+
+    virtual bool Map(Render::Texture* ptexture, unsigned mipLevel, unsigned levelCount);
+};
+
+
+// Software Texture Manger.
+// This class is responsible for creating textures and keeping track of them
+// in the list.
+//
+
+class TextureManager : public Render::TextureManager
+{
+    friend class Texture;
+
+    MappedTexture                MappedTexture0;
+    RasterQueue*                 pRasterQueue;
+
+    virtual void                 processInitTextures();
+
+    void                         initTextureFormats();
+    virtual MappedTextureBase&   getDefaultMappedTexture() { return MappedTexture0; }
+    virtual MappedTextureBase*   createMappedTexture()     { return SF_HEAP_AUTO_NEW(this) MappedTexture; }
+
+public:
+    TextureManager(ThreadId renderThreadId = 0,
+                   ThreadCommandQueue* commandQueue = 0,
+                   TextureCache* texCache = 0);
+    ~TextureManager();
+
+    // *** TextureManager
+    virtual Render::Texture* CreateTexture(ImageFormat format, unsigned mipLevels,
+                                           const ImageSize& size,
+                                           unsigned use, ImageBase* pimage,
+                                           Render::MemoryManager* manager = 0);
+
+    virtual Render::DepthStencilSurface* CreateDepthStencilSurface(const ImageSize& size,
+                                                                   Render::MemoryManager* manager = 0);
+
+    // Textures live in system memory, so they can be created on any thread.
+    virtual bool            CanCreateTextureCurrentThread() const { return true; }
+
+    virtual unsigned        GetTextureUseCaps(ImageFormat format);
+
+    // Set by the HAL. Queued rendering is flushed before texture storage is
+    // modified or mapped, since the raster queue reads it asynchronously.
+    void                    SetRasterQueue(RasterQueue* pqueue) { pRasterQueue = pqueue; }
+    void                    FlushRasterQueue();
+};
+
+
+}}};  // namespace Scaleform::Render::Soft
+
+#endif
@@ -59,7 +59,8 @@ DocView::DocView(Allocator* pallocator, FontManagerBase* pfontMgr, Log* plog)
 
     SetAutoFit(); // on by default
     SetDefaultShadow();
-    TextWidth = TextHeight = 0;
+    TextWidth = TextHeight = LinesWidth = 0;
+    FirstChangedPos = 0;
 }
 
 DocView::~DocView()
@@ -182,20 +183,20 @@ void DocView::DocumentText::OnParagraphRemoving(const Paragraph& para)
 
 void DocView::DocumentText::OnTextInserting(UPInt startPos, UPInt length, const wchar_t* ptextInserting)
 {
-    SF_UNUSED3(startPos, length, ptextInserting);
-    pDocument->OnDocumentChanged(ViewNotify_TextChange);
+    SF_UNUSED2(length, ptextInserting);
+    pDocument->OnDocumentTextChanged(startPos);
 }
 
 void DocView::DocumentText::OnTextInserting(UPInt startPos, UPInt length, const char* ptextInserting)
 {
-    SF_UNUSED3(startPos, length, ptextInserting);
-    pDocument->OnDocumentChanged(ViewNotify_TextChange);
+    SF_UNUSED2(length, ptextInserting);
+    pDocument->OnDocumentTextChanged(startPos);
 }
 
 void DocView::DocumentText::OnTextRemoving(UPInt startPos, UPInt length)
 {
-    SF_UNUSED2(startPos, length);
-    pDocument->OnDocumentChanged(ViewNotify_TextChange);
+    SF_UNUSED(length);
+    pDocument->OnDocumentTextChanged(startPos);
 }
 
 UPInt DocView::EditCommand(DocView::CommandType cmdId, const void* command)
@@ -362,7 +363,7 @@ UPInt DocView::EditCommand(DocView::CommandType cmdId, const void* command)
                         ParagraphFormat newFmt = *pparaFmt;
                         newFmt.SetBullet(false);
                         ppara->SetFormat(pDocument->GetAllocator(), newFmt);
-                        OnDocumentChanged(ViewNotify_TextChange);
+                        OnDocumentChanged(ViewNotify_FormatChange);
                         res = 0;
                     }
                     else if (pparaFmt->GetIndent() != 0 || pparaFmt->GetBlockIndent() != 0)
@@ -371,7 +372,7 @@ UPInt DocView::EditCommand(DocView::CommandType cmdId, const void* command)
                         newFmt.SetIndent(0);
                         newFmt.SetBlockIndent(0);
                         ppara->SetFormat(pDocument->GetAllocator(), newFmt);
-                        OnDocumentChanged(ViewNotify_TextChange);
+                        OnDocumentChanged(ViewNotify_FormatChange);
                         res = 0;
                     }
                 }
@@ -498,6 +499,7 @@ void DocView::AppendHtml(const wchar_t* pwStr, UPInt strLen, bool condenseWhite,
 {
     if (strLen == SF_MAX_UPINT)
         strLen = SFwcslen(pwStr); 
+    OnDocumentTextChanged(pDocument->GetLength());
     pDocument->ParseHtml(pwStr, strLen, pimgInfoArr, IsMultiline(), condenseWhite);
     OnDocumentChanged(ViewNotify_TextChange | ViewNotify_ScrollingParamsChange);
 }
@@ -506,6 +508,7 @@ void DocView::AppendHtml(const char* putf8Str, UPInt utf8Len, bool condenseWhite
 {
     if (utf8Len == SF_MAX_UPINT)
         utf8Len = SFstrlen(putf8Str); // actually, this is the SIZE, not length. TODO
+    OnDocumentTextChanged(pDocument->GetLength());
     pDocument->ParseHtml(putf8Str, utf8Len, pimgInfoArr, IsMultiline(), condenseWhite);
     OnDocumentChanged(ViewNotify_TextChange | ViewNotify_ScrollingParamsChange);
 }
@@ -606,8 +609,17 @@ void DocView::OnDocumentChanged(unsigned notifyMask)
 {
     if (notifyMask & DocView::ViewNotify_SignificantMask)
         SetCompleteReformatReq();
-    else
+    else if (notifyMask & ~(DocView::ViewNotify_TextChange | DocView::ViewNotify_ScrollingParamsChange))
         SetReformatReq();
+    else
+        // position of the text change is reported by OnDocumentTextChanged
+        RTFlags |= RTFlags_ReformatReq;
+}
+
+void DocView::OnDocumentTextChanged(UPInt startPos)
+{
+    FirstChangedPos = Alg::Min(FirstChangedPos, startPos);
+    RTFlags |= RTFlags_ReformatReq;
 }
 
 void DocView::OnDocumentParagraphRemoving(const Paragraph& para)
@@ -1882,6 +1894,64 @@ void ParagraphFormatter::Format(const Paragraph& paragraph)
         pDocView->GetAllocator()->FreeText(pTextBufForCustomFormat);
 }
 
+bool DocView::FindUnchangedLines(StyledText::ParagraphsIterator* pparaIter, unsigned* plineIndex,
+                                 int* pnextOffsetY, int* ptextWidth, int* ptextHeight)
+{
+    // lines are realigned or rescaled by these, so all of them should be walked
+    if (FirstChangedPos == 0 || FirstChangedPos == SF_MAX_UPINT || IsCompleteReformatReq() ||
+        IsAutoSizeX() || GetTextAutoSize() != TAS_None || mLineBuffer.GetSize() == 0)
+        return false;
+
+    // paragraphs before the one holding the char preceding the change are not modified
+    StyledText::ParagraphsIterator paraIter = GetStyledText()->GetNearestParagraphByIndex(FirstChangedPos - 1);
+    if (paraIter.IsFinished() || paraIter.GetIndex() == 0)
+        return false;
+    const Paragraph* pprevPara = *(paraIter - 1);
+    if (pprevPara->GetLength() == 0)
+        return false;
+
+    // lines of these paragraphs are at the beginning of the line buffer and have
+    // text positions before the first modified paragraph.
+    unsigned startPos = (unsigned)TextPos2GlyphOffset((*paraIter)->GetStartIndex());
+    unsigned lo = 0, hi = mLineBuffer.GetSize();
+    while (lo < hi)
+    {
+        unsigned mid = (lo + hi) / 2;
+        if (mLineBuffer[mid].GetTextPos() < startPos)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == 0)
+        return false;
+    const LineBuffer::Line& lastLine = mLineBuffer[lo - 1];
+    if (lastLine.GetParagraphId() != pprevPara->GetId() ||
+        lastLine.GetParagraphModId() != pprevPara->GetModCounter() ||
+        (lo < mLineBuffer.GetSize() && mLineBuffer[lo].GetParagraphId() == pprevPara->GetId()))
+        return false;
+
+    // the widest of these lines is the widest line of the previous Format,
+    // unless that one is among the lines to be walked.
+    int width = 0;
+    for (unsigned i = lo; i < mLineBuffer.GetSize(); ++i)
+        width = Alg::Max(width, mLineBuffer[i].GetWidth());
+    if (width < int(LinesWidth))
+        width = int(LinesWidth);
+    else
+    {
+        width = 0;
+        for (unsigned i = 0; i < lo; ++i)
+            width = Alg::Max(width, mLineBuffer[i].GetWidth());
+    }
+
+    *pparaIter      = paraIter;
+    *plineIndex     = lo;
+    *pnextOffsetY   = lastLine.GetOffsetY() + lastLine.GetHeight() + lastLine.GetLeading();
+    *ptextWidth     = width;
+    *ptextHeight    = lastLine.GetOffsetY() + lastLine.GetHeight();
+    return true;
+}
+
 void DocView::Format()
 {
     // Reset LineBuffer's VisibleRect to ViewRect
@@ -1905,7 +1975,16 @@ void DocView::Format()
     LineBuffer::Iterator linesIt = mLineBuffer.Begin();
 
     ParagraphFormatter formatter(this, pLog);
-    int textWidth = 0, textHeight = 0;
+    int textWidth = 0, textHeight = 0, linesWidth = 0;
+
+    // if text was only inserted or removed, lines of the paragraphs before the change
+    // are skipped, so appending to a long text doesn't walk all of its lines.
+    unsigned firstLine;
+    if (FindUnchangedLines(&paraIter, &firstLine, &formatter.NextOffsetY, &textWidth, &textHeight))
+    {
+        linesIt    = linesIt + firstLine;
+        linesWidth = textWidth;
+    }
 
     while(!paraIter.IsFinished())
     {
@@ -1935,6 +2014,7 @@ void DocView::Format()
                     curLine.SetOffsetY(formatter.NextOffsetY);
 
                     textWidth  =  Alg::Max(textWidth, curLine.GetWidth());
+                    linesWidth =  Alg::Max(linesWidth, curLine.GetWidth());
                     // In Flash, the last empty line doesn't participate in textHeight,
                     // unless this is editable text.
                     if (ppara->GetLength() != 0 || (HasEditorKit() && !GetEditorKit()->IsReadOnly()))
@@ -2011,9 +2091,13 @@ void DocView::Format()
         // format paragraph
         formatter.pLinesIter     = &linesIt;
         formatter.ParaYOffset    = formatter.NextOffsetY;
+        firstLine                = linesIt.GetIndex();
         formatter.Format(*ppara);
         mLineBuffer.InvalidateCache(); // force batching to be rebuilt
 
+        for (unsigned i = firstLine; i < linesIt.GetIndex(); ++i)
+            linesWidth = Alg::Max(linesWidth, mLineBuffer[i].GetWidth());
+
         textWidth  =  Alg::Max(textWidth, formatter.ParaWidth);
 
         // In Flash, the last empty line doesn't participate in textHeight,
@@ -2034,6 +2118,7 @@ void DocView::Format()
     SF_ASSERT(textWidth >= 0 && textHeight >= 0);
     TextWidth = (UInt32)textWidth;
     TextHeight = (UInt32)textHeight;
+    LinesWidth = (UInt32)linesWidth;
 
     //    mLineBuffer.Dump();
 
@@ -287,7 +287,11 @@ public:
 
     Allocator* GetAllocator() { return pDocument->GetAllocator(); }
 protected:
-    void ClearReformatReq()   { RTFlags &= (~(RTFlags_ReformatReq | RTFlags_CompleteReformatReq)); }
+    void ClearReformatReq()
+    {
+        RTFlags &= (~(RTFlags_ReformatReq | RTFlags_CompleteReformatReq));
+        FirstChangedPos = SF_MAX_UPINT;
+    }
 
     void ClearCompleteReformatReq()   { RTFlags &= (~RTFlags_CompleteReformatReq); }
     bool IsCompleteReformatReq() const{ return (RTFlags & RTFlags_CompleteReformatReq) != 0; }
@@ -299,6 +303,11 @@ protected:
 
     UPInt GetCursorPosInLineByOffset(unsigned lineIndex, float relativeOffsetX);
 
+    // Finds the lines Format doesn't need to walk, if text was only inserted or
+    // removed since the last Format. Returns false if all lines should be walked.
+    bool FindUnchangedLines(StyledText::ParagraphsIterator* pparaIter, unsigned* plineIndex,
+                            int* pnextOffsetY, int* ptextWidth, int* ptextHeight);
+
     StyledText::NewLinePolicy GetNewLinePolicy() const
     {
         return (DoesCompressCRLF()) ? StyledText::NLP_CompressCRLF: StyledText::NLP_ReplaceCRLF;
@@ -459,8 +468,10 @@ public:
     // the combination of DocView::ViewNotificationMasks
     virtual void OnDocumentChanged(unsigned notifyMask);
     virtual void OnDocumentParagraphRemoving(const Paragraph& para);
+    // Notifies the view that text was inserted or removed at startPos.
+    void OnDocumentTextChanged(UPInt startPos);
 
-    void SetReformatReq()           { RTFlags |= RTFlags_ReformatReq; }
+    void SetReformatReq()           { RTFlags |= RTFlags_ReformatReq; FirstChangedPos = 0; }
     void SetCompleteReformatReq()   { RTFlags |= RTFlags_CompleteReformatReq; }
 
     void Format();
@@ -757,6 +768,8 @@ protected:
     RectF                   ViewRect; // total rectangle occupied by the view
     unsigned                TextWidth;  // in twips
     unsigned                TextHeight; // in twips
+    unsigned                LinesWidth; // the widest line, in twips
+    UPInt                   FirstChangedPos; // first text position changed since the last Format
     unsigned                MaxLength;
     CachedPrimValue<unsigned> MaxVScroll; 
 
@@ -862,6 +862,8 @@ public:
             x, ctx.CachedBlockY, addr, ctx.pPlane->DataSize);
         return *(UInt32*)(&ctx.pPlane->pData[addr]);
     }
+
+    virtual bool IsLinear() const { return false; }
 };
 
 Render::ImageSwizzler& TextureManager::GetImageSwizzler() const